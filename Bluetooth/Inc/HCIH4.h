@@ -0,0 +1,93 @@
+/*****< hcih4.h >**************************************************************/
+/*                                                                            */
+/*  HCIH4 - H4 (UART) packet framing for the HCI Transport Layer.             */
+/*                                                                            */
+/*  This module parses the H4 packet type and header of the data in an        */
+/*  HCIRING receive ring so that the transport can pass complete packets      */
+/*  to the upper layer.  Like HCIRING it has no dependencies on the HAL,      */
+/*  the RTOS or Bluetopia.                                                    */
+/******************************************************************************/
+#ifndef __HCIH4H__
+#define __HCIH4H__
+
+#include "HCIRING.h"        /* HCI Transport Ring Prototypes/Constants.       */
+
+   /* The following constants represent the H4 packet indicators.       */
+#define HCIH4_PACKET_TYPE_COMMAND                  0x01
+#define HCIH4_PACKET_TYPE_ACL                      0x02
+#define HCIH4_PACKET_TYPE_SCO                      0x03
+#define HCIH4_PACKET_TYPE_EVENT                    0x04
+
+   /* The following constants represent the single byte HCILL (TI low   */
+   /* power protocol) messages that are carried in the H4 stream.       */
+#define HCIH4_HCILL_GO_TO_SLEEP_IND                0x30
+#define HCIH4_HCILL_GO_TO_SLEEP_ACK                0x31
+#define HCIH4_HCILL_WAKE_UP_IND                    0x32
+#define HCIH4_HCILL_WAKE_UP_ACK                    0x33
+
+   /* The following enumerated type is used to index the per packet     */
+   /* type counters of a framer.                                        */
+typedef enum
+{
+   h4cCommand,
+   h4cACL,
+   h4cSCO,
+   h4cEvent,
+   h4cHCILL,
+   h4cUnknown
+} HCIH4_PacketClass_t;
+
+#define HCIH4_NUMBER_PACKET_CLASSES                (h4cUnknown + 1)
+
+   /* The following enumerated type represents the states of the        */
+   /* framer.                                                           */
+typedef enum
+{
+   h4sPacketType,
+   h4sHeader,
+   h4sPayload,
+   h4sStream
+} HCIH4_State_t;
+
+   /* The following structure holds the state of a framer.              */
+   /* MaxFrameLength is the largest packet that is passed up in one     */
+   /* piece, larger packets are passed up as they arrive.  The receive  */
+   /* ring MUST have MaxFrameLength bytes of buffer following the ring  */
+   /* (the mirror region) which is used to make a packet that wraps the */
+   /* end of the ring contiguous.                                       */
+typedef struct _tagHCIH4_Framer_t
+{
+   HCIH4_State_t        State;
+   HCIH4_PacketClass_t  PacketClass;
+   unsigned int         MaxFrameLength;
+   unsigned int         Parsed;
+   unsigned int         HeaderLength;
+   unsigned int         HeaderCount;
+   unsigned char        Header[4];
+   unsigned int         PacketLength;
+   unsigned int         Remaining;
+   unsigned long        PacketCount[HCIH4_NUMBER_PACKET_CLASSES];
+   unsigned long        ByteCount[HCIH4_NUMBER_PACKET_CLASSES];
+   unsigned long        MirrorCount;
+   unsigned long        StreamCount;
+} HCIH4_Framer_t;
+
+   /* The following function initializes the specified framer.  The     */
+   /* second parameter specifies the largest packet that is passed up in*/
+   /* one piece (and the size of the mirror region of the ring).        */
+void HCIH4_Initialize(HCIH4_Framer_t *Framer, unsigned int MaxFrameLength);
+
+   /* The following function examines the data that is waiting in the   */
+   /* specified ring and returns the length of the next piece of data   */
+   /* that can be passed to the upper layer, or zero if no complete     */
+   /* packet is available yet.  The data always starts at the OutIndex  */
+   /* of the ring and the third parameter receives a pointer to it.     */
+   /* Once the data has been processed the caller must call             */
+   /* HCIRING_Consume() with the returned length.                       */
+   /* * NOTE * A packet that wraps the end of the ring is made          */
+   /*          contiguous by copying the wrapped part to the mirror     */
+   /*          region, which is only possible because that part has     */
+   /*          already been received.                                   */
+unsigned int HCIH4_GetFrame(HCIH4_Framer_t *Framer, HCIRING_Ring_t *Ring, unsigned char **Data);
+
+#endif
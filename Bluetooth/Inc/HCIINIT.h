@@ -0,0 +1,104 @@
+/*****< hciinit.h >************************************************************/
+/*                                                                            */
+/*  HCIINIT - Controller initialization script loader for the HCI Transport   */
+/*            Layer.                                                          */
+/*                                                                            */
+/*  The initialization script (service pack) of the CC256x is a sequence of   */
+/*  HCI command packets in H4 format that is held in flash.  This module      */
+/*  walks the script and hands out the next command whenever the controller   */
+/*  has a command credit (Num_HCI_Command_Packets) available, and parses the  */
+/*  received data to return the credits and check the status of each          */
+/*  command.  The transport sends the commands and performs the returned      */
+/*  actions.  Like HCISLEEP it has no dependencies on the HAL, the RTOS or    */
+/*  Bluetopia.                                                                */
+/******************************************************************************/
+#ifndef __HCIINITH__
+#define __HCIINITH__
+
+   /* The following constants represent the opcode and the length (with */
+   /* the packet indicator) of the HCI_VS_Update_UART_HCI_Baudrate      */
+   /* command of the CC256x.                                            */
+#define HCIINIT_OPCODE_UPDATE_UART_HCI_BAUDRATE    0xFF36
+#define HCIINIT_BAUD_RATE_COMMAND_LENGTH           8
+
+   /* The following enumerated type represents the states of the        */
+   /* loader.                                                           */
+typedef enum
+{
+   hisRunning,
+   hisComplete,
+   hisFailed
+} HCIINIT_State_t;
+
+   /* The following constants represent the actions (bit mask) that are */
+   /* returned by HCIINIT_ProcessData().                                */
+   /*    CHANGE_BAUD_RATE - The controller has accepted the new baud    */
+   /*                       rate, the UART MUST be switched to it before*/
+   /*                       the next command is sent.                   */
+   /*    PROGRESS         - A Command Complete or Command Status event  */
+   /*                       has been received.                          */
+#define HCIINIT_ACTION_CHANGE_BAUD_RATE            0x0001
+#define HCIINIT_ACTION_PROGRESS                    0x0002
+
+   /* The following structure holds the state of the loader.  Offset is */
+   /* the offset in the script of the next command to send.  Credits is */
+   /* the number of commands that the controller last reported it can   */
+   /* accept and Outstanding the number of commands that have been      */
+   /* handed out and not completed yet.  FailedOpCode and FailedStatus  */
+   /* hold the command that failed (if the state is hisFailed).  The    */
+   /* remaining members are used to parse the received packets.         */
+typedef struct _tagHCIINIT_Loader_t
+{
+   const unsigned char *Script;
+   unsigned long        ScriptLength;
+   unsigned long        Offset;
+   volatile HCIINIT_State_t State;
+   unsigned int         Credits;
+   unsigned int         Outstanding;
+   unsigned int         MaximumOutstanding;
+   unsigned long        CommandsSent;
+   unsigned long        CommandsCompleted;
+   unsigned long        CommandsSkipped;
+   unsigned short       FailedOpCode;
+   unsigned char        FailedStatus;
+   unsigned char        BaudRateCommandState;
+   unsigned char        BaudRateCommand[HCIINIT_BAUD_RATE_COMMAND_LENGTH];
+   unsigned char        PacketType;
+   unsigned int         HeaderLength;
+   unsigned int         PacketLength;
+   unsigned int         Count;
+   unsigned char        Header[6];
+} HCIINIT_Loader_t;
+
+   /* The following function checks that the specified script consists  */
+   /* only of complete HCI command packets.  This function returns the  */
+   /* number of commands in the script or a negative value if the       */
+   /* script is not valid.                                              */
+long HCIINIT_CheckScript(const unsigned char *Script, unsigned long Length);
+
+   /* The following function initializes the specified loader with the  */
+   /* specified script (which may be NULL if only the baud rate is to be*/
+   /* changed).  If the final parameter is not zero the first command   */
+   /* is HCI_VS_Update_UART_HCI_Baudrate to the specified baud rate and */
+   /* no other command is handed out until it has completed.  The loader*/
+   /* starts with one command credit.                                   */
+   /* * NOTE * HCI_VS_Update_UART_HCI_Baudrate commands in the script   */
+   /*          are skipped, as the transport can not follow them.       */
+void HCIINIT_Initialize(HCIINIT_Loader_t *Loader, const unsigned char *Script, unsigned long Length, unsigned long BaudRate);
+
+   /* The following function returns the length of the next command to  */
+   /* send, or zero if no command can be sent until more credits are    */
+   /* returned (or the loader has finished).  The second parameter      */
+   /* receives a pointer to the command.  The command is counted as     */
+   /* outstanding when it is returned, so it MUST be sent.              */
+unsigned int HCIINIT_GetCommand(HCIINIT_Loader_t *Loader, const unsigned char **Command);
+
+   /* The following function parses the specified data that has been    */
+   /* received from the controller (in pieces of any size) and returns  */
+   /* the actions (a bit mask of HCIINIT_ACTION_xxx constants) that the */
+   /* caller must perform.                                              */
+   /* * NOTE * The caller must make sure that this function and         */
+   /*          HCIINIT_GetCommand() are never called at the same time.  */
+unsigned int HCIINIT_ProcessData(HCIINIT_Loader_t *Loader, unsigned int Length, const unsigned char *Data);
+
+#endif
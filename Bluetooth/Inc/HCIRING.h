@@ -0,0 +1,69 @@
+/*****< hciring.h >************************************************************/
+/*                                                                            */
+/*  HCIRING - Receive ring bookkeeping for the HCI Transport Layer.           */
+/*                                                                            */
+/*  This module contains only the index/count arithmetic of the HCI           */
+/*  transport receive ring.  It has no dependencies on the HAL, the RTOS      */
+/*  or Bluetopia so that the same code can be built into a host side          */
+/*  harness and fed with recorded HCI byte streams.                           */
+/******************************************************************************/
+#ifndef __HCIRINGH__
+#define __HCIRINGH__
+
+   /* The following structure holds the state of a single receive ring. */
+   /* The producer (UART interrupt or DMA event) only ever modifies the */
+   /* InIndex and the consumer (HCITR_COMProcess()) only ever modifies  */
+   /* the OutIndex, except on an overrun of HCIRING_ProducerSync().     */
+   /* BytesFree is shared by both and MUST be updated by the consumer   */
+   /* with the producer locked out.                                     */
+typedef struct _tagHCIRING_Ring_t
+{
+   unsigned char          *Buffer;
+   unsigned int            Size;
+   unsigned int            InIndex;
+   unsigned int            OutIndex;
+   volatile unsigned int   BytesFree;
+   unsigned long           OverrunCount;
+} HCIRING_Ring_t;
+
+   /* The following function initializes the specified ring to use the  */
+   /* specified buffer of the specified size.  The ring is empty upon   */
+   /* return.                                                           */
+void HCIRING_Initialize(HCIRING_Ring_t *Ring, unsigned char *Buffer, unsigned int Size);
+
+   /* The following function is called by the producer after Length     */
+   /* bytes have been written to the ring starting at InIndex.  The     */
+   /* function returns the number of bytes that were accepted into the  */
+   /* ring.                                                             */
+unsigned int HCIRING_Produce(HCIRING_Ring_t *Ring, unsigned int Length);
+
+   /* The following function is called by a producer that writes the    */
+   /* ring autonomously (i.e. a circular DMA) to synchronize the ring   */
+   /* with the current hardware write position (0 - Size).  The         */
+   /* function returns the number of new bytes that were found in the   */
+   /* ring since the last call.                                         */
+   /* * NOTE * The producer MUST be synchronized at least once for every*/
+   /*          Size bytes that are written (the half and full transfer  */
+   /*          events of a circular DMA guarantee this).                */
+   /* * NOTE * If the hardware has written over data that has not been  */
+   /*          consumed yet the OverrunCount is incremented, the ring is*/
+   /*          marked as full and OutIndex is moved to InIndex (the     */
+   /*          oldest byte that is left), so the data stays in order.  A*/
+   /*          span that was being processed when this happened has been*/
+   /*          overwritten, and its HCIRING_Consume() drops as many of  */
+   /*          the oldest bytes that are left.                          */
+unsigned int HCIRING_ProducerSync(HCIRING_Ring_t *Ring, unsigned int Position);
+
+   /* The following function returns the number of bytes that can be    */
+   /* read contiguously starting at OutIndex.  The second parameter, if */
+   /* specified, receives a pointer to the first of these bytes.        */
+unsigned int HCIRING_GetSpan(HCIRING_Ring_t *Ring, unsigned char **Data);
+
+   /* The following function is called by the consumer once Length      */
+   /* bytes (previously returned by HCIRING_GetSpan()) have been        */
+   /* processed.                                                        */
+   /* * NOTE * The caller must lock out the producer for the duration of*/
+   /*          this call.                                               */
+void HCIRING_Consume(HCIRING_Ring_t *Ring, unsigned int Length);
+
+#endif
@@ -0,0 +1,90 @@
+/*****< hcisleep.h >***********************************************************/
+/*                                                                            */
+/*  HCISLEEP - HCILL suspend/wake sequencing for the HCI Transport Layer.     */
+/*                                                                            */
+/*  This module contains only the state machine that decides what the        */
+/*  transport must do when it is suspended, when the suspend is               */
+/*  interrupted and when either side wakes the link.  The transport           */
+/*  performs the returned actions on the hardware.  Like HCIRING it has no    */
+/*  dependencies on the HAL, the RTOS or Bluetopia so that the wake           */
+/*  sequencing can be exercised by a host side harness.                       */
+/******************************************************************************/
+#ifndef __HCISLEEPH__
+#define __HCISLEEPH__
+
+   /* The following enumerated type represents the states of the        */
+   /* transport.                                                        */
+typedef enum
+{
+   hslAwake,
+   hslSuspendWait,
+   hslSuspendAborted,
+   hslSuspended
+} HCISLEEP_State_t;
+
+   /* The following enumerated type represents the events that are      */
+   /* passed to the state machine.                                      */
+   /*    hseSuspendRequest  - HCITR_COMSuspend() has been called.       */
+   /*    hseReceiveActivity - Data has been received from the           */
+   /*                         controller.                               */
+   /*    hseWaitComplete    - HCITR_COMSuspend() has finished waiting   */
+   /*                         for the transmitter (either because all   */
+   /*                         data was sent or because the suspend was  */
+   /*                         aborted).                                 */
+   /*    hseControllerWake  - The controller has lowered CTS.           */
+   /*    hseHostWake        - The host has data to send.                */
+typedef enum
+{
+   hseSuspendRequest,
+   hseReceiveActivity,
+   hseWaitComplete,
+   hseControllerWake,
+   hseHostWake
+} HCISLEEP_Event_t;
+
+   /* The following constants represent the actions (bit mask) that are */
+   /* returned by HCISLEEP_Event().  When more than one action is       */
+   /* returned they MUST be performed in the order that they are listed */
+   /* here.                                                             */
+   /*    START_UART   - Enable the UART clock, return TXD to the UART   */
+   /*                   and prevent the MCU from entering a mode in     */
+   /*                   which the UART can not run.                     */
+   /*    HOLD_FLOW    - Raise RTS so that the controller can not send.  */
+   /*    RELEASE_FLOW - Return RTS to the receive flow control.         */
+   /*    STOP_UART    - Hold the TXD line idle, disable the UART clock  */
+   /*                   and allow the MCU to enter a low power mode.    */
+   /*    SUSPENDED    - The suspend has completed successfully.         */
+   /*    ABORTED      - The suspend has been aborted.                   */
+#define HCISLEEP_ACTION_START_UART                 0x0001
+#define HCISLEEP_ACTION_HOLD_FLOW                  0x0002
+#define HCISLEEP_ACTION_RELEASE_FLOW               0x0004
+#define HCISLEEP_ACTION_STOP_UART                  0x0008
+#define HCISLEEP_ACTION_SUSPENDED                  0x0010
+#define HCISLEEP_ACTION_ABORTED                    0x0020
+
+   /* The following structure holds the state of the state machine.     */
+   /* The counts are the number of completed and aborted suspends and   */
+   /* the number of times that the suspended link was woken by either   */
+   /* side.                                                             */
+typedef struct _tagHCISLEEP_Machine_t
+{
+   volatile HCISLEEP_State_t State;
+   unsigned long             SuspendCount;
+   unsigned long             AbortCount;
+   unsigned long             ControllerWakeCount;
+   unsigned long             HostWakeCount;
+} HCISLEEP_Machine_t;
+
+   /* The following function initializes the specified state machine.   */
+   /* The state machine starts in the awake state.                      */
+void HCISLEEP_Initialize(HCISLEEP_Machine_t *Machine);
+
+   /* The following function passes the specified event to the          */
+   /* specified state machine and returns the actions (a bit mask of    */
+   /* HCISLEEP_ACTION_xxx constants) that the caller must perform.      */
+   /* * NOTE * The caller must lock out all other sources of events     */
+   /*          (i.e. disable interrupts) for the duration of this call  */
+   /*          and while the returned actions are performed.            */
+unsigned int HCISLEEP_Event(HCISLEEP_Machine_t *Machine, HCISLEEP_Event_t Event);
+
+#endif
@@ -0,0 +1,89 @@
+/*****< hcisnoop.h >***********************************************************/
+/*                                                                            */
+/*  HCISNOOP - btsnoop capture staging ring for the HCI Transport Layer.      */
+/*                                                                            */
+/*  This module formats captured HCI packets as btsnoop records (the format   */
+/*  that is read by Wireshark) into a staging ring that is written to a file  */
+/*  in large blocks by a separate task.  Like HCIRING it has no dependencies  */
+/*  on the HAL, the RTOS or Bluetopia.                                        */
+/******************************************************************************/
+#ifndef __HCISNOOPH__
+#define __HCISNOOPH__
+
+   /* The following constants represent the sizes of the btsnoop file   */
+   /* header and of the header of each packet record.                   */
+#define HCISNOOP_FILE_HEADER_SIZE                  16
+#define HCISNOOP_RECORD_HEADER_SIZE                24
+
+   /* The following constant represents the btsnoop data link type of   */
+   /* HCI UART (H4) packets, which include the H4 packet indicator.     */
+#define HCISNOOP_DATALINK_TYPE_H4                  1002
+
+   /* The following constant represents the offset (in microseconds)    */
+   /* between the btsnoop time base (midnight, January 1st, 0 AD) and   */
+   /* the Unix epoch.  Add this to a Unix time in microseconds to get a */
+   /* btsnoop time stamp.                                               */
+#define HCISNOOP_UNIX_EPOCH_OFFSET                 0x00DCDDB30F2F8000ULL
+
+   /* The following macro is used to order the writes to the ring data  */
+   /* before the write of the index that publishes them.                */
+#ifndef HCISNOOP_MEMORY_BARRIER
+
+   #define HCISNOOP_MEMORY_BARRIER()               __sync_synchronize()
+
+#endif
+
+   /* The following structure holds the state of a staging ring.  The   */
+   /* producer only ever modifies the InIndex and the consumer only ever*/
+   /* modifies the OutIndex, so the producer and consumer need no lock. */
+   /* DropCount is the number of packets that did not fit in the ring   */
+   /* (written in each record as the btsnoop cumulative drops).         */
+   /* * NOTE * There may only be a single producer at a time.           */
+typedef struct _tagHCISNOOP_Ring_t
+{
+   unsigned char         *Buffer;
+   unsigned int           Size;
+   volatile unsigned int  InIndex;
+   volatile unsigned int  OutIndex;
+   unsigned long          PacketCount;
+   unsigned long          DropCount;
+} HCISNOOP_Ring_t;
+
+   /* The following function initializes the specified ring to use the  */
+   /* specified buffer of the specified size and places the btsnoop file*/
+   /* header in it, so that the data that is read from the ring is a    */
+   /* complete btsnoop file.                                            */
+   /* * NOTE * The size should be a multiple of the block size that is  */
+   /*          passed to HCISNOOP_GetBlock() so that every block that is*/
+   /*          written (except the last) starts at a multiple of the    */
+   /*          block size in the file.                                  */
+void HCISNOOP_Initialize(HCISNOOP_Ring_t *Ring, unsigned char *Buffer, unsigned int Size);
+
+   /* The following function is called by the producer to capture a     */
+   /* packet.  The second parameter is non-zero for a packet that was   */
+   /* received from the controller and zero for a packet that was sent  */
+   /* to it.  The time stamp is a btsnoop time stamp (microseconds, see */
+   /* HCISNOOP_UNIX_EPOCH_OFFSET).  The packet starts with the H4 packet*/
+   /* indicator.  This function returns non-zero if the packet was      */
+   /* captured or zero if it was dropped because the ring is full.      */
+int HCISNOOP_Capture(HCISNOOP_Ring_t *Ring, int Received, unsigned long long TimeStamp, unsigned int Length, unsigned char *Data);
+
+   /* The following function is called by the consumer to get the next  */
+   /* block of data to write.  The length that is returned is the       */
+   /* largest multiple of BlockSize that can be read contiguously or, if*/
+   /* the third parameter is non-zero (i.e. when the capture is being   */
+   /* finished), whatever can be read contiguously.  The fourth         */
+   /* parameter receives a pointer to the data.  Once the data has been */
+   /* written the consumer must call HCISNOOP_Release().                */
+unsigned int HCISNOOP_GetBlock(HCISNOOP_Ring_t *Ring, unsigned int BlockSize, int Flush, unsigned char **Data);
+
+   /* The following function is called by the consumer once Length      */
+   /* bytes (previously returned by HCISNOOP_GetBlock()) have been      */
+   /* written.                                                          */
+void HCISNOOP_Release(HCISNOOP_Ring_t *Ring, unsigned int Length);
+
+   /* The following function returns the number of bytes that are       */
+   /* waiting in the specified ring.                                    */
+unsigned int HCISNOOP_GetUsed(HCISNOOP_Ring_t *Ring);
+
+#endif
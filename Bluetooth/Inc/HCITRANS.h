@@ -52,6 +52,171 @@
                                                         /* the transmit buffer*/
                                                         /* to empty.          */
 
+#define HCITR_ERROR_CAPTURE_FAILED           (-6)       /* Denotes that the   */
+                                                        /* capture file could */
+                                                        /* not be created or  */
+                                                        /* a capture is       */
+                                                        /* already running.   */
+
+#define HCITR_ERROR_INITIALIZATION_FAILED    (-7)       /* Denotes that the   */
+                                                        /* controller did not */
+                                                        /* accept the baud    */
+                                                        /* rate or the        */
+                                                        /* initialization     */
+                                                        /* script.            */
+
+   /* The following constants represent the classes of transmitted data */
+   /* that are reported separately in the transport statistics, in      */
+   /* order of decreasing transmit priority (see                        */
+   /* HCITR_ENABLE_TX_PRIORITY_QUEUES in HCITRCFG.h).  The single byte  */
+   /* HCILL messages are sent with the SCO data.                        */
+#define HCITR_TX_CLASS_SCO                   0
+#define HCITR_TX_CLASS_COMMAND               1
+#define HCITR_TX_CLASS_ACL                   2
+
+#define HCITR_NUMBER_TX_CLASSES              3
+
+   /* The following constants define the transmit latency histogram of  */
+   /* each class.  Bucket 0 counts the packets that were sent in less   */
+   /* than HCITR_LATENCY_BUCKET_0_LIMIT microseconds, the limit of each */
+   /* following bucket is double that of the previous bucket and the    */
+   /* last bucket counts all of the packets above that.                 */
+#define HCITR_NUMBER_LATENCY_BUCKETS         10
+#define HCITR_LATENCY_BUCKET_0_LIMIT         64
+
+   /* The following structure is used with the HCITR_QueryStatistics()  */
+   /* function to return the transmit statistics of a single class of   */
+   /* data.  The latency of a packet is the time (in microseconds) from */
+   /* when it was passed to HCITR_COMWrite() until its last byte was    */
+   /* handed to the UART.                                               */
+typedef struct _tagHCITR_TxClassStatistics_t
+{
+   unsigned long Packets;
+   unsigned long Bytes;
+   unsigned long MaximumLatency;
+   unsigned long LatencyHistogram[HCITR_NUMBER_LATENCY_BUCKETS];
+} HCITR_TxClassStatistics_t;
+
+   /* The following structure is used with the                          */
+   /* HCITR_QueryStatistics() function to return the transfer           */
+   /* statistics of the transport.  The counts are accumulated since the*/
+   /* transport was opened or the statistics were last reset.  The      */
+   /* interrupt counts include the per character UART interrupts as     */
+   /* well as the DMA and idle line events, depending on the configured */
+   /* mode (see HCITRCFG.h).  RxCallbacks is the number of times the    */
+   /* upper layer was called with received data.  The per packet type   */
+   /* counts are only available when H4 framing is enabled.  TxClass is */
+   /* indexed by the HCITR_TX_CLASS_xxx constants.  RxHighWaterMark is  */
+   /* the largest number of bytes that were waiting in the receive      */
+   /* buffer, RxFlowOffCount is the number of times flow was turned off */
+   /* and RxBufferOverruns and RxUARTOverruns count the times that      */
+   /* received data was lost because the buffer or the UART was full.   */
+   /* RxTaskWakeups and RxMaximumLatency (in microseconds, from the     */
+   /* arrival of data until the receive task started to process it) are */
+   /* only available when the receive task is enabled.  Suspends and    */
+   /* SuspendAborts count the calls to HCITR_COMSuspend() that          */
+   /* succeeded and failed, ControllerWakes and HostWakes count the     */
+   /* times that the suspended transport was woken by the controller    */
+   /* (CTS) and by HCITR_COMWrite().                                    */
+typedef struct _tagHCITR_Statistics_t
+{
+   unsigned long ElapsedTime;
+   unsigned long TxBytes;
+   unsigned long TxBytesPerSecond;
+   unsigned long TxInterrupts;
+   unsigned long RxBytes;
+   unsigned long RxBytesPerSecond;
+   unsigned long RxInterrupts;
+   unsigned long RxCallbacks;
+   unsigned long RxEventPackets;
+   unsigned long RxACLPackets;
+   unsigned long RxSCOPackets;
+   unsigned long RxHCILLPackets;
+   unsigned long RxUnknownBytes;
+   unsigned long RxBufferSize;
+   unsigned long RxHighWaterMark;
+   unsigned long RxFlowOffCount;
+   unsigned long RxBufferOverruns;
+   unsigned long RxUARTOverruns;
+   unsigned long RxTaskWakeups;
+   unsigned long RxMaximumLatency;
+   unsigned long Suspends;
+   unsigned long SuspendAborts;
+   unsigned long ControllerWakes;
+   unsigned long HostWakes;
+   HCITR_TxClassStatistics_t TxClass[HCITR_NUMBER_TX_CLASSES];
+} HCITR_Statistics_t;
+
+#define HCITR_STATISTICS_SIZE                (sizeof(HCITR_Statistics_t))
+
+   /* The following structure is used with the HCITR_StopCapture()      */
+   /* function to return the number of packets that were captured and   */
+   /* dropped (because the staging buffer was full), the number of bytes*/
+   /* that were written to the file and the number of writes that       */
+   /* failed.                                                           */
+typedef struct _tagHCITR_CaptureStatistics_t
+{
+   unsigned long Packets;
+   unsigned long DroppedPackets;
+   unsigned long BytesWritten;
+   unsigned long WriteErrors;
+} HCITR_CaptureStatistics_t;
+
+   /* The following structure is used with the                          */
+   /* HCITR_QueryBootStatistics() function to return the duration (in   */
+   /* microseconds) of each phase of the start up of the controller by  */
+   /* the last call to HCITR_COMOpen().  ResetTime is the time that     */
+   /* nShutdown was held low, BootTime the time from its release until  */
+   /* the controller lowered CTS, BaudRateTime the time to switch both  */
+   /* sides to BaudRate and ScriptTime the time to upload the           */
+   /* initialization script (see HCITR_SetInitScript()).  TotalTime is  */
+   /* the time spent in HCITR_COMOpen().  ScriptCommands is the number  */
+   /* of script commands that were sent and MaximumOutstanding the      */
+   /* largest number of commands that were waiting for the controller   */
+   /* at the same time.  Status is zero if all phases succeeded, or     */
+   /* HCITR_ERROR_INITIALIZATION_FAILED in which case FailedOpCode and  */
+   /* FailedStatus identify the command that failed (the status is zero */
+   /* if the controller did not respond in time).  CTSTimeout is TRUE if*/
+   /* the controller did not lower CTS within the boot timeout.         */
+typedef struct _tagHCITR_BootStatistics_t
+{
+   unsigned long  ResetTime;
+   unsigned long  BootTime;
+   unsigned long  BaudRateTime;
+   unsigned long  ScriptTime;
+   unsigned long  TotalTime;
+   unsigned long  BaudRate;
+   unsigned long  ScriptCommands;
+   unsigned long  MaximumOutstanding;
+   int            Status;
+   unsigned short FailedOpCode;
+   unsigned char  FailedStatus;
+   Boolean_t      CTSTimeout;
+} HCITR_BootStatistics_t;
+
+   /* The following structure is used with the                          */
+   /* HCITR_SetFlowConfiguration() and HCITR_QueryFlowConfiguration()   */
+   /* functions to specify the size of the receive buffer and the       */
+   /* amount of free space remaining in it at which flow is turned off  */
+   /* and back on.  When the receive buffer is filled by the DMA, half  */
+   /* of the buffer is added to both thresholds (see HCITRANS.c).       */
+   /* * NOTE * The buffer size must be between                          */
+   /*          HCITR_MINIMUM_RECEIVE_BUFFER_SIZE and                    */
+   /*          HCITR_MAXIMUM_RECEIVE_BUFFER_SIZE and the flow off       */
+   /*          threshold must be less than the flow on threshold which  */
+   /*          must be less than half of the buffer size.               */
+typedef struct _tagHCITR_FlowConfiguration_t
+{
+   unsigned int ReceiveBufferSize;
+   unsigned int FlowOffThreshold;
+   unsigned int FlowOnThreshold;
+} HCITR_FlowConfiguration_t;
+
+#define HCITR_FLOW_CONFIGURATION_SIZE        (sizeof(HCITR_FlowConfiguration_t))
+
+#define HCITR_MINIMUM_RECEIVE_BUFFER_SIZE    256
+#define HCITR_MAXIMUM_RECEIVE_BUFFER_SIZE    2112
+
    /* The following declared type represents the Prototype Function for */
    /* an HCI Transport Driver Data Callback for COM data.  This function*/
    /* will be called whenever HCI Packet Information has been received  */
@@ -168,4 +333,64 @@ int BTPSAPI HCITR_COMSuspend(unsigned int HCITransportID);
    /* if successful or a negative value if there was an error.          */
 int BTPSAPI HCITR_EnableDebugLogging(Boolean_t Enable);
 
+   /* The following function is used to query the transfer statistics   */
+   /* of the HCI Transport specified by the first parameter.  The second*/
+   /* parameter is a pointer to a structure that will receive the       */
+   /* statistics (the ElapsedTime member is specified in milliseconds). */
+   /* The final parameter specifies whether the statistics should be    */
+   /* reset after they are read.  This function returns zero if         */
+   /* successful or a negative value if there was an error.             */
+int BTPSAPI HCITR_QueryStatistics(unsigned int HCITransportID, HCITR_Statistics_t *Statistics, Boolean_t Reset);
+
+   /* The following function is used to change the receive buffer size  */
+   /* and flow control thresholds of the HCI Transport.  The function   */
+   /* accepts as its parameter a pointer to the new configuration.  The */
+   /* configuration is used the next time the transport is opened with  */
+   /* HCITR_COMOpen().  This function returns zero if successful or a   */
+   /* negative value if the configuration is not valid.                 */
+int BTPSAPI HCITR_SetFlowConfiguration(HCITR_FlowConfiguration_t *Configuration);
+
+   /* The following function is used to query the flow configuration    */
+   /* that will be used the next time the HCI Transport is opened.  The */
+   /* function accepts as its parameter a pointer to a structure that   */
+   /* will receive the configuration.  This function returns zero if    */
+   /* successful or a negative value if there was an error.             */
+int BTPSAPI HCITR_QueryFlowConfiguration(HCITR_FlowConfiguration_t *Configuration);
+
+   /* The following function is used to start capturing the HCI traffic */
+   /* to the specified btsnoop file on the SD card (which is created or */
+   /* truncated).  The file can be opened with Wireshark.  This function*/
+   /* returns zero if successful or a negative value if there was an    */
+   /* error.                                                            */
+int BTPSAPI HCITR_StartCapture(char *FileName);
+
+   /* The following function is used to stop the capture that was       */
+   /* started with HCITR_StartCapture().  The function blocks until all */
+   /* captured data has been written and the file has been closed.  The */
+   /* function accepts as its parameter an optional pointer to a        */
+   /* structure that receives the final counts of the capture.  This    */
+   /* function returns zero if successful or a negative value if there  */
+   /* was an error.                                                     */
+int BTPSAPI HCITR_StopCapture(HCITR_CaptureStatistics_t *Statistics);
+
+   /* The following function is used to register the initialization     */
+   /* script (service pack) that is uploaded to the controller each time*/
+   /* the transport is opened with HCITR_COMOpen(), after the baud rate */
+   /* has been switched to the one specified in the COMM driver         */
+   /* information.  The script is a sequence of H4 HCI command packets  */
+   /* (a .bts file converted to a C array) and MUST remain valid while  */
+   /* it is registered.  A NULL script removes the registration.  This  */
+   /* function returns zero if successful or a negative value if the    */
+   /* script is not valid.                                              */
+   /* * NOTE * The script must not also be sent by the vendor specific  */
+   /*          initialization of Bluetopia.                             */
+int BTPSAPI HCITR_SetInitScript(const unsigned char *Script, unsigned long Length);
+
+   /* The following function is used to query the timing of the start up*/
+   /* of the controller by the last call to HCITR_COMOpen().  The       */
+   /* function accepts as its parameter a pointer to a structure that   */
+   /* will receive the statistics.  This function returns zero if       */
+   /* successful or a negative value if there was an error.             */
+int BTPSAPI HCITR_QueryBootStatistics(HCITR_BootStatistics_t *Statistics);
+
 #endif
@@ -21,6 +21,12 @@
 
 #include "BTAPITyp.h"            /* Bluetooth API Type Definitions.           */
 
+#ifdef HCITR_HOST_SIMULATION
+
+#include "HCITRSIM.h"            /* Host simulation of the MCU peripherals.   */
+
+#else
+
 #include "main.h"
 #include "stm32l4xx.h"           /* STM32F register definitions.              */
 #include "stm32l4xx_hal_gpio.h"      /* STM32F GPIO control functions.            */
@@ -29,6 +35,8 @@
 #include "stm32l4xx_hal_dma.h"       /* STM32F DMA control functions.             */
 #include "stm32l4xx_hal_exti.h"      /* STM32F Ext interrupt definitions.         */
 
+#endif
+
    /* The following definitions define the UART/USART to be used by the */
    /* HCI transport and the pins that will be used by the UART.  Please */
    /* consult the processor's documentation to determine what pins are  */
@@ -65,19 +73,107 @@
 
 #define HCITR_CTS_EXTI_LINE		 EXTI_IMR1_IM3
 
+   /* The following definition defines the frequency (in Hz) of the     */
+   /* kernel clock of the UART.  This is used to build the table of     */
+   /* baud rate divisors.                                               */
+   /* * NOTE * USART2 is clocked from PCLK1 (see HAL_UART_MspInit() in  */
+   /*          usart.c) which is SYSCLK / 2 (see SystemClock_Config() in*/
+   /*          main.c).  This MUST be updated if the clock tree changes.*/
+#define HCITR_UART_CLOCK         60000000
+
    /* The following definitons define the DMA infomation for receive and*/
    /* transmit on the HCI UART.  This includes the DMA number (either 1 */
-   /* or 2) as well as the stream and channel.                          */
-   /* * NOTE * The DMA information MUST map to the receive and transmit */
-   /*          DMA for the specified UART (see the DMA sections of the  */
-   /*          processor's User Manual).                                */
+   /* or 2) as well as the channel.                                     */
+   /* * NOTE * The DMA information MUST match the channels that the     */
+   /*          DMAMUX requests for the specified UART are routed to (see*/
+   /*          HAL_UART_MspInit() in usart.c).                          */
 #define HCITR_DMA_RXD_NUMBER     2
-#define HCITR_DMA_RXD_STREAM     1
 #define HCITR_DMA_RXD_CHANNEL    6
 
 #define HCITR_DMA_TXD_NUMBER     2
-#define HCITR_DMA_TXD_STREAM     6
-#define HCITR_DMA_TXD_CHANNEL    5
+#define HCITR_DMA_TXD_CHANNEL    7
+
+   /* Define the following to receive into the input buffer with a      */
+   /* circular DMA instead of one interrupt per received character.     */
+   /* Received data is then made available on the idle line interrupt   */
+   /* of the UART and on the half and full transfer interrupts of the   */
+   /* DMA.                                                              */
+   /* * NOTE * The receive DMA channel MUST be configured in circular   */
+   /*          mode (see HAL_UART_MspInit() in usart.c).                */
+#define HCITR_ENABLE_DMA_RX
+
+   /* Define the following to transmit the output buffer with the DMA   */
+   /* instead of one interrupt per transmitted character.  The task     */
+   /* calling HCITR_COMWrite() blocks on a task notification while it   */
+   /* waits for space in the output buffer.                             */
+#define HCITR_ENABLE_DMA_TX
+
+   /* Define the following to enable the 8 character transmit and       */
+   /* receive FIFOs of the UART.  For a direction that is not serviced  */
+   /* by the DMA, the UART interrupt is then only generated when the    */
+   /* FIFO reaches the threshold below (or the receive line goes idle)  */
+   /* and each interrupt moves several characters.                      */
+#define HCITR_ENABLE_UART_FIFO
+
+#define HCITR_UART_TX_FIFO_THRESHOLD UART_TXFIFO_THRESHOLD_1_2
+#define HCITR_UART_RX_FIFO_THRESHOLD UART_RXFIFO_THRESHOLD_1_2
+
+   /* Define the following to parse the H4 packet headers of the        */
+   /* received data and pass only complete packets to the upper layer   */
+   /* (instead of whatever has been received up to the end of the input */
+   /* buffer).                                                          */
+#define HCITR_ENABLE_H4_FRAMING
+
+   /* Define the following to queue the transmitted SCO (and HCILL),    */
+   /* command and ACL packets separately.  The next packet to send is   */
+   /* chosen by priority (in that order) each time the previous packet  */
+   /* has been completely sent, so a command or SCO packet never waits  */
+   /* behind more than one ACL packet.  If not defined all data is sent */
+   /* in the order it was written.                                      */
+   /* * NOTE * The transmit latency of each class is measured with the  */
+   /*          DWT cycle counter in either case.                        */
+#define HCITR_ENABLE_TX_PRIORITY_QUEUES
+
+   /* Define the following to pass received data to the upper layer     */
+   /* from a dedicated task that is notified by the receive interrupt   */
+   /* (or DMA event) as soon as data arrives, instead of waiting for    */
+   /* HCITR_COMProcess() to be called.  Calls to HCITR_COMProcess() then*/
+   /* only wake up this task.  The stack size is specified in words.    */
+#define HCITR_ENABLE_RX_TASK
+
+#define HCITR_RX_TASK_PRIORITY   (configMAX_PRIORITIES - 1)
+#define HCITR_RX_TASK_STACK_SIZE 256
+
+   /* Define the following to have HCITR_COMOpen() start the controller */
+   /* itself instead of allowing it a fixed 250 milliseconds after the  */
+   /* reset.  It waits (for up to HCITR_BOOT_TIMEOUT milliseconds) for  */
+   /* the controller to lower CTS, switches both sides to the baud rate */
+   /* of the COMM driver information (with the vendor specific          */
+   /* command HCI_VS_Update_UART_HCI_Baudrate) and then streams the     */
+   /* initialization script registered with HCITR_SetInitScript() from  */
+   /* flash, with as many commands outstanding as the controller has    */
+   /* credits for.  The controller must respond within                  */
+   /* HCITR_BOOT_COMMAND_TIMEOUT milliseconds.  The time of each phase  */
+   /* is returned by HCITR_QueryBootStatistics().                       */
+#define HCITR_ENABLE_FAST_BOOT
+
+#define HCITR_BOOT_TIMEOUT          250
+#define HCITR_BOOT_COMMAND_TIMEOUT  500
+
+   /* Define the following to be able to capture the HCI traffic to a   */
+   /* btsnoop file on the SD card (see HCITR_StartCapture()).  Packets  */
+   /* are copied to a staging buffer of the size below and written to   */
+   /* the file in whole sectors by a low priority task, so the transport*/
+   /* never waits for the card.  Packets that do not fit in the staging */
+   /* buffer are dropped (and counted in the file).  The stack size is  */
+   /* specified in words.                                               */
+   /* * NOTE * Received packets are only captured whole when            */
+   /*          HCITR_ENABLE_H4_FRAMING is also defined.                 */
+#define HCITR_ENABLE_SNOOP_CAPTURE
+
+#define HCITR_SNOOP_BUFFER_SIZE      16384
+#define HCITR_SNOOP_TASK_PRIORITY    (tskIDLE_PRIORITY + 1)
+#define HCITR_SNOOP_TASK_STACK_SIZE  512
 
    /* Define the following to enable suspend functionality within       */
    /* HCITRANS.  This will shut down the UART when HCITR_COMSuspend() is*/
@@ -88,6 +184,15 @@
    /*          indicated it is safe to do so by the protocol driver.    */
 #define SUPPORT_TRANSPORT_SUSPEND
 
+   /* Define the following to allow the MCU to enter STOP2 (see         */
+   /* LOWPOWER.h) while the transport is suspended.  The controller     */
+   /* wakes the MCU by lowering CTS, which is configured as an EXTI     */
+   /* interrupt (see MX_GPIO_Init() in gpio.c).  RTS is held high while */
+   /* the transport is suspended so that the controller does not send   */
+   /* before the UART has been restarted.                               */
+   /* * NOTE * This option requires SUPPORT_TRANSPORT_SUSPEND.          */
+#define HCITR_ENABLE_LOW_POWER_STOP
+
    /* Define the following if software managed flow control is being    */
    /* used and the NVIC interrupt for the CTS EXTI line is being also   */
    /* used by another EXTI line.  The specified function can then be    */
@@ -105,6 +210,17 @@
    /* logged via BTPS_OutputMessage().                                  */
 // #define HCITR_ENABLE_DEBUG_LOGGING
 
+   /* HCITR_HOST_SIMULATION is defined (on the compiler command line)   */
+   /* only when HCITRANS is built for the host simulator in             */
+   /* Tools/HCITRSim.  The simulator then selects the transport mode    */
+   /* that is being built and removes the options that need hardware    */
+   /* it does not simulate.                                             */
+#ifdef HCITR_HOST_SIMULATION
+
+#include "HCITRSIMCFG.h"
+
+#endif
+
 
 /************************************************************************/
 /* !!!DO NOT MODIFY PAST THIS POINT!!!                                  */
@@ -163,29 +279,14 @@
 #define HCITR_RESET_GPIO_AHB_BIT       (DEF_CONCAT3(RCC_AHB2ENR_GPIO, HCITR_RESET_PORT, EN))
 
    /* DMA Mapping.                                                      */
-#define HCITR_TXD_DMA_AHB_BIT          (DEF_CONCAT2(RCC_AHB1Periph_DMA, HCITR_DMA_TXD_NUMBER))
-#define HCITR_TXD_DMA_CHANNEL          (DEF_CONCAT2(DMA_Channel_, HCITR_DMA_TXD_CHANNEL))
-#define HCITR_TXD_DMA_STREAM           (DEF_CONCAT2(DEF_CONCAT3(DMA, HCITR_DMA_TXD_NUMBER, _Stream), HCITR_DMA_TXD_STREAM))
-#define HCITR_RXD_DMA_AHB_BIT          (DEF_CONCAT2(RCC_AHB1Periph_DMA, HCITR_DMA_RXD_NUMBER))
-#define HCITR_RXD_DMA_CHANNEL          (DEF_CONCAT2(DMA_Channel_, HCITR_DMA_RXD_CHANNEL))
-#define HCITR_RXD_DMA_STREAM           (DEF_CONCAT2(DEF_CONCAT3(DMA, HCITR_DMA_RXD_NUMBER, _Stream), HCITR_DMA_RXD_STREAM))
-
-#define HCITR_TXD_DMA_FLAG_TCIF        (DEF_CONCAT2(DMA_FLAG_TCIF, HCITR_DMA_TXD_STREAM))
-#define HCITR_TXD_DMA_FLAG_HTIF        (DEF_CONCAT2(DMA_FLAG_HTIF, HCITR_DMA_TXD_STREAM))
-#define HCITR_TXD_DMA_FLAG_TEIF        (DEF_CONCAT2(DMA_FLAG_TEIF, HCITR_DMA_TXD_STREAM))
-#define HCITR_TXD_DMA_FLAG_DMEIF       (DEF_CONCAT2(DMA_FLAG_DMEIF, HCITR_DMA_TXD_STREAM))
-#define HCITR_TXD_DMA_FLAG_FEIF        (DEF_CONCAT2(DMA_FLAG_FEIF, HCITR_DMA_TXD_STREAM))
-
-#define HCITR_RXD_DMA_FLAG_TCIF        (DEF_CONCAT2(DMA_FLAG_TCIF, HCITR_DMA_RXD_STREAM))
-#define HCITR_RXD_DMA_FLAG_HTIF        (DEF_CONCAT2(DMA_FLAG_HTIF, HCITR_DMA_RXD_STREAM))
-#define HCITR_RXD_DMA_FLAG_TEIF        (DEF_CONCAT2(DMA_FLAG_TEIF, HCITR_DMA_RXD_STREAM))
-#define HCITR_RXD_DMA_FLAG_DMEIF       (DEF_CONCAT2(DMA_FLAG_DMEIF, HCITR_DMA_RXD_STREAM))
-#define HCITR_RXD_DMA_FLAG_FEIF        (DEF_CONCAT2(DMA_FLAG_FEIF, HCITR_DMA_RXD_STREAM))
-
-#define HCITR_TXD_IRQ                  (DEF_CONCAT3(DEF_CONCAT3(DMA, HCITR_DMA_TXD_NUMBER, _Stream), HCITR_DMA_TXD_STREAM, _IRQn))
-#define HCITR_RXD_IRQ                  (DEF_CONCAT3(DEF_CONCAT3(DMA, HCITR_DMA_RXD_NUMBER, _Stream), HCITR_DMA_RXD_STREAM, _IRQn))
-#define HCITR_TXD_IRQHandler           (DEF_CONCAT3(DEF_CONCAT3(DMA, HCITR_DMA_TXD_NUMBER, _Stream), HCITR_DMA_TXD_STREAM, _IRQHandler))
-#define HCITR_RXD_IRQHandler           (DEF_CONCAT3(DEF_CONCAT3(DMA, HCITR_DMA_RXD_NUMBER, _Stream), HCITR_DMA_RXD_STREAM, _IRQHandler))
+#define HCITR_TXD_DMA_CHANNEL          (DEF_CONCAT2(DEF_CONCAT3(DMA, HCITR_DMA_TXD_NUMBER, _Channel), HCITR_DMA_TXD_CHANNEL))
+#define HCITR_RXD_DMA_CHANNEL          (DEF_CONCAT2(DEF_CONCAT3(DMA, HCITR_DMA_RXD_NUMBER, _Channel), HCITR_DMA_RXD_CHANNEL))
+
+#define HCITR_TXD_IRQ                  (DEF_CONCAT3(DEF_CONCAT3(DMA, HCITR_DMA_TXD_NUMBER, _Channel), HCITR_DMA_TXD_CHANNEL, _IRQn))
+#define HCITR_RXD_IRQ                  (DEF_CONCAT3(DEF_CONCAT3(DMA, HCITR_DMA_RXD_NUMBER, _Channel), HCITR_DMA_RXD_CHANNEL, _IRQn))
+
+   /* HAL handle of the UART in use (declared in usart.h).              */
+#define HCITR_UART_HANDLE              (DEF_CONCAT2(huart, HCITR_UART))
 
    /* Location of the Data register for the UART in use.                */
 #define HCITR_UART_DR_REGISTER_ADDRESS (((unsigned int)(DEF_CONCAT3(HCITR_UART_TYPE, HCITR_UART, _BASE))) + 4)
@@ -27,7 +27,10 @@
 #include "SS1BTAVR.h"            /* A/V Remote Control Header.                */
 #include "BTPSKRNL.h"            /* BTPS Kernel Header.                       */
 #include "A3DPDemo_SNK.h"        /* Application Header.                       */
+#include "HCITRANS.h"            /* HCI Transport Prototypes/Constants.       */
 #include "AUDIO.h"          /* Audio Abstraction Layer Header.           */
+#include "AUDIOCFG.h"            /* Audio Configuration Header.               */
+#include "LOWPOWER.h"            /* Low Power (STOP2) Idle Header.            */
 
 
 #define MAX_SUPPORTED_COMMANDS                     (30)  /* maximum number of */
@@ -333,6 +336,23 @@ static Byte_t              NumConnected;            /* Number of sources connect
                                                     /* Used to determine if we can     */
                                                     /* become connectable/discoverable.*/
 
+#if AUDIO_SBC_DECODER
+
+#if MAX_SOURCES > AUDIO_STREAM_SOURCES
+#error Every connected source needs a source of the audio stream.
+#endif
+
+static BD_ADDR_t           StreamSources[MAX_SOURCES]; /* Variable which holds the     */
+                                                    /* BD_ADDR of the A2DP SRC that    */
+                                                    /* writes each source of the audio */
+                                                    /* stream.                         */
+
+static Boolean_t           SourcesMixed;            /* Variable which flags whether all*/
+                                                    /* open sources are heard instead  */
+                                                    /* of the active one only.         */
+
+#endif
+
    /* The following table holds the supported Sink formats.             */
 static BTPSCONST AUD_Stream_Format_t AudioSNKSupportedFormats[] =
 {
@@ -371,6 +391,15 @@ static BTPSCONST char *IOCapabilitiesStrings[] =
    "No Input/Output"
 } ;
 
+   /* The following string table is used to map the HCI transport       */
+   /* transmit classes to an easily displayable string.                 */
+static BTPSCONST char *TxClassStrings[] =
+{
+   "SCO/HCILL",
+   "Command",
+   "ACL"
+} ;
+
    /* The following structure is used to hold information of the 		*/
    /* FIRMWARE version.                                                 */
 typedef struct FW_Version_t
@@ -420,6 +449,12 @@ static void DisplayFWVersion (void);
 static void RemoteControlCommandAsync(unsigned int BluetoothStackID, unsigned long CallbackParameter);
 static int QueueRemoteControlCommand(BD_ADDR_t BD_ADDR, RemoteControlCommand_t Command);
 static int QueryMemory(ParameterList_t *TempParam);
+static int TransportStatistics(ParameterList_t *TempParam);
+static int AudioStatistics(ParameterList_t *TempParam);
+static int SnoopCapture(ParameterList_t *TempParam);
+static int MixSources(ParameterList_t *TempParam);
+static int SetVolume(ParameterList_t *TempParam);
+static int MuteAudio(ParameterList_t *TempParam);
 
 
 static int Inquiry(ParameterList_t *TempParam);
@@ -453,6 +488,11 @@ static int StopA3DPStream(void);
 static int OpenA3DPStream(BD_ADDR_t BD_ADDR);
 static int CloseA3DPStream(void);
 static int ReconfigureA3DPStream(AUD_Stream_Format_t *Format);
+#if AUDIO_SBC_DECODER
+static int FindStreamSource(BD_ADDR_t BD_ADDR, Boolean_t Allocate);
+static Boolean_t ReleaseStreamSource(BD_ADDR_t BD_ADDR);
+static void UpdateSourceGains(void);
+#endif
 static void Change_connection_priority(int high_normal, Word_t  ConnHandle);
 
    /* BTPS Callback function prototypes.                                */
@@ -492,6 +532,12 @@ static void UserInterface(void)
    AddCommand("REMOTEPREV", RemotePrev);
    AddCommand("PCMLOOPBACK", PcmLoopback);
    AddCommand("QUERYMEMORY", QueryMemory);
+   AddCommand("TRANSPORTSTATISTICS", TransportStatistics);
+   AddCommand("AUDIOSTATISTICS", AudioStatistics);
+   AddCommand("SNOOPCAPTURE", SnoopCapture);
+   AddCommand("MIXSOURCES", MixSources);
+   AddCommand("SETVOLUME", SetVolume);
+   AddCommand("MUTEAUDIO", MuteAudio);
    /* Next display the available commands.                              */
    DisplayHelp(NULL);
 }
@@ -971,6 +1017,7 @@ static int OpenStack(HCI_DriverInformation_t *HCI_DriverInformation, BTPS_Initia
    HCI_Version_t              HCIVersion;
    unsigned long              ActiveFeatures;
    Class_of_Device_t          ClassOfDevice;
+   HCITR_BootStatistics_t     BootStatistics;
    L2CA_Link_Connect_Params_t L2CA_Link_Connect_Params;
 
    /* First check to see if the Stack has already been opened.          */
@@ -1000,6 +1047,13 @@ static int OpenStack(HCI_DriverInformation_t *HCI_DriverInformation, BTPS_Initia
             BluetoothStackID = Result;
             Display(("Bluetooth Stack ID: %d\r\n", BluetoothStackID));
 
+            /* Show how long the transport took to start the controller */
+            /* (see TransportStatistics for the details).               */
+            if((!HCITR_QueryBootStatistics(&BootStatistics)) && (!BootStatistics.Status))
+               Display(("Controller started in %lu us (%lu baud).\r\n", BootStatistics.TotalTime, BootStatistics.BaudRate));
+            else
+               Display(("Controller start up failed (command 0x%04X, status 0x%02X).\r\n", BootStatistics.FailedOpCode, BootStatistics.FailedStatus));
+
             /* Attempt to enable the A3DP Sink Feature.                 */
             if((Result = BSC_EnableFeature(BluetoothStackID, BSC_FEATURE_A3DP_SINK)) != 0)
                DisplayFunctionError("BSC_EnableFeature()", Result);
@@ -1558,9 +1612,20 @@ static void Change_connection_priority(int high_normal, Word_t  ConnHandle)
 /* * NOTE * Currently, the BCLK is hardcoded at 3.087MHz and the SBC */
 /*          parameters are hardcoded. If these need to be dynamic, a */
 /*          change to AUD will be necessary to expose the SBC        */
-/*          parameters.                                              */
+/*          parameters, or AUDIO_SBC_DECODER can be set so that the  */
+/*          MCU decodes the stream with the parameters of each frame.*/
 static int ReconfigureA3DPStream(AUD_Stream_Format_t *Format)
 {
+#if AUDIO_SBC_DECODER
+
+   Display((" Initialize audio with Sample Freq: %lu\r\n", Format->SampleFrequency));
+
+   /* The SBC frames are decoded by the MCU, which follows the          */
+   /* parameters of each frame.                                         */
+   return(initializeAudio(BluetoothStackID, Format->SampleFrequency));
+
+#else
+
    int AudioFormat;
    int SBCFormat;
    int ret_val;
@@ -1600,6 +1665,8 @@ static int ReconfigureA3DPStream(AUD_Stream_Format_t *Format)
    }
 
    return(ret_val);
+
+#endif
 }
 
 /* This function handles the AUD/GAP/VS commands required to open and*/
@@ -1626,8 +1693,13 @@ static int OpenA3DPStream(BD_ADDR_t BD_ADDR)
          {
             if((ConnHandle > 0) && (ConnHandle < 8))
             {
+#if AUDIO_SBC_DECODER
+               /* The stream is not offloaded to the CC256x.            */
+               ret_val = 0;
+#else
                ret_val = VS_A3DP_Sink_Open_Stream(BluetoothStackID, ConnHandle, StreamChannelInfo.LocalCID);
                Display(("A3DP Open:  %d\r\n", ret_val));
+#endif
             }
             else
                ret_val = FUNCTION_ERROR;
@@ -1665,8 +1737,12 @@ static int CloseA3DPStream(void)
       /* Change the ACL connection priority back to normal, for better Bluetooth scans */
 	  Change_connection_priority(NORMAL_AUDIO_CONNECTION_PRIORITY, 0);
 
+#if AUDIO_SBC_DECODER
+      ret_val = 0;
+#else
       ret_val = VS_A3DP_Sink_Close_Stream(BluetoothStackID);
       Display(("A3DP Close: %d\r\n", ret_val));
+#endif
       uninitializeAUDIO();
 
       /* Set to closed even if an error occurs.                         */
@@ -1694,17 +1770,28 @@ static int StartA3DPStream(BD_ADDR_t BD_ADDR)
       /* this via an asynchronous command because there is a chance we  */
       /* will exceed our stack space.                                   */
 
+#if AUDIO_SBC_DECODER
+      /* Mixed sources keep playing.                                    */
+      if(!COMPARE_NULL_BD_ADDR(A2DPRemoteBD_ADDR) && (A3DPPlaying) && (!SourcesMixed))
+#else
       if(!COMPARE_NULL_BD_ADDR(A2DPRemoteBD_ADDR) && (A3DPPlaying))
+#endif
          QueueRemoteControlCommand(A2DPRemoteBD_ADDR, rcPause);
 
       /* We need to switch over the configuration to use the new CID.   */
       A2DPRemoteBD_ADDR = BD_ADDR;
 
+#if AUDIO_SBC_DECODER
+      /* Every open source is decoded already, so the stream only       */
+      /* cross-fades to the new one.                                    */
+      UpdateSourceGains();
+#else
       if(A3DPPlaying)
          StopA3DPStream();
 
       CloseA3DPStream();
       OpenA3DPStream(BD_ADDR);
+#endif
 
       /* Reset the A3DPPlaying variable to maintain a proper state.     */
       A3DPPlaying = FALSE;
@@ -1712,8 +1799,12 @@ static int StartA3DPStream(BD_ADDR_t BD_ADDR)
 
    if(!A3DPPlaying)
    {
+#if AUDIO_SBC_DECODER
+      ret_val = 0;
+#else
       ret_val = VS_A3DP_Sink_Start_Stream(BluetoothStackID); 
       Display(("A3DP Start: %d\r\n", ret_val));
+#endif
 
       if(ret_val == 0)
       {
@@ -1738,8 +1829,12 @@ static int StopA3DPStream(void)
 
    if(A3DPPlaying)
    {
+#if AUDIO_SBC_DECODER
+      ret_val = 0;
+#else
       ret_val = VS_A3DP_Sink_Stop_Stream(BluetoothStackID);
       Display(("A3DP Stop:  %d\r\n", ret_val));
+#endif
 
       /* Reset regardless of return value.                              */
       A3DPPlaying = FALSE;
@@ -1753,6 +1848,103 @@ static int StopA3DPStream(void)
    return(ret_val);
 }
 
+#if AUDIO_SBC_DECODER
+
+/* The following function returns the source of the audio stream that*/
+/* the specified A2DP SRC writes, and allocates a free one to it if  */
+/* it has none and the second parameter is TRUE.  This function      */
+/* returns the source if successful or a negative value if there is  */
+/* none.                                                             */
+static int FindStreamSource(BD_ADDR_t BD_ADDR, Boolean_t Allocate)
+{
+   int ret_val;
+   int Index;
+
+   for(Index = 0, ret_val = FUNCTION_ERROR; (Index < MAX_SOURCES) && (ret_val < 0); Index++)
+   {
+      if(COMPARE_BD_ADDR(StreamSources[Index], BD_ADDR))
+         ret_val = Index;
+   }
+
+   for(Index = 0; (Allocate) && (Index < MAX_SOURCES) && (ret_val < 0); Index++)
+   {
+      if(COMPARE_NULL_BD_ADDR(StreamSources[Index]))
+      {
+         StreamSources[Index] = BD_ADDR;
+         ret_val              = Index;
+      }
+   }
+
+   return(ret_val);
+}
+
+/* The following function releases the source of the audio stream of */
+/* the specified A2DP SRC, which has closed its stream.  If it was   */
+/* the active SRC another open one becomes active.  The gains of the */
+/* sources that remain are updated either way.  This function        */
+/* returns TRUE if the audio stream continues or FALSE if the active */
+/* SRC closed and no other is open.                                  */
+static Boolean_t ReleaseStreamSource(BD_ADDR_t BD_ADDR)
+{
+   int       Index;
+   Boolean_t ret_val;
+
+   if((Index = FindStreamSource(BD_ADDR, FALSE)) >= 0)
+      ASSIGN_BD_ADDR(StreamSources[Index], 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+
+   if(COMPARE_BD_ADDR(BD_ADDR, A2DPRemoteBD_ADDR))
+   {
+      for(Index = 0; (Index < MAX_SOURCES) && (COMPARE_NULL_BD_ADDR(StreamSources[Index])); Index++)
+         ;
+
+      if(Index < MAX_SOURCES)
+      {
+         Display(("Switching to the remaining A2DP source.\r\n"));
+
+         A2DPRemoteBD_ADDR = StreamSources[Index];
+
+         ret_val = TRUE;
+      }
+      else
+         ret_val = FALSE;
+   }
+   else
+      ret_val = TRUE;
+
+   UpdateSourceGains();
+
+   return(ret_val);
+}
+
+/* The following function sets the gains of the sources of the audio */
+/* stream: either every open source is heard at an equal share (of   */
+/* the sources that are open) or the stream cross-fades to the active*/
+/* source.                                                           */
+static void UpdateSourceGains(void)
+{
+   int Index;
+   int Count;
+
+   if(SourcesMixed)
+   {
+      for(Index = 0, Count = 0; Index < MAX_SOURCES; Index++)
+      {
+         if(!COMPARE_NULL_BD_ADDR(StreamSources[Index]))
+            Count++;
+      }
+
+      for(Index = 0; Index < MAX_SOURCES; Index++)
+         AUDIO_Set_Source_Gain((unsigned int)Index, (COMPARE_NULL_BD_ADDR(StreamSources[Index])) ? 0 : (AUDIO_UNITY_GAIN / Count));
+   }
+   else
+   {
+      if((Index = FindStreamSource(A2DPRemoteBD_ADDR, FALSE)) >= 0)
+         AUDIO_Select_Source((unsigned int)Index);
+   }
+}
+
+#endif
+
 /* The following function is responsible for displaying all available*/
 /* commands to the user. It always returns zero.                     */
 static int DisplayHelp(ParameterList_t *TempParam)
@@ -1769,7 +1961,9 @@ static int DisplayHelp(ParameterList_t *TempParam)
    Display(("*                  GetClassOfDevice, SetClassOfDevice,           *\r\n"));
    Display(("*                  GetRemoteName, OpenSink, CloseSink,           *\r\n"));
    Display(("*                  RemotePlay, RemotePause, RemoteNext,          *\r\n"));
-   Display(("*                  RemotePrev, Help                              *\r\n"));
+   Display(("*                  RemotePrev, QueryMemory, TransportStatistics, *\r\n"));
+   Display(("*                  AudioStatistics, SnoopCapture, MixSources,    *\r\n"));
+   Display(("*                  SetVolume, MuteAudio, Help                    *\r\n"));
    Display(("******************************************************************\r\n"));
    Display(("\r\n"));
    return(0);
@@ -1836,6 +2030,292 @@ static int QueryMemory(ParameterList_t *TempParam)
    return(ret_val);
 }
 
+   /* The following function is responsible for displaying the transfer */
+   /* statistics of the HCI transport (throughput and interrupt counts).*/
+   /* If the first parameter is non-zero the statistics are reset after */
+   /* they are displayed.  This function will return zero on successful */
+   /* execution and a negative value on errors.                         */
+static int TransportStatistics(ParameterList_t *TempParam)
+{
+   HCITR_Statistics_t        Statistics;
+   HCITR_BootStatistics_t    BootStatistics;
+   HCITR_FlowConfiguration_t FlowConfiguration;
+   LOWPOWER_Statistics_t     LowPowerStatistics;
+   Boolean_t                 Reset;
+   int                       ret_val;
+   unsigned int              Class;
+   unsigned int              Bucket;
+
+   Reset = (Boolean_t)((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam));
+
+   /* The HCI transport is always opened with transport ID 1.           */
+   ret_val = HCITR_QueryStatistics(1, &Statistics, Reset);
+   if(!ret_val)
+   {
+      Display(("\r\n"));
+      Display(("Elapsed Time:             %8lu ms\r\n", Statistics.ElapsedTime));
+      Display(("Transmit:\r\n"));
+      Display(("   Bytes:                 %8lu\r\n", Statistics.TxBytes));
+      Display(("   Bytes/Second:          %8lu\r\n", Statistics.TxBytesPerSecond));
+      Display(("   Interrupts:            %8lu\r\n", Statistics.TxInterrupts));
+      Display(("Receive:\r\n"));
+      Display(("   Bytes:                 %8lu\r\n", Statistics.RxBytes));
+      Display(("   Bytes/Second:          %8lu\r\n", Statistics.RxBytesPerSecond));
+      Display(("   Interrupts:            %8lu\r\n", Statistics.RxInterrupts));
+      Display(("   Callbacks:             %8lu\r\n", Statistics.RxCallbacks));
+      Display(("   Event Packets:         %8lu\r\n", Statistics.RxEventPackets));
+      Display(("   ACL Packets:           %8lu\r\n", Statistics.RxACLPackets));
+      Display(("   SCO Packets:           %8lu\r\n", Statistics.RxSCOPackets));
+      Display(("   HCILL Packets:         %8lu\r\n", Statistics.RxHCILLPackets));
+      Display(("   Unknown Bytes:         %8lu\r\n", Statistics.RxUnknownBytes));
+      Display(("   Buffer Size:           %8lu\r\n", Statistics.RxBufferSize));
+      Display(("   High Water Mark:       %8lu\r\n", Statistics.RxHighWaterMark));
+      Display(("   Flow Off Count:        %8lu\r\n", Statistics.RxFlowOffCount));
+      Display(("   Buffer Overruns:       %8lu\r\n", Statistics.RxBufferOverruns));
+      Display(("   UART Overruns:         %8lu\r\n", Statistics.RxUARTOverruns));
+      Display(("   Task Wakeups:          %8lu\r\n", Statistics.RxTaskWakeups));
+      Display(("   Max Task Latency:      %8lu us\r\n", Statistics.RxMaximumLatency));
+
+      if(!HCITR_QueryFlowConfiguration(&FlowConfiguration))
+         Display(("   Flow Off/On Threshold: %8u/%u\r\n", FlowConfiguration.FlowOffThreshold, FlowConfiguration.FlowOnThreshold));
+
+      Display(("Transmit Latency (histogram buckets from <%u us, doubling):\r\n", HCITR_LATENCY_BUCKET_0_LIMIT));
+
+      for(Class = 0; Class < HCITR_NUMBER_TX_CLASSES; Class++)
+      {
+         Display(("   %-10s Packets: %8lu, Bytes: %8lu, Max: %8lu us\r\n", TxClassStrings[Class], Statistics.TxClass[Class].Packets, Statistics.TxClass[Class].Bytes, Statistics.TxClass[Class].MaximumLatency));
+         Display(("             "));
+
+         for(Bucket = 0; Bucket < HCITR_NUMBER_LATENCY_BUCKETS; Bucket++)
+            Display((" %lu", Statistics.TxClass[Class].LatencyHistogram[Bucket]));
+
+         Display(("\r\n"));
+      }
+
+      LOWPOWER_QueryStatistics(&LowPowerStatistics, Reset);
+
+      Display(("Low Power:\r\n"));
+      Display(("   Suspends:              %8lu\r\n", Statistics.Suspends));
+      Display(("   Suspend Aborts:        %8lu\r\n", Statistics.SuspendAborts));
+      Display(("   Controller Wakes:      %8lu\r\n", Statistics.ControllerWakes));
+      Display(("   Host Wakes:            %8lu\r\n", Statistics.HostWakes));
+      Display(("   Sleep Count:           %8lu\r\n", LowPowerStatistics.SleepCount));
+      Display(("   STOP2 Count:           %8lu\r\n", LowPowerStatistics.StopCount));
+      Display(("   STOP2 Time:            %8lu ms\r\n", LowPowerStatistics.StopTime));
+      Display(("   Longest STOP2:         %8lu ms\r\n", LowPowerStatistics.LongestStop));
+
+      if(!HCITR_QueryBootStatistics(&BootStatistics))
+      {
+         Display(("Controller Start Up:\r\n"));
+         Display(("   Reset:                 %8lu us\r\n", BootStatistics.ResetTime));
+         Display(("   Boot (to CTS low):     %8lu us%s\r\n", BootStatistics.BootTime, (BootStatistics.CTSTimeout) ? " (timeout)" : ""));
+         Display(("   Baud Rate Switch:      %8lu us (%lu)\r\n", BootStatistics.BaudRateTime, BootStatistics.BaudRate));
+         Display(("   Init Script:           %8lu us (%lu commands, %lu outstanding)\r\n", BootStatistics.ScriptTime, BootStatistics.ScriptCommands, BootStatistics.MaximumOutstanding));
+         Display(("   Total:                 %8lu us\r\n", BootStatistics.TotalTime));
+
+         if(BootStatistics.Status)
+            Display(("   Failed:                  0x%04X (status 0x%02X)\r\n", BootStatistics.FailedOpCode, BootStatistics.FailedStatus));
+      }
+   }
+   else
+   {
+      Display(("Failed to get transport statistics\r\n"));
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for displaying the          */
+   /* statistics of the SAI1 audio pipeline.  If the first parameter is */
+   /* non-zero the statistics are reset after they are displayed.  This */
+   /* function always returns zero.                                     */
+static int AudioStatistics(ParameterList_t *TempParam)
+{
+   AUDIO_Statistics_t Statistics;
+
+   AUDIO_Query_Statistics(&Statistics, ((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam)));
+
+   Display(("\r\n"));
+   Display(("Sample Rate:              %8lu Hz\r\n", Statistics.SampleRate));
+   Display(("Clock Error:              %8ld ppb\r\n", Statistics.ClockError));
+   Display(("Period:                   %8u frames (%lu us)\r\n", Statistics.PeriodFrames, Statistics.PeriodTime));
+   Display(("Periods Processed:        %8lu\r\n", Statistics.Periods));
+   Display(("Max Process Time:         %8lu us\r\n", Statistics.MaximumProcessTime));
+   Display(("Underruns:                %8lu\r\n", Statistics.Underruns));
+   Display(("FIFO Underruns:           %8lu\r\n", Statistics.FIFOUnderruns));
+   Display(("FIFO Overruns:            %8lu\r\n", Statistics.FIFOOverruns));
+   Display(("Transfer Errors:          %8lu\r\n", Statistics.TransferErrors));
+
+   if(Statistics.StreamRate)
+   {
+      Display(("Stream Source:            %8u\r\n", Statistics.StreamSource));
+      Display(("Stream Rate:              %8lu Hz\r\n", Statistics.StreamRate));
+      Display(("Stream Frames:            %8lu\r\n", Statistics.StreamFrames));
+      Display(("Stream Depth:             %8u frames (%lu ms)\r\n", Statistics.StreamDepth, (Statistics.StreamDepth * 1000UL) / Statistics.StreamRate));
+      Display(("Stream Target Depth:      %8u frames (%lu ms)\r\n", Statistics.StreamTargetDepth, (Statistics.StreamTargetDepth * 1000UL) / Statistics.StreamRate));
+      Display(("Stream Jitter:            %8u frames (%lu ms)\r\n", Statistics.StreamJitter, (Statistics.StreamJitter * 1000UL) / Statistics.StreamRate));
+      Display(("Stream Underruns:         %8lu\r\n", Statistics.StreamUnderruns));
+      Display(("Stream Concealed Frames:  %8lu\r\n", Statistics.StreamConcealedFrames));
+      Display(("Stream Late Writes:       %8lu\r\n", Statistics.StreamLate));
+      Display(("Stream Overruns:          %8lu\r\n", Statistics.StreamOverruns));
+      Display(("Rate Correction:          %8ld ppb\r\n", Statistics.Correction));
+   }
+
+   if((Statistics.DecodedFrames) || (Statistics.DecodeErrors))
+   {
+      Display(("SBC Frames Decoded:       %8lu\r\n", Statistics.DecodedFrames));
+      Display(("SBC Decode Errors:        %8lu\r\n", Statistics.DecodeErrors));
+      Display(("SBC Decode Cycles:        %8lu per frame (max %lu)\r\n", Statistics.DecodeCycles, Statistics.MaximumDecodeCycles));
+   }
+
+   if((Statistics.MicrophoneSlips) || (Statistics.MicrophoneResyncs))
+   {
+      Display(("Microphone Slips:         %8lu\r\n", Statistics.MicrophoneSlips));
+      Display(("Microphone Resyncs:       %8lu\r\n", Statistics.MicrophoneResyncs));
+   }
+
+   return(0);
+}
+
+   /* The following function is responsible for starting and stopping a */
+   /* btsnoop capture of the HCI traffic to the SD card.  The first     */
+   /* parameter is 1 to start and 0 to stop the capture and the optional*/
+   /* second parameter is the name of the capture file.  This function  */
+   /* will return zero on successful execution and a negative value on  */
+   /* errors.                                                           */
+static int SnoopCapture(ParameterList_t *TempParam)
+{
+   HCITR_CaptureStatistics_t Statistics;
+   char                     *FileName;
+   int                       ret_val;
+
+   if((TempParam) && (TempParam->NumberofParameters > 0))
+   {
+      if(TempParam->Params[0].intParam)
+      {
+         FileName = (TempParam->NumberofParameters > 1) ? TempParam->Params[1].strParam : "BTSNOOP.LOG";
+
+         if(!(ret_val = HCITR_StartCapture(FileName)))
+            Display(("Capturing to %s.\r\n", FileName));
+         else
+            DisplayFunctionError("HCITR_StartCapture", ret_val);
+      }
+      else
+      {
+         if(!(ret_val = HCITR_StopCapture(&Statistics)))
+         {
+            Display(("Capture stopped.\r\n"));
+            Display(("   Packets:               %8lu\r\n", Statistics.Packets));
+            Display(("   Dropped Packets:       %8lu\r\n", Statistics.DroppedPackets));
+            Display(("   Bytes Written:         %8lu\r\n", Statistics.BytesWritten));
+            Display(("   Write Errors:          %8lu\r\n", Statistics.WriteErrors));
+         }
+         else
+            DisplayFunctionError("HCITR_StopCapture", ret_val);
+      }
+   }
+   else
+   {
+      DisplayUsage("SnoopCapture [Start (1) / Stop (0)] [File Name (optional)]");
+
+      ret_val = INVALID_PARAMETERS_ERROR;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for selecting whether the   */
+   /* open A2DP sources are mixed (the first parameter is 1) or only the*/
+   /* active source is heard (0).  The sources can only be mixed when   */
+   /* the MCU decodes them (AUDIO_SBC_DECODER), the A3DP offload of the */
+   /* CC256x decodes a single stream.  This function will return zero on*/
+   /* successful execution and a negative value on errors.              */
+static int MixSources(ParameterList_t *TempParam)
+{
+   int ret_val;
+
+#if AUDIO_SBC_DECODER
+
+   if((TempParam) && (TempParam->NumberofParameters > 0))
+   {
+      SourcesMixed = (Boolean_t)(TempParam->Params[0].intParam != 0);
+
+      if(A3DPOpened)
+         UpdateSourceGains();
+
+      Display(("%s.\r\n", (SourcesMixed) ? "Mixing the A2DP sources" : "Playing the active A2DP source"));
+
+      ret_val = 0;
+   }
+   else
+   {
+      DisplayUsage("MixSources [Mix (1) / Active Source (0)]");
+
+      ret_val = INVALID_PARAMETERS_ERROR;
+   }
+
+#else
+
+   Display(("The sources can only be mixed with AUDIO_SBC_DECODER.\r\n"));
+
+   ret_val = FUNCTION_ERROR;
+
+#endif
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for setting the volume of   */
+   /* the audio output to the AVRCP absolute volume given as the first  */
+   /* parameter (0, muted, to 127).  The output ramps to the new        */
+   /* volume.  This function will return zero on successful execution   */
+   /* and a negative value on errors.                                   */
+static int SetVolume(ParameterList_t *TempParam)
+{
+   int ret_val;
+
+   if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam >= 0) && (TempParam->Params[0].intParam <= AUDIO_MAXIMUM_ABSOLUTE_VOLUME))
+   {
+      if(!AUDIO_Set_Absolute_Volume((unsigned int)TempParam->Params[0].intParam))
+      {
+         Display(("Volume set to %d (%d%%).\r\n", AUDIO_Get_Absolute_Volume(), AUDIO_Get_Volume()));
+
+         ret_val = 0;
+      }
+      else
+         ret_val = FUNCTION_ERROR;
+   }
+   else
+   {
+      DisplayUsage("SetVolume [Absolute Volume (0 - 127)]");
+
+      ret_val = INVALID_PARAMETERS_ERROR;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for muting the audio output */
+   /* if it is playing or un-muting it if it is muted.  The output fades*/
+   /* out (or in) while the stream keeps playing.  This function will   */
+   /* return zero on successful execution and a negative value on       */
+   /* errors.                                                           */
+static int MuteAudio(ParameterList_t *TempParam)
+{
+   int ret_val;
+
+   if(!pauseResumeAudio())
+      ret_val = 0;
+   else
+   {
+      Display(("Audio is not playing.\r\n"));
+
+      ret_val = FUNCTION_ERROR;
+   }
+
+   return(ret_val);
+}
+
 /* The following function is an asynchronous callback to handle      */
 /* calling into the SendRemoteControlCommand function, in cases where*/
 /* we are too deep into the call stack to call it directly.          */
@@ -2985,6 +3465,9 @@ static int GetLocalAddress(ParameterList_t *TempParam)
 /* current Baud Rate used to talk to the Radio.                      */
 /* * NOTE * This function ONLY configures the Baud Rate for a TI     */
 /*          Bluetooth chipset.                                       */
+/* * NOTE * VS_Update_UART_Baud_Rate() reconfigures the HCI driver   */
+/*          once the chipset has accepted the new rate, which in turn*/
+/*          switches the local UART (see HCITR_COMReconfigure()).    */
 static int SetBaudRate(ParameterList_t *TempParam)
 {
    int ret_val;
@@ -3006,14 +3489,14 @@ static int SetBaudRate(ParameterList_t *TempParam)
          else
          {
             /* Unable to write vendor specific command to chipset.      */
-            Display(("VS_Update_UART_Baud_Rate(%lu): Failure %d, %d.\r\n", TempParam->Params[0].intParam, ret_val));
+            Display(("VS_Update_UART_Baud_Rate(%lu): Failure %d.\r\n", TempParam->Params[0].intParam, ret_val));
 
             ret_val = FUNCTION_ERROR;
          }
       }
       else
       {
-         DisplayUsage("SetBaudRate [BaudRate]");
+         DisplayUsage("SetBaudRate [BaudRate (115200 - 3000000)]");
 
          ret_val = INVALID_PARAMETERS_ERROR;
       }
@@ -3170,6 +3653,9 @@ static int PcmLoopback(ParameterList_t *TempParam)
 static void BTPSAPI AUD_Event_Callback(unsigned int BluetoothStackID, AUD_Event_Data_t *AUD_Event_Data, unsigned long CallbackParameter)
 {
    Byte_t StatusResult;
+#if AUDIO_SBC_DECODER
+   int    Index;
+#endif
 
    if((BluetoothStackID) && (AUD_Event_Data))
    {
@@ -3194,6 +3680,21 @@ static void BTPSAPI AUD_Event_Callback(unsigned int BluetoothStackID, AUD_Event_
             /* Attempt to become master (not critical if we don't).     */
             HCI_Switch_Role(BluetoothStackID, AUD_Event_Data->Event_Data.AUD_Stream_Open_Indication_Data->BD_ADDR, HCI_ROLE_SWITCH_BECOME_MASTER, &StatusResult);
 
+#if AUDIO_SBC_DECODER
+            /* Every open source is decoded into its own source of the  */
+            /* audio stream, so a source that opens while another one   */
+            /* plays is only added to the mixer (it becomes active when */
+            /* it starts).                                              */
+            FindStreamSource(AUD_Event_Data->Event_Data.AUD_Stream_Open_Indication_Data->BD_ADDR, TRUE);
+
+            if(!A3DPOpened)
+            {
+               A2DPRemoteBD_ADDR = AUD_Event_Data->Event_Data.AUD_Stream_Open_Indication_Data->BD_ADDR;
+               OpenA3DPStream(AUD_Event_Data->Event_Data.AUD_Stream_Open_Indication_Data->BD_ADDR);
+            }
+
+            UpdateSourceGains();
+#else
             if(A3DPOpened)
             {
                /* Close and stop any active A3DP streams since we must  */
@@ -3208,6 +3709,7 @@ static void BTPSAPI AUD_Event_Callback(unsigned int BluetoothStackID, AUD_Event_
             /* Set this BD_ADDR as being active, and set up the stream. */
             A2DPRemoteBD_ADDR = AUD_Event_Data->Event_Data.AUD_Stream_Open_Indication_Data->BD_ADDR;
             OpenA3DPStream(AUD_Event_Data->Event_Data.AUD_Stream_Open_Indication_Data->BD_ADDR);
+#endif
 
             NumConnected++;
 
@@ -3229,6 +3731,10 @@ static void BTPSAPI AUD_Event_Callback(unsigned int BluetoothStackID, AUD_Event_
             Display(("StreamType:       %d\r\n", AUD_Event_Data->Event_Data.AUD_Stream_Close_Indication_Data->StreamType));
             Display(("DisconnectReason: %d\r\n", AUD_Event_Data->Event_Data.AUD_Stream_Close_Indication_Data->DisconnectReason));
 
+#if AUDIO_SBC_DECODER
+            /* The audio stream continues if another source is open.    */
+            if(!ReleaseStreamSource(AUD_Event_Data->Event_Data.AUD_Stream_Close_Indication_Data->BD_ADDR))
+#endif
             if(COMPARE_BD_ADDR(AUD_Event_Data->Event_Data.AUD_Stream_Close_Indication_Data->BD_ADDR, A2DPRemoteBD_ADDR))
             {
                /* Check to see if this was a requested disconnect.      */
@@ -3316,10 +3822,17 @@ static void BTPSAPI AUD_Event_Callback(unsigned int BluetoothStackID, AUD_Event_
             }
             break;
          case etAUD_Encoded_Audio_Data_Indication:
+#if AUDIO_SBC_DECODER
+            /* Every open source is decoded, the mixer selects which    */
+            /* are heard.                                               */
+            if((Index = FindStreamSource(AUD_Event_Data->Event_Data.AUD_Encoded_Audio_Data_Indication_Data->BD_ADDR, FALSE)) >= 0)
+               AUDIO_Write_SBC((unsigned int)Index, AUD_Event_Data->Event_Data.AUD_Encoded_Audio_Data_Indication_Data->RawAudioDataFrameLength, AUD_Event_Data->Event_Data.AUD_Encoded_Audio_Data_Indication_Data->RawAudioDataFrame);
+#else
             BD_ADDRToStr(AUD_Event_Data->Event_Data.AUD_Encoded_Audio_Data_Indication_Data->BD_ADDR, Callback_BoardStr);
             Display(("etAUD_Encoded_Audio_Data_Indication\r\n"));
             Display(("BD_ADDR:  %s\r\n", Callback_BoardStr));
             Display(("Length:   %d\r\n", AUD_Event_Data->Event_Data.AUD_Encoded_Audio_Data_Indication_Data->RawAudioDataFrameLength));
+#endif
             break;
          case etAUD_Signalling_Channel_Open_Indication:
             BD_ADDRToStr(AUD_Event_Data->Event_Data.AUD_Signalling_Channel_Open_Indication_Data->BD_ADDR, Callback_BoardStr);
@@ -0,0 +1,195 @@
+/*****< hcih4.c >**************************************************************/
+/*                                                                            */
+/*  HCIH4 - H4 (UART) packet framing for the HCI Transport Layer.             */
+/*                                                                            */
+/******************************************************************************/
+
+#include <string.h>
+
+#include "HCIH4.h"          /* HCI Transport H4 Framing Prototypes/Constants. */
+
+   /* The following constants represent the length of the header (not   */
+   /* including the packet indicator) of each of the H4 packet types.   */
+#define COMMAND_HEADER_LENGTH    3
+#define ACL_HEADER_LENGTH        4
+#define SCO_HEADER_LENGTH        3
+#define EVENT_HEADER_LENGTH      2
+
+   /* Local Function Prototypes.                                        */
+static unsigned char RingByte(HCIRING_Ring_t *Ring, unsigned int Offset);
+
+   /* The following function returns the byte at the specified offset   */
+   /* from the OutIndex of the specified ring.                          */
+static unsigned char RingByte(HCIRING_Ring_t *Ring, unsigned int Offset)
+{
+   Offset += Ring->OutIndex;
+   if(Offset >= Ring->Size)
+      Offset -= Ring->Size;
+
+   return(Ring->Buffer[Offset]);
+}
+
+   /* The following function initializes the specified framer.  The     */
+   /* second parameter specifies the largest packet that is passed up in*/
+   /* one piece (and the size of the mirror region of the ring).        */
+void HCIH4_Initialize(HCIH4_Framer_t *Framer, unsigned int MaxFrameLength)
+{
+   if(Framer)
+   {
+      memset(Framer, 0, sizeof(HCIH4_Framer_t));
+
+      Framer->State          = h4sPacketType;
+      Framer->MaxFrameLength = MaxFrameLength;
+   }
+}
+
+   /* The following function examines the data that is waiting in the   */
+   /* specified ring and returns the length of the next piece of data   */
+   /* that can be passed to the upper layer, or zero if no complete     */
+   /* packet is available yet.  The data always starts at the OutIndex  */
+   /* of the ring and the third parameter receives a pointer to it.     */
+unsigned int HCIH4_GetFrame(HCIH4_Framer_t *Framer, HCIRING_Ring_t *Ring, unsigned char **Data)
+{
+   unsigned int  Length;
+   unsigned int  Pending;
+   unsigned int  Wrapped;
+   unsigned int  PayloadLength;
+   unsigned char PacketType;
+
+   Length  = 0;
+   Pending = Ring->Size - Ring->BytesFree;
+
+   /* Parse as much of the current packet as has been received.  The    */
+   /* parsed count is relative to the OutIndex, which always points to  */
+   /* the start of the current packet.                                  */
+   while((!Length) && (Framer->State != h4sStream) && (Framer->Parsed < Pending))
+   {
+      switch(Framer->State)
+      {
+         case h4sPacketType:
+            PacketType            = RingByte(Ring, 0);
+            Framer->Parsed        = 1;
+            Framer->HeaderCount   = 0;
+            Framer->State         = h4sHeader;
+
+            switch(PacketType)
+            {
+               case HCIH4_PACKET_TYPE_COMMAND:
+                  Framer->PacketClass  = h4cCommand;
+                  Framer->HeaderLength = COMMAND_HEADER_LENGTH;
+                  break;
+               case HCIH4_PACKET_TYPE_ACL:
+                  Framer->PacketClass  = h4cACL;
+                  Framer->HeaderLength = ACL_HEADER_LENGTH;
+                  break;
+               case HCIH4_PACKET_TYPE_SCO:
+                  Framer->PacketClass  = h4cSCO;
+                  Framer->HeaderLength = SCO_HEADER_LENGTH;
+                  break;
+               case HCIH4_PACKET_TYPE_EVENT:
+                  Framer->PacketClass  = h4cEvent;
+                  Framer->HeaderLength = EVENT_HEADER_LENGTH;
+                  break;
+               case HCIH4_HCILL_GO_TO_SLEEP_IND:
+               case HCIH4_HCILL_GO_TO_SLEEP_ACK:
+               case HCIH4_HCILL_WAKE_UP_IND:
+               case HCIH4_HCILL_WAKE_UP_ACK:
+                  /* HCILL messages consist of the indicator only.      */
+                  Framer->PacketClass  = h4cHCILL;
+                  Framer->PacketLength = 1;
+                  Framer->State        = h4sPayload;
+                  break;
+               default:
+                  /* Not a known packet indicator, pass the byte up on  */
+                  /* its own and let the upper layer deal with it.      */
+                  Framer->PacketClass  = h4cUnknown;
+                  Framer->PacketLength = 1;
+                  Framer->State        = h4sPayload;
+                  break;
+            }
+            break;
+         case h4sHeader:
+            Framer->Header[Framer->HeaderCount++] = RingByte(Ring, Framer->Parsed++);
+
+            if(Framer->HeaderCount == Framer->HeaderLength)
+            {
+               /* The payload length is the last field of the header,   */
+               /* which is two bytes for ACL packets.                   */
+               if(Framer->PacketClass == h4cACL)
+                  PayloadLength = (unsigned int)Framer->Header[2] | ((unsigned int)Framer->Header[3] << 8);
+               else
+                  PayloadLength = Framer->Header[Framer->HeaderLength - 1];
+
+               Framer->PacketLength = 1 + Framer->HeaderLength + PayloadLength;
+
+               if(Framer->PacketLength <= Framer->MaxFrameLength)
+                  Framer->State = h4sPayload;
+               else
+               {
+                  /* The packet is too large to be held in one piece,   */
+                  /* pass it up as it arrives.                          */
+                  Framer->PacketCount[Framer->PacketClass]++;
+                  Framer->ByteCount[Framer->PacketClass] += Framer->PacketLength;
+                  Framer->StreamCount++;
+
+                  Framer->Remaining = Framer->PacketLength;
+                  Framer->State     = h4sStream;
+               }
+            }
+            break;
+         case h4sPayload:
+         default:
+            /* Skip over the payload that has been received.            */
+            Framer->Parsed = (Pending < Framer->PacketLength) ? Pending : Framer->PacketLength;
+            break;
+      }
+
+      if((Framer->State == h4sPayload) && (Framer->Parsed == Framer->PacketLength))
+         Length = Framer->PacketLength;
+   }
+
+   if(Length)
+   {
+      Framer->PacketCount[Framer->PacketClass]++;
+      Framer->ByteCount[Framer->PacketClass] += Length;
+
+      /* If the packet wraps the end of the ring, copy the wrapped part */
+      /* to the mirror region so that the packet is contiguous.         */
+      Wrapped = Ring->OutIndex + Length;
+      if(Wrapped > Ring->Size)
+      {
+         Wrapped -= Ring->Size;
+
+         memcpy(&(Ring->Buffer[Ring->Size]), Ring->Buffer, Wrapped);
+
+         Framer->MirrorCount++;
+      }
+
+      Framer->State  = h4sPacketType;
+      Framer->Parsed = 0;
+   }
+   else
+   {
+      if(Framer->State == h4sStream)
+      {
+         /* Pass up whatever of the packet can be read contiguously.    */
+         Length = Framer->Remaining;
+         if(Length > Pending)
+            Length = Pending;
+         if(Length > (Ring->Size - Ring->OutIndex))
+            Length = Ring->Size - Ring->OutIndex;
+
+         Framer->Remaining -= Length;
+         if(!Framer->Remaining)
+         {
+            Framer->State  = h4sPacketType;
+            Framer->Parsed = 0;
+         }
+      }
+   }
+
+   if(Data)
+      *Data = &(Ring->Buffer[Ring->OutIndex]);
+
+   return(Length);
+}
@@ -0,0 +1,328 @@
+/*****< hciinit.c >************************************************************/
+/*                                                                            */
+/*  HCIINIT - Controller initialization script loader for the HCI Transport   */
+/*            Layer.                                                          */
+/*                                                                            */
+/******************************************************************************/
+
+#include <string.h>
+
+#include "HCIINIT.h"        /* HCI Init Script Loader Prototypes/Constants.   */
+#include "HCIH4.h"          /* HCI Transport H4 Framing Prototypes/Constants. */
+
+   /* The following constants represent the length of the header (not   */
+   /* including the packet indicator) of each of the H4 packet types.   */
+#define COMMAND_HEADER_LENGTH    3
+#define ACL_HEADER_LENGTH        4
+#define SCO_HEADER_LENGTH        3
+#define EVENT_HEADER_LENGTH      2
+
+   /* The following constants represent the event codes and the minimum */
+   /* parameter lengths of the Command Complete and Command Status      */
+   /* events.                                                           */
+#define EVENT_COMMAND_COMPLETE   0x0E
+#define EVENT_COMMAND_STATUS     0x0F
+
+#define COMMAND_COMPLETE_LENGTH  3
+#define COMMAND_STATUS_LENGTH    4
+
+   /* The following constants represent the states of the baud rate     */
+   /* command.                                                          */
+#define BAUD_RATE_NONE           0
+#define BAUD_RATE_PENDING        1
+#define BAUD_RATE_SENT           2
+
+   /* Local Function Prototypes.                                        */
+static unsigned short GetOpCode(const unsigned char *Command);
+static unsigned int ProcessEvent(HCIINIT_Loader_t *Loader);
+
+   /* The following function returns the opcode of the specified H4     */
+   /* command packet.                                                   */
+static unsigned short GetOpCode(const unsigned char *Command)
+{
+   return((unsigned short)(Command[1] | (Command[2] << 8)));
+}
+
+   /* The following function processes the event that has been received */
+   /* into the header buffer of the specified loader.  Only the Command */
+   /* Complete and Command Status events are of interest, they return   */
+   /* the credits and complete the oldest outstanding command.  This    */
+   /* function returns the actions that the caller must perform.        */
+static unsigned int ProcessEvent(HCIINIT_Loader_t *Loader)
+{
+   unsigned int   ret_val;
+   unsigned int   Credits;
+   unsigned short OpCode;
+   unsigned char  Status;
+
+   ret_val = 0;
+   Credits = 0;
+   OpCode  = 0;
+   Status  = 0;
+
+   if((Loader->Header[0] == EVENT_COMMAND_COMPLETE) && (Loader->Header[1] >= COMMAND_COMPLETE_LENGTH))
+   {
+      Credits = Loader->Header[2];
+      OpCode  = (unsigned short)(Loader->Header[3] | (Loader->Header[4] << 8));
+      Status  = (unsigned char)((Loader->Header[1] > COMMAND_COMPLETE_LENGTH) ? Loader->Header[5] : 0);
+
+      ret_val = HCIINIT_ACTION_PROGRESS;
+   }
+   else
+   {
+      if((Loader->Header[0] == EVENT_COMMAND_STATUS) && (Loader->Header[1] >= COMMAND_STATUS_LENGTH))
+      {
+         Status  = Loader->Header[2];
+         Credits = Loader->Header[3];
+         OpCode  = (unsigned short)(Loader->Header[4] | (Loader->Header[5] << 8));
+
+         ret_val = HCIINIT_ACTION_PROGRESS;
+      }
+   }
+
+   if(ret_val)
+   {
+      Loader->Credits = Credits;
+
+      /* An opcode of zero only returns credits, anything else          */
+      /* completes the oldest outstanding command.                      */
+      if((OpCode) && (Loader->Outstanding))
+      {
+         Loader->Outstanding--;
+         Loader->CommandsCompleted++;
+
+         if(Status)
+         {
+            if(Loader->State == hisRunning)
+            {
+               Loader->State        = hisFailed;
+               Loader->FailedOpCode = OpCode;
+               Loader->FailedStatus = Status;
+            }
+         }
+         else
+         {
+            if((OpCode == HCIINIT_OPCODE_UPDATE_UART_HCI_BAUDRATE) && (Loader->BaudRateCommandState == BAUD_RATE_SENT))
+            {
+               Loader->BaudRateCommandState = BAUD_RATE_NONE;
+
+               ret_val |= HCIINIT_ACTION_CHANGE_BAUD_RATE;
+            }
+         }
+
+         if((Loader->State == hisRunning) && (Loader->BaudRateCommandState == BAUD_RATE_NONE) && (Loader->Offset >= Loader->ScriptLength) && (!Loader->Outstanding))
+            Loader->State = hisComplete;
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function checks that the specified script consists  */
+   /* only of complete HCI command packets.  This function returns the  */
+   /* number of commands in the script or a negative value if the       */
+   /* script is not valid.                                              */
+long HCIINIT_CheckScript(const unsigned char *Script, unsigned long Length)
+{
+   long          ret_val;
+   unsigned long Offset;
+
+   ret_val = 0;
+   Offset  = 0;
+
+   while((ret_val >= 0) && (Offset < Length))
+   {
+      if((Script[Offset] == HCIH4_PACKET_TYPE_COMMAND) && ((Length - Offset) >= (1 + COMMAND_HEADER_LENGTH)) && ((Length - Offset) >= (unsigned long)(1 + COMMAND_HEADER_LENGTH + Script[Offset + 3])))
+      {
+         Offset += 1 + COMMAND_HEADER_LENGTH + Script[Offset + 3];
+
+         ret_val++;
+      }
+      else
+         ret_val = -1;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function initializes the specified loader with the  */
+   /* specified script (which may be NULL if only the baud rate is to be*/
+   /* changed).  If the final parameter is not zero the first command   */
+   /* is HCI_VS_Update_UART_HCI_Baudrate to the specified baud rate and */
+   /* no other command is handed out until it has completed.  The loader*/
+   /* starts with one command credit.                                   */
+void HCIINIT_Initialize(HCIINIT_Loader_t *Loader, const unsigned char *Script, unsigned long Length, unsigned long BaudRate)
+{
+   if(Loader)
+   {
+      memset(Loader, 0, sizeof(HCIINIT_Loader_t));
+
+      Loader->Script       = Script;
+      Loader->ScriptLength = (Script) ? Length : 0;
+      Loader->State        = hisRunning;
+      Loader->Credits      = 1;
+
+      if(BaudRate)
+      {
+         Loader->BaudRateCommand[0]   = HCIH4_PACKET_TYPE_COMMAND;
+         Loader->BaudRateCommand[1]   = (unsigned char)(HCIINIT_OPCODE_UPDATE_UART_HCI_BAUDRATE & 0xFF);
+         Loader->BaudRateCommand[2]   = (unsigned char)(HCIINIT_OPCODE_UPDATE_UART_HCI_BAUDRATE >> 8);
+         Loader->BaudRateCommand[3]   = 4;
+         Loader->BaudRateCommand[4]   = (unsigned char)(BaudRate);
+         Loader->BaudRateCommand[5]   = (unsigned char)(BaudRate >> 8);
+         Loader->BaudRateCommand[6]   = (unsigned char)(BaudRate >> 16);
+         Loader->BaudRateCommand[7]   = (unsigned char)(BaudRate >> 24);
+
+         Loader->BaudRateCommandState = BAUD_RATE_PENDING;
+      }
+      else
+      {
+         /* There is nothing to do for an empty script.                 */
+         if(!Loader->ScriptLength)
+            Loader->State = hisComplete;
+      }
+   }
+}
+
+   /* The following function returns the length of the next command to  */
+   /* send, or zero if no command can be sent until more credits are    */
+   /* returned (or the loader has finished).  The second parameter      */
+   /* receives a pointer to the command.  The command is counted as     */
+   /* outstanding when it is returned, so it MUST be sent.              */
+unsigned int HCIINIT_GetCommand(HCIINIT_Loader_t *Loader, const unsigned char **Command)
+{
+   unsigned int ret_val;
+
+   ret_val = 0;
+
+   if((Loader->State == hisRunning) && (Loader->Credits) && (Loader->BaudRateCommandState != BAUD_RATE_SENT))
+   {
+      if(Loader->BaudRateCommandState == BAUD_RATE_PENDING)
+      {
+         /* The baud rate is changed by itself, so wait for anything    */
+         /* that is still outstanding first.                            */
+         if(!Loader->Outstanding)
+         {
+            Loader->BaudRateCommandState = BAUD_RATE_SENT;
+
+            *Command = Loader->BaudRateCommand;
+            ret_val  = HCIINIT_BAUD_RATE_COMMAND_LENGTH;
+         }
+      }
+      else
+      {
+         /* Skip any baud rate changes in the script, then hand out the */
+         /* next command.  The script has been checked by the caller    */
+         /* (see HCIINIT_CheckScript()).                                */
+         while((!ret_val) && (Loader->Offset < Loader->ScriptLength))
+         {
+            ret_val         = 1 + COMMAND_HEADER_LENGTH + Loader->Script[Loader->Offset + 3];
+            *Command        = &(Loader->Script[Loader->Offset]);
+            Loader->Offset += ret_val;
+
+            if(GetOpCode(*Command) == HCIINIT_OPCODE_UPDATE_UART_HCI_BAUDRATE)
+            {
+               Loader->CommandsSkipped++;
+
+               ret_val = 0;
+            }
+         }
+
+         /* The script may have ended with skipped commands.            */
+         if((!ret_val) && (!Loader->Outstanding))
+            Loader->State = hisComplete;
+      }
+
+      if(ret_val)
+      {
+         Loader->Credits--;
+         Loader->Outstanding++;
+         Loader->CommandsSent++;
+
+         if(Loader->Outstanding > Loader->MaximumOutstanding)
+            Loader->MaximumOutstanding = Loader->Outstanding;
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function parses the specified data that has been    */
+   /* received from the controller (in pieces of any size) and returns  */
+   /* the actions (a bit mask of HCIINIT_ACTION_xxx constants) that the */
+   /* caller must perform.                                              */
+unsigned int HCIINIT_ProcessData(HCIINIT_Loader_t *Loader, unsigned int Length, const unsigned char *Data)
+{
+   unsigned int  ret_val;
+   unsigned char Byte;
+
+   ret_val = 0;
+
+   while(Length--)
+   {
+      Byte = *(Data++);
+
+      if(!Loader->PacketType)
+      {
+         /* Anything that does not start a packet (i.e. the single byte */
+         /* HCILL messages) is ignored.                                 */
+         switch(Byte)
+         {
+            case HCIH4_PACKET_TYPE_ACL:
+               Loader->HeaderLength = ACL_HEADER_LENGTH;
+               break;
+            case HCIH4_PACKET_TYPE_SCO:
+               Loader->HeaderLength = SCO_HEADER_LENGTH;
+               break;
+            case HCIH4_PACKET_TYPE_EVENT:
+               Loader->HeaderLength = EVENT_HEADER_LENGTH;
+               break;
+            default:
+               Loader->HeaderLength = 0;
+               break;
+         }
+
+         if(Loader->HeaderLength)
+         {
+            Loader->PacketType   = Byte;
+            Loader->PacketLength = 0;
+            Loader->Count        = 0;
+         }
+      }
+      else
+      {
+         /* Only the start of each packet is kept, which holds all of   */
+         /* the fields of the events that are processed.                */
+         if(Loader->Count < sizeof(Loader->Header))
+            Loader->Header[Loader->Count] = Byte;
+
+         Loader->Count++;
+
+         if(Loader->Count == Loader->HeaderLength)
+         {
+            switch(Loader->PacketType)
+            {
+               case HCIH4_PACKET_TYPE_ACL:
+                  Loader->PacketLength = ACL_HEADER_LENGTH + (Loader->Header[2] | (Loader->Header[3] << 8));
+                  break;
+               case HCIH4_PACKET_TYPE_SCO:
+                  Loader->PacketLength = SCO_HEADER_LENGTH + Loader->Header[2];
+                  break;
+               default:
+                  Loader->PacketLength = EVENT_HEADER_LENGTH + Loader->Header[1];
+                  break;
+            }
+         }
+
+         if((Loader->PacketLength) && (Loader->Count == Loader->PacketLength))
+         {
+            if(Loader->PacketType == HCIH4_PACKET_TYPE_EVENT)
+               ret_val |= ProcessEvent(Loader);
+
+            Loader->PacketType = 0;
+         }
+      }
+   }
+
+   return(ret_val);
+}
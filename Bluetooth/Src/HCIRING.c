@@ -0,0 +1,123 @@
+/*****< hciring.c >************************************************************/
+/*                                                                            */
+/*  HCIRING - Receive ring bookkeeping for the HCI Transport Layer.           */
+/*                                                                            */
+/******************************************************************************/
+
+#include "HCIRING.h"        /* HCI Transport Ring Prototypes/Constants.       */
+
+   /* The following function initializes the specified ring to use the  */
+   /* specified buffer of the specified size.  The ring is empty upon   */
+   /* return.                                                           */
+void HCIRING_Initialize(HCIRING_Ring_t *Ring, unsigned char *Buffer, unsigned int Size)
+{
+   if((Ring) && (Buffer) && (Size))
+   {
+      Ring->Buffer       = Buffer;
+      Ring->Size         = Size;
+      Ring->InIndex      = 0;
+      Ring->OutIndex     = 0;
+      Ring->BytesFree    = Size;
+      Ring->OverrunCount = 0;
+   }
+}
+
+   /* The following function is called by the producer after Length     */
+   /* bytes have been written to the ring starting at InIndex.  The     */
+   /* function returns the number of bytes that were accepted into the  */
+   /* ring.                                                             */
+unsigned int HCIRING_Produce(HCIRING_Ring_t *Ring, unsigned int Length)
+{
+   /* Never accept more than there is room for.                         */
+   if(Length > Ring->BytesFree)
+   {
+      Ring->OverrunCount++;
+
+      Length = Ring->BytesFree;
+   }
+
+   Ring->InIndex += Length;
+   if(Ring->InIndex >= Ring->Size)
+      Ring->InIndex -= Ring->Size;
+
+   Ring->BytesFree -= Length;
+
+   return(Length);
+}
+
+   /* The following function is called by a producer that writes the    */
+   /* ring autonomously (i.e. a circular DMA) to synchronize the ring   */
+   /* with the current hardware write position (0 - Size).  The         */
+   /* function returns the number of new bytes that were found in the   */
+   /* ring since the last call.                                         */
+unsigned int HCIRING_ProducerSync(HCIRING_Ring_t *Ring, unsigned int Position)
+{
+   unsigned int NewBytes;
+
+   /* A position equal to the size of the ring is the same as the start */
+   /* of the ring (the counter of a circular DMA reloads on the transfer*/
+   /* complete event).                                                  */
+   if(Position >= Ring->Size)
+      Position = 0;
+
+   /* Determine how far the hardware has moved since the last update,   */
+   /* taking into account that it may have wrapped.                     */
+   if(Position >= Ring->InIndex)
+      NewBytes = Position - Ring->InIndex;
+   else
+      NewBytes = (Ring->Size - Ring->InIndex) + Position;
+
+   if(NewBytes)
+   {
+      Ring->InIndex = Position;
+
+      if(NewBytes <= Ring->BytesFree)
+         Ring->BytesFree -= NewBytes;
+      else
+      {
+         /* The hardware has overwritten data that was not consumed.    */
+         /* The ring now holds the most recent Size bytes, the oldest of*/
+         /* which is the one the hardware writes next, so the bytes that*/
+         /* were overwritten are dropped by moving OutIndex there.      */
+         Ring->OverrunCount++;
+
+         Ring->OutIndex  = Ring->InIndex;
+         Ring->BytesFree = 0;
+      }
+   }
+
+   return(NewBytes);
+}
+
+   /* The following function returns the number of bytes that can be    */
+   /* read contiguously starting at OutIndex.  The second parameter, if */
+   /* specified, receives a pointer to the first of these bytes.        */
+unsigned int HCIRING_GetSpan(HCIRING_Ring_t *Ring, unsigned char **Data)
+{
+   unsigned int TotalLength;
+   unsigned int MaxLength;
+
+   /* Determine the number of characters that can be processed before   */
+   /* the end of the buffer is reached.                                 */
+   TotalLength = Ring->Size - Ring->BytesFree;
+   MaxLength   = Ring->Size - Ring->OutIndex;
+   if(TotalLength > MaxLength)
+      TotalLength = MaxLength;
+
+   if(Data)
+      *Data = &(Ring->Buffer[Ring->OutIndex]);
+
+   return(TotalLength);
+}
+
+   /* The following function is called by the consumer once Length      */
+   /* bytes (previously returned by HCIRING_GetSpan()) have been        */
+   /* processed.                                                        */
+void HCIRING_Consume(HCIRING_Ring_t *Ring, unsigned int Length)
+{
+   Ring->OutIndex += Length;
+   if(Ring->OutIndex >= Ring->Size)
+      Ring->OutIndex -= Ring->Size;
+
+   Ring->BytesFree += Length;
+}
@@ -0,0 +1,109 @@
+/*****< hcisleep.c >***********************************************************/
+/*                                                                            */
+/*  HCISLEEP - HCILL suspend/wake sequencing for the HCI Transport Layer.     */
+/*                                                                            */
+/******************************************************************************/
+
+#include "HCISLEEP.h"       /* HCI Transport Sleep Prototypes/Constants.      */
+
+   /* The following function initializes the specified state machine.   */
+   /* The state machine starts in the awake state.                      */
+void HCISLEEP_Initialize(HCISLEEP_Machine_t *Machine)
+{
+   if(Machine)
+   {
+      Machine->State               = hslAwake;
+      Machine->SuspendCount        = 0;
+      Machine->AbortCount          = 0;
+      Machine->ControllerWakeCount = 0;
+      Machine->HostWakeCount       = 0;
+   }
+}
+
+   /* The following function passes the specified event to the          */
+   /* specified state machine and returns the actions (a bit mask of    */
+   /* HCISLEEP_ACTION_xxx constants) that the caller must perform.      */
+unsigned int HCISLEEP_Event(HCISLEEP_Machine_t *Machine, HCISLEEP_Event_t Event)
+{
+   unsigned int ret_val;
+
+   ret_val = 0;
+
+   switch(Machine->State)
+   {
+      case hslAwake:
+         /* Stop the controller from sending while the transmitter      */
+         /* drains.  Anything else is normal operation.                 */
+         if(Event == hseSuspendRequest)
+         {
+            Machine->State = hslSuspendWait;
+
+            ret_val        = HCISLEEP_ACTION_HOLD_FLOW;
+         }
+         break;
+      case hslSuspendWait:
+         switch(Event)
+         {
+            case hseWaitComplete:
+               /* Nothing interrupted the suspend, the UART can be      */
+               /* stopped.                                              */
+               Machine->State = hslSuspended;
+               Machine->SuspendCount++;
+
+               ret_val        = HCISLEEP_ACTION_STOP_UART | HCISLEEP_ACTION_SUSPENDED;
+               break;
+            case hseReceiveActivity:
+            case hseControllerWake:
+            case hseHostWake:
+               /* The link is in use again.  Let the controller send    */
+               /* right away, the suspend fails once the wait has       */
+               /* finished.                                             */
+               Machine->State = hslSuspendAborted;
+
+               ret_val        = HCISLEEP_ACTION_RELEASE_FLOW;
+               break;
+            case hseSuspendRequest:
+            default:
+               break;
+         }
+         break;
+      case hslSuspendAborted:
+         if(Event == hseWaitComplete)
+         {
+            Machine->State = hslAwake;
+            Machine->AbortCount++;
+
+            ret_val        = HCISLEEP_ACTION_ABORTED;
+         }
+         break;
+      case hslSuspended:
+         switch(Event)
+         {
+            case hseControllerWake:
+            case hseHostWake:
+               /* The UART MUST be running before the controller is     */
+               /* allowed to send the first byte.                       */
+               if(Event == hseControllerWake)
+                  Machine->ControllerWakeCount++;
+               else
+                  Machine->HostWakeCount++;
+
+               Machine->State = hslAwake;
+
+               ret_val        = HCISLEEP_ACTION_START_UART | HCISLEEP_ACTION_RELEASE_FLOW;
+               break;
+            case hseWaitComplete:
+               /* A suspend was requested while already suspended.      */
+               ret_val        = HCISLEEP_ACTION_SUSPENDED;
+               break;
+            case hseSuspendRequest:
+            case hseReceiveActivity:
+            default:
+               /* Nothing can be received while the UART is stopped.    */
+               break;
+         }
+         break;
+   }
+
+   return(ret_val);
+}
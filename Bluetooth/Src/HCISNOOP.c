@@ -0,0 +1,203 @@
+/*****< hcisnoop.c >***********************************************************/
+/*                                                                            */
+/*  HCISNOOP - btsnoop capture staging ring for the HCI Transport Layer.      */
+/*                                                                            */
+/******************************************************************************/
+
+#include <string.h>
+
+#include "HCISNOOP.h"       /* HCI Transport Capture Prototypes/Constants.    */
+
+   /* The following constants represent the btsnoop packet flags.       */
+#define FLAG_RECEIVED            0x00000001
+#define FLAG_COMMAND_EVENT       0x00000002
+
+   /* The following constants represent the H4 packet indicators of     */
+   /* command and event packets.                                        */
+#define H4_PACKET_TYPE_COMMAND   0x01
+#define H4_PACKET_TYPE_EVENT     0x04
+
+   /* Local Function Prototypes.                                        */
+static void AssignBigEndian32(unsigned char *Buffer, unsigned long Value);
+static void PutBytes(HCISNOOP_Ring_t *Ring, unsigned int *Index, unsigned int Length, const unsigned char *Data);
+
+   /* The following function writes the specified value to the specified*/
+   /* buffer in big endian (network) byte order.                        */
+static void AssignBigEndian32(unsigned char *Buffer, unsigned long Value)
+{
+   Buffer[0] = (unsigned char)(Value >> 24);
+   Buffer[1] = (unsigned char)(Value >> 16);
+   Buffer[2] = (unsigned char)(Value >> 8);
+   Buffer[3] = (unsigned char)Value;
+}
+
+   /* The following function copies the specified data to the ring at   */
+   /* the specified index, wrapping at the end of the ring, and advances*/
+   /* the index.  The caller must have checked that there is room.      */
+static void PutBytes(HCISNOOP_Ring_t *Ring, unsigned int *Index, unsigned int Length, const unsigned char *Data)
+{
+   unsigned int Count;
+
+   Count = Ring->Size - *Index;
+   if(Count > Length)
+      Count = Length;
+
+   memcpy(&(Ring->Buffer[*Index]), Data, Count);
+
+   if(Count < Length)
+      memcpy(Ring->Buffer, &(Data[Count]), (Length - Count));
+
+   *Index += Length;
+   if(*Index >= Ring->Size)
+      *Index -= Ring->Size;
+}
+
+   /* The following function initializes the specified ring to use the  */
+   /* specified buffer of the specified size and places the btsnoop file*/
+   /* header in it, so that the data that is read from the ring is a    */
+   /* complete btsnoop file.                                            */
+void HCISNOOP_Initialize(HCISNOOP_Ring_t *Ring, unsigned char *Buffer, unsigned int Size)
+{
+   unsigned char Header[HCISNOOP_FILE_HEADER_SIZE];
+   unsigned int  Index;
+
+   if((Ring) && (Buffer) && (Size > HCISNOOP_FILE_HEADER_SIZE))
+   {
+      Ring->Buffer      = Buffer;
+      Ring->Size        = Size;
+      Ring->OutIndex    = 0;
+      Ring->PacketCount = 0;
+      Ring->DropCount   = 0;
+
+      /* The identification pattern is followed by the version number   */
+      /* and the data link type.                                        */
+      memcpy(Header, "btsnoop", 8);
+      AssignBigEndian32(&(Header[8]), 1);
+      AssignBigEndian32(&(Header[12]), HCISNOOP_DATALINK_TYPE_H4);
+
+      Index = 0;
+      PutBytes(Ring, &Index, HCISNOOP_FILE_HEADER_SIZE, Header);
+
+      Ring->InIndex     = Index;
+   }
+}
+
+   /* The following function is called by the producer to capture a     */
+   /* packet.  The second parameter is non-zero for a packet that was   */
+   /* received from the controller and zero for a packet that was sent  */
+   /* to it.  This function returns non-zero if the packet was captured */
+   /* or zero if it was dropped because the ring is full.               */
+int HCISNOOP_Capture(HCISNOOP_Ring_t *Ring, int Received, unsigned long long TimeStamp, unsigned int Length, unsigned char *Data)
+{
+   int           ret_val;
+   unsigned int  Index;
+   unsigned int  Free;
+   unsigned long Flags;
+   unsigned char Header[HCISNOOP_RECORD_HEADER_SIZE];
+
+   if((Ring) && (Ring->Buffer) && (Length) && (Data))
+   {
+      /* One byte of the ring is always left unused so that a full ring */
+      /* can be told apart from an empty one.                           */
+      Free = (Ring->Size - 1) - HCISNOOP_GetUsed(Ring);
+
+      if((HCISNOOP_RECORD_HEADER_SIZE + Length) <= Free)
+      {
+         Flags = (Received) ? FLAG_RECEIVED : 0;
+         if((Data[0] == H4_PACKET_TYPE_COMMAND) || (Data[0] == H4_PACKET_TYPE_EVENT))
+            Flags |= FLAG_COMMAND_EVENT;
+
+         /* The original and included lengths are the same as packets   */
+         /* are never truncated.                                        */
+         AssignBigEndian32(&(Header[0]), Length);
+         AssignBigEndian32(&(Header[4]), Length);
+         AssignBigEndian32(&(Header[8]), Flags);
+         AssignBigEndian32(&(Header[12]), Ring->DropCount);
+         AssignBigEndian32(&(Header[16]), (unsigned long)(TimeStamp >> 32));
+         AssignBigEndian32(&(Header[20]), (unsigned long)TimeStamp);
+
+         Index = Ring->InIndex;
+
+         PutBytes(Ring, &Index, HCISNOOP_RECORD_HEADER_SIZE, Header);
+         PutBytes(Ring, &Index, Length, Data);
+
+         /* Publish the record only once all of it has been written.    */
+         HCISNOOP_MEMORY_BARRIER();
+
+         Ring->InIndex = Index;
+
+         Ring->PacketCount++;
+
+         ret_val = 1;
+      }
+      else
+      {
+         Ring->DropCount++;
+
+         ret_val = 0;
+      }
+   }
+   else
+      ret_val = 0;
+
+   return(ret_val);
+}
+
+   /* The following function is called by the consumer to get the next  */
+   /* block of data to write.  The length that is returned is the       */
+   /* largest multiple of BlockSize that can be read contiguously or, if*/
+   /* the third parameter is non-zero, whatever can be read             */
+   /* contiguously.                                                     */
+unsigned int HCISNOOP_GetBlock(HCISNOOP_Ring_t *Ring, unsigned int BlockSize, int Flush, unsigned char **Data)
+{
+   unsigned int Length;
+   unsigned int InIndex;
+
+   InIndex = Ring->InIndex;
+
+   /* The data up to the InIndex that was read has been published.      */
+   HCISNOOP_MEMORY_BARRIER();
+
+   if(InIndex >= Ring->OutIndex)
+      Length = InIndex - Ring->OutIndex;
+   else
+      Length = Ring->Size - Ring->OutIndex;
+
+   if((!Flush) && (BlockSize))
+      Length -= (Length % BlockSize);
+
+   if(Data)
+      *Data = &(Ring->Buffer[Ring->OutIndex]);
+
+   return(Length);
+}
+
+   /* The following function is called by the consumer once Length      */
+   /* bytes (previously returned by HCISNOOP_GetBlock()) have been      */
+   /* written.                                                          */
+void HCISNOOP_Release(HCISNOOP_Ring_t *Ring, unsigned int Length)
+{
+   unsigned int Index;
+
+   Index = Ring->OutIndex + Length;
+   if(Index >= Ring->Size)
+      Index -= Ring->Size;
+
+   /* Finish reading the data before the producer may overwrite it.     */
+   HCISNOOP_MEMORY_BARRIER();
+
+   Ring->OutIndex = Index;
+}
+
+   /* The following function returns the number of bytes that are       */
+   /* waiting in the specified ring.                                    */
+unsigned int HCISNOOP_GetUsed(HCISNOOP_Ring_t *Ring)
+{
+   unsigned int InIndex;
+   unsigned int OutIndex;
+
+   InIndex  = Ring->InIndex;
+   OutIndex = Ring->OutIndex;
+
+   return((InIndex >= OutIndex) ? (InIndex - OutIndex) : ((Ring->Size - OutIndex) + InIndex));
+}
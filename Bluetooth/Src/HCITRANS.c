@@ -15,57 +15,298 @@
 
 #include "BTPSKRNL.h"       /* Bluetooth Kernel Prototypes/Constants.         */
 #include "HCITRANS.h"       /* HCI Transport Prototypes/Constants.            */
+#include "HCIRING.h"        /* HCI Transport Ring Prototypes/Constants.       */
+#include "HCIH4.h"          /* HCI Transport H4 Framing Prototypes/Constants. */
+#include "HCISLEEP.h"       /* HCI Transport Sleep Prototypes/Constants.      */
+#include "HCIINIT.h"        /* HCI Init Script Loader Prototypes/Constants.   */
 #include "HCITRCFG.h"       /* HCI Transport configuration.                   */
+
+#ifndef HCITR_HOST_SIMULATION
+
 #include "stm32l4xx_hal_gpio.h"
 #include "stm32l4xx_hal_rcc.h"
 #include "stm32l4xx_hal_uart.h"
 #include "stm32l4xx_hal_uart_ex.h"
 #include "usart.h"
 
-#define INPUT_BUFFER_SIZE        1056
+#endif
+
+#if (defined(HCITR_ENABLE_DMA_TX) || defined(HCITR_ENABLE_RX_TASK) || defined(HCITR_ENABLE_SNOOP_CAPTURE))
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#endif
+
+#ifdef HCITR_ENABLE_SNOOP_CAPTURE
+
+#include "HCISNOOP.h"       /* HCI Transport Capture Prototypes/Constants.    */
+#include "fatfs.h"
+#include "rtc.h"
+
+#endif
+
+#if (defined(SUPPORT_TRANSPORT_SUSPEND) && defined(HCITR_ENABLE_LOW_POWER_STOP))
+
+#include "LOWPOWER.h"
+
+#endif
+
+   /* The following defines the size of the input buffer.  The part of  */
+   /* it that is used as the receive ring is configured at run time     */
+   /* (see HCITR_SetFlowConfiguration()).                               */
+#define INPUT_BUFFER_SIZE        HCITR_MAXIMUM_RECEIVE_BUFFER_SIZE
 #define OUTPUT_BUFFER_SIZE       1056
 
-   /* The following define the thresholds of free space remaining in the*/
-   /* transmit buffers when flow should be turned on or off when using  */
-   /* software managed flow control.                                    */
-   /* * NOTE * INPUT_BUFFER_SIZE must be greater than FLOW_ON_THRESHOLD */
-   /*          which must be greater than FLOW_OFF_THRESHOLD.           */
+   /* The following define the sizes of the output buffers of the SCO   */
+   /* and command queues when the transmit priority queues are enabled  */
+   /* (the ACL queue, or the only queue otherwise, uses the output      */
+   /* buffer above).  Each holds at least one packet with the largest   */
+   /* payload of its type.                                              */
+#define SCO_OUTPUT_BUFFER_SIZE   264
+#define COMMAND_OUTPUT_BUFFER_SIZE 264
+
+   /* The following defines the number of packets that may be waiting   */
+   /* in each output queue.                                             */
+#define TX_QUEUE_PACKETS         8
+
+#ifdef HCITR_ENABLE_TX_PRIORITY_QUEUES
+
+   /* There is one output queue per class, in order of priority.        */
+   #define NUMBER_TX_QUEUES      HCITR_NUMBER_TX_CLASSES
+   #define TX_QUEUE_INDEX(_x)    (_x)
+
+#else
+
+   #define NUMBER_TX_QUEUES      1
+   #define TX_QUEUE_INDEX(_x)    0
+
+#endif
+
+   /* The following define the default thresholds of free space         */
+   /* remaining in the receive buffer when flow should be turned on or  */
+   /* off when using software managed flow control.                     */
+   /* * NOTE * Half of the receive buffer size must be greater than     */
+   /*          FLOW_ON_THRESHOLD which must be greater than             */
+   /*          FLOW_OFF_THRESHOLD.                                      */
 #define FLOW_OFF_THRESHOLD       16
 #define FLOW_ON_THRESHOLD        32
 
+#ifdef HCITR_ENABLE_DMA_RX
+
+   /* When the input buffer is filled by the DMA the amount of free     */
+   /* space is only known when the idle line, half transfer or transfer */
+   /* complete events occur.  As up to half of the buffer can be        */
+   /* received between two of these events, flow is turned off while    */
+   /* there is still at least half of the buffer free.                  */
+   #define RX_FLOW_OFF_THRESHOLD ((UartContext.RxRing.Size / 2) + UartContext.FlowOffThreshold)
+   #define RX_FLOW_ON_THRESHOLD  ((UartContext.RxRing.Size / 2) + UartContext.FlowOnThreshold)
+
+#else
+
+   #define RX_FLOW_OFF_THRESHOLD (UartContext.FlowOffThreshold)
+   #define RX_FLOW_ON_THRESHOLD  (UartContext.FlowOnThreshold)
+
+#endif
+
+   /* The following macro calculates the largest received packet that   */
+   /* is passed to the upper layer in one piece when H4 framing is      */
+   /* enabled (larger packets are passed up as they arrive) for the     */
+   /* specified receive buffer size and flow off threshold.  This MUST  */
+   /* not be larger than the amount of data that can be buffered before */
+   /* flow is turned off, otherwise the packet could never complete.    */
+   /* Enough buffer follows the input buffer (H4_MAX_FRAME_LENGTH) so   */
+   /* that a packet that wraps the end of the receive ring can be made  */
+   /* contiguous.                                                       */
+   /* * NOTE * The default configuration allows a complete 1021 byte    */
+   /*          CC256x ACL packet.                                       */
+#define H4_FRAME_LENGTH(_Size, _FlowOffThreshold) (((_Size) / 2) - (_FlowOffThreshold))
+
+#ifdef HCITR_ENABLE_H4_FRAMING
+
+   #define H4_MAX_FRAME_LENGTH   (INPUT_BUFFER_SIZE / 2)
+
+#else
+
+   #define H4_MAX_FRAME_LENGTH   0
+
+#endif
+
+   /* The following defines the minimum size of a packet that is sent   */
+   /* by the DMA directly from the caller's buffer (instead of being    */
+   /* copied to the output buffer) when the transmitter is idle.  The   */
+   /* caller is blocked until the transfer has completed, so smaller    */
+   /* packets are always copied.                                        */
+#define DMA_TX_DIRECT_THRESHOLD  64
+
+   /* The following defines the maximum time (in milliseconds) that     */
+   /* HCITR_COMWrite() will block waiting for a single notification     */
+   /* from the transmit DMA before checking the state of the output     */
+   /* buffer again.                                                     */
+#define DMA_TX_WAIT_TIMEOUT      10
+
+   /* The following macro calculates the rounded baud rate divisor (BRR */
+   /* value, 16 times oversampling) for the specified baud rate.        */
+#define BAUD_RATE_DIVISOR(_x)    ((unsigned short)((HCITR_UART_CLOCK + ((_x) / 2)) / (_x)))
+
+   /* The following defines the smallest baud rate divisor that may be  */
+   /* used with 16 times oversampling.                                  */
+#define MINIMUM_BAUD_RATE_DIVISOR 16
+
+   /* The following macro converts a number of cycles of the time stamp */
+   /* (see GetTimeStamp()) to microseconds.                             */
+#define CyclesToMicroseconds(_x) ((_x) / (SystemCoreClock / 1000000))
+
+#ifdef HCITR_ENABLE_SNOOP_CAPTURE
+
+   /* The following defines the size of the blocks that are written to  */
+   /* the capture file.  The staging ring is written in multiples of    */
+   /* this size (except for the end of the capture) so that FatFs can   */
+   /* write whole sectors directly from the ring.                       */
+#define SNOOP_BLOCK_SIZE         512
+
+   /* The following defines the time (in milliseconds) after which the  */
+   /* capture task writes whatever whole blocks are waiting, and the    */
+   /* amount of waiting data at which the task is woken right away.     */
+#define SNOOP_FLUSH_INTERVAL     100
+#define SNOOP_FLUSH_THRESHOLD    (HCITR_SNOOP_BUFFER_SIZE / 2)
+
+   /* The following defines the longest time (in microseconds) that is  */
+   /* measured with the DWT cycle counter between two captured packets. */
+   /* Longer gaps (which could wrap the counter) are measured with the  */
+   /* tick count.                                                       */
+#define SNOOP_MAXIMUM_CYCLE_TIME 30000000UL
+
+#endif
+
+   /* The following macros wrap every access to the MCU that is not a   */
+   /* plain read or write of a register.  The host simulator (see       */
+   /* HCITR_HOST_SIMULATION in HCITRCFG.h) supplies its own versions of */
+   /* them, so any new access of this kind MUST be added here.          */
+#ifndef HCITR_HOST_SIMULATION
+
+   /* The following macro reads the DWT cycle counter that is used to   */
+   /* time stamp transmitted packets.                                   */
+#define GetTimeStamp()           (DWT->CYCCNT)
+
+   /* The following macros read the next received character from the    */
+   /* UART and write the next character to be transmitted to it.        */
+#define ReadReceiveData()        ((unsigned char)HCITR_UART_BASE->RDR)
+#define WriteTransmitData(_x)    (HCITR_UART_BASE->TDR = (_x))
+
+   /* The following macro starts a transmit DMA transfer of the         */
+   /* specified buffer to the data register of the UART.                */
+#define StartTransmitDMA(_Buffer, _Length) HAL_DMA_Start_IT(HCITR_UART_HANDLE.hdmatx, (uint32_t)(_Buffer), (uint32_t)&(HCITR_UART_BASE->TDR), (_Length))
+
 #define FlowOff()                HCITR_RTS_GPIO_PORT->ODR |= 1 << HCITR_RTS_PIN
 #define FlowOn()                 HCITR_RTS_GPIO_PORT->ODR &= ~(1 << HCITR_RTS_PIN)
 #define FlowIsOn()               HCITR_RTS_GPIO_PORT->ODR & (1 << HCITR_RTS_PIN)
 
+   /* The following macro reads the level of CTS (which the controller  */
+   /* holds high until it has started).                                 */
+#define GetCTSLevel()            ((HCITR_CTS_GPIO_PORT->IDR >> HCITR_CTS_PIN) & 1)
+
 #define ClearReset()             HAL_GPIO_WritePin(HCITR_RESET_GPIO_PORT, (1 << HCITR_RESET_PIN), GPIO_PIN_SET)
 #define SetReset()               HAL_GPIO_WritePin(HCITR_RESET_GPIO_PORT, (1 << HCITR_RESET_PIN), GPIO_PIN_RESET)
 
 #define EnableUartPeriphClock()  	RCC->APB1ENR1 |= RCC_APB1ENR1_USART2EN
-#define DisableUartPeriphClock() 	RCC->APB1RSTR1 &= ~RCC_APB1ENR1_USART2EN
+#define DisableUartPeriphClock() 	RCC->APB1ENR1 &= ~RCC_APB1ENR1_USART2EN
+
+   /* The following macros switch the TXD pin between a GPIO output     */
+   /* that holds the line idle (high) and the UART alternate function.  */
+   /* The line is held while the UART clock is stopped so that the      */
+   /* controller never sees a false start bit.                          */
+#define HoldTxdLine()            do { HCITR_TXD_GPIO_PORT->BSRR = (1 << HCITR_TXD_PIN); MODIFY_REG(HCITR_TXD_GPIO_PORT->MODER, (3 << (HCITR_TXD_PIN * 2)), (1 << (HCITR_TXD_PIN * 2))); } while(0)
+#define ReleaseTxdLine()         MODIFY_REG(HCITR_TXD_GPIO_PORT->MODER, (3 << (HCITR_TXD_PIN * 2)), (2 << (HCITR_TXD_PIN * 2)))
+
+#define DisableInterrupts()      __set_PRIMASK(1)
+#define EnableInterrupts()       __set_PRIMASK(0)
+
+#endif
+
+#ifdef HCITR_ENABLE_DMA_TX
+
+   /* The transmitter is serviced by the DMA, enabling the transmitter  */
+   /* starts a DMA transfer if one is not already in progress.          */
+#define USARTEnableTXInterrupt()  	StartTxDMA()
+#define USARTDisableTXInterrupt()
+
+#elif defined(HCITR_ENABLE_UART_FIFO)
+
+   /* Interrupt when the transmit FIFO has drained to its threshold.    */
+#define USARTEnableTXInterrupt() 	HCITR_UART_BASE->CR3 |= USART_CR3_TXFTIE
+#define USARTDisableTXInterrupt() 	HCITR_UART_BASE->CR3 &= ~USART_CR3_TXFTIE
+
+#else
 
 #define USARTEnableTXInterrupt() 	HCITR_UART_BASE->CR1 |= USART_CR1_TXEIE_TXFNFIE
 #define USARTDisableTXInterrupt() 	HCITR_UART_BASE->CR1 &= ~USART_CR1_TXEIE_TXFNFIE
+
+#endif
+
+#ifdef HCITR_ENABLE_DMA_RX
+
+   /* The receiver is serviced by the DMA so the receive interrupt is   */
+   /* never used.                                                       */
+#define USARTEnableRXInterrupt()
+#define USARTDisableRXInterrupt()
+
+#elif defined(HCITR_ENABLE_UART_FIFO)
+
+   /* Interrupt when the receive FIFO has filled to its threshold.  The */
+   /* idle line interrupt picks up the characters that are left below   */
+   /* the threshold at the end of a packet.                             */
+#define USARTEnableRXInterrupt() 	do { HCITR_UART_BASE->CR3 |= USART_CR3_RXFTIE; HCITR_UART_BASE->CR1 |= USART_CR1_IDLEIE; } while(0)
+#define USARTDisableRXInterrupt() 	do { HCITR_UART_BASE->CR3 &= ~USART_CR3_RXFTIE; HCITR_UART_BASE->CR1 &= ~USART_CR1_IDLEIE; } while(0)
+
+#else
+
 #define USARTEnableRXInterrupt() 	HCITR_UART_BASE->CR1 |= USART_CR1_RXNEIE_RXFNEIE
 #define USARTDisableRXInterrupt() 	HCITR_UART_BASE->CR1 &= ~USART_CR1_RXNEIE_RXFNEIE
+
+#endif
+
 #define USARTEnableCTSInterrupt() 	EXTI->IMR1 |= HCITR_CTS_EXTI_LINE//HCITR_UART_BASE->CR3 |= USART_CR3_CTSIE;
 #define USARTDisableCTSInterrupt()	EXTI->IMR1 &= ~HCITR_CTS_EXTI_LINE//HCITR_UART_BASE->CR3 &= ~USART_CR3_CTSIE;
 
-#define DisableInterrupts()      __set_PRIMASK(1)
-#define EnableInterrupts()       __set_PRIMASK(0)
-
 #define INTERRUPT_PRIORITY       5
 
 #define TRANSPORT_ID             1
 
 #define DEBUG_PRINT              BTPS_OutputMessage
 
-typedef enum
+typedef struct _tagBaudRateEntry_t
+{
+   unsigned long  BaudRate;
+   unsigned short Divisor;
+} BaudRateEntry_t;
+
+   /* The following structure holds a packet that is waiting in an      */
+   /* output queue.  The time stamp is taken when the packet is passed  */
+   /* to HCITR_COMWrite().                                              */
+typedef struct _tagTxPacket_t
+{
+   unsigned int   Length;
+   unsigned int   Class;
+   unsigned long  TimeStamp;
+} TxPacket_t;
+
+   /* The following structure holds the state of an output queue.  The  */
+   /* data of the queued packets is held in the buffer in the same order*/
+   /* as the packets.                                                   */
+typedef struct _tagTxQueue_t
 {
-   hssNormal,
-   hssSuspendWait,
-   hssSuspendWaitInterrupted,
-   hssSuspended
-} SuspendState_t;
+   unsigned char           *Buffer;
+   unsigned short           Size;
+   unsigned short           InIndex;
+   unsigned short           OutIndex;
+   volatile unsigned short  BytesFree;
+   unsigned short           PacketInIndex;
+   unsigned short           PacketOutIndex;
+   volatile unsigned short  PacketCount;
+   TxPacket_t               Packets[TX_QUEUE_PACKETS];
+} TxQueue_t;
 
 typedef struct _tagUartContext_t
 {
@@ -75,20 +316,84 @@ typedef struct _tagUartContext_t
 
 #endif
 
-   SuspendState_t           SuspendState;
+   HCISLEEP_Machine_t       Sleep;
 
    HCITR_COMDataCallback_t  COMDataCallbackFunction;
    unsigned long            COMDataCallbackParameter;
 
-   unsigned short           RxInIndex;
-   unsigned short           RxOutIndex;
-   volatile unsigned short  RxBytesFree;
-   unsigned char            RxBuffer[INPUT_BUFFER_SIZE];
+   HCIRING_Ring_t           RxRing;
+   unsigned char            RxBuffer[INPUT_BUFFER_SIZE + H4_MAX_FRAME_LENGTH];
+
+#ifdef HCITR_ENABLE_H4_FRAMING
+
+   HCIH4_Framer_t           RxFramer;
 
-   unsigned short           TxInIndex;
-   unsigned short           TxOutIndex;
-   volatile unsigned short  TxBytesFree;
+#endif
+
+   unsigned int             FlowOffThreshold;
+   unsigned int             FlowOnThreshold;
+   Boolean_t                RxFlowStopped;
+
+   TxQueue_t                TxQueue[NUMBER_TX_QUEUES];
    unsigned char            TxBuffer[OUTPUT_BUFFER_SIZE];
+
+#ifdef HCITR_ENABLE_TX_PRIORITY_QUEUES
+
+   unsigned char            TxSCOBuffer[SCO_OUTPUT_BUFFER_SIZE];
+   unsigned char            TxCommandBuffer[COMMAND_OUTPUT_BUFFER_SIZE];
+
+#endif
+
+   volatile unsigned int    TxBytesQueued;
+   TxQueue_t               *TxCurrentQueue;
+   unsigned int             TxCurrentRemaining;
+   unsigned int             TxCurrentLength;
+   unsigned int             TxCurrentClass;
+   unsigned long            TxCurrentTimeStamp;
+
+#ifdef HCITR_ENABLE_DMA_TX
+
+   volatile Boolean_t       TxDMAActive;
+   volatile Boolean_t       TxDMADirect;
+   unsigned short           TxDMALength;
+   volatile TaskHandle_t    TxWaitTask;
+
+#endif
+
+   unsigned long            StatisticsStartTime;
+   unsigned long            TxByteCount;
+   unsigned long            TxInterruptCount;
+   unsigned long            RxByteCount;
+   unsigned long            RxInterruptCount;
+   unsigned long            RxCallbackCount;
+   unsigned long            RxHighWaterMark;
+   unsigned long            RxFlowOffCount;
+   unsigned long            RxUARTOverrunCount;
+
+#ifdef HCITR_ENABLE_RX_TASK
+
+   volatile Boolean_t       RxTaskSignaled;
+   volatile Boolean_t       RxTaskBusy;
+   unsigned long            RxSignalTimeStamp;
+   unsigned long            RxTaskWakeupCount;
+   unsigned long            RxMaximumLatency;
+
+#endif
+
+#ifdef HCITR_ENABLE_FAST_BOOT
+
+   HCIINIT_Loader_t         InitLoader;
+   volatile Boolean_t       InitActive;
+   volatile unsigned int    InitActions;
+
+#ifdef HCITR_ENABLE_RX_TASK
+
+   TaskHandle_t             InitWaitTask;
+
+#endif
+
+#endif
+   HCITR_TxClassStatistics_t TxClassStatistics[HCITR_NUMBER_TX_CLASSES];
 } UartContext_t;
 
    /* Internal Variables to this Module (Remember that all variables    */
@@ -98,36 +403,458 @@ typedef struct _tagUartContext_t
 static UartContext_t              UartContext;
 static int                        HCITransportOpen        = 0;
 
+   /* The following variable holds the receive buffer configuration     */
+   /* that is used when the transport is opened.                        */
+static HCITR_FlowConfiguration_t  FlowConfiguration       = { INPUT_BUFFER_SIZE, FLOW_OFF_THRESHOLD, FLOW_ON_THRESHOLD };
+
+   /* The following variable holds the timing of the last start up of   */
+   /* the controller.                                                   */
+static HCITR_BootStatistics_t     BootStatistics;
+
+#ifdef HCITR_ENABLE_FAST_BOOT
+
+   /* The following variables hold the initialization script that is    */
+   /* uploaded each time the transport is opened.                       */
+static const unsigned char       *InitScript;
+static unsigned long              InitScriptLength;
+
+#endif
+
+#ifdef HCITR_ENABLE_RX_TASK
+
+   /* The following variables hold the receive task.  The task is       */
+   /* created the first time the transport is opened and then remains   */
+   /* (waiting for a notification) while the transport is closed.       */
+static TaskHandle_t               RxTaskHandle;
+static StaticTask_t               RxTaskBuffer;
+static StackType_t                RxTaskStack[HCITR_RX_TASK_STACK_SIZE];
+
+#endif
+
+#ifdef HCITR_ENABLE_DMA_TX
+
+   /* The following variables hold the mutex that serializes the tasks  */
+   /* that wait for the transmitter (see AcquireTransmitter()).  The    */
+   /* mutex is created the first time the transport is opened.          */
+static SemaphoreHandle_t          TxWaitMutex;
+static StaticSemaphore_t          TxWaitMutexBuffer;
+
+#endif
+
+#ifdef HCITR_ENABLE_SNOOP_CAPTURE
+
+   /* The following variables hold the state of the btsnoop capture.    */
+   /* The staging buffer is declared as unsigned long so that the       */
+   /* sectors that are written from it are word aligned (for the SD     */
+   /* DMA).  The capture time is a btsnoop time stamp that is advanced  */
+   /* by the DWT cycle counter (and the tick count) each time a packet  */
+   /* is captured.                                                      */
+static HCISNOOP_Ring_t            SnoopRing;
+static unsigned long              SnoopBuffer[HCITR_SNOOP_BUFFER_SIZE / sizeof(unsigned long)];
+static FIL                        SnoopFile;
+static volatile Boolean_t         SnoopCapturing;
+static volatile Boolean_t         SnoopFileOpen;
+static volatile Boolean_t         SnoopStopRequested;
+static unsigned long              SnoopBytesWritten;
+static unsigned long              SnoopWriteErrors;
+static unsigned long long         SnoopTime;
+static unsigned long              SnoopLastCycles;
+static unsigned long              SnoopCycleRemainder;
+static TickType_t                 SnoopLastTick;
+static TaskHandle_t               SnoopTaskHandle;
+static StaticTask_t               SnoopTaskBuffer;
+static StackType_t                SnoopTaskStack[HCITR_SNOOP_TASK_STACK_SIZE];
+
+#endif
+
+   /* The following table contains the precomputed baud rate divisors   */
+   /* for the baud rates supported by the CC256x.                       */
+static const BaudRateEntry_t BaudRateTable[] =
+{
+   {  115200, BAUD_RATE_DIVISOR(115200)  },
+   {  230400, BAUD_RATE_DIVISOR(230400)  },
+   {  460800, BAUD_RATE_DIVISOR(460800)  },
+   {  921600, BAUD_RATE_DIVISOR(921600)  },
+   { 1000000, BAUD_RATE_DIVISOR(1000000) },
+   { 1500000, BAUD_RATE_DIVISOR(1500000) },
+   { 2000000, BAUD_RATE_DIVISOR(2000000) },
+   { 3000000, BAUD_RATE_DIVISOR(3000000) }
+};
+
+#define NUMBER_BAUD_RATES        (sizeof(BaudRateTable) / sizeof(BaudRateEntry_t))
+
    /* Local Function Prototypes.                                        */
-//static void SetBaudRate(USART_TypeDef *UartBase, unsigned int BaudRate);
+static int SetBaudRate(USART_TypeDef *UartBase, unsigned int BaudRate);
+static void FlushTransmitter(void);
+static unsigned int GetTxClass(unsigned char PacketType);
+static void InitializeTxQueue(TxQueue_t *Queue, unsigned char *Buffer, unsigned int Size);
+static unsigned int GetTxSegment(unsigned char **Data);
+static void TxSegmentComplete(unsigned int Length);
+static void TxPacketComplete(unsigned int Class, unsigned int Length, unsigned long TimeStamp);
 //static void ConfigureGPIO(GPIO_TypeDef *Port, unsigned int Pin, GPIOMode_TypeDef Mode);
-//static void SetSuspendGPIO(Boolean_t Suspend);
+static void SetSuspendGPIO(Boolean_t Suspend);
+static void PerformSleepActions(unsigned int Actions);
 static void TxInterrupt(void);
+static void ReceiveBufferUpdated(void);
 static void RxInterrupt(void);
+static void ProcessReceivedData(void);
+
+#ifdef HCITR_ENABLE_FAST_BOOT
+
+static void BootController(unsigned long BaudRate);
+
+#endif
+
+#ifdef HCITR_ENABLE_RX_TASK
+
+static void SignalRxTask(void);
+static void RxTask(void *Parameter);
+
+#endif
+
+#ifdef HCITR_ENABLE_SNOOP_CAPTURE
+
+static unsigned long long GetRTCTime(void);
+static unsigned long long GetCaptureTime(void);
+static void CapturePacket(int Received, unsigned int Length, unsigned char *Data);
+static void SnoopTask(void *Parameter);
+
+#endif
+
+#ifdef HCITR_ENABLE_DMA_RX
+
+static void RxDMAEvent(void);
+
+#endif
+
+#ifdef HCITR_ENABLE_DMA_TX
+
+static void StartTxTransfer(unsigned char *Buffer, unsigned int Length);
+static void StartTxDMA(void);
+static void TxDMAComplete(DMA_HandleTypeDef *hdma);
+static void AcquireTransmitter(void);
+static void ReleaseTransmitter(void);
+static void WaitForTransmitter(void);
+
+#endif
 
    /* The following function will reconfigure the BAUD rate without     */
    /* reconfiguring the entire port.  This function is also potentially */
    /* more accurate than the method used in the ST standard peripheral  */
-   /* libraries.                                                        */
-static void SetBaudRate(USART_TypeDef *UartBase, unsigned int BaudRate)
+   /* libraries.  The function returns zero if successful or a negative */
+   /* value if the baud rate can not be generated.                      */
+   /* * NOTE * Any data that is still being transmitted is lost, see    */
+   /*          FlushTransmitter().                                      */
+static int SetBaudRate(USART_TypeDef *UartBase, unsigned int BaudRate)
+{
+   int            ret_val;
+   unsigned int   Index;
+   unsigned short Divisor;
+
+   /* Look up the divisor for the requested baud rate.                  */
+   Divisor = 0;
+   for(Index = 0; Index < NUMBER_BAUD_RATES; Index++)
+   {
+      if(BaudRateTable[Index].BaudRate == BaudRate)
+      {
+         Divisor = BaudRateTable[Index].Divisor;
+         break;
+      }
+   }
+
+   /* Calculate the divisor for a baud rate that is not in the table.   */
+   if((!Divisor) && (BaudRate) && (BaudRate <= (HCITR_UART_CLOCK / MINIMUM_BAUD_RATE_DIVISOR)))
+      Divisor = BAUD_RATE_DIVISOR(BaudRate);
+
+   if(Divisor >= MINIMUM_BAUD_RATE_DIVISOR)
+   {
+      /* The baud rate register can only be written while the UART is   */
+      /* disabled.                                                      */
+      UartBase->CR1 &= ~USART_CR1_UE;
+      UartBase->BRR  = Divisor;
+      UartBase->CR1 |= USART_CR1_UE;
+
+      /* Keep the HAL handle in sync with the new configuration.        */
+      HCITR_UART_HANDLE.Init.BaudRate = BaudRate;
+
+      ret_val = 0;
+   }
+   else
+      ret_val = HCITR_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* The following function blocks until all of the data in the output */
+   /* buffer has been sent and the last character has left the UART.    */
+   /* This is used before the baud rate is changed so that data queued  */
+   /* at the old baud rate is not corrupted.                            */
+static void FlushTransmitter(void)
 {
+   /* Nothing can be sent while the UART is suspended.                  */
+   if(UartContext.Sleep.State != hslSuspended)
+   {
+#ifdef HCITR_ENABLE_DMA_TX
+
+      AcquireTransmitter();
+
+      while((UartContext.TxBytesQueued) || (UartContext.TxDMAActive))
+         WaitForTransmitter();
+
+      ReleaseTransmitter();
+
+#else
+
+      while(UartContext.TxBytesQueued) {}
+
+#endif
+
+      /* Wait for the last character to be shifted out.                 */
+      while(!(HCITR_UART_BASE->ISR & USART_ISR_TC)) {}
+   }
 }
 
+   /* The following function controls RTS while the transport is        */
+   /* suspended.  RTS is raised when a suspend is requested so that the */
+   /* controller can not start sending while the UART is being (or has  */
+   /* been) stopped.  The controller wakes the transport by lowering    */
+   /* CTS, which is always enabled as an EXTI interrupt, and RTS is only*/
+   /* lowered again once the UART is running.                           */
 static void SetSuspendGPIO(Boolean_t Suspend)
 {
+   if(Suspend)
+      FlowOff();
+   else
+   {
+      /* Only let the Bluetooth device send if there is room for the    */
+      /* data.                                                          */
+      if(!UartContext.RxFlowStopped)
+         FlowOn();
+   }
+}
+
+   /* The following function performs the actions (HCISLEEP_ACTION_xxx  */
+   /* bit mask) that were returned by the sleep state machine, in the   */
+   /* order that is required by HCISLEEP_Event().                       */
+   /* * NOTE * This function must be called with interrupts disabled or */
+   /*          from an interrupt.                                       */
+static void PerformSleepActions(unsigned int Actions)
+{
+   if(Actions & HCISLEEP_ACTION_START_UART)
+   {
+#if (defined(SUPPORT_TRANSPORT_SUSPEND) && defined(HCITR_ENABLE_LOW_POWER_STOP))
+
+      LOWPOWER_PreventStop(LOWPOWER_LOCK_HCI_TRANSPORT);
+
+#endif
+
+      EnableUartPeriphClock();
+      ReleaseTxdLine();
+   }
+
+   if(Actions & HCISLEEP_ACTION_HOLD_FLOW)
+      SetSuspendGPIO(TRUE);
+
+   if(Actions & HCISLEEP_ACTION_RELEASE_FLOW)
+      SetSuspendGPIO(FALSE);
+
+   if(Actions & HCISLEEP_ACTION_STOP_UART)
+   {
+      HoldTxdLine();
+      DisableUartPeriphClock();
+
+#if (defined(SUPPORT_TRANSPORT_SUSPEND) && defined(HCITR_ENABLE_LOW_POWER_STOP))
+
+      LOWPOWER_AllowStop(LOWPOWER_LOCK_HCI_TRANSPORT);
+
+#endif
+   }
+}
+
+   /* The following function returns the transmit class (one of the     */
+   /* HCITR_TX_CLASS_xxx constants) of a packet with the specified H4   */
+   /* packet indicator.                                                 */
+static unsigned int GetTxClass(unsigned char PacketType)
+{
+   unsigned int ret_val;
+
+   switch(PacketType)
+   {
+      case HCIH4_PACKET_TYPE_SCO:
+      case HCIH4_HCILL_GO_TO_SLEEP_IND:
+      case HCIH4_HCILL_GO_TO_SLEEP_ACK:
+      case HCIH4_HCILL_WAKE_UP_IND:
+      case HCIH4_HCILL_WAKE_UP_ACK:
+         ret_val = HCITR_TX_CLASS_SCO;
+         break;
+      case HCIH4_PACKET_TYPE_COMMAND:
+         ret_val = HCITR_TX_CLASS_COMMAND;
+         break;
+      default:
+         ret_val = HCITR_TX_CLASS_ACL;
+         break;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function initializes the specified output queue to  */
+   /* use the specified buffer.                                         */
+static void InitializeTxQueue(TxQueue_t *Queue, unsigned char *Buffer, unsigned int Size)
+{
+   BTPS_MemInitialize(Queue, 0, sizeof(TxQueue_t));
+
+   Queue->Buffer    = Buffer;
+   Queue->Size      = (unsigned short)Size;
+   Queue->BytesFree = (unsigned short)Size;
+}
+
+   /* The following function is the transmit scheduler.  If the         */
+   /* previous packet has been completely sent it selects the oldest    */
+   /* packet of the highest priority queue that has a packet waiting.   */
+   /* The function returns the number of bytes of the current packet    */
+   /* that can be sent contiguously from its queue (zero if there is    */
+   /* nothing to send) and the parameter, if specified, receives a      */
+   /* pointer to the first of these bytes.                              */
+   /* * NOTE * This function must be called with interrupts disabled or */
+   /*          from the transmit interrupt.                             */
+static unsigned int GetTxSegment(unsigned char **Data)
+{
+   unsigned int  ret_val;
+   unsigned int  Index;
+   TxQueue_t    *Queue;
+   TxPacket_t   *Packet;
+
+   if(!UartContext.TxCurrentQueue)
+   {
+      for(Index = 0; Index < NUMBER_TX_QUEUES; Index++)
+      {
+         Queue = &(UartContext.TxQueue[Index]);
+         if(Queue->PacketCount)
+         {
+            Packet = &(Queue->Packets[Queue->PacketOutIndex]);
+
+            UartContext.TxCurrentQueue     = Queue;
+            UartContext.TxCurrentRemaining = Packet->Length;
+            UartContext.TxCurrentLength    = Packet->Length;
+            UartContext.TxCurrentClass     = Packet->Class;
+            UartContext.TxCurrentTimeStamp = Packet->TimeStamp;
+
+            /* The packet entry is no longer needed.                    */
+            Queue->PacketCount--;
+            Queue->PacketOutIndex++;
+            if(Queue->PacketOutIndex == TX_QUEUE_PACKETS)
+               Queue->PacketOutIndex = 0;
+
+            break;
+         }
+      }
+   }
+
+   if((Queue = UartContext.TxCurrentQueue) != NULL)
+   {
+      /* Only the part of the packet that has already been written to   */
+      /* the buffer can be sent, up to the end of the buffer.           */
+      ret_val = Queue->Size - Queue->BytesFree;
+      if(ret_val > UartContext.TxCurrentRemaining)
+         ret_val = UartContext.TxCurrentRemaining;
+      if(ret_val > (unsigned int)(Queue->Size - Queue->OutIndex))
+         ret_val = Queue->Size - Queue->OutIndex;
+
+      if(Data)
+         *Data = &(Queue->Buffer[Queue->OutIndex]);
+   }
+   else
+      ret_val = 0;
+
+   return(ret_val);
+}
+
+   /* The following function is called when the specified number of     */
+   /* bytes (previously returned by GetTxSegment()) have been sent.  It */
+   /* releases the space in the output queue and completes the current  */
+   /* packet once all of it has been sent.                              */
+   /* * NOTE * This function must be called with interrupts disabled or */
+   /*          from the transmit interrupt.                             */
+static void TxSegmentComplete(unsigned int Length)
+{
+   TxQueue_t *Queue;
+
+   Queue = UartContext.TxCurrentQueue;
+
+   /* Adjust the character counts and wrap the index if necessary.      */
+   Queue->BytesFree += Length;
+   Queue->OutIndex  += Length;
+   if(Queue->OutIndex == Queue->Size)
+      Queue->OutIndex = 0;
+
+   UartContext.TxBytesQueued      -= Length;
+   UartContext.TxCurrentRemaining -= Length;
+
+   if(!UartContext.TxCurrentRemaining)
+   {
+      TxPacketComplete(UartContext.TxCurrentClass, UartContext.TxCurrentLength, UartContext.TxCurrentTimeStamp);
+
+      /* The next call to GetTxSegment() selects the next packet.       */
+      UartContext.TxCurrentQueue = NULL;
+   }
+}
+
+   /* The following function updates the statistics of the specified    */
+   /* class when a packet of that class has been sent.  The final       */
+   /* parameter is the time stamp of the packet.                        */
+static void TxPacketComplete(unsigned int Class, unsigned int Length, unsigned long TimeStamp)
+{
+   unsigned int               Bucket;
+   unsigned long              Limit;
+   unsigned long              Latency;
+   HCITR_TxClassStatistics_t *Statistics;
+
+   Statistics = &(UartContext.TxClassStatistics[Class]);
+   Latency    = CyclesToMicroseconds(GetTimeStamp() - TimeStamp);
+
+   Statistics->Packets++;
+   Statistics->Bytes += Length;
+
+   if(Latency > Statistics->MaximumLatency)
+      Statistics->MaximumLatency = Latency;
+
+   /* Find the histogram bucket of the latency.                         */
+   Bucket = 0;
+   Limit  = HCITR_LATENCY_BUCKET_0_LIMIT;
+   while((Bucket < (HCITR_NUMBER_LATENCY_BUCKETS - 1)) && (Latency >= Limit))
+   {
+      Bucket++;
+      Limit <<= 1;
+   }
+
+   Statistics->LatencyHistogram[Bucket]++;
 }
 
    /* The following function is the FIFO Primer and Interrupt Service   */
    /* Routine for the UART TX interrupt.                                */
 static void TxInterrupt(void)
 {
+   unsigned char *Data;
+
    /* Continue to transmit characters as long as there is data in the   */
    /* buffer and the transmit fifo is empty.                            */
-	// while
-   if((UartContext.TxBytesFree != OUTPUT_BUFFER_SIZE))
+   UartContext.TxInterruptCount++;
+
+#ifdef HCITR_ENABLE_UART_FIFO
+
+   while((GetTxSegment(&Data)) && (HCITR_UART_BASE->ISR & USART_ISR_TXE_TXFNF))
+
+#else
+
+   if(GetTxSegment(&Data))
+
+#endif
    {
+      UartContext.TxByteCount++;
+
       /* Place the next character into the output buffer.               */
-      HCITR_UART_BASE->TDR = UartContext.TxBuffer[UartContext.TxOutIndex];
+      WriteTransmitData(*Data);
       //HAL_UART_Transmit_IT(&huart2, &UartContext.TxBuffer[UartContext.TxOutIndex], 1);
       //printHex(UartContext.TxBuffer[UartContext.TxOutIndex], 1);
       //printString("\n");
@@ -135,83 +862,257 @@ static void TxInterrupt(void)
       //printHex(UartContext.TxBuffer[UartContext.TxOutIndex], 1);
       //printString("\n");
 
-      /* Adjust the character counts and wrap the index if necessary.   */
-      UartContext.TxBytesFree++;
-      UartContext.TxOutIndex++;
-      if(UartContext.TxOutIndex == OUTPUT_BUFFER_SIZE) {
-         UartContext.TxOutIndex = 0;
-      }
+      TxSegmentComplete(1);
    }
 
-   /* If there are no more bytes in the queue then disable the transmit */
-   /* interrupt.                                                        */
-   if(UartContext.TxBytesFree == OUTPUT_BUFFER_SIZE) {
+   /* If there are no more bytes that can be sent then disable the      */
+   /* transmit interrupt.                                               */
+   if(!GetTxSegment(NULL)) {
 	   USARTDisableTXInterrupt();
    }
 }
 
+   /* The following function is called after data has been placed in    */
+   /* the receive buffer.  It updates the high water mark of the buffer */
+   /* and turns flow off once the free space in the buffer drops below  */
+   /* the flow off threshold.                                           */
+static void ReceiveBufferUpdated(void)
+{
+   unsigned long BytesUsed;
+
+   BytesUsed = UartContext.RxRing.Size - UartContext.RxRing.BytesFree;
+   if(BytesUsed > UartContext.RxHighWaterMark)
+      UartContext.RxHighWaterMark = BytesUsed;
+
+   /* If the buffer is getting full, stop the Bluetooth device from     */
+   /* sending more data.                                                */
+   if((!UartContext.RxFlowStopped) && (UartContext.RxRing.BytesFree < RX_FLOW_OFF_THRESHOLD))
+   {
+      FlowOff();
+
+      UartContext.RxFlowStopped = TRUE;
+      UartContext.RxFlowOffCount++;
+   }
+
+#ifdef HCITR_ENABLE_RX_TASK
+
+   /* Let the receive task pass the data to the upper layer.            */
+   SignalRxTask();
+
+#endif
+}
+
    /* The following function is the Interrupt Service Routine for the   */
    /* UART RX interrupt.                                                */
 static void RxInterrupt(void)
 {
    /* Continue reading data from the fifo until it is empty or the      */
    /* buffer is full.                                                   */
-	// while
-   if((UartContext.RxBytesFree))
+   UartContext.RxInterruptCount++;
+
+#ifdef HCITR_ENABLE_UART_FIFO
+
+   while((UartContext.RxRing.BytesFree) && (HCITR_UART_BASE->ISR & USART_ISR_RXNE_RXFNE))
+
+#else
+
+   if((UartContext.RxRing.BytesFree))
+
+#endif
    {
+      UartContext.RxByteCount++;
+
       if(HCITR_UART_BASE->ISR & USART_ISR_ORE) {
          DBG_MSG(DBG_ZONE_GENERAL, ("Receive Overflow\r\n"));
       }
 
       /* Read a character from the port into the receive buffer         */
-      UartContext.RxBuffer[UartContext.RxInIndex] = HCITR_UART_BASE->RDR;
+      UartContext.RxBuffer[UartContext.RxRing.InIndex] = ReadReceiveData();
       //HAL_UART_Receive_IT(&huart2, &UartContext.RxBuffer[UartContext.RxInIndex], 1);
       //printHex(UartContext.RxBuffer[UartContext.RxInIndex], 1);
       //printString("\n");
       /* Update the count variables.                                    */
-      UartContext.RxBytesFree--;
-      UartContext.RxInIndex++;
-      if(UartContext.RxInIndex == INPUT_BUFFER_SIZE) {
-         UartContext.RxInIndex = 0;
-      }
+      HCIRING_Produce(&UartContext.RxRing, 1);
    }
 
+   ReceiveBufferUpdated();
+
   /* If the buffer is full, disable the receive interrupt.          */
-  if(!UartContext.RxBytesFree) {
-	  FlowOff();
+  if(!UartContext.RxRing.BytesFree) {
 	  USARTDisableRXInterrupt();
   }
 
-   if(UartContext.SuspendState == hssSuspendWait)
+   /* Data was received, a suspend that is in progress is interrupted.  */
+   PerformSleepActions(HCISLEEP_Event(&UartContext.Sleep, hseReceiveActivity));
+}
+
+#ifdef HCITR_ENABLE_DMA_RX
+
+   /* The following function is called on the idle line interrupt of    */
+   /* the UART and on the half and full transfer interrupts of the      */
+   /* receive DMA.  It makes the data that the DMA has placed in the    */
+   /* input buffer since the last call available to HCITR_COMProcess(). */
+static void RxDMAEvent(void)
+{
+   unsigned int Position;
+   unsigned int NewBytes;
+
+   UartContext.RxInterruptCount++;
+
+   /* Determine where the DMA will write the next character.            */
+   Position = UartContext.RxRing.Size - HCITR_RXD_DMA_CHANNEL->CNDTR;
+
+   if((NewBytes = HCIRING_ProducerSync(&UartContext.RxRing, Position)) != 0)
    {
-      /* Indicate the suspend is interrupted.                           */
-      UartContext.SuspendState = hssSuspendWaitInterrupted;
+      UartContext.RxByteCount += NewBytes;
+
+      ReceiveBufferUpdated();
+
+      /* A suspend that is in progress is interrupted.                  */
+      PerformSleepActions(HCISLEEP_Event(&UartContext.Sleep, hseReceiveActivity));
+   }
+}
+
+#endif
+
+#ifdef HCITR_ENABLE_DMA_TX
+
+   /* The following function starts a transmit DMA transfer of the      */
+   /* specified buffer to the UART.                                     */
+   /* * NOTE * This function must be called with interrupts disabled or */
+   /*          from the DMA interrupt.                                  */
+static void StartTxTransfer(unsigned char *Buffer, unsigned int Length)
+{
+   UartContext.TxDMAActive = TRUE;
+   UartContext.TxDMALength = Length;
+
+   StartTransmitDMA(Buffer, Length);
+
+   /* Clear the transmission complete flag and let the UART request the */
+   /* data.                                                             */
+   HCITR_UART_BASE->ICR  = USART_ICR_TCCF;
+   HCITR_UART_BASE->CR3 |= USART_CR3_DMAT;
+}
+
+   /* The following function starts a transmit DMA transfer of the next */
+   /* contiguous segment of the output buffer if the transmitter is     */
+   /* idle and there is data waiting in the buffer.                     */
+   /* * NOTE * This function must be called with interrupts disabled or */
+   /*          from the DMA interrupt.                                  */
+static void StartTxDMA(void)
+{
+   unsigned int   Length;
+   unsigned char *Data;
+
+   if(!UartContext.TxDMAActive)
+   {
+      /* Send up to the end of the current packet or the buffer, the    */
+      /* remainder (if any) is sent when this transfer completes.       */
+      if((Length = GetTxSegment(&Data)) != 0)
+      {
+         UartContext.TxDMADirect = FALSE;
+
+         StartTxTransfer(Data, Length);
+      }
    }
 }
 
+   /* The following function is the transfer complete callback of the   */
+   /* transmit DMA.  It releases the space used by the transfer, starts */
+   /* the next transfer and wakes up any task that is waiting in        */
+   /* HCITR_COMWrite().                                                 */
+static void TxDMAComplete(DMA_HandleTypeDef *hdma)
+{
+   BaseType_t HigherPriorityTaskWoken = pdFALSE;
+
+   UartContext.TxInterruptCount++;
+   UartContext.TxByteCount += UartContext.TxDMALength;
+
+   if(UartContext.TxDMADirect)
+   {
+      /* The packet was sent directly from the caller's buffer.         */
+      UartContext.TxDMADirect = FALSE;
+
+      TxPacketComplete(UartContext.TxCurrentClass, UartContext.TxDMALength, UartContext.TxCurrentTimeStamp);
+   }
+   else
+      TxSegmentComplete(UartContext.TxDMALength);
+
+   UartContext.TxDMAActive = FALSE;
+   UartContext.TxDMALength = 0;
+
+   /* Send anything that was queued while this transfer was in progress.*/
+   StartTxDMA();
+
+   if(UartContext.TxWaitTask)
+   {
+      vTaskNotifyGiveFromISR(UartContext.TxWaitTask, &HigherPriorityTaskWoken);
+
+      portYIELD_FROM_ISR(HigherPriorityTaskWoken);
+   }
+}
+
+   /* The following function makes the calling task the one that is     */
+   /* notified by the transmit DMA (UartContext.TxWaitTask).  There is  */
+   /* only one such task, so this blocks while another task is writing  */
+   /* or flushing the transmitter, until it calls ReleaseTransmitter(). */
+   /* * NOTE * Before the scheduler is started there is only one caller */
+   /*          and nothing to block on.                                 */
+static void AcquireTransmitter(void)
+{
+   if(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+      xSemaphoreTake(TxWaitMutex, portMAX_DELAY);
+
+   UartContext.TxWaitTask = xTaskGetCurrentTaskHandle();
+}
+
+   /* The following function releases the transmitter that was acquired */
+   /* by the calling task with AcquireTransmitter().                    */
+static void ReleaseTransmitter(void)
+{
+   UartContext.TxWaitTask = NULL;
+
+   if(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+      xSemaphoreGive(TxWaitMutex);
+}
+
+   /* The following function blocks the calling task until the transmit */
+   /* DMA signals that it has made progress.                            */
+   /* * NOTE * The caller must have called AcquireTransmitter() before  */
+   /*          checking the condition it is waiting on so that no       */
+   /*          notification can be missed.                              */
+static void WaitForTransmitter(void)
+{
+   /* Before the scheduler is started there is nothing to block on.     */
+   if(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(DMA_TX_WAIT_TIMEOUT));
+}
+
+#endif
+
 void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
 	if(GPIO_Pin == GPIO_PIN_3) {
 		//EXTI->PR |= EXTI_PR_PR9;
 		//printString("CTS\n");
-		if(UartContext.SuspendState == hssSuspended) {
-		  /* Resume the UART.                                               */
-		  EnableUartPeriphClock();
-		  SetSuspendGPIO(FALSE);
-		  UartContext.SuspendState = hssNormal;
-		} else {
-		  if(UartContext.SuspendState == hssSuspendWait) {
-			 /* Indicate the suspend is interrupted.                        */
-			 UartContext.SuspendState = hssSuspendWaitInterrupted;
-		  }
-		}
+		/* The controller is waking the transport.  A suspended UART is */
+		/* restarted before RTS is lowered and a suspend in progress is */
+		/* interrupted.  If the MCU was in STOP2 the clocks have already*/
+		/* been restored (see vPortSuppressTicksAndSleep()).            */
+		PerformSleepActions(HCISLEEP_Event(&UartContext.Sleep, hseControllerWake));
+
 		/* Enable the UART transmit interrupt if there is data in the buffer.*/
-		if(UartContext.TxBytesFree != OUTPUT_BUFFER_SIZE) {
+		if(UartContext.TxBytesQueued) {
 		   USARTEnableTXInterrupt();
 		   //TxInterrupt();
 		   //printString("USARTEnableTXInterrupt\n");
 		}
 		USARTEnableRXInterrupt();
-		FlowOn();
+
+		/* Only let the Bluetooth device send if there is room for the  */
+		/* data.                                                        */
+		if(!UartContext.RxFlowStopped) {
+			FlowOn();
+		}
 	}
 	/*
 	printString("CR1:");
@@ -235,31 +1136,211 @@ void HCITR_UART_IRQ_HANDLER(void)
 
 	/* Check to see if data is available in the Receive Buffer.          */
 	//if((Flags & (USART_SR_RXNE | USART_SR_ORE))) {
+#ifndef HCITR_ENABLE_DMA_TX
+
 	if((Flags & USART_ISR_TXE_TXFNF)) {
 		//HCITR_UART_BASE->SR &= ~USART_SR_TC;
 		//printString("TXE\n");
 		TxInterrupt();
 	}
 
+#endif
+
+
+#ifdef HCITR_ENABLE_DMA_RX
+
+	/* The line has gone idle, pick up whatever the DMA has received.    */
+	if((Flags & USART_ISR_IDLE)) {
+		HCITR_UART_BASE->ICR = USART_ICR_IDLECF;
+		RxDMAEvent();
+	}
+
+	if((Flags & USART_ISR_ORE)) {
+		DBG_MSG(DBG_ZONE_GENERAL, ("Receive Overflow\r\n"));
+		UartContext.RxUARTOverrunCount++;
+		HCITR_UART_BASE->ICR = USART_ICR_ORECF;
+	}
+
+#else
 
 	if((Flags & (USART_ISR_RXNE_RXFNE | USART_ISR_ORE))) {
 		//printString("RXE\n");
 		RxInterrupt();
-		HCITR_UART_BASE->ISR &= ~USART_ISR_RXNE_RXFNE;
-		HCITR_UART_BASE->ISR &= ~USART_ISR_ORE;
+		if((Flags & USART_ISR_ORE)) {
+			UartContext.RxUARTOverrunCount++;
+			HCITR_UART_BASE->ICR = USART_ICR_ORECF;
+		}
 	}
 
+#ifdef HCITR_ENABLE_UART_FIFO
+
+	/* The line has gone idle, the idle line interrupt only needs to be */
+	/* acknowledged as the receive FIFO was drained above.              */
+	if((Flags & USART_ISR_IDLE)) {
+		HCITR_UART_BASE->ICR = USART_ICR_IDLECF;
+	}
+
+#endif
+
+#endif
+
+	/* The error flags are only cleared by writing the ICR register.    */
 	if((Flags & USART_ISR_NE)) {
 		//printString("NE\n");
-		HCITR_UART_BASE->ISR &= ~USART_ISR_NE;
+		HCITR_UART_BASE->ICR = USART_ICR_NECF;
 	}
 
 	if((Flags & USART_ISR_FE)) {
 		//printString("FE\n");
-		HCITR_UART_BASE->ISR &= ~USART_ISR_FE;
+		HCITR_UART_BASE->ICR = USART_ICR_FECF;
 	}
 }
 
+#ifdef HCITR_ENABLE_FAST_BOOT
+
+   /* The following function starts the controller once it has been     */
+   /* released from reset (see HCITR_ENABLE_FAST_BOOT in HCITRCFG.h).   */
+   /* The parameter specifies the baud rate to switch to, or zero to    */
+   /* stay at the current baud rate.  While the controller is started   */
+   /* the received data is passed to the loader instead of the upper    */
+   /* layer.  The time of each phase is noted in the boot statistics.   */
+static void BootController(unsigned long BaudRate)
+{
+   unsigned int         Length;
+   unsigned int         Actions;
+   unsigned long        TimeStamp;
+   unsigned long        PhaseStart;
+   unsigned long        LastProgress;
+   unsigned short       LastOpCode;
+   const unsigned char *Command;
+
+   /* Wait for the controller to lower CTS, which it does once it is    */
+   /* ready to receive.                                                 */
+   PhaseStart   = GetTimeStamp();
+   LastProgress = BTPS_GetTickCount();
+
+   while((GetCTSLevel()) && ((BTPS_GetTickCount() - LastProgress) < HCITR_BOOT_TIMEOUT))
+      BTPS_Delay(1);
+
+   BootStatistics.CTSTimeout = (Boolean_t)(GetCTSLevel() ? TRUE : FALSE);
+
+   TimeStamp                 = GetTimeStamp();
+   BootStatistics.BootTime   = CyclesToMicroseconds(TimeStamp - PhaseStart);
+   BootStatistics.BaudRate   = HCITR_UART_HANDLE.Init.BaudRate;
+   PhaseStart                = TimeStamp;
+
+   /* Stay at the current baud rate if the new one is the same or can   */
+   /* not be generated (the controller must not be switched to a baud   */
+   /* rate that the UART can not follow).                               */
+   if((BaudRate == HCITR_UART_HANDLE.Init.BaudRate) || (BaudRate > (HCITR_UART_CLOCK / MINIMUM_BAUD_RATE_DIVISOR)))
+      BaudRate = 0;
+
+   HCIINIT_Initialize(&UartContext.InitLoader, InitScript, InitScriptLength, BaudRate);
+
+   if(UartContext.InitLoader.State == hisRunning)
+   {
+#ifdef HCITR_ENABLE_RX_TASK
+
+      UartContext.InitWaitTask = xTaskGetCurrentTaskHandle();
+
+#endif
+
+      UartContext.InitActions  = 0;
+      UartContext.InitActive   = TRUE;
+      LastOpCode               = 0;
+
+      while((UartContext.InitLoader.State == hisRunning) && (!BootStatistics.Status))
+      {
+         /* Pick up what the received events have done and get the next */
+         /* command.  No command is sent after the baud rate command has*/
+         /* completed until the UART has been switched.                 */
+         DisableInterrupts();
+
+         Actions                 = UartContext.InitActions;
+         UartContext.InitActions = 0;
+
+         if(!(Actions & HCIINIT_ACTION_CHANGE_BAUD_RATE))
+            Length = HCIINIT_GetCommand(&UartContext.InitLoader, &Command);
+         else
+            Length = 0;
+
+         EnableInterrupts();
+
+         if(Actions & HCIINIT_ACTION_PROGRESS)
+            LastProgress = BTPS_GetTickCount();
+
+         if(Actions & HCIINIT_ACTION_CHANGE_BAUD_RATE)
+         {
+            FlushTransmitter();
+
+            DisableInterrupts();
+            SetBaudRate(HCITR_UART_BASE, BaudRate);
+            EnableInterrupts();
+
+            TimeStamp                   = GetTimeStamp();
+            BootStatistics.BaudRateTime = CyclesToMicroseconds(TimeStamp - PhaseStart);
+            BootStatistics.BaudRate     = BaudRate;
+            PhaseStart                  = TimeStamp;
+         }
+
+         if(Length)
+         {
+            LastOpCode = (unsigned short)(Command[1] | (Command[2] << 8));
+
+            if(HCITR_COMWrite(TRANSPORT_ID, Length, (unsigned char *)Command))
+            {
+               BootStatistics.Status       = HCITR_ERROR_INITIALIZATION_FAILED;
+               BootStatistics.FailedOpCode = LastOpCode;
+            }
+         }
+         else
+         {
+            if((BTPS_GetTickCount() - LastProgress) >= HCITR_BOOT_COMMAND_TIMEOUT)
+            {
+               BootStatistics.Status       = HCITR_ERROR_INITIALIZATION_FAILED;
+               BootStatistics.FailedOpCode = LastOpCode;
+            }
+            else
+            {
+               /* Wait for the controller to respond.                   */
+#ifdef HCITR_ENABLE_RX_TASK
+
+               ulTaskNotifyTake(pdTRUE, 1);
+
+#else
+
+               ProcessReceivedData();
+
+               if(!UartContext.InitActions)
+                  BTPS_Delay(1);
+
+#endif
+            }
+         }
+      }
+
+      UartContext.InitActive = FALSE;
+
+      if(UartContext.InitLoader.State == hisFailed)
+      {
+         BootStatistics.Status       = HCITR_ERROR_INITIALIZATION_FAILED;
+         BootStatistics.FailedOpCode = UartContext.InitLoader.FailedOpCode;
+         BootStatistics.FailedStatus = UartContext.InitLoader.FailedStatus;
+      }
+
+      /* The script phase starts once the baud rate has been switched.  */
+      if((UartContext.InitLoader.ScriptLength) && ((!BaudRate) || (BootStatistics.BaudRate == BaudRate)))
+      {
+         BootStatistics.ScriptTime     = CyclesToMicroseconds(GetTimeStamp() - PhaseStart);
+         BootStatistics.ScriptCommands = UartContext.InitLoader.CommandsSent - ((BaudRate) ? 1 : 0);
+      }
+
+      BootStatistics.MaximumOutstanding = UartContext.InitLoader.MaximumOutstanding;
+   }
+}
+
+#endif
+
    /* The following function is responsible for opening the HCI         */
    /* Transport layer that will be used by Bluetopia to send and receive*/
    /* COM (Serial) data.  This function must be successfully issued in  */
@@ -274,7 +1355,9 @@ void HCITR_UART_IRQ_HANDLER(void)
    /* negative return value to signify an error.                        */
 int BTPSAPI HCITR_COMOpen(HCI_COMMDriverInformation_t *COMMDriverInformation, HCITR_COMDataCallback_t COMDataCallback, unsigned long CallbackParameter)
 {
-   int ret_val;
+   int           ret_val;
+   unsigned long OpenTime;
+   unsigned long ResetTime;
    //printString("HCITR_COMOpen\n");
    /* First, make sure that the port is not already open and make sure  */
    /* that valid COMM Driver Information was specified.                 */
@@ -291,25 +1374,111 @@ int BTPSAPI HCITR_COMOpen(HCI_COMMDriverInformation_t *COMMDriverInformation, HC
 
       UartContext.COMDataCallbackFunction  = COMDataCallback;
       UartContext.COMDataCallbackParameter = CallbackParameter;
-      UartContext.TxBytesFree              = OUTPUT_BUFFER_SIZE;
-      UartContext.RxBytesFree              = INPUT_BUFFER_SIZE;
-      UartContext.SuspendState             = hssNormal;
+      UartContext.StatisticsStartTime      = BTPS_GetTickCount();
+
+      HCISLEEP_Initialize(&UartContext.Sleep);
+
+#if (defined(SUPPORT_TRANSPORT_SUSPEND) && defined(HCITR_ENABLE_LOW_POWER_STOP))
+
+      /* The MCU must not stop while the transport is awake.            */
+      LOWPOWER_PreventStop(LOWPOWER_LOCK_HCI_TRANSPORT);
+
+#endif
+
+#ifdef HCITR_ENABLE_RX_TASK
+
+      /* Create the receive task the first time the transport is opened.*/
+      if(!RxTaskHandle)
+         RxTaskHandle = xTaskCreateStatic(RxTask, "HCITR_Rx", HCITR_RX_TASK_STACK_SIZE, NULL, HCITR_RX_TASK_PRIORITY, RxTaskStack, &RxTaskBuffer);
+
+#endif
+
+#ifdef HCITR_ENABLE_DMA_TX
+
+      /* Create the transmitter mutex the first time the transport is   */
+      /* opened.                                                        */
+      if(!TxWaitMutex)
+         TxWaitMutex = xSemaphoreCreateMutexStatic(&TxWaitMutexBuffer);
+
+#endif
+
+#ifdef HCITR_ENABLE_TX_PRIORITY_QUEUES
+
+      InitializeTxQueue(&(UartContext.TxQueue[HCITR_TX_CLASS_SCO]), UartContext.TxSCOBuffer, SCO_OUTPUT_BUFFER_SIZE);
+      InitializeTxQueue(&(UartContext.TxQueue[HCITR_TX_CLASS_COMMAND]), UartContext.TxCommandBuffer, COMMAND_OUTPUT_BUFFER_SIZE);
+
+#endif
+
+      InitializeTxQueue(&(UartContext.TxQueue[TX_QUEUE_INDEX(HCITR_TX_CLASS_ACL)]), UartContext.TxBuffer, OUTPUT_BUFFER_SIZE);
+
+      /* Start the cycle counter that is used to time stamp transmitted */
+      /* packets.                                                       */
+      CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+      DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
+      BTPS_MemInitialize(&BootStatistics, 0, sizeof(BootStatistics));
+
+      OpenTime          = GetTimeStamp();
+
+      /* Use the receive buffer configuration that is currently set.    */
+      UartContext.FlowOffThreshold         = FlowConfiguration.FlowOffThreshold;
+      UartContext.FlowOnThreshold          = FlowConfiguration.FlowOnThreshold;
+
+      HCIRING_Initialize(&UartContext.RxRing, UartContext.RxBuffer, FlowConfiguration.ReceiveBufferSize);
+
+#ifdef HCITR_ENABLE_H4_FRAMING
+
+      HCIH4_Initialize(&UartContext.RxFramer, H4_FRAME_LENGTH(FlowConfiguration.ReceiveBufferSize, FlowConfiguration.FlowOffThreshold));
+
+#endif
       //UartContext.DebugEnabled				= ENABLE;
 
 
       /* Enable the peripheral clocks for the UART and its GPIO.        */
       EnableUartPeriphClock();
+      ReleaseTxdLine();
       USARTDisableTXInterrupt();
       USARTDisableCTSInterrupt();
 
       //__HAL_UART_CLEAR_FLAG(&huart2, (UART_CLEAR_TCF | UART_CLEAR_TXFECF));
 
       MX_USART2_UART_Init();
+
+#ifdef HCITR_ENABLE_UART_FIFO
+
+      /* The generated initialization leaves the FIFOs disabled, enable */
+      /* them with the thresholds used by this module.                  */
+      HAL_UARTEx_SetTxFifoThreshold(&HCITR_UART_HANDLE, HCITR_UART_TX_FIFO_THRESHOLD);
+      HAL_UARTEx_SetRxFifoThreshold(&HCITR_UART_HANDLE, HCITR_UART_RX_FIFO_THRESHOLD);
+      HAL_UARTEx_EnableFifoMode(&HCITR_UART_HANDLE);
+
+#endif
+
       USARTEnableRXInterrupt();
       FlowOff();
 
+#ifdef HCITR_ENABLE_DMA_RX
+
+      /* Start the circular receive DMA into the input buffer.  This    */
+      /* also enables the idle line interrupt.                          */
+      HAL_UARTEx_ReceiveToIdle_DMA(&HCITR_UART_HANDLE, UartContext.RxBuffer, UartContext.RxRing.Size);
+
+#endif
+
+#ifdef HCITR_ENABLE_DMA_TX
+
+      /* The transmit DMA is driven directly by this module, install the*/
+      /* callbacks that are called from the DMA interrupt.              */
+      HCITR_UART_HANDLE.hdmatx->XferCpltCallback     = TxDMAComplete;
+      HCITR_UART_HANDLE.hdmatx->XferHalfCpltCallback = NULL;
+      HCITR_UART_HANDLE.hdmatx->XferErrorCallback    = TxDMAComplete;
+      HCITR_UART_HANDLE.hdmatx->XferAbortCallback    = NULL;
+
+#endif
+
 
       SetReset();
+      ResetTime = GetTimeStamp();
       /* Clear the reset.                                               */
       BTPS_Delay(20);
       //EXTI->PR |= EXTI_PR_PR9;
@@ -319,8 +1488,22 @@ int BTPSAPI HCITR_COMOpen(HCI_COMMDriverInformation_t *COMMDriverInformation, HC
 
       //printString("CTS enable\n");
       ClearReset();
+      BootStatistics.ResetTime = CyclesToMicroseconds(GetTimeStamp() - ResetTime);
+
+#ifdef HCITR_ENABLE_FAST_BOOT
+
+      BootController(COMMDriverInformation->BaudRate);
+
+#else
+
       BTPS_Delay(250);
 
+      BootStatistics.BaudRate = HCITR_UART_HANDLE.Init.BaudRate;
+
+#endif
+
+      BootStatistics.TotalTime = CyclesToMicroseconds(GetTimeStamp() - OpenTime);
+
    } else {
       ret_val = HCITR_ERROR_UNABLE_TO_OPEN_TRANSPORT;
    }
@@ -363,6 +1546,18 @@ void BTPSAPI HCITR_COMClose(unsigned int HCITransportID)
       /* Flag that the HCI Transport is no longer open.                 */
       HCITransportOpen = 0;
 
+#ifdef HCITR_ENABLE_RX_TASK
+
+      /* Wait for the receive task to finish passing up any data, unless*/
+      /* the port is being closed from the receive task itself.         */
+      if(xTaskGetCurrentTaskHandle() != RxTaskHandle)
+      {
+         while(UartContext.RxTaskBusy)
+            BTPS_Delay(1);
+      }
+
+#endif
+
 #if (defined(SUPPORT_TRANSPORT_SUSPEND) || defined(USE_SOFTWARE_CTS_RTS))
 
       /* Disable external interrupt for the CTS line                    */
@@ -381,6 +1576,24 @@ void BTPSAPI HCITR_COMClose(unsigned int HCITransportID)
       USARTDisableTXInterrupt();
       USARTDisableCTSInterrupt();
       FlowOff();
+
+#ifdef HCITR_ENABLE_DMA_RX
+
+      /* Stop the receive DMA.                                          */
+      HAL_UART_AbortReceive(&HCITR_UART_HANDLE);
+
+#endif
+
+#ifdef HCITR_ENABLE_DMA_TX
+
+      /* Stop the transmit DMA.                                         */
+      HCITR_UART_BASE->CR3 &= ~USART_CR3_DMAT;
+      HAL_DMA_Abort(HCITR_UART_HANDLE.hdmatx);
+
+      UartContext.TxDMAActive = FALSE;
+      UartContext.TxDMADirect = FALSE;
+
+#endif
       //USART_ITConfig(HCITR_UART_BASE, USART_IT_RXNE, DISABLE);
       //USART_ITConfig(HCITR_UART_BASE, USART_IT_TXE,  DISABLE);
 
@@ -428,89 +1641,375 @@ void BTPSAPI HCITR_COMReconfigure(unsigned int HCITransportID, HCI_Driver_Reconf
          /* Check if the baud rate needs to change.                     */
          if(ReconfigureInformation->ReconfigureFlags & (HCI_COMM_RECONFIGURE_INFORMATION_RECONFIGURE_FLAGS_CHANGE_BAUDRATE | HCI_COMM_RECONFIGURE_INFORMATION_RECONFIGURE_FLAGS_CHANGE_PROTOCOL))
          {
+            /* Let any data queued at the current baud rate go out      */
+            /* before switching.                                        */
+            FlushTransmitter();
+
             DisableInterrupts();
-            SetBaudRate(HCITR_UART_BASE, ReconfigureInformation->BaudRate);
+            if(SetBaudRate(HCITR_UART_BASE, ReconfigureInformation->BaudRate))
+            {
+               DBG_MSG(DBG_ZONE_GENERAL, ("Unsupported Baud Rate %lu\r\n", (unsigned long)ReconfigureInformation->BaudRate));
+            }
             EnableInterrupts();
          }
       }
    }
 }
 
-   /* The following function is provided to allow a mechanism for       */
-   /* modules to force the processing of incoming COM Data.             */
-   /* * NOTE * This function is only applicable in device stacks that   */
-   /*          are non-threaded.  This function has no effect for device*/
-   /*          stacks that are operating in threaded environments.      */
-void BTPSAPI HCITR_COMProcess(unsigned int HCITransportID)
+   /* The following function passes the data that has been received to  */
+   /* the upper layer.  Each pass of the loop processes one packet (or  */
+   /* the data that can be read before the end of the buffer is reached */
+   /* when H4 framing is disabled).                                     */
+static void ProcessReceivedData(void)
 {
-   unsigned int MaxLength;
-   unsigned int TotalLength;
-//   printString("HCITR_COMProcess\n");
+   unsigned int   TotalLength;
+   unsigned char *Data;
+
 #ifdef HCITR_ENABLE_DEBUG_LOGGING
 
    unsigned int Index;
 
 #endif
 
-   /* Check to make sure that the specified Transport ID is valid.      */
-   if((HCITransportID == TRANSPORT_ID) && (HCITransportOpen))
+#ifdef HCITR_ENABLE_DMA_RX
+
+   /* Pick up any data the DMA has received since the last event.       */
+   DisableInterrupts();
+   RxDMAEvent();
+   EnableInterrupts();
+
+#endif
+
+#ifdef HCITR_ENABLE_H4_FRAMING
+
+   /* Loop until there are no more complete packets in the receive      */
+   /* buffer.                                                           */
+   while((TotalLength = HCIH4_GetFrame(&UartContext.RxFramer, &UartContext.RxRing, &Data)) != 0)
+
+#else
+
+   /* Loop until the receive buffer is empty.  Each pass processes      */
+   /* the characters that can be read before the end of the buffer      */
+   /* is reached.                                                       */
+   while((TotalLength = HCIRING_GetSpan(&UartContext.RxRing, &Data)) != 0)
+
+#endif
    {
-      /* Loop until the receive buffer is empty.                        */
-      while((TotalLength = (INPUT_BUFFER_SIZE - UartContext.RxBytesFree)) != 0)
+#ifdef HCITR_ENABLE_DEBUG_LOGGING
+
+      if(UartContext.DebugEnabled)
       {
-         /* Determine the maximum number of characters that we can send */
-         /* before we reach the end of the buffer.  We need to process  */
-         /* the smaller of the max characters or the number of          */
-         /* characters that are in the buffer.                          */
-         MaxLength   = (INPUT_BUFFER_SIZE - UartContext.RxOutIndex);
-         if(TotalLength > MaxLength)
-            TotalLength = MaxLength;
+         DEBUG_PRINT(">");
 
-#ifdef HCITR_ENABLE_DEBUG_LOGGING
+         for(Index = 0; Index < TotalLength; Index ++)
+            DEBUG_PRINT(" %02X", Data[Index]);
+
+         DEBUG_PRINT("\r\n");
+      }
+
+#endif
+
+#ifdef HCITR_ENABLE_SNOOP_CAPTURE
+
+      CapturePacket(1, TotalLength, Data);
+
+#endif
+
+#ifdef HCITR_ENABLE_FAST_BOOT
+
+      /* While the controller is being started the events answer the    */
+      /* commands of the loader, which runs at a lower priority than    */
+      /* this function (see BootController()).                          */
+      if(UartContext.InitActive)
+      {
+         UartContext.InitActions |= HCIINIT_ProcessData(&UartContext.InitLoader, TotalLength, Data);
+
+#ifdef HCITR_ENABLE_RX_TASK
+
+         if(UartContext.InitWaitTask)
+            xTaskNotifyGive(UartContext.InitWaitTask);
+
+#endif
+      }
+      else
+
+#endif
+
+      /* Call the upper layer back with the data.                       */
+      if(UartContext.COMDataCallbackFunction)
+      {
+         UartContext.RxCallbackCount++;
+
+         (*UartContext.COMDataCallbackFunction)(TRANSPORT_ID, TotalLength, Data, UartContext.COMDataCallbackParameter);
+      }
+
+      /* Credit the amount that was processed and make sure the         */
+      /* receive interrupt is enabled.                                  */
+      DisableInterrupts();
+      HCIRING_Consume(&UartContext.RxRing, TotalLength);
+      //USART_ITConfig(HCITR_UART_BASE, USART_IT_RXNE, ENABLE);
+      USARTEnableRXInterrupt();
+
+      if((UartContext.RxFlowStopped) && (UartContext.Sleep.State == hslAwake))
+      {
+         /* If the input buffer has passed the flow on threshold,       */
+         /* re-enable flow control.                                     */
+         if(UartContext.RxRing.BytesFree >= RX_FLOW_ON_THRESHOLD)
+         {
+            UartContext.RxFlowStopped = FALSE;
+
+            FlowOn();
+         }
+      }
+
+      EnableInterrupts();
+   }
+}
+
+#ifdef HCITR_ENABLE_RX_TASK
+
+   /* The following function wakes up the receive task.  It may be      */
+   /* called from an interrupt or, with interrupts disabled, from a     */
+   /* task.  The time stamp of the first signal that has not been       */
+   /* handled yet is noted to measure the latency of the task.          */
+   /* * NOTE * The receive task does not need to wake itself up, it     */
+   /*          processes any data it picks up before it waits again.    */
+static void SignalRxTask(void)
+{
+   BaseType_t HigherPriorityTaskWoken;
+
+   if((RxTaskHandle) && ((xPortIsInsideInterrupt()) || (xTaskGetCurrentTaskHandle() != RxTaskHandle)))
+   {
+      if(!UartContext.RxTaskSignaled)
+      {
+         UartContext.RxTaskSignaled    = TRUE;
+         UartContext.RxSignalTimeStamp = GetTimeStamp();
+      }
+
+      if(xPortIsInsideInterrupt())
+      {
+         HigherPriorityTaskWoken = pdFALSE;
+
+         vTaskNotifyGiveFromISR(RxTaskHandle, &HigherPriorityTaskWoken);
+
+         portYIELD_FROM_ISR(HigherPriorityTaskWoken);
+      }
+      else
+         xTaskNotifyGive(RxTaskHandle);
+   }
+}
+
+   /* The following function is the receive task.  It waits for a       */
+   /* notification that data has been received and then passes all of   */
+   /* the data that has been received to the upper layer.               */
+static void RxTask(void *Parameter)
+{
+   unsigned long Latency;
+
+   while(1)
+   {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+      UartContext.RxTaskBusy = TRUE;
+
+      if(HCITransportOpen)
+      {
+         DisableInterrupts();
+
+         if(UartContext.RxTaskSignaled)
+         {
+            Latency = CyclesToMicroseconds(GetTimeStamp() - UartContext.RxSignalTimeStamp);
+            if(Latency > UartContext.RxMaximumLatency)
+               UartContext.RxMaximumLatency = Latency;
+
+            UartContext.RxTaskSignaled = FALSE;
+         }
+
+         UartContext.RxTaskWakeupCount++;
+
+         EnableInterrupts();
+
+         ProcessReceivedData();
+      }
+
+      UartContext.RxTaskBusy = FALSE;
+   }
+}
+
+#endif
+
+#ifdef HCITR_ENABLE_SNOOP_CAPTURE
+
+   /* The following function returns the current date and time of the   */
+   /* RTC as a btsnoop time stamp (microseconds since 0 AD).            */
+static unsigned long long GetRTCTime(void)
+{
+   RTC_TimeTypeDef Time;
+   RTC_DateTypeDef Date;
+   unsigned long   Year;
+   unsigned long   Month;
+   unsigned long   Days;
+
+   /* The date must be read after the time to unlock the shadow         */
+   /* registers.                                                        */
+   HAL_RTC_GetTime(&hrtc, &Time, RTC_FORMAT_BIN);
+   HAL_RTC_GetDate(&hrtc, &Date, RTC_FORMAT_BIN);
+
+   /* Count the days since the Unix epoch, with the year starting in    */
+   /* March so that the leap day is the last day of the year.           */
+   Year  = 2000 + Date.Year;
+   Month = Date.Month;
+   if(Month <= 2)
+   {
+      Year--;
+      Month += 12;
+   }
+
+   Days  = (365 * Year) + (Year / 4) - (Year / 100) + (Year / 400);
+   Days += ((153 * (Month - 3)) + 2) / 5;
+   Days += Date.Date - 1;
+   Days -= 719468;
+
+   return(HCISNOOP_UNIX_EPOCH_OFFSET + ((((unsigned long long)Days * 86400) + ((unsigned long)Time.Hours * 3600) + ((unsigned long)Time.Minutes * 60) + Time.Seconds) * 1000000));
+}
+
+   /* The following function advances the capture time to the current   */
+   /* time and returns it.                                              */
+   /* * NOTE * The cycle counter stops while the MCU is in STOP2 (and   */
+   /*          wraps after about 35 seconds), so the time measured with */
+   /*          it is never allowed to fall behind the tick count.       */
+   /* * NOTE * This function must be called with the scheduler          */
+   /*          suspended.                                               */
+static unsigned long long GetCaptureTime(void)
+{
+   unsigned long      Cycles;
+   unsigned long      CyclesPerMicrosecond;
+   unsigned long      Elapsed;
+   unsigned long long TickElapsed;
+   TickType_t         Tick;
+
+   Cycles               = GetTimeStamp();
+   Tick                 = xTaskGetTickCount();
+   CyclesPerMicrosecond = SystemCoreClock / 1000000;
+
+   TickElapsed = (unsigned long long)(Tick - SnoopLastTick) * portTICK_PERIOD_MS * 1000;
+
+   if(TickElapsed < SNOOP_MAXIMUM_CYCLE_TIME)
+   {
+      Elapsed             = (Cycles - SnoopLastCycles) + SnoopCycleRemainder;
+      SnoopCycleRemainder = Elapsed % CyclesPerMicrosecond;
+      Elapsed            /= CyclesPerMicrosecond;
+
+      /* The last tick period may only have partly elapsed.             */
+      if((TickElapsed > (portTICK_PERIOD_MS * 1000)) && (Elapsed < (TickElapsed - (portTICK_PERIOD_MS * 1000))))
+         Elapsed = (unsigned long)(TickElapsed - (portTICK_PERIOD_MS * 1000));
+
+      SnoopTime += Elapsed;
+   }
+   else
+   {
+      SnoopCycleRemainder  = 0;
+      SnoopTime           += TickElapsed;
+   }
+
+   SnoopLastCycles = Cycles;
+   SnoopLastTick   = Tick;
+
+   return(SnoopTime);
+}
+
+   /* The following function captures the specified packet if a capture */
+   /* is running.  The second parameter is non-zero for a packet that   */
+   /* was received from the controller.  The capture task is woken if   */
+   /* enough data is waiting to be written.                             */
+   /* * NOTE * The transmit and receive paths are serialized (as the    */
+   /*          staging ring allows only a single producer) by suspending*/
+   /*          the scheduler, interrupts are never disabled.            */
+static void CapturePacket(int Received, unsigned int Length, unsigned char *Data)
+{
+   unsigned int Used;
+
+   if(SnoopCapturing)
+   {
+      vTaskSuspendAll();
+
+      HCISNOOP_Capture(&SnoopRing, Received, GetCaptureTime(), Length, Data);
+
+      Used = HCISNOOP_GetUsed(&SnoopRing);
+
+      xTaskResumeAll();
+
+      if(Used >= SNOOP_FLUSH_THRESHOLD)
+         xTaskNotifyGive(SnoopTaskHandle);
+   }
+}
+
+   /* The following function is the task that writes the captured data  */
+   /* from the staging ring to the capture file.  It runs at a low      */
+   /* priority so that the file system and the SD card never delay the  */
+   /* transport or the audio.                                           */
+static void SnoopTask(void *Parameter)
+{
+   unsigned int   Length;
+   unsigned char *Data;
+   UINT           Written;
+   Boolean_t      Stopping;
+
+   while(1)
+   {
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SNOOP_FLUSH_INTERVAL));
+
+      if(SnoopFileOpen)
+      {
+         /* Only whole blocks are written until the capture is stopped. */
+         Stopping = SnoopStopRequested;
+
+         while((Length = HCISNOOP_GetBlock(&SnoopRing, SNOOP_BLOCK_SIZE, Stopping, &Data)) != 0)
+         {
+            if((f_write(&SnoopFile, Data, Length, &Written) == FR_OK) && (Written == Length))
+               SnoopBytesWritten += Length;
+            else
+               SnoopWriteErrors++;
+
+            HCISNOOP_Release(&SnoopRing, Length);
+         }
 
-         if(UartContext.DebugEnabled)
+         if(Stopping)
          {
-            DEBUG_PRINT(">");
-
-            for(Index = 0; Index < TotalLength; Index ++)
-               DEBUG_PRINT(" %02X", UartContext.RxBuffer[UartContext.RxOutIndex + Index]);
+            f_close(&SnoopFile);
 
-            DEBUG_PRINT("\r\n");
+            SnoopStopRequested = FALSE;
+            SnoopFileOpen      = FALSE;
          }
+      }
+   }
+}
 
 #endif
 
-         /* Call the upper layer back with the data.                    */
-         if(UartContext.COMDataCallbackFunction)
-            (*UartContext.COMDataCallbackFunction)(TRANSPORT_ID, TotalLength, &(UartContext.RxBuffer[UartContext.RxOutIndex]), UartContext.COMDataCallbackParameter);
+   /* The following function is provided to allow a mechanism for       */
+   /* modules to force the processing of incoming COM Data.             */
+   /* * NOTE * This function is only applicable in device stacks that   */
+   /*          are non-threaded.  This function has no effect for device*/
+   /*          stacks that are operating in threaded environments.      */
+   /* * NOTE * When the receive task is enabled the data is always      */
+   /*          processed by that task, this function only wakes it up.  */
+void BTPSAPI HCITR_COMProcess(unsigned int HCITransportID)
+{
+//   printString("HCITR_COMProcess\n");
+   /* Check to make sure that the specified Transport ID is valid.      */
+   if((HCITransportID == TRANSPORT_ID) && (HCITransportOpen))
+   {
+#ifdef HCITR_ENABLE_RX_TASK
 
-         /* Adjust the Out Index and handle any looping.                */
-         UartContext.RxOutIndex += TotalLength;
-         if(UartContext.RxOutIndex == INPUT_BUFFER_SIZE)
-            UartContext.RxOutIndex = 0;
+      if(RxTaskHandle)
+         xTaskNotifyGive(RxTaskHandle);
 
-         /* Credit the amount that was processed and make sure the      */
-         /* receive interrupt is enabled.                               */
-         DisableInterrupts();
-         UartContext.RxBytesFree += TotalLength;
-         //USART_ITConfig(HCITR_UART_BASE, USART_IT_RXNE, ENABLE);
-         USARTEnableRXInterrupt();
-         EnableInterrupts();
-/*
-#ifdef USE_SOFTWARE_CTS_RTS
+#else
 
-         if(UartContext.SuspendState == hssNormal)
-         {
-            // If the input buffer has passed the flow on threshold,
-            // re-enable flow control.
-            if(UartContext.RxBytesFree >= FLOW_ON_THRESHOLD)
-               FlowOn();
-         }
+      ProcessReceivedData();
 
 #endif
- */
-
-      }
    }
 }
 
@@ -538,9 +2037,13 @@ int BTPSAPI HCITR_COMWrite(unsigned int HCITransportID, unsigned int Length, uns
 	//printUnsignedInt(Length);
 	//printString("\n");
 
-	int ret_val;
-	int Count;
-	int BytesFree;
+	int            ret_val;
+	int            Count;
+	int            BytesFree;
+	unsigned int   Class;
+	unsigned long  TimeStamp;
+	TxQueue_t     *Queue;
+	TxPacket_t    *Packet;
 
 #ifdef HCITR_ENABLE_DEBUG_LOGGING
 
@@ -553,13 +2056,11 @@ int BTPSAPI HCITR_COMWrite(unsigned int HCITransportID, unsigned int Length, uns
    if((HCITransportID == TRANSPORT_ID) && (HCITransportOpen) && (Length) && (Buffer))
    {
       /* If the UART is suspended, resume it.                           */
-      if(UartContext.SuspendState == hssSuspended)
+      if(UartContext.Sleep.State == hslSuspended)
       {
          DisableInterrupts();
 
-         EnableUartPeriphClock();
-         SetSuspendGPIO(FALSE);
-         UartContext.SuspendState = hssNormal;
+         PerformSleepActions(HCISLEEP_Event(&UartContext.Sleep, hseHostWake));
 
          EnableInterrupts();
       }
@@ -577,25 +2078,116 @@ int BTPSAPI HCITR_COMWrite(unsigned int HCITransportID, unsigned int Length, uns
 
 #endif
 
+#ifdef HCITR_ENABLE_SNOOP_CAPTURE
+
+      CapturePacket(0, Length, Buffer);
+
+#endif
+
+      /* Determine the queue of the packet from its packet indicator.   */
+      /* * NOTE * Each call is assumed to write one complete packet, as */
+      /*          Bluetopia does.                                       */
+      Class     = GetTxClass(Buffer[0]);
+      Queue     = &(UartContext.TxQueue[TX_QUEUE_INDEX(Class)]);
+      TimeStamp = GetTimeStamp();
+
+#ifdef HCITR_ENABLE_DMA_TX
+
+      /* Become the task that waits for the transmitter, this is done   */
+      /* before any of the conditions are checked so that a             */
+      /* notification from the DMA interrupt can not be missed.  Other  */
+      /* writers wait here until this packet has been queued (or sent). */
+      AcquireTransmitter();
+
+      /* If the transmitter is idle, larger packets are sent directly   */
+      /* from the caller's buffer rather than copied to the output      */
+      /* buffer first.                                                  */
+      if(Length >= DMA_TX_DIRECT_THRESHOLD)
+      {
+         DisableInterrupts();
+
+         if((!UartContext.TxDMAActive) && (!UartContext.TxBytesQueued) && (!UartContext.TxCurrentQueue))
+         {
+            UartContext.TxCurrentClass     = Class;
+            UartContext.TxCurrentTimeStamp = TimeStamp;
+
+            StartTxTransfer(Buffer, Length);
+
+            UartContext.TxDMADirect = TRUE;
+
+            Length = 0;
+         }
+
+         EnableInterrupts();
+
+         /* The caller's buffer must not be released before the DMA has */
+         /* finished with it.                                           */
+         while(UartContext.TxDMADirect)
+            WaitForTransmitter();
+      }
+
+#endif
+
+      if(Length)
+      {
+         /* Wait for room for the packet in the queue.                  */
+#ifdef HCITR_ENABLE_DMA_TX
+
+         while(Queue->PacketCount == TX_QUEUE_PACKETS)
+            WaitForTransmitter();
+
+#else
+
+         while(Queue->PacketCount == TX_QUEUE_PACKETS) {}
+
+#endif
+
+         /* Queue the packet before its data is written so that a packet*/
+         /* larger than the buffer is sent as the data is written.      */
+         DisableInterrupts();
+
+         Packet            = &(Queue->Packets[Queue->PacketInIndex]);
+         Packet->Length    = Length;
+         Packet->Class     = Class;
+         Packet->TimeStamp = TimeStamp;
+
+         Queue->PacketInIndex++;
+         if(Queue->PacketInIndex == TX_QUEUE_PACKETS)
+            Queue->PacketInIndex = 0;
+
+         Queue->PacketCount++;
+
+         EnableInterrupts();
+      }
+
       /* Process all of the data.                                       */
       while(Length)
       {
          /* Wait for space in the transmit buffer.                      */
-         while(!UartContext.TxBytesFree) {}
+#ifdef HCITR_ENABLE_DMA_TX
+
+         while(!Queue->BytesFree)
+            WaitForTransmitter();
+
+#else
+
+         while(!Queue->BytesFree) {}
+
+#endif
 
          /* The data may have to be copied in 2 phases.  Calculate the  */
          /* number of character that can be placed in the buffer before */
          /* the buffer must be wrapped.                                 */
-         BytesFree = UartContext.TxBytesFree;
+         BytesFree = Queue->BytesFree;
          Count = Length;
          // If Count bigger than BytesFree in TxBuffer only BytesFree will be copy
          Count = (BytesFree < Count) ? BytesFree : Count;
-         Count = ((OUTPUT_BUFFER_SIZE - UartContext.TxInIndex) < Count) ? (OUTPUT_BUFFER_SIZE - UartContext.TxInIndex) : Count;
+         Count = ((Queue->Size - Queue->InIndex) < Count) ? (Queue->Size - Queue->InIndex) : Count;
 
          //printString("Count: ");
          //printUnsignedInt(Count);
          //printString("\n");
-         BTPS_MemCopy(&(UartContext.TxBuffer[UartContext.TxInIndex]), Buffer, Count);
+         BTPS_MemCopy(&(Queue->Buffer[Queue->InIndex]), Buffer, Count);
 
          /* Update the number of free bytes in the buffer.  Since this  */
          /* count can also be updated in the interrupt routine, we will */
@@ -604,15 +2196,16 @@ int BTPSAPI HCITR_COMWrite(unsigned int HCITransportID, unsigned int Length, uns
          /* Adjust the index values.                                    */
          Buffer                  += Count;
          Length                  -= Count;
-         UartContext.TxInIndex   += Count;
-         if(UartContext.TxInIndex == OUTPUT_BUFFER_SIZE) {
-            UartContext.TxInIndex = 0;
+         Queue->InIndex          += Count;
+         if(Queue->InIndex == Queue->Size) {
+            Queue->InIndex = 0;
          }
 
          /* Update the bytes free and make sure the transmit interrupt  */
          /* is enabled.                                                 */
          DisableInterrupts();
-         UartContext.TxBytesFree -= Count;
+         Queue->BytesFree          -= Count;
+         UartContext.TxBytesQueued += Count;
          //HCITR_UART_BASE->TDR = (UartContext.TxBuffer[UartContext.TxOutIndex]);
          USARTEnableTXInterrupt();
          USARTEnableRXInterrupt();
@@ -620,6 +2213,12 @@ int BTPSAPI HCITR_COMWrite(unsigned int HCITransportID, unsigned int Length, uns
          //printString("WriteDR\n");
       }
 
+#ifdef HCITR_ENABLE_DMA_TX
+
+      ReleaseTransmitter();
+
+#endif
+
       ret_val = 0;
    }
    else
@@ -646,43 +2245,54 @@ int BTPSAPI HCITR_COMWrite(unsigned int HCITransportID, unsigned int Length, uns
    /*          transport to operate are disabled.                       */
 int BTPSAPI HCITR_COMSuspend(unsigned int HCITransportID)
 {
-   int ret_val;
+   int          ret_val;
+   unsigned int Actions;
    //printString("HCITR_COMSuspend\n");
 #ifdef SUPPORT_TRANSPORT_SUSPEND
 
    if(HCITransportID == TRANSPORT_ID)
    {
-      /* Signal that we are waiting for a suspend operation to complete.*/
-      UartContext.SuspendState = hssSuspendWait;
+      /* Signal that we are waiting for a suspend operation to complete */
+      /* and stop the controller from sending.                          */
+      DisableInterrupts();
 
-      /* Set the CTS interrupt.                                         */
-      SetSuspendGPIO(TRUE);
+      PerformSleepActions(HCISLEEP_Event(&UartContext.Sleep, hseSuspendRequest));
+
+      EnableInterrupts();
+
+#ifdef HCITR_ENABLE_DMA_TX
+
+      /* Wait for a transfer from a caller's buffer to complete.        */
+      while((UartContext.TxDMAActive) && (UartContext.Sleep.State == hslSuspendWait)) {}
+
+#endif
 
       /* Wait for the UART transmit buffer and FIFO to be empty.        */
       //while(((UartContext.TxBytesFree != OUTPUT_BUFFER_SIZE) || (USART_GetFlagStatus(HCITR_UART_BASE, UART_FLAG_TC) != SET)) && (UartContext.SuspendState == hssSuspendWait)) {}
-      while(((UartContext.TxBytesFree != OUTPUT_BUFFER_SIZE) || (HCITR_UART_BASE->ISR & USART_ISR_TC == 0)) && (UartContext.SuspendState == hssSuspendWait)) {}
+      while(((UartContext.TxBytesQueued) || (!(HCITR_UART_BASE->ISR & USART_ISR_TC))) && (UartContext.Sleep.State == hslSuspendWait)) {}
 
 
       /* Confirm that no data was received in this time and suspend the */
       /* UART.                                                          */
       DisableInterrupts();
 
-      if(UartContext.SuspendState == hssSuspendWait)
-      {
-         UartContext.SuspendState = hssSuspended;
+#ifdef HCITR_ENABLE_DMA_RX
+
+      /* Account for anything the DMA received since the last event.    */
+      RxDMAEvent();
 
-         /* Disable the UART clock.                                     */
-         DisableUartPeriphClock();
+#endif
+
+      /* If nothing interrupted the suspend the UART clock is stopped,  */
+      /* otherwise the suspend is aborted.                              */
+      Actions = HCISLEEP_Event(&UartContext.Sleep, hseWaitComplete);
 
+      PerformSleepActions(Actions);
+
+      if(Actions & HCISLEEP_ACTION_SUSPENDED)
          ret_val = 0;
-      }
       else
-      {
-         /* Data was received, abort suspending the UART.               */
-         SetSuspendGPIO(FALSE);
-
          ret_val = HCITR_ERROR_SUSPEND_ABORTED;
-      }
 
       EnableInterrupts();
 
@@ -722,12 +2332,341 @@ int BTPSAPI HCITR_EnableDebugLogging(Boolean_t Enable)
    return(ret_val);
 }
 
-//void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
-//	if(huart->Instance == USART2) {
-//		RxInterrupt();
-//	}
-//}
-//
+#ifdef HCITR_ENABLE_DMA_RX
+
+   /* The following function is called by the HAL on the half and full  */
+   /* transfer interrupts of the circular receive DMA.                  */
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
+	if(huart->Instance == HCITR_UART_BASE) {
+		RxDMAEvent();
+	}
+}
+
+#endif
+
+   /* The following function is used to query the transfer statistics   */
+   /* of the HCI Transport specified by the first parameter.  The second*/
+   /* parameter is a pointer to a structure that will receive the       */
+   /* statistics.  The final parameter specifies whether the statistics */
+   /* should be reset after they are read.  This function returns zero  */
+   /* if successful or a negative value if there was an error.          */
+int BTPSAPI HCITR_QueryStatistics(unsigned int HCITransportID, HCITR_Statistics_t *Statistics, Boolean_t Reset)
+{
+   int           ret_val;
+   unsigned long CurrentTime;
+
+   if((HCITransportID == TRANSPORT_ID) && (HCITransportOpen) && (Statistics))
+   {
+      CurrentTime = BTPS_GetTickCount();
+
+      /* Take a consistent snapshot of the counts.                      */
+      DisableInterrupts();
+
+      Statistics->ElapsedTime  = CurrentTime - UartContext.StatisticsStartTime;
+      Statistics->TxBytes      = UartContext.TxByteCount;
+      Statistics->TxInterrupts = UartContext.TxInterruptCount;
+      Statistics->RxBytes      = UartContext.RxByteCount;
+      Statistics->RxInterrupts = UartContext.RxInterruptCount;
+      Statistics->RxCallbacks  = UartContext.RxCallbackCount;
+
+      Statistics->RxBufferSize     = UartContext.RxRing.Size;
+      Statistics->RxHighWaterMark  = UartContext.RxHighWaterMark;
+      Statistics->RxFlowOffCount   = UartContext.RxFlowOffCount;
+      Statistics->RxBufferOverruns = UartContext.RxRing.OverrunCount;
+      Statistics->RxUARTOverruns   = UartContext.RxUARTOverrunCount;
+
+#ifdef HCITR_ENABLE_RX_TASK
+
+      Statistics->RxTaskWakeups    = UartContext.RxTaskWakeupCount;
+      Statistics->RxMaximumLatency = UartContext.RxMaximumLatency;
+
+#else
+
+      Statistics->RxTaskWakeups    = 0;
+      Statistics->RxMaximumLatency = 0;
+
+#endif
+
+      Statistics->Suspends         = UartContext.Sleep.SuspendCount;
+      Statistics->SuspendAborts    = UartContext.Sleep.AbortCount;
+      Statistics->ControllerWakes  = UartContext.Sleep.ControllerWakeCount;
+      Statistics->HostWakes        = UartContext.Sleep.HostWakeCount;
+
+      BTPS_MemCopy(Statistics->TxClass, UartContext.TxClassStatistics, sizeof(Statistics->TxClass));
+
+      if(Reset)
+      {
+         UartContext.StatisticsStartTime = CurrentTime;
+         UartContext.TxByteCount         = 0;
+         UartContext.TxInterruptCount    = 0;
+         UartContext.RxByteCount         = 0;
+         UartContext.RxInterruptCount    = 0;
+         UartContext.RxCallbackCount     = 0;
+         UartContext.RxHighWaterMark     = 0;
+         UartContext.RxFlowOffCount      = 0;
+         UartContext.RxUARTOverrunCount  = 0;
+
+#ifdef HCITR_ENABLE_RX_TASK
+
+         UartContext.RxTaskWakeupCount   = 0;
+         UartContext.RxMaximumLatency    = 0;
+
+#endif
+
+         UartContext.RxRing.OverrunCount = 0;
+
+         UartContext.Sleep.SuspendCount        = 0;
+         UartContext.Sleep.AbortCount          = 0;
+         UartContext.Sleep.ControllerWakeCount = 0;
+         UartContext.Sleep.HostWakeCount       = 0;
+
+         BTPS_MemInitialize(UartContext.TxClassStatistics, 0, sizeof(UartContext.TxClassStatistics));
+      }
+
+      EnableInterrupts();
+
+#ifdef HCITR_ENABLE_H4_FRAMING
+
+      Statistics->RxEventPackets = UartContext.RxFramer.PacketCount[h4cEvent];
+      Statistics->RxACLPackets   = UartContext.RxFramer.PacketCount[h4cACL];
+      Statistics->RxSCOPackets   = UartContext.RxFramer.PacketCount[h4cSCO];
+      Statistics->RxHCILLPackets = UartContext.RxFramer.PacketCount[h4cHCILL];
+      Statistics->RxUnknownBytes = UartContext.RxFramer.PacketCount[h4cUnknown];
+
+      if(Reset)
+      {
+         BTPS_MemInitialize(UartContext.RxFramer.PacketCount, 0, sizeof(UartContext.RxFramer.PacketCount));
+         BTPS_MemInitialize(UartContext.RxFramer.ByteCount, 0, sizeof(UartContext.RxFramer.ByteCount));
+      }
+
+#else
+
+      Statistics->RxEventPackets = 0;
+      Statistics->RxACLPackets   = 0;
+      Statistics->RxSCOPackets   = 0;
+      Statistics->RxHCILLPackets = 0;
+      Statistics->RxUnknownBytes = 0;
+
+#endif
+
+      /* Calculate the average throughput over the elapsed time.        */
+      if(Statistics->ElapsedTime)
+      {
+         Statistics->TxBytesPerSecond = (unsigned long)(((unsigned long long)Statistics->TxBytes * 1000) / Statistics->ElapsedTime);
+         Statistics->RxBytesPerSecond = (unsigned long)(((unsigned long long)Statistics->RxBytes * 1000) / Statistics->ElapsedTime);
+      }
+      else
+      {
+         Statistics->TxBytesPerSecond = 0;
+         Statistics->RxBytesPerSecond = 0;
+      }
+
+      ret_val = 0;
+   }
+   else
+      ret_val = HCITR_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* The following function is used to change the receive buffer size  */
+   /* and flow control thresholds of the HCI Transport.  The function   */
+   /* accepts as its parameter a pointer to the new configuration.  The */
+   /* configuration is used the next time the transport is opened with  */
+   /* HCITR_COMOpen().  This function returns zero if successful or a   */
+   /* negative value if the configuration is not valid.                 */
+int BTPSAPI HCITR_SetFlowConfiguration(HCITR_FlowConfiguration_t *Configuration)
+{
+   int ret_val;
+
+   /* Make sure that the buffer size is supported and that the          */
+   /* thresholds leave room for a packet to be received before flow is  */
+   /* turned off.                                                       */
+   if((Configuration) && (Configuration->ReceiveBufferSize >= HCITR_MINIMUM_RECEIVE_BUFFER_SIZE) && (Configuration->ReceiveBufferSize <= HCITR_MAXIMUM_RECEIVE_BUFFER_SIZE))
+   {
+      if((Configuration->FlowOffThreshold) && (Configuration->FlowOffThreshold < Configuration->FlowOnThreshold) && (Configuration->FlowOnThreshold < (Configuration->ReceiveBufferSize / 2)))
+      {
+         FlowConfiguration = *Configuration;
+
+         ret_val           = 0;
+      }
+      else
+         ret_val = HCITR_ERROR_INVALID_PARAMETER;
+   }
+   else
+      ret_val = HCITR_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* The following function is used to query the flow configuration    */
+   /* that will be used the next time the HCI Transport is opened.  The */
+   /* function accepts as its parameter a pointer to a structure that   */
+   /* will receive the configuration.  This function returns zero if    */
+   /* successful or a negative value if there was an error.             */
+int BTPSAPI HCITR_QueryFlowConfiguration(HCITR_FlowConfiguration_t *Configuration)
+{
+   int ret_val;
+
+   if(Configuration)
+   {
+      *Configuration = FlowConfiguration;
+
+      ret_val        = 0;
+   }
+   else
+      ret_val = HCITR_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* The following function is used to start capturing the HCI traffic */
+   /* to the specified btsnoop file on the SD card (which is created or */
+   /* truncated).  This function returns zero if successful or a        */
+   /* negative value if there was an error.                             */
+int BTPSAPI HCITR_StartCapture(char *FileName)
+{
+#ifdef HCITR_ENABLE_SNOOP_CAPTURE
+
+   int ret_val;
+
+   if(FileName)
+   {
+      if((!SnoopFileOpen) && (f_mount(&SDFatFS, SDPath, 1) == FR_OK) && (f_open(&SnoopFile, FileName, (FA_CREATE_ALWAYS | FA_WRITE)) == FR_OK))
+      {
+         /* Create the capture task the first time a capture is started.*/
+         if(!SnoopTaskHandle)
+            SnoopTaskHandle = xTaskCreateStatic(SnoopTask, "HCITR_Snoop", HCITR_SNOOP_TASK_STACK_SIZE, NULL, HCITR_SNOOP_TASK_PRIORITY, SnoopTaskStack, &SnoopTaskBuffer);
+
+         /* The ring starts with the btsnoop file header.               */
+         HCISNOOP_Initialize(&SnoopRing, (unsigned char *)SnoopBuffer, sizeof(SnoopBuffer));
+
+         SnoopBytesWritten   = 0;
+         SnoopWriteErrors    = 0;
+         SnoopStopRequested  = FALSE;
+         SnoopCycleRemainder = 0;
+         SnoopTime           = GetRTCTime();
+         SnoopLastCycles     = GetTimeStamp();
+         SnoopLastTick       = xTaskGetTickCount();
+         SnoopFileOpen       = TRUE;
+         SnoopCapturing      = TRUE;
+
+         ret_val = 0;
+      }
+      else
+         ret_val = HCITR_ERROR_CAPTURE_FAILED;
+   }
+   else
+      ret_val = HCITR_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+
+#else
+
+   return(HCITR_ERROR_INVALID_PARAMETER);
+
+#endif
+}
+
+   /* The following function is used to stop the capture that was       */
+   /* started with HCITR_StartCapture().  The function blocks until all */
+   /* captured data has been written and the file has been closed.  This*/
+   /* function returns zero if successful or a negative value if there  */
+   /* was an error.                                                     */
+int BTPSAPI HCITR_StopCapture(HCITR_CaptureStatistics_t *Statistics)
+{
+#ifdef HCITR_ENABLE_SNOOP_CAPTURE
+
+   int ret_val;
+
+   if(SnoopFileOpen)
+   {
+      /* Stop capturing (waiting for a packet that is being captured)   */
+      /* and let the capture task write the rest of the data.           */
+      vTaskSuspendAll();
+
+      SnoopCapturing     = FALSE;
+      SnoopStopRequested = TRUE;
+
+      xTaskResumeAll();
+
+      xTaskNotifyGive(SnoopTaskHandle);
+
+      while(SnoopFileOpen)
+         BTPS_Delay(1);
+
+      if(Statistics)
+      {
+         Statistics->Packets        = SnoopRing.PacketCount;
+         Statistics->DroppedPackets = SnoopRing.DropCount;
+         Statistics->BytesWritten   = SnoopBytesWritten;
+         Statistics->WriteErrors    = SnoopWriteErrors;
+      }
+
+      ret_val = 0;
+   }
+   else
+      ret_val = HCITR_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+
+#else
+
+   return(HCITR_ERROR_INVALID_PARAMETER);
+
+#endif
+}
+
+   /* The following function is used to register the initialization     */
+   /* script (service pack) that is uploaded to the controller each time*/
+   /* the transport is opened.  A NULL script removes the registration. */
+   /* This function returns zero if successful or a negative value if   */
+   /* the script is not valid.                                          */
+int BTPSAPI HCITR_SetInitScript(const unsigned char *Script, unsigned long Length)
+{
+#ifdef HCITR_ENABLE_FAST_BOOT
+
+   int ret_val;
+
+   if((!Script) || (HCIINIT_CheckScript(Script, Length) > 0))
+   {
+      InitScript       = Script;
+      InitScriptLength = (Script) ? Length : 0;
+
+      ret_val          = 0;
+   }
+   else
+      ret_val = HCITR_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+
+#else
+
+   return(HCITR_ERROR_INVALID_PARAMETER);
+
+#endif
+}
+
+   /* The following function is used to query the timing of the start up*/
+   /* of the controller by the last call to HCITR_COMOpen().  This      */
+   /* function returns zero if successful or a negative value if there  */
+   /* was an error.                                                     */
+int BTPSAPI HCITR_QueryBootStatistics(HCITR_BootStatistics_t *Statistics)
+{
+   int ret_val;
+
+   if(Statistics)
+   {
+      BTPS_MemCopy(Statistics, &BootStatistics, sizeof(HCITR_BootStatistics_t));
+
+      ret_val = 0;
+   }
+   else
+      ret_val = HCITR_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
 //void HAL_UARTEx_TxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
 //	if(huart->Instance == USART2) {
 //		TxInterrupt();
@@ -25,15 +25,103 @@
 
 #define AUDIO_ERROR_INVALID_PARAMETER     (-3000)
 #define AUDIO_ERROR_I2C_OPERATION_FAILED  (-3001)
+#define AUDIO_ERROR_SAI_OPERATION_FAILED  (-3002)
+#define AUDIO_ERROR_PIPELINE_RUNNING      (-3003)
+#define AUDIO_ERROR_ADC_OPERATION_FAILED  (-3004)
+
+   /* The following constant represents the gain of a source of the      */
+   /* stream that plays it unchanged (see AUDIO_Set_Source_Gain()).     */
+#define AUDIO_UNITY_GAIN                  16384
+
+   /* The following constant represents the AVRCP absolute volume of the*/
+   /* full volume of the audio output (see AUDIO_Set_Absolute_Volume()).*/
+#define AUDIO_MAXIMUM_ABSOLUTE_VOLUME     127
+
+   /* The following type represents the function that is called by the  */
+   /* audio task to process each period of the SAI1 pipeline.  Input    */
+   /* holds the frames that have been received on SAI1 block B and      */
+   /* Output receives the frames that will be sent on SAI1 block A.     */
+   /* Both hold Frames interleaved stereo (left, right) 16 bit samples. */
+   /* The function must return before the next period has been          */
+   /* transferred.                                                      */
+typedef void (*AUDIO_Process_Callback_t)(unsigned int Frames, const short *Input, short *Output, unsigned long CallbackParameter);
+
+   /* The following structure is used with AUDIO_Query_Statistics() to  */
+   /* return the statistics of the SAI1 pipeline.  Underruns is the     */
+   /* number of periods that were not processed before the next one had */
+   /* been transferred (so the previous output was sent again).  The    */
+   /* FIFO counts are the SAI underrun (block A) and overrun (block B)  */
+   /* errors.  Any other error stops the pipeline (until audio is       */
+   /* uninitialized and initialized again) and is counted in            */
+   /* TransferErrors.  The times are in microseconds.  The stream       */
+   /* members are only used at the A2DP rates and describe the source of*/
+   /* the stream with the largest gain, StreamSource: StreamRate is its */
+   /* rate, StreamFrames the number of its frames that have been        */
+   /* received, StreamUnderruns the number of times it ran out (and was */
+   /* concealed), StreamLate the number of writes that arrived later    */
+   /* than the target depth covered and StreamOverruns the number of    */
+   /* writes that did not fit in its jitter buffer.  StreamJitter is the*/
+   /* largest recent arrival jitter, StreamDepth and StreamTargetDepth  */
+   /* the current and target depth of the jitter buffer (all in frames  */
+   /* of the source).  Correction is the current correction of its      */
+   /* converter (in parts per billion).  The decode members (counted for*/
+   /* every source) are only used when the stream is written as SBC     */
+   /* frames: DecodedFrames is the number of SBC frames that were       */
+   /* decoded, DecodeErrors the number that were dropped (a CRC that did*/
+   /* not match, an invalid or fragmented frame or an unsupported rate) */
+   /* and DecodeCycles and MaximumDecodeCycles the average and largest  */
+   /* number of cycles the decoding of a frame took.  ClockError is how */
+   /* far the rate SAI1 runs at is from SampleRate (in parts per        */
+   /* billion, see AUDIOCLK.h).  The microphone members are only used at*/
+   /* the HFP rates: MicrophoneSlips is the number of samples that were */
+   /* dropped or repeated to follow the rate of ADC1 and                */
+   /* MicrophoneResyncs the number of times the read position had to be */
+   /* aligned again with the DMA of ADC1.                               */
+typedef struct _tagAUDIO_Statistics_t
+{
+   unsigned long SampleRate;
+   unsigned int  PeriodFrames;
+   unsigned long PeriodTime;
+   long          ClockError;
+   unsigned long Periods;
+   unsigned long Underruns;
+   unsigned long FIFOUnderruns;
+   unsigned long FIFOOverruns;
+   unsigned long TransferErrors;
+   unsigned long MaximumProcessTime;
+   unsigned int  StreamSource;
+   unsigned long StreamRate;
+   unsigned long StreamFrames;
+   unsigned long StreamUnderruns;
+   unsigned long StreamLate;
+   unsigned long StreamOverruns;
+   unsigned long StreamConcealedFrames;
+   unsigned int  StreamJitter;
+   unsigned int  StreamDepth;
+   unsigned int  StreamTargetDepth;
+   long          Correction;
+   unsigned long DecodedFrames;
+   unsigned long DecodeErrors;
+   unsigned long DecodeCycles;
+   unsigned long MaximumDecodeCycles;
+   unsigned long MicrophoneSlips;
+   unsigned long MicrophoneResyncs;
+} AUDIO_Statistics_t;
 
    /* The following function initilizes the codec and enables           */
-   /* the I2S as master.  This function will return zero if             */
-   /* successful or a negative value if there was an error.             */
+   /* the I2S as master.  If the pipeline is still in standby at the    */
+   /* same rate of SAI1 it is resumed (see uninitializeAUDIO()) and the */
+   /* output fades in.  This function will return zero if successful or */
+   /* a negative value if there was an error.                           */
+
 int initializeAudio(unsigned int BluetoothStackID, unsigned long Frequency);
 
    /* The following function un-initilizes the codec and disables       */
-   /* the I2S.  This function will return zero if                       */
+   /* the I2S.  The output fades out and the pipeline stays in standby  */
+   /* (clocked, sending silence) for AUDIO_STANDBY_TIME milliseconds    */
+   /* before it is stopped.  This function will return zero if          */
    /* successful or a negative value if there was an error.             */
+
 int uninitializeAUDIO(void);
  
    /* The following function will set the volume of the audio output.   */
@@ -48,13 +136,99 @@ int AUDIO_Set_Volume(unsigned int NewVolume);
    /* there was an error.                                               */
 int AUDIO_Get_Volume(void);
 
+   /* The following function sets the volume of the audio output to the */
+   /* specified AVRCP absolute volume, from zero (muted) to             */
+   /* AUDIO_MAXIMUM_ABSOLUTE_VOLUME (full volume), so that the absolute */
+   /* volume of a remote device can be passed on as it is.  The output  */
+   /* is scaled digitally and ramps to the new volume over one period,  */
+   /* without a codec register being written.  This function returns    */
+   /* zero if successful or a negative value if there was an error.     */
+int AUDIO_Set_Absolute_Volume(unsigned int Volume);
+
+   /* The following function returns the current AVRCP absolute volume  */
+   /* of the audio output, from zero (muted) to                         */
+   /* AUDIO_MAXIMUM_ABSOLUTE_VOLUME.                                    */
+int AUDIO_Get_Absolute_Volume(void);
+
    /* The following function configures the DAC, CS43L22, and hold it   */
    /* in HW reset */
 void AUDIO_Reset_CODEC(void);
 
-   /* The following function Mutes/Un-Mutes the HW CODEC and puts       */
-   /* the CODEC in Power Save mode. This function will return zero if   */
-   /* successful or a negative value if there was an error.             */
+   /* The following function pauses the audio output if it is playing or*/
+   /* resumes it if it is paused.  The output is muted softly: it fades */
+   /* out (or in) over AUDIO_OUTPUT_FADE_TIME milliseconds while the    */
+   /* pipeline keeps running, and the volume is kept.  This function    */
+   /* will return zero if successful or a negative value if there was an*/
+   /* error.                                                            */
 int pauseResumeAudio(void);
 
+   /* The following function sets the number of stereo frames in each   */
+   /* period of the SAI1 pipeline (at most AUDIO_MAXIMUM_PERIOD_FRAMES).*/
+   /* The period can only be changed while audio is not initialized.    */
+   /* This function will return zero if successful or a negative value  */
+   /* if there was an error.                                            */
+int AUDIO_Set_Period(unsigned int PeriodFrames);
+
+   /* The following function clocks SAI1 for the specified sample rate  */
+   /* with its clock plan (see AUDIOCLK.h), so that the pipeline starts */
+   /* at that rate without waiting for PLLSAI2 to lock.  The rate can   */
+   /* only be changed while audio is not initialized (a pipeline in     */
+   /* standby at another rate is stopped).  This function will return   */
+   /* zero if successful or a negative value if there was an error.     */
+int AUDIO_Set_Rate(unsigned long Frequency);
+
+   /* The following function registers the function that processes      */
+   /* each period of the SAI1 pipeline (NULL restores the default       */
+   /* processing).  This function may be called while the pipeline      */
+   /* runs, the new function is used from the next period.  This        */
+   /* function will return zero if successful or a negative value if    */
+   /* there was an error.                                               */
+int AUDIO_Register_Process_Callback(AUDIO_Process_Callback_t ProcessCallback, unsigned long CallbackParameter);
+
+   /* The following function writes the specified number of interleaved */
+   /* stereo frames of the specified source of the stream (at the sample*/
+   /* rate audio was initialized with) to the jitter buffer of the      */
+   /* source that is played by the default processing at the A2DP       */
+   /* rates.  The frames are stamped with the current time to measure   */
+   /* the arrival jitter, so they should be written as soon as they     */
+   /* arrive.  Frames that do not fit in the jitter buffer are          */
+   /* dropped.  This function may be called from one task at a time (the*/
+   /* one that calls initializeAudio()).  This function returns the     */
+   /* number of frames that were written if successful or a negative    */
+   /* value if there was an error.                                      */
+int AUDIO_Write_Stream(unsigned int Source, unsigned int Frames, const short *Samples);
+
+   /* The following function decodes the specified A2DP media payload   */
+   /* (the SBC frames of a packet, with or without the media payload    */
+   /* header) of the specified source and writes the decoded frames to  */
+   /* the jitter buffer of the source like AUDIO_Write_Stream().  The   */
+   /* rate of the source follows the rate of the frames, so each source */
+   /* may have its own rate.  A fragmented frame, a frame whose CRC does*/
+   /* not match and a frame at a rate the converter does not support are*/
+   /* dropped.  This function may be called from one task at a time (the*/
+   /* one that calls initializeAudio()).  This function returns the     */
+   /* number of frames that were written if successful or a negative    */
+   /* value if there was an error.                                      */
+int AUDIO_Write_SBC(unsigned int Source, unsigned int Length, const unsigned char *Data);
+
+   /* The following function sets the gain (Q14, AUDIO_UNITY_GAIN plays */
+   /* the source unchanged) with which the specified source of the      */
+   /* stream is mixed.  The gain fades to its new value over            */
+   /* AUDIO_STREAM_FADE_TIME milliseconds.  A source that is not heard  */
+   /* is still buffered, so it can be heard at once.  This function     */
+   /* returns zero if successful or a negative value if there was an    */
+   /* error.                                                            */
+int AUDIO_Set_Source_Gain(unsigned int Source, unsigned int Gain);
+
+   /* The following function selects the source of the stream that is   */
+   /* heard: the stream cross-fades from the sources that are heard to  */
+   /* the specified source at unity gain.  This function returns zero if*/
+   /* successful or a negative value if there was an error.             */
+int AUDIO_Select_Source(unsigned int Source);
+
+   /* The following function returns the statistics of the SAI1         */
+   /* pipeline in the specified structure and, if the second parameter  */
+   /* is non-zero, resets them.                                         */
+void AUDIO_Query_Statistics(AUDIO_Statistics_t *Statistics, int Reset);
+
 #endif
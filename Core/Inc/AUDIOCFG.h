@@ -54,6 +54,90 @@
 #define MCO2_OUT_PIN           			9
 #define ADC3_MIC_PIN           			10
 
+   /* The following constants configure the SAI1 audio pipeline.  The   */
+   /* DMA of each block runs continuously over a buffer of two periods  */
+   /* and the audio task processes one period while the DMA transfers   */
+   /* the other.  AUDIO_DEFAULT_PERIOD_FRAMES is the period (in stereo  */
+   /* frames) that is used until AUDIO_Set_Period() is called and       */
+   /* AUDIO_MAXIMUM_PERIOD_FRAMES sets the size of the buffers.  The    */
+   /* task must finish each period before the next one has been         */
+   /* transferred, so it runs just below the HCI receive task.  The     */
+   /* stack size is specified in words.                                 */
+#define AUDIO_DEFAULT_PERIOD_FRAMES     240
+#define AUDIO_MAXIMUM_PERIOD_FRAMES     480
+
+#define AUDIO_TASK_PRIORITY             (configMAX_PRIORITIES - 2)
+#define AUDIO_TASK_STACK_SIZE           256
+
+   /* The following constants configure the capture of the microphone at*/
+   /* the HFP rates.  TIM6 triggers ADC1 at the rate of SAI1, each      */
+   /* trigger makes 16 conversions whose sum is shifted to a 14 bit     */
+   /* sample (see adc.c) and the DMA of ADC1 writes the samples to a    */
+   /* circular buffer of AUDIO_MICROPHONE_PERIODS periods (at least     */
+   /* three).  The audio task reads each period half the buffer behind  */
+   /* the DMA and moves by one sample when the distance has drifted more*/
+   /* than AUDIO_MICROPHONE_SLACK samples.                              */
+#define AUDIO_MICROPHONE_PERIODS        4
+#define AUDIO_MICROPHONE_SLACK          8
+
+   /* The following constants configure the stream that is played at the*/
+   /* A2DP rates.  If AUDIO_STREAM_NATIVE_RATE is non-zero SAI1 is      */
+   /* started at the rate of the stream when it has a clock plan for it */
+   /* (see AUDIOCLK.h), so the stream is only corrected for the drift,  */
+   /* otherwise SAI1 runs at AUDIO_STREAM_OUTPUT_RATE.  The stream is   */
+   /* converted to the rate of SAI1 (see AUDIOSRC.h), so a change of the*/
+   /* stream format while audio is initialized does not change any      */
+   /* clock.  The stream is buffered in a jitter buffer of              */
+   /* AUDIO_STREAM_FIFO_FRAMES stereo frames (a power of two, see       */
+   /* AUDIOJB.h).  Its target depth is AUDIO_STREAM_TARGET_LATENCY      */
+   /* milliseconds plus the measured arrival jitter (at most 3/4 of the */
+   /* buffer) and its fill level is held at the target depth by the     */
+   /* correction of the converter.                                      */
+#define AUDIO_STREAM_NATIVE_RATE        1
+#define AUDIO_STREAM_OUTPUT_RATE        48000
+#define AUDIO_STREAM_FIFO_FRAMES        8192
+#define AUDIO_STREAM_TARGET_LATENCY     40
+
+   /* The following constants configure the sources of the stream.  Each */
+   /* of the AUDIO_STREAM_SOURCES sources (at most                      */
+   /* AUDIOMIX_MAXIMUM_SOURCES) has its own jitter buffer, converter and*/
+   /* decoder and the sources are mixed (see AUDIOMIX.h).  A change of  */
+   /* the gain of a source fades over AUDIO_STREAM_FADE_TIME            */
+   /* milliseconds, so selecting another source cross-fades to it.      */
+#define AUDIO_STREAM_SOURCES            2
+#define AUDIO_STREAM_FADE_TIME          50
+
+   /* The following constants configure the hand-over between           */
+   /* streams.  The output fades in over AUDIO_OUTPUT_FADE_TIME         */
+   /* milliseconds when the pipeline starts and fades out when audio is */
+   /* uninitialized.  The pipeline then stays in standby (SAI1 keeps its*/
+   /* clocks and sends silence) for AUDIO_STANDBY_TIME milliseconds, so */
+   /* a stream that is opened within that time starts at once.  Zero    */
+   /* stops the pipeline as soon as the output has been uninitialized.  */
+#define AUDIO_OUTPUT_FADE_TIME          20
+#define AUDIO_STANDBY_TIME              10000
+
+   /* The following constants configure the volume of the output (see   */
+   /* AUDIOVOL.h).  The absolute volumes 1 to                           */
+   /* AUDIO_MAXIMUM_ABSOLUTE_VOLUME span AUDIO_VOLUME_RANGE decibels (at*/
+   /* most 96) below the full volume and zero mutes.  A change of the   */
+   /* volume ramps over one period, a pause and the fades of the        */
+   /* pipeline over AUDIO_OUTPUT_FADE_TIME.  AUDIO_VOLUME_RAMP selects  */
+   /* the shape of the ramps, vrExponential ramps evenly in decibels and*/
+   /* vrLinear evenly in gain.                                          */
+#define AUDIO_VOLUME_RANGE              60
+#define AUDIO_VOLUME_RAMP               vrExponential
+
+   /* The following constant selects where the SBC frames of the stream */
+   /* are decoded.  If it is non-zero the A3DP offload of the CC256x is */
+   /* not used: the frames are decoded by the MCU (see AUDIOSBC.h) with */
+   /* whatever SBC parameters the source chose and written to the jitter*/
+   /* buffer.  Otherwise the CC256x decodes them with the parameters it */
+   /* has been configured with.                                         */
+#ifndef AUDIO_SBC_DECODER
+#define AUDIO_SBC_DECODER               0
+#endif
+
 /************************************************************************/
 /* !!!DO NOT MODIFY PAST THIS POINT!!!                                  */
 /************************************************************************/
@@ -0,0 +1,73 @@
+/*****< audioclk.h >***********************************************************/
+/*                                                                            */
+/*  AUDIOCLK - Clock plans of the audio interface.                            */
+/*                                                                            */
+/*  A clock plan gives the dividers that clock SAI1 from PLLSAI2 at one       */
+/*  sample rate: the PLL divides its input clock by PLLM, multiplies it by    */
+/*  PLLN and divides the VCO by PLLP, and SAI1 divides that kernel clock by   */
+/*  MCKDIV for a master clock of 256 times the sample rate (NOMCK = 0, no     */
+/*  oversampling).  AUDIOCLK_Plan() searches every valid combination for the  */
+/*  one closest to the sample rate, the default plans hold its result for     */
+/*  each rate of the audio interface so that no search is done at run time    */
+/*  (the bench checks that they match).  PLLSAI1 is left alone, so USB and    */
+/*  the ADC keep their clocks whatever the rate.  Like AUDIOJB the module has */
+/*  no dependencies on the HAL, the RTOS or Bluetopia.                        */
+/******************************************************************************/
+#ifndef __AUDIOCLKH__
+#define __AUDIOCLKH__
+
+   /* The following constants represent the clock the PLL is fed with   */
+   /* (the MSI), the limits of the dividers and of the VCO and its input*/
+   /* and the ratio of the master clock to the sample rate.             */
+#define AUDIOCLK_INPUT_CLOCK                       4000000UL
+
+#define AUDIOCLK_MINIMUM_PLLM                      1
+#define AUDIOCLK_MAXIMUM_PLLM                      16
+#define AUDIOCLK_MINIMUM_PLLN                      8
+#define AUDIOCLK_MAXIMUM_PLLN                      127
+#define AUDIOCLK_MINIMUM_PLLP                      2
+#define AUDIOCLK_MAXIMUM_PLLP                      31
+#define AUDIOCLK_MINIMUM_MCKDIV                    1
+#define AUDIOCLK_MAXIMUM_MCKDIV                    63
+
+#define AUDIOCLK_MINIMUM_VCO_INPUT                 2660000UL
+#define AUDIOCLK_MAXIMUM_VCO_INPUT                 8000000UL
+#define AUDIOCLK_MINIMUM_VCO                       64000000UL
+#define AUDIOCLK_MAXIMUM_VCO                       344000000UL
+
+#define AUDIOCLK_MCLK_RATIO                        256
+
+   /* The following structure holds the clock plan of one sample rate.  */
+   /* Error is how far the rate SAI1 runs at is from the sample rate (in*/
+   /* parts per billion).                                               */
+typedef struct _tagAUDIOCLK_Plan_t
+{
+   unsigned long SampleRate;
+   unsigned int  PLLM;
+   unsigned int  PLLN;
+   unsigned int  PLLP;
+   unsigned int  MCKDIV;
+   long          Error;
+} AUDIOCLK_Plan_t;
+
+   /* The following variables hold the default clock plans, one for each*/
+   /* rate SAI1 may run at, from AUDIOCLK_INPUT_CLOCK.                  */
+extern const AUDIOCLK_Plan_t AUDIOCLK_DefaultPlans[];
+extern const unsigned int    AUDIOCLK_NumberDefaultPlans;
+
+   /* The following function searches the clock plan of the specified   */
+   /* sample rate from the specified input clock.  The plan with the    */
+   /* smallest error is chosen, of those the one with the slowest VCO   */
+   /* and then the slowest kernel clock.  This function returns zero if */
+   /* successful or a negative value if no plan is valid.               */
+int AUDIOCLK_Plan(unsigned long InputClock, unsigned long SampleRate, AUDIOCLK_Plan_t *Plan);
+
+   /* The following function returns the clock plan of the specified    */
+   /* sample rate from the specified plans, or NULL if there is none.   */
+const AUDIOCLK_Plan_t *AUDIOCLK_FindPlan(const AUDIOCLK_Plan_t *Plans, unsigned int NumberPlans, unsigned long SampleRate);
+
+   /* The following function returns the rate (in Hz, rounded) SAI1 runs*/
+   /* at from the specified input clock with the specified plan.        */
+unsigned long AUDIOCLK_Rate(unsigned long InputClock, const AUDIOCLK_Plan_t *Plan);
+
+#endif
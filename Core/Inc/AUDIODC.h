@@ -0,0 +1,61 @@
+/*****< audiodc.h >************************************************************/
+/*                                                                            */
+/*  AUDIODC - DC removal and noise gate of the microphone samples.            */
+/*                                                                            */
+/*  The DC level is the average of the last AUDIODC_AVERAGES segments of      */
+/*  AUDIODC_SEGMENT_LENGTH samples, and it is only followed once that many    */
+/*  segments have been received (the initial level is used until then).       */
+/*  Each sample has the DC level removed and is then amplified by a power of  */
+/*  two (with saturation), and samples that are closer to zero than the       */
+/*  threshold are cleared.  The block version keeps running sums and gates    */
+/*  two samples at once with the SIMD instructions (see AUDIOSIMD.h), the     */
+/*  reference version processes one sample at a time in portable C and MUST   */
+/*  give the same result.  Like HCIINIT it has no dependencies on the HAL,    */
+/*  the RTOS or Bluetopia.                                                    */
+/******************************************************************************/
+#ifndef __AUDIODCH__
+#define __AUDIODCH__
+
+   /* The following constants represent the number of samples of each   */
+   /* segment and the number of segment averages that the DC level is   */
+   /* the average of (as powers of two).                                */
+#define AUDIODC_SEGMENT_SHIFT                      8
+#define AUDIODC_AVERAGE_SHIFT                      4
+
+#define AUDIODC_SEGMENT_LENGTH                     (1 << AUDIODC_SEGMENT_SHIFT)
+#define AUDIODC_AVERAGES                           (1 << AUDIODC_AVERAGE_SHIFT)
+
+   /* The following structure holds the state of the DC removal.  Level */
+   /* is the DC level that is currently removed.  SegmentSum is the sum */
+   /* of the SegmentCount samples of the current segment, Averages holds*/
+   /* the averages of the last segments (AverageIndex is the oldest one)*/
+   /* and AverageSum is their sum.  Tracking is set once all of the     */
+   /* averages have been received.                                      */
+typedef struct _tagAUDIODC_State_t
+{
+   short        Level;
+   short        Threshold;
+   unsigned int Shift;
+   long         SegmentSum;
+   unsigned int SegmentCount;
+   long         AverageSum;
+   unsigned int AverageIndex;
+   int          Tracking;
+   short        Averages[AUDIODC_AVERAGES];
+} AUDIODC_State_t;
+
+   /* The following function initializes the specified state with the   */
+   /* specified initial DC level, the amplification (as a shift, 0 to   */
+   /* 15) and the threshold (not negative) of the noise gate.  A        */
+   /* threshold of zero disables the noise gate.                        */
+void AUDIODC_Initialize(AUDIODC_State_t *State, short InitialLevel, unsigned int Shift, short Threshold);
+
+   /* The following function processes the specified number of samples  */
+   /* from the input to the output buffer (which may be the same).      */
+void AUDIODC_Process(AUDIODC_State_t *State, unsigned int Length, const short *Input, short *Output);
+
+   /* The following function is the reference version of                */
+   /* AUDIODC_Process().  It is only used to check the block version.   */
+void AUDIODC_ProcessReference(AUDIODC_State_t *State, unsigned int Length, const short *Input, short *Output);
+
+#endif
@@ -0,0 +1,124 @@
+/*****< audioflt.h >***********************************************************/
+/*                                                                            */
+/*  AUDIOFLT - Fixed point filter bank of the audio path.                     */
+/*                                                                            */
+/*  A filter bank is a cascade of up to AUDIOFLT_MAXIMUM_STAGES stages that   */
+/*  is configured from a coefficient set, and a coefficient set is chosen     */
+/*  by the sample rate.  The stages are:                                      */
+/*     FIR_Q15    - FIR filter of up to AUDIOFLT_MAXIMUM_FIR_TAPS Q15         */
+/*                  coefficients.  The history is held twice in a row so      */
+/*                  that the last samples are always contiguous, and two      */
+/*                  taps are computed at a time with __SMLAD.                 */
+/*     BIQUAD_Q15 - Direct form I biquad with Q14 coefficients and 16 bit     */
+/*                  state, three __SMLAD per sample.                          */
+/*     BIQUAD_Q31 - Direct form I biquad with Q30 coefficients and 32 bit     */
+/*                  output state, for filters with poles close to the unit    */
+/*                  circle (i.e. low cut offs at high sample rates).          */
+/*  Samples are Q15 between the stages.  The reference version processes      */
+/*  one sample at a time in portable C (and indexes the FIR history with a    */
+/*  modulo) and MUST give the same result.  Like AUDIODC it has no            */
+/*  dependencies on the HAL, the RTOS or Bluetopia.                           */
+/******************************************************************************/
+#ifndef __AUDIOFLTH__
+#define __AUDIOFLTH__
+
+   /* The following constants represent the largest number of stages of */
+   /* a filter bank and the largest number of taps of a FIR stage.      */
+#define AUDIOFLT_MAXIMUM_STAGES                    4
+#define AUDIOFLT_MAXIMUM_FIR_TAPS                  32
+
+   /* The following constants represent the number of coefficients of a */
+   /* biquad stage, in the order b0, b1, b2, a1, a2 where               */
+   /*    y[n] = b0.x[n] + b1.x[n-1] + b2.x[n-2] - a1.y[n-1] - a2.y[n-2] */
+#define AUDIOFLT_BIQUAD_COEFFICIENTS               5
+
+   /* The following enumerated type represents the types of the stages. */
+typedef enum
+{
+   ftFIR_Q15,
+   ftBiquad_Q15,
+   ftBiquad_Q31
+} AUDIOFLT_Stage_Type_t;
+
+   /* The following structure defines one stage of a coefficient set.   */
+   /* A FIR_Q15 stage has NumberTaps coefficients in Q15 (the first     */
+   /* applies to the newest sample), the sum of their magnitudes MUST be*/
+   /* less than 2.  A BIQUAD_Q15 stage has the biquad coefficients in   */
+   /* Q15 (as Q14 values, -a1 and -a2 MUST be representable) and a      */
+   /* BIQUAD_Q31 stage in Q31 (as Q30 values).                          */
+typedef struct _tagAUDIOFLT_Stage_Definition_t
+{
+   AUDIOFLT_Stage_Type_t  Type;
+   unsigned int           NumberTaps;
+   const short           *Q15;
+   const long            *Q31;
+} AUDIOFLT_Stage_Definition_t;
+
+   /* The following structure defines the coefficient set of one sample */
+   /* rate.                                                             */
+typedef struct _tagAUDIOFLT_Coefficient_Set_t
+{
+   unsigned long                      SampleRate;
+   unsigned int                       NumberStages;
+   const AUDIOFLT_Stage_Definition_t *Stages;
+} AUDIOFLT_Coefficient_Set_t;
+
+   /* The following structure holds the state of one stage.  The FIR    */
+   /* coefficients are held in reverse order (padded to an even number  */
+   /* of taps) and History holds the last NumberTaps samples twice,     */
+   /* Position is where the next sample is written.  The Q15 biquad     */
+   /* coefficients are held packed in the pairs that are multiplied.    */
+typedef struct _tagAUDIOFLT_Stage_t
+{
+   AUDIOFLT_Stage_Type_t Type;
+   unsigned int          NumberTaps;
+   unsigned int          Position;
+   short                 Coefficients[AUDIOFLT_MAXIMUM_FIR_TAPS];
+   short                 History[AUDIOFLT_MAXIMUM_FIR_TAPS * 2];
+   unsigned long         BiquadQ15[3];
+   short                 StateQ15[4];
+   long                  BiquadQ31[AUDIOFLT_BIQUAD_COEFFICIENTS];
+   long                  StateQ31[4];
+} AUDIOFLT_Stage_t;
+
+   /* The following structure holds the state of a filter bank.  A bank */
+   /* with no stages passes the samples through.                        */
+typedef struct _tagAUDIOFLT_Bank_t
+{
+   unsigned long    SampleRate;
+   unsigned int     NumberStages;
+   AUDIOFLT_Stage_t Stages[AUDIOFLT_MAXIMUM_STAGES];
+} AUDIOFLT_Bank_t;
+
+   /* The following variables hold the default coefficient sets of the  */
+   /* audio path, one for each sample rate of initializeAudio().  The   */
+   /* HFP rates remove the DC and low frequency noise of the microphone */
+   /* and smooth it, the A2DP rates only remove sub-sonic content.      */
+extern const AUDIOFLT_Coefficient_Set_t AUDIOFLT_DefaultSets[];
+extern const unsigned int               AUDIOFLT_NumberDefaultSets;
+
+   /* The following function returns the coefficient set of the         */
+   /* specified sample rate from the specified sets, or NULL if there is*/
+   /* none.                                                             */
+const AUDIOFLT_Coefficient_Set_t *AUDIOFLT_FindCoefficientSet(const AUDIOFLT_Coefficient_Set_t *Sets, unsigned int NumberSets, unsigned long SampleRate);
+
+   /* The following function configures the specified filter bank with  */
+   /* the specified coefficient set (NULL configures a bank with no     */
+   /* stages) and clears its history.  This function returns zero if    */
+   /* successful or a negative value if the set is not valid, in which  */
+   /* case the bank is left with no stages.                             */
+int AUDIOFLT_Initialize(AUDIOFLT_Bank_t *Bank, const AUDIOFLT_Coefficient_Set_t *Set);
+
+   /* The following function clears the history of the specified filter */
+   /* bank.                                                             */
+void AUDIOFLT_Reset(AUDIOFLT_Bank_t *Bank);
+
+   /* The following function filters the specified number of samples    */
+   /* from the input to the output buffer (which may be the same).      */
+void AUDIOFLT_Process(AUDIOFLT_Bank_t *Bank, unsigned int Length, const short *Input, short *Output);
+
+   /* The following function is the reference version of                */
+   /* AUDIOFLT_Process().  It is only used to check the block version.  */
+void AUDIOFLT_ProcessReference(AUDIOFLT_Bank_t *Bank, unsigned int Length, const short *Input, short *Output);
+
+#endif
@@ -0,0 +1,152 @@
+/*****< audiojb.h >************************************************************/
+/*                                                                            */
+/*  AUDIOJB - Adaptive jitter buffer of the audio stream.                     */
+/*                                                                            */
+/*  The jitter buffer is a FIFO of interleaved stereo frames that is written  */
+/*  by one task (as the stream arrives) and read by another (as it is         */
+/*  played).  Each write is stamped with its arrival time and the transit     */
+/*  of the write (the arrival time less the time of its first frame in the    */
+/*  stream) is followed over windows of AUDIOJB_WINDOW_TIME milliseconds.     */
+/*  The spread of the transit in a window is the arrival jitter, and the      */
+/*  target depth of the buffer is kept above the largest recent jitter (but   */
+/*  never below the configured latency).  A write that arrives later than     */
+/*  the target depth covers is counted as late.                               */
+/*                                                                            */
+/*  Reading starts once the buffer holds the target depth.  If the reader     */
+/*  runs out the rest of the output is concealed by repeating the last        */
+/*  output frames while fading them out, reading stops until the buffer       */
+/*  holds the target depth again and the output then fades back in.  Like     */
+/*  AUDIOSRC the module has no dependencies on the HAL, the RTOS or           */
+/*  Bluetopia.                                                                */
+/******************************************************************************/
+#ifndef __AUDIOJBH__
+#define __AUDIOJBH__
+
+   /* The following constants represent the number of channels of each  */
+   /* frame and the length of the windows over which the jitter is      */
+   /* measured (in milliseconds).  A gap in the stream longer than      */
+   /* AUDIOJB_RESYNC_TIME milliseconds starts a new measurement (the    */
+   /* stream has been suspended).                                       */
+#define AUDIOJB_CHANNELS                           2
+#define AUDIOJB_WINDOW_TIME                        1000
+#define AUDIOJB_RESYNC_TIME                        500
+
+   /* The following constants represent the number of output frames     */
+   /* that are repeated to conceal an underrun and the number of frames */
+   /* over which the output fades out and back in (as powers of two).   */
+#define AUDIOJB_CONCEAL_SHIFT                      8
+#define AUDIOJB_FADE_SHIFT                         9
+
+#define AUDIOJB_CONCEAL_FRAMES                     (1 << AUDIOJB_CONCEAL_SHIFT)
+#define AUDIOJB_FADE_FRAMES                        (1 << AUDIOJB_FADE_SHIFT)
+
+   /* The following structure holds the statistics of a jitter buffer.  */
+   /* Underruns is the number of times the reader ran out, Late the     */
+   /* number of writes that arrived later than the target depth covered */
+   /* and Overruns the number of writes that did not fit in the buffer. */
+   /* Jitter is the largest recent spread of the transit and Depth and  */
+   /* TargetDepth the current and target depth of the buffer (all in    */
+   /* frames).                                                          */
+typedef struct _tagAUDIOJB_Statistics_t
+{
+   unsigned long Frames;
+   unsigned long Writes;
+   unsigned long Underruns;
+   unsigned long Late;
+   unsigned long Overruns;
+   unsigned long ConcealedFrames;
+   unsigned int  Jitter;
+   unsigned int  Depth;
+   unsigned int  TargetDepth;
+} AUDIOJB_Statistics_t;
+
+   /* The following structure holds the state of a jitter buffer.  In   */
+   /* and Out count the frames that have been written and read (In is   */
+   /* only changed by the writer and Out by the reader).  The transit   */
+   /* members are only used by the writer: the transit is measured from */
+   /* StartTime, at which StreamFrames was zero.  Baseline is the       */
+   /* smallest transit of the last window and WindowMinimum and         */
+   /* WindowMaximum those of the current one (which started at          */
+   /* WindowStart).  Peak is the largest recent spread, which decays by */
+   /* 1/8 per window.  The remaining members are only used by the       */
+   /* reader: Playing is set while the buffer is read, Concealing while */
+   /* an underrun is concealed, Fade is the number of frames left of the*/
+   /* fade (out while concealing, in otherwise) and Last holds the last */
+   /* AUDIOJB_CONCEAL_FRAMES output frames (Repeat is the next one to   */
+   /* repeat).                                                          */
+typedef struct _tagAUDIOJB_Buffer_t
+{
+   short                  *Buffer;
+   unsigned int            Size;
+   unsigned long           SampleRate;
+   unsigned int            LatencyFrames;
+   unsigned int            MaximumFrames;
+   volatile unsigned long  In;
+   volatile unsigned long  Out;
+   volatile unsigned int   TargetFrames;
+   unsigned int            Latency;
+   int                     Synchronized;
+   unsigned long           StartTime;
+   unsigned long           LastArrival;
+   unsigned long           WindowStart;
+   unsigned long           StreamFrames;
+   long                    Baseline;
+   long                    WindowMinimum;
+   long                    WindowMaximum;
+   unsigned int            Peak;
+   int                     Playing;
+   int                     Concealing;
+   unsigned int            Fade;
+   unsigned int            Repeat;
+   short                   Last[AUDIOJB_CONCEAL_FRAMES * AUDIOJB_CHANNELS];
+   AUDIOJB_Statistics_t    Statistics;
+} AUDIOJB_Buffer_t;
+
+   /* The following function initializes the specified jitter buffer to */
+   /* use the specified buffer of the specified size (in frames, a power*/
+   /* of two) for a stream at the specified sample rate, with the       */
+   /* specified latency (in milliseconds) as the smallest target depth. */
+   /* The target depth never exceeds 3/4 of the buffer.  This function  */
+   /* returns zero if successful or a negative value if a parameter is  */
+   /* not valid.                                                        */
+int AUDIOJB_Initialize(AUDIOJB_Buffer_t *JitterBuffer, short *Buffer, unsigned int Size, unsigned long SampleRate, unsigned int Latency);
+
+   /* The following function changes the sample rate of the stream of   */
+   /* the specified jitter buffer.  It may only be called by the writer */
+   /* and the frames that are in the buffer are kept.                   */
+void AUDIOJB_SetSampleRate(AUDIOJB_Buffer_t *JitterBuffer, unsigned long SampleRate);
+
+   /* The following function writes the specified number of frames that */
+   /* arrived at the specified time (in milliseconds) to the specified  */
+   /* jitter buffer.  Frames that do not fit in the buffer are dropped. */
+   /* This function returns the number of frames that were written.     */
+unsigned int AUDIOJB_Write(AUDIOJB_Buffer_t *JitterBuffer, unsigned long Time, unsigned int Frames, const short *Samples);
+
+   /* The following function returns the number of frames that can be   */
+   /* read contiguously from the specified jitter buffer and the first  */
+   /* of them in the final parameter.  This function returns zero while */
+   /* the buffer does not (yet) hold the target depth after starting or */
+   /* after an underrun.                                                */
+unsigned int AUDIOJB_Peek(AUDIOJB_Buffer_t *JitterBuffer, const short **Samples);
+
+   /* The following function removes the specified number of frames     */
+   /* (at most the number returned by AUDIOJB_Peek()) from the specified*/
+   /* jitter buffer.                                                    */
+void AUDIOJB_Consume(AUDIOJB_Buffer_t *JitterBuffer, unsigned int Frames);
+
+   /* The following function returns the number of frames in the        */
+   /* specified jitter buffer.                                          */
+unsigned int AUDIOJB_Depth(AUDIOJB_Buffer_t *JitterBuffer);
+
+   /* The following function completes an output block of the specified */
+   /* number of frames, of which the first Produced frames were made    */
+   /* from the stream.  If the block is short the rest is concealed and */
+   /* an underrun is counted, and the frames after an underrun are faded*/
+   /* back in.  It must be called by the reader for every output block. */
+void AUDIOJB_Conceal(AUDIOJB_Buffer_t *JitterBuffer, unsigned int Produced, unsigned int Frames, short *Output);
+
+   /* The following function returns the statistics of the specified    */
+   /* jitter buffer in the specified structure.                         */
+void AUDIOJB_Query_Statistics(AUDIOJB_Buffer_t *JitterBuffer, AUDIOJB_Statistics_t *Statistics);
+
+#endif
@@ -0,0 +1,71 @@
+/*****< audiomix.h >***********************************************************/
+/*                                                                            */
+/*  AUDIOMIX - Mixer of the audio streams.                                    */
+/*                                                                            */
+/*  The mixer adds up to AUDIOMIX_MAXIMUM_SOURCES sources of interleaved      */
+/*  stereo frames, each scaled by its own gain, into one output with          */
+/*  saturation.  The gains are Q14 (AUDIOMIX_UNITY_GAIN passes a source       */
+/*  unchanged), so a source that is played alone at unity gain is exact.  A   */
+/*  change of the gains does not take effect at once: every gain ramps        */
+/*  linearly from where it is to its new value over the fade of the mixer,    */
+/*  so selecting another source cross-fades to it without a click.  The       */
+/*  block version scales two sources at a time with 64 bit dual multiply      */
+/*  accumulates (__SMLALD) and copies a lone source at unity gain, the        */
+/*  reference version processes one frame at a time in portable C and MUST    */
+/*  give the same result.  Like AUDIOJB the module has no dependencies on     */
+/*  the HAL, the RTOS or Bluetopia.                                           */
+/******************************************************************************/
+#ifndef __AUDIOMIXH__
+#define __AUDIOMIXH__
+
+   /* The following constants represent the number of channels of each  */
+   /* frame, the largest number of sources and the gain that passes a   */
+   /* source unchanged and the largest gain (Q14).                      */
+#define AUDIOMIX_CHANNELS                          2
+#define AUDIOMIX_MAXIMUM_SOURCES                   4
+#define AUDIOMIX_UNITY_GAIN                        16384
+#define AUDIOMIX_MAXIMUM_GAIN                      32767
+
+   /* The following structure holds the state of a mixer.  Gain holds   */
+   /* the current gain of each source with 16 more fraction bits, Step  */
+   /* how much it changes for each frame of the fade and Target the gain*/
+   /* it ramps to.  Remaining is the number of frames left of the fade. */
+typedef struct _tagAUDIOMIX_Mixer_t
+{
+   unsigned int Sources;
+   unsigned int FadeFrames;
+   unsigned int Remaining;
+   long         Gain[AUDIOMIX_MAXIMUM_SOURCES];
+   long         Step[AUDIOMIX_MAXIMUM_SOURCES];
+   unsigned int Target[AUDIOMIX_MAXIMUM_SOURCES];
+} AUDIOMIX_Mixer_t;
+
+   /* The following function initializes the specified mixer for the    */
+   /* specified number of sources, with a fade of the specified number  */
+   /* of frames (at least one).  Every source starts muted.  This       */
+   /* function returns zero if successful or a negative value if a      */
+   /* parameter is not valid.                                           */
+int AUDIOMIX_Initialize(AUDIOMIX_Mixer_t *Mixer, unsigned int Sources, unsigned int FadeFrames);
+
+   /* The following function sets the gain (Q14, at most                */
+   /* AUDIOMIX_MAXIMUM_GAIN) of the specified source of the specified   */
+   /* mixer.  A fade of every source from its current gain to its target*/
+   /* starts with the next frame (the fade of a previous change is not  */
+   /* completed first).                                                 */
+void AUDIOMIX_SetGain(AUDIOMIX_Mixer_t *Mixer, unsigned int Source, unsigned int Gain);
+
+   /* The following function returns non-zero if the specified source of*/
+   /* the specified mixer is heard (or will be by the end of the fade). */
+int AUDIOMIX_IsAudible(AUDIOMIX_Mixer_t *Mixer, unsigned int Source);
+
+   /* The following function mixes the specified number of frames of the*/
+   /* specified sources (one pointer for each source of the mixer, NULL */
+   /* for a source that is silent) into the specified output, which may */
+   /* be one of the sources.                                            */
+void AUDIOMIX_Process(AUDIOMIX_Mixer_t *Mixer, unsigned int Frames, const short * const *Inputs, short *Output);
+
+   /* The following function is the reference version of                */
+   /* AUDIOMIX_Process().  It is only used to check the block version.  */
+void AUDIOMIX_ProcessReference(AUDIOMIX_Mixer_t *Mixer, unsigned int Frames, const short * const *Inputs, short *Output);
+
+#endif
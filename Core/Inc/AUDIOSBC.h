@@ -0,0 +1,129 @@
+/*****< audiosbc.h >***********************************************************/
+/*                                                                            */
+/*  AUDIOSBC - SBC decoder of the audio stream.                               */
+/*                                                                            */
+/*  The decoder turns the SBC frames of an A2DP stream into interleaved       */
+/*  stereo frames, so that the stream can be decoded by the MCU instead of    */
+/*  by the A3DP offload of the CC256x (which only decodes the SBC parameters  */
+/*  it has been configured with).  Every parameter of the format is           */
+/*  supported: 4 or 8 subbands, 4 to 16 blocks, mono, dual channel, stereo    */
+/*  and joint stereo, loudness and SNR allocation and any valid bit pool.  A  */
+/*  mono stream is played on both channels.                                   */
+/*                                                                            */
+/*  The subband samples of a frame are held in 16 bits relative to the        */
+/*  largest scale factor of the frame and both stages of the synthesis        */
+/*  filter bank (the matrixing and the windowing) use 64 bit dual multiply    */
+/*  accumulates (__SMLALD).  The history of the windowing is kept in the      */
+/*  order in which it is read, so each output sample is a contiguous dot      */
+/*  product of AUDIOSBC_TAPS samples.  Like AUDIOJB the module has no         */
+/*  dependencies on the HAL, the RTOS or Bluetopia.                           */
+/******************************************************************************/
+#ifndef __AUDIOSBCH__
+#define __AUDIOSBCH__
+
+   /* The following constants represent the number of channels of each  */
+   /* output frame, the largest number of subbands and blocks of an SBC */
+   /* frame (and so the largest number of output frames it decodes to)  */
+   /* and the number of taps of the windowing of each output sample.    */
+#define AUDIOSBC_CHANNELS                          2
+#define AUDIOSBC_MAXIMUM_SUBBANDS                  8
+#define AUDIOSBC_MAXIMUM_BLOCKS                    16
+#define AUDIOSBC_MAXIMUM_FRAMES                    (AUDIOSBC_MAXIMUM_SUBBANDS * AUDIOSBC_MAXIMUM_BLOCKS)
+#define AUDIOSBC_TAPS                              10
+
+   /* The following constants represent the sync word that starts every */
+   /* SBC frame and the length of its header (up to the CRC).           */
+#define AUDIOSBC_SYNCWORD                          0x9C
+#define AUDIOSBC_HEADER_LENGTH                     4
+
+   /* The following constants represent the channel modes and the       */
+   /* allocation methods of an SBC frame.                               */
+#define AUDIOSBC_CHANNEL_MODE_MONO                 0
+#define AUDIOSBC_CHANNEL_MODE_DUAL_CHANNEL         1
+#define AUDIOSBC_CHANNEL_MODE_STEREO               2
+#define AUDIOSBC_CHANNEL_MODE_JOINT_STEREO         3
+
+#define AUDIOSBC_ALLOCATION_LOUDNESS               0
+#define AUDIOSBC_ALLOCATION_SNR                    1
+
+   /* The following structure holds the format of an SBC frame.         */
+   /* Channels is the number of channels of the frame (one for mono) and*/
+   /* FrameLength its length in bytes.                                  */
+typedef struct _tagAUDIOSBC_Format_t
+{
+   unsigned long SampleRate;
+   unsigned int  Blocks;
+   unsigned int  ChannelMode;
+   unsigned int  Channels;
+   unsigned int  AllocationMethod;
+   unsigned int  Subbands;
+   unsigned int  Bitpool;
+   unsigned int  FrameLength;
+} AUDIOSBC_Format_t;
+
+   /* The following structure holds the statistics of a decoder.  Frames*/
+   /* is the number of SBC frames that were decoded, CRCErrors the      */
+   /* number that were dropped because their CRC did not match and      */
+   /* InvalidFrames the number of times the data did not start with a   */
+   /* valid frame.                                                      */
+typedef struct _tagAUDIOSBC_Statistics_t
+{
+   unsigned long Frames;
+   unsigned long CRCErrors;
+   unsigned long InvalidFrames;
+} AUDIOSBC_Statistics_t;
+
+   /* The following structure holds the state of a decoder.  Format is  */
+   /* that of the last frame, Subband holds the (16 bit) subband        */
+   /* samples of the frame being decoded.  Window holds the history of  */
+   /* the windowing: for each channel two sequences of AUDIOSBC_TAPS    */
+   /* samples per output sample (twice, see AUDIOFLT.h), which the      */
+   /* blocks alternate between (Parity is the one of the next block).   */
+   /* Position is where the next sample is written.  Reference holds the*/
+   /* history of the reference version in the order of the A2DP         */
+   /* specification instead (a decoder only uses one of them).          */
+typedef struct _tagAUDIOSBC_Decoder_t
+{
+   AUDIOSBC_Format_t      Format;
+   unsigned int           Position;
+   unsigned int           Parity;
+   short                  Subband[AUDIOSBC_MAXIMUM_BLOCKS][AUDIOSBC_CHANNELS][AUDIOSBC_MAXIMUM_SUBBANDS];
+   union
+   {
+      short               Window[AUDIOSBC_CHANNELS][2][AUDIOSBC_MAXIMUM_SUBBANDS][AUDIOSBC_TAPS * 2];
+      short               Reference[AUDIOSBC_CHANNELS][AUDIOSBC_MAXIMUM_SUBBANDS * AUDIOSBC_TAPS * 2];
+   } History;
+   AUDIOSBC_Statistics_t  Statistics;
+} AUDIOSBC_Decoder_t;
+
+   /* The following function initializes the specified decoder with an  */
+   /* empty (silent) history.  This function returns zero if successful */
+   /* or a negative value if the parameter is not valid.                */
+int AUDIOSBC_Initialize(AUDIOSBC_Decoder_t *Decoder);
+
+   /* The following function parses the header of the SBC frame at the  */
+   /* start of the specified data into the specified format.  This      */
+   /* function returns the length of the frame if successful or a       */
+   /* negative value if the data does not start with a valid header or  */
+   /* is shorter than the frame.                                        */
+int AUDIOSBC_ParseHeader(const unsigned char *Data, unsigned int Length, AUDIOSBC_Format_t *Format);
+
+   /* The following function decodes the SBC frame at the start of the  */
+   /* specified data into interleaved stereo frames, of which it returns*/
+   /* the number in the fourth parameter (at most                       */
+   /* AUDIOSBC_MAXIMUM_FRAMES).  A frame whose CRC does not match is    */
+   /* dropped (no frames are returned).  The history is cleared if the  */
+   /* number of subbands or channels changes.  This function returns the*/
+   /* length of the frame if successful or a negative value if the data */
+   /* does not start with a valid frame.                                */
+int AUDIOSBC_Decode(AUDIOSBC_Decoder_t *Decoder, const unsigned char *Data, unsigned int Length, unsigned int *Frames, short *Output);
+
+   /* The following function is the reference version of                */
+   /* AUDIOSBC_Decode().  It is only used to check the block version.   */
+int AUDIOSBC_DecodeReference(AUDIOSBC_Decoder_t *Decoder, const unsigned char *Data, unsigned int Length, unsigned int *Frames, short *Output);
+
+   /* The following function returns the statistics of the specified    */
+   /* decoder in the specified structure.                               */
+void AUDIOSBC_Query_Statistics(AUDIOSBC_Decoder_t *Decoder, AUDIOSBC_Statistics_t *Statistics);
+
+#endif
@@ -0,0 +1,146 @@
+/*****< audiosimd.h >**********************************************************/
+/*                                                                            */
+/*  AUDIOSIMD - Cortex-M4 SIMD instructions for the audio DSP modules.        */
+/*                                                                            */
+/*  On the target the CMSIS intrinsics are used.  Anywhere else (the host     */
+/*  tools) the same instructions are provided in portable C, including the    */
+/*  GE flags that are set by __SSUB16 and read by __SEL, so that the DSP      */
+/*  modules can be built and checked bit for bit on the host.  Two 16 bit     */
+/*  samples are packed in one word with the first sample in the low half.   */
+/******************************************************************************/
+#ifndef __AUDIOSIMDH__
+#define __AUDIOSIMDH__
+
+#include <stdint.h>
+#include <string.h>
+
+#if (defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1))
+
+#include "cmsis_compiler.h"
+
+#else
+
+   /* The following function returns the GE flags of the host versions  */
+   /* of the instructions.  Each 16 bit lane has two flags, as on the   */
+   /* Cortex-M4, although only one per lane is used by __SEL.           */
+static __inline uint32_t *AUDIOSIMD_GEFlags(void)
+{
+   static uint32_t GEFlags;
+
+   return(&GEFlags);
+}
+
+   /* The following function saturates the specified value to a signed  */
+   /* 16 bit value.                                                     */
+static __inline int32_t AUDIOSIMD_Saturate16(int32_t Value)
+{
+   return((Value > 32767) ? 32767 : ((Value < -32768) ? -32768 : Value));
+}
+
+   /* The following functions return the low and high (signed) 16 bit   */
+   /* halves of the specified word, and pack two 16 bit values.         */
+static __inline int32_t AUDIOSIMD_Low(uint32_t Value)
+{
+   return((int16_t)(Value & 0xFFFF));
+}
+
+static __inline int32_t AUDIOSIMD_High(uint32_t Value)
+{
+   return((int16_t)(Value >> 16));
+}
+
+static __inline uint32_t AUDIOSIMD_Pack(int32_t Low, int32_t High)
+{
+   return(((uint32_t)Low & 0xFFFF) | ((uint32_t)High << 16));
+}
+
+static __inline uint32_t __QADD16(uint32_t op1, uint32_t op2)
+{
+   return(AUDIOSIMD_Pack(AUDIOSIMD_Saturate16(AUDIOSIMD_Low(op1) + AUDIOSIMD_Low(op2)), AUDIOSIMD_Saturate16(AUDIOSIMD_High(op1) + AUDIOSIMD_High(op2))));
+}
+
+static __inline uint32_t __QSUB16(uint32_t op1, uint32_t op2)
+{
+   return(AUDIOSIMD_Pack(AUDIOSIMD_Saturate16(AUDIOSIMD_Low(op1) - AUDIOSIMD_Low(op2)), AUDIOSIMD_Saturate16(AUDIOSIMD_High(op1) - AUDIOSIMD_High(op2))));
+}
+
+   /* The GE flags of each lane are set if the (unwrapped) difference   */
+   /* is not negative.                                                  */
+static __inline uint32_t __SSUB16(uint32_t op1, uint32_t op2)
+{
+   int32_t Low;
+   int32_t High;
+
+   Low                   = AUDIOSIMD_Low(op1) - AUDIOSIMD_Low(op2);
+   High                  = AUDIOSIMD_High(op1) - AUDIOSIMD_High(op2);
+   *AUDIOSIMD_GEFlags()  = ((Low >= 0) ? 0x3 : 0) | ((High >= 0) ? 0xC : 0);
+
+   return(AUDIOSIMD_Pack(Low, High));
+}
+
+   /* Each byte of the result is taken from the first operand if its GE */
+   /* flag is set and from the second operand otherwise.                */
+static __inline uint32_t __SEL(uint32_t op1, uint32_t op2)
+{
+   uint32_t Mask;
+   uint32_t GEFlags;
+
+   GEFlags = *AUDIOSIMD_GEFlags();
+   Mask    = ((GEFlags & 0x1) ? 0x000000FF : 0) | ((GEFlags & 0x2) ? 0x0000FF00 : 0) | ((GEFlags & 0x4) ? 0x00FF0000 : 0) | ((GEFlags & 0x8) ? 0xFF000000 : 0);
+
+   return((op1 & Mask) | (op2 & ~Mask));
+}
+
+static __inline int32_t __SSAT(int32_t val, uint32_t sat)
+{
+   int32_t Maximum;
+
+   Maximum = (int32_t)((1UL << (sat - 1)) - 1);
+
+   return((val > Maximum) ? Maximum : ((val < (-Maximum - 1)) ? (-Maximum - 1) : val));
+}
+
+   /* The shift of __PKHTB is arithmetic on the Cortex-M4, which makes  */
+   /* no difference to the half that is kept for shifts of up to 16.    */
+static __inline uint32_t __PKHBT(uint32_t op1, uint32_t op2, uint32_t shift)
+{
+   return((op1 & 0x0000FFFF) | ((op2 << shift) & 0xFFFF0000));
+}
+
+static __inline uint32_t __PKHTB(uint32_t op1, uint32_t op2, uint32_t shift)
+{
+   return((op1 & 0xFFFF0000) | ((op2 >> shift) & 0x0000FFFF));
+}
+
+static __inline uint32_t __SMLAD(uint32_t op1, uint32_t op2, uint32_t op3)
+{
+   return(op3 + (uint32_t)(AUDIOSIMD_Low(op1) * AUDIOSIMD_Low(op2)) + (uint32_t)(AUDIOSIMD_High(op1) * AUDIOSIMD_High(op2)));
+}
+
+static __inline uint64_t __SMLALD(uint32_t op1, uint32_t op2, uint64_t acc)
+{
+   return(acc + (uint64_t)((int64_t)AUDIOSIMD_Low(op1) * AUDIOSIMD_Low(op2)) + (uint64_t)((int64_t)AUDIOSIMD_High(op1) * AUDIOSIMD_High(op2)));
+}
+
+#endif
+
+   /* The following macros pack two signed 16 bit values into one word, */
+   /* and read and write two consecutive 16 bit samples as one word (the*/
+   /* Cortex-M4 allows the samples to be unaligned).                    */
+#define AUDIOSIMD_PACK(_Low, _High)  (((uint32_t)(_Low) & 0xFFFF) | ((uint32_t)(_High) << 16))
+
+static __inline uint32_t AUDIOSIMD_Read2(const short *Samples)
+{
+   uint32_t Value;
+
+   memcpy(&Value, Samples, sizeof(Value));
+
+   return(Value);
+}
+
+static __inline void AUDIOSIMD_Write2(short *Samples, uint32_t Value)
+{
+   memcpy(Samples, &Value, sizeof(Value));
+}
+
+#endif
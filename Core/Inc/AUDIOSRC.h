@@ -0,0 +1,104 @@
+/*****< audiosrc.h >***********************************************************/
+/*                                                                            */
+/*  AUDIOSRC - Asynchronous sample rate converter of the audio stream.        */
+/*                                                                            */
+/*  The converter takes interleaved stereo frames at the input rate and       */
+/*  produces frames at the output rate (each rate at most twice the other).   */
+/*  Each output frame is computed from the last AUDIOSRC_TAPS input frames    */
+/*  by a polyphase low pass filter of AUDIOSRC_PHASES phases, interpolating   */
+/*  linearly between the two phases around the exact position, with 64 bit    */
+/*  dual multiply accumulates (__SMLALD).  The position advances by the       */
+/*  ratio of the rates, scaled by a correction in parts per billion, so that  */
+/*  the drift between the clock of the source and that of the SAI can be      */
+/*  followed without changing any clock.                                      */
+/*                                                                            */
+/*  The tracker turns the fill level of the buffer that feeds the converter   */
+/*  into the correction, with a proportional and integral control of the      */
+/*  (filtered) difference to a target level.  Like AUDIOFLT the module has    */
+/*  no dependencies on the HAL, the RTOS or Bluetopia.                        */
+/******************************************************************************/
+#ifndef __AUDIOSRCH__
+#define __AUDIOSRCH__
+
+   /* The following constants represent the number of channels of each  */
+   /* frame, and the number of taps and phases of the filter.           */
+#define AUDIOSRC_CHANNELS                          2
+#define AUDIOSRC_TAPS                              48
+#define AUDIOSRC_PHASES                            64
+
+   /* The following constant represents the largest correction (in parts*/
+   /* per billion, i.e. 1000 ppm).                                      */
+#define AUDIOSRC_MAXIMUM_CORRECTION                1000000L
+
+   /* The following structure holds the state of a converter.  Step is  */
+   /* the number of input frames per output frame (32 fraction bits)    */
+   /* and Fraction the position of the next output frame after the last */
+   /* input frame.  Pending is the number of input frames that must be  */
+   /* read before the next output frame.  History holds the last        */
+   /* AUDIOSRC_TAPS frames of each channel twice (see AUDIOFLT.h),      */
+   /* Position is where the next frame is written.                      */
+typedef struct _tagAUDIOSRC_State_t
+{
+   unsigned long      InputRate;
+   unsigned long      OutputRate;
+   long               Correction;
+   unsigned long long Step;
+   unsigned long      Fraction;
+   unsigned int       Pending;
+   unsigned int       Position;
+   short              History[AUDIOSRC_CHANNELS][AUDIOSRC_TAPS * 2];
+} AUDIOSRC_State_t;
+
+   /* The following structure holds the state of a tracker.  Filtered is*/
+   /* the filtered difference between the fill level and the target (in */
+   /* 1/256 frames), Smoothed is Filtered filtered again and Integral   */
+   /* its sum over the output frames.                                   */
+typedef struct _tagAUDIOSRC_Tracker_t
+{
+   unsigned int  TargetFrames;
+   long          Filtered;
+   long          Smoothed;
+   long long     Integral;
+   long          Correction;
+} AUDIOSRC_Tracker_t;
+
+   /* The following function initializes the specified converter for the*/
+   /* specified input and output rates, with no correction and an empty */
+   /* (silent) history.  This function returns zero if successful or a  */
+   /* negative value if the rates are not supported.                    */
+int AUDIOSRC_Initialize(AUDIOSRC_State_t *State, unsigned long InputRate, unsigned long OutputRate);
+
+   /* The following function changes the rates of the specified         */
+   /* converter.  The history and the position are kept, so the output  */
+   /* continues without a gap.  This function returns zero if successful*/
+   /* or a negative value if the rates are not supported.               */
+int AUDIOSRC_SetRates(AUDIOSRC_State_t *State, unsigned long InputRate, unsigned long OutputRate);
+
+   /* The following function sets the correction of the specified       */
+   /* converter in parts per billion (positive reads the input faster). */
+   /* The correction is limited to +/-AUDIOSRC_MAXIMUM_CORRECTION.      */
+void AUDIOSRC_SetCorrection(AUDIOSRC_State_t *State, long Correction);
+
+   /* The following function converts the specified input frames into at*/
+   /* most the specified number of output frames.  The second parameter */
+   /* holds the number of input frames on entry and receives the number */
+   /* that were read.  This function returns the number of output frames*/
+   /* that were produced, which is less than requested only if all of   */
+   /* the input frames have been read.                                  */
+unsigned int AUDIOSRC_Process(AUDIOSRC_State_t *State, unsigned int *InputFrames, const short *Input, unsigned int OutputFrames, short *Output);
+
+   /* The following function is the reference version of                */
+   /* AUDIOSRC_Process().  It is only used to check the block version.  */
+unsigned int AUDIOSRC_ProcessReference(AUDIOSRC_State_t *State, unsigned int *InputFrames, const short *Input, unsigned int OutputFrames, short *Output);
+
+   /* The following function initializes the specified tracker with the */
+   /* specified target fill level (in frames).                          */
+void AUDIOSRC_InitializeTracker(AUDIOSRC_Tracker_t *Tracker, unsigned int TargetFrames);
+
+   /* The following function updates the specified tracker with the     */
+   /* specified fill level of the buffer and the number of output frames*/
+   /* since the last update, and returns the correction (in parts per   */
+   /* billion) that should be set for the converter.                    */
+long AUDIOSRC_UpdateTracker(AUDIOSRC_Tracker_t *Tracker, unsigned int Frames, unsigned int ElapsedFrames);
+
+#endif
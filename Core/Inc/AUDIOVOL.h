@@ -0,0 +1,99 @@
+/*****< audiovol.h >***********************************************************/
+/*                                                                            */
+/*  AUDIOVOL - Volume of the audio output.                                    */
+/*                                                                            */
+/*  The volume stage scales interleaved stereo frames by a Q15 gain           */
+/*  (AUDIOVOL_UNITY_GAIN passes them unchanged) that is set in levels of      */
+/*  half a decibel: level 0 is 0 dB, each level is 0.5 dB quieter down to     */
+/*  AUDIOVOL_MINIMUM_LEVEL (-96 dB) and AUDIOVOL_MUTE_LEVEL is silent.  The   */
+/*  gain never changes at once: a new level, and a mute that keeps the        */
+/*  level, ramps the gain over the specified number of frames, either         */
+/*  linearly or exponentially (linearly in decibels, as segments of           */
+/*  AUDIOVOL_SEGMENT_FRAMES frames that are each linear), so changing the     */
+/*  volume does not click.  The block version scales a span of constant       */
+/*  gain without the ramp (copying it at unity gain and clearing it when      */
+/*  silent), the reference version processes one frame at a time and MUST     */
+/*  give the same result.  Like AUDIOJB the module has no dependencies on     */
+/*  the HAL, the RTOS or Bluetopia.                                           */
+/******************************************************************************/
+#ifndef __AUDIOVOLH__
+#define __AUDIOVOLH__
+
+   /* The following constants represent the number of channels of each  */
+   /* frame, the gain that passes the frames unchanged (Q15), the number*/
+   /* of levels in each decibel, the quietest level that is heard, the  */
+   /* level that is silent and the length of each segment of an         */
+   /* exponential ramp.                                                 */
+#define AUDIOVOL_CHANNELS                          2
+#define AUDIOVOL_UNITY_GAIN                        32768
+#define AUDIOVOL_LEVELS_PER_DECIBEL                2
+#define AUDIOVOL_MINIMUM_LEVEL                     192
+#define AUDIOVOL_MUTE_LEVEL                        (AUDIOVOL_MINIMUM_LEVEL + 1)
+#define AUDIOVOL_SEGMENT_FRAMES                    16
+
+   /* The following enumerated type represents the shapes of the ramps. */
+typedef enum
+{
+   vrLinear,
+   vrExponential
+} AUDIOVOL_Ramp_t;
+
+   /* The following structure holds the state of a volume stage.  Level */
+   /* and Muted are the level and the mute the gain ramps to and Target */
+   /* that gain.  Gain holds the current gain with 15 more fraction bits*/
+   /* and Step how much it changes for each frame of the current        */
+   /* segment.  Position is the level (with 12 fraction bits) at the end*/
+   /* of the current segment and Rate how much it changes for each      */
+   /* frame.  Remaining and Segment are the number of frames left of the*/
+   /* ramp and of the current segment.                                  */
+typedef struct _tagAUDIOVOL_Stage_t
+{
+   AUDIOVOL_Ramp_t Ramp;
+   unsigned int    Level;
+   int             Muted;
+   unsigned int    Target;
+   long            Gain;
+   long            Step;
+   long            Position;
+   long            Rate;
+   unsigned int    Remaining;
+   unsigned int    Segment;
+} AUDIOVOL_Stage_t;
+
+   /* The following function returns the gain (Q15) of the specified    */
+   /* level (zero for AUDIOVOL_MUTE_LEVEL and above).                   */
+unsigned int AUDIOVOL_LevelGain(unsigned int Level);
+
+   /* The following function initializes the specified volume stage with*/
+   /* ramps of the specified shape at the specified level and mute,     */
+   /* without a ramp.  This function returns zero if successful or a    */
+   /* negative value if a parameter is not valid.                       */
+int AUDIOVOL_Initialize(AUDIOVOL_Stage_t *Stage, AUDIOVOL_Ramp_t Ramp, unsigned int Level, int Muted);
+
+   /* The following function sets the level (at most                    */
+   /* AUDIOVOL_MUTE_LEVEL) of the specified volume stage.  Unless it is */
+   /* the current level the gain ramps from where it is over the        */
+   /* specified number of frames (at least one), starting with the next */
+   /* frame.  The level is kept while the stage is muted.               */
+void AUDIOVOL_SetLevel(AUDIOVOL_Stage_t *Stage, unsigned int Level, unsigned int Frames);
+
+   /* The following function mutes (if the second parameter is non-zero)*/
+   /* or un-mutes the specified volume stage.  Unless the stage already */
+   /* is, the gain ramps from where it is over the specified number of  */
+   /* frames (at least one), starting with the next frame.              */
+void AUDIOVOL_SetMute(AUDIOVOL_Stage_t *Stage, int Mute, unsigned int Frames);
+
+   /* The following function returns non-zero if the output of the      */
+   /* specified volume stage is heard (or will be by the end of the     */
+   /* ramp).                                                            */
+int AUDIOVOL_IsAudible(AUDIOVOL_Stage_t *Stage);
+
+   /* The following function scales the specified number of frames of the*/
+   /* specified input into the specified output, which may be the input.*/
+void AUDIOVOL_Process(AUDIOVOL_Stage_t *Stage, unsigned int Frames, const short *Input, short *Output);
+
+   /* The following function is the reference version of                */
+   /* AUDIOVOL_Process().  It is only used to check the block version.  */
+void AUDIOVOL_ProcessReference(AUDIOVOL_Stage_t *Stage, unsigned int Frames, const short *Input, short *Output);
+
+#endif
@@ -168,6 +168,8 @@ standard names. */
 
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+/* The idle task stops the tick and enters STOP2 (see vPortSuppressTicksAndSleep() in LOWPOWER.c) */
+#define configUSE_TICKLESS_IDLE                  2
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,103 @@
+/*****< i2cqueue.h >**********************************************************/
+/*                                                                           */
+/*  I2CQUEUE - Non-blocking register writes to the I2C1 control devices.     */
+/*                                                                           */
+/*  The register writes to a device (the codec or the IO expander) are       */
+/*  queued as sequences and sent on I2C1 by DMA, each transfer being         */
+/*  started from the interrupt that ends the one before, so the caller (a    */
+/*  Bluetooth callback) never waits for the bus.  The writes of a sequence   */
+/*  to consecutive registers are sent as a single transfer when the device   */
+/*  increments its register address, so a whole block of a power up script   */
+/*  is one DMA transfer.  Each device has a shadow of the values written to  */
+/*  its registers and a write of the value that a register already holds is  */
+/*  dropped when it is queued.                                               */
+/*****************************************************************************/
+#ifndef I2CQUEUE_H_
+#define I2CQUEUE_H_
+
+#define I2CQUEUE_ERROR_INVALID_PARAMETER  (-3100)
+#define I2CQUEUE_ERROR_QUEUE_FULL         (-3101)
+#define I2CQUEUE_ERROR_TRANSFER_FAILED    (-3102)
+
+   /* The following constants represent the number of devices that may  */
+   /* be registered, the number of sequences that may be queued and the */
+   /* number of writes in each sequence.                                */
+#define I2CQUEUE_MAXIMUM_DEVICES          2
+#define I2CQUEUE_MAXIMUM_SEQUENCES        8
+#define I2CQUEUE_MAXIMUM_WRITES           32
+
+   /* The following structure holds a single register write.            */
+typedef struct _tagI2CQUEUE_Write_t
+{
+   unsigned char Register;
+   unsigned char Value;
+} I2CQUEUE_Write_t;
+
+   /* The following type represents the function that is called once    */
+   /* the writes of a sequence have been sent (Status is zero) or have  */
+   /* failed (Status is negative).  The sequences complete in the order */
+   /* they were queued.                                                 */
+   /* * NOTE * This function is called from the I2C or DMA interrupt, or*/
+   /*          from I2CQUEUE_Write_Sequence() when nothing is left to   */
+   /*          send, so it must not block.                              */
+typedef void (*I2CQUEUE_Callback_t)(unsigned int DeviceID, int Status, unsigned long CallbackParameter);
+
+   /* The following structure is used with I2CQUEUE_Query_Statistics()   */
+   /* to return the number of sequences that have been queued, the      */
+   /* number of transfers that have been sent, the number of writes that*/
+   /* were dropped because the register already held the value and the  */
+   /* number of transfers that failed.                                  */
+typedef struct _tagI2CQUEUE_Statistics_t
+{
+   unsigned long Sequences;
+   unsigned long Transfers;
+   unsigned long SkippedWrites;
+   unsigned long Errors;
+} I2CQUEUE_Statistics_t;
+
+   /* The following function registers the device at the specified 7 bit*/
+   /* address.  If the second parameter is non-zero the device          */
+   /* increments its register address after each write, once the third  */
+   /* parameter has been OR'ed into the register address (zero if it    */
+   /* always does).  This function returns the ID of the device (used   */
+   /* with the other functions) if successful or a negative value if    */
+   /* there was an error.                                               */
+int I2CQUEUE_Register_Device(unsigned int Address, int AutoIncrement, unsigned int IncrementFlag);
+
+   /* The following function forgets the shadow of every register of the*/
+   /* specified device, so that the next write of each register is sent.*/
+   /* It must be called once the device has been reset.                 */
+void I2CQUEUE_Invalidate(unsigned int DeviceID);
+
+   /* The following function queues the specified register writes to the*/
+   /* specified device, which are sent in order.  The writes are copied,*/
+   /* so the array does not have to be kept.  The callback (which may be*/
+   /* NULL) is called once the sequence has been sent.  This function   */
+   /* returns zero if successful or a negative value if there was an    */
+   /* error.                                                            */
+   /* * NOTE * If a transfer fails the rest of its sequence is dropped, */
+   /*          as are the sequences already queued to the same device   */
+   /*          (their callbacks are called with                         */
+   /*          I2CQUEUE_ERROR_TRANSFER_FAILED), and the shadow of the   */
+   /*          device is invalidated.                                   */
+int I2CQUEUE_Write_Sequence(unsigned int DeviceID, unsigned int NumberWrites, const I2CQUEUE_Write_t *Writes, I2CQUEUE_Callback_t Callback, unsigned long CallbackParameter);
+
+   /* The following function queues a single register write to the      */
+   /* specified device (see I2CQUEUE_Write_Sequence()).  This function  */
+   /* returns zero if successful or a negative value if there was an    */
+   /* error.                                                            */
+int I2CQUEUE_Write_Register(unsigned int DeviceID, unsigned int Register, unsigned int Value, I2CQUEUE_Callback_t Callback, unsigned long CallbackParameter);
+
+   /* The following function returns the value that the specified       */
+   /* register of the specified device holds once the queued writes have*/
+   /* been sent, so that a field of a register can be changed without   */
+   /* reading it.  This function returns the value if it is known or a  */
+   /* negative value if it is not.                                      */
+int I2CQUEUE_Query_Register(unsigned int DeviceID, unsigned int Register);
+
+   /* The following function returns the statistics of the queue in the */
+   /* specified structure and, if the second parameter is non-zero,     */
+   /* resets them.                                                      */
+void I2CQUEUE_Query_Statistics(I2CQUEUE_Statistics_t *Statistics, int Reset);
+
+#endif
@@ -0,0 +1,58 @@
+/*****< lowpower.h >**********************************************************/
+/*                                                                           */
+/*  LOWPOWER - FreeRTOS tickless idle with STOP2 for the STM32L4R5.          */
+/*                                                                           */
+/*  When every driver that needs the high speed clocks has released its      */
+/*  lock the idle task stops the MCU in STOP2 until the next task is due     */
+/*  (timed by LPTIM1 from the LSE) or until a wake up interrupt occurs.      */
+/*  Otherwise the idle task only waits for the next interrupt in sleep       */
+/*  mode with the tick running.                                              */
+/*****************************************************************************/
+#ifndef LOWPOWER_H_
+#define LOWPOWER_H_
+
+   /* The following constants represent the locks (bit mask) that       */
+   /* prevent the MCU from entering STOP2.  A driver that needs a clock */
+   /* or peripheral that does not run in STOP2 must hold its lock while */
+   /* it needs it.                                                      */
+   /* * NOTE * The HCI transport lock is held from start up until the   */
+   /*          transport is suspended by the HCILL low power protocol.  */
+   /*          The audio lock is held while the SAI1 pipeline runs.     */
+   /*          The I2C queue lock is held while register writes are     */
+   /*          queued or being sent.                                    */
+#define LOWPOWER_LOCK_HCI_TRANSPORT       0x00000001
+#define LOWPOWER_LOCK_AUDIO               0x00000002
+#define LOWPOWER_LOCK_I2C_QUEUE           0x00000004
+
+   /* The following structure is used with LOWPOWER_QueryStatistics()   */
+   /* to return the number of times that the idle task entered sleep    */
+   /* mode and STOP2, the total time (in milliseconds) spent in STOP2   */
+   /* and the longest single STOP2 period (in milliseconds).            */
+typedef struct _tagLOWPOWER_Statistics_t
+{
+   unsigned long SleepCount;
+   unsigned long StopCount;
+   unsigned long StopTime;
+   unsigned long LongestStop;
+} LOWPOWER_Statistics_t;
+
+   /* The following function configures LPTIM1 (clocked from the LSE)   */
+   /* that times the STOP2 periods.  This function must be called before*/
+   /* the scheduler is started.                                         */
+void LOWPOWER_Initialize(void);
+
+   /* The following function takes the specified lock(s), preventing    */
+   /* the MCU from entering STOP2.  This function may be called from an */
+   /* interrupt.                                                        */
+void LOWPOWER_PreventStop(unsigned long Locks);
+
+   /* The following function releases the specified lock(s).  This      */
+   /* function may be called from an interrupt.                         */
+void LOWPOWER_AllowStop(unsigned long Locks);
+
+   /* The following function returns the low power statistics in the    */
+   /* specified structure and, if the second parameter is non-zero,     */
+   /* resets them.                                                      */
+void LOWPOWER_QueryStatistics(LOWPOWER_Statistics_t *Statistics, int Reset);
+
+#endif
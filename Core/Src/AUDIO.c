@@ -24,26 +24,52 @@
 /* Library includes. */
 #include "BTPSKRNL.h"
 #include "SS1BTVS.h"       /* Vendor Specific Prototypes/Constants.*/
+#include "FreeRTOS.h"
+#include "task.h"
 #include "AUDIO.h"
 #include "AUDIOCFG.h"
+#include "AUDIOCLK.h"
+#include "AUDIODC.h"
+#include "AUDIOFLT.h"
+#include "AUDIOJB.h"
+#include "AUDIOMIX.h"
+#include "AUDIOSBC.h"
+#include "AUDIOSRC.h"
+#include "AUDIOVOL.h"
+#include "LOWPOWER.h"
+#include "adc.h"
+#include "sai.h"
+#include "tim.h"
 #include "main.h"
 
+   /* The following constants represent the number of channels of each  */
+   /* frame and the number of periods in the DMA buffers of the SAI1    */
+   /* pipeline.                                                         */
+#define AUDIO_CHANNELS                    2
+#define AUDIO_PERIODS                     2
 
-#define AUDIO_INTERRUPT_PRIORITY      (1)
+   /* The following constant represents the fragmented bit of the media */
+   /* payload header that precedes the SBC frames of an A2DP packet.    */
+#define SBC_PAYLOAD_FRAGMENTED            0x80
+
+   /* The following macro reads the DWT cycle counter that is used to   */
+   /* time the processing of each period, and the following converts a  */
+   /* number of cycles to microseconds.                                 */
+#define GetTimeStamp()                    (DWT->CYCCNT)
+#define CyclesToMicroseconds(_x)          ((_x) / (SystemCoreClock / 1000000))
 
 #define I2S_CLK_FREQ_IN_FS_8KHZ           256
 #define I2S_CLK_FREQ_IN_FS_16KHZ          512
 #define I2S_CLK_FREQ_IN_FS_48KHZ          1536
 #define I2S_CLK_FREQ_IN_FS_44_1KHZ        1411
 
-#define ADC_MIC_ZERO_SAMPLE               0x0790
+/* The DC level of the 14 bit oversampled microphone samples (see adc.c) */
+#define ADC_MIC_ZERO_SAMPLE               0x1E40
 /* The value for the Noise-Gate. When the sample value is between */
 /* +/-DC_REMOVAL_THRESHOLD the sample is cleared */
 #define DC_REMOVAL_THRESHOLD              800
-/* For DC removal, each 256 ADC samples are averaged */
-#define AVERAGE_NUMBER_FOR_DC_REMOVAL            256
-/* For DC removal, take 16 values from the last 256 averages and make moving average */
-#define MOVING_AVERAGE_NUMBER_FOR_DC_REMOVAL     16
+/* The microphone samples are amplified by 2^MIC_GAIN_SHIFT once the DC is removed */
+#define MIC_GAIN_SHIFT                    1
 
  /* The following is used as a printf() replacement.        */
 #define Display(_x) do { BTPS_OutputMessage _x; } while(0)
@@ -54,16 +80,117 @@ typedef enum
    psPaused
 } PlaybackState_t;
 
+   /* The following structure holds the state of a source of the stream */
+   /* that is played at the A2DP rates.  StreamRate is the rate of the  */
+   /* source and ConverterRate the rate its converter is set to, which  */
+   /* the audio task changes to StreamRate.  Correction is the current  */
+   /* correction of the converter.  StreamBase holds the statistics of  */
+   /* the jitter buffer when the statistics were last reset.            */
+typedef struct _tagAudio_Source_t
+{
+   volatile unsigned long    StreamRate;
+   unsigned long             ConverterRate;
+   long                      Correction;
+   AUDIOJB_Buffer_t          JitterBuffer;
+   AUDIOJB_Statistics_t      StreamBase;
+   AUDIOSRC_State_t          Converter;
+   AUDIOSRC_Tracker_t        Tracker;
+   AUDIOSBC_Decoder_t        Decoder;
+} Audio_Source_t;
+
+   /* The following structure holds the state of the audio interface.   */
+   /* PeriodsSignaled is incremented by the DMA interrupt each time a   */
+   /* period has been transferred (NextPeriod is the index of that      */
+   /* period in the buffers) and PeriodsProcessed is set to it by the   */
+   /* audio task once the period has been processed.  Sources holds each*/
+   /* source of the stream, which the mixer adds with the gains in      */
+   /* SourceGain (Q14, the audio task passes a change to the            */
+   /* mixer).  DecodeCycles is the total number of cycles spent decoding*/
+   /* the SBC frames that have been counted in the statistics.  The     */
+   /* output of each period is scaled by Volume, which ramps to         */
+   /* VolumeLevel over a period and mutes over FadeFrames while Muted   */
+   /* (paused) or in standby.  VolumeAttenuation is how far the absolute*/
+   /* volume is below AUDIO_MAXIMUM_ABSOLUTE_VOLUME.  Standby is set    */
+   /* while the pipeline keeps running after audio has been             */
+   /* uninitialized: the output fades out and once it is Silent the     */
+   /* periods are cleared without being processed, until StandbyPeriods */
+   /* have passed and the audio task stops the pipeline (Stopping is set*/
+   /* while it does).  PipelineRate is the rate SAI1 runs at and        */
+   /* ClockPlan the clock plan SAI1 is clocked with (NULL until SAI1 has*/
+   /* been clocked from PLLSAI2).  MicrophoneLength is the length of the*/
+   /* capture buffer of the microphone, which the DMA of ADC1 fills     */
+   /* while MicrophoneRunning is set, and MicrophoneRead is where the   */
+   /* audio task reads it next (once MicrophoneAligned is set).         */
 typedef struct _tagAudio_Context_t
 {
-   Boolean_t        Initialized;
-   PlaybackState_t  PlaybackState;
-   unsigned short   CurrentVolume;
-   Boolean_t        hfpAudio;
+   Boolean_t                 Initialized;
+   PlaybackState_t           PlaybackState;
+   volatile unsigned int     VolumeAttenuation;
+   Boolean_t                 hfpAudio;
+   volatile Boolean_t        Running;
+   unsigned int              PeriodFrames;
+   AUDIO_Process_Callback_t  ProcessCallback;
+   unsigned long             CallbackParameter;
+   volatile unsigned long    PeriodsSignaled;
+   volatile unsigned long    PeriodsProcessed;
+   volatile unsigned int     NextPeriod;
+   AUDIO_Statistics_t        Statistics;
+   AUDIODC_State_t           MicrophoneDC;
+   AUDIOFLT_Bank_t           Filter;
+   Audio_Source_t            Sources[AUDIO_STREAM_SOURCES];
+   AUDIOMIX_Mixer_t          Mixer;
+   volatile unsigned int     SourceGain[AUDIO_STREAM_SOURCES];
+   unsigned long long        DecodeCycles;
+   AUDIOVOL_Stage_t          Volume;
+   volatile unsigned int     VolumeLevel;
+   volatile Boolean_t        Muted;
+   unsigned int              FadeFrames;
+   volatile Boolean_t        Standby;
+   volatile Boolean_t        Silent;
+   volatile Boolean_t        Stopping;
+   unsigned long             StandbyPeriods;
+   unsigned long             PipelineRate;
+   const AUDIOCLK_Plan_t    *ClockPlan;
+   unsigned int              MicrophoneLength;
+   unsigned int              MicrophoneRead;
+   Boolean_t                 MicrophoneRunning;
+   Boolean_t                 MicrophoneAligned;
 } AUDIO_Context_t;
 
 static AUDIO_Context_t AUDIO_Context;
 
+   /* The following buffers are transferred continuously by the DMA of  */
+   /* SAI1 block A (TxBuffer) and block B (RxBuffer).  Each holds       */
+   /* AUDIO_PERIODS periods of interleaved stereo samples.              */
+static short TxBuffer[AUDIO_PERIODS * AUDIO_MAXIMUM_PERIOD_FRAMES * AUDIO_CHANNELS];
+static short RxBuffer[AUDIO_PERIODS * AUDIO_MAXIMUM_PERIOD_FRAMES * AUDIO_CHANNELS];
+
+   /* The following buffer is filled continuously by the DMA of ADC1    */
+   /* with one oversampled microphone sample for each trigger of        */
+   /* TIM6.  It holds AUDIO_MICROPHONE_PERIODS periods.                 */
+static short CaptureBuffer[AUDIO_MICROPHONE_PERIODS * AUDIO_MAXIMUM_PERIOD_FRAMES];
+
+   /* The following buffer holds the microphone samples of one period.  */
+static short MicrophoneBuffer[AUDIO_MAXIMUM_PERIOD_FRAMES];
+
+   /* The following buffers hold the jitter buffer of each source of the */
+   /* stream, AUDIO_STREAM_FIFO_FRAMES interleaved stereo frames.       */
+static short StreamBuffer[AUDIO_STREAM_SOURCES][AUDIO_STREAM_FIFO_FRAMES * AUDIO_CHANNELS];
+
+   /* The following buffers hold one period of each source of the       */
+   /* stream, converted to the rate of SAI1, before it is mixed.        */
+static short SourceBuffer[AUDIO_STREAM_SOURCES][AUDIO_MAXIMUM_PERIOD_FRAMES * AUDIO_CHANNELS];
+
+   /* The following buffer holds the interleaved stereo frames of the   */
+   /* SBC frame that was last decoded.                                  */
+static short DecodeBuffer[AUDIOSBC_MAXIMUM_FRAMES * AUDIOSBC_CHANNELS];
+
+   /* The following variables hold the audio task, which is created the */
+   /* first time the pipeline is started.                               */
+static TaskHandle_t AudioTaskHandle;
+static StaticTask_t AudioTaskBuffer;
+static StackType_t  AudioTaskStack[AUDIO_TASK_STACK_SIZE];
+
 /*
 // Configure the ADC Microphone input pin(PF10)
 static BTPSCONST GPIO_InitTypeDef ADC3_Input_GpioConfiguration = {(1 << ADC3_MIC_PIN),  
@@ -90,61 +217,22 @@ static BTPSCONST GPIO_InitTypeDef Audio_DBG_GpioConfiguration = {(1 << AUDIO_DBG
 #endif // DEBUG_ADC_SAMPLING_TIME
 */
 
-static int SetVolume(unsigned int Volume);
-
-/* The following function Cpnfigure the ADC for Microphone voice sampling */
-static void ADC_Configuration(void)
-{
-	/*
-  ADC_InitTypeDef       ADC_InitStructure;
-  ADC_CommonInitTypeDef ADC_CommonInitStructure;
- 
-  // Put everything back to power-on defaults
-  ADC_DeInit();
-  // Enable ADC3 and GPIO F the MIC input clocks
-  RCC_APB2PeriphClockCmd(RCC_APB2Periph_ADC3, ENABLE);
-  RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOF, ENABLE);
-  // ADC3 Channel 8 -> PF10
-  GPIO_Init(GPIOF, (GPIO_InitTypeDef *)&ADC3_Input_GpioConfiguration);
-  // ADC Common Init
-  ADC_CommonInitStructure.ADC_Mode = ADC_Mode_Independent;
-  ADC_CommonInitStructure.ADC_Prescaler = ADC_Prescaler_Div2;
-  ADC_CommonInitStructure.ADC_DMAAccessMode = ADC_DMAAccessMode_Disabled;
-  ADC_CommonInitStructure.ADC_TwoSamplingDelay = ADC_TwoSamplingDelay_5Cycles;
-  ADC_CommonInit(&ADC_CommonInitStructure);
-  
-  // ADC3 Init
-  ADC_InitStructure.ADC_Resolution = ADC_Resolution_12b;
-  ADC_InitStructure.ADC_ScanConvMode = DISABLE;
-  ADC_InitStructure.ADC_ContinuousConvMode = DISABLE;
-  ADC_InitStructure.ADC_ExternalTrigConvEdge = ADC_ExternalTrigConvEdge_None;
-  ADC_InitStructure.ADC_ExternalTrigConv = ADC_ExternalTrigConv_T1_CC1;
-  ADC_InitStructure.ADC_DataAlign = ADC_DataAlign_Right;
-  ADC_InitStructure.ADC_NbrOfConversion = 1;
-  ADC_Init(ADC3, &ADC_InitStructure);
-
-  // Enable ADC3
-  ADC_Cmd(ADC3, ENABLE);
-  */
-}
-
-/* The following function reads ADC sample and returns the value  */
-static unsigned short readADC3(unsigned char channel)
-{
-  /* Enable ADC3 */
-	/*
-  ADC_Cmd(ADC3, ENABLE);
-  
-  ADC_RegularChannelConfig(ADC3, ADC_Channel_8, 1, ADC_SampleTime_3Cycles);
-  // Start the conversion
-  ADC_SoftwareStartConv(ADC3);
-  // Wait until conversion completion
-  while(ADC_GetFlagStatus(ADC3, ADC_FLAG_EOC) == RESET);
-  // Return the conversion value
-  return ADC_GetConversionValue(ADC3);
-  */
-	return 0;
-}
+static unsigned int AbsoluteVolumeLevel(unsigned int Volume);
+static void ReadMicrophone(unsigned int Frames);
+static void ProcessMicrophone(unsigned int Frames, short *Output);
+static void ProcessStream(unsigned int Frames, short *Output);
+static void DefaultProcess(unsigned int Frames, const short *Input, short *Output, unsigned long CallbackParameter);
+static void SignalPeriod(unsigned int Period);
+static void AudioTask(void *Parameter);
+static void InitializeProcessing(unsigned long Frequency);
+static unsigned long SelectPipelineRate(unsigned long Frequency);
+static int SetClock(unsigned long Frequency);
+static int StartMicrophone(unsigned long Frequency);
+static void StopMicrophone(void);
+static int StartPipeline(unsigned long Frequency);
+static void StopPipeline(void);
+static void StopStandby(void);
+static Boolean_t ResumeStandby(unsigned long Frequency);
 
 #ifdef A3DP_SRC_PLAY_SIN
 unsigned short sin_array8k400hz[120] = {
@@ -163,185 +251,712 @@ unsigned short sin_array8k400hz[120] = {
   };
 #endif /* A3DP_SRC_PLAY_SIN */
 
-/* The following function is the interrupt request handler for the   */
-/* I2S interface.                                                    */
-void AUDIO_I2S_IRQ_HANDLER(void)
+   /* The following function copies the next specified number of        */
+   /* microphone samples from the capture buffer to                     */
+   /* MicrophoneBuffer.  The audio task reads half the capture buffer   */
+   /* behind the DMA of ADC1.  The read position is aligned there the   */
+   /* first time, moves by one sample more or less when it has drifted  */
+   /* more than AUDIO_MICROPHONE_SLACK samples from there (TIM6 and SAI1*/
+   /* are not clocked by the same PLL, so their rates differ slightly)  */
+   /* and is aligned again if the DMA has come within a period of it.   */
+static void ReadMicrophone(unsigned int Frames)
 {
-	/*
-#ifdef A3DP_SRC_PLAY_SIN
-   static int  sin_index = 0;
-#endif
-   static unsigned short  in_sample = 0;
-   static unsigned short  last_in_samples[4];
-   static unsigned short  last_in_samples_point = 0;
-   static unsigned short  last_samples_average[256];
-   static short           samples_array_pointer = 0;
-   static unsigned long   samples_average = ADC_MIC_ZERO_SAMPLE;
-   static unsigned long   averages_array[16];
-   static unsigned long   averages_array_pointer = 0;
-   static unsigned char   start_dc_removal = 0;
-   static unsigned char   Data_Status;
-   static unsigned short  right_sample = 0;
-   // Write the next word onto the transmit buffer.
-   if(SPI_I2S_GetFlagStatus(AUDIO_I2S_BASE, SPI_I2S_FLAG_TXE ))
+   unsigned int Length;
+   unsigned int Target;
+   unsigned int Write;
+   unsigned int Read;
+   unsigned int Distance;
+   unsigned int Count;
+   unsigned int Advance;
+   unsigned int Index;
+
+   Length   = AUDIO_Context.MicrophoneLength;
+   Target   = Length / 2;
+
+   /* The DMA counts the samples that are left until it wraps.          */
+   Write    = (Length - __HAL_DMA_GET_COUNTER(hadc1.DMA_Handle)) % Length;
+   Distance = (Write + Length - AUDIO_Context.MicrophoneRead) % Length;
+
+   if((!AUDIO_Context.MicrophoneAligned) || (Distance < Frames) || (Distance > (Length - Frames)))
    {
-   		// Check what channel, L/R
-   		if(SPI_I2S_GetFlagStatus(AUDIO_I2S_BASE, I2S_FLAG_CHSIDE))
-   		{   // Channel R
-#ifdef A3DP_SRC_PLAY_SIN
-            SPI_I2S_SendData(SPI2, in_sample);
-#else 
-			SPI_I2S_SendData(SPI2, 0x00);
-            if(AUDIO_Context.hfpAudio)
-            {
-                right_sample = readADC3(8);
-            }
-#endif  
-   		}
-		else
-		{   // Channel L
-            int i2s_16b_val = 0;
-#ifdef DEBUG_ADC_SAMPLING_TIME
-			GPIO_SetBits(AUDIO_DBG_GPIO_PORT, (1 << AUDIO_DBG_PIN));
-#endif
-            if(AUDIO_Context.hfpAudio)
-            {
-                in_sample = readADC3(8);
-                in_sample = ((right_sample + in_sample) >> 1);
-                // Save the sample in integer value for rescale to (+/-)2^15
-                i2s_16b_val = (int) in_sample;
-                // Save the reading for average and DC removal
-                last_samples_average[samples_array_pointer] = in_sample;
-                samples_array_pointer++;
-                // Check if we have new 256 readings, for moving average
-                if(samples_array_pointer >= 256) {
-                    int i;
-                    unsigned long averaging = 0;
-                    // Clear the pointer for next 256 readings
-                    samples_array_pointer = 0;
-                    // Sum the samples -> Max(12bits)= 0x3FFF = 16,383 -> 16,383*256=4,194,048 which smaller then 2^32 ( U long )
-                    for(i=0; i<256; i++) {
-                        averaging += last_samples_average[i];
-                    }
-                    // Devide by 256=2^8
-                    averaging = averaging >> 8;
-                    // Save in the averages array
-                    averages_array[averages_array_pointer++] = averaging;
-                    // Check if clear the round moving pointer
-                    if(averages_array_pointer >= 16) {
-                        averages_array_pointer = 0;
-                        // Set the flag to start the DC removal by changing the average
-                        if(!start_dc_removal) {
-                            start_dc_removal = 1;
-                        }
-                    }
-                    // Check if start DC removal after 256*16=2048 samples arrived -> in 16KHz - 256msec
-                    if(start_dc_removal) {
-                        averaging = 0;
-                        // Make 16 average on the averages moving array
-                        for(i=0; i<16; i++) {
-                            averaging += averages_array[i];
-                        }
-                        // Devide by 16 - 2^4
-                        averaging = averaging >> 4;
-                        // Set new DC value
-                        samples_average = averaging;
-                    }
-                }
-                
-                i2s_16b_val -= samples_average; 
-                i2s_16b_val <<= 3;
-                
-                // Remove DC noise
-                if((i2s_16b_val < DC_REMOVAL_THRESHOLD) && (i2s_16b_val > (-DC_REMOVAL_THRESHOLD)))
-                {
-                     i2s_16b_val = 0;
-                }
-                
-                in_sample = (unsigned short) i2s_16b_val;
-                // Make simple Filter to remove circuit noises
-                last_in_samples[last_in_samples_point] = in_sample;
-                last_in_samples_point++;
-                if(last_in_samples_point >= 4)
-                {
-                    last_in_samples_point = 0;
-                    Data_Status = 1;
-                }
-            
-                if(Data_Status)
-                {
-                    unsigned short a0_sample, a1_sample, a2_sample, a3_sample;
-                
-                    if(0 ==  last_in_samples_point)
-                    {
-                        a0_sample = last_in_samples[3];
-                        a1_sample = last_in_samples[2];
-                        a2_sample = last_in_samples[1];
-                        a3_sample = last_in_samples[0];
-                    }
-                    else
-                    {
-                        a0_sample = last_in_samples[(last_in_samples_point-1)];
-                        a3_sample = last_in_samples[(last_in_samples_point)];
-                        a2_sample = last_in_samples[((last_in_samples_point+1)%4)];
-                        a1_sample = last_in_samples[((last_in_samples_point+2)%4)];
-                    }
-                
-                    //  Simple FIR coefficients: 1/2=a0  1/4=a1  1/8=a2  1/8=a3
-                    in_sample = (a0_sample >> 1) + (a1_sample >> 2) + (a2_sample >> 3) + (a3_sample >> 3);
-                SPI_I2S_SendData(SPI2, in_sample);
-            }
-            else
-            {
-                    // Start send the sampled data to the Bluetooth after the first 4 samples to average
-                    SPI_I2S_SendData(SPI2, 0x00);
-                }
-            }
-            else
-            {
+      if(AUDIO_Context.MicrophoneAligned)
+         AUDIO_Context.Statistics.MicrophoneResyncs++;
+
+      AUDIO_Context.MicrophoneRead    = (Write + Length - Target) % Length;
+      AUDIO_Context.MicrophoneAligned = TRUE;
+
+      Distance                        = Target;
+   }
+
+   Count   = Frames;
+   Advance = Frames;
+
+   /* If ADC1 runs faster a sample is dropped, if it runs slower the    */
+   /* last sample is repeated.                                          */
+   if(Distance > (Target + AUDIO_MICROPHONE_SLACK))
+   {
+      Advance++;
+
+      AUDIO_Context.Statistics.MicrophoneSlips++;
+   }
+   else
+   {
+      if((Frames > 1) && ((Distance + AUDIO_MICROPHONE_SLACK) < Target))
+      {
+         Count--;
+         Advance--;
+
+         AUDIO_Context.Statistics.MicrophoneSlips++;
+      }
+   }
+
+   for(Index = 0, Read = AUDIO_Context.MicrophoneRead; Index < Count; Index++)
+   {
+      MicrophoneBuffer[Index] = CaptureBuffer[Read];
+
+      if(++Read == Length)
+         Read = 0;
+   }
+
+   if(Count < Frames)
+      MicrophoneBuffer[Count] = MicrophoneBuffer[Count - 1];
+
+   AUDIO_Context.MicrophoneRead = (AUDIO_Context.MicrophoneRead + Advance) % Length;
+}
+
+   /* The following function reads the microphone samples of the        */
+   /* specified number of frames (see ReadMicrophone()), removes the DC */
+   /* level and applies the noise gate (see AUDIODC.h), filters them    */
+   /* with the filter bank of the sample rate (see AUDIOFLT.h) and sends*/
+   /* the samples on the left channel of the specified output.          */
+static void ProcessMicrophone(unsigned int Frames, short *Output)
+{
+   unsigned int Index;
+
+   ReadMicrophone(Frames);
+
+   AUDIODC_Process(&AUDIO_Context.MicrophoneDC, Frames, MicrophoneBuffer, MicrophoneBuffer);
+   AUDIOFLT_Process(&AUDIO_Context.Filter, Frames, MicrophoneBuffer, MicrophoneBuffer);
+
+   for(Index = 0; Index < Frames; Index++)
+   {
+      *Output++ = MicrophoneBuffer[Index];
+      *Output++ = 0;
+   }
+}
+
+   /* The following function converts the specified source of the stream*/
+   /* to the rate of SAI1 and sends the specified number of frames of it*/
+   /* to the specified output.  The correction of the converter is      */
+   /* updated first from the depth of the jitter buffer, so that the    */
+   /* source is read exactly as fast as it is written and the depth     */
+   /* follows the target depth.  Playing starts once the jitter buffer  */
+   /* holds the target depth, and if it runs out the rest of the period */
+   /* is concealed (see AUDIOJB.h).                                     */
+static void ProcessSource(Audio_Source_t *Source, unsigned int Frames, short *Output)
+{
+   const short  *Samples;
+   unsigned int  Depth;
+   unsigned int  Span;
+   unsigned int  Read;
+   unsigned int  Produced;
+
+   /* A new stream rate only changes the step of the converter, the     */
+   /* history is kept so the output continues without a gap.            */
+   if(Source->StreamRate != Source->ConverterRate)
+   {
+      Source->ConverterRate = Source->StreamRate;
+
+      AUDIOSRC_SetRates(&Source->Converter, Source->ConverterRate, AUDIO_Context.PipelineRate);
+      AUDIOSRC_InitializeTracker(&Source->Tracker, Source->JitterBuffer.TargetFrames);
+   }
+
+   Depth    = AUDIOJB_Depth(&Source->JitterBuffer);
+   Span     = AUDIOJB_Peek(&Source->JitterBuffer, &Samples);
+   Produced = 0;
+
+   if(Span)
+   {
+      /* The tracker follows the target depth as it adapts.             */
+      Source->Tracker.TargetFrames = Source->JitterBuffer.TargetFrames;
+
+      Source->Correction = AUDIOSRC_UpdateTracker(&Source->Tracker, Depth, Frames);
+
+      AUDIOSRC_SetCorrection(&Source->Converter, Source->Correction);
+
+      /* The jitter buffer is read in up to two contiguous spans.       */
+      while((Produced < Frames) && (Span))
+      {
+         Read      = Span;
+         Produced += AUDIOSRC_Process(&Source->Converter, &Read, Samples, (Frames - Produced), &Output[Produced * AUDIO_CHANNELS]);
+
+         AUDIOJB_Consume(&Source->JitterBuffer, Read);
+
+         Span      = AUDIOJB_Peek(&Source->JitterBuffer, &Samples);
+      }
+   }
+
+   AUDIOJB_Conceal(&Source->JitterBuffer, Produced, Frames, Output);
+}
+
+   /* The following function sends the specified number of frames of the */
+   /* stream to the specified output.  Every source is processed, so    */
+   /* that each keeps its jitter buffer and converter current and can be*/
+   /* heard at once, and the sources that are heard are mixed.  A new   */
+   /* gain of a source starts a fade of the mixer (see AUDIOMIX.h).     */
+static void ProcessStream(unsigned int Frames, short *Output)
+{
+   unsigned int  Index;
+   const short  *Inputs[AUDIO_STREAM_SOURCES];
+
+   for(Index = 0; Index < AUDIO_STREAM_SOURCES; Index++)
+   {
+      if(AUDIO_Context.SourceGain[Index] != AUDIO_Context.Mixer.Target[Index])
+         AUDIOMIX_SetGain(&AUDIO_Context.Mixer, Index, AUDIO_Context.SourceGain[Index]);
+   }
+
+   for(Index = 0; Index < AUDIO_STREAM_SOURCES; Index++)
+   {
+      ProcessSource(&AUDIO_Context.Sources[Index], Frames, SourceBuffer[Index]);
+
+      Inputs[Index] = (AUDIOMIX_IsAudible(&AUDIO_Context.Mixer, Index)) ? SourceBuffer[Index] : NULL;
+   }
+
+   AUDIOMIX_Process(&AUDIO_Context.Mixer, Frames, Inputs, Output);
+}
+
+   /* The following function is the default processing of each period   */
+   /* of the SAI1 pipeline.  It sends a 400 Hz tone (if                 */
+   /* A3DP_SRC_PLAY_SIN is defined), the microphone (for the HFP rates) */
+   /* or the stream (for the A2DP rates).                               */
+static void DefaultProcess(unsigned int Frames, const short *Input, short *Output, unsigned long CallbackParameter)
+{
 #ifdef A3DP_SRC_PLAY_SIN
-                // For Sin()
-                in_sample = (sin_array8k400hz[sin_index] << 3);
-				SPI_I2S_SendData(SPI2, in_sample);
-				sin_index++;
-				if(sin_index >= 120)
-				{
-					sin_index = 0;
-				}
-#else  
-                SPI_I2S_SendData(SPI2, 0x00);
-#endif 
-            }
-#ifdef DEBUG_ADC_SAMPLING_TIME
-			GPIO_ResetBits(AUDIO_DBG_GPIO_PORT, (1 << AUDIO_DBG_PIN));
+
+   static unsigned int SinIndex;
+   short               Sample;
+
+   while(Frames--)
+   {
+      Sample    = (short)(sin_array8k400hz[SinIndex] << 3);
+      *Output++ = Sample;
+      *Output++ = Sample;
+
+      if(++SinIndex >= (sizeof(sin_array8k400hz) / sizeof(sin_array8k400hz[0])))
+         SinIndex = 0;
+   }
+
+#else
+
+   if(AUDIO_Context.hfpAudio)
+      ProcessMicrophone(Frames, Output);
+   else
+      ProcessStream(Frames, Output);
+
 #endif
-		}
+}
+
+   /* The following function is called from the DMA interrupt of SAI1   */
+   /* block B each time the specified period of the buffers has been    */
+   /* transferred.  It wakes up the audio task to process the period.   */
+static void SignalPeriod(unsigned int Period)
+{
+   BaseType_t HigherPriorityTaskWoken = pdFALSE;
+
+   /* If the previous period has not been processed yet the DMA of      */
+   /* block A is already sending it again.                              */
+   if(AUDIO_Context.PeriodsSignaled != AUDIO_Context.PeriodsProcessed)
+      AUDIO_Context.Statistics.Underruns++;
+
+   AUDIO_Context.PeriodsSignaled++;
+   AUDIO_Context.NextPeriod = Period;
+
+   vTaskNotifyGiveFromISR(AudioTaskHandle, &HigherPriorityTaskWoken);
+   portYIELD_FROM_ISR(HigherPriorityTaskWoken);
+}
+
+   /* The following function is the audio task.  It waits for a         */
+   /* notification that a period has been transferred and then passes   */
+   /* the received period to the processing function, which fills the   */
+   /* same period of the transmit buffer.  Block A runs slightly ahead  */
+   /* of block B (by the depth of its FIFO), so when a period has been  */
+   /* received the same period of the transmit buffer has already been  */
+   /* sent and may be refilled until the next period has been received. */
+static void AudioTask(void *Parameter)
+{
+   unsigned long            PeriodsSignaled;
+   unsigned long            TimeStamp;
+   unsigned long            ProcessTime;
+   unsigned int             Offset;
+   AUDIO_Process_Callback_t ProcessCallback;
+   unsigned long            CallbackParameter;
+   Boolean_t                Silence;
+
+   while(1)
+   {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+      taskENTER_CRITICAL();
+
+      PeriodsSignaled   = AUDIO_Context.PeriodsSignaled;
+      Offset            = AUDIO_Context.NextPeriod * AUDIO_Context.PeriodFrames * AUDIO_CHANNELS;
+      ProcessCallback   = AUDIO_Context.ProcessCallback;
+      CallbackParameter = AUDIO_Context.CallbackParameter;
+      Silence           = (Boolean_t)((AUDIO_Context.Standby) && (AUDIO_Context.Silent));
+
+      /* The pipeline is stopped once it has been silent for the        */
+      /* standby time.                                                  */
+      if((Silence) && (AUDIO_Context.Running) && (AUDIO_Context.StandbyPeriods) && (!--AUDIO_Context.StandbyPeriods))
+      {
+         AUDIO_Context.Standby  = FALSE;
+         AUDIO_Context.Stopping = TRUE;
+      }
+
+      taskEXIT_CRITICAL();
+
+      if(AUDIO_Context.Stopping)
+      {
+         StopPipeline();
+
+         AUDIO_Context.Stopping = FALSE;
+      }
+
+      /* Only the latest period is processed, any earlier one has been  */
+      /* counted as an underrun.                                        */
+      if((AUDIO_Context.Running) && (PeriodsSignaled != AUDIO_Context.PeriodsProcessed))
+      {
+         TimeStamp = GetTimeStamp();
+
+         if(!Silence)
+         {
+            (*ProcessCallback)(AUDIO_Context.PeriodFrames, &RxBuffer[Offset], &TxBuffer[Offset], CallbackParameter);
+
+            /* The output ramps whenever its volume changes and fades   */
+            /* out while it is paused or in standby.                    */
+            AUDIOVOL_SetLevel(&AUDIO_Context.Volume, AUDIO_Context.VolumeLevel, AUDIO_Context.PeriodFrames);
+            AUDIOVOL_SetMute(&AUDIO_Context.Volume, ((AUDIO_Context.Standby) || (AUDIO_Context.Muted)), AUDIO_Context.FadeFrames);
+
+            AUDIOVOL_Process(&AUDIO_Context.Volume, AUDIO_Context.PeriodFrames, &TxBuffer[Offset], &TxBuffer[Offset]);
+
+            /* The processing is not used again in standby once the     */
+            /* output has faded out.                                    */
+            if((AUDIO_Context.Standby) && (!AUDIOVOL_IsAudible(&AUDIO_Context.Volume)))
+               AUDIO_Context.Silent = TRUE;
+         }
+         else
+            BTPS_MemInitialize(&TxBuffer[Offset], 0, (AUDIO_Context.PeriodFrames * AUDIO_CHANNELS * sizeof(short)));
+
+         ProcessTime = CyclesToMicroseconds(GetTimeStamp() - TimeStamp);
+
+         taskENTER_CRITICAL();
+
+         AUDIO_Context.PeriodsProcessed = PeriodsSignaled;
+
+         AUDIO_Context.Statistics.Periods++;
+
+         if(ProcessTime > AUDIO_Context.Statistics.MaximumProcessTime)
+            AUDIO_Context.Statistics.MaximumProcessTime = ProcessTime;
+
+         taskEXIT_CRITICAL();
+      }
    }
-   */
 }
 
-/* The following function sets the volume of the codec to the        */
-/* specified value.  This function returns zero if successful or a   */
-/* negative value if there was an error.                             */
-static int SetVolume(unsigned int Volume)
+   /* The following function initializes the processing of the periods  */
+   /* at the specified rate of SAI1: the microphone and its filter, and */
+   /* every source of the stream with an empty jitter buffer.  It must  */
+   /* not be called while the audio task may process the periods.       */
+static void InitializeProcessing(unsigned long Frequency)
+{
+   unsigned int    Index;
+   Audio_Source_t *Source;
+
+   AUDIODC_Initialize(&AUDIO_Context.MicrophoneDC, ADC_MIC_ZERO_SAMPLE, MIC_GAIN_SHIFT, DC_REMOVAL_THRESHOLD);
+
+   /* The microphone is read from where the DMA is at the next period.  */
+   AUDIO_Context.MicrophoneAligned = FALSE;
+
+   /* Without a coefficient set for the rate the samples pass through   */
+   /* unfiltered.                                                       */
+   AUDIOFLT_Initialize(&AUDIO_Context.Filter, AUDIOFLT_FindCoefficientSet(AUDIOFLT_DefaultSets, AUDIOFLT_NumberDefaultSets, Frequency));
+
+   /* Every source starts with an empty jitter buffer and only the      */
+   /* first is heard (it fades in).                                     */
+   if(!AUDIO_Context.hfpAudio)
+   {
+      for(Index = 0; Index < AUDIO_STREAM_SOURCES; Index++)
+      {
+         Source                = &AUDIO_Context.Sources[Index];
+         Source->ConverterRate = Source->StreamRate;
+         Source->Correction    = 0;
+
+         AUDIOJB_Initialize(&Source->JitterBuffer, StreamBuffer[Index], AUDIO_STREAM_FIFO_FRAMES, Source->ConverterRate, AUDIO_STREAM_TARGET_LATENCY);
+         AUDIOSRC_Initialize(&Source->Converter, Source->ConverterRate, Frequency);
+         AUDIOSRC_InitializeTracker(&Source->Tracker, Source->JitterBuffer.TargetFrames);
+         AUDIOSBC_Initialize(&Source->Decoder);
+
+         BTPS_MemInitialize(&Source->StreamBase, 0, sizeof(Source->StreamBase));
+
+         AUDIO_Context.SourceGain[Index] = (Index) ? 0 : AUDIO_UNITY_GAIN;
+      }
+
+      AUDIOMIX_Initialize(&AUDIO_Context.Mixer, AUDIO_STREAM_SOURCES, ((AUDIO_STREAM_FADE_TIME * Frequency) / 1000));
+      AUDIOMIX_SetGain(&AUDIO_Context.Mixer, 0, AUDIO_UNITY_GAIN);
+   }
+}
+
+   /* The following function returns the rate SAI1 runs at for the      */
+   /* specified rate of audio.  The HFP rates are sent as they are.  An */
+   /* A2DP rate is played at its own rate if AUDIO_STREAM_NATIVE_RATE is*/
+   /* set and SAI1 has a clock plan for it, so the converters only      */
+   /* correct the drift, otherwise at AUDIO_STREAM_OUTPUT_RATE.         */
+static unsigned long SelectPipelineRate(unsigned long Frequency)
+{
+   unsigned long ret_val;
+
+   if((AUDIO_Context.hfpAudio) || ((AUDIO_STREAM_NATIVE_RATE) && (AUDIOCLK_FindPlan(AUDIOCLK_DefaultPlans, AUDIOCLK_NumberDefaultPlans, Frequency))))
+      ret_val = Frequency;
+   else
+      ret_val = AUDIO_STREAM_OUTPUT_RATE;
+
+   return(ret_val);
+}
+
+   /* The following function clocks SAI1 from PLLSAI2 with the clock    */
+   /* plan of the specified sample rate (see AUDIOCLK.h) and sets the   */
+   /* master clock divider of block A, which the HAL would otherwise    */
+   /* round from the kernel clock.  PLLSAI2 is only relocked if the plan*/
+   /* needs another VCO or P divider, so switching between rates that   */
+   /* share them only changes the divider.  SAI1 MUST be stopped.  This */
+   /* function returns zero if successful or a negative value if there  */
+   /* was an error.                                                     */
+static int SetClock(unsigned long Frequency)
+{
+   int                       ret_val;
+   const AUDIOCLK_Plan_t    *Plan;
+   const AUDIOCLK_Plan_t    *Current;
+   RCC_PeriphCLKInitTypeDef  PeriphClkInit;
+
+   if((Plan = AUDIOCLK_FindPlan(AUDIOCLK_DefaultPlans, AUDIOCLK_NumberDefaultPlans, Frequency)) != NULL)
+   {
+      Current = AUDIO_Context.ClockPlan;
+      ret_val = 0;
+
+      if((!Current) || (Plan->PLLM != Current->PLLM) || (Plan->PLLN != Current->PLLN) || (Plan->PLLP != Current->PLLP))
+      {
+         /* The plan is forgotten until PLLSAI2 has locked to it.       */
+         AUDIO_Context.ClockPlan = NULL;
+
+         BTPS_MemInitialize(&PeriphClkInit, 0, sizeof(PeriphClkInit));
+
+         PeriphClkInit.PeriphClockSelection    = RCC_PERIPHCLK_SAI1;
+         PeriphClkInit.Sai1ClockSelection      = RCC_SAI1CLKSOURCE_PLLSAI2;
+         PeriphClkInit.PLLSAI2.PLLSAI2Source   = RCC_PLLSOURCE_MSI;
+         PeriphClkInit.PLLSAI2.PLLSAI2M        = Plan->PLLM;
+         PeriphClkInit.PLLSAI2.PLLSAI2N        = Plan->PLLN;
+         PeriphClkInit.PLLSAI2.PLLSAI2P        = Plan->PLLP;
+         PeriphClkInit.PLLSAI2.PLLSAI2Q        = RCC_PLLQ_DIV2;
+         PeriphClkInit.PLLSAI2.PLLSAI2R        = RCC_PLLR_DIV2;
+         PeriphClkInit.PLLSAI2.PLLSAI2ClockOut = RCC_PLLSAI2_SAI2CLK;
+
+         if(HAL_RCCEx_PeriphCLKConfig(&PeriphClkInit) != HAL_OK)
+            ret_val = AUDIO_ERROR_SAI_OPERATION_FAILED;
+      }
+
+      if(!ret_val)
+      {
+         AUDIO_Context.ClockPlan             = Plan;
+         AUDIO_Context.Statistics.ClockError = Plan->Error;
+
+         hsai_BlockA1.Init.AudioFrequency    = SAI_AUDIO_FREQUENCY_MCKDIV;
+         hsai_BlockA1.Init.Mckdiv            = Plan->MCKDIV;
+      }
+   }
+   else
+      ret_val = AUDIO_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* The following function starts the capture of the microphone at the*/
+   /* specified sample rate.  TIM6 triggers ADC1 at that rate, each     */
+   /* trigger makes an oversampled conversion (see adc.c) and the DMA of*/
+   /* ADC1 fills the capture buffer continuously.  The capture buffer   */
+   /* starts at the DC level, so the microphone is silent until the DMA */
+   /* reaches the read position.  The audio task reads the samples by   */
+   /* the position of the DMA, so its half and full transfer interrupts */
+   /* are disabled.  This function returns zero if successful or a      */
+   /* negative value if there was an error.                             */
+static int StartMicrophone(unsigned long Frequency)
 {
    int           ret_val;
-   /*
-   unsigned char RegisterValue;
-
-   // Determine the value that will be written to the CODEC's registers
-   // for the specified volume. Register=165 + Volumex6 for 3dB increments.
-   // The value is between 155 to (155+15x6)= 245 = Gain of -5dB to -50dB
-   RegisterValue = (Volume * 6) + 155;
-   // Write the value to the DAC registers.
-   Display(("\r\n Volume changed to %d, register value = 0x%x \r\n", Volume, RegisterValue));
-   ret_val = setVolumeDAC(RegisterValue);
-   // Update the context information if there wasn't an error.
+   unsigned int  Index;
+   unsigned long TimerClock;
+
+   AUDIO_Context.MicrophoneLength  = AUDIO_MICROPHONE_PERIODS * AUDIO_Context.PeriodFrames;
+   AUDIO_Context.MicrophoneAligned = FALSE;
+
+   for(Index = 0; Index < AUDIO_Context.MicrophoneLength; Index++)
+      CaptureBuffer[Index] = ADC_MIC_ZERO_SAMPLE;
+
+   /* The timers of APB1 run at twice its clock when it is divided.     */
+   TimerClock = HAL_RCC_GetPCLK1Freq();
+   if((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_HCLK_DIV1)
+      TimerClock *= 2;
+
+   __HAL_TIM_SET_AUTORELOAD(&htim6, (((TimerClock + (Frequency / 2)) / Frequency) - 1));
+   __HAL_TIM_SET_COUNTER(&htim6, 0);
+
+   /* ADC1 is calibrated each time it is started, while it is disabled. */
+   if((HAL_ADCEx_Calibration_Start(&hadc1, ADC_SINGLE_ENDED) == HAL_OK) && (HAL_ADC_Start_DMA(&hadc1, (uint32_t *)CaptureBuffer, AUDIO_Context.MicrophoneLength) == HAL_OK))
+   {
+      __HAL_DMA_DISABLE_IT(hadc1.DMA_Handle, (DMA_IT_HT | DMA_IT_TC));
+
+      AUDIO_Context.MicrophoneRunning = TRUE;
+
+      if(HAL_TIM_Base_Start(&htim6) == HAL_OK)
+         ret_val = 0;
+      else
+         ret_val = AUDIO_ERROR_ADC_OPERATION_FAILED;
+   }
+   else
+      ret_val = AUDIO_ERROR_ADC_OPERATION_FAILED;
+
+   return(ret_val);
+}
+
+   /* The following function stops the capture of the microphone.       */
+static void StopMicrophone(void)
+{
+   if(AUDIO_Context.MicrophoneRunning)
+   {
+      AUDIO_Context.MicrophoneRunning = FALSE;
+
+      HAL_TIM_Base_Stop(&htim6);
+      HAL_ADC_Stop_DMA(&hadc1);
+   }
+}
+
+   /* The following function starts the SAI1 pipeline at the specified  */
+   /* sample rate (each source of the stream is converted from its      */
+   /* StreamRate at the A2DP rates).  Both blocks transfer their buffers*/
+   /* with circular DMA; only the half and full transfer events of block*/
+   /* B are enabled, so there are two interrupts per buffer.  At the HFP*/
+   /* rates the capture of the microphone is started first.  This       */
+   /* function returns zero if successful or a negative value if there  */
+   /* was an error.                                                     */
+static int StartPipeline(unsigned long Frequency)
+{
+   int          ret_val;
+   unsigned int Samples;
+
+   if(!AUDIO_Context.PeriodFrames)
+      AUDIO_Context.PeriodFrames = AUDIO_DEFAULT_PERIOD_FRAMES;
+
+   if(!AUDIO_Context.ProcessCallback)
+      AUDIO_Context.ProcessCallback = DefaultProcess;
+
+   /* Create the audio task the first time the pipeline is started.     */
+   if(!AudioTaskHandle)
+      AudioTaskHandle = xTaskCreateStatic(AudioTask, "Audio", AUDIO_TASK_STACK_SIZE, NULL, AUDIO_TASK_PRIORITY, AudioTaskStack, &AudioTaskBuffer);
+
+   /* Start the cycle counter that is used to time the processing.      */
+   CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+   DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
+   Samples = AUDIO_PERIODS * AUDIO_Context.PeriodFrames * AUDIO_CHANNELS;
+
+   BTPS_MemInitialize(TxBuffer, 0, sizeof(TxBuffer));
+
+   InitializeProcessing(Frequency);
+
+   /* The output fades in from silence.                                 */
+   AUDIOVOL_Initialize(&AUDIO_Context.Volume, AUDIO_VOLUME_RAMP, AUDIO_Context.VolumeLevel, TRUE);
+
+   AUDIO_Context.FadeFrames                  = (AUDIO_OUTPUT_FADE_TIME * Frequency) / 1000;
+   AUDIO_Context.Standby                     = FALSE;
+   AUDIO_Context.Silent                      = FALSE;
+   AUDIO_Context.PipelineRate                = Frequency;
+   AUDIO_Context.PeriodsSignaled             = 0;
+   AUDIO_Context.PeriodsProcessed            = 0;
+   AUDIO_Context.Statistics.SampleRate       = Frequency;
+   AUDIO_Context.Statistics.PeriodFrames     = AUDIO_Context.PeriodFrames;
+   AUDIO_Context.Statistics.PeriodTime       = (AUDIO_Context.PeriodFrames * 1000000UL) / Frequency;
+   AUDIO_Context.Running                     = TRUE;
+
+   /* The SAI1 clocks must keep running while the pipeline runs.        */
+   LOWPOWER_PreventStop(LOWPOWER_LOCK_AUDIO);
+
+   ret_val = (AUDIO_Context.hfpAudio) ? StartMicrophone(Frequency) : 0;
+
    if(!ret_val)
    {
-      AUDIO_Context.CurrentVolume = Volume;
+      /* Block B is synchronous to block A, so it is started first and  */
+      /* receives from the first frame that block A sends.              */
+      if((!SetClock(Frequency)) && (HAL_SAI_InitProtocol(&hsai_BlockA1, SAI_I2S_STANDARD, SAI_PROTOCOL_DATASIZE_16BIT, 2) == HAL_OK) && (HAL_SAI_Receive_DMA(&hsai_BlockB1, (uint8_t *)RxBuffer, (uint16_t)Samples) == HAL_OK))
+      {
+         if(HAL_SAI_Transmit_DMA(&hsai_BlockA1, (uint8_t *)TxBuffer, (uint16_t)Samples) == HAL_OK)
+         {
+            __HAL_DMA_DISABLE_IT(hsai_BlockA1.hdmatx, (DMA_IT_HT | DMA_IT_TC));
+
+            ret_val = 0;
+         }
+         else
+            ret_val = AUDIO_ERROR_SAI_OPERATION_FAILED;
+      }
+      else
+         ret_val = AUDIO_ERROR_SAI_OPERATION_FAILED;
    }
-   */
+
+   if(ret_val)
+      StopPipeline();
+
+   return(ret_val);
+}
+
+   /* The following function stops the SAI1 pipeline and the capture of */
+   /* the microphone.                                                   */
+static void StopPipeline(void)
+{
+   AUDIO_Context.Running = FALSE;
+
+   HAL_SAI_DMAStop(&hsai_BlockA1);
+   HAL_SAI_DMAStop(&hsai_BlockB1);
+
+   StopMicrophone();
+
+   LOWPOWER_AllowStop(LOWPOWER_LOCK_AUDIO);
+}
+
+   /* The following function stops the SAI1 pipeline if it is in standby */
+   /* (or waits until the audio task has stopped it).                   */
+static void StopStandby(void)
+{
+   Boolean_t Stop;
+
+   while(AUDIO_Context.Stopping)
+      vTaskDelay(1);
+
+   taskENTER_CRITICAL();
+
+   Stop                  = AUDIO_Context.Standby;
+   AUDIO_Context.Standby = FALSE;
+
+   taskEXIT_CRITICAL();
+
+   if(Stop)
+      StopPipeline();
+}
+
+   /* The following function resumes the SAI1 pipeline from standby if   */
+   /* it still runs at the specified rate.  The output has faded out    */
+   /* first, so the processing is not used by the audio task while it is*/
+   /* initialized again, and then fades in.  This function returns TRUE */
+   /* if the pipeline was resumed or FALSE if it has to be started.     */
+static Boolean_t ResumeStandby(unsigned long Frequency)
+{
+   Boolean_t ret_val;
+
+   ret_val = FALSE;
+
+   if((AUDIO_Context.Standby) && (AUDIO_Context.Running) && (AUDIO_Context.PipelineRate == Frequency))
+   {
+      /* The fade out takes at most AUDIO_OUTPUT_FADE_TIME.             */
+      while((AUDIO_Context.Standby) && (AUDIO_Context.Running) && (!AUDIO_Context.Silent))
+         vTaskDelay(1);
+
+      /* The pipeline may not be stopped once it is claimed.            */
+      taskENTER_CRITICAL();
+
+      if((AUDIO_Context.Standby) && (AUDIO_Context.Running) && (AUDIO_Context.Silent))
+      {
+         AUDIO_Context.StandbyPeriods = 0;
+
+         ret_val                      = TRUE;
+      }
+
+      taskEXIT_CRITICAL();
+
+      if(ret_val)
+      {
+         InitializeProcessing(Frequency);
+
+         taskENTER_CRITICAL();
+
+         AUDIO_Context.Silent  = FALSE;
+         AUDIO_Context.Standby = FALSE;
+
+         taskEXIT_CRITICAL();
+      }
+   }
+
+   /* A pipeline that cannot be resumed is stopped before it is started */
+   /* again.                                                            */
+   if(!ret_val)
+      StopStandby();
+
+   return(ret_val);
+}
+
+   /* The following function is called by the HAL when the first half   */
+   /* of the receive buffer of a SAI block has been filled.             */
+void HAL_SAI_RxHalfCpltCallback(SAI_HandleTypeDef *hsai)
+{
+   if(hsai == &hsai_BlockB1)
+      SignalPeriod(0);
+}
+
+   /* The following function is called by the HAL when the second half  */
+   /* of the receive buffer of a SAI block has been filled.             */
+void HAL_SAI_RxCpltCallback(SAI_HandleTypeDef *hsai)
+{
+   if(hsai == &hsai_BlockB1)
+      SignalPeriod(1);
+}
+
+   /* The following function is called by the HAL when a SAI block      */
+   /* reports an error.  FIFO underruns and overruns do not stop the    */
+   /* transfer and are only counted.  Any other error has stopped the   */
+   /* DMA, so processing stops until the pipeline is restarted.         */
+void HAL_SAI_ErrorCallback(SAI_HandleTypeDef *hsai)
+{
+   uint32_t ErrorCode;
+
+   if((hsai == &hsai_BlockA1) || (hsai == &hsai_BlockB1))
+   {
+      /* The HAL accumulates the error codes, so they are cleared once  */
+      /* they have been counted.                                        */
+      ErrorCode       = HAL_SAI_GetError(hsai);
+      hsai->ErrorCode = HAL_SAI_ERROR_NONE;
+
+      if(ErrorCode & HAL_SAI_ERROR_UDR)
+         AUDIO_Context.Statistics.FIFOUnderruns++;
+
+      if(ErrorCode & HAL_SAI_ERROR_OVR)
+         AUDIO_Context.Statistics.FIFOOverruns++;
+
+      if(ErrorCode & ~(HAL_SAI_ERROR_UDR | HAL_SAI_ERROR_OVR))
+      {
+         AUDIO_Context.Statistics.TransferErrors++;
+
+         AUDIO_Context.Running = FALSE;
+      }
+   }
+}
+
+   /* The following function returns the level (see AUDIOVOL.h) of the  */
+   /* specified AVRCP absolute volume.  The absolute volumes 1 to       */
+   /* AUDIO_MAXIMUM_ABSOLUTE_VOLUME span AUDIO_VOLUME_RANGE decibels in */
+   /* equal steps, zero is muted.                                       */
+static unsigned int AbsoluteVolumeLevel(unsigned int Volume)
+{
+   unsigned int ret_val;
+
+   if(Volume)
+      ret_val = ((((AUDIO_MAXIMUM_ABSOLUTE_VOLUME - Volume) * AUDIO_VOLUME_RANGE * AUDIOVOL_LEVELS_PER_DECIBEL) + ((AUDIO_MAXIMUM_ABSOLUTE_VOLUME - 1) / 2)) / (AUDIO_MAXIMUM_ABSOLUTE_VOLUME - 1));
+   else
+      ret_val = AUDIOVOL_MUTE_LEVEL;
+
    return(ret_val);
 }
 
@@ -349,6 +964,7 @@ static int SetVolume(unsigned int Volume)
 int initializeAudio(unsigned int BluetoothStackID, unsigned long Frequency)
 {
 	int              ret_val = 0;
+	unsigned int     Index;
 	/*
 	int              timeout_counter = 0;
 	I2S_InitTypeDef  I2SConfig;
@@ -504,13 +1120,80 @@ int initializeAudio(unsigned int BluetoothStackID, unsigned long Frequency)
         NVIC_EnableIRQ(AUDIO_I2S_IRQ);
     // }
     */
-    Display(("\r\n I2S configuration finished \r\n"));
+    if(TRUE == AUDIO_Context.Initialized)
+    {
+        /* SAI1 keeps its rate for a new A2DP rate, only the converters */
+        /* of the sources that are at another rate change (in the audio */
+        /* task).                                                       */
+        if((!AUDIO_Context.hfpAudio) && ((Frequency == 44100) || (Frequency == 48000)))
+        {
+            for(Index = 0; Index < AUDIO_STREAM_SOURCES; Index++)
+            {
+                if(AUDIO_Context.Sources[Index].StreamRate != Frequency)
+                {
+                    AUDIOJB_SetSampleRate(&AUDIO_Context.Sources[Index].JitterBuffer, Frequency);
+
+                    AUDIO_Context.Sources[Index].StreamRate = Frequency;
+
+                    Display(("\r\n Audio stream rate changed, f = %lu \r\n", Frequency));
+                }
+            }
+        }
+        else
+            Display(("\r\n Audio already initialized... \r\n"));
+
+        return 0;
+    }
+
+    if((Frequency == 8000) || (Frequency == 16000) || (Frequency == 44100) || (Frequency == 48000))
+    {
+        /* The microphone is only sampled for the HFP rates, the A2DP   */
+        /* rates are converted to the rate of SAI1.                     */
+        AUDIO_Context.hfpAudio = (Boolean_t)(Frequency < 32000);
+
+        for(Index = 0; Index < AUDIO_STREAM_SOURCES; Index++)
+            AUDIO_Context.Sources[Index].StreamRate = Frequency;
+
+        /* A pipeline in standby at the same rate of SAI1 is resumed,   */
+        /* so the clocks only change when the rate of SAI1 changes.     */
+        if(ResumeStandby(SelectPipelineRate(Frequency)))
+        {
+            AUDIO_Context.Initialized   = TRUE;
+            AUDIO_Context.PlaybackState = psPlaying;
+            AUDIO_Context.Muted         = FALSE;
+
+            Display(("\r\n SAI1 pipeline resumed, f = %lu \r\n", Frequency));
+        }
+        else
+        {
+            ret_val = StartPipeline(SelectPipelineRate(Frequency));
+            if(!ret_val)
+            {
+                AUDIO_Context.Initialized   = TRUE;
+                AUDIO_Context.PlaybackState = psPlaying;
+                AUDIO_Context.Muted         = FALSE;
+
+                Display(("\r\n SAI1 pipeline started, f = %lu, period = %u frames \r\n", Frequency, AUDIO_Context.PeriodFrames));
+            }
+            else
+                Display(("\r\n Failed to start the SAI1 pipeline !!! \r\n"));
+        }
+    }
+    else
+    {
+        Display(("\r\n Unsupported I2S Frequency !!! \r\n"));
+        ret_val = AUDIO_ERROR_INVALID_PARAMETER;
+    }
+
     return ret_val;
 }
 
    /* The following function un-initilizes the codec and disables       */
-   /* playback and recording.  This function will return zero if        */
-   /* successful or a negative value if there was an error.             */
+   /* playback and recording.  The output fades out and the pipeline    */
+   /* stays in standby for AUDIO_STANDBY_TIME, so that initializeAudio()*/
+   /* can resume it without changing a clock.  This function will return*/
+   /* zero if successful or a negative value if there was an error.     */
+
 int uninitializeAUDIO(void)
 {
 	/*
@@ -547,6 +1230,27 @@ int uninitializeAUDIO(void)
 	   return(0);
    }
    */
+   if(TRUE == AUDIO_Context.Initialized)
+   {
+      AUDIO_Context.Initialized = FALSE;
+
+      /* The pipeline keeps running for AUDIO_STANDBY_TIME while the    */
+      /* output fades out, so that it can be resumed at once.           */
+      if((AUDIO_STANDBY_TIME) && (AUDIO_Context.Running))
+      {
+         taskENTER_CRITICAL();
+
+         AUDIO_Context.StandbyPeriods = (((AUDIO_STANDBY_TIME * AUDIO_Context.PipelineRate) / 1000) / AUDIO_Context.PeriodFrames) + 1;
+         AUDIO_Context.Silent         = FALSE;
+         AUDIO_Context.Standby        = TRUE;
+
+         taskEXIT_CRITICAL();
+      }
+      else
+         StopPipeline();
+   }
+
+   return(0);
 }
  
    /* The following function will set the volume of the audio output.   */
@@ -557,8 +1261,8 @@ int AUDIO_Set_Volume(unsigned int NewVolume)
 {
    int ret_val;
 
-   if(NewVolume <= 16)
-      ret_val = SetVolume(NewVolume);
+   if(NewVolume <= 100)
+      ret_val = AUDIO_Set_Absolute_Volume(((NewVolume * AUDIO_MAXIMUM_ABSOLUTE_VOLUME) + 50) / 100);
    else
       ret_val = AUDIO_ERROR_INVALID_PARAMETER;
 
@@ -571,7 +1275,40 @@ int AUDIO_Set_Volume(unsigned int NewVolume)
    /* there was an error.                                               */
 int AUDIO_Get_Volume(void)
 {
-   return(AUDIO_Context.CurrentVolume);
+   return(((AUDIO_Get_Absolute_Volume() * 100) + (AUDIO_MAXIMUM_ABSOLUTE_VOLUME / 2)) / AUDIO_MAXIMUM_ABSOLUTE_VOLUME);
+}
+
+   /* The following function sets the volume of the audio output to the */
+   /* specified AVRCP absolute volume, from zero (muted) to             */
+   /* AUDIO_MAXIMUM_ABSOLUTE_VOLUME (full volume), so that the absolute */
+   /* volume of a remote device can be passed on as it is.  The output  */
+   /* is scaled digitally and ramps to the new volume over one period,  */
+   /* without a codec register being written.  This function returns    */
+   /* zero if successful or a negative value if there was an error.     */
+int AUDIO_Set_Absolute_Volume(unsigned int Volume)
+{
+   int ret_val;
+
+   if(Volume <= AUDIO_MAXIMUM_ABSOLUTE_VOLUME)
+   {
+      /* The audio task passes the new level to the volume stage.       */
+      AUDIO_Context.VolumeAttenuation = AUDIO_MAXIMUM_ABSOLUTE_VOLUME - Volume;
+      AUDIO_Context.VolumeLevel       = AbsoluteVolumeLevel(Volume);
+
+      ret_val                         = 0;
+   }
+   else
+      ret_val = AUDIO_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* The following function returns the current AVRCP absolute volume  */
+   /* of the audio output, from zero (muted) to                         */
+   /* AUDIO_MAXIMUM_ABSOLUTE_VOLUME.                                    */
+int AUDIO_Get_Absolute_Volume(void)
+{
+   return((int)(AUDIO_MAXIMUM_ABSOLUTE_VOLUME - AUDIO_Context.VolumeAttenuation));
 }
 
    /* The following function configures the DAC, CS43L22, and hold it   */
@@ -591,36 +1328,369 @@ void AUDIO_Reset_CODEC(void)
    */
 }
 
-   /* The following function Mutes/Un-Mutes the HW CODEC and puts       */
-   /* the CODEC in Power Save mode. This function will return zero if   */
-   /* successful or a negative value if there was an error.             */
+   /* The following function pauses the audio output if it is playing or*/
+   /* resumes it if it is paused.  The output is muted softly: it fades */
+   /* out (or in) over AUDIO_OUTPUT_FADE_TIME milliseconds while the    */
+   /* pipeline keeps running, and the volume is kept.  This function    */
+   /* will return zero if successful or a negative value if there was an*/
+   /* error.                                                            */
 int pauseResumeAudio(void)
 {
-    int ret_val = 0;
-    if(psPaused == AUDIO_Context.PlaybackState)
-    {
-        Display(("Unmute and exit CODEC power save mode\r\n"));
-        /* Just Un-mute the CODEC Headphones output */
-		ret_val = powerSaveDAC(FALSE);
-		ret_val = muteDAC(FALSE);
-        AUDIO_Context.PlaybackState = psPlaying;
-    }
-    else if(psPlaying == AUDIO_Context.PlaybackState)
-    {
-       Display(("Mute and enter CODEC power save mode\r\n"));
-       /* Just mute the CODEC  */
-	   ret_val = muteDAC(TRUE);
-       AUDIO_Context.PlaybackState = psPaused;
-	   /* Power save mode */
-	   ret_val = powerSaveDAC(TRUE);
-    }
-    else
-    {
-       Display(("\r\nError!!! pauseResumeA3dpAudio(), AUDIO in unknown state, PlaybackStat=%d \r\n", 
-	   			AUDIO_Context.PlaybackState));
-    }
-    
-    return ret_val;
+   int ret_val;
+
+   ret_val = 0;
+
+   /* The audio task passes the mute to the volume stage.               */
+   if(psPaused == AUDIO_Context.PlaybackState)
+   {
+      AUDIO_Context.Muted         = FALSE;
+      AUDIO_Context.PlaybackState = psPlaying;
+   }
+   else
+   {
+      if(psPlaying == AUDIO_Context.PlaybackState)
+      {
+         AUDIO_Context.Muted         = TRUE;
+         AUDIO_Context.PlaybackState = psPaused;
+      }
+      else
+      {
+         Display(("\r\nError!!! pauseResumeAudio(), AUDIO in unknown state, PlaybackState=%d \r\n", AUDIO_Context.PlaybackState));
+
+         ret_val = AUDIO_ERROR_INVALID_PARAMETER;
+      }
+   }
+
+   return(ret_val);
 }
-   
 
+   /* The following function sets the number of stereo frames in each   */
+   /* period of the SAI1 pipeline (at most AUDIO_MAXIMUM_PERIOD_FRAMES).*/
+   /* The period can only be changed while audio is not initialized.    */
+   /* This function will return zero if successful or a negative value  */
+   /* if there was an error.                                            */
+int AUDIO_Set_Period(unsigned int PeriodFrames)
+{
+   int ret_val;
+
+   if(!AUDIO_Context.Initialized)
+   {
+      if((PeriodFrames) && (PeriodFrames <= AUDIO_MAXIMUM_PERIOD_FRAMES))
+      {
+         /* A pipeline in standby uses the current period.              */
+         if(PeriodFrames != AUDIO_Context.PeriodFrames)
+            StopStandby();
+
+         AUDIO_Context.PeriodFrames = PeriodFrames;
+
+         ret_val = 0;
+      }
+      else
+         ret_val = AUDIO_ERROR_INVALID_PARAMETER;
+   }
+   else
+      ret_val = AUDIO_ERROR_PIPELINE_RUNNING;
+
+   return(ret_val);
+}
+
+   /* The following function clocks SAI1 for the specified sample rate  */
+   /* with its clock plan (see AUDIOCLK.h), so that the pipeline starts */
+   /* at that rate without waiting for PLLSAI2 to lock.  The rate can   */
+   /* only be changed while audio is not initialized (a pipeline in     */
+   /* standby at another rate is stopped).  This function will return   */
+   /* zero if successful or a negative value if there was an error.     */
+int AUDIO_Set_Rate(unsigned long Frequency)
+{
+   int ret_val;
+
+   if(!AUDIO_Context.Initialized)
+   {
+      if(AUDIOCLK_FindPlan(AUDIOCLK_DefaultPlans, AUDIOCLK_NumberDefaultPlans, Frequency))
+      {
+         /* A pipeline in standby at the rate is already clocked for it.*/
+         if(AUDIO_Context.PipelineRate != Frequency)
+            StopStandby();
+
+         if(!AUDIO_Context.Running)
+            ret_val = SetClock(Frequency);
+         else
+            ret_val = 0;
+      }
+      else
+         ret_val = AUDIO_ERROR_INVALID_PARAMETER;
+   }
+   else
+      ret_val = AUDIO_ERROR_PIPELINE_RUNNING;
+
+   return(ret_val);
+}
+
+   /* The following function registers the function that processes      */
+   /* each period of the SAI1 pipeline (NULL restores the default       */
+   /* processing).  This function may be called while the pipeline      */
+   /* runs, the new function is used from the next period.  This        */
+   /* function will return zero if successful or a negative value if    */
+   /* there was an error.                                               */
+int AUDIO_Register_Process_Callback(AUDIO_Process_Callback_t ProcessCallback, unsigned long CallbackParameter)
+{
+   taskENTER_CRITICAL();
+
+   AUDIO_Context.ProcessCallback   = (ProcessCallback) ? ProcessCallback : DefaultProcess;
+   AUDIO_Context.CallbackParameter = CallbackParameter;
+
+   taskEXIT_CRITICAL();
+
+   return(0);
+}
+
+   /* The following function writes the specified number of interleaved */
+   /* stereo frames of the specified source of the stream (at the sample*/
+   /* rate audio was initialized with) to the jitter buffer of the      */
+   /* source that is played by the default processing at the A2DP       */
+   /* rates.  The frames are stamped with the current time to measure   */
+   /* the arrival jitter, so they should be written as soon as they     */
+   /* arrive.  Frames that do not fit in the jitter buffer are          */
+   /* dropped.  This function may be called from one task at a time (the*/
+   /* one that calls initializeAudio()).  This function returns the     */
+   /* number of frames that were written if successful or a negative    */
+   /* value if there was an error.                                      */
+int AUDIO_Write_Stream(unsigned int Source, unsigned int Frames, const short *Samples)
+{
+   int ret_val;
+
+   if((AUDIO_Context.Initialized) && (!AUDIO_Context.hfpAudio) && (Source < AUDIO_STREAM_SOURCES) && (Samples))
+      ret_val = (int)AUDIOJB_Write(&AUDIO_Context.Sources[Source].JitterBuffer, BTPS_GetTickCount(), Frames, Samples);
+   else
+      ret_val = AUDIO_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* The following function decodes the specified A2DP media payload   */
+   /* (the SBC frames of a packet, with or without the media payload    */
+   /* header) of the specified source and writes the decoded frames to  */
+   /* the jitter buffer of the source like AUDIO_Write_Stream().  The   */
+   /* rate of the source follows the rate of the frames, so each source */
+   /* may have its own rate.  A fragmented frame, a frame whose CRC does*/
+   /* not match and a frame at a rate the converter does not support are*/
+   /* dropped.  This function may be called from one task at a time (the*/
+   /* one that calls initializeAudio()).  This function returns the     */
+   /* number of frames that were written if successful or a negative    */
+   /* value if there was an error.                                      */
+int AUDIO_Write_SBC(unsigned int Source, unsigned int Length, const unsigned char *Data)
+{
+   int             ret_val;
+   int             Result;
+   unsigned int    Frames;
+   unsigned long   Time;
+   unsigned long   Written;
+   unsigned long   TimeStamp;
+   unsigned long   Cycles;
+   unsigned long   SampleRate;
+   Audio_Source_t *Stream;
+
+   if((AUDIO_Context.Initialized) && (!AUDIO_Context.hfpAudio) && (Source < AUDIO_STREAM_SOURCES) && (Data))
+   {
+      Stream  = &AUDIO_Context.Sources[Source];
+      ret_val = 0;
+      Written = 0;
+      Time    = BTPS_GetTickCount();
+
+      /* The media payload header is skipped if it is present (it       */
+      /* never starts with the sync word of a frame).                   */
+      if((Length) && (Data[0] != AUDIOSBC_SYNCWORD))
+      {
+         if(Data[0] & SBC_PAYLOAD_FRAGMENTED)
+         {
+            AUDIO_Context.Statistics.DecodeErrors++;
+
+            Length = 0;
+         }
+         else
+         {
+            Data++;
+            Length--;
+         }
+      }
+
+      while(Length)
+      {
+         TimeStamp = GetTimeStamp();
+         Result    = AUDIOSBC_Decode(&Stream->Decoder, Data, Length, &Frames, DecodeBuffer);
+         Cycles    = GetTimeStamp() - TimeStamp;
+
+         if(Result > 0)
+         {
+            /* A new rate only changes the converter of the source (in  */
+            /* the audio task), the frames that are buffered are played */
+            /* at it.                                                   */
+            SampleRate = Stream->Decoder.Format.SampleRate;
+
+            if((Frames) && (SampleRate != Stream->StreamRate))
+            {
+               if((SampleRate <= (AUDIO_Context.PipelineRate * 2)) && (AUDIO_Context.PipelineRate <= (SampleRate * 2)))
+               {
+                  AUDIOJB_SetSampleRate(&Stream->JitterBuffer, SampleRate);
+
+                  Stream->StreamRate = SampleRate;
+               }
+               else
+                  Frames = 0;
+            }
+
+            if(Frames)
+            {
+               AUDIO_Context.Statistics.DecodedFrames++;
+               AUDIO_Context.DecodeCycles += Cycles;
+
+               if(Cycles > AUDIO_Context.Statistics.MaximumDecodeCycles)
+                  AUDIO_Context.Statistics.MaximumDecodeCycles = Cycles;
+
+               /* The frames of a packet are stamped as if they had     */
+               /* arrived one after the other, so that the packet does  */
+               /* not add its own length to the measured jitter.        */
+               ret_val += (int)AUDIOJB_Write(&Stream->JitterBuffer, Time + ((Written * 1000UL) / SampleRate), Frames, DecodeBuffer);
+               Written += Frames;
+            }
+            else
+               AUDIO_Context.Statistics.DecodeErrors++;
+
+            Data   += Result;
+            Length -= (unsigned int)Result;
+         }
+         else
+         {
+            /* The rest of the packet cannot be found without a valid   */
+            /* frame.                                                   */
+            AUDIO_Context.Statistics.DecodeErrors++;
+
+            Length = 0;
+         }
+      }
+   }
+   else
+      ret_val = AUDIO_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* The following function sets the gain (Q14, AUDIO_UNITY_GAIN plays */
+   /* the source unchanged) with which the specified source of the      */
+   /* stream is mixed.  The gain fades to its new value over            */
+   /* AUDIO_STREAM_FADE_TIME milliseconds.  A source that is not heard  */
+   /* is still buffered, so it can be heard at once.  This function     */
+   /* returns zero if successful or a negative value if there was an    */
+   /* error.                                                            */
+int AUDIO_Set_Source_Gain(unsigned int Source, unsigned int Gain)
+{
+   int ret_val;
+
+   if(Source < AUDIO_STREAM_SOURCES)
+   {
+      AUDIO_Context.SourceGain[Source] = (Gain > AUDIOMIX_MAXIMUM_GAIN) ? AUDIOMIX_MAXIMUM_GAIN : Gain;
+
+      ret_val                          = 0;
+   }
+   else
+      ret_val = AUDIO_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* The following function selects the source of the stream that is   */
+   /* heard: the stream cross-fades from the sources that are heard to  */
+   /* the specified source at unity gain.  This function returns zero if*/
+   /* successful or a negative value if there was an error.             */
+int AUDIO_Select_Source(unsigned int Source)
+{
+   int          ret_val;
+   unsigned int Index;
+
+   if(Source < AUDIO_STREAM_SOURCES)
+   {
+      taskENTER_CRITICAL();
+
+      for(Index = 0; Index < AUDIO_STREAM_SOURCES; Index++)
+         AUDIO_Context.SourceGain[Index] = (Index == Source) ? AUDIO_UNITY_GAIN : 0;
+
+      taskEXIT_CRITICAL();
+
+      ret_val = 0;
+   }
+   else
+      ret_val = AUDIO_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* The following function returns the statistics of the SAI1         */
+   /* pipeline in the specified structure and, if the second parameter  */
+   /* is non-zero, resets them.                                         */
+void AUDIO_Query_Statistics(AUDIO_Statistics_t *Statistics, int Reset)
+{
+   unsigned int          Index;
+   Audio_Source_t       *Source;
+   AUDIOJB_Statistics_t  StreamStatistics;
+
+   if(Statistics)
+   {
+      taskENTER_CRITICAL();
+
+      *Statistics = AUDIO_Context.Statistics;
+
+      if(Statistics->DecodedFrames)
+         Statistics->DecodeCycles = (unsigned long)(AUDIO_Context.DecodeCycles / Statistics->DecodedFrames);
+
+      /* The stream counters are kept by the jitter buffer of each      */
+      /* source and reported from the last reset for the source that is */
+      /* heard the most.                                                */
+      if(!AUDIO_Context.hfpAudio)
+      {
+         for(Index = 1, Statistics->StreamSource = 0; Index < AUDIO_STREAM_SOURCES; Index++)
+         {
+            if(AUDIO_Context.SourceGain[Index] > AUDIO_Context.SourceGain[Statistics->StreamSource])
+               Statistics->StreamSource = Index;
+         }
+
+         Source = &AUDIO_Context.Sources[Statistics->StreamSource];
+
+         AUDIOJB_Query_Statistics(&Source->JitterBuffer, &StreamStatistics);
+
+         Statistics->StreamRate            = Source->ConverterRate;
+         Statistics->StreamFrames          = StreamStatistics.Frames - Source->StreamBase.Frames;
+         Statistics->StreamUnderruns       = StreamStatistics.Underruns - Source->StreamBase.Underruns;
+         Statistics->StreamLate            = StreamStatistics.Late - Source->StreamBase.Late;
+         Statistics->StreamOverruns        = StreamStatistics.Overruns - Source->StreamBase.Overruns;
+         Statistics->StreamConcealedFrames = StreamStatistics.ConcealedFrames - Source->StreamBase.ConcealedFrames;
+         Statistics->StreamJitter          = StreamStatistics.Jitter;
+         Statistics->StreamDepth           = StreamStatistics.Depth;
+         Statistics->StreamTargetDepth     = StreamStatistics.TargetDepth;
+         Statistics->Correction            = Source->Correction;
+
+         if(Reset)
+         {
+            for(Index = 0; Index < AUDIO_STREAM_SOURCES; Index++)
+               AUDIOJB_Query_Statistics(&AUDIO_Context.Sources[Index].JitterBuffer, &AUDIO_Context.Sources[Index].StreamBase);
+         }
+      }
+
+      if(Reset)
+      {
+         AUDIO_Context.Statistics.Periods             = 0;
+         AUDIO_Context.Statistics.Underruns           = 0;
+         AUDIO_Context.Statistics.FIFOUnderruns       = 0;
+         AUDIO_Context.Statistics.FIFOOverruns        = 0;
+         AUDIO_Context.Statistics.TransferErrors      = 0;
+         AUDIO_Context.Statistics.MaximumProcessTime  = 0;
+         AUDIO_Context.Statistics.DecodedFrames       = 0;
+         AUDIO_Context.Statistics.DecodeErrors        = 0;
+         AUDIO_Context.Statistics.MaximumDecodeCycles = 0;
+         AUDIO_Context.Statistics.MicrophoneSlips     = 0;
+         AUDIO_Context.Statistics.MicrophoneResyncs   = 0;
+         AUDIO_Context.DecodeCycles                   = 0;
+      }
+
+      taskEXIT_CRITICAL();
+   }
+}
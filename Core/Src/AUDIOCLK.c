@@ -0,0 +1,162 @@
+/*****< audioclk.c >***********************************************************/
+/*                                                                            */
+/*  AUDIOCLK - Clock plans of the audio interface.                            */
+/*                                                                            */
+/******************************************************************************/
+
+#include <stddef.h>
+
+#include "AUDIOCLK.h"       /* Audio Clock Plan Prototypes/Constants.         */
+
+   /* The following constant represents one in parts per billion.       */
+#define PARTS_PER_BILLION        1000000000LL
+
+   /* The following table holds the default clock plans, which are the  */
+   /* result of AUDIOCLK_Plan() for AUDIOCLK_INPUT_CLOCK.  The 16 kHz   */
+   /* and 32 kHz plans only differ in MCKDIV, so switching between them */
+   /* does not relock the PLL.                                          */
+const AUDIOCLK_Plan_t AUDIOCLK_DefaultPlans[] =
+{
+   {  8000, 1, 64, 25, 5,       0 },
+   { 16000, 1, 43, 21, 2, -186012 },
+   { 32000, 1, 43, 21, 1, -186012 },
+   { 44100, 1, 79, 28, 1, -344185 },
+   { 48000, 1, 43, 14, 1, -186012 }
+};
+
+const unsigned int AUDIOCLK_NumberDefaultPlans = sizeof(AUDIOCLK_DefaultPlans) / sizeof(AUDIOCLK_DefaultPlans[0]);
+
+   /* Local Function Prototypes.                                        */
+static long PlanError(unsigned long InputClock, unsigned long SampleRate, unsigned int PLLM, unsigned int PLLN, unsigned int Divider);
+
+   /* The following function returns the error (in parts per billion,   */
+   /* rounded) of the rate of the specified dividers, where Divider is  */
+   /* the product of PLLP and MCKDIV.                                   */
+static long PlanError(unsigned long InputClock, unsigned long SampleRate, unsigned int PLLM, unsigned int PLLN, unsigned int Divider)
+{
+   long long Numerator;
+   long long Denominator;
+
+   Numerator   = (long long)InputClock * PLLN * PARTS_PER_BILLION;
+   Denominator = (long long)PLLM * Divider * AUDIOCLK_MCLK_RATIO * SampleRate;
+
+   return((long)(((Numerator + (Denominator / 2)) / Denominator) - PARTS_PER_BILLION));
+}
+
+   /* The following function searches the clock plan of the specified   */
+   /* sample rate from the specified input clock.  The plan with the    */
+   /* smallest error is chosen, of those the one with the slowest VCO   */
+   /* and then the slowest kernel clock.  This function returns zero if */
+   /* successful or a negative value if no plan is valid.               */
+int AUDIOCLK_Plan(unsigned long InputClock, unsigned long SampleRate, AUDIOCLK_Plan_t *Plan)
+{
+   int                ret_val;
+   int                Better;
+   unsigned int       PLLM;
+   unsigned int       PLLN;
+   unsigned int       PLLP;
+   unsigned int       MCKDIV;
+   unsigned long      VCOInput;
+   unsigned long      Magnitude;
+   unsigned long      Best;
+   long               Error;
+   long long          Slower;
+   unsigned long long VCO;
+
+   ret_val = -1;
+
+   if((InputClock) && (SampleRate) && (Plan))
+   {
+      Best = 0;
+
+      for(PLLM = AUDIOCLK_MINIMUM_PLLM; PLLM <= AUDIOCLK_MAXIMUM_PLLM; PLLM++)
+      {
+         VCOInput = InputClock / PLLM;
+
+         if((VCOInput >= AUDIOCLK_MINIMUM_VCO_INPUT) && (VCOInput <= AUDIOCLK_MAXIMUM_VCO_INPUT))
+         {
+            for(PLLN = AUDIOCLK_MINIMUM_PLLN; PLLN <= AUDIOCLK_MAXIMUM_PLLN; PLLN++)
+            {
+               VCO = ((unsigned long long)InputClock * PLLN) / PLLM;
+
+               if((VCO >= AUDIOCLK_MINIMUM_VCO) && (VCO <= AUDIOCLK_MAXIMUM_VCO))
+               {
+                  for(PLLP = AUDIOCLK_MINIMUM_PLLP; PLLP <= AUDIOCLK_MAXIMUM_PLLP; PLLP++)
+                  {
+                     for(MCKDIV = AUDIOCLK_MINIMUM_MCKDIV; MCKDIV <= AUDIOCLK_MAXIMUM_MCKDIV; MCKDIV++)
+                     {
+                        Error     = PlanError(InputClock, SampleRate, PLLM, PLLN, (PLLP * MCKDIV));
+                        Magnitude = (unsigned long)((Error < 0) ? -Error : Error);
+
+                        /* A plan with the same error only replaces the */
+                        /* best one if its VCO (N / M) is slower, or is */
+                        /* as fast and its kernel clock is slower.      */
+                        if(!ret_val)
+                        {
+                           Slower = ((long long)PLLN * Plan->PLLM) - ((long long)Plan->PLLN * PLLM);
+
+                           Better = ((Magnitude < Best) || ((Magnitude == Best) && ((Slower < 0) || ((!Slower) && (PLLP > Plan->PLLP)))));
+                        }
+                        else
+                           Better = 1;
+
+                        if(Better)
+                        {
+                           Plan->SampleRate = SampleRate;
+                           Plan->PLLM       = PLLM;
+                           Plan->PLLN       = PLLN;
+                           Plan->PLLP       = PLLP;
+                           Plan->MCKDIV     = MCKDIV;
+                           Plan->Error      = Error;
+
+                           Best             = Magnitude;
+                           ret_val          = 0;
+                        }
+                     }
+                  }
+               }
+            }
+         }
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the clock plan of the specified    */
+   /* sample rate from the specified plans, or NULL if there is none.   */
+const AUDIOCLK_Plan_t *AUDIOCLK_FindPlan(const AUDIOCLK_Plan_t *Plans, unsigned int NumberPlans, unsigned long SampleRate)
+{
+   const AUDIOCLK_Plan_t *ret_val;
+
+   ret_val = NULL;
+
+   while((!ret_val) && (Plans) && (NumberPlans--))
+   {
+      if(Plans->SampleRate == SampleRate)
+         ret_val = Plans;
+      else
+         Plans++;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the rate (in Hz, rounded) SAI1 runs*/
+   /* at from the specified input clock with the specified plan.        */
+unsigned long AUDIOCLK_Rate(unsigned long InputClock, const AUDIOCLK_Plan_t *Plan)
+{
+   unsigned long ret_val;
+   long long     Denominator;
+
+   if((Plan) && (Plan->PLLM) && (Plan->PLLP) && (Plan->MCKDIV))
+   {
+      Denominator = (long long)Plan->PLLM * Plan->PLLP * Plan->MCKDIV * AUDIOCLK_MCLK_RATIO;
+
+      ret_val     = (unsigned long)((((long long)InputClock * Plan->PLLN) + (Denominator / 2)) / Denominator);
+   }
+   else
+      ret_val = 0;
+
+   return(ret_val);
+}
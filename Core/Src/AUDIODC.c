@@ -0,0 +1,190 @@
+/*****< audiodc.c >************************************************************/
+/*                                                                            */
+/*  AUDIODC - DC removal and noise gate of the microphone samples.            */
+/*                                                                            */
+/******************************************************************************/
+
+#include <string.h>
+
+#include "AUDIODC.h"        /* Audio DC Removal Prototypes/Constants.         */
+#include "AUDIOSIMD.h"      /* Audio SIMD Instructions.                       */
+
+   /* Local Function Prototypes.                                        */
+static void EndSegment(AUDIODC_State_t *State);
+static short ProcessSample(AUDIODC_State_t *State, short Sample);
+static long SumBlock(unsigned int Length, const short *Input);
+static void ProcessBlock(AUDIODC_State_t *State, unsigned int Length, const short *Input, short *Output);
+
+   /* The following function is called when the current segment is      */
+   /* complete.  It replaces the oldest segment average with the average*/
+   /* of the segment and updates the DC level.                          */
+static void EndSegment(AUDIODC_State_t *State)
+{
+   short Average;
+
+   Average                              = (short)(State->SegmentSum >> AUDIODC_SEGMENT_SHIFT);
+   State->AverageSum                   += Average - State->Averages[State->AverageIndex];
+   State->Averages[State->AverageIndex] = Average;
+   State->SegmentSum                    = 0;
+   State->SegmentCount                  = 0;
+
+   if(++State->AverageIndex >= AUDIODC_AVERAGES)
+   {
+      State->AverageIndex = 0;
+      State->Tracking     = 1;
+   }
+
+   if(State->Tracking)
+      State->Level = (short)(State->AverageSum >> AUDIODC_AVERAGE_SHIFT);
+}
+
+   /* The following function removes the DC level from the specified    */
+   /* sample, amplifies it and applies the noise gate.                  */
+static short ProcessSample(AUDIODC_State_t *State, short Sample)
+{
+   long Value;
+
+   Value = (long)Sample - State->Level;
+   Value = (Value > 32767) ? 32767 : ((Value < -32768) ? -32768 : Value);
+   Value = Value * (1L << State->Shift);
+   Value = (Value > 32767) ? 32767 : ((Value < -32768) ? -32768 : Value);
+
+   if((Value < State->Threshold) && (Value > -State->Threshold))
+      Value = 0;
+
+   return((short)Value);
+}
+
+   /* The following function returns the sum of the specified samples.  */
+   /* Two samples are added at a time by a dual multiply accumulate     */
+   /* with one.                                                         */
+static long SumBlock(unsigned int Length, const short *Input)
+{
+   uint32_t Sum;
+
+   Sum = 0;
+
+   while(Length >= 2)
+   {
+      Sum     = __SMLAD(AUDIOSIMD_Read2(Input), 0x00010001, Sum);
+      Input  += 2;
+      Length -= 2;
+   }
+
+   if(Length)
+      Sum += (uint32_t)(long)*Input;
+
+   return((long)(int32_t)Sum);
+}
+
+   /* The following function processes the specified samples with the   */
+   /* current DC level, two samples at a time.  The gate compares each  */
+   /* sample with the threshold and with its negative, the GE flags of  */
+   /* each comparison select the samples that are kept.                 */
+static void ProcessBlock(AUDIODC_State_t *State, unsigned int Length, const short *Input, short *Output)
+{
+   uint32_t     Level;
+   uint32_t     Threshold;
+   uint32_t     NegativeThreshold;
+   uint32_t     Value;
+   uint32_t     Result;
+   unsigned int Index;
+
+   Level             = AUDIOSIMD_PACK(State->Level, State->Level);
+   Threshold         = AUDIOSIMD_PACK(State->Threshold, State->Threshold);
+   NegativeThreshold = AUDIOSIMD_PACK(-State->Threshold, -State->Threshold);
+
+   while(Length >= 2)
+   {
+      Value = __QSUB16(AUDIOSIMD_Read2(Input), Level);
+
+      for(Index = State->Shift; Index; Index--)
+         Value = __QADD16(Value, Value);
+
+      /* Keep the samples that are at or above the threshold, then the  */
+      /* samples that are at or below its negative.                     */
+      __SSUB16(Value, Threshold);
+      Result = __SEL(Value, 0);
+      __SSUB16(NegativeThreshold, Value);
+      Result = __SEL(Value, Result);
+
+      AUDIOSIMD_Write2(Output, Result);
+
+      Input  += 2;
+      Output += 2;
+      Length -= 2;
+   }
+
+   if(Length)
+      *Output = ProcessSample(State, *Input);
+}
+
+   /* The following function initializes the specified state with the   */
+   /* specified initial DC level, the amplification (as a shift, 0 to   */
+   /* 15) and the threshold (not negative) of the noise gate.  A        */
+   /* threshold of zero disables the noise gate.                        */
+void AUDIODC_Initialize(AUDIODC_State_t *State, short InitialLevel, unsigned int Shift, short Threshold)
+{
+   if(State)
+   {
+      memset(State, 0, sizeof(AUDIODC_State_t));
+
+      State->Level     = InitialLevel;
+      State->Shift     = (Shift > 15) ? 15 : Shift;
+      State->Threshold = (Threshold < 0) ? 0 : Threshold;
+   }
+}
+
+   /* The following function processes the specified number of samples  */
+   /* from the input to the output buffer (which may be the same).  The */
+   /* samples are taken in pieces that end at the end of each segment.  */
+   /* The last sample of a segment is processed with the new DC level,  */
+   /* the others with the level at the start of the piece.              */
+void AUDIODC_Process(AUDIODC_State_t *State, unsigned int Length, const short *Input, short *Output)
+{
+   unsigned int Count;
+
+   while(Length)
+   {
+      Count = AUDIODC_SEGMENT_LENGTH - State->SegmentCount;
+      if(Count > Length)
+         Count = Length;
+
+      /* The sum is taken first, as the output may overwrite the input. */
+      State->SegmentSum   += SumBlock(Count, Input);
+      State->SegmentCount += Count;
+
+      if(State->SegmentCount == AUDIODC_SEGMENT_LENGTH)
+      {
+         ProcessBlock(State, Count - 1, Input, Output);
+
+         EndSegment(State);
+
+         ProcessBlock(State, 1, &Input[Count - 1], &Output[Count - 1]);
+      }
+      else
+         ProcessBlock(State, Count, Input, Output);
+
+      Input  += Count;
+      Output += Count;
+      Length -= Count;
+   }
+}
+
+   /* The following function is the reference version of                */
+   /* AUDIODC_Process().  It is only used to check the block version.   */
+void AUDIODC_ProcessReference(AUDIODC_State_t *State, unsigned int Length, const short *Input, short *Output)
+{
+   short Sample;
+
+   while(Length--)
+   {
+      Sample             = *(Input++);
+      State->SegmentSum += Sample;
+
+      if(++State->SegmentCount == AUDIODC_SEGMENT_LENGTH)
+         EndSegment(State);
+
+      *(Output++) = ProcessSample(State, Sample);
+   }
+}
@@ -0,0 +1,445 @@
+/*****< audioflt.c >***********************************************************/
+/*                                                                            */
+/*  AUDIOFLT - Fixed point filter bank of the audio path.                     */
+/*                                                                            */
+/******************************************************************************/
+
+#include <string.h>
+
+#include "AUDIOFLT.h"       /* Audio Filter Bank Prototypes/Constants.        */
+#include "AUDIOSIMD.h"      /* Audio SIMD Instructions.                       */
+
+   /* The following constants represent the fraction bits of the FIR    */
+   /* coefficients and of the Q15 and Q31 biquad coefficients.          */
+#define FIR_SHIFT                15
+#define BIQUAD_Q15_SHIFT         14
+#define BIQUAD_Q31_SHIFT         30
+
+   /* The following constants represent the indexes of the biquad state.*/
+#define STATE_X1                 0
+#define STATE_X2                 1
+#define STATE_Y1                 2
+#define STATE_Y2                 3
+
+   /* The following are the coefficients of the default sets.  The FIR  */
+   /* is the smoothing filter that was applied to the microphone        */
+   /* samples by the I2S interrupt (1/2, 1/4, 1/8 and 1/8 from the      */
+   /* newest sample), the biquads are second order Butterworth high     */
+   /* pass filters at 100 Hz (HFP) and 20 Hz (A2DP).                    */
+static const short MicrophoneSmoothing[] = { 16384, 8192, 4096, 4096 };
+
+static const long HighPass100Hz8kHz[AUDIOFLT_BIQUAD_COEFFICIENTS]   = { 1015734915L, -2031469830L, 1015734915L, -2028333824L,  960864011L };
+static const long HighPass100Hz16kHz[AUDIOFLT_BIQUAD_COEFFICIENTS]  = { 1044336221L, -2088672443L, 1044336221L, -2087866987L, 1015736075L };
+static const long HighPass20Hz44kHz[AUDIOFLT_BIQUAD_COEFFICIENTS]   = { 1071580506L, -2143161012L, 1071580506L, -2143156661L, 1069423538L };
+static const long HighPass20Hz48kHz[AUDIOFLT_BIQUAD_COEFFICIENTS]   = { 1071755951L, -2143511901L, 1071755951L, -2143508228L, 1069773750L };
+
+static const AUDIOFLT_Stage_Definition_t Microphone8kHzStages[] =
+{
+   { ftBiquad_Q31, 0, NULL, HighPass100Hz8kHz },
+   { ftFIR_Q15, sizeof(MicrophoneSmoothing) / sizeof(MicrophoneSmoothing[0]), MicrophoneSmoothing, NULL }
+};
+
+static const AUDIOFLT_Stage_Definition_t Microphone16kHzStages[] =
+{
+   { ftBiquad_Q31, 0, NULL, HighPass100Hz16kHz },
+   { ftFIR_Q15, sizeof(MicrophoneSmoothing) / sizeof(MicrophoneSmoothing[0]), MicrophoneSmoothing, NULL }
+};
+
+static const AUDIOFLT_Stage_Definition_t Playback44kHzStages[] =
+{
+   { ftBiquad_Q31, 0, NULL, HighPass20Hz44kHz }
+};
+
+static const AUDIOFLT_Stage_Definition_t Playback48kHzStages[] =
+{
+   { ftBiquad_Q31, 0, NULL, HighPass20Hz48kHz }
+};
+
+const AUDIOFLT_Coefficient_Set_t AUDIOFLT_DefaultSets[] =
+{
+   {  8000, sizeof(Microphone8kHzStages) / sizeof(Microphone8kHzStages[0]),   Microphone8kHzStages  },
+   { 16000, sizeof(Microphone16kHzStages) / sizeof(Microphone16kHzStages[0]), Microphone16kHzStages },
+   { 44100, sizeof(Playback44kHzStages) / sizeof(Playback44kHzStages[0]),     Playback44kHzStages   },
+   { 48000, sizeof(Playback48kHzStages) / sizeof(Playback48kHzStages[0]),     Playback48kHzStages   }
+};
+
+const unsigned int AUDIOFLT_NumberDefaultSets = sizeof(AUDIOFLT_DefaultSets) / sizeof(AUDIOFLT_DefaultSets[0]);
+
+   /* Local Function Prototypes.                                        */
+static int InitializeStage(AUDIOFLT_Stage_t *Stage, const AUDIOFLT_Stage_Definition_t *Definition);
+static short BiquadQ31Sample(AUDIOFLT_Stage_t *Stage, short Sample);
+static void ProcessFIR(AUDIOFLT_Stage_t *Stage, unsigned int Length, const short *Input, short *Output);
+static void ProcessBiquadQ15(AUDIOFLT_Stage_t *Stage, unsigned int Length, const short *Input, short *Output);
+static short ReferenceFIR(AUDIOFLT_Stage_t *Stage, short Sample);
+static short ReferenceBiquadQ15(AUDIOFLT_Stage_t *Stage, short Sample);
+
+   /* The following function configures the specified stage from the    */
+   /* specified definition.  This function returns zero if successful or*/
+   /* a negative value if the definition is not valid.                  */
+static int InitializeStage(AUDIOFLT_Stage_t *Stage, const AUDIOFLT_Stage_Definition_t *Definition)
+{
+   int          ret_val;
+   unsigned int Index;
+
+   memset(Stage, 0, sizeof(AUDIOFLT_Stage_t));
+
+   Stage->Type = Definition->Type;
+   ret_val     = -1;
+
+   switch(Definition->Type)
+   {
+      case ftFIR_Q15:
+         if((Definition->Q15) && (Definition->NumberTaps) && (Definition->NumberTaps <= AUDIOFLT_MAXIMUM_FIR_TAPS))
+         {
+            /* The taps are computed in pairs, so an odd number of taps */
+            /* is padded with a zero coefficient for the oldest sample. */
+            Stage->NumberTaps = (Definition->NumberTaps + 1) & ~1U;
+
+            for(Index = 0; Index < Definition->NumberTaps; Index++)
+               Stage->Coefficients[Stage->NumberTaps - 1 - Index] = Definition->Q15[Index];
+
+            ret_val = 0;
+         }
+         break;
+      case ftBiquad_Q15:
+         if((Definition->Q15) && (Definition->Q15[3] != -32768) && (Definition->Q15[4] != -32768))
+         {
+            Stage->BiquadQ15[0] = AUDIOSIMD_PACK(Definition->Q15[0], Definition->Q15[1]);
+            Stage->BiquadQ15[1] = AUDIOSIMD_PACK(Definition->Q15[2], -Definition->Q15[3]);
+            Stage->BiquadQ15[2] = AUDIOSIMD_PACK(-Definition->Q15[4], 0);
+
+            ret_val = 0;
+         }
+         break;
+      case ftBiquad_Q31:
+         if(Definition->Q31)
+         {
+            for(Index = 0, ret_val = 0; Index < AUDIOFLT_BIQUAD_COEFFICIENTS; Index++)
+            {
+               if((Definition->Q31[Index] > 2147483647L) || (Definition->Q31[Index] < (-2147483647L - 1)))
+                  ret_val = -1;
+
+               Stage->BiquadQ31[Index] = Definition->Q31[Index];
+            }
+         }
+         break;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function filters one sample with the specified Q31  */
+   /* biquad stage.  The input samples are taken as Q31 and the products*/
+   /* are accumulated in 64 bits, which wraps like SMLAL on the target  */
+   /* (only the final sum needs to fit).  The block and the reference   */
+   /* versions both use this function.                                  */
+static short BiquadQ31Sample(AUDIOFLT_Stage_t *Stage, short Sample)
+{
+   long     *State;
+   long     *Coefficients;
+   int64_t   Output;
+   uint64_t  Sum;
+
+   State        = Stage->StateQ31;
+   Coefficients = Stage->BiquadQ31;
+
+   Sum  = (uint64_t)1 << (BIQUAD_Q31_SHIFT - 1);
+   Sum += (uint64_t)((int64_t)Coefficients[0] * ((int64_t)Sample * 65536));
+   Sum += (uint64_t)((int64_t)Coefficients[1] * ((int64_t)State[STATE_X1] * 65536));
+   Sum += (uint64_t)((int64_t)Coefficients[2] * ((int64_t)State[STATE_X2] * 65536));
+   Sum -= (uint64_t)((int64_t)Coefficients[3] * (int64_t)State[STATE_Y1]);
+   Sum -= (uint64_t)((int64_t)Coefficients[4] * (int64_t)State[STATE_Y2]);
+
+   Output = (int64_t)Sum >> BIQUAD_Q31_SHIFT;
+   Output = (Output > 2147483647LL) ? 2147483647LL : ((Output < (-2147483647LL - 1)) ? (-2147483647LL - 1) : Output);
+
+   State[STATE_X2] = State[STATE_X1];
+   State[STATE_X1] = Sample;
+   State[STATE_Y2] = State[STATE_Y1];
+   State[STATE_Y1] = (long)Output;
+
+   return((short)__SSAT((int32_t)((Output + 0x8000) >> 16), 16));
+}
+
+   /* The following function filters the specified samples with the     */
+   /* specified FIR stage.  Each sample is written at Position and at   */
+   /* Position + NumberTaps, so the last NumberTaps samples always start*/
+   /* at Position + 1 (oldest first) and the taps are computed in pairs */
+   /* without wrapping.                                                 */
+static void ProcessFIR(AUDIOFLT_Stage_t *Stage, unsigned int Length, const short *Input, short *Output)
+{
+   short        *Window;
+   uint32_t      Sum;
+   unsigned int  Index;
+   unsigned int  NumberTaps;
+   unsigned int  Position;
+
+   NumberTaps = Stage->NumberTaps;
+   Position   = Stage->Position;
+
+   while(Length--)
+   {
+      Stage->History[Position]              = *Input;
+      Stage->History[Position + NumberTaps] = *Input;
+
+      Window = &(Stage->History[Position + 1]);
+      Sum    = 1UL << (FIR_SHIFT - 1);
+
+      for(Index = 0; Index < NumberTaps; Index += 2)
+         Sum = __SMLAD(AUDIOSIMD_Read2(&Window[Index]), AUDIOSIMD_Read2(&(Stage->Coefficients[Index])), Sum);
+
+      if(++Position == NumberTaps)
+         Position = 0;
+
+      *Output = (short)__SSAT((int32_t)Sum >> FIR_SHIFT, 16);
+
+      Input++;
+      Output++;
+   }
+
+   Stage->Position = Position;
+}
+
+   /* The following function filters the specified samples with the     */
+   /* specified Q15 biquad stage.  The samples and the state are packed */
+   /* in the same pairs as the coefficients (x[n], x[n-1]), (x[n-2],    */
+   /* y[n-1]) and (y[n-2], 0).                                          */
+static void ProcessBiquadQ15(AUDIOFLT_Stage_t *Stage, unsigned int Length, const short *Input, short *Output)
+{
+   int32_t  X1;
+   int32_t  X2;
+   int32_t  Y1;
+   int32_t  Y2;
+   int32_t  Sample;
+   uint32_t Sum;
+
+   X1 = Stage->StateQ15[STATE_X1];
+   X2 = Stage->StateQ15[STATE_X2];
+   Y1 = Stage->StateQ15[STATE_Y1];
+   Y2 = Stage->StateQ15[STATE_Y2];
+
+   while(Length--)
+   {
+      Sample = *(Input++);
+
+      Sum    = 1UL << (BIQUAD_Q15_SHIFT - 1);
+      Sum    = __SMLAD(AUDIOSIMD_PACK(Sample, X1), Stage->BiquadQ15[0], Sum);
+      Sum    = __SMLAD(AUDIOSIMD_PACK(X2, Y1), Stage->BiquadQ15[1], Sum);
+      Sum    = __SMLAD(AUDIOSIMD_PACK(Y2, 0), Stage->BiquadQ15[2], Sum);
+
+      X2     = X1;
+      X1     = Sample;
+      Y2     = Y1;
+      Y1     = __SSAT((int32_t)Sum >> BIQUAD_Q15_SHIFT, 16);
+
+      *(Output++) = (short)Y1;
+   }
+
+   Stage->StateQ15[STATE_X1] = (short)X1;
+   Stage->StateQ15[STATE_X2] = (short)X2;
+   Stage->StateQ15[STATE_Y1] = (short)Y1;
+   Stage->StateQ15[STATE_Y2] = (short)Y2;
+}
+
+   /* The following function is the reference version of ProcessFIR()   */
+   /* for one sample.  The products are accumulated modulo 2^32, like   */
+   /* __SMLAD.                                                          */
+static short ReferenceFIR(AUDIOFLT_Stage_t *Stage, short Sample)
+{
+   uint32_t     Sum;
+   unsigned int Index;
+   unsigned int NumberTaps;
+
+   NumberTaps = Stage->NumberTaps;
+
+   Stage->History[Stage->Position]              = Sample;
+   Stage->History[Stage->Position + NumberTaps] = Sample;
+
+   Sum = 1UL << (FIR_SHIFT - 1);
+
+   for(Index = 0; Index < NumberTaps; Index++)
+      Sum += (uint32_t)((int32_t)Stage->Coefficients[NumberTaps - 1 - Index] * Stage->History[(Stage->Position + NumberTaps - Index) % NumberTaps]);
+
+   Stage->Position = (Stage->Position + 1) % NumberTaps;
+
+   Sum = (uint32_t)((int32_t)Sum >> FIR_SHIFT);
+
+   return((short)(((int32_t)Sum > 32767) ? 32767 : (((int32_t)Sum < -32768) ? -32768 : (int32_t)Sum)));
+}
+
+   /* The following function is the reference version of                */
+   /* ProcessBiquadQ15() for one sample.                                */
+static short ReferenceBiquadQ15(AUDIOFLT_Stage_t *Stage, short Sample)
+{
+   short   *State;
+   int32_t  Output;
+   uint32_t Sum;
+
+   State = Stage->StateQ15;
+
+   Sum  = 1UL << (BIQUAD_Q15_SHIFT - 1);
+   Sum += (uint32_t)((int32_t)(short)(Stage->BiquadQ15[0] & 0xFFFF) * Sample);
+   Sum += (uint32_t)((int32_t)(short)(Stage->BiquadQ15[0] >> 16) * State[STATE_X1]);
+   Sum += (uint32_t)((int32_t)(short)(Stage->BiquadQ15[1] & 0xFFFF) * State[STATE_X2]);
+   Sum += (uint32_t)((int32_t)(short)(Stage->BiquadQ15[1] >> 16) * State[STATE_Y1]);
+   Sum += (uint32_t)((int32_t)(short)(Stage->BiquadQ15[2] & 0xFFFF) * State[STATE_Y2]);
+
+   Output = (int32_t)Sum >> BIQUAD_Q15_SHIFT;
+   Output = (Output > 32767) ? 32767 : ((Output < -32768) ? -32768 : Output);
+
+   State[STATE_X2] = State[STATE_X1];
+   State[STATE_X1] = Sample;
+   State[STATE_Y2] = State[STATE_Y1];
+   State[STATE_Y1] = (short)Output;
+
+   return((short)Output);
+}
+
+   /* The following function returns the coefficient set of the         */
+   /* specified sample rate from the specified sets, or NULL if there is*/
+   /* none.                                                             */
+const AUDIOFLT_Coefficient_Set_t *AUDIOFLT_FindCoefficientSet(const AUDIOFLT_Coefficient_Set_t *Sets, unsigned int NumberSets, unsigned long SampleRate)
+{
+   const AUDIOFLT_Coefficient_Set_t *ret_val;
+
+   ret_val = NULL;
+
+   while((!ret_val) && (Sets) && (NumberSets--))
+   {
+      if(Sets->SampleRate == SampleRate)
+         ret_val = Sets;
+      else
+         Sets++;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function configures the specified filter bank with  */
+   /* the specified coefficient set (NULL configures a bank with no     */
+   /* stages) and clears its history.  This function returns zero if    */
+   /* successful or a negative value if the set is not valid, in which  */
+   /* case the bank is left with no stages.                             */
+int AUDIOFLT_Initialize(AUDIOFLT_Bank_t *Bank, const AUDIOFLT_Coefficient_Set_t *Set)
+{
+   int          ret_val;
+   unsigned int Index;
+
+   if(Bank)
+   {
+      memset(Bank, 0, sizeof(AUDIOFLT_Bank_t));
+
+      ret_val = 0;
+
+      if(Set)
+      {
+         if((Set->NumberStages <= AUDIOFLT_MAXIMUM_STAGES) && ((Set->Stages) || (!Set->NumberStages)))
+         {
+            for(Index = 0; (!ret_val) && (Index < Set->NumberStages); Index++)
+               ret_val = InitializeStage(&(Bank->Stages[Index]), &(Set->Stages[Index]));
+
+            if(!ret_val)
+            {
+               Bank->SampleRate   = Set->SampleRate;
+               Bank->NumberStages = Set->NumberStages;
+            }
+         }
+         else
+            ret_val = -1;
+      }
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function clears the history of the specified filter */
+   /* bank.                                                             */
+void AUDIOFLT_Reset(AUDIOFLT_Bank_t *Bank)
+{
+   unsigned int      Index;
+   AUDIOFLT_Stage_t *Stage;
+
+   for(Index = 0; Index < Bank->NumberStages; Index++)
+   {
+      Stage           = &(Bank->Stages[Index]);
+      Stage->Position = 0;
+
+      memset(Stage->History, 0, sizeof(Stage->History));
+      memset(Stage->StateQ15, 0, sizeof(Stage->StateQ15));
+      memset(Stage->StateQ31, 0, sizeof(Stage->StateQ31));
+   }
+}
+
+   /* The following function filters the specified number of samples    */
+   /* from the input to the output buffer (which may be the same).  The */
+   /* whole block is filtered by each stage in turn, the stages after   */
+   /* the first work in place in the output buffer.                     */
+void AUDIOFLT_Process(AUDIOFLT_Bank_t *Bank, unsigned int Length, const short *Input, short *Output)
+{
+   unsigned int      Index;
+   unsigned int      Count;
+   AUDIOFLT_Stage_t *Stage;
+
+   if(!Bank->NumberStages)
+   {
+      if(Input != Output)
+         memmove(Output, Input, Length * sizeof(short));
+   }
+
+   for(Index = 0; Index < Bank->NumberStages; Index++)
+   {
+      Stage = &(Bank->Stages[Index]);
+
+      switch(Stage->Type)
+      {
+         case ftFIR_Q15:
+            ProcessFIR(Stage, Length, Input, Output);
+            break;
+         case ftBiquad_Q15:
+            ProcessBiquadQ15(Stage, Length, Input, Output);
+            break;
+         case ftBiquad_Q31:
+            for(Count = 0; Count < Length; Count++)
+               Output[Count] = BiquadQ31Sample(Stage, Input[Count]);
+            break;
+      }
+
+      Input = Output;
+   }
+}
+
+   /* The following function is the reference version of                */
+   /* AUDIOFLT_Process().  It is only used to check the block version.  */
+void AUDIOFLT_ProcessReference(AUDIOFLT_Bank_t *Bank, unsigned int Length, const short *Input, short *Output)
+{
+   short             Sample;
+   unsigned int      Index;
+   AUDIOFLT_Stage_t *Stage;
+
+   while(Length--)
+   {
+      Sample = *(Input++);
+
+      for(Index = 0; Index < Bank->NumberStages; Index++)
+      {
+         Stage = &(Bank->Stages[Index]);
+
+         switch(Stage->Type)
+         {
+            case ftFIR_Q15:
+               Sample = ReferenceFIR(Stage, Sample);
+               break;
+            case ftBiquad_Q15:
+               Sample = ReferenceBiquadQ15(Stage, Sample);
+               break;
+            case ftBiquad_Q31:
+               Sample = BiquadQ31Sample(Stage, Sample);
+               break;
+         }
+      }
+
+      *(Output++) = Sample;
+   }
+}
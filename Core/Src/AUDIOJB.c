@@ -0,0 +1,360 @@
+/*****< audiojb.c >************************************************************/
+/*                                                                            */
+/*  AUDIOJB - Adaptive jitter buffer of the audio stream.                     */
+/*                                                                            */
+/******************************************************************************/
+
+#include <string.h>
+
+#include "AUDIOJB.h"        /* Audio Jitter Buffer Prototypes/Constants.      */
+
+   /* The following macro keeps the compiler from moving the writes of  */
+   /* the frames after the update of the write count (the Cortex-M4     */
+   /* does not reorder them itself).                                    */
+#define MemoryBarrier()          __asm volatile ("" : : : "memory")
+
+static void UpdateTarget(AUDIOJB_Buffer_t *JitterBuffer);
+static void MeasureArrival(AUDIOJB_Buffer_t *JitterBuffer, unsigned long Time);
+static void SaveLast(AUDIOJB_Buffer_t *JitterBuffer, unsigned int Frames, const short *Output);
+
+   /* The following function sets the target depth of the specified     */
+   /* jitter buffer to the latency plus the largest recent jitter.      */
+static void UpdateTarget(AUDIOJB_Buffer_t *JitterBuffer)
+{
+   unsigned long TargetFrames;
+
+   TargetFrames = (unsigned long)JitterBuffer->LatencyFrames + JitterBuffer->Peak;
+
+   if(TargetFrames > JitterBuffer->MaximumFrames)
+      TargetFrames = JitterBuffer->MaximumFrames;
+
+   JitterBuffer->TargetFrames = (unsigned int)TargetFrames;
+}
+
+   /* The following function measures the transit of a write that       */
+   /* arrived at the specified time, before its frames are added to the */
+   /* stream.  The transit is in frames, so that a write that arrives   */
+   /* D frames later than the earliest writes needs D frames in the     */
+   /* buffer to be played in time.                                      */
+static void MeasureArrival(AUDIOJB_Buffer_t *JitterBuffer, unsigned long Time)
+{
+   long         Transit;
+   long         Reference;
+   unsigned int Spread;
+
+   /* The first write, or the first after a gap, starts a new           */
+   /* measurement (the largest recent jitter is kept).                  */
+   if((!JitterBuffer->Synchronized) || ((Time - JitterBuffer->LastArrival) > AUDIOJB_RESYNC_TIME))
+   {
+      JitterBuffer->Synchronized  = 1;
+      JitterBuffer->StartTime     = Time;
+      JitterBuffer->WindowStart   = Time;
+      JitterBuffer->StreamFrames  = 0;
+      JitterBuffer->Baseline      = 0;
+      JitterBuffer->WindowMinimum = 0;
+      JitterBuffer->WindowMaximum = 0;
+   }
+
+   JitterBuffer->LastArrival = Time;
+
+   Transit   = (long)(((unsigned long long)(Time - JitterBuffer->StartTime) * JitterBuffer->SampleRate) / 1000) - (long)JitterBuffer->StreamFrames;
+
+   if(Transit < JitterBuffer->WindowMinimum)
+      JitterBuffer->WindowMinimum = Transit;
+
+   if(Transit > JitterBuffer->WindowMaximum)
+      JitterBuffer->WindowMaximum = Transit;
+
+   /* The earliest writes of this and the last window are the reference */
+   /* (the windows follow the drift between the clocks).                */
+   Reference = (JitterBuffer->Baseline < JitterBuffer->WindowMinimum) ? JitterBuffer->Baseline : JitterBuffer->WindowMinimum;
+
+   if((unsigned long)(Transit - Reference) > JitterBuffer->TargetFrames)
+      JitterBuffer->Statistics.Late++;
+
+   /* The target grows as soon as the jitter grows.                     */
+   if((unsigned long)(Transit - Reference) > JitterBuffer->Peak)
+      JitterBuffer->Peak = (unsigned int)(Transit - Reference);
+
+   /* At the end of a window the largest jitter decays towards the      */
+   /* spread of the window.                                             */
+   if((Time - JitterBuffer->WindowStart) >= AUDIOJB_WINDOW_TIME)
+   {
+      Spread                      = (unsigned int)(JitterBuffer->WindowMaximum - JitterBuffer->WindowMinimum);
+      JitterBuffer->Peak         -= JitterBuffer->Peak >> 3;
+
+      if(Spread > JitterBuffer->Peak)
+         JitterBuffer->Peak = Spread;
+
+      JitterBuffer->Baseline      = JitterBuffer->WindowMinimum;
+      JitterBuffer->WindowMinimum = Transit;
+      JitterBuffer->WindowMaximum = Transit;
+      JitterBuffer->WindowStart   = Time;
+   }
+
+   UpdateTarget(JitterBuffer);
+}
+
+   /* The following function keeps the last of the specified output     */
+   /* frames of the specified jitter buffer, to be repeated if the next */
+   /* block is concealed.                                               */
+static void SaveLast(AUDIOJB_Buffer_t *JitterBuffer, unsigned int Frames, const short *Output)
+{
+   if(Frames >= AUDIOJB_CONCEAL_FRAMES)
+      memcpy(JitterBuffer->Last, &Output[(Frames - AUDIOJB_CONCEAL_FRAMES) * AUDIOJB_CHANNELS], sizeof(JitterBuffer->Last));
+   else
+   {
+      memmove(JitterBuffer->Last, &JitterBuffer->Last[Frames * AUDIOJB_CHANNELS], (AUDIOJB_CONCEAL_FRAMES - Frames) * AUDIOJB_CHANNELS * sizeof(short));
+      memcpy(&JitterBuffer->Last[(AUDIOJB_CONCEAL_FRAMES - Frames) * AUDIOJB_CHANNELS], Output, Frames * AUDIOJB_CHANNELS * sizeof(short));
+   }
+
+   JitterBuffer->Repeat = 0;
+}
+
+   /* The following function initializes the specified jitter buffer to */
+   /* use the specified buffer of the specified size (in frames, a power*/
+   /* of two) for a stream at the specified sample rate, with the       */
+   /* specified latency (in milliseconds) as the smallest target depth. */
+   /* The target depth never exceeds 3/4 of the buffer.  This function  */
+   /* returns zero if successful or a negative value if a parameter is  */
+   /* not valid.                                                        */
+int AUDIOJB_Initialize(AUDIOJB_Buffer_t *JitterBuffer, short *Buffer, unsigned int Size, unsigned long SampleRate, unsigned int Latency)
+{
+   int ret_val;
+
+   if((JitterBuffer) && (Buffer) && (Size) && (!(Size & (Size - 1))) && (SampleRate))
+   {
+      memset(JitterBuffer, 0, sizeof(AUDIOJB_Buffer_t));
+
+      JitterBuffer->Buffer        = Buffer;
+      JitterBuffer->Size          = Size;
+      JitterBuffer->MaximumFrames = Size - (Size >> 2);
+      JitterBuffer->Latency       = Latency;
+
+      /* The stream fades in when it starts.                            */
+      JitterBuffer->Fade          = AUDIOJB_FADE_FRAMES;
+
+      AUDIOJB_SetSampleRate(JitterBuffer, SampleRate);
+
+      ret_val = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function changes the sample rate of the stream of   */
+   /* the specified jitter buffer.  It may only be called by the writer */
+   /* and the frames that are in the buffer are kept.                   */
+void AUDIOJB_SetSampleRate(AUDIOJB_Buffer_t *JitterBuffer, unsigned long SampleRate)
+{
+   if((JitterBuffer) && (SampleRate))
+   {
+      /* The jitter is kept in time.                                    */
+      if(JitterBuffer->SampleRate)
+         JitterBuffer->Peak = (unsigned int)(((unsigned long long)JitterBuffer->Peak * SampleRate) / JitterBuffer->SampleRate);
+
+      JitterBuffer->SampleRate    = SampleRate;
+      JitterBuffer->LatencyFrames = (unsigned int)((SampleRate * JitterBuffer->Latency) / 1000);
+      JitterBuffer->Synchronized  = 0;
+
+      if(JitterBuffer->LatencyFrames > JitterBuffer->MaximumFrames)
+         JitterBuffer->LatencyFrames = JitterBuffer->MaximumFrames;
+
+      UpdateTarget(JitterBuffer);
+   }
+}
+
+   /* The following function writes the specified number of frames that */
+   /* arrived at the specified time (in milliseconds) to the specified  */
+   /* jitter buffer.  Frames that do not fit in the buffer are dropped. */
+   /* This function returns the number of frames that were written.     */
+unsigned int AUDIOJB_Write(AUDIOJB_Buffer_t *JitterBuffer, unsigned long Time, unsigned int Frames, const short *Samples)
+{
+   unsigned int  ret_val;
+   unsigned long In;
+   unsigned long Free;
+   unsigned int  Offset;
+   unsigned int  Span;
+
+   ret_val = 0;
+
+   if((JitterBuffer) && (Samples) && (Frames))
+   {
+      MeasureArrival(JitterBuffer, Time);
+
+      JitterBuffer->StreamFrames += Frames;
+
+      JitterBuffer->Statistics.Writes++;
+
+      In   = JitterBuffer->In;
+      Free = JitterBuffer->Size - (In - JitterBuffer->Out);
+
+      if(Frames > Free)
+      {
+         JitterBuffer->Statistics.Overruns++;
+
+         Frames = (unsigned int)Free;
+      }
+
+      ret_val = Frames;
+
+      /* The frames are written in up to two contiguous spans.          */
+      while(Frames)
+      {
+         Offset = (unsigned int)(In & (JitterBuffer->Size - 1));
+         Span   = JitterBuffer->Size - Offset;
+
+         if(Span > Frames)
+            Span = Frames;
+
+         memcpy(&JitterBuffer->Buffer[Offset * AUDIOJB_CHANNELS], Samples, Span * AUDIOJB_CHANNELS * sizeof(short));
+
+         Samples += Span * AUDIOJB_CHANNELS;
+         In      += Span;
+         Frames  -= Span;
+      }
+
+      MemoryBarrier();
+
+      JitterBuffer->In                 = In;
+      JitterBuffer->Statistics.Frames += ret_val;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the number of frames that can be   */
+   /* read contiguously from the specified jitter buffer and the first  */
+   /* of them in the final parameter.  This function returns zero while */
+   /* the buffer does not (yet) hold the target depth after starting or */
+   /* after an underrun.                                                */
+unsigned int AUDIOJB_Peek(AUDIOJB_Buffer_t *JitterBuffer, const short **Samples)
+{
+   unsigned int ret_val;
+   unsigned int Depth;
+   unsigned int Offset;
+
+   ret_val = 0;
+
+   if((JitterBuffer) && (Samples))
+   {
+      Depth = (unsigned int)(JitterBuffer->In - JitterBuffer->Out);
+
+      if((!JitterBuffer->Playing) && (Depth) && (Depth >= JitterBuffer->TargetFrames))
+         JitterBuffer->Playing = 1;
+
+      if(JitterBuffer->Playing)
+      {
+         Offset  = (unsigned int)(JitterBuffer->Out & (JitterBuffer->Size - 1));
+         ret_val = JitterBuffer->Size - Offset;
+
+         if(ret_val > Depth)
+            ret_val = Depth;
+
+         *Samples = &JitterBuffer->Buffer[Offset * AUDIOJB_CHANNELS];
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function removes the specified number of frames     */
+   /* (at most the number returned by AUDIOJB_Peek()) from the specified*/
+   /* jitter buffer.                                                    */
+void AUDIOJB_Consume(AUDIOJB_Buffer_t *JitterBuffer, unsigned int Frames)
+{
+   if(JitterBuffer)
+      JitterBuffer->Out += Frames;
+}
+
+   /* The following function returns the number of frames in the        */
+   /* specified jitter buffer.                                          */
+unsigned int AUDIOJB_Depth(AUDIOJB_Buffer_t *JitterBuffer)
+{
+   return((JitterBuffer) ? (unsigned int)(JitterBuffer->In - JitterBuffer->Out) : 0);
+}
+
+   /* The following function completes an output block of the specified */
+   /* number of frames, of which the first Produced frames were made    */
+   /* from the stream.  If the block is short the rest is concealed and */
+   /* an underrun is counted, and the frames after an underrun are faded*/
+   /* back in.  It must be called by the reader for every output block. */
+void AUDIOJB_Conceal(AUDIOJB_Buffer_t *JitterBuffer, unsigned int Produced, unsigned int Frames, short *Output)
+{
+   unsigned int Index;
+   unsigned int Channel;
+   long         Gain;
+   short       *Sample;
+
+   if((JitterBuffer) && (Output) && (Produced <= Frames))
+   {
+      if(Produced)
+      {
+         /* The stream fades back in from the gain the fade out reached.*/
+         if(JitterBuffer->Concealing)
+         {
+            JitterBuffer->Concealing = 0;
+            JitterBuffer->Fade       = AUDIOJB_FADE_FRAMES - JitterBuffer->Fade;
+         }
+
+         for(Index = 0, Sample = Output; (Index < Produced) && (JitterBuffer->Fade); Index++, JitterBuffer->Fade--)
+         {
+            Gain = (long)(AUDIOJB_FADE_FRAMES - JitterBuffer->Fade) << (15 - AUDIOJB_FADE_SHIFT);
+
+            for(Channel = 0; Channel < AUDIOJB_CHANNELS; Channel++, Sample++)
+               *Sample = (short)((*Sample * Gain) >> 15);
+         }
+
+         SaveLast(JitterBuffer, Produced, Output);
+      }
+
+      if(Produced < Frames)
+      {
+         /* The fade out starts from the gain the fade in reached.      */
+         if(JitterBuffer->Playing)
+         {
+            JitterBuffer->Statistics.Underruns++;
+
+            JitterBuffer->Playing    = 0;
+            JitterBuffer->Concealing = 1;
+            JitterBuffer->Fade       = AUDIOJB_FADE_FRAMES - JitterBuffer->Fade;
+         }
+
+         for(Index = Produced, Sample = &Output[Produced * AUDIOJB_CHANNELS]; Index < Frames; Index++)
+         {
+            if((JitterBuffer->Concealing) && (JitterBuffer->Fade))
+            {
+               Gain = (long)JitterBuffer->Fade << (15 - AUDIOJB_FADE_SHIFT);
+
+               for(Channel = 0; Channel < AUDIOJB_CHANNELS; Channel++, Sample++)
+                  *Sample = (short)((JitterBuffer->Last[(JitterBuffer->Repeat * AUDIOJB_CHANNELS) + Channel] * Gain) >> 15);
+
+               JitterBuffer->Repeat = (JitterBuffer->Repeat + 1) & (AUDIOJB_CONCEAL_FRAMES - 1);
+               JitterBuffer->Fade--;
+
+               JitterBuffer->Statistics.ConcealedFrames++;
+            }
+            else
+            {
+               for(Channel = 0; Channel < AUDIOJB_CHANNELS; Channel++, Sample++)
+                  *Sample = 0;
+            }
+         }
+      }
+   }
+}
+
+   /* The following function returns the statistics of the specified    */
+   /* jitter buffer in the specified structure.                         */
+void AUDIOJB_Query_Statistics(AUDIOJB_Buffer_t *JitterBuffer, AUDIOJB_Statistics_t *Statistics)
+{
+   if((JitterBuffer) && (Statistics))
+   {
+      *Statistics             = JitterBuffer->Statistics;
+      Statistics->Jitter      = JitterBuffer->Peak;
+      Statistics->Depth       = AUDIOJB_Depth(JitterBuffer);
+      Statistics->TargetDepth = JitterBuffer->TargetFrames;
+   }
+}
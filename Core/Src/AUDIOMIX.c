@@ -0,0 +1,231 @@
+/*****< audiomix.c >***********************************************************/
+/*                                                                            */
+/*  AUDIOMIX - Mixer of the audio streams.                                    */
+/*                                                                            */
+/******************************************************************************/
+
+#include <string.h>
+
+#include "AUDIOMIX.h"       /* Audio Mixer Prototypes/Constants.              */
+#include "AUDIOSIMD.h"      /* Audio SIMD Instructions.                       */
+
+   /* The following constants represent the number of fraction bits of  */
+   /* the gains of the mixer beyond Q14, and the shift and rounding that*/
+   /* bring the sum of the scaled samples back to 16 bits.              */
+#define GAIN_SHIFT               16
+#define MIX_SHIFT                14
+#define MIX_ROUNDING             (1L << (MIX_SHIFT - 1))
+
+   /* Local Function Prototypes.                                        */
+static void AdvanceFade(AUDIOMIX_Mixer_t *Mixer);
+static void MixBlock(AUDIOMIX_Mixer_t *Mixer, unsigned int Frames, const short * const *Inputs, unsigned int Offset, short *Output);
+
+   /* The following function advances the fade of the specified mixer by*/
+   /* one frame.  The gains are set to their targets exactly at the end */
+   /* of the fade.                                                      */
+static void AdvanceFade(AUDIOMIX_Mixer_t *Mixer)
+{
+   unsigned int Source;
+
+   Mixer->Remaining--;
+
+   for(Source = 0; Source < Mixer->Sources; Source++)
+   {
+      if(Mixer->Remaining)
+         Mixer->Gain[Source] += Mixer->Step[Source];
+      else
+         Mixer->Gain[Source]  = (long)Mixer->Target[Source] << GAIN_SHIFT;
+   }
+}
+
+   /* The following function mixes the specified number of frames of the*/
+   /* sources, starting at the specified frame, with the current gains. */
+   /* Only the sources that are heard are mixed: none clears the output */
+   /* and a lone source at unity gain is copied.  Otherwise the sources */
+   /* are taken in pairs (an odd source is paired with itself at no     */
+   /* gain), the left and the right samples of a pair are packed        */
+   /* together and scaled by the packed gains of the pair.              */
+static void MixBlock(AUDIOMIX_Mixer_t *Mixer, unsigned int Frames, const short * const *Inputs, unsigned int Offset, short *Output)
+{
+   unsigned int  Source;
+   unsigned int  Active;
+   unsigned int  Pair;
+   unsigned int  Index;
+   long          Gain[AUDIOMIX_MAXIMUM_SOURCES];
+   uint32_t      Gains[AUDIOMIX_MAXIMUM_SOURCES / 2];
+   uint32_t      First;
+   uint32_t      Second;
+   uint64_t      Left;
+   uint64_t      Right;
+   const short  *Samples[AUDIOMIX_MAXIMUM_SOURCES];
+
+   for(Source = 0, Active = 0; Source < Mixer->Sources; Source++)
+   {
+      if((Inputs[Source]) && (Mixer->Gain[Source] >> GAIN_SHIFT))
+      {
+         Samples[Active] = &Inputs[Source][Offset * AUDIOMIX_CHANNELS];
+         Gain[Active++]  = Mixer->Gain[Source] >> GAIN_SHIFT;
+      }
+   }
+
+   Output = &Output[Offset * AUDIOMIX_CHANNELS];
+
+   if(!Active)
+      memset(Output, 0, (Frames * AUDIOMIX_CHANNELS * sizeof(short)));
+   else
+   {
+      if((Active == 1) && (Gain[0] == AUDIOMIX_UNITY_GAIN))
+      {
+         if(Samples[0] != Output)
+            memmove(Output, Samples[0], (Frames * AUDIOMIX_CHANNELS * sizeof(short)));
+      }
+      else
+      {
+         if(Active & 1)
+         {
+            Samples[Active] = Samples[0];
+            Gain[Active++]  = 0;
+         }
+
+         for(Pair = 0; Pair < (Active / 2); Pair++)
+            Gains[Pair] = AUDIOSIMD_PACK(Gain[Pair * 2], Gain[(Pair * 2) + 1]);
+
+         /* Each frame is read from every source before it is written,  */
+         /* so the output may be one of the sources.                    */
+         for(Index = 0; Index < (Frames * AUDIOMIX_CHANNELS); Index += AUDIOMIX_CHANNELS)
+         {
+            Left  = (uint64_t)MIX_ROUNDING;
+            Right = (uint64_t)MIX_ROUNDING;
+
+            for(Pair = 0; Pair < (Active / 2); Pair++)
+            {
+               First  = AUDIOSIMD_Read2(&Samples[Pair * 2][Index]);
+               Second = AUDIOSIMD_Read2(&Samples[(Pair * 2) + 1][Index]);
+
+               Left   = __SMLALD(__PKHBT(First, Second, 16), Gains[Pair], Left);
+               Right  = __SMLALD(__PKHTB(Second, First, 16), Gains[Pair], Right);
+            }
+
+            Output[Index]     = (short)__SSAT((int32_t)((int64_t)Left >> MIX_SHIFT), 16);
+            Output[Index + 1] = (short)__SSAT((int32_t)((int64_t)Right >> MIX_SHIFT), 16);
+         }
+      }
+   }
+}
+
+   /* The following function initializes the specified mixer for the    */
+   /* specified number of sources, with a fade of the specified number  */
+   /* of frames (at least one).  Every source starts muted.  This       */
+   /* function returns zero if successful or a negative value if a      */
+   /* parameter is not valid.                                           */
+int AUDIOMIX_Initialize(AUDIOMIX_Mixer_t *Mixer, unsigned int Sources, unsigned int FadeFrames)
+{
+   int ret_val;
+
+   if((Mixer) && (Sources) && (Sources <= AUDIOMIX_MAXIMUM_SOURCES) && (FadeFrames))
+   {
+      memset(Mixer, 0, sizeof(AUDIOMIX_Mixer_t));
+
+      Mixer->Sources    = Sources;
+      Mixer->FadeFrames = FadeFrames;
+
+      ret_val           = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function sets the gain (Q14, at most                */
+   /* AUDIOMIX_MAXIMUM_GAIN) of the specified source of the specified   */
+   /* mixer.  A fade of every source from its current gain to its target*/
+   /* starts with the next frame (the fade of a previous change is not  */
+   /* completed first).                                                 */
+void AUDIOMIX_SetGain(AUDIOMIX_Mixer_t *Mixer, unsigned int Source, unsigned int Gain)
+{
+   unsigned int Index;
+
+   if((Mixer) && (Source < Mixer->Sources))
+   {
+      Mixer->Target[Source] = (Gain > AUDIOMIX_MAXIMUM_GAIN) ? AUDIOMIX_MAXIMUM_GAIN : Gain;
+
+      /* The step is rounded towards zero, so no gain overshoots its    */
+      /* target before the end of the fade.                             */
+      for(Index = 0; Index < Mixer->Sources; Index++)
+         Mixer->Step[Index] = (((long)Mixer->Target[Index] << GAIN_SHIFT) - Mixer->Gain[Index]) / (long)Mixer->FadeFrames;
+
+      Mixer->Remaining = Mixer->FadeFrames;
+   }
+}
+
+   /* The following function returns non-zero if the specified source of*/
+   /* the specified mixer is heard (or will be by the end of the fade). */
+int AUDIOMIX_IsAudible(AUDIOMIX_Mixer_t *Mixer, unsigned int Source)
+{
+   int ret_val;
+
+   if((Mixer) && (Source < Mixer->Sources))
+      ret_val = ((Mixer->Gain[Source] >> GAIN_SHIFT) || (Mixer->Target[Source]));
+   else
+      ret_val = 0;
+
+   return(ret_val);
+}
+
+   /* The following function mixes the specified number of frames of the*/
+   /* specified sources into the specified output.  The gains change    */
+   /* with every frame of a fade, so a fade is mixed one frame at a     */
+   /* time and the rest of the frames as one block.                     */
+void AUDIOMIX_Process(AUDIOMIX_Mixer_t *Mixer, unsigned int Frames, const short * const *Inputs, short *Output)
+{
+   unsigned int Offset;
+
+   if((Mixer) && (Inputs) && (Output))
+   {
+      for(Offset = 0; (Offset < Frames) && (Mixer->Remaining); Offset++)
+      {
+         MixBlock(Mixer, 1, Inputs, Offset, Output);
+
+         AdvanceFade(Mixer);
+      }
+
+      if(Offset < Frames)
+         MixBlock(Mixer, (Frames - Offset), Inputs, Offset, Output);
+   }
+}
+
+   /* The following function is the reference version of                */
+   /* AUDIOMIX_Process().  Each sample is the rounded sum of the scaled */
+   /* samples of every source, saturated to 16 bits.                    */
+void AUDIOMIX_ProcessReference(AUDIOMIX_Mixer_t *Mixer, unsigned int Frames, const short * const *Inputs, short *Output)
+{
+   unsigned int Index;
+   unsigned int Channel;
+   unsigned int Source;
+   long long    Sum;
+
+   if((Mixer) && (Inputs) && (Output))
+   {
+      for(Index = 0; Index < (Frames * AUDIOMIX_CHANNELS); Index += AUDIOMIX_CHANNELS)
+      {
+         for(Channel = 0; Channel < AUDIOMIX_CHANNELS; Channel++)
+         {
+            Sum = MIX_ROUNDING;
+
+            for(Source = 0; Source < Mixer->Sources; Source++)
+            {
+               if(Inputs[Source])
+                  Sum += (long long)Inputs[Source][Index + Channel] * (Mixer->Gain[Source] >> GAIN_SHIFT);
+            }
+
+            Sum >>= MIX_SHIFT;
+
+            Output[Index + Channel] = (short)((Sum > 32767) ? 32767 : ((Sum < -32768) ? -32768 : Sum));
+         }
+
+         if(Mixer->Remaining)
+            AdvanceFade(Mixer);
+      }
+   }
+}
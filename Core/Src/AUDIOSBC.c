@@ -0,0 +1,723 @@
+/*****< audiosbc.c >***********************************************************/
+/*                                                                            */
+/*  AUDIOSBC - SBC decoder of the audio stream.                               */
+/*                                                                            */
+/******************************************************************************/
+
+#include <string.h>
+
+#include "AUDIOSBC.h"       /* Audio SBC Decoder Prototypes/Constants.        */
+#include "AUDIOSIMD.h"      /* Audio SIMD Instructions.                       */
+
+   /* The following constants represent the polynomial and the initial  */
+   /* value of the CRC of an SBC frame, and the bit of the frame at     */
+   /* which the joint stereo flags (or the scale factors) start.        */
+#define CRC_POLYNOMIAL           0x1D
+#define CRC_INITIAL_VALUE        0x0F
+#define CRC_START_BIT            (AUDIOSBC_HEADER_LENGTH * 8)
+
+   /* The following constants represent the number of bits of the       */
+   /* subband samples (relative to the largest scale factor of the      */
+   /* frame), the shift of the matrixing that leaves the samples of the */
+   /* windowing at half the scale of the output (so they may exceed it),*/
+   /* and the shift of the windowing (its coefficients are Q14).        */
+#define SUBBAND_BITS             13
+#define MATRIX_SHIFT             (15 + SUBBAND_BITS + 1)
+#define WINDOW_SHIFT             13
+
+   /* The following structure holds the position of a reader of the     */
+   /* bits of a frame (which is Length bytes long).                     */
+typedef struct _tagBitReader_t
+{
+   const unsigned char *Data;
+   unsigned int         Length;
+   unsigned int         Position;
+} BitReader_t;
+
+   /* The following table holds the sample rates of the frequency field */
+   /* of the header.                                                    */
+static const unsigned long SampleRates[4] = { 16000, 32000, 44100, 48000 };
+
+   /* The following tables hold the offsets of the loudness allocation  */
+   /* for each frequency and subband (from the A2DP specification).     */
+static const signed char Offset4[4][4] =
+{
+   { -1, 0, 0, 0 },
+   { -2, 0, 0, 1 },
+   { -2, 0, 0, 1 },
+   { -2, 0, 0, 1 }
+};
+
+static const signed char Offset8[4][8] =
+{
+   { -2, 0, 0, 0, 0, 0, 0, 1 },
+   { -3, 0, 0, 0, 0, 0, 1, 2 },
+   { -4, 0, 0, 0, 0, 0, 1, 2 },
+   { -4, 0, 0, 0, 0, 0, 1, 2 }
+};
+
+   /* The following tables hold the matrixing coefficients (Q15) of 4   */
+   /* and 8 subbands: row k holds cos((i + 0.5)(k + M/2)pi/M) for each  */
+   /* subband i of the M subbands.                                      */
+static const short Matrix4[8][4] =
+{
+   {  23170, -23170, -23170,  23170 },
+   {  12540, -30274,  30274, -12540 },
+   {      0,      0,      0,      0 },
+   { -12540,  30274, -30274,  12540 },
+   { -23170,  23170,  23170, -23170 },
+   { -30274, -12540,  12540,  30274 },
+   { -32768, -32768, -32768, -32768 },
+   { -30274, -12540,  12540,  30274 }
+};
+
+static const short Matrix8[16][8] =
+{
+   {  23170, -23170, -23170,  23170,  23170, -23170, -23170,  23170 },
+   {  18205, -32138,   6393,  27246, -27246,  -6393,  32138, -18205 },
+   {  12540, -30274,  30274, -12540, -12540,  30274, -30274,  12540 },
+   {   6393, -18205,  27246, -32138,  32138, -27246,  18205,  -6393 },
+   {      0,      0,      0,      0,      0,      0,      0,      0 },
+   {  -6393,  18205, -27246,  32138, -32138,  27246, -18205,   6393 },
+   { -12540,  30274, -30274,  12540,  12540, -30274,  30274, -12540 },
+   { -18205,  32138,  -6393, -27246,  27246,   6393, -32138,  18205 },
+   { -23170,  23170,  23170, -23170, -23170,  23170,  23170, -23170 },
+   { -27246,   6393,  32138,  18205, -18205, -32138,  -6393,  27246 },
+   { -30274, -12540,  12540,  30274,  30274,  12540, -12540, -30274 },
+   { -32138, -27246, -18205,  -6393,   6393,  18205,  27246,  32138 },
+   { -32768, -32768, -32768, -32768, -32768, -32768, -32768, -32768 },
+   { -32138, -27246, -18205,  -6393,   6393,  18205,  27246,  32138 },
+   { -30274, -12540,  12540,  30274,  30274,  12540, -12540, -30274 },
+   { -27246,   6393,  32138,  18205, -18205, -32138,  -6393,  27246 }
+};
+
+   /* The following tables hold the windowing coefficients (Q14) of 4   */
+   /* and 8 subbands: the prototype filter of the A2DP specification    */
+   /* (Proto_4_40 and Proto_8_80) scaled by -M.  Row j holds the        */
+   /* coefficients of output sample j in the order of its history,      */
+   /* i.e. D[j + M * (9 - t)] for tap t (oldest first).                 */
+static const short Window4[4][AUDIOSBC_TAPS] =
+{
+   {   -251,    715,  -1696,   8886, -19288,  -8886,  -1696,   -715,   -251,      0 },
+   {   -179,    201,  -2110,   5089, -18470, -12779,   -402,  -1339,   -255,    -35 },
+   {    -98,   -122,  -1892,   1889, -16164, -16164,   1889,  -1892,   -122,    -98 },
+   {    -35,   -255,  -1339,   -402, -12779, -18470,   5089,  -2110,    201,   -179 }
+};
+
+static const short Window8[8][AUDIOSBC_TAPS] =
+{
+   {   -264,    742,  -1696,   8913, -19262,  -8913,  -1696,   -742,   -264,      0 },
+   {   -234,    458,  -2008,   6971, -19057, -10877,  -1161,  -1052,   -276,    -21 },
+   {   -194,    216,  -2126,   5122, -18449, -12789,   -383,  -1371,   -261,    -45 },
+   {   -149,     23,  -2085,   3422, -17467, -14575,    644,  -1671,   -212,    -73 },
+   {   -108,   -118,  -1921,   1919, -16157, -16157,   1919,  -1921,   -118,   -108 },
+   {    -73,   -212,  -1671,    644, -14575, -17467,   3422,  -2085,     23,   -149 },
+   {    -45,   -261,  -1371,   -383, -12789, -18449,   5122,  -2126,    216,   -194 },
+   {    -21,   -276,  -1052,  -1161, -10877, -19057,   6971,  -2008,    458,   -234 }
+};
+
+   /* Local Function Prototypes.                                        */
+static unsigned int ReadBits(BitReader_t *Reader, unsigned int Bits);
+static unsigned char ComputeCRC(const unsigned char *Data, unsigned int Bits);
+static void AllocateBits(const AUDIOSBC_Format_t *Format, unsigned int Frequency, unsigned int Channels, const unsigned char ScaleFactors[][AUDIOSBC_MAXIMUM_SUBBANDS], unsigned char Bits[][AUDIOSBC_MAXIMUM_SUBBANDS]);
+static int ReadFrame(AUDIOSBC_Decoder_t *Decoder, const unsigned char *Data, unsigned int Length, unsigned int *Shift);
+static short RoundSample(int64_t Value, unsigned int Shift);
+static void SynthesizeBlock(AUDIOSBC_Decoder_t *Decoder, unsigned int Block, unsigned int Shift, short *Output);
+static void SynthesizeBlockReference(AUDIOSBC_Decoder_t *Decoder, unsigned int Block, unsigned int Shift, short *Output);
+static void CompleteFrame(AUDIOSBC_Decoder_t *Decoder, unsigned int *Frames, short *Output);
+
+   /* The following function reads the specified number of bits (at most*/
+   /* 16) from the specified reader, most significant bit first.  The   */
+   /* bytes after the end of the frame are read as zero.                */
+static unsigned int ReadBits(BitReader_t *Reader, unsigned int Bits)
+{
+   unsigned int  Index;
+   unsigned long Word;
+
+   Index = Reader->Position >> 3;
+   Word  = (unsigned long)Reader->Data[Index] << 16;
+
+   if((Index + 1) < Reader->Length)
+      Word |= (unsigned long)Reader->Data[Index + 1] << 8;
+
+   if((Index + 2) < Reader->Length)
+      Word |= (unsigned long)Reader->Data[Index + 2];
+
+   Word              = (Word >> (24 - (Reader->Position & 7) - Bits)) & ((1UL << Bits) - 1);
+   Reader->Position += Bits;
+
+   return((unsigned int)Word);
+}
+
+   /* The following function returns the CRC of an SBC frame: that of   */
+   /* the two bytes after the sync word followed by the specified number*/
+   /* of bits from CRC_START_BIT (the joint stereo flags and the scale  */
+   /* factors).                                                         */
+static unsigned char ComputeCRC(const unsigned char *Data, unsigned int Bits)
+{
+   unsigned int  Index;
+   unsigned int  Bit;
+   unsigned char ret_val;
+
+   ret_val = CRC_INITIAL_VALUE;
+
+   for(Index = 8; Index < (CRC_START_BIT + Bits); Index++)
+   {
+      /* The CRC byte itself is not covered.                            */
+      if(Index == 24)
+         Index = CRC_START_BIT;
+
+      Bit     = (Data[Index >> 3] >> (7 - (Index & 7))) & 1;
+      Bit    ^= (ret_val >> 7);
+      ret_val = (unsigned char)(ret_val << 1);
+
+      if(Bit)
+         ret_val ^= CRC_POLYNOMIAL;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function computes the number of bits of each        */
+   /* subband of the specified number of channels, which share the bit  */
+   /* pool (the bit allocation of the A2DP specification).  The bits    */
+   /* that are left over are given to the subbands in order, and to the */
+   /* channels in turn within each subband.                             */
+static void AllocateBits(const AUDIOSBC_Format_t *Format, unsigned int Frequency, unsigned int Channels, const unsigned char ScaleFactors[][AUDIOSBC_MAXIMUM_SUBBANDS], unsigned char Bits[][AUDIOSBC_MAXIMUM_SUBBANDS])
+{
+   int          BitNeed[AUDIOSBC_CHANNELS][AUDIOSBC_MAXIMUM_SUBBANDS];
+   int          MaximumBitNeed;
+   int          Loudness;
+   int          BitSlice;
+   int          BitCount;
+   int          SliceCount;
+   int          Bitpool;
+   unsigned int Channel;
+   unsigned int Subband;
+   unsigned int Index;
+
+   MaximumBitNeed = 0;
+   Bitpool        = (int)Format->Bitpool;
+
+   for(Channel = 0; Channel < Channels; Channel++)
+   {
+      for(Subband = 0; Subband < Format->Subbands; Subband++)
+      {
+         if(Format->AllocationMethod == AUDIOSBC_ALLOCATION_SNR)
+            BitNeed[Channel][Subband] = ScaleFactors[Channel][Subband];
+         else
+         {
+            if(!ScaleFactors[Channel][Subband])
+               BitNeed[Channel][Subband] = -5;
+            else
+            {
+               if(Format->Subbands == 4)
+                  Loudness = (int)ScaleFactors[Channel][Subband] - Offset4[Frequency][Subband];
+               else
+                  Loudness = (int)ScaleFactors[Channel][Subband] - Offset8[Frequency][Subband];
+
+               BitNeed[Channel][Subband] = (Loudness > 0) ? (Loudness / 2) : Loudness;
+            }
+         }
+
+         if(BitNeed[Channel][Subband] > MaximumBitNeed)
+            MaximumBitNeed = BitNeed[Channel][Subband];
+      }
+   }
+
+   /* Lower the slice until the bit pool is used up.                    */
+   BitCount   = 0;
+   SliceCount = 0;
+   BitSlice   = MaximumBitNeed + 1;
+
+   do
+   {
+      BitSlice--;
+      BitCount   += SliceCount;
+      SliceCount  = 0;
+
+      for(Channel = 0; Channel < Channels; Channel++)
+      {
+         for(Subband = 0; Subband < Format->Subbands; Subband++)
+         {
+            if((BitNeed[Channel][Subband] > (BitSlice + 1)) && (BitNeed[Channel][Subband] < (BitSlice + 16)))
+               SliceCount++;
+            else
+            {
+               if(BitNeed[Channel][Subband] == (BitSlice + 1))
+                  SliceCount += 2;
+            }
+         }
+      }
+   } while((BitCount + SliceCount) < Bitpool);
+
+   if((BitCount + SliceCount) == Bitpool)
+   {
+      BitCount += SliceCount;
+      BitSlice--;
+   }
+
+   for(Channel = 0; Channel < Channels; Channel++)
+   {
+      for(Subband = 0; Subband < Format->Subbands; Subband++)
+      {
+         if(BitNeed[Channel][Subband] < (BitSlice + 2))
+            Bits[Channel][Subband] = 0;
+         else
+         {
+            Loudness               = BitNeed[Channel][Subband] - BitSlice;
+            Bits[Channel][Subband] = (unsigned char)((Loudness > 16) ? 16 : Loudness);
+         }
+      }
+   }
+
+   /* Give the rest of the bit pool first to the subbands that already  */
+   /* have bits (or just missed the slice), then to any subband.        */
+   for(Index = 0; (BitCount < Bitpool) && (Index < (Format->Subbands * Channels)); Index++)
+   {
+      Channel = Index % Channels;
+      Subband = Index / Channels;
+
+      if((Bits[Channel][Subband] >= 2) && (Bits[Channel][Subband] < 16))
+      {
+         Bits[Channel][Subband]++;
+         BitCount++;
+      }
+      else
+      {
+         if((BitNeed[Channel][Subband] == (BitSlice + 1)) && (Bitpool > (BitCount + 1)))
+         {
+            Bits[Channel][Subband]  = 2;
+            BitCount               += 2;
+         }
+      }
+   }
+
+   for(Index = 0; (BitCount < Bitpool) && (Index < (Format->Subbands * Channels)); Index++)
+   {
+      Channel = Index % Channels;
+      Subband = Index / Channels;
+
+      if(Bits[Channel][Subband] < 16)
+      {
+         Bits[Channel][Subband]++;
+         BitCount++;
+      }
+   }
+}
+
+   /* The following function checks the SBC frame at the start of the   */
+   /* specified data and reads its subband samples.  Each sample is held*/
+   /* in SUBBAND_BITS + 1 bits relative to the largest scale factor of  */
+   /* the frame (plus a bit of headroom for joint stereo), the shift    */
+   /* that brings the matrixing back to half the scale of the output is */
+   /* returned in the final parameter.  This function returns the length*/
+   /* of the frame, with the shift set to zero if its CRC did not match,*/
+   /* or a negative value if the data does not start with a valid frame.*/
+static int ReadFrame(AUDIOSBC_Decoder_t *Decoder, const unsigned char *Data, unsigned int Length, unsigned int *Shift)
+{
+   int               ret_val;
+   unsigned int      Channel;
+   unsigned int      Subband;
+   unsigned int      Block;
+   unsigned int      Join;
+   unsigned int      Maximum;
+   int               Scale;
+   unsigned long     Levels[AUDIOSBC_CHANNELS][AUDIOSBC_MAXIMUM_SUBBANDS];
+   long              Sample;
+   long              Difference;
+   unsigned char     ScaleFactors[AUDIOSBC_CHANNELS][AUDIOSBC_MAXIMUM_SUBBANDS];
+   unsigned char     Bits[AUDIOSBC_CHANNELS][AUDIOSBC_MAXIMUM_SUBBANDS];
+   BitReader_t       Reader;
+   AUDIOSBC_Format_t Format;
+
+   *Shift = 0;
+
+   if((ret_val = AUDIOSBC_ParseHeader(Data, Length, &Format)) > 0)
+   {
+      /* A new filter bank starts from silence.                         */
+      if((Format.Subbands != Decoder->Format.Subbands) || (Format.Channels != Decoder->Format.Channels))
+      {
+         memset(&(Decoder->History), 0, sizeof(Decoder->History));
+
+         Decoder->Position = 0;
+         Decoder->Parity   = 0;
+      }
+
+      Decoder->Format = Format;
+
+      Reader.Data     = Data;
+      Reader.Length   = Format.FrameLength;
+      Reader.Position = CRC_START_BIT;
+
+      /* The flag of the last subband is always clear.                  */
+      Join            = 0;
+
+      if(Format.ChannelMode == AUDIOSBC_CHANNEL_MODE_JOINT_STEREO)
+         Join = ReadBits(&Reader, Format.Subbands) & ~1U;
+
+      Maximum = 0;
+
+      for(Channel = 0; Channel < Format.Channels; Channel++)
+      {
+         for(Subband = 0; Subband < Format.Subbands; Subband++)
+         {
+            ScaleFactors[Channel][Subband] = (unsigned char)ReadBits(&Reader, 4);
+
+            if(ScaleFactors[Channel][Subband] > Maximum)
+               Maximum = ScaleFactors[Channel][Subband];
+         }
+      }
+
+      if(ComputeCRC(Data, (Reader.Position - CRC_START_BIT)) == Data[3])
+      {
+         /* Mono and dual channel frames allocate the bit pool to each  */
+         /* channel, stereo frames share it between the channels.       */
+         if((Format.ChannelMode == AUDIOSBC_CHANNEL_MODE_MONO) || (Format.ChannelMode == AUDIOSBC_CHANNEL_MODE_DUAL_CHANNEL))
+         {
+            for(Channel = 0; Channel < Format.Channels; Channel++)
+               AllocateBits(&Format, (Data[1] >> 6), 1, &ScaleFactors[Channel], &Bits[Channel]);
+         }
+         else
+            AllocateBits(&Format, (Data[1] >> 6), AUDIOSBC_CHANNELS, ScaleFactors, Bits);
+
+         for(Channel = 0; Channel < Format.Channels; Channel++)
+         {
+            for(Subband = 0; Subband < Format.Subbands; Subband++)
+               Levels[Channel][Subband] = (1UL << Bits[Channel][Subband]) - 1;
+         }
+
+         /* A sample of a subband is scalefactor * ((2 * q + 1) / levels*/
+         /* - 1) with a scalefactor of 2^(factor + 1).  It is rounded to*/
+         /* SUBBAND_BITS + 1 bits (the numerator fits in 32 bits).  A   */
+         /* subband whose scale factor is more than SUBBAND_BITS + 1    */
+         /* below the largest is under half of the last bit, so it is 0.*/
+         for(Block = 0; Block < Format.Blocks; Block++)
+         {
+            for(Channel = 0; Channel < Format.Channels; Channel++)
+            {
+               for(Subband = 0; Subband < Format.Subbands; Subband++)
+               {
+                  if(Bits[Channel][Subband])
+                  {
+                     Scale  = (int)ScaleFactors[Channel][Subband] + SUBBAND_BITS + 1 - (int)Maximum;
+                     Sample = (long)ReadBits(&Reader, Bits[Channel][Subband]);
+
+                     if(Scale >= 0)
+                        Sample = (long)((((((unsigned long)Sample << 1) | 1UL) << Scale) + (Levels[Channel][Subband] >> 1)) / Levels[Channel][Subband]) - (1L << Scale);
+                     else
+                        Sample = 0;
+
+                     Decoder->Subband[Block][Channel][Subband] = (short)Sample;
+                  }
+                  else
+                     Decoder->Subband[Block][Channel][Subband] = 0;
+               }
+            }
+
+            /* The joint subbands hold the sum and the difference.      */
+            for(Subband = 0; Subband < Format.Subbands; Subband++)
+            {
+               if(Join & (1U << (Format.Subbands - 1 - Subband)))
+               {
+                  Sample                                    = Decoder->Subband[Block][0][Subband];
+                  Difference                                = Decoder->Subband[Block][1][Subband];
+
+                  Decoder->Subband[Block][0][Subband]       = (short)(Sample + Difference);
+                  Decoder->Subband[Block][1][Subband]       = (short)(Sample - Difference);
+               }
+            }
+         }
+
+         *Shift = MATRIX_SHIFT - Maximum;
+
+         Decoder->Statistics.Frames++;
+      }
+      else
+         Decoder->Statistics.CRCErrors++;
+   }
+   else
+      Decoder->Statistics.InvalidFrames++;
+
+   return(ret_val);
+}
+
+   /* The following function rounds the specified sum to a 16 bit sample*/
+   /* after the specified shift, saturating it.                         */
+static short RoundSample(int64_t Value, unsigned int Shift)
+{
+   Value = (Value + ((int64_t)1 << (Shift - 1))) >> Shift;
+
+   return((short)((Value > 32767) ? 32767 : ((Value < -32768) ? -32768 : Value)));
+}
+
+   /* The following function synthesizes the output samples of the      */
+   /* specified block of the frame.  The matrixing writes the first half*/
+   /* of the block to the sequences of this block's parity (where the   */
+   /* windowing reads it now and in every other block after it) and the */
+   /* second half to those of the other parity (where it is read in the */
+   /* blocks in between).  Both stages take two samples at a time.      */
+static void SynthesizeBlock(AUDIOSBC_Decoder_t *Decoder, unsigned int Block, unsigned int Shift, short *Output)
+{
+   const short  *Matrix;
+   const short  *Window;
+   const short  *Subband;
+   short        *History;
+   unsigned int  Subbands;
+   unsigned int  Channel;
+   unsigned int  Row;
+   unsigned int  Index;
+   unsigned int  Position;
+   uint32_t      Samples[AUDIOSBC_MAXIMUM_SUBBANDS / 2];
+   uint64_t      Sum;
+   short         Value;
+
+   Subbands = Decoder->Format.Subbands;
+   Matrix   = (Subbands == 4) ? Matrix4[0] : Matrix8[0];
+   Window   = (Subbands == 4) ? Window4[0] : Window8[0];
+   Position = Decoder->Position + 1;
+
+   if(Position == AUDIOSBC_TAPS)
+      Position = 0;
+
+   for(Channel = 0; Channel < Decoder->Format.Channels; Channel++)
+   {
+      Subband = Decoder->Subband[Block][Channel];
+
+      for(Index = 0; Index < Subbands; Index += 2)
+         Samples[Index / 2] = AUDIOSIMD_Read2(&Subband[Index]);
+
+      for(Row = 0; Row < (Subbands * 2); Row++)
+      {
+         Sum = 0;
+
+         for(Index = 0; Index < Subbands; Index += 2)
+            Sum = __SMLALD(Samples[Index / 2], AUDIOSIMD_Read2(&Matrix[(Row * Subbands) + Index]), Sum);
+
+         Value   = RoundSample((int64_t)Sum, Shift);
+
+         if(Row < Subbands)
+            History = Decoder->History.Window[Channel][Decoder->Parity][Row];
+         else
+            History = Decoder->History.Window[Channel][Decoder->Parity ^ 1][Row - Subbands];
+
+         History[Decoder->Position]                 = Value;
+         History[Decoder->Position + AUDIOSBC_TAPS] = Value;
+      }
+
+      for(Row = 0; Row < Subbands; Row++)
+      {
+         History = &(Decoder->History.Window[Channel][Decoder->Parity][Row][Position]);
+         Sum     = 0;
+
+         for(Index = 0; Index < AUDIOSBC_TAPS; Index += 2)
+            Sum = __SMLALD(AUDIOSIMD_Read2(&History[Index]), AUDIOSIMD_Read2(&Window[(Row * AUDIOSBC_TAPS) + Index]), Sum);
+
+         Output[(Row * AUDIOSBC_CHANNELS) + Channel] = RoundSample((int64_t)Sum, WINDOW_SHIFT);
+      }
+   }
+
+   Decoder->Position  = Position;
+   Decoder->Parity   ^= 1;
+}
+
+   /* The following function is the reference version of                */
+   /* SynthesizeBlock(), which follows the A2DP specification: the      */
+   /* history V of 20 * M samples is shifted by 2 * M, the new samples  */
+   /* are matrixed into its start and each output sample j is the sum   */
+   /* of U[j + M * i] * D[j + M * i], where U takes the samples of V    */
+   /* that the windowing needs.                                         */
+static void SynthesizeBlockReference(AUDIOSBC_Decoder_t *Decoder, unsigned int Block, unsigned int Shift, short *Output)
+{
+   const short  *Matrix;
+   const short  *Window;
+   short        *V;
+   unsigned int  Subbands;
+   unsigned int  Channel;
+   unsigned int  Row;
+   unsigned int  Index;
+   unsigned int  Tap;
+   unsigned int  Sample;
+   int64_t       Sum;
+
+   Subbands = Decoder->Format.Subbands;
+   Matrix   = (Subbands == 4) ? Matrix4[0] : Matrix8[0];
+   Window   = (Subbands == 4) ? Window4[0] : Window8[0];
+
+   for(Channel = 0; Channel < Decoder->Format.Channels; Channel++)
+   {
+      V = Decoder->History.Reference[Channel];
+
+      memmove(&V[Subbands * 2], V, (Subbands * 18 * sizeof(short)));
+
+      for(Row = 0; Row < (Subbands * 2); Row++)
+      {
+         Sum = 0;
+
+         for(Index = 0; Index < Subbands; Index++)
+            Sum += (int64_t)Decoder->Subband[Block][Channel][Index] * Matrix[(Row * Subbands) + Index];
+
+         V[Row] = RoundSample(Sum, Shift);
+      }
+
+      for(Row = 0; Row < Subbands; Row++)
+      {
+         Sum = 0;
+
+         for(Tap = 0; Tap < AUDIOSBC_TAPS; Tap++)
+         {
+            /* U[j + M * i] is V[j + 2M * i] for even i and             */
+            /* V[j + M + 2M * i] for odd i.                             */
+            Sample  = Row + (Subbands * 2 * Tap) + ((Tap & 1) ? Subbands : 0);
+            Sum    += (int64_t)V[Sample] * Window[(Row * AUDIOSBC_TAPS) + (AUDIOSBC_TAPS - 1 - Tap)];
+         }
+
+         Output[(Row * AUDIOSBC_CHANNELS) + Channel] = RoundSample(Sum, WINDOW_SHIFT);
+      }
+   }
+}
+
+   /* The following function completes the output of a frame that has   */
+   /* been synthesized: a mono frame is copied to the second channel.   */
+static void CompleteFrame(AUDIOSBC_Decoder_t *Decoder, unsigned int *Frames, short *Output)
+{
+   unsigned int Index;
+
+   *Frames = Decoder->Format.Blocks * Decoder->Format.Subbands;
+
+   if(Decoder->Format.Channels == 1)
+   {
+      for(Index = 0; Index < *Frames; Index++)
+         Output[(Index * AUDIOSBC_CHANNELS) + 1] = Output[Index * AUDIOSBC_CHANNELS];
+   }
+}
+
+   /* The following function initializes the specified decoder with an  */
+   /* empty (silent) history.  This function returns zero if successful */
+   /* or a negative value if the parameter is not valid.                */
+int AUDIOSBC_Initialize(AUDIOSBC_Decoder_t *Decoder)
+{
+   int ret_val;
+
+   if(Decoder)
+   {
+      memset(Decoder, 0, sizeof(AUDIOSBC_Decoder_t));
+
+      ret_val = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function parses the header of the SBC frame at the  */
+   /* start of the specified data into the specified format.  This      */
+   /* function returns the length of the frame if successful or a       */
+   /* negative value if the data does not start with a valid header or  */
+   /* is shorter than the frame.                                        */
+int AUDIOSBC_ParseHeader(const unsigned char *Data, unsigned int Length, AUDIOSBC_Format_t *Format)
+{
+   int          ret_val;
+   unsigned int Bits;
+
+   ret_val = -1;
+
+   if((Data) && (Format) && (Length >= AUDIOSBC_HEADER_LENGTH) && (Data[0] == AUDIOSBC_SYNCWORD))
+   {
+      Format->SampleRate       = SampleRates[(Data[1] >> 6) & 0x03];
+      Format->Blocks           = (((Data[1] >> 4) & 0x03) + 1) * 4;
+      Format->ChannelMode      = (Data[1] >> 2) & 0x03;
+      Format->Channels         = (Format->ChannelMode == AUDIOSBC_CHANNEL_MODE_MONO) ? 1 : 2;
+      Format->AllocationMethod = (Data[1] >> 1) & 0x01;
+      Format->Subbands         = (Data[1] & 0x01) ? 8 : 4;
+      Format->Bitpool          = Data[2];
+
+      /* The bit pool of a mono or dual channel frame is that of each   */
+      /* channel, that of a stereo frame is shared by both.             */
+      if((Format->ChannelMode == AUDIOSBC_CHANNEL_MODE_MONO) || (Format->ChannelMode == AUDIOSBC_CHANNEL_MODE_DUAL_CHANNEL))
+         Bits = Format->Blocks * Format->Channels * Format->Bitpool;
+      else
+      {
+         Bits = Format->Blocks * Format->Bitpool;
+
+         if(Format->ChannelMode == AUDIOSBC_CHANNEL_MODE_JOINT_STEREO)
+            Bits += Format->Subbands;
+      }
+
+      Format->FrameLength = AUDIOSBC_HEADER_LENGTH + ((4 * Format->Subbands * Format->Channels) / 8) + ((Bits + 7) / 8);
+
+      /* Every bit of the pool must be able to be allocated (16 bits per*/
+      /* subband), otherwise the allocation would not end.              */
+      if((Format->Bitpool >= 2) && (Format->Bitpool <= (16 * Format->Subbands * ((Format->ChannelMode >= AUDIOSBC_CHANNEL_MODE_STEREO) ? 2 : 1))) && (Format->FrameLength <= Length))
+         ret_val = (int)Format->FrameLength;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function decodes the SBC frame at the start of the  */
+   /* specified data into interleaved stereo frames, of which it returns*/
+   /* the number in the fourth parameter (at most                       */
+   /* AUDIOSBC_MAXIMUM_FRAMES).  A frame whose CRC does not match is    */
+   /* dropped (no frames are returned).  The history is cleared if the  */
+   /* number of subbands or channels changes.  This function returns the*/
+   /* length of the frame if successful or a negative value if the data */
+   /* does not start with a valid frame.                                */
+int AUDIOSBC_Decode(AUDIOSBC_Decoder_t *Decoder, const unsigned char *Data, unsigned int Length, unsigned int *Frames, short *Output)
+{
+   int          ret_val;
+   unsigned int Shift;
+   unsigned int Block;
+
+   if((Decoder) && (Frames) && (Output))
+   {
+      *Frames = 0;
+
+      if(((ret_val = ReadFrame(Decoder, Data, Length, &Shift)) > 0) && (Shift))
+      {
+         for(Block = 0; Block < Decoder->Format.Blocks; Block++)
+            SynthesizeBlock(Decoder, Block, Shift, &Output[Block * Decoder->Format.Subbands * AUDIOSBC_CHANNELS]);
+
+         CompleteFrame(Decoder, Frames, Output);
+      }
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function is the reference version of                */
+   /* AUDIOSBC_Decode().  It is only used to check the block version.   */
+int AUDIOSBC_DecodeReference(AUDIOSBC_Decoder_t *Decoder, const unsigned char *Data, unsigned int Length, unsigned int *Frames, short *Output)
+{
+   int          ret_val;
+   unsigned int Shift;
+   unsigned int Block;
+
+   if((Decoder) && (Frames) && (Output))
+   {
+      *Frames = 0;
+
+      if(((ret_val = ReadFrame(Decoder, Data, Length, &Shift)) > 0) && (Shift))
+      {
+         for(Block = 0; Block < Decoder->Format.Blocks; Block++)
+            SynthesizeBlockReference(Decoder, Block, Shift, &Output[Block * Decoder->Format.Subbands * AUDIOSBC_CHANNELS]);
+
+         CompleteFrame(Decoder, Frames, Output);
+      }
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function returns the statistics of the specified    */
+   /* decoder in the specified structure.                               */
+void AUDIOSBC_Query_Statistics(AUDIOSBC_Decoder_t *Decoder, AUDIOSBC_Statistics_t *Statistics)
+{
+   if((Decoder) && (Statistics))
+      *Statistics = Decoder->Statistics;
+}
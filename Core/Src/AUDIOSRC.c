@@ -0,0 +1,735 @@
+/*****< audiosrc.c >***********************************************************/
+/*                                                                            */
+/*  AUDIOSRC - Asynchronous sample rate converter of the audio stream.        */
+/*                                                                            */
+/******************************************************************************/
+
+#include <string.h>
+
+#include "AUDIOSRC.h"       /* Audio Sample Rate Converter Prototypes.        */
+#include "AUDIOSIMD.h"      /* Audio SIMD Instructions.                       */
+
+   /* The following constants represent the number of bits of the       */
+   /* position that select the phase, and the number of bits below them */
+   /* that interpolate between two phases (Q15).                        */
+#define PHASE_SHIFT              26
+#define INTERPOLATION_SHIFT      11
+
+   /* The following constants represent the gains of the tracker.  The  */
+   /* proportional gain is 2048 ppb per frame of difference, the        */
+   /* integral gain about 2 ppb per frame of difference per 1000 output */
+   /* frames (about 94 ppb per frame and second at 48 kHz), which gives */
+   /* a damping of about 0.7 at 48 kHz.  The difference is filtered     */
+   /* twice with a time constant of 128 updates, to smooth the bursts in*/
+   /* which the stream arrives (which are sampled by the updates).      */
+#define TRACKER_FILTER_SHIFT     7
+#define TRACKER_PROPORTIONAL     8
+#define TRACKER_INTEGRAL_SHIFT   17
+
+   /* The following table holds the coefficients (Q15) of each phase of */
+   /* the filter, with one more phase for the interpolation.  Phase P   */
+   /* holds the coefficient of input frame n - k at k + P/64 frames     */
+   /* from the output frame, in reverse order of k (i.e. oldest frame   */
+   /* first).  The prototype is a sinc with a cut off (-6 dB) at 0.445  */
+   /* of the input rate and a Kaiser window (beta 7).  At 44.1 kHz it   */
+   /* passes 18 kHz (-0.1 dB) and attenuates everything from 22.05 kHz  */
+   /* by at least 78 dB.                                                */
+static const short Coefficients[AUDIOSRC_PHASES + 1][AUDIOSRC_TAPS] =
+{
+   {
+           6,    -11,     16,    -18,     13,      4,    -37,     88,   -152,    221,   -281,    310,
+        -284,    179,     23,   -332,    744,  -1240,   1788,  -2340,   2844,  -3250,   3513,  29164,
+        3513,  -3250,   2844,  -2340,   1788,  -1240,    744,   -332,     23,    179,   -284,    310,
+        -281,    221,   -152,     88,    -37,      4,     13,    -18,     16,    -11,      6,      0
+   },
+   {
+           6,    -11,     16,    -17,     11,      7,    -41,     91,   -154,    222,   -277,    300,
+        -267,    154,     54,   -367,    777,  -1264,   1791,  -2307,   2752,  -3051,   3036,  29154,
+        3999,  -3447,   2932,  -2368,   1781,  -1214,    709,   -296,     -9,    204,   -301,    319,
+        -285,    221,   -149,     84,    -34,      1,     15,    -20,     17,    -12,      6,     -2
+   },
+   {
+           6,    -11,     15,    -16,      9,     10,    -44,     95,   -157,    221,   -272,    289,
+        -249,    130,     85,   -401,    809,  -1286,   1791,  -2271,   2656,  -2848,   2567,  29126,
+        4493,  -3640,   3015,  -2392,   1770,  -1185,    672,   -259,    -41,    228,   -317,    328,
+        -288,    220,   -146,     80,    -30,     -2,     17,    -21,     18,    -12,      6,     -2
+   },
+   {
+           6,    -11,     14,    -15,      7,     13,    -48,     98,   -159,    220,   -267,    278,
+        -231,    105,    116,   -434,    839,  -1304,   1788,  -2230,   2556,  -2644,   2108,  29080,
+        4995,  -3829,   3093,  -2411,   1756,  -1153,    634,   -222,    -73,    252,   -333,    337,
+        -290,    219,   -142,     76,    -26,     -5,     19,    -22,     18,    -12,      6,     -2
+   },
+   {
+           6,    -10,     14,    -13,      5,     16,    -51,    101,   -160,    219,   -262,    267,
+        -213,     79,    146,   -466,    867,  -1321,   1781,  -2186,   2452,  -2438,   1658,  29015,
+        5504,  -4015,   3166,  -2426,   1739,  -1119,    594,   -183,   -105,    276,   -348,    344,
+        -292,    217,   -139,     71,    -22,     -8,     21,    -23,     19,    -12,      6,     -2
+   },
+   {
+           6,    -10,     13,    -12,      3,     18,    -54,    103,   -162,    218,   -256,    255,
+        -194,     54,    176,   -497,    893,  -1334,   1771,  -2138,   2345,  -2230,   1219,  28931,
+        6020,  -4195,   3234,  -2437,   1718,  -1083,    553,   -145,   -137,    300,   -363,    351,
+        -294,    214,   -134,     67,    -18,    -11,     23,    -24,     19,    -12,      6,     -2
+   },
+   {
+           6,    -10,     12,    -11,      1,     21,    -57,    106,   -163,    216,   -249,    243,
+        -175,     30,    205,   -526,    918,  -1345,   1757,  -2086,   2234,  -2022,    790,  28829,
+        6541,  -4371,   3296,  -2443,   1694,  -1044,    510,   -105,   -169,    323,   -377,    358,
+        -294,    212,   -130,     62,    -14,    -14,     25,    -25,     20,    -12,      6,     -2
+   },
+   {
+           6,     -9,     12,     -9,     -1,     23,    -59,    108,   -163,    213,   -242,    230,
+        -156,      5,    234,   -555,    940,  -1353,   1740,  -2031,   2120,  -1813,    371,  28709,
+        7069,  -4541,   3353,  -2444,   1666,  -1003,    467,    -66,   -201,    345,   -390,    364,
+        -295,    209,   -125,     57,    -10,    -17,     27,    -26,     20,    -12,      6,     -2
+   },
+   {
+           5,     -9,     11,     -8,     -3,     26,    -62,    110,   -163,    211,   -235,    217,
+        -137,    -20,    262,   -582,    961,  -1358,   1721,  -1972,   2004,  -1603,    -36,  28571,
+        7602,  -4705,   3404,  -2440,   1635,   -960,    422,    -25,   -233,    367,   -403,    369,
+        -294,    205,   -120,     52,     -6,    -20,     29,    -27,     20,    -12,      6,     -2
+   },
+   {
+           5,     -9,     10,     -7,     -5,     28,    -65,    112,   -163,    207,   -227,    204,
+        -118,    -44,    289,   -608,    979,  -1361,   1698,  -1910,   1885,  -1394,   -432,  28415,
+        8139,  -4863,   3449,  -2432,   1600,   -915,    376,     15,   -264,    389,   -415,    374,
+        -294,    201,   -115,     47,     -1,    -23,     31,    -28,     21,    -13,      6,     -2
+   },
+   {
+           5,     -8,      9,     -6,     -7,     31,    -67,    113,   -163,    204,   -219,    190,
+         -99,    -69,    316,   -633,    996,  -1362,   1671,  -1845,   1764,  -1185,   -816,  28241,
+        8681,  -5015,   3488,  -2419,   1562,   -867,    328,     56,   -295,    410,   -427,    378,
+        -292,    197,   -110,     42,      3,    -26,     33,    -29,     21,    -13,      6,     -2
+   },
+   {
+           5,     -8,      9,     -4,     -9,     33,    -69,    115,   -163,    200,   -211,    176,
+         -79,    -92,    341,   -656,   1010,  -1359,   1642,  -1777,   1640,   -978,  -1189,  28049,
+        9226,  -5159,   3520,  -2402,   1521,   -817,    280,     97,   -326,    430,   -438,    381,
+        -290,    192,   -104,     36,      7,    -29,     35,    -30,     21,    -13,      6,     -2
+   },
+   {
+           5,     -7,      8,     -3,    -10,     35,    -71,    116,   -162,    196,   -202,    162,
+         -60,   -116,    366,   -678,   1022,  -1354,   1610,  -1706,   1515,   -771,  -1549,  27840,
+        9774,  -5296,   3547,  -2379,   1476,   -766,    231,    138,   -357,    450,   -448,    383,
+        -288,    187,    -98,     31,     12,    -32,     36,    -31,     22,    -12,      6,     -2
+   },
+   {
+           5,     -7,      7,     -2,    -12,     37,    -73,    117,   -160,    191,   -193,    148,
+         -41,   -139,    390,   -698,   1033,  -1347,   1576,  -1633,   1388,   -566,  -1896,  27614,
+       10325,  -5425,   3566,  -2352,   1428,   -713,    181,    179,   -387,    469,   -457,    385,
+        -285,    181,    -91,     25,     16,    -35,     38,    -32,     22,    -12,      6,     -2
+   },
+   {
+           5,     -7,      6,      0,    -14,     39,    -75,    117,   -159,    186,   -184,    134,
+         -21,   -162,    413,   -717,   1041,  -1337,   1538,  -1557,   1260,   -363,  -2231,  27372,
+       10878,  -5547,   3579,  -2320,   1377,   -657,    131,    220,   -416,    487,   -465,    386,
+        -281,    175,    -85,     19,     20,    -38,     40,    -32,     22,    -12,      5,     -2
+   },
+   {
+           4,     -6,      6,      1,    -16,     41,    -76,    118,   -157,    181,   -174,    119,
+          -2,   -184,    436,   -735,   1048,  -1324,   1498,  -1479,   1132,   -163,  -2554,  27112,
+       11432,  -5659,   3586,  -2283,   1323,   -601,     80,    261,   -445,    504,   -472,    386,
+        -277,    168,    -78,     14,     25,    -41,     41,    -33,     22,    -12,      5,     -1
+   },
+   {
+           4,     -6,      5,      2,    -17,     43,    -78,    118,   -155,    176,   -164,    104,
+          17,   -206,    457,   -751,   1052,  -1309,   1455,  -1399,   1002,     35,  -2863,  26837,
+       11988,  -5763,   3585,  -2241,   1266,   -542,     28,    301,   -473,    520,   -479,    386,
+        -272,    162,    -71,      8,     29,    -44,     43,    -34,     22,    -12,      5,     -1
+   },
+   {
+           4,     -5,      4,      3,    -19,     44,    -79,    118,   -152,    170,   -154,     89,
+          36,   -227,    477,   -765,   1054,  -1292,   1410,  -1317,    872,    230,  -3159,  26545,
+       12543,  -5858,   3578,  -2195,   1206,   -482,    -24,    342,   -501,    536,   -485,    384,
+        -266,    155,    -64,      2,     34,    -46,     44,    -34,     22,    -12,      5,     -1
+   },
+   {
+           4,     -5,      3,      4,    -20,     46,    -80,    118,   -150,    164,   -144,     75,
+          55,   -248,    496,   -778,   1054,  -1272,   1362,  -1233,    741,    422,  -3441,  26238,
+       13099,  -5943,   3563,  -2144,   1143,   -421,    -76,    382,   -527,    550,   -490,    383,
+        -260,    147,    -57,     -5,     38,    -49,     46,    -35,     22,    -12,      5,     -1
+   },
+   {
+           4,     -5,      2,      6,    -22,     47,    -81,    117,   -147,    157,   -133,     60,
+          73,   -268,    514,   -789,   1052,  -1250,   1313,  -1147,    611,    610,  -3711,  25915,
+       13653,  -6018,   3542,  -2088,   1078,   -358,   -129,    421,   -553,    564,   -494,    380,
+        -254,    139,    -49,    -11,     42,    -52,     47,    -35,     22,    -12,      5,     -1
+   },
+   {
+           3,     -4,      2,      7,    -23,     49,    -81,    116,   -144,    151,   -122,     45,
+          92,   -287,    531,   -798,   1049,  -1226,   1261,  -1060,    480,    795,  -3966,  25578,
+       14206,  -6083,   3513,  -2028,   1010,   -295,   -182,    460,   -578,    577,   -497,    376,
+        -247,    131,    -42,    -17,     47,    -54,     48,    -36,     22,    -11,      4,     -1
+   },
+   {
+           3,     -4,      1,      8,    -24,     50,    -82,    115,   -140,    144,   -111,     30,
+         109,   -306,    547,   -806,   1043,  -1200,   1207,   -972,    350,    975,  -4208,  25226,
+       14757,  -6137,   3478,  -1963,    939,   -230,   -235,    498,   -602,    588,   -499,    372,
+        -239,    122,    -34,    -23,     51,    -57,     49,    -36,     22,    -11,      4,     -1
+   },
+   {
+           3,     -3,      0,      9,    -26,     51,    -82,    114,   -137,    137,   -100,     15,
+         127,   -324,    562,   -813,   1035,  -1171,   1151,   -882,    221,   1151,  -4437,  24860,
+       15306,  -6180,   3435,  -1894,    866,   -164,   -287,    536,   -625,    599,   -500,    367,
+        -231,    114,    -26,    -29,     55,    -59,     50,    -36,     22,    -11,      4,     -1
+   },
+   {
+           3,     -3,     -1,     10,    -27,     52,    -83,    113,   -133,    129,    -89,      0,
+         144,   -341,    575,   -818,   1025,  -1141,   1094,   -792,     93,   1322,  -4651,  24480,
+       15851,  -6213,   3385,  -1821,    791,    -98,   -340,    573,   -647,    608,   -500,    361,
+        -223,    104,    -18,    -35,     59,    -62,     51,    -36,     22,    -10,      4,      0
+   },
+   {
+           3,     -2,     -1,     11,    -28,     53,    -83,    111,   -129,    122,    -78,    -14,
+         161,   -357,    587,   -821,   1014,  -1108,   1034,   -701,    -34,   1488,  -4852,  24087,
+       16393,  -6234,   3327,  -1743,    713,    -30,   -392,    609,   -668,    617,   -499,    355,
+        -213,     95,    -10,    -41,     63,    -64,     52,    -36,     21,    -10,      3,      0
+   },
+   {
+           2,     -2,     -2,     12,    -29,     54,    -83,    109,   -124,    114,    -67,    -29,
+         177,   -373,    599,   -823,   1000,  -1074,    974,   -609,   -160,   1649,  -5039,  23681,
+       16930,  -6243,   3263,  -1661,    634,     37,   -444,    644,   -688,    624,   -498,    348,
+        -204,     85,     -1,    -48,     67,    -66,     53,    -36,     21,    -10,      3,      0
+   },
+   {
+           2,     -2,     -3,     13,    -30,     54,    -82,    108,   -120,    107,    -55,    -43,
+         193,   -388,    608,   -823,    985,  -1038,    912,   -517,   -284,   1805,  -5212,  23263,
+       17462,  -6241,   3191,  -1575,    553,    106,   -495,    678,   -706,    630,   -495,    340,
+        -194,     75,      7,    -54,     71,    -68,     54,    -36,     21,     -9,      3,      0
+   },
+   {
+           2,     -1,     -3,     14,    -31,     55,    -82,    105,   -115,     99,    -44,    -58,
+         209,   -402,    617,   -821,    968,  -1000,    848,   -425,   -406,   1955,  -5371,  22833,
+       17989,  -6226,   3113,  -1485,    469,    174,   -546,    711,   -724,    635,   -491,    331,
+        -183,     65,     15,    -60,     75,    -70,     54,    -36,     20,     -9,      2,      0
+   },
+   {
+           2,     -1,     -4,     14,    -32,     55,    -81,    103,   -110,     91,    -33,    -71,
+         224,   -415,    624,   -818,    949,   -961,    784,   -333,   -526,   2100,  -5517,  22391,
+       18510,  -6199,   3027,  -1392,    385,    243,   -596,    743,   -740,    639,   -487,    322,
+        -172,     55,     24,    -66,     79,    -72,     55,    -36,     20,     -8,      2,      0
+   },
+   {
+           2,      0,     -5,     15,    -33,     56,    -81,    101,   -105,     82,    -22,    -85,
+         238,   -427,    631,   -813,    929,   -919,    718,   -241,   -644,   2238,  -5649,  21939,
+       19024,  -6160,   2935,  -1295,    298,    312,   -646,    774,   -755,    641,   -481,    312,
+        -161,     44,     32,    -72,     82,    -73,     55,    -36,     19,     -8,      2,      1
+   },
+   {
+           1,      0,     -5,     16,    -33,     56,    -80,     98,   -100,     74,    -10,    -99,
+         252,   -438,    636,   -807,    907,   -877,    652,   -149,   -760,   2370,  -5768,  21476,
+       19531,  -6108,   2835,  -1194,    211,    380,   -694,    803,   -768,    643,   -474,    301,
+        -149,     34,     41,    -78,     86,    -75,     56,    -35,     19,     -7,      1,      1
+   },
+   {
+           1,      0,     -6,     17,    -34,     56,    -79,     95,    -94,     66,      1,   -112,
+         265,   -449,    639,   -800,    883,   -833,    585,    -58,   -873,   2496,  -5873,  21003,
+       20030,  -6042,   2729,  -1090,    122,    449,   -741,    831,   -780,    643,   -467,    290,
+        -137,     23,     49,    -83,     89,    -76,     56,    -35,     18,     -7,      1,      1
+   },
+   {
+           1,      1,     -6,     17,    -35,     56,    -78,     92,    -89,     57,     12,   -125,
+         278,   -458,    642,   -791,    858,   -788,    517,     32,   -983,   2616,  -5964,  20521,
+       20521,  -5964,   2616,   -983,     32,    517,   -788,    858,   -791,    642,   -458,    278,
+        -125,     12,     57,    -89,     92,    -78,     56,    -35,     17,     -6,      1,      1
+   },
+   {
+           1,      1,     -7,     18,    -35,     56,    -76,     89,    -83,     49,     23,   -137,
+         290,   -467,    643,   -780,    831,   -741,    449,    122,  -1090,   2729,  -6042,  20030,
+       21003,  -5873,   2496,   -873,    -58,    585,   -833,    883,   -800,    639,   -449,    265,
+        -112,      1,     66,    -94,     95,    -79,     56,    -34,     17,     -6,      0,      1
+   },
+   {
+           1,      1,     -7,     19,    -35,     56,    -75,     86,    -78,     41,     34,   -149,
+         301,   -474,    643,   -768,    803,   -694,    380,    211,  -1194,   2835,  -6108,  19531,
+       21476,  -5768,   2370,   -760,   -149,    652,   -877,    907,   -807,    636,   -438,    252,
+         -99,    -10,     74,   -100,     98,    -80,     56,    -33,     16,     -5,      0,      1
+   },
+   {
+           1,      2,     -8,     19,    -36,     55,    -73,     82,    -72,     32,     44,   -161,
+         312,   -481,    641,   -755,    774,   -646,    312,    298,  -1295,   2935,  -6160,  19024,
+       21939,  -5649,   2238,   -644,   -241,    718,   -919,    929,   -813,    631,   -427,    238,
+         -85,    -22,     82,   -105,    101,    -81,     56,    -33,     15,     -5,      0,      2
+   },
+   {
+           0,      2,     -8,     20,    -36,     55,    -72,     79,    -66,     24,     55,   -172,
+         322,   -487,    639,   -740,    743,   -596,    243,    385,  -1392,   3027,  -6199,  18510,
+       22391,  -5517,   2100,   -526,   -333,    784,   -961,    949,   -818,    624,   -415,    224,
+         -71,    -33,     91,   -110,    103,    -81,     55,    -32,     14,     -4,     -1,      2
+   },
+   {
+           0,      2,     -9,     20,    -36,     54,    -70,     75,    -60,     15,     65,   -183,
+         331,   -491,    635,   -724,    711,   -546,    174,    469,  -1485,   3113,  -6226,  17989,
+       22833,  -5371,   1955,   -406,   -425,    848,  -1000,    968,   -821,    617,   -402,    209,
+         -58,    -44,     99,   -115,    105,    -82,     55,    -31,     14,     -3,     -1,      2
+   },
+   {
+           0,      3,     -9,     21,    -36,     54,    -68,     71,    -54,      7,     75,   -194,
+         340,   -495,    630,   -706,    678,   -495,    106,    553,  -1575,   3191,  -6241,  17462,
+       23263,  -5212,   1805,   -284,   -517,    912,  -1038,    985,   -823,    608,   -388,    193,
+         -43,    -55,    107,   -120,    108,    -82,     54,    -30,     13,     -3,     -2,      2
+   },
+   {
+           0,      3,    -10,     21,    -36,     53,    -66,     67,    -48,     -1,     85,   -204,
+         348,   -498,    624,   -688,    644,   -444,     37,    634,  -1661,   3263,  -6243,  16930,
+       23681,  -5039,   1649,   -160,   -609,    974,  -1074,   1000,   -823,    599,   -373,    177,
+         -29,    -67,    114,   -124,    109,    -83,     54,    -29,     12,     -2,     -2,      2
+   },
+   {
+           0,      3,    -10,     21,    -36,     52,    -64,     63,    -41,    -10,     95,   -213,
+         355,   -499,    617,   -668,    609,   -392,    -30,    713,  -1743,   3327,  -6234,  16393,
+       24087,  -4852,   1488,    -34,   -701,   1034,  -1108,   1014,   -821,    587,   -357,    161,
+         -14,    -78,    122,   -129,    111,    -83,     53,    -28,     11,     -1,     -2,      3
+   },
+   {
+           0,      4,    -10,     22,    -36,     51,    -62,     59,    -35,    -18,    104,   -223,
+         361,   -500,    608,   -647,    573,   -340,    -98,    791,  -1821,   3385,  -6213,  15851,
+       24480,  -4651,   1322,     93,   -792,   1094,  -1141,   1025,   -818,    575,   -341,    144,
+           0,    -89,    129,   -133,    113,    -83,     52,    -27,     10,     -1,     -3,      3
+   },
+   {
+          -1,      4,    -11,     22,    -36,     50,    -59,     55,    -29,    -26,    114,   -231,
+         367,   -500,    599,   -625,    536,   -287,   -164,    866,  -1894,   3435,  -6180,  15306,
+       24860,  -4437,   1151,    221,   -882,   1151,  -1171,   1035,   -813,    562,   -324,    127,
+          15,   -100,    137,   -137,    114,    -82,     51,    -26,      9,      0,     -3,      3
+   },
+   {
+          -1,      4,    -11,     22,    -36,     49,    -57,     51,    -23,    -34,    122,   -239,
+         372,   -499,    588,   -602,    498,   -235,   -230,    939,  -1963,   3478,  -6137,  14757,
+       25226,  -4208,    975,    350,   -972,   1207,  -1200,   1043,   -806,    547,   -306,    109,
+          30,   -111,    144,   -140,    115,    -82,     50,    -24,      8,      1,     -4,      3
+   },
+   {
+          -1,      4,    -11,     22,    -36,     48,    -54,     47,    -17,    -42,    131,   -247,
+         376,   -497,    577,   -578,    460,   -182,   -295,   1010,  -2028,   3513,  -6083,  14206,
+       25578,  -3966,    795,    480,  -1060,   1261,  -1226,   1049,   -798,    531,   -287,     92,
+          45,   -122,    151,   -144,    116,    -81,     49,    -23,      7,      2,     -4,      3
+   },
+   {
+          -1,      5,    -12,     22,    -35,     47,    -52,     42,    -11,    -49,    139,   -254,
+         380,   -494,    564,   -553,    421,   -129,   -358,   1078,  -2088,   3542,  -6018,  13653,
+       25915,  -3711,    610,    611,  -1147,   1313,  -1250,   1052,   -789,    514,   -268,     73,
+          60,   -133,    157,   -147,    117,    -81,     47,    -22,      6,      2,     -5,      4
+   },
+   {
+          -1,      5,    -12,     22,    -35,     46,    -49,     38,     -5,    -57,    147,   -260,
+         383,   -490,    550,   -527,    382,    -76,   -421,   1143,  -2144,   3563,  -5943,  13099,
+       26238,  -3441,    422,    741,  -1233,   1362,  -1272,   1054,   -778,    496,   -248,     55,
+          75,   -144,    164,   -150,    118,    -80,     46,    -20,      4,      3,     -5,      4
+   },
+   {
+          -1,      5,    -12,     22,    -34,     44,    -46,     34,      2,    -64,    155,   -266,
+         384,   -485,    536,   -501,    342,    -24,   -482,   1206,  -2195,   3578,  -5858,  12543,
+       26545,  -3159,    230,    872,  -1317,   1410,  -1292,   1054,   -765,    477,   -227,     36,
+          89,   -154,    170,   -152,    118,    -79,     44,    -19,      3,      4,     -5,      4
+   },
+   {
+          -1,      5,    -12,     22,    -34,     43,    -44,     29,      8,    -71,    162,   -272,
+         386,   -479,    520,   -473,    301,     28,   -542,   1266,  -2241,   3585,  -5763,  11988,
+       26837,  -2863,     35,   1002,  -1399,   1455,  -1309,   1052,   -751,    457,   -206,     17,
+         104,   -164,    176,   -155,    118,    -78,     43,    -17,      2,      5,     -6,      4
+   },
+   {
+          -1,      5,    -12,     22,    -33,     41,    -41,     25,     14,    -78,    168,   -277,
+         386,   -472,    504,   -445,    261,     80,   -601,   1323,  -2283,   3586,  -5659,  11432,
+       27112,  -2554,   -163,   1132,  -1479,   1498,  -1324,   1048,   -735,    436,   -184,     -2,
+         119,   -174,    181,   -157,    118,    -76,     41,    -16,      1,      6,     -6,      4
+   },
+   {
+          -2,      5,    -12,     22,    -32,     40,    -38,     20,     19,    -85,    175,   -281,
+         386,   -465,    487,   -416,    220,    131,   -657,   1377,  -2320,   3579,  -5547,  10878,
+       27372,  -2231,   -363,   1260,  -1557,   1538,  -1337,   1041,   -717,    413,   -162,    -21,
+         134,   -184,    186,   -159,    117,    -75,     39,    -14,      0,      6,     -7,      5
+   },
+   {
+          -2,      6,    -12,     22,    -32,     38,    -35,     16,     25,    -91,    181,   -285,
+         385,   -457,    469,   -387,    179,    181,   -713,   1428,  -2352,   3566,  -5425,  10325,
+       27614,  -1896,   -566,   1388,  -1633,   1576,  -1347,   1033,   -698,    390,   -139,    -41,
+         148,   -193,    191,   -160,    117,    -73,     37,    -12,     -2,      7,     -7,      5
+   },
+   {
+          -2,      6,    -12,     22,    -31,     36,    -32,     12,     31,    -98,    187,   -288,
+         383,   -448,    450,   -357,    138,    231,   -766,   1476,  -2379,   3547,  -5296,   9774,
+       27840,  -1549,   -771,   1515,  -1706,   1610,  -1354,   1022,   -678,    366,   -116,    -60,
+         162,   -202,    196,   -162,    116,    -71,     35,    -10,     -3,      8,     -7,      5
+   },
+   {
+          -2,      6,    -13,     21,    -30,     35,    -29,      7,     36,   -104,    192,   -290,
+         381,   -438,    430,   -326,     97,    280,   -817,   1521,  -2402,   3520,  -5159,   9226,
+       28049,  -1189,   -978,   1640,  -1777,   1642,  -1359,   1010,   -656,    341,    -92,    -79,
+         176,   -211,    200,   -163,    115,    -69,     33,     -9,     -4,      9,     -8,      5
+   },
+   {
+          -2,      6,    -13,     21,    -29,     33,    -26,      3,     42,   -110,    197,   -292,
+         378,   -427,    410,   -295,     56,    328,   -867,   1562,  -2419,   3488,  -5015,   8681,
+       28241,   -816,  -1185,   1764,  -1845,   1671,  -1362,    996,   -633,    316,    -69,    -99,
+         190,   -219,    204,   -163,    113,    -67,     31,     -7,     -6,      9,     -8,      5
+   },
+   {
+          -2,      6,    -13,     21,    -28,     31,    -23,     -1,     47,   -115,    201,   -294,
+         374,   -415,    389,   -264,     15,    376,   -915,   1600,  -2432,   3449,  -4863,   8139,
+       28415,   -432,  -1394,   1885,  -1910,   1698,  -1361,    979,   -608,    289,    -44,   -118,
+         204,   -227,    207,   -163,    112,    -65,     28,     -5,     -7,     10,     -9,      5
+   },
+   {
+          -2,      6,    -12,     20,    -27,     29,    -20,     -6,     52,   -120,    205,   -294,
+         369,   -403,    367,   -233,    -25,    422,   -960,   1635,  -2440,   3404,  -4705,   7602,
+       28571,    -36,  -1603,   2004,  -1972,   1721,  -1358,    961,   -582,    262,    -20,   -137,
+         217,   -235,    211,   -163,    110,    -62,     26,     -3,     -8,     11,     -9,      5
+   },
+   {
+          -2,      6,    -12,     20,    -26,     27,    -17,    -10,     57,   -125,    209,   -295,
+         364,   -390,    345,   -201,    -66,    467,  -1003,   1666,  -2444,   3353,  -4541,   7069,
+       28709,    371,  -1813,   2120,  -2031,   1740,  -1353,    940,   -555,    234,      5,   -156,
+         230,   -242,    213,   -163,    108,    -59,     23,     -1,     -9,     12,     -9,      6
+   },
+   {
+          -2,      6,    -12,     20,    -25,     25,    -14,    -14,     62,   -130,    212,   -294,
+         358,   -377,    323,   -169,   -105,    510,  -1044,   1694,  -2443,   3296,  -4371,   6541,
+       28829,    790,  -2022,   2234,  -2086,   1757,  -1345,    918,   -526,    205,     30,   -175,
+         243,   -249,    216,   -163,    106,    -57,     21,      1,    -11,     12,    -10,      6
+   },
+   {
+          -2,      6,    -12,     19,    -24,     23,    -11,    -18,     67,   -134,    214,   -294,
+         351,   -363,    300,   -137,   -145,    553,  -1083,   1718,  -2437,   3234,  -4195,   6020,
+       28931,   1219,  -2230,   2345,  -2138,   1771,  -1334,    893,   -497,    176,     54,   -194,
+         255,   -256,    218,   -162,    103,    -54,     18,      3,    -12,     13,    -10,      6
+   },
+   {
+          -2,      6,    -12,     19,    -23,     21,     -8,    -22,     71,   -139,    217,   -292,
+         344,   -348,    276,   -105,   -183,    594,  -1119,   1739,  -2426,   3166,  -4015,   5504,
+       29015,   1658,  -2438,   2452,  -2186,   1781,  -1321,    867,   -466,    146,     79,   -213,
+         267,   -262,    219,   -160,    101,    -51,     16,      5,    -13,     14,    -10,      6
+   },
+   {
+          -2,      6,    -12,     18,    -22,     19,     -5,    -26,     76,   -142,    219,   -290,
+         337,   -333,    252,    -73,   -222,    634,  -1153,   1756,  -2411,   3093,  -3829,   4995,
+       29080,   2108,  -2644,   2556,  -2230,   1788,  -1304,    839,   -434,    116,    105,   -231,
+         278,   -267,    220,   -159,     98,    -48,     13,      7,    -15,     14,    -11,      6
+   },
+   {
+          -2,      6,    -12,     18,    -21,     17,     -2,    -30,     80,   -146,    220,   -288,
+         328,   -317,    228,    -41,   -259,    672,  -1185,   1770,  -2392,   3015,  -3640,   4493,
+       29126,   2567,  -2848,   2656,  -2271,   1791,  -1286,    809,   -401,     85,    130,   -249,
+         289,   -272,    221,   -157,     95,    -44,     10,      9,    -16,     15,    -11,      6
+   },
+   {
+          -2,      6,    -12,     17,    -20,     15,      1,    -34,     84,   -149,    221,   -285,
+         319,   -301,    204,     -9,   -296,    709,  -1214,   1781,  -2368,   2932,  -3447,   3999,
+       29154,   3036,  -3051,   2752,  -2307,   1791,  -1264,    777,   -367,     54,    154,   -267,
+         300,   -277,    222,   -154,     91,    -41,      7,     11,    -17,     16,    -11,      6
+   },
+   {
+           0,      6,    -11,     16,    -18,     13,      4,    -37,     88,   -152,    221,   -281,
+         310,   -284,    179,     23,   -332,    744,  -1240,   1788,  -2340,   2844,  -3250,   3513,
+       29164,   3513,  -3250,   2844,  -2340,   1788,  -1240,    744,   -332,     23,    179,   -284,
+         310,   -281,    221,   -152,     88,    -37,      4,     13,    -18,     16,    -11,      6
+   }
+};
+
+   /* Local Function Prototypes.                                        */
+static unsigned long long ComputeStep(unsigned long InputRate, unsigned long OutputRate, long Correction);
+static void WriteFrame(AUDIOSRC_State_t *State, const short *Frame);
+static void AdvancePosition(AUDIOSRC_State_t *State);
+static void ComputeFrame(AUDIOSRC_State_t *State, short *Frame);
+static void ComputeFrameReference(AUDIOSRC_State_t *State, short *Frame);
+
+   /* The following function returns the number of input frames per     */
+   /* output frame (with 32 fraction bits) for the specified rates and  */
+   /* correction.                                                       */
+static unsigned long long ComputeStep(unsigned long InputRate, unsigned long OutputRate, long Correction)
+{
+   long long Step;
+
+   Step  = (long long)(((unsigned long long)InputRate << 32) / OutputRate);
+   Step += (Step * Correction) / 1000000000LL;
+
+   return((unsigned long long)Step);
+}
+
+   /* The following function writes the specified input frame in the    */
+   /* history.  Each sample is written at Position and at Position +    */
+   /* AUDIOSRC_TAPS, so the last AUDIOSRC_TAPS samples of a channel     */
+   /* always start at (the new) Position.                               */
+static void WriteFrame(AUDIOSRC_State_t *State, const short *Frame)
+{
+   unsigned int Channel;
+
+   for(Channel = 0; Channel < AUDIOSRC_CHANNELS; Channel++)
+   {
+      State->History[Channel][State->Position]                 = Frame[Channel];
+      State->History[Channel][State->Position + AUDIOSRC_TAPS] = Frame[Channel];
+   }
+
+   if(++State->Position == AUDIOSRC_TAPS)
+      State->Position = 0;
+}
+
+   /* The following function moves the position to the next output      */
+   /* frame.                                                            */
+static void AdvancePosition(AUDIOSRC_State_t *State)
+{
+   unsigned long long Position;
+
+   Position        = (unsigned long long)State->Fraction + State->Step;
+   State->Fraction = (unsigned long)(Position & 0xFFFFFFFFUL);
+   State->Pending  = (unsigned int)(Position >> 32);
+}
+
+   /* The following function computes the output frame at the current   */
+   /* position.  Two phases are applied to the history, two taps at a   */
+   /* time, and the results are interpolated.                           */
+static void ComputeFrame(AUDIOSRC_State_t *State, short *Frame)
+{
+   const short  *Phase0;
+   const short  *Phase1;
+   const short  *Window;
+   unsigned int  Channel;
+   unsigned int  Index;
+   long          Interpolation;
+   uint32_t      Samples;
+   uint64_t      Sum0;
+   uint64_t      Sum1;
+   int64_t       Result;
+
+   Phase0        = Coefficients[State->Fraction >> PHASE_SHIFT];
+   Phase1        = Phase0 + AUDIOSRC_TAPS;
+   Interpolation = (long)((State->Fraction >> INTERPOLATION_SHIFT) & 0x7FFF);
+
+   for(Channel = 0; Channel < AUDIOSRC_CHANNELS; Channel++)
+   {
+      Window = &(State->History[Channel][State->Position]);
+      Sum0   = 0;
+      Sum1   = 0;
+
+      for(Index = 0; Index < AUDIOSRC_TAPS; Index += 2)
+      {
+         Samples = AUDIOSIMD_Read2(&Window[Index]);
+         Sum0    = __SMLALD(Samples, AUDIOSIMD_Read2(&Phase0[Index]), Sum0);
+         Sum1    = __SMLALD(Samples, AUDIOSIMD_Read2(&Phase1[Index]), Sum1);
+      }
+
+      Result         = (int64_t)Sum0 + ((((int64_t)Sum1 - (int64_t)Sum0) * Interpolation) >> 15);
+      Result         = (Result + 0x4000) >> 15;
+
+      Frame[Channel] = (short)((Result > 32767) ? 32767 : ((Result < -32768) ? -32768 : Result));
+   }
+}
+
+   /* The following function is the reference version of ComputeFrame(),*/
+   /* one tap at a time with the history indexed modulo AUDIOSRC_TAPS.  */
+static void ComputeFrameReference(AUDIOSRC_State_t *State, short *Frame)
+{
+   unsigned int Channel;
+   unsigned int Index;
+   unsigned int Phase;
+   long         Interpolation;
+   int64_t      Sum0;
+   int64_t      Sum1;
+   int64_t      Sample;
+   int64_t      Result;
+
+   Phase         = (unsigned int)(State->Fraction >> PHASE_SHIFT);
+   Interpolation = (long)((State->Fraction >> INTERPOLATION_SHIFT) & 0x7FFF);
+
+   for(Channel = 0; Channel < AUDIOSRC_CHANNELS; Channel++)
+   {
+      Sum0 = 0;
+      Sum1 = 0;
+
+      for(Index = 0; Index < AUDIOSRC_TAPS; Index++)
+      {
+         Sample  = State->History[Channel][(State->Position + Index) % AUDIOSRC_TAPS];
+         Sum0   += Sample * Coefficients[Phase][Index];
+         Sum1   += Sample * Coefficients[Phase + 1][Index];
+      }
+
+      Result         = Sum0 + (((Sum1 - Sum0) * Interpolation) >> 15);
+      Result         = (Result + 0x4000) >> 15;
+
+      Frame[Channel] = (short)((Result > 32767) ? 32767 : ((Result < -32768) ? -32768 : Result));
+   }
+}
+
+   /* The following function initializes the specified converter for the*/
+   /* specified input and output rates, with no correction and an empty */
+   /* (silent) history.  This function returns zero if successful or a  */
+   /* negative value if the rates are not supported.                    */
+int AUDIOSRC_Initialize(AUDIOSRC_State_t *State, unsigned long InputRate, unsigned long OutputRate)
+{
+   int ret_val;
+
+   if(State)
+   {
+      memset(State, 0, sizeof(AUDIOSRC_State_t));
+
+      State->Pending = 1;
+
+      ret_val = AUDIOSRC_SetRates(State, InputRate, OutputRate);
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function changes the rates of the specified         */
+   /* converter.  The history and the position are kept, so the output  */
+   /* continues without a gap.  This function returns zero if successful*/
+   /* or a negative value if the rates are not supported.               */
+int AUDIOSRC_SetRates(AUDIOSRC_State_t *State, unsigned long InputRate, unsigned long OutputRate)
+{
+   int ret_val;
+
+   if((InputRate) && (OutputRate) && (InputRate <= (OutputRate * 2)) && (OutputRate <= (InputRate * 2)))
+   {
+      State->InputRate  = InputRate;
+      State->OutputRate = OutputRate;
+      State->Step       = ComputeStep(InputRate, OutputRate, State->Correction);
+
+      ret_val           = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function sets the correction of the specified       */
+   /* converter in parts per billion (positive reads the input faster). */
+   /* The correction is limited to +/-AUDIOSRC_MAXIMUM_CORRECTION.      */
+void AUDIOSRC_SetCorrection(AUDIOSRC_State_t *State, long Correction)
+{
+   if(Correction > AUDIOSRC_MAXIMUM_CORRECTION)
+      Correction = AUDIOSRC_MAXIMUM_CORRECTION;
+   else
+   {
+      if(Correction < -AUDIOSRC_MAXIMUM_CORRECTION)
+         Correction = -AUDIOSRC_MAXIMUM_CORRECTION;
+   }
+
+   State->Correction = Correction;
+   State->Step       = ComputeStep(State->InputRate, State->OutputRate, Correction);
+}
+
+   /* The following function converts the specified input frames into at*/
+   /* most the specified number of output frames.  The second parameter */
+   /* holds the number of input frames on entry and receives the number */
+   /* that were read.  This function returns the number of output frames*/
+   /* that were produced, which is less than requested only if all of   */
+   /* the input frames have been read.                                  */
+unsigned int AUDIOSRC_Process(AUDIOSRC_State_t *State, unsigned int *InputFrames, const short *Input, unsigned int OutputFrames, short *Output)
+{
+   unsigned int ret_val;
+   unsigned int Available;
+   unsigned int Read;
+
+   ret_val   = 0;
+   Read      = 0;
+   Available = *InputFrames;
+
+   while(ret_val < OutputFrames)
+   {
+      while((State->Pending) && (Read < Available))
+      {
+         WriteFrame(State, &Input[Read * AUDIOSRC_CHANNELS]);
+
+         State->Pending--;
+         Read++;
+      }
+
+      if(State->Pending)
+         break;
+
+      ComputeFrame(State, &Output[ret_val * AUDIOSRC_CHANNELS]);
+      AdvancePosition(State);
+
+      ret_val++;
+   }
+
+   *InputFrames = Read;
+
+   return(ret_val);
+}
+
+   /* The following function is the reference version of                */
+   /* AUDIOSRC_Process().  It is only used to check the block version.  */
+unsigned int AUDIOSRC_ProcessReference(AUDIOSRC_State_t *State, unsigned int *InputFrames, const short *Input, unsigned int OutputFrames, short *Output)
+{
+   unsigned int ret_val;
+   unsigned int Available;
+   unsigned int Read;
+
+   ret_val   = 0;
+   Read      = 0;
+   Available = *InputFrames;
+
+   while(ret_val < OutputFrames)
+   {
+      while((State->Pending) && (Read < Available))
+      {
+         WriteFrame(State, &Input[Read * AUDIOSRC_CHANNELS]);
+
+         State->Pending--;
+         Read++;
+      }
+
+      if(State->Pending)
+         break;
+
+      ComputeFrameReference(State, &Output[ret_val * AUDIOSRC_CHANNELS]);
+      AdvancePosition(State);
+
+      ret_val++;
+   }
+
+   *InputFrames = Read;
+
+   return(ret_val);
+}
+
+   /* The following function initializes the specified tracker with the */
+   /* specified target fill level (in frames).                          */
+void AUDIOSRC_InitializeTracker(AUDIOSRC_Tracker_t *Tracker, unsigned int TargetFrames)
+{
+   if(Tracker)
+   {
+      memset(Tracker, 0, sizeof(AUDIOSRC_Tracker_t));
+
+      Tracker->TargetFrames = TargetFrames;
+   }
+}
+
+   /* The following function updates the specified tracker with the     */
+   /* specified fill level of the buffer and the number of output frames*/
+   /* since the last update, and returns the correction (in parts per   */
+   /* billion) that should be set for the converter.  The integral is   */
+   /* not changed while the correction is limited.                      */
+long AUDIOSRC_UpdateTracker(AUDIOSRC_Tracker_t *Tracker, unsigned int Frames, unsigned int ElapsedFrames)
+{
+   long      Difference;
+   long long Integral;
+   long long Correction;
+
+   Difference          = ((long)Frames - (long)Tracker->TargetFrames) * 256;
+   Tracker->Filtered  += (Difference - Tracker->Filtered) / (1 << TRACKER_FILTER_SHIFT);
+   Tracker->Smoothed  += (Tracker->Filtered - Tracker->Smoothed) / (1 << TRACKER_FILTER_SHIFT);
+
+   Integral            = Tracker->Integral + ((long long)Tracker->Smoothed * ElapsedFrames);
+   Correction          = ((long long)Tracker->Smoothed * TRACKER_PROPORTIONAL) + (Integral / (1LL << TRACKER_INTEGRAL_SHIFT));
+
+   if(Correction > AUDIOSRC_MAXIMUM_CORRECTION)
+      Correction = AUDIOSRC_MAXIMUM_CORRECTION;
+   else
+   {
+      if(Correction < -AUDIOSRC_MAXIMUM_CORRECTION)
+         Correction = -AUDIOSRC_MAXIMUM_CORRECTION;
+      else
+         Tracker->Integral = Integral;
+   }
+
+   Tracker->Correction = (long)Correction;
+
+   return(Tracker->Correction);
+}
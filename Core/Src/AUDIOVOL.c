@@ -0,0 +1,319 @@
+/*****< audiovol.c >***********************************************************/
+/*                                                                            */
+/*  AUDIOVOL - Volume of the audio output.                                    */
+/*                                                                            */
+/******************************************************************************/
+
+#include <string.h>
+
+#include "AUDIOVOL.h"       /* Audio Volume Prototypes/Constants.             */
+
+   /* The following constants represent the number of fraction bits of  */
+   /* the gain beyond Q15 and of the position, and the shift and        */
+   /* rounding that bring a scaled sample back to 16 bits.              */
+#define GAIN_SHIFT               15
+#define POSITION_SHIFT           12
+#define SCALE_SHIFT              15
+#define SCALE_ROUNDING           (1L << (SCALE_SHIFT - 1))
+
+   /* The following constant represents the number of levels in each row*/
+   /* of CoarseGains, i.e. in 6 dB.                                     */
+#define FINE_LEVELS              12
+
+   /* The following tables hold the gains (Q15, rounded) of the levels: */
+   /* the gain of a level is the product of the coarse gain of 6 dB     */
+   /* steps and the fine gain of the remaining half decibels, which is  */
+   /* within one of the exact gain.                                     */
+static const unsigned short CoarseGains[(AUDIOVOL_MINIMUM_LEVEL / FINE_LEVELS) + 1] =
+{
+   32768, 16423,  8231,  4125,  2068,  1036,   519,   260,
+     130,    65,    33,    16,     8,     4,     2,     1,
+       1
+};
+
+static const unsigned short FineGains[FINE_LEVELS] =
+{
+   32768, 30935, 29205, 27571, 26029, 24573, 23198, 21900,
+   20675, 19519, 18427, 17396
+};
+
+   /* Local Function Prototypes.                                        */
+static unsigned int PositionGain(long Position);
+static void StartRamp(AUDIOVOL_Stage_t *Stage, unsigned int Frames);
+static void StartSegment(AUDIOVOL_Stage_t *Stage);
+static void AdvanceRamp(AUDIOVOL_Stage_t *Stage);
+static void ScaleBlock(unsigned int Frames, unsigned int Gain, const short *Input, short *Output);
+static void RampBlock(AUDIOVOL_Stage_t *Stage, unsigned int Frames, const short *Input, short *Output);
+
+   /* The following function returns the gain of the specified position */
+   /* (a level with POSITION_SHIFT fraction bits), interpolated linearly*/
+   /* between the gains of the levels around it.                        */
+static unsigned int PositionGain(long Position)
+{
+   unsigned int Level;
+   long         First;
+   long         Second;
+
+   Level  = (unsigned int)(Position >> POSITION_SHIFT);
+   First  = (long)AUDIOVOL_LevelGain(Level);
+   Second = (long)AUDIOVOL_LevelGain(Level + 1);
+
+   return((unsigned int)(First - ((((First - Second) * (Position & ((1L << POSITION_SHIFT) - 1))) + (1L << (POSITION_SHIFT - 1))) >> POSITION_SHIFT)));
+}
+
+   /* The following function starts a ramp of the specified stage to its*/
+   /* level and mute over the specified number of frames.               */
+static void StartRamp(AUDIOVOL_Stage_t *Stage, unsigned int Frames)
+{
+   long Target;
+
+   if(!Frames)
+      Frames = 1;
+
+   Target           = (long)((Stage->Muted) ? AUDIOVOL_MUTE_LEVEL : Stage->Level) << POSITION_SHIFT;
+
+   Stage->Target    = AUDIOVOL_LevelGain((unsigned int)(Target >> POSITION_SHIFT));
+   Stage->Rate      = (Target - Stage->Position) / (long)Frames;
+   Stage->Remaining = Frames;
+   Stage->Segment   = 0;
+}
+
+   /* The following function starts the next segment of the ramp of the */
+   /* specified stage.  A linear ramp is one segment, an exponential    */
+   /* ramp moves its position by AUDIOVOL_SEGMENT_FRAMES frames of its  */
+   /* rate at a time.  The last segment ends exactly at the target.  The*/
+   /* step is rounded towards zero, so the gain does not overshoot the  */
+   /* end of a segment.                                                 */
+static void StartSegment(AUDIOVOL_Stage_t *Stage)
+{
+   unsigned int Frames;
+   unsigned int Gain;
+
+   if((Stage->Ramp == vrExponential) && (Stage->Remaining > AUDIOVOL_SEGMENT_FRAMES))
+   {
+      Frames           = AUDIOVOL_SEGMENT_FRAMES;
+      Stage->Position += Stage->Rate * AUDIOVOL_SEGMENT_FRAMES;
+      Gain             = PositionGain(Stage->Position);
+   }
+   else
+   {
+      Frames           = Stage->Remaining;
+      Stage->Position  = (long)((Stage->Muted) ? AUDIOVOL_MUTE_LEVEL : Stage->Level) << POSITION_SHIFT;
+      Gain             = Stage->Target;
+   }
+
+   Stage->Step    = (((long)Gain << GAIN_SHIFT) - Stage->Gain) / (long)Frames;
+   Stage->Segment = Frames;
+}
+
+   /* The following function advances the ramp of the specified stage by*/
+   /* one frame.  The gain is set to its target exactly at the end of   */
+   /* the ramp.                                                         */
+static void AdvanceRamp(AUDIOVOL_Stage_t *Stage)
+{
+   Stage->Segment--;
+
+   if(--Stage->Remaining)
+      Stage->Gain += Stage->Step;
+   else
+      Stage->Gain  = (long)Stage->Target << GAIN_SHIFT;
+}
+
+   /* The following function scales the specified number of frames by   */
+   /* the specified constant gain.  The product of a sample and a gain  */
+   /* of at most unity always fits in 16 bits once it is rounded.       */
+static void ScaleBlock(unsigned int Frames, unsigned int Gain, const short *Input, short *Output)
+{
+   unsigned int Index;
+
+   if(Gain == AUDIOVOL_UNITY_GAIN)
+   {
+      if(Input != Output)
+         memmove(Output, Input, (Frames * AUDIOVOL_CHANNELS * sizeof(short)));
+   }
+   else
+   {
+      if(!Gain)
+         memset(Output, 0, (Frames * AUDIOVOL_CHANNELS * sizeof(short)));
+      else
+      {
+         for(Index = 0; Index < (Frames * AUDIOVOL_CHANNELS); Index++)
+            Output[Index] = (short)((((long)Input[Index] * (long)Gain) + SCALE_ROUNDING) >> SCALE_SHIFT);
+      }
+   }
+}
+
+   /* The following function scales the specified number of frames, at  */
+   /* most the rest of the current segment, along the ramp of the       */
+   /* specified stage.                                                  */
+static void RampBlock(AUDIOVOL_Stage_t *Stage, unsigned int Frames, const short *Input, short *Output)
+{
+   unsigned int Index;
+   long         Gain;
+
+   for(Index = 0; Index < (Frames * AUDIOVOL_CHANNELS); Index += AUDIOVOL_CHANNELS)
+   {
+      Gain              = Stage->Gain >> GAIN_SHIFT;
+
+      Output[Index]     = (short)((((long)Input[Index] * Gain) + SCALE_ROUNDING) >> SCALE_SHIFT);
+      Output[Index + 1] = (short)((((long)Input[Index + 1] * Gain) + SCALE_ROUNDING) >> SCALE_SHIFT);
+
+      AdvanceRamp(Stage);
+   }
+}
+
+   /* The following function returns the gain (Q15) of the specified    */
+   /* level (zero for AUDIOVOL_MUTE_LEVEL and above).                   */
+unsigned int AUDIOVOL_LevelGain(unsigned int Level)
+{
+   unsigned int ret_val;
+
+   if(Level < AUDIOVOL_MUTE_LEVEL)
+      ret_val = (((unsigned long)CoarseGains[Level / FINE_LEVELS] * FineGains[Level % FINE_LEVELS]) + SCALE_ROUNDING) >> SCALE_SHIFT;
+   else
+      ret_val = 0;
+
+   return(ret_val);
+}
+
+   /* The following function initializes the specified volume stage with*/
+   /* ramps of the specified shape at the specified level and mute,     */
+   /* without a ramp.  This function returns zero if successful or a    */
+   /* negative value if a parameter is not valid.                       */
+int AUDIOVOL_Initialize(AUDIOVOL_Stage_t *Stage, AUDIOVOL_Ramp_t Ramp, unsigned int Level, int Muted)
+{
+   int ret_val;
+
+   if((Stage) && ((Ramp == vrLinear) || (Ramp == vrExponential)))
+   {
+      memset(Stage, 0, sizeof(AUDIOVOL_Stage_t));
+
+      Stage->Ramp     = Ramp;
+      Stage->Level    = (Level > AUDIOVOL_MUTE_LEVEL) ? AUDIOVOL_MUTE_LEVEL : Level;
+      Stage->Muted    = (Muted) ? 1 : 0;
+      Stage->Position = (long)((Stage->Muted) ? AUDIOVOL_MUTE_LEVEL : Stage->Level) << POSITION_SHIFT;
+      Stage->Target   = AUDIOVOL_LevelGain((unsigned int)(Stage->Position >> POSITION_SHIFT));
+      Stage->Gain     = (long)Stage->Target << GAIN_SHIFT;
+
+      ret_val         = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function sets the level (at most                    */
+   /* AUDIOVOL_MUTE_LEVEL) of the specified volume stage.  Unless it is */
+   /* the current level the gain ramps from where it is over the        */
+   /* specified number of frames (at least one), starting with the next */
+   /* frame.  The level is kept while the stage is muted.               */
+void AUDIOVOL_SetLevel(AUDIOVOL_Stage_t *Stage, unsigned int Level, unsigned int Frames)
+{
+   if(Stage)
+   {
+      if(Level > AUDIOVOL_MUTE_LEVEL)
+         Level = AUDIOVOL_MUTE_LEVEL;
+
+      if(Level != Stage->Level)
+      {
+         Stage->Level = Level;
+
+         /* A muted stage stays silent until it is un-muted.            */
+         if(!Stage->Muted)
+            StartRamp(Stage, Frames);
+      }
+   }
+}
+
+   /* The following function mutes (if the second parameter is non-zero)*/
+   /* or un-mutes the specified volume stage.  Unless the stage already */
+   /* is, the gain ramps from where it is over the specified number of  */
+   /* frames (at least one), starting with the next frame.              */
+void AUDIOVOL_SetMute(AUDIOVOL_Stage_t *Stage, int Mute, unsigned int Frames)
+{
+   if(Stage)
+   {
+      Mute = (Mute) ? 1 : 0;
+
+      if(Mute != Stage->Muted)
+      {
+         Stage->Muted = Mute;
+
+         StartRamp(Stage, Frames);
+      }
+   }
+}
+
+   /* The following function returns non-zero if the output of the      */
+   /* specified volume stage is heard (or will be by the end of the     */
+   /* ramp).                                                            */
+int AUDIOVOL_IsAudible(AUDIOVOL_Stage_t *Stage)
+{
+   int ret_val;
+
+   if(Stage)
+      ret_val = ((Stage->Gain >> GAIN_SHIFT) || (Stage->Target));
+   else
+      ret_val = 0;
+
+   return(ret_val);
+}
+
+   /* The following function scales the specified number of frames of the*/
+   /* specified input into the specified output.  The gain changes with */
+   /* every frame of a ramp, so a ramp is scaled one segment at a time  */
+   /* and the rest of the frames with the constant gain as one block.   */
+void AUDIOVOL_Process(AUDIOVOL_Stage_t *Stage, unsigned int Frames, const short *Input, short *Output)
+{
+   unsigned int Count;
+
+   if((Stage) && (Input) && (Output))
+   {
+      while((Frames) && (Stage->Remaining))
+      {
+         if(!Stage->Segment)
+            StartSegment(Stage);
+
+         Count   = (Frames < Stage->Segment) ? Frames : Stage->Segment;
+
+         RampBlock(Stage, Count, Input, Output);
+
+         Input  += Count * AUDIOVOL_CHANNELS;
+         Output += Count * AUDIOVOL_CHANNELS;
+         Frames -= Count;
+      }
+
+      if(Frames)
+         ScaleBlock(Frames, (unsigned int)(Stage->Gain >> GAIN_SHIFT), Input, Output);
+   }
+}
+
+   /* The following function is the reference version of                */
+   /* AUDIOVOL_Process().  Each sample is the rounded product of the    */
+   /* sample and the gain of its frame.                                 */
+void AUDIOVOL_ProcessReference(AUDIOVOL_Stage_t *Stage, unsigned int Frames, const short *Input, short *Output)
+{
+   unsigned int Index;
+   unsigned int Channel;
+   long long    Product;
+
+   if((Stage) && (Input) && (Output))
+   {
+      for(Index = 0; Index < (Frames * AUDIOVOL_CHANNELS); Index += AUDIOVOL_CHANNELS)
+      {
+         if((Stage->Remaining) && (!Stage->Segment))
+            StartSegment(Stage);
+
+         for(Channel = 0; Channel < AUDIOVOL_CHANNELS; Channel++)
+         {
+            Product                 = ((long long)Input[Index + Channel] * (Stage->Gain >> GAIN_SHIFT)) + SCALE_ROUNDING;
+
+            Output[Index + Channel] = (short)(Product >> SCALE_SHIFT);
+         }
+
+         if(Stage->Remaining)
+            AdvanceRamp(Stage);
+      }
+   }
+}
@@ -0,0 +1,460 @@
+/*****< i2cqueue.c >**********************************************************/
+/*                                                                           */
+/*  I2CQUEUE - Non-blocking register writes to the I2C1 control devices.     */
+/*                                                                           */
+/*****************************************************************************/
+
+#include <string.h>
+
+#include "main.h"
+#include "i2c.h"
+#include "LOWPOWER.h"
+#include "I2CQUEUE.h"
+
+   /* The following constant represents the I2C handle of the bus that  */
+   /* the control devices are on (its TX DMA is linked in i2c.c).       */
+#define I2C_HANDLE                hi2c1
+
+   /* The following constant represents the number of registers of each */
+   /* device (8 bit register addresses).                                */
+#define NUMBER_REGISTERS          256
+
+   /* The following macros save, disable and restore the interrupt      */
+   /* state so that the queue may be changed from a task while the      */
+   /* interrupts service it.                                            */
+#define SaveAndDisableInterrupts(_x) do { (_x) = __get_PRIMASK(); __disable_irq(); } while(0)
+#define RestoreInterrupts(_x)        __set_PRIMASK(_x)
+
+   /* The following structure holds a registered device and the shadow  */
+   /* of its registers, of which those that have their bit set in Valid */
+   /* are known.                                                        */
+typedef struct _tagDevice_t
+{
+   unsigned int  Address;
+   int           AutoIncrement;
+   unsigned char IncrementFlag;
+   unsigned char Shadow[NUMBER_REGISTERS];
+   unsigned char Valid[NUMBER_REGISTERS / 8];
+} Device_t;
+
+   /* The following structure holds a queued sequence.  Position is the */
+   /* index of the next write that is sent and Status the result that is*/
+   /* passed to the callback.                                           */
+typedef struct _tagSequence_t
+{
+   unsigned int        DeviceID;
+   unsigned int        NumberWrites;
+   unsigned int        Position;
+   int                 Status;
+   I2CQUEUE_Callback_t Callback;
+   unsigned long       CallbackParameter;
+   I2CQUEUE_Write_t    Writes[I2CQUEUE_MAXIMUM_WRITES];
+} Sequence_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+   /* * NOTE * Sequences is a ring of NumberSequences sequences starting*/
+   /*          at FirstSequence.  The queue is Active from the time a   */
+   /*          sequence is queued until it is empty again, during which */
+   /*          only ServiceQueue() (from the interrupts once a transfer */
+   /*          has been started) removes sequences.  TransferWrites is  */
+   /*          the number of writes of the first sequence that are being*/
+   /*          sent from TransferBuffer.                                */
+static Device_t              Devices[I2CQUEUE_MAXIMUM_DEVICES];
+static unsigned int          NumberDevices;
+static Sequence_t            Sequences[I2CQUEUE_MAXIMUM_SEQUENCES];
+static volatile unsigned int FirstSequence;
+static volatile unsigned int NumberSequences;
+static volatile int          Active;
+static unsigned int          TransferWrites;
+static unsigned char         TransferBuffer[I2CQUEUE_MAXIMUM_WRITES + 1];
+static I2CQUEUE_Statistics_t QueueStatistics;
+
+   /* Local Function Prototypes.                                        */
+static void FailSequence(Sequence_t *Sequence);
+static int StartTransfer(Sequence_t *Sequence);
+static void ServiceQueue(void);
+static void TransferComplete(int Status);
+
+   /* The following function drops the rest of the specified sequence   */
+   /* (the first of the queue) after a transfer failed.  Which of its   */
+   /* writes reached the device is not known, so the shadow of the      */
+   /* device is invalidated.  The sequences queued after it to the same */
+   /* device are failed as well, as writes of theirs that were dropped  */
+   /* by the shadow relied on writes that may not have been sent.       */
+static void FailSequence(Sequence_t *Sequence)
+{
+   unsigned int  Index;
+   unsigned int  DeviceID;
+   unsigned long InterruptState;
+   Sequence_t   *Queued;
+
+   DeviceID = Sequence->DeviceID;
+
+   SaveAndDisableInterrupts(InterruptState);
+
+   for(Index = 0; Index < NumberSequences; Index++)
+   {
+      Queued = &Sequences[(FirstSequence + Index) % I2CQUEUE_MAXIMUM_SEQUENCES];
+
+      if(Queued->DeviceID == DeviceID)
+      {
+         Queued->Position = Queued->NumberWrites;
+         Queued->Status   = I2CQUEUE_ERROR_TRANSFER_FAILED;
+      }
+   }
+
+   memset(Devices[DeviceID].Valid, 0, sizeof(Devices[DeviceID].Valid));
+
+   QueueStatistics.Errors++;
+
+   RestoreInterrupts(InterruptState);
+}
+
+   /* The following function starts the transfer of the next writes of  */
+   /* the specified sequence: the writes to consecutive registers if the*/
+   /* device increments its register address, otherwise a single write. */
+   /* This function returns non-zero if the transfer was started.       */
+static int StartTransfer(Sequence_t *Sequence)
+{
+   int                     ret_val;
+   unsigned int            Index;
+   unsigned int            Length;
+   unsigned int            Remaining;
+   Device_t               *Device;
+   const I2CQUEUE_Write_t *Writes;
+
+   Device    = &Devices[Sequence->DeviceID];
+   Writes    = &Sequence->Writes[Sequence->Position];
+   Remaining = Sequence->NumberWrites - Sequence->Position;
+   Length    = 1;
+
+   if(Device->AutoIncrement)
+   {
+      while((Length < Remaining) && (Writes[Length].Register == (Writes[Length - 1].Register + 1)))
+         Length++;
+   }
+
+   /* The register address is followed by the value of each register.   */
+   TransferBuffer[0] = Writes[0].Register | ((Length > 1) ? Device->IncrementFlag : 0);
+
+   for(Index = 0; Index < Length; Index++)
+      TransferBuffer[Index + 1] = Writes[Index].Value;
+
+   TransferWrites = Length;
+
+   QueueStatistics.Transfers++;
+
+   ret_val = (HAL_I2C_Master_Transmit_DMA(&I2C_HANDLE, (uint16_t)(Device->Address << 1), TransferBuffer, (uint16_t)(Length + 1)) == HAL_OK);
+
+   return(ret_val);
+}
+
+   /* The following function services the queue until a transfer has    */
+   /* been started or the queue is empty, calling the callback of each  */
+   /* sequence that has completed.  It is only called by the owner of   */
+   /* the active queue.                                                 */
+static void ServiceQueue(void)
+{
+   int                 Waiting;
+   int                 Status;
+   unsigned int        DeviceID;
+   unsigned long       InterruptState;
+   unsigned long       CallbackParameter;
+   Sequence_t         *Sequence;
+   I2CQUEUE_Callback_t Callback;
+
+   Waiting = 0;
+
+   while(!Waiting)
+   {
+      SaveAndDisableInterrupts(InterruptState);
+
+      if(NumberSequences)
+         Sequence = &Sequences[FirstSequence];
+      else
+      {
+         Sequence = NULL;
+         Active   = 0;
+
+         LOWPOWER_AllowStop(LOWPOWER_LOCK_I2C_QUEUE);
+      }
+
+      RestoreInterrupts(InterruptState);
+
+      if(Sequence)
+      {
+         if(Sequence->Position < Sequence->NumberWrites)
+         {
+            if(StartTransfer(Sequence))
+               Waiting = 1;
+            else
+               FailSequence(Sequence);
+         }
+         else
+         {
+            /* The sequence is removed before its callback is called,   */
+            /* which may queue another one.                             */
+            DeviceID          = Sequence->DeviceID;
+            Status            = Sequence->Status;
+            Callback          = Sequence->Callback;
+            CallbackParameter = Sequence->CallbackParameter;
+
+            SaveAndDisableInterrupts(InterruptState);
+
+            FirstSequence = (FirstSequence + 1) % I2CQUEUE_MAXIMUM_SEQUENCES;
+            NumberSequences--;
+
+            RestoreInterrupts(InterruptState);
+
+            if(Callback)
+               (*Callback)(DeviceID, Status, CallbackParameter);
+         }
+      }
+      else
+         Waiting = 1;
+   }
+}
+
+   /* The following function is called from the I2C interrupts when the */
+   /* current transfer has been sent (Status is zero) or has failed.    */
+static void TransferComplete(int Status)
+{
+   Sequence_t *Sequence;
+
+   if(Active)
+   {
+      Sequence = &Sequences[FirstSequence];
+
+      if(!Status)
+         Sequence->Position += TransferWrites;
+      else
+         FailSequence(Sequence);
+
+      TransferWrites = 0;
+
+      ServiceQueue();
+   }
+}
+
+   /* The following function is the HAL callback that is called when a  */
+   /* DMA transmission of a master has completed.                       */
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+   if(hi2c == &I2C_HANDLE)
+      TransferComplete(0);
+}
+
+   /* The following function is the HAL callback that is called when an */
+   /* I2C error (e.g. the device did not acknowledge) occurs.           */
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+   if(hi2c == &I2C_HANDLE)
+      TransferComplete(I2CQUEUE_ERROR_TRANSFER_FAILED);
+}
+
+   /* The following function registers the device at the specified 7 bit*/
+   /* address.  If the second parameter is non-zero the device          */
+   /* increments its register address after each write, once the third  */
+   /* parameter has been OR'ed into the register address (zero if it    */
+   /* always does).  This function returns the ID of the device (used   */
+   /* with the other functions) if successful or a negative value if    */
+   /* there was an error.                                               */
+int I2CQUEUE_Register_Device(unsigned int Address, int AutoIncrement, unsigned int IncrementFlag)
+{
+   int           ret_val;
+   unsigned long InterruptState;
+
+   if((Address <= 0x7F) && (IncrementFlag <= 0xFF))
+   {
+      SaveAndDisableInterrupts(InterruptState);
+
+      if(NumberDevices < I2CQUEUE_MAXIMUM_DEVICES)
+      {
+         memset(&Devices[NumberDevices], 0, sizeof(Device_t));
+
+         Devices[NumberDevices].Address       = Address;
+         Devices[NumberDevices].AutoIncrement = AutoIncrement;
+         Devices[NumberDevices].IncrementFlag = (unsigned char)IncrementFlag;
+
+         ret_val                              = (int)NumberDevices++;
+      }
+      else
+         ret_val = I2CQUEUE_ERROR_QUEUE_FULL;
+
+      RestoreInterrupts(InterruptState);
+   }
+   else
+      ret_val = I2CQUEUE_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* The following function forgets the shadow of every register of the*/
+   /* specified device, so that the next write of each register is sent.*/
+   /* It must be called once the device has been reset.                 */
+void I2CQUEUE_Invalidate(unsigned int DeviceID)
+{
+   unsigned long InterruptState;
+
+   if(DeviceID < NumberDevices)
+   {
+      SaveAndDisableInterrupts(InterruptState);
+
+      memset(Devices[DeviceID].Valid, 0, sizeof(Devices[DeviceID].Valid));
+
+      RestoreInterrupts(InterruptState);
+   }
+}
+
+   /* The following function queues the specified register writes to the*/
+   /* specified device, which are sent in order.  The writes are copied,*/
+   /* so the array does not have to be kept.  The callback (which may be*/
+   /* NULL) is called once the sequence has been sent.  This function   */
+   /* returns zero if successful or a negative value if there was an    */
+   /* error.                                                            */
+int I2CQUEUE_Write_Sequence(unsigned int DeviceID, unsigned int NumberWrites, const I2CQUEUE_Write_t *Writes, I2CQUEUE_Callback_t Callback, unsigned long CallbackParameter)
+{
+   int            ret_val;
+   int            Start;
+   unsigned int   Index;
+   unsigned int   Register;
+   unsigned long  InterruptState;
+   Device_t      *Device;
+   Sequence_t    *Sequence;
+
+   Start = 0;
+
+   if((DeviceID < NumberDevices) && (NumberWrites) && (NumberWrites <= I2CQUEUE_MAXIMUM_WRITES) && (Writes))
+   {
+      SaveAndDisableInterrupts(InterruptState);
+
+      if(NumberSequences < I2CQUEUE_MAXIMUM_SEQUENCES)
+      {
+         Device                      = &Devices[DeviceID];
+         Sequence                    = &Sequences[(FirstSequence + NumberSequences) % I2CQUEUE_MAXIMUM_SEQUENCES];
+
+         Sequence->DeviceID          = DeviceID;
+         Sequence->NumberWrites      = 0;
+         Sequence->Position          = 0;
+         Sequence->Status            = 0;
+         Sequence->Callback          = Callback;
+         Sequence->CallbackParameter = CallbackParameter;
+
+         /* The shadow holds the value each register will have once the */
+         /* queued writes have been sent, so a write of the same value  */
+         /* is dropped.                                                 */
+         for(Index = 0; Index < NumberWrites; Index++)
+         {
+            Register = Writes[Index].Register;
+
+            if((Device->Valid[Register >> 3] & (1 << (Register & 0x07))) && (Device->Shadow[Register] == Writes[Index].Value))
+               QueueStatistics.SkippedWrites++;
+            else
+            {
+               Sequence->Writes[Sequence->NumberWrites++]  = Writes[Index];
+
+               Device->Shadow[Register]                    = Writes[Index].Value;
+               Device->Valid[Register >> 3]               |= (unsigned char)(1 << (Register & 0x07));
+            }
+         }
+
+         NumberSequences++;
+
+         QueueStatistics.Sequences++;
+
+         /* The caller services an idle queue until the first transfer  */
+         /* has been started, the interrupts do from then on.           */
+         if(!Active)
+         {
+            Active = 1;
+            Start  = 1;
+
+            LOWPOWER_PreventStop(LOWPOWER_LOCK_I2C_QUEUE);
+         }
+
+         ret_val = 0;
+      }
+      else
+         ret_val = I2CQUEUE_ERROR_QUEUE_FULL;
+
+      RestoreInterrupts(InterruptState);
+
+      if(Start)
+         ServiceQueue();
+   }
+   else
+      ret_val = I2CQUEUE_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* The following function queues a single register write to the      */
+   /* specified device (see I2CQUEUE_Write_Sequence()).  This function  */
+   /* returns zero if successful or a negative value if there was an    */
+   /* error.                                                            */
+int I2CQUEUE_Write_Register(unsigned int DeviceID, unsigned int Register, unsigned int Value, I2CQUEUE_Callback_t Callback, unsigned long CallbackParameter)
+{
+   int              ret_val;
+   I2CQUEUE_Write_t Write;
+
+   if((Register <= 0xFF) && (Value <= 0xFF))
+   {
+      Write.Register = (unsigned char)Register;
+      Write.Value    = (unsigned char)Value;
+
+      ret_val        = I2CQUEUE_Write_Sequence(DeviceID, 1, &Write, Callback, CallbackParameter);
+   }
+   else
+      ret_val = I2CQUEUE_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* The following function returns the value that the specified       */
+   /* register of the specified device holds once the queued writes have*/
+   /* been sent, so that a field of a register can be changed without   */
+   /* reading it.  This function returns the value if it is known or a  */
+   /* negative value if it is not.                                      */
+int I2CQUEUE_Query_Register(unsigned int DeviceID, unsigned int Register)
+{
+   int           ret_val;
+   unsigned long InterruptState;
+
+   if((DeviceID < NumberDevices) && (Register <= 0xFF))
+   {
+      SaveAndDisableInterrupts(InterruptState);
+
+      if(Devices[DeviceID].Valid[Register >> 3] & (1 << (Register & 0x07)))
+         ret_val = (int)Devices[DeviceID].Shadow[Register];
+      else
+         ret_val = I2CQUEUE_ERROR_INVALID_PARAMETER;
+
+      RestoreInterrupts(InterruptState);
+   }
+   else
+      ret_val = I2CQUEUE_ERROR_INVALID_PARAMETER;
+
+   return(ret_val);
+}
+
+   /* The following function returns the statistics of the queue in the */
+   /* specified structure and, if the second parameter is non-zero,     */
+   /* resets them.                                                      */
+void I2CQUEUE_Query_Statistics(I2CQUEUE_Statistics_t *Statistics, int Reset)
+{
+   unsigned long InterruptState;
+
+   if(Statistics)
+   {
+      SaveAndDisableInterrupts(InterruptState);
+
+      *Statistics = QueueStatistics;
+
+      if(Reset)
+         memset(&QueueStatistics, 0, sizeof(QueueStatistics));
+
+      RestoreInterrupts(InterruptState);
+   }
+}
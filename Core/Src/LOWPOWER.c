@@ -0,0 +1,268 @@
+/*****< lowpower.c >**********************************************************/
+/*                                                                           */
+/*  LOWPOWER - FreeRTOS tickless idle with STOP2 for the STM32L4R5.          */
+/*                                                                           */
+/*****************************************************************************/
+
+#include <string.h>
+
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "LOWPOWER.h"
+
+   /* LPTIM1 is clocked from the LSE divided by 32, giving 1024 counts  */
+   /* per second.                                                       */
+#define LPTIM_PRESCALER           (LPTIM_CFGR_PRESC_2 | LPTIM_CFGR_PRESC_0)
+#define LPTIM_CLOCK_FREQUENCY     (LSE_VALUE / 32)
+#define LPTIM_MAXIMUM_COUNT       0xFFFF
+
+   /* The following defines the shortest expected idle time (in ticks)  */
+   /* for which STOP2 is entered.  Waking from STOP2 restarts the PLLs, */
+   /* which is not worth it for shorter periods.                        */
+#define MINIMUM_STOP_TICKS        5
+
+   /* The following defines the longest STOP2 period (in ticks) that    */
+   /* can be timed by LPTIM1.                                           */
+#define MAXIMUM_STOP_TICKS        ((TickType_t)(((unsigned long long)LPTIM_MAXIMUM_COUNT * configTICK_RATE_HZ) / LPTIM_CLOCK_FREQUENCY))
+
+   /* The following defines the number of iterations of the delay loop  */
+   /* that runs at the intermediate AHB frequency when SYSCLK is        */
+   /* switched back to the PLL (at least 1 microsecond).                */
+#define AHB_TRANSITION_DELAY      64
+
+   /* The following macros save, disable and restore the interrupt      */
+   /* state so that the locks may be changed from an interrupt.         */
+#define SaveAndDisableInterrupts(_x) do { (_x) = __get_PRIMASK(); __disable_irq(); } while(0)
+#define RestoreInterrupts(_x)        __set_PRIMASK(_x)
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+static volatile unsigned long StopLocks = LOWPOWER_LOCK_HCI_TRANSPORT;
+static unsigned long          CountRemainder;
+static LOWPOWER_Statistics_t  LowPowerStatistics;
+
+   /* Local Function Prototypes.                                        */
+static unsigned long ReadCounter(void);
+static void RestoreClocks(unsigned long PLLs, unsigned long AHBPrescaler);
+
+   /* The following function reads the counter of LPTIM1.  The counter  */
+   /* is clocked asynchronously so it must be read until two            */
+   /* consecutive reads match.                                          */
+static unsigned long ReadCounter(void)
+{
+   unsigned long Count;
+
+   do
+   {
+      Count = LPTIM1->CNT;
+   } while(Count != LPTIM1->CNT);
+
+   return(Count);
+}
+
+   /* The following function restarts the specified PLLs (RCC_CR ON     */
+   /* bits) after the MCU has woken from STOP2 (on the MSI) and         */
+   /* switches SYSCLK back to the main PLL.                             */
+static void RestoreClocks(unsigned long PLLs, unsigned long AHBPrescaler)
+{
+   volatile unsigned int Delay;
+
+   /* The ready bit of each PLL follows its on bit.                     */
+   RCC->CR |= PLLs;
+   while((RCC->CR & (PLLs << 1)) != (PLLs << 1)) {}
+
+   if(PLLs & RCC_CR_PLLON)
+   {
+      /* Step through an intermediate AHB frequency on the way up to    */
+      /* the full speed (see the Reference Manual, RCC_CFGR).           */
+      MODIFY_REG(RCC->CFGR, RCC_CFGR_HPRE, RCC_CFGR_HPRE_DIV2);
+      MODIFY_REG(RCC->CFGR, RCC_CFGR_SW, RCC_CFGR_SW_PLL);
+      while((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_PLL) {}
+
+      for(Delay = 0; Delay < AHB_TRANSITION_DELAY; Delay++) {}
+
+      MODIFY_REG(RCC->CFGR, RCC_CFGR_HPRE, AHBPrescaler);
+   }
+}
+
+   /* The following function configures LPTIM1 (clocked from the LSE)   */
+   /* that times the STOP2 periods.  This function must be called before*/
+   /* the scheduler is started.                                         */
+void LOWPOWER_Initialize(void)
+{
+   /* LPTIM1 keeps running in STOP2 when it is clocked from the LSE.    */
+   MODIFY_REG(RCC->CCIPR, RCC_CCIPR_LPTIM1SEL, RCC_CCIPR_LPTIM1SEL_1 | RCC_CCIPR_LPTIM1SEL_0);
+   RCC->APB1ENR1 |= RCC_APB1ENR1_LPTIM1EN;
+   (void)RCC->APB1ENR1;
+
+   /* The configuration and interrupt enable registers may only be      */
+   /* written while the timer is disabled.                              */
+   LPTIM1->CR   = 0;
+   LPTIM1->CFGR = LPTIM_PRESCALER;
+   LPTIM1->IER  = LPTIM_IER_ARRMIE;
+
+   /* The autoreload match wakes the MCU through EXTI line 32.          */
+   EXTI->IMR2 |= EXTI_IMR2_IM32;
+
+   HAL_NVIC_SetPriority(LPTIM1_IRQn, configLIBRARY_LOWEST_INTERRUPT_PRIORITY, 0);
+   HAL_NVIC_EnableIRQ(LPTIM1_IRQn);
+
+   /* Wake up from STOP2 on the MSI, which is the PLL source.           */
+   __HAL_RCC_WAKEUPSTOP_CLK_CONFIG(RCC_STOP_WAKEUPCLOCK_MSI);
+}
+
+   /* The following function takes the specified lock(s), preventing    */
+   /* the MCU from entering STOP2.  This function may be called from an */
+   /* interrupt.                                                        */
+void LOWPOWER_PreventStop(unsigned long Locks)
+{
+   unsigned long Mask;
+
+   SaveAndDisableInterrupts(Mask);
+
+   StopLocks |= Locks;
+
+   RestoreInterrupts(Mask);
+}
+
+   /* The following function releases the specified lock(s).  This      */
+   /* function may be called from an interrupt.                         */
+void LOWPOWER_AllowStop(unsigned long Locks)
+{
+   unsigned long Mask;
+
+   SaveAndDisableInterrupts(Mask);
+
+   StopLocks &= ~Locks;
+
+   RestoreInterrupts(Mask);
+}
+
+   /* The following function returns the low power statistics in the    */
+   /* specified structure and, if the second parameter is non-zero,     */
+   /* resets them.                                                      */
+void LOWPOWER_QueryStatistics(LOWPOWER_Statistics_t *Statistics, int Reset)
+{
+   unsigned long Mask;
+
+   if(Statistics)
+   {
+      SaveAndDisableInterrupts(Mask);
+
+      *Statistics = LowPowerStatistics;
+
+      if(Reset)
+         memset(&LowPowerStatistics, 0, sizeof(LowPowerStatistics));
+
+      RestoreInterrupts(Mask);
+   }
+}
+
+   /* The following function is called by the idle task (with the       */
+   /* scheduler suspended) when no task is due for at least             */
+   /* configEXPECTED_IDLE_TIME_BEFORE_SLEEP ticks (see                  */
+   /* configUSE_TICKLESS_IDLE in FreeRTOSConfig.h).                     */
+   /* * NOTE * Interrupts are masked with PRIMASK while the MCU is      */
+   /*          stopped so that the interrupt that woke it only runs     */
+   /*          once the clocks and the tick count have been restored.   */
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime)
+{
+   unsigned long PLLs;
+   unsigned long AHBPrescaler;
+   unsigned long Counts;
+   unsigned long ElapsedCounts;
+   TickType_t    ElapsedTicks;
+
+   __disable_irq();
+   __DSB();
+   __ISB();
+
+   /* A task may have been made ready by an interrupt after the idle    */
+   /* task decided to sleep.                                            */
+   if(eTaskConfirmSleepModeStatus() != eAbortSleep)
+   {
+      if((StopLocks) || (xExpectedIdleTime < MINIMUM_STOP_TICKS))
+      {
+         /* Wait for the next interrupt (at the latest the tick) with   */
+         /* the clocks running.                                         */
+         LowPowerStatistics.SleepCount++;
+
+         __DSB();
+         __WFI();
+         __ISB();
+      }
+      else
+      {
+         if(xExpectedIdleTime > MAXIMUM_STOP_TICKS)
+            xExpectedIdleTime = MAXIMUM_STOP_TICKS;
+
+         /* Stop the tick, the part of the current tick period that has */
+         /* already elapsed is lost.                                    */
+         SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+
+         /* Wake up one tick early to allow for restarting the PLLs.    */
+         Counts = ((unsigned long)(xExpectedIdleTime - 1) * LPTIM_CLOCK_FREQUENCY) / configTICK_RATE_HZ;
+
+         LPTIM1->ICR = LPTIM_ICR_ARRMCF | LPTIM_ICR_ARROKCF;
+         LPTIM1->CR  = LPTIM_CR_ENABLE;
+         LPTIM1->ARR = Counts;
+         while(!(LPTIM1->ISR & LPTIM_ISR_ARROK)) {}
+         LPTIM1->ICR = LPTIM_ICR_ARROKCF;
+         LPTIM1->CR  = LPTIM_CR_ENABLE | LPTIM_CR_SNGSTRT;
+
+         /* Note the clocks that are running so that they can be        */
+         /* restored.                                                   */
+         PLLs         = RCC->CR & (RCC_CR_PLLON | RCC_CR_PLLSAI1ON | RCC_CR_PLLSAI2ON);
+         AHBPrescaler = RCC->CFGR & RCC_CFGR_HPRE;
+
+         HAL_PWREx_EnterSTOP2Mode(PWR_STOPENTRY_WFI);
+
+         RestoreClocks(PLLs, AHBPrescaler);
+
+         /* Determine how long the MCU was stopped.  The counter returns*/
+         /* to zero once it reaches the autoreload value, so the match  */
+         /* flag is checked after the counter is read.                  */
+         ElapsedCounts = ReadCounter();
+         if(LPTIM1->ISR & LPTIM_ISR_ARRM)
+            ElapsedCounts = Counts;
+
+         LPTIM1->ICR = LPTIM_ICR_ARRMCF;
+         LPTIM1->CR  = 0;
+         NVIC_ClearPendingIRQ(LPTIM1_IRQn);
+
+         /* Convert to ticks, carrying the fraction of a tick over to   */
+         /* the next period so that the tick count does not drift.      */
+         ElapsedCounts  = (ElapsedCounts * configTICK_RATE_HZ) + CountRemainder;
+         ElapsedTicks   = (TickType_t)(ElapsedCounts / LPTIM_CLOCK_FREQUENCY);
+         CountRemainder = ElapsedCounts % LPTIM_CLOCK_FREQUENCY;
+
+         if(ElapsedTicks > xExpectedIdleTime)
+            ElapsedTicks = xExpectedIdleTime;
+
+         vTaskStepTick(ElapsedTicks);
+
+         /* The HAL time base was stopped as well.                      */
+         uwTick += (uint32_t)((ElapsedTicks * 1000) / configTICK_RATE_HZ);
+
+         LowPowerStatistics.StopCount++;
+         LowPowerStatistics.StopTime += ElapsedTicks;
+         if(ElapsedTicks > LowPowerStatistics.LongestStop)
+            LowPowerStatistics.LongestStop = ElapsedTicks;
+
+         /* Restart the tick from the start of a period.                */
+         SysTick->VAL   = 0;
+         SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+      }
+   }
+
+   __enable_irq();
+}
+
+   /* The following function is the LPTIM1 interrupt handler.  The      */
+   /* interrupt is only used to wake the MCU from STOP2.                */
+void LPTIM1_IRQHandler(void)
+{
+   LPTIM1->ICR = LPTIM_ICR_ARRMCF;
+}
@@ -27,6 +27,7 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "HCITRANS.h"            /* HCI Transport Prototypes/Constants.       */
+#include "HCITRCFG.h"            /* HCI Transport configuration.              */
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -286,9 +287,16 @@ static void StartBluetoothAudioTask(void *UserParameter)
   HCI_Driver_Reconfigure_Data_t DriverReconfigureData;
 
   /* Configure the UART Parameters. 								   */
-  //HCI_DRIVER_SET_COMM_INFORMATION(&HCI_DriverInformation, 1, 921600, cpHCILL_RTS_CTS);
-  HCI_DRIVER_SET_COMM_INFORMATION(&HCI_DriverInformation, 1, 115200, cpHCILL_RTS_CTS);
+  HCI_DRIVER_SET_COMM_INFORMATION(&HCI_DriverInformation, 1, 921600, cpHCILL_RTS_CTS);
+  //HCI_DRIVER_SET_COMM_INFORMATION(&HCI_DriverInformation, 1, 115200, cpHCILL_RTS_CTS);
+#ifdef HCITR_ENABLE_FAST_BOOT
+  /* HCITR_COMOpen() returns once the controller has started (and has  */
+  /* been switched to the baud rate above), so Bluetopia need not wait */
+  /* before the first command.                                         */
+  HCI_DriverInformation.DriverInformation.COMMDriverInformation.InitializationDelay = 0;
+#else
   HCI_DriverInformation.DriverInformation.COMMDriverInformation.InitializationDelay = 2000;
+#endif
 
   /* Set up the application callbacks.								   */
   BTPS_Initialization.MessageOutputCallback = DisplayCallback;
@@ -300,7 +308,7 @@ static void StartBluetoothAudioTask(void *UserParameter)
 	 if((HCI_DriverInformation.DriverInformation.COMMDriverInformation.Protocol == cpHCILL) || (HCI_DriverInformation.DriverInformation.COMMDriverInformation.Protocol == cpHCILL_RTS_CTS))
 	 {
 		HCILLConfig.SleepCallbackFunction		 = Sleep_Indication_Callback;
-		HCILLConfig.SleepCallbackParameter		 = 0;
+		HCILLConfig.SleepCallbackParameter		 = (unsigned long)Result;
 		DriverReconfigureData.ReconfigureCommand = HCI_COMM_DRIVER_RECONFIGURE_DATA_COMMAND_CHANGE_HCILL_PARAMETERS;
 		DriverReconfigureData.ReconfigureData	 = (void *)&HCILLConfig;
 
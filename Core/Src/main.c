@@ -32,12 +32,14 @@
 #include "sai.h"
 #include "sdmmc.h"
 #include "spi.h"
+#include "tim.h"
 #include "usb_device.h"
 #include "gpio.h"
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "stm32l4xx_it.h"
+#include "LOWPOWER.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -107,7 +109,7 @@ int main(void)
   MX_LPUART1_UART_Init();
   MX_USART3_UART_Init();
   MX_DMA_Init();
-  //MX_ADC1_Init();
+  MX_ADC1_Init();
   MX_DAC1_Init();
   MX_I2C1_Init();
   MX_I2C2_Init();
@@ -123,7 +125,9 @@ int main(void)
   MX_RTC_Init();
   MX_FATFS_Init();
   MX_SAI2_Init();
+  MX_TIM6_Init();
   /* USER CODE BEGIN 2 */
+  LOWPOWER_Initialize();
 
   /* USER CODE END 2 */
 
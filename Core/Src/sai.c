@@ -177,10 +177,10 @@ void HAL_SAI_MspInit(SAI_HandleTypeDef* saiHandle)
     hdma_sai1_a.Init.Direction = DMA_MEMORY_TO_PERIPH;
     hdma_sai1_a.Init.PeriphInc = DMA_PINC_DISABLE;
     hdma_sai1_a.Init.MemInc = DMA_MINC_ENABLE;
-    hdma_sai1_a.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
-    hdma_sai1_a.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
-    hdma_sai1_a.Init.Mode = DMA_NORMAL;
-    hdma_sai1_a.Init.Priority = DMA_PRIORITY_LOW;
+    hdma_sai1_a.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    hdma_sai1_a.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    hdma_sai1_a.Init.Mode = DMA_CIRCULAR;
+    hdma_sai1_a.Init.Priority = DMA_PRIORITY_HIGH;
     if (HAL_DMA_Init(&hdma_sai1_a) != HAL_OK)
     {
       Error_Handler();
@@ -190,6 +190,10 @@ void HAL_SAI_MspInit(SAI_HandleTypeDef* saiHandle)
      Be aware that there is only one channel to perform all the requested DMAs. */
     __HAL_LINKDMA(saiHandle,hdmarx,hdma_sai1_a);
     __HAL_LINKDMA(saiHandle,hdmatx,hdma_sai1_a);
+
+    /* SAI1 interrupt Init */
+    HAL_NVIC_SetPriority(SAI1_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(SAI1_IRQn);
     }
     if(saiHandle->Instance==SAI1_Block_B)
     {
@@ -217,10 +221,10 @@ void HAL_SAI_MspInit(SAI_HandleTypeDef* saiHandle)
     hdma_sai1_b.Init.Direction = DMA_PERIPH_TO_MEMORY;
     hdma_sai1_b.Init.PeriphInc = DMA_PINC_DISABLE;
     hdma_sai1_b.Init.MemInc = DMA_MINC_ENABLE;
-    hdma_sai1_b.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
-    hdma_sai1_b.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
-    hdma_sai1_b.Init.Mode = DMA_NORMAL;
-    hdma_sai1_b.Init.Priority = DMA_PRIORITY_LOW;
+    hdma_sai1_b.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    hdma_sai1_b.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    hdma_sai1_b.Init.Mode = DMA_CIRCULAR;
+    hdma_sai1_b.Init.Priority = DMA_PRIORITY_HIGH;
     if (HAL_DMA_Init(&hdma_sai1_b) != HAL_OK)
     {
       Error_Handler();
@@ -230,6 +234,10 @@ void HAL_SAI_MspInit(SAI_HandleTypeDef* saiHandle)
      Be aware that there is only one channel to perform all the requested DMAs. */
     __HAL_LINKDMA(saiHandle,hdmarx,hdma_sai1_b);
     __HAL_LINKDMA(saiHandle,hdmatx,hdma_sai1_b);
+
+    /* SAI1 interrupt Init */
+    HAL_NVIC_SetPriority(SAI1_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(SAI1_IRQn);
     }
 /* SAI2 */
     if(saiHandle->Instance==SAI2_Block_A)
@@ -340,6 +348,9 @@ void HAL_SAI_MspDeInit(SAI_HandleTypeDef* saiHandle)
 
     HAL_DMA_DeInit(saiHandle->hdmarx);
     HAL_DMA_DeInit(saiHandle->hdmatx);
+
+    /* SAI1 interrupt DeInit */
+    HAL_NVIC_DisableIRQ(SAI1_IRQn);
     }
     if(saiHandle->Instance==SAI1_Block_B)
     {
@@ -357,6 +368,9 @@ void HAL_SAI_MspDeInit(SAI_HandleTypeDef* saiHandle)
 
     HAL_DMA_DeInit(saiHandle->hdmarx);
     HAL_DMA_DeInit(saiHandle->hdmatx);
+
+    /* SAI1 interrupt DeInit */
+    HAL_NVIC_DisableIRQ(SAI1_IRQn);
     }
 /* SAI2 */
     if(saiHandle->Instance==SAI2_Block_A)
@@ -6,7 +6,17 @@
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
 ../Core/Src/AUDIO.c \
+../Core/Src/AUDIOCLK.c \
+../Core/Src/AUDIODC.c \
+../Core/Src/AUDIOFLT.c \
+../Core/Src/AUDIOJB.c \
+../Core/Src/AUDIOMIX.c \
+../Core/Src/AUDIOSBC.c \
+../Core/Src/AUDIOSRC.c \
+../Core/Src/AUDIOVOL.c \
 ../Core/Src/HAL.c \
+../Core/Src/I2CQUEUE.c \
+../Core/Src/LOWPOWER.c \
 ../Core/Src/adc.c \
 ../Core/Src/crc.c \
 ../Core/Src/dac.c \
@@ -26,11 +36,22 @@ C_SRCS += \
 ../Core/Src/syscalls.c \
 ../Core/Src/sysmem.c \
 ../Core/Src/system_stm32l4xx.c \
+../Core/Src/tim.c \
 ../Core/Src/usart.c 
 
 OBJS += \
 ./Core/Src/AUDIO.o \
+./Core/Src/AUDIOCLK.o \
+./Core/Src/AUDIODC.o \
+./Core/Src/AUDIOFLT.o \
+./Core/Src/AUDIOJB.o \
+./Core/Src/AUDIOMIX.o \
+./Core/Src/AUDIOSBC.o \
+./Core/Src/AUDIOSRC.o \
+./Core/Src/AUDIOVOL.o \
 ./Core/Src/HAL.o \
+./Core/Src/I2CQUEUE.o \
+./Core/Src/LOWPOWER.o \
 ./Core/Src/adc.o \
 ./Core/Src/crc.o \
 ./Core/Src/dac.o \
@@ -50,11 +71,22 @@ OBJS += \
 ./Core/Src/syscalls.o \
 ./Core/Src/sysmem.o \
 ./Core/Src/system_stm32l4xx.o \
+./Core/Src/tim.o \
 ./Core/Src/usart.o 
 
 C_DEPS += \
 ./Core/Src/AUDIO.d \
+./Core/Src/AUDIOCLK.d \
+./Core/Src/AUDIODC.d \
+./Core/Src/AUDIOFLT.d \
+./Core/Src/AUDIOJB.d \
+./Core/Src/AUDIOMIX.d \
+./Core/Src/AUDIOSBC.d \
+./Core/Src/AUDIOSRC.d \
+./Core/Src/AUDIOVOL.d \
 ./Core/Src/HAL.d \
+./Core/Src/I2CQUEUE.d \
+./Core/Src/LOWPOWER.d \
 ./Core/Src/adc.d \
 ./Core/Src/crc.d \
 ./Core/Src/dac.d \
@@ -74,6 +106,7 @@ C_DEPS += \
 ./Core/Src/syscalls.d \
 ./Core/Src/sysmem.d \
 ./Core/Src/system_stm32l4xx.d \
+./Core/Src/tim.d \
 ./Core/Src/usart.d 
 
 
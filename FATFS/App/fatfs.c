@@ -45,7 +45,16 @@ void MX_FATFS_Init(void)
 DWORD get_fattime(void)
 {
   /* USER CODE BEGIN get_fattime */
-  return 0;
+  RTC_TimeTypeDef Time;
+  RTC_DateTypeDef Date;
+
+  /* The date must be read after the time to unlock the shadow registers */
+  HAL_RTC_GetTime(&hrtc, &Time, RTC_FORMAT_BIN);
+  HAL_RTC_GetDate(&hrtc, &Date, RTC_FORMAT_BIN);
+
+  /* The RTC year is counted from 2000, the FAT year from 1980 */
+  return ((DWORD)(Date.Year + 20) << 25) | ((DWORD)Date.Month << 21) | ((DWORD)Date.Date << 16) |
+         ((DWORD)Time.Hours << 11) | ((DWORD)Time.Minutes << 5) | ((DWORD)Time.Seconds >> 1);
   /* USER CODE END get_fattime */
 }
 
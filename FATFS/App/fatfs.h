@@ -28,6 +28,7 @@
 #include "sd_diskio.h" /* defines SD_Driver as external */
 
 /* USER CODE BEGIN Includes */
+#include "rtc.h"
 
 /* USER CODE END Includes */
 
@@ -6,14 +6,29 @@
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
 ../Bluetooth/Src/A3DPDemo_SNK.c \
+../Bluetooth/Src/HCIH4.c \
+../Bluetooth/Src/HCIINIT.c \
+../Bluetooth/Src/HCIRING.c \
+../Bluetooth/Src/HCISLEEP.c \
+../Bluetooth/Src/HCISNOOP.c \
 ../Bluetooth/Src/HCITRANS.c 
 
 OBJS += \
 ./Bluetooth/Src/A3DPDemo_SNK.o \
+./Bluetooth/Src/HCIH4.o \
+./Bluetooth/Src/HCIINIT.o \
+./Bluetooth/Src/HCIRING.o \
+./Bluetooth/Src/HCISLEEP.o \
+./Bluetooth/Src/HCISNOOP.o \
 ./Bluetooth/Src/HCITRANS.o 
 
 C_DEPS += \
 ./Bluetooth/Src/A3DPDemo_SNK.d \
+./Bluetooth/Src/HCIH4.d \
+./Bluetooth/Src/HCIINIT.d \
+./Bluetooth/Src/HCIRING.d \
+./Bluetooth/Src/HCISLEEP.d \
+./Bluetooth/Src/HCISNOOP.d \
 ./Bluetooth/Src/HCITRANS.d 
 
 
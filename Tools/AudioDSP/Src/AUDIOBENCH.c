@@ -0,0 +1,2564 @@
+/*****< audiobench.c >*********************************************************/
+/*                                                                            */
+/*  AUDIOBENCH - Check and benchmark of the audio DSP modules on the host.    */
+/*                                                                            */
+/*  Each module is built from the firmware sources with the portable SIMD     */
+/*  instructions (see AUDIOSIMD.h).  The block version is checked bit for     */
+/*  bit against the reference version, with blocks of random lengths, and     */
+/*  both are then timed in periods of the default length.  The program exits  */
+/*  with a non zero status if any output differs.                             */
+/*                                                                            */
+/*  The times are those of the host and only compare the versions with each   */
+/*  other, the cycles on the target are measured by the audio task (see       */
+/*  AUDIO_Query_Statistics()).                                                */
+/*                                                                            */
+/******************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if (defined(__x86_64__) || defined(__i386__))
+
+#include <x86intrin.h>
+
+#define GetCycles()              __rdtsc()
+
+#else
+
+#define GetCycles()              0ULL
+
+#endif
+
+#include "AUDIOCLK.h"       /* Audio Clock Plan Prototypes/Constants.         */
+#include "AUDIODC.h"        /* Audio DC Removal Prototypes/Constants.         */
+#include "AUDIOFLT.h"       /* Audio Filter Bank Prototypes/Constants.        */
+#include "AUDIOJB.h"        /* Audio Jitter Buffer Prototypes/Constants.      */
+#include "AUDIOMIX.h"       /* Audio Mixer Prototypes/Constants.              */
+#include "AUDIOSBC.h"       /* Audio SBC Decoder Prototypes/Constants.        */
+#include "AUDIOSRC.h"       /* Audio Sample Rate Converter Prototypes.        */
+#include "AUDIOVOL.h"       /* Audio Volume Prototypes/Constants.             */
+
+   /* The following constants represent the defaults of the options.    */
+#define DEFAULT_SAMPLES          (1 << 20)
+#define DEFAULT_SEED             1
+
+   /* The following constants represent the length of the periods that  */
+   /* are timed and the largest block that is checked (the default and  */
+   /* the largest period of the audio pipeline, see AUDIOCFG.h).        */
+#define PERIOD_LENGTH            240
+#define MAXIMUM_BLOCK_LENGTH     480
+
+   /* The following constants represent the parameters of the DC removal*/
+   /* of the microphone (see AUDIO.c).                                  */
+#define MIC_ZERO_SAMPLE          0x1E40
+#define MIC_GAIN_SHIFT           1
+#define MIC_THRESHOLD            800
+
+   /* The following constants represent the parameters of the checks of */
+   /* the sample rate converter: the length of the tones (in seconds)   */
+   /* and the number of output frames that are skipped before they are  */
+   /* measured, the length of the drift simulation and the part of it   */
+   /* that is measured (in seconds), the target fill level (40 ms at    */
+   /* 44.1 kHz) and the size of the bursts in which the stream arrives, */
+   /* and the largest error of the average correction (in ppb).         */
+#define TONE_LENGTH              4
+#define TONE_SETTLE_FRAMES       4800
+#define DRIFT_LENGTH             400
+#define DRIFT_MEASURE_LENGTH     100
+#define DRIFT_TARGET_FRAMES      1764
+#define DRIFT_BURST_FRAMES       512
+#define DRIFT_TOLERANCE          5000
+
+   /* The following constants represent the parameters of the           */
+   /* simulation of the jitter buffer: the length (in seconds), the     */
+   /* size of the buffer and the smallest latency (see AUDIOCFG.h), the */
+   /* number of frames in each packet of the stream (at 44.1 kHz) and   */
+   /* the largest random delay of a packet (in microseconds).           */
+#define JITTER_LENGTH            120
+#define JITTER_BUFFER_FRAMES     8192
+#define JITTER_LATENCY           40
+#define JITTER_PACKET_FRAMES     512
+#define JITTER_DELAY             4000
+
+   /* The following constants represent the parameters of the checks of */
+   /* the SBC decoder: the length of each stream (in seconds), the      */
+   /* largest frame that is encoded, and the largest difference of a    */
+   /* sample from the floating point decoder (or from the samples of a  */
+   /* reference vector) and the smallest signal to noise ratio against  */
+   /* it (in dB).  The history of the windowing is held in 16 bits at   */
+   /* half the scale of the output, which limits the decoder to about   */
+   /* 77 dB against the floating point decoder.                         */
+#define SBC_LENGTH               2
+#define SBC_MAXIMUM_FRAME_LENGTH 1024
+#define SBC_TOLERANCE            16
+#define SBC_MINIMUM_SNR          74.0
+
+   /* The following constants represent the parameters of the check of  */
+   /* the mixer: the number of sources and the fade (50 ms at 48 kHz,   */
+   /* see AUDIOCFG.h).                                                  */
+#define MIX_SOURCES              2
+#define MIX_FADE_FRAMES          2400
+
+   /* The following constants represent the parameters of the checks of */
+   /* the volume stage: the number of changes of the volume or mute     */
+   /* along the signal, the longest ramp of a change (in frames), the   */
+   /* ramp and its end level that are measured halfway (-40 dB over 20  */
+   /* ms at 48 kHz) and the largest error of that measurement (in dB).  */
+#define VOLUME_CHANGES           64
+#define VOLUME_MAXIMUM_RAMP      960
+#define VOLUME_MEASURE_FRAMES    960
+#define VOLUME_MEASURE_LEVEL     80
+#define VOLUME_TOLERANCE         0.5
+
+   /* The following are the filters that are checked besides the        */
+   /* default sets: a 31 tap low pass FIR (an odd number of taps) and a */
+   /* Q15 biquad low pass at 3400 Hz (16 kHz), alone and in a cascade   */
+   /* with every type of stage.                                         */
+static const short LowPassFIR[] =
+{
+       0,   -64,   -56,    86,   209,     0,  -439,  -377,   515,  1128,
+       0, -2103, -1864,  2944,  9820, 13107,  9820,  2944, -1864, -2103,
+       0,  1128,   515,  -377,  -439,     0,   209,    86,   -56,   -64,
+       0
+};
+
+static const short LowPassBiquad[AUDIOFLT_BIQUAD_COEFFICIENTS] = { 3721, 7442, 3721, -4533, 3033 };
+
+static const AUDIOFLT_Stage_Definition_t TestStages[] =
+{
+   { ftFIR_Q15, sizeof(LowPassFIR) / sizeof(LowPassFIR[0]), LowPassFIR, NULL },
+   { ftBiquad_Q15, 0, LowPassBiquad, NULL },
+   { ftBiquad_Q31, 0, NULL, NULL },
+   { ftFIR_Q15, 3, LowPassBiquad, NULL }
+};
+
+   /* The following structure holds the options of the program.         */
+typedef struct _tagOptions_t
+{
+   unsigned int  Samples;
+   unsigned long Seed;
+   char         *Vectors;
+   char         *Reference;
+} Options_t;
+
+   /* The following structure holds the time that a version took.       */
+typedef struct _tagTiming_t
+{
+   unsigned long long Nanoseconds;
+   unsigned long long Cycles;
+} Timing_t;
+
+   /* The following structure defines a tone that is converted to       */
+   /* measure the THD+N of the sample rate converter.                   */
+typedef struct _tagTone_t
+{
+   unsigned long InputRate;
+   unsigned long OutputRate;
+   long          Correction;
+   double        Frequency;
+} Tone_t;
+
+static const Tone_t Tones[] =
+{
+   { 44100, 48000,       0,   997.0 },
+   { 44100, 48000,  100000,   997.0 },
+   { 44100, 48000,       0, 10007.0 },
+   { 48000, 44100,       0,   997.0 },
+   { 48000, 48000, -100000,   997.0 }
+};
+
+   /* The following structure defines a scenario of the simulation of   */
+   /* the jitter buffer: every HiccupInterval milliseconds no packet    */
+   /* arrives for HiccupLength milliseconds (a coexistence hiccup) and  */
+   /* the packets that were held back then arrive at once.  A scenario  */
+   /* passes if there are at most MaximumUnderruns underruns.           */
+typedef struct _tagScenario_t
+{
+   char         *Name;
+   unsigned long HiccupInterval;
+   unsigned long HiccupLength;
+   unsigned long MaximumUnderruns;
+} Scenario_t;
+
+static const Scenario_t Scenarios[] =
+{
+   { "steady",          0,   0, 0 },
+   { "30 ms hiccups", 5000,  30, 0 },
+   { "100 ms hiccups", 7000, 100, 1 }
+};
+
+   /* The following structure defines the configuration of an SBC       */
+   /* stream (Frequency is the index of the sample rate in the header). */
+typedef struct _tagSBC_Configuration_t
+{
+   unsigned int Frequency;
+   unsigned int Blocks;
+   unsigned int ChannelMode;
+   unsigned int AllocationMethod;
+   unsigned int Subbands;
+   unsigned int Bitpool;
+} SBC_Configuration_t;
+
+   /* The following structure holds the state of the floating point SBC */
+   /* encoder: the history of the analysis (X) and of the synthesis (V) */
+   /* and the subbands of the last frame as they decode.                */
+typedef struct _tagSBC_Encoder_t
+{
+   SBC_Configuration_t Configuration;
+   double              Analysis[AUDIOSBC_CHANNELS][AUDIOSBC_MAXIMUM_SUBBANDS * AUDIOSBC_TAPS];
+   double              Synthesis[AUDIOSBC_CHANNELS][AUDIOSBC_MAXIMUM_SUBBANDS * AUDIOSBC_TAPS * 2];
+   double              Subband[AUDIOSBC_MAXIMUM_BLOCKS][AUDIOSBC_CHANNELS][AUDIOSBC_MAXIMUM_SUBBANDS];
+} SBC_Encoder_t;
+
+   /* The following configurations are checked besides every combination*/
+   /* of subbands, blocks, channel mode and allocation method: the      */
+   /* smallest and the largest bit pools, and the usual A2DP high       */
+   /* quality streams, which are timed.                                 */
+static const SBC_Configuration_t SBCConfigurations[] =
+{
+   { 3, 16, AUDIOSBC_CHANNEL_MODE_JOINT_STEREO, AUDIOSBC_ALLOCATION_LOUDNESS, 8,   2 },
+   { 1,  4, AUDIOSBC_CHANNEL_MODE_MONO,         AUDIOSBC_ALLOCATION_SNR,      4,  64 },
+   { 2, 16, AUDIOSBC_CHANNEL_MODE_DUAL_CHANNEL, AUDIOSBC_ALLOCATION_LOUDNESS, 8, 128 },
+   { 2, 12, AUDIOSBC_CHANNEL_MODE_STEREO,       AUDIOSBC_ALLOCATION_SNR,      8, 250 },
+   { 2, 16, AUDIOSBC_CHANNEL_MODE_JOINT_STEREO, AUDIOSBC_ALLOCATION_LOUDNESS, 8,  53 },
+   { 3, 16, AUDIOSBC_CHANNEL_MODE_JOINT_STEREO, AUDIOSBC_ALLOCATION_LOUDNESS, 8,  51 }
+};
+
+#define SBC_TIMED_CONFIGURATIONS 2
+
+   /* The following tables hold the sample rates of the frequency field  */
+   /* of an SBC header and the names of the channel modes.              */
+static const unsigned long SBCSampleRates[4] = { 16000, 32000, 44100, 48000 };
+
+static char *SBCChannelModes[4] = { "mono", "dual channel", "stereo", "joint stereo" };
+
+   /* The following structure defines a change of the gain of a source  */
+   /* of the mixer, Offset frames after the specified eighth of the     */
+   /* signal.                                                           */
+typedef struct _tagMix_Change_t
+{
+   unsigned int Eighth;
+   unsigned int Offset;
+   unsigned int Source;
+   unsigned int Gain;
+} Mix_Change_t;
+
+   /* The following changes are made in turn: the first source fades in */
+   /* (and must then pass unchanged), the mixer cross-fades to the      */
+   /* second source, both are mixed at unity gain (which saturates),    */
+   /* then at the largest and at half gain, both are muted, and a fade  */
+   /* is interrupted by another change.                                 */
+static const Mix_Change_t MixChanges[] =
+{
+   { 0,    0, 0, AUDIOMIX_UNITY_GAIN       },
+   { 1,    0, 1, AUDIOMIX_UNITY_GAIN       },
+   { 1,    0, 0, 0                         },
+   { 2,    0, 0, AUDIOMIX_UNITY_GAIN       },
+   { 3,    0, 0, AUDIOMIX_MAXIMUM_GAIN     },
+   { 3,    0, 1, AUDIOMIX_UNITY_GAIN / 2   },
+   { 4,    0, 0, 0                         },
+   { 4,    0, 1, 0                         },
+   { 5,    0, 0, AUDIOMIX_UNITY_GAIN       },
+   { 5, 1000, 1, AUDIOMIX_UNITY_GAIN       },
+   { 6,    0, 0, AUDIOMIX_UNITY_GAIN / 3   }
+};
+
+   /* The following tables hold the prototype filters of the A2DP        */
+   /* specification (Proto_4_40 and Proto_8_80).                        */
+static const double SBCPrototype4[AUDIOSBC_TAPS * 4] =
+{
+    0.00000000E+00,  5.36548976E-04,  1.49188357E-03,  2.73370904E-03,
+    3.83720193E-03,  3.89205149E-03,  1.86581691E-03, -3.06012286E-03,
+    1.09137620E-02,  2.04385087E-02,  2.88757392E-02,  3.21939290E-02,
+    2.58767811E-02,  6.13245186E-03, -2.88217274E-02, -7.76463494E-02,
+    1.35593274E-01,  1.94987841E-01,  2.46636662E-01,  2.81828203E-01,
+    2.94315332E-01,  2.81828203E-01,  2.46636662E-01,  1.94987841E-01,
+   -1.35593274E-01, -7.76463494E-02, -2.88217274E-02,  6.13245186E-03,
+    2.58767811E-02,  3.21939290E-02,  2.88757392E-02,  2.04385087E-02,
+   -1.09137620E-02, -3.06012286E-03,  1.86581691E-03,  3.89205149E-03,
+    3.83720193E-03,  2.73370904E-03,  1.49188357E-03,  5.36548976E-04
+};
+
+static const double SBCPrototype8[AUDIOSBC_TAPS * 8] =
+{
+    0.00000000E+00,  1.56575398E-04,  3.43256425E-04,  5.54620202E-04,
+    8.23919506E-04,  1.13992507E-03,  1.47640169E-03,  1.78371725E-03,
+    2.01182542E-03,  2.10371989E-03,  1.99454554E-03,  1.61656283E-03,
+    9.02154502E-04, -1.78805361E-04, -1.64973098E-03, -3.49717454E-03,
+    5.65949473E-03,  8.02941163E-03,  1.04584443E-02,  1.27472335E-02,
+    1.46525263E-02,  1.59045603E-02,  1.62208471E-02,  1.53184106E-02,
+    1.29371806E-02,  8.85757540E-03,  2.92408442E-03, -4.91578024E-03,
+   -1.46404076E-02, -2.61098752E-02, -3.90751381E-02, -5.31873032E-02,
+    6.79989431E-02,  8.29847578E-02,  9.75753918E-02,  1.11196689E-01,
+    1.23264548E-01,  1.33264415E-01,  1.40753505E-01,  1.45389847E-01,
+    1.46955068E-01,  1.45389847E-01,  1.40753505E-01,  1.33264415E-01,
+    1.23264548E-01,  1.11196689E-01,  9.75753918E-02,  8.29847578E-02,
+   -6.79989431E-02, -5.31873032E-02, -3.90751381E-02, -2.61098752E-02,
+   -1.46404076E-02, -4.91578024E-03,  2.92408442E-03,  8.85757540E-03,
+    1.29371806E-02,  1.53184106E-02,  1.62208471E-02,  1.59045603E-02,
+    1.46525263E-02,  1.27472335E-02,  1.04584443E-02,  8.02941163E-03,
+   -5.65949473E-03, -3.49717454E-03, -1.64973098E-03, -1.78805361E-04,
+    9.02154502E-04,  1.61656283E-03,  1.99454554E-03,  2.10371989E-03,
+    2.01182542E-03,  1.78371725E-03,  1.47640169E-03,  1.13992507E-03,
+    8.23919506E-04,  5.54620202E-04,  3.43256425E-04,  1.56575398E-04
+};
+
+static Options_t     Options;
+static unsigned long RandomState;
+
+   /* Local Function Prototypes.                                        */
+static void Usage(char *Name);
+static int ParseOptions(int argc, char *argv[]);
+static unsigned long long GetNanoseconds(void);
+static unsigned long Random(void);
+static void GenerateMicrophone(unsigned int Length, short *Samples);
+static void GenerateFullRange(unsigned int Length, short *Samples);
+static void DisplayTiming(char *Name, unsigned int Length, Timing_t *Timing);
+static int CheckDC(char *Name, unsigned int Length, short *Input);
+static int CheckFilter(char *Name, const AUDIOFLT_Coefficient_Set_t *Set, unsigned int Length, short *Input);
+static int CheckFilters(char *Name, unsigned int Length, short *Input);
+static int CheckConverter(unsigned long InputRate, unsigned long OutputRate, unsigned int Length, short *Input);
+static double MeasureTone(unsigned long InputRate, unsigned long OutputRate, long Correction, double Frequency, Timing_t *Timing);
+static int CheckDrift(unsigned long InputRate, unsigned long OutputRate, long Drift);
+static int CheckJitterBuffer(const Scenario_t *Scenario);
+static unsigned int ComputeScaleFactor(double Maximum);
+static void AllocateSBCBits(const SBC_Configuration_t *Configuration, unsigned char ScaleFactors[][AUDIOSBC_MAXIMUM_SUBBANDS], unsigned char Bits[][AUDIOSBC_MAXIMUM_SUBBANDS]);
+static void WriteSBCBits(unsigned char *Frame, unsigned int *Position, unsigned int Bits, unsigned int Value);
+static void WriteSBCCRC(unsigned char *Frame, unsigned int Position);
+static unsigned int EncodeSBC(SBC_Encoder_t *Encoder, const short *Input, unsigned char *Frame);
+static void DecodeSBC(SBC_Encoder_t *Encoder, double *Output);
+static int CheckSBC(const SBC_Configuration_t *Configuration, int Timed);
+static int CheckSBCErrors(void);
+static int CheckSBCScaleFactors(void);
+static int CheckSBCVectors(char *StreamName, char *ReferenceName);
+static int CheckMixer(unsigned int Length, short *Input);
+static int CheckClockPlans(void);
+static int CheckVolumeLevels(void);
+static int CheckVolume(AUDIOVOL_Ramp_t Ramp, unsigned int Length, short *Input);
+
+   /* The following function displays the usage of the program.         */
+static void Usage(char *Name)
+{
+   fprintf(stderr, "Usage: %s [options]\n", Name);
+   fprintf(stderr, "   -n Samples         Number of samples of each signal (default %u).\n", DEFAULT_SAMPLES);
+   fprintf(stderr, "   -s Seed            Seed of the random signals (default %u).\n", DEFAULT_SEED);
+   fprintf(stderr, "   -v Stream          File of SBC frames (reference vectors) to decode.\n");
+   fprintf(stderr, "   -r Reference       File of the decoded samples of the stream (16 bit).\n");
+}
+
+   /* The following function parses the command line into the options.  */
+   /* The function returns zero if successful or a negative value if the*/
+   /* command line is not valid.                                        */
+static int ParseOptions(int argc, char *argv[])
+{
+   int ret_val;
+   int Option;
+
+   Options.Samples   = DEFAULT_SAMPLES;
+   Options.Seed      = DEFAULT_SEED;
+   Options.Vectors   = NULL;
+   Options.Reference = NULL;
+
+   ret_val = 0;
+
+   while((!ret_val) && ((Option = getopt(argc, argv, "n:r:s:v:")) != -1))
+   {
+      switch(Option)
+      {
+         case 'n':
+            Options.Samples = (unsigned int)strtoul(optarg, NULL, 0);
+            if(!Options.Samples)
+               ret_val = -1;
+            break;
+         case 'r':
+            Options.Reference = optarg;
+            break;
+         case 's':
+            Options.Seed = strtoul(optarg, NULL, 0);
+            break;
+         case 'v':
+            Options.Vectors = optarg;
+            break;
+         default:
+            ret_val = -1;
+            break;
+      }
+   }
+
+   if((!ret_val) && ((optind != argc) || ((Options.Reference) && (!Options.Vectors))))
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function returns the time (in nanoseconds) of the   */
+   /* monotonic clock.                                                  */
+static unsigned long long GetNanoseconds(void)
+{
+   struct timespec Now;
+
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+
+   return(((unsigned long long)Now.tv_sec * 1000000000ULL) + Now.tv_nsec);
+}
+
+   /* The following function returns the next (31 bit) pseudo random    */
+   /* number, which is the same on every host for the same seed.        */
+static unsigned long Random(void)
+{
+   RandomState = (RandomState * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+
+   return(RandomState >> 1);
+}
+
+   /* The following function generates a signal like that of the        */
+   /* microphone: 14 bit oversampled ADC codes of a drifting DC level, a*/
+   /* tone that comes and goes and some noise.                          */
+static void GenerateMicrophone(unsigned int Length, short *Samples)
+{
+   unsigned int Index;
+   long         Value;
+
+   for(Index = 0; Index < Length; Index++)
+   {
+      Value = MIC_ZERO_SAMPLE + (long)((Index >> 12) % 256) - 128;
+
+      if((Index >> 14) & 1)
+         Value += (long)(((Index * 37) % 3200) - 1600);
+
+      Value += (long)(Random() % 129) - 64;
+
+      Samples[Index] = (short)((Value < 0) ? 0 : ((Value > 16383) ? 16383 : Value));
+   }
+}
+
+   /* The following function generates random samples over the whole 16 */
+   /* bit range, to check the saturation.                               */
+static void GenerateFullRange(unsigned int Length, short *Samples)
+{
+   unsigned int Index;
+
+   for(Index = 0; Index < Length; Index++)
+      Samples[Index] = (short)(Random() >> 8);
+}
+
+   /* The following function displays the specified time of the         */
+   /* specified number of samples.                                      */
+static void DisplayTiming(char *Name, unsigned int Length, Timing_t *Timing)
+{
+   printf("   %-10s %8.2f ns/sample", Name, (double)Timing->Nanoseconds / Length);
+
+   if(Timing->Cycles)
+      printf(" %8.2f cycles/sample", (double)Timing->Cycles / Length);
+
+   printf("\n");
+}
+
+   /* The following function checks and times the DC removal on the     */
+   /* specified signal.  This function returns the number of samples    */
+   /* that differ.                                                      */
+static int CheckDC(char *Name, unsigned int Length, short *Input)
+{
+   int                ret_val;
+   short             *Block;
+   short             *Reference;
+   unsigned int       Index;
+   unsigned int       Count;
+   unsigned long long StartTime;
+   unsigned long long StartCycles;
+   Timing_t           BlockTiming;
+   Timing_t           ReferenceTiming;
+   AUDIODC_State_t    BlockState;
+   AUDIODC_State_t    ReferenceState;
+
+   ret_val   = 0;
+   Block     = malloc(Length * sizeof(short));
+   Reference = malloc(Length * sizeof(short));
+
+   if((Block) && (Reference))
+   {
+      /* Check the block version in place, with random block lengths.   */
+      memcpy(Block, Input, Length * sizeof(short));
+
+      AUDIODC_Initialize(&BlockState, MIC_ZERO_SAMPLE, MIC_GAIN_SHIFT, MIC_THRESHOLD);
+      AUDIODC_Initialize(&ReferenceState, MIC_ZERO_SAMPLE, MIC_GAIN_SHIFT, MIC_THRESHOLD);
+
+      for(Index = 0; Index < Length; Index += Count)
+      {
+         Count = 1 + (unsigned int)(Random() % MAXIMUM_BLOCK_LENGTH);
+         if(Count > (Length - Index))
+            Count = Length - Index;
+
+         AUDIODC_Process(&BlockState, Count, &Block[Index], &Block[Index]);
+      }
+
+      AUDIODC_ProcessReference(&ReferenceState, Length, Input, Reference);
+
+      for(Index = 0; Index < Length; Index++)
+      {
+         if(Block[Index] != Reference[Index])
+         {
+            if(!ret_val)
+               printf("   First difference at sample %u: %d, reference %d\n", Index, Block[Index], Reference[Index]);
+
+            ret_val++;
+         }
+      }
+
+      /* Time both versions in periods.                                 */
+      AUDIODC_Initialize(&BlockState, MIC_ZERO_SAMPLE, MIC_GAIN_SHIFT, MIC_THRESHOLD);
+
+      StartTime   = GetNanoseconds();
+      StartCycles = GetCycles();
+
+      for(Index = 0; Index < Length; Index += Count)
+      {
+         Count = ((Length - Index) < PERIOD_LENGTH) ? (Length - Index) : PERIOD_LENGTH;
+
+         AUDIODC_Process(&BlockState, Count, &Input[Index], &Block[Index]);
+      }
+
+      BlockTiming.Cycles      = GetCycles() - StartCycles;
+      BlockTiming.Nanoseconds = GetNanoseconds() - StartTime;
+
+      AUDIODC_Initialize(&ReferenceState, MIC_ZERO_SAMPLE, MIC_GAIN_SHIFT, MIC_THRESHOLD);
+
+      StartTime   = GetNanoseconds();
+      StartCycles = GetCycles();
+
+      for(Index = 0; Index < Length; Index += Count)
+      {
+         Count = ((Length - Index) < PERIOD_LENGTH) ? (Length - Index) : PERIOD_LENGTH;
+
+         AUDIODC_ProcessReference(&ReferenceState, Count, &Input[Index], &Reference[Index]);
+      }
+
+      ReferenceTiming.Cycles      = GetCycles() - StartCycles;
+      ReferenceTiming.Nanoseconds = GetNanoseconds() - StartTime;
+
+      printf("AUDIODC %s: %u samples, %d differences\n", Name, Length, ret_val);
+
+      DisplayTiming("block", Length, &BlockTiming);
+      DisplayTiming("reference", Length, &ReferenceTiming);
+   }
+   else
+   {
+      fprintf(stderr, "Out of memory\n");
+
+      ret_val = 1;
+   }
+
+   free(Block);
+   free(Reference);
+
+   return(ret_val);
+}
+
+   /* The following function checks and times the specified coefficient */
+   /* set on the specified signal.  This function returns the number of */
+   /* samples that differ.                                              */
+static int CheckFilter(char *Name, const AUDIOFLT_Coefficient_Set_t *Set, unsigned int Length, short *Input)
+{
+   int                     ret_val;
+   short                  *Block;
+   short                  *Reference;
+   unsigned int            Index;
+   unsigned int            Count;
+   unsigned long long      StartTime;
+   unsigned long long      StartCycles;
+   Timing_t                BlockTiming;
+   Timing_t                ReferenceTiming;
+   static AUDIOFLT_Bank_t  BlockBank;
+   static AUDIOFLT_Bank_t  ReferenceBank;
+
+   ret_val   = 0;
+   Block     = malloc(Length * sizeof(short));
+   Reference = malloc(Length * sizeof(short));
+
+   if((Block) && (Reference) && (!AUDIOFLT_Initialize(&BlockBank, Set)) && (!AUDIOFLT_Initialize(&ReferenceBank, Set)))
+   {
+      /* Check the block version in place, with random block lengths.   */
+      memcpy(Block, Input, Length * sizeof(short));
+
+      for(Index = 0; Index < Length; Index += Count)
+      {
+         Count = 1 + (unsigned int)(Random() % MAXIMUM_BLOCK_LENGTH);
+         if(Count > (Length - Index))
+            Count = Length - Index;
+
+         AUDIOFLT_Process(&BlockBank, Count, &Block[Index], &Block[Index]);
+      }
+
+      AUDIOFLT_ProcessReference(&ReferenceBank, Length, Input, Reference);
+
+      for(Index = 0; Index < Length; Index++)
+      {
+         if(Block[Index] != Reference[Index])
+         {
+            if(!ret_val)
+               printf("   First difference at sample %u: %d, reference %d\n", Index, Block[Index], Reference[Index]);
+
+            ret_val++;
+         }
+      }
+
+      /* Time both versions in periods.                                 */
+      AUDIOFLT_Reset(&BlockBank);
+
+      StartTime   = GetNanoseconds();
+      StartCycles = GetCycles();
+
+      for(Index = 0; Index < Length; Index += Count)
+      {
+         Count = ((Length - Index) < PERIOD_LENGTH) ? (Length - Index) : PERIOD_LENGTH;
+
+         AUDIOFLT_Process(&BlockBank, Count, &Input[Index], &Block[Index]);
+      }
+
+      BlockTiming.Cycles      = GetCycles() - StartCycles;
+      BlockTiming.Nanoseconds = GetNanoseconds() - StartTime;
+
+      AUDIOFLT_Reset(&ReferenceBank);
+
+      StartTime   = GetNanoseconds();
+      StartCycles = GetCycles();
+
+      for(Index = 0; Index < Length; Index += Count)
+      {
+         Count = ((Length - Index) < PERIOD_LENGTH) ? (Length - Index) : PERIOD_LENGTH;
+
+         AUDIOFLT_ProcessReference(&ReferenceBank, Count, &Input[Index], &Reference[Index]);
+      }
+
+      ReferenceTiming.Cycles      = GetCycles() - StartCycles;
+      ReferenceTiming.Nanoseconds = GetNanoseconds() - StartTime;
+
+      printf("AUDIOFLT %s %lu Hz (%u stages): %u samples, %d differences\n", Name, Set->SampleRate, Set->NumberStages, Length, ret_val);
+
+      DisplayTiming("block", Length, &BlockTiming);
+      DisplayTiming("reference", Length, &ReferenceTiming);
+   }
+   else
+   {
+      fprintf(stderr, "Unable to check the %s filter\n", Name);
+
+      ret_val = 1;
+   }
+
+   free(Block);
+   free(Reference);
+
+   return(ret_val);
+}
+
+   /* The following function checks the default coefficient sets and    */
+   /* the test filters on the specified signal.  This function returns  */
+   /* the number of samples that differ.                                */
+static int CheckFilters(char *Name, unsigned int Length, short *Input)
+{
+   int                         ret_val;
+   unsigned int                Index;
+   AUDIOFLT_Stage_Definition_t Stages[AUDIOFLT_MAXIMUM_STAGES];
+   AUDIOFLT_Coefficient_Set_t  Set;
+
+   ret_val = 0;
+
+   for(Index = 0; Index < AUDIOFLT_NumberDefaultSets; Index++)
+      ret_val += CheckFilter(Name, &AUDIOFLT_DefaultSets[Index], Length, Input);
+
+   /* The cascade takes the Q31 biquad of the last default set.         */
+   memcpy(Stages, TestStages, sizeof(Stages));
+
+   Stages[2].Q31 = AUDIOFLT_DefaultSets[AUDIOFLT_NumberDefaultSets - 1].Stages[0].Q31;
+
+   for(Index = 1; Index <= 2; Index++)
+   {
+      Set.SampleRate   = 16000;
+      Set.NumberStages = Index;
+      Set.Stages       = &Stages[Index - 1];
+
+      ret_val         += CheckFilter(Name, &Set, Length, Input);
+   }
+
+   Set.NumberStages = AUDIOFLT_MAXIMUM_STAGES;
+   Set.Stages       = Stages;
+
+   ret_val += CheckFilter(Name, &Set, Length, Input);
+
+   return(ret_val);
+}
+
+   /* The following function checks the sample rate converter on the    */
+   /* specified signal (taken as interleaved stereo), with blocks of    */
+   /* random lengths on both sides and a correction that changes with   */
+   /* every block.  This function returns the number of samples that    */
+   /* differ.                                                           */
+static int CheckConverter(unsigned long InputRate, unsigned long OutputRate, unsigned int Length, short *Input)
+{
+   int                      ret_val;
+   short                   *Block;
+   short                   *Reference;
+   long                     Correction;
+   unsigned int             Frames;
+   unsigned int             Read;
+   unsigned int             ReferenceRead;
+   unsigned int             InputIndex;
+   unsigned int             OutputIndex;
+   unsigned int             Count;
+   unsigned int             Produced;
+   unsigned int             Index;
+   static AUDIOSRC_State_t  BlockState;
+   static AUDIOSRC_State_t  ReferenceState;
+
+   ret_val   = 0;
+   Frames    = Length / AUDIOSRC_CHANNELS;
+   Block     = malloc(Frames * 3 * AUDIOSRC_CHANNELS * sizeof(short));
+   Reference = malloc(Frames * 3 * AUDIOSRC_CHANNELS * sizeof(short));
+
+   if((Block) && (Reference) && (!AUDIOSRC_Initialize(&BlockState, InputRate, OutputRate)) && (!AUDIOSRC_Initialize(&ReferenceState, InputRate, OutputRate)))
+   {
+      InputIndex  = 0;
+      OutputIndex = 0;
+
+      while(InputIndex < Frames)
+      {
+         Correction    = (long)(Random() % (2 * AUDIOSRC_MAXIMUM_CORRECTION + 1)) - AUDIOSRC_MAXIMUM_CORRECTION;
+         Count         = 1 + (unsigned int)(Random() % MAXIMUM_BLOCK_LENGTH);
+         Read          = 1 + (unsigned int)(Random() % MAXIMUM_BLOCK_LENGTH);
+         if(Read > (Frames - InputIndex))
+            Read = Frames - InputIndex;
+
+         ReferenceRead = Read;
+
+         AUDIOSRC_SetCorrection(&BlockState, Correction);
+         AUDIOSRC_SetCorrection(&ReferenceState, Correction);
+
+         Produced      = AUDIOSRC_Process(&BlockState, &Read, &Input[InputIndex * AUDIOSRC_CHANNELS], Count, &Block[OutputIndex * AUDIOSRC_CHANNELS]);
+
+         if((AUDIOSRC_ProcessReference(&ReferenceState, &ReferenceRead, &Input[InputIndex * AUDIOSRC_CHANNELS], Count, &Reference[OutputIndex * AUDIOSRC_CHANNELS]) != Produced) || (ReferenceRead != Read))
+         {
+            printf("   Block and reference read or produced different numbers of frames\n");
+
+            ret_val++;
+            break;
+         }
+
+         InputIndex  += Read;
+         OutputIndex += Produced;
+      }
+
+      for(Index = 0; Index < (OutputIndex * AUDIOSRC_CHANNELS); Index++)
+      {
+         if(Block[Index] != Reference[Index])
+         {
+            if(!ret_val)
+               printf("   First difference at sample %u: %d, reference %d\n", Index, Block[Index], Reference[Index]);
+
+            ret_val++;
+         }
+      }
+
+      printf("AUDIOSRC %lu -> %lu Hz: %u input frames, %u output frames, %d differences\n", InputRate, OutputRate, InputIndex, OutputIndex, ret_val);
+   }
+   else
+   {
+      fprintf(stderr, "Unable to check the sample rate converter\n");
+
+      ret_val = 1;
+   }
+
+   free(Block);
+   free(Reference);
+
+   return(ret_val);
+}
+
+   /* The following function converts a tone of the specified frequency */
+   /* (at -1 dBFS) with the specified correction and returns its THD+N  */
+   /* in dB: the power of what is left of the output once the tone (at  */
+   /* its converted frequency) and the DC have been fitted and removed, */
+   /* relative to the power of the tone.  The time of the conversion is */
+   /* returned in the final parameter.                                  */
+static double MeasureTone(unsigned long InputRate, unsigned long OutputRate, long Correction, double Frequency, Timing_t *Timing)
+{
+   double                   ret_val;
+   short                   *Input;
+   short                   *Output;
+   unsigned int             InputFrames;
+   unsigned int             OutputFrames;
+   unsigned int             Read;
+   unsigned int             Produced;
+   unsigned int             Index;
+   unsigned int             Channel;
+   unsigned long long       StartTime;
+   unsigned long long       StartCycles;
+   double                   Phase;
+   double                   Sums[3][4];
+   double                   Basis[3];
+   double                   Matrix[3][4];
+   double                   Factor;
+   double                   Residual;
+   double                   Sample;
+   int                      Row;
+   int                      Column;
+   int                      Pivot;
+   static AUDIOSRC_State_t  State;
+
+   ret_val      = 0;
+   InputFrames  = (unsigned int)(InputRate * TONE_LENGTH);
+
+   memset(Timing, 0, sizeof(Timing_t));
+
+   OutputFrames = (unsigned int)(OutputRate * TONE_LENGTH / 2);
+   Input        = malloc(InputFrames * AUDIOSRC_CHANNELS * sizeof(short));
+   Output       = malloc(OutputFrames * AUDIOSRC_CHANNELS * sizeof(short));
+
+   if((Input) && (Output) && (!AUDIOSRC_Initialize(&State, InputRate, OutputRate)))
+   {
+      for(Index = 0; Index < InputFrames; Index++)
+      {
+         for(Channel = 0; Channel < AUDIOSRC_CHANNELS; Channel++)
+            Input[(Index * AUDIOSRC_CHANNELS) + Channel] = (short)lrint(29204.0 * sin(2.0 * M_PI * Frequency * Index / InputRate));
+      }
+
+      AUDIOSRC_SetCorrection(&State, Correction);
+
+      StartTime   = GetNanoseconds();
+      StartCycles = GetCycles();
+
+      Read        = InputFrames;
+      Produced    = AUDIOSRC_Process(&State, &Read, Input, OutputFrames, Output);
+
+      Timing->Cycles      = GetCycles() - StartCycles;
+      Timing->Nanoseconds = GetNanoseconds() - StartTime;
+
+      /* The frequency of the tone in the output follows the step of    */
+      /* the converter exactly.                                         */
+      Frequency = (Frequency / InputRate) * ((double)State.Step / 4294967296.0);
+
+      /* Least squares fit of DC, cosine and sine on the left channel.  */
+      memset(Sums, 0, sizeof(Sums));
+
+      for(Index = TONE_SETTLE_FRAMES; Index < Produced; Index++)
+      {
+         Phase    = 2.0 * M_PI * Frequency * Index;
+         Basis[0] = 1.0;
+         Basis[1] = cos(Phase);
+         Basis[2] = sin(Phase);
+         Sample   = Output[Index * AUDIOSRC_CHANNELS];
+
+         for(Row = 0; Row < 3; Row++)
+         {
+            for(Column = 0; Column < 3; Column++)
+               Sums[Row][Column] += Basis[Row] * Basis[Column];
+
+            Sums[Row][3] += Basis[Row] * Sample;
+         }
+      }
+
+      memcpy(Matrix, Sums, sizeof(Matrix));
+
+      for(Pivot = 0; Pivot < 3; Pivot++)
+      {
+         for(Row = 0; Row < 3; Row++)
+         {
+            if(Row != Pivot)
+            {
+               Factor = Matrix[Row][Pivot] / Matrix[Pivot][Pivot];
+
+               for(Column = Pivot; Column < 4; Column++)
+                  Matrix[Row][Column] -= Factor * Matrix[Pivot][Column];
+            }
+         }
+      }
+
+      Residual = 0;
+
+      for(Index = TONE_SETTLE_FRAMES; Index < Produced; Index++)
+      {
+         Phase     = 2.0 * M_PI * Frequency * Index;
+         Sample    = Output[Index * AUDIOSRC_CHANNELS] - (Matrix[0][3] / Matrix[0][0]) - ((Matrix[1][3] / Matrix[1][1]) * cos(Phase)) - ((Matrix[2][3] / Matrix[2][2]) * sin(Phase));
+         Residual += Sample * Sample;
+      }
+
+      Factor  = ((Matrix[1][3] / Matrix[1][1]) * (Matrix[1][3] / Matrix[1][1])) + ((Matrix[2][3] / Matrix[2][2]) * (Matrix[2][3] / Matrix[2][2]));
+      ret_val = 10.0 * log10((Residual / (Produced - TONE_SETTLE_FRAMES)) / (Factor / 2.0));
+
+      /* The time is given for the output frames that were produced.    */
+      Timing->Nanoseconds = (Timing->Nanoseconds * OutputRate) / Produced;
+      Timing->Cycles      = (Timing->Cycles * OutputRate) / Produced;
+   }
+   else
+      fprintf(stderr, "Unable to measure the sample rate converter\n");
+
+   free(Input);
+   free(Output);
+
+   return(ret_val);
+}
+
+   /* The following function simulates a stream at the specified input  */
+   /* rate that is off by the specified drift (in ppb) and arrives in   */
+   /* bursts, converted in periods at the specified output rate with the*/
+   /* tracker setting the correction.  This function returns zero if    */
+   /* the average correction settled within DRIFT_TOLERANCE of the drift*/
+   /* without the buffer running empty.                                 */
+static int CheckDrift(unsigned long InputRate, unsigned long OutputRate, long Drift)
+{
+   int                      ret_val;
+   short                   *Input;
+   short                   *Output;
+   double                   Arrived;
+   double                   Average;
+   long long                Fill;
+   long long                MinimumFill;
+   long long                MaximumFill;
+   long                     Correction;
+   long                     MinimumCorrection;
+   long                     MaximumCorrection;
+   unsigned long            Period;
+   unsigned long            Periods;
+   unsigned long            Underruns;
+   unsigned int             Read;
+   static AUDIOSRC_State_t  State;
+   static AUDIOSRC_Tracker_t Tracker;
+
+   Input  = calloc(DRIFT_TARGET_FRAMES * 4 * AUDIOSRC_CHANNELS, sizeof(short));
+   Output = malloc(PERIOD_LENGTH * AUDIOSRC_CHANNELS * sizeof(short));
+
+   if((Input) && (Output) && (!AUDIOSRC_Initialize(&State, InputRate, OutputRate)))
+   {
+      AUDIOSRC_InitializeTracker(&Tracker, DRIFT_TARGET_FRAMES);
+
+      Periods           = (unsigned long)(((unsigned long long)OutputRate * DRIFT_LENGTH) / PERIOD_LENGTH);
+      Fill              = DRIFT_TARGET_FRAMES;
+      Arrived           = 0;
+      Underruns         = 0;
+      Correction        = 0;
+      MinimumFill       = Fill;
+      MaximumFill       = Fill;
+      Average           = 0;
+      MinimumCorrection = AUDIOSRC_MAXIMUM_CORRECTION;
+      MaximumCorrection = -AUDIOSRC_MAXIMUM_CORRECTION;
+
+      for(Period = 0; Period < Periods; Period++)
+      {
+         /* The stream arrives in whole bursts at its (drifted) rate.   */
+         Arrived += ((double)InputRate * (1.0 + (Drift / 1e9)) * PERIOD_LENGTH) / OutputRate;
+
+         while(Arrived >= DRIFT_BURST_FRAMES)
+         {
+            Fill    += DRIFT_BURST_FRAMES;
+            Arrived -= DRIFT_BURST_FRAMES;
+         }
+
+         Correction = AUDIOSRC_UpdateTracker(&Tracker, (unsigned int)Fill, PERIOD_LENGTH);
+
+         AUDIOSRC_SetCorrection(&State, Correction);
+
+         /* The content does not matter, only the frames that are read. */
+         Read = (unsigned int)((Fill < (DRIFT_TARGET_FRAMES * 4)) ? Fill : (DRIFT_TARGET_FRAMES * 4));
+
+         if(AUDIOSRC_Process(&State, &Read, Input, PERIOD_LENGTH, Output) != PERIOD_LENGTH)
+            Underruns++;
+
+         Fill -= Read;
+
+         if(Period >= (Periods - (unsigned long)(((unsigned long long)OutputRate * DRIFT_MEASURE_LENGTH) / PERIOD_LENGTH)))
+         {
+            MinimumFill       = (Fill < MinimumFill) ? Fill : MinimumFill;
+            MaximumFill       = (Fill > MaximumFill) ? Fill : MaximumFill;
+            MinimumCorrection = (Correction < MinimumCorrection) ? Correction : MinimumCorrection;
+            MaximumCorrection = (Correction > MaximumCorrection) ? Correction : MaximumCorrection;
+            Average          += Correction;
+         }
+      }
+
+      Average /= (double)(((unsigned long long)OutputRate * DRIFT_MEASURE_LENGTH) / PERIOD_LENGTH);
+
+      ret_val  = ((Underruns) || (fabs(Average - Drift) > DRIFT_TOLERANCE)) ? 1 : 0;
+
+      printf("AUDIOSRC %lu -> %lu Hz, drift %+.1f ppm: correction %+.1f ppm (%+.1f to %+.1f), fill %lld to %lld frames (target %u), %lu underruns%s\n", InputRate, OutputRate, Drift / 1000.0, Average / 1000.0, MinimumCorrection / 1000.0, MaximumCorrection / 1000.0, MinimumFill, MaximumFill, DRIFT_TARGET_FRAMES, Underruns, (ret_val) ? " FAILED" : "");
+   }
+   else
+   {
+      fprintf(stderr, "Unable to simulate the drift\n");
+
+      ret_val = 1;
+   }
+
+   free(Input);
+   free(Output);
+
+   return(ret_val);
+}
+
+   /* The following function simulates the stream of the specified      */
+   /* scenario at 44.1 kHz through the jitter buffer and the converter  */
+   /* (as the audio task plays it at 48 kHz, see AUDIO.c) and checks    */
+   /* the number of underruns.  The first hiccup is longer than the     */
+   /* smallest latency, the jitter buffer must adapt so that the later  */
+   /* ones do not run it out.  This function returns zero if the        */
+   /* scenario passed.                                                  */
+static int CheckJitterBuffer(const Scenario_t *Scenario)
+{
+   int                         ret_val;
+   short                      *Buffer;
+   short                      *Packet;
+   short                       Output[PERIOD_LENGTH * AUDIOJB_CHANNELS];
+   const short                *Samples;
+   unsigned long long          Now;
+   unsigned long long          Arrival;
+   unsigned long long          LastArrival;
+   unsigned long long          Hiccup;
+   unsigned long               Packets;
+   unsigned long               Period;
+   unsigned long               MaximumDepth;
+   unsigned int                Depth;
+   unsigned int                Span;
+   unsigned int                Read;
+   unsigned int                Produced;
+   static AUDIOJB_Buffer_t     JitterBuffer;
+   static AUDIOSRC_State_t     State;
+   static AUDIOSRC_Tracker_t   Tracker;
+   AUDIOJB_Statistics_t        Statistics;
+
+   Buffer = calloc(JITTER_BUFFER_FRAMES * AUDIOJB_CHANNELS, sizeof(short));
+   Packet = calloc(JITTER_PACKET_FRAMES * AUDIOJB_CHANNELS, sizeof(short));
+
+   if((Buffer) && (Packet) && (!AUDIOJB_Initialize(&JitterBuffer, Buffer, JITTER_BUFFER_FRAMES, 44100, JITTER_LATENCY)) && (!AUDIOSRC_Initialize(&State, 44100, 48000)))
+   {
+      AUDIOSRC_InitializeTracker(&Tracker, JitterBuffer.TargetFrames);
+
+      Packets      = 0;
+      LastArrival  = 0;
+      MaximumDepth = 0;
+
+      for(Period = 0; Period < ((48000UL * JITTER_LENGTH) / PERIOD_LENGTH); Period++)
+      {
+         Now = ((unsigned long long)Period * PERIOD_LENGTH * 1000000ULL) / 48000;
+
+         /* Every packet that has arrived by now is written, in order.  */
+         while(1)
+         {
+            Arrival = (((unsigned long long)Packets * JITTER_PACKET_FRAMES * 1000000ULL) / 44100) + (Random() % JITTER_DELAY);
+
+            if(Scenario->HiccupInterval)
+            {
+               Hiccup = (Arrival / (Scenario->HiccupInterval * 1000ULL)) * (Scenario->HiccupInterval * 1000ULL);
+
+               if((Hiccup) && (Arrival < (Hiccup + (Scenario->HiccupLength * 1000ULL))))
+                  Arrival = Hiccup + (Scenario->HiccupLength * 1000ULL);
+            }
+
+            if(Arrival < LastArrival)
+               Arrival = LastArrival;
+
+            if(Arrival > Now)
+               break;
+
+            AUDIOJB_Write(&JitterBuffer, (unsigned long)(Arrival / 1000), JITTER_PACKET_FRAMES, Packet);
+
+            LastArrival = Arrival;
+            Packets++;
+         }
+
+         /* The period is played as ProcessStream() does.               */
+         Depth    = AUDIOJB_Depth(&JitterBuffer);
+         Span     = AUDIOJB_Peek(&JitterBuffer, &Samples);
+         Produced = 0;
+
+         if(Span)
+         {
+            Tracker.TargetFrames = JitterBuffer.TargetFrames;
+
+            AUDIOSRC_SetCorrection(&State, AUDIOSRC_UpdateTracker(&Tracker, Depth, PERIOD_LENGTH));
+
+            while((Produced < PERIOD_LENGTH) && (Span))
+            {
+               Read      = Span;
+               Produced += AUDIOSRC_Process(&State, &Read, Samples, (PERIOD_LENGTH - Produced), &Output[Produced * AUDIOJB_CHANNELS]);
+
+               AUDIOJB_Consume(&JitterBuffer, Read);
+
+               Span      = AUDIOJB_Peek(&JitterBuffer, &Samples);
+            }
+         }
+
+         AUDIOJB_Conceal(&JitterBuffer, Produced, PERIOD_LENGTH, Output);
+
+         if(Depth > MaximumDepth)
+            MaximumDepth = Depth;
+      }
+
+      AUDIOJB_Query_Statistics(&JitterBuffer, &Statistics);
+
+      ret_val = (Statistics.Underruns > Scenario->MaximumUnderruns) ? 1 : 0;
+
+      printf("AUDIOJB %-15s: %lu packets, %lu underruns, %lu late, %lu overruns, %lu concealed frames, jitter %.1f ms, depth %.1f ms (target %.1f ms, largest %.1f ms)%s\n", Scenario->Name, Statistics.Writes, Statistics.Underruns, Statistics.Late, Statistics.Overruns, Statistics.ConcealedFrames, Statistics.Jitter / 44.1, Statistics.Depth / 44.1, Statistics.TargetDepth / 44.1, MaximumDepth / 44.1, (ret_val) ? " FAILED" : "");
+   }
+   else
+   {
+      fprintf(stderr, "Unable to simulate the jitter buffer\n");
+
+      ret_val = 1;
+   }
+
+   free(Buffer);
+   free(Packet);
+
+   return(ret_val);
+}
+
+   /* The following function returns the scale factor of the specified  */
+   /* largest magnitude of a subband: the smallest factor for which the */
+   /* magnitude is below 2^(factor + 1) (at most 15).                   */
+static unsigned int ComputeScaleFactor(double Maximum)
+{
+   unsigned int ret_val;
+
+   ret_val = 0;
+
+   while((ret_val < 15) && (Maximum >= (double)(2UL << ret_val)))
+      ret_val++;
+
+   return(ret_val);
+}
+
+   /* The following function allocates the bits of the specified frame  */
+   /* as the bit allocation of the A2DP specification describes it,     */
+   /* independently of the decoder.  Stereo frames share the bit pool   */
+   /* between the channels, the other frames allocate it to each.       */
+static void AllocateSBCBits(const SBC_Configuration_t *Configuration, unsigned char ScaleFactors[][AUDIOSBC_MAXIMUM_SUBBANDS], unsigned char Bits[][AUDIOSBC_MAXIMUM_SUBBANDS])
+{
+   static const int Offset4[4][4] = { { -1, 0, 0, 0 }, { -2, 0, 0, 1 }, { -2, 0, 0, 1 }, { -2, 0, 0, 1 } };
+   static const int Offset8[4][8] = { { -2, 0, 0, 0, 0, 0, 0, 1 }, { -3, 0, 0, 0, 0, 0, 1, 2 }, { -4, 0, 0, 0, 0, 0, 1, 2 }, { -4, 0, 0, 0, 0, 0, 1, 2 } };
+   int          BitNeed[AUDIOSBC_CHANNELS][AUDIOSBC_MAXIMUM_SUBBANDS];
+   int          MaximumBitNeed;
+   int          Loudness;
+   int          BitSlice;
+   int          BitCount;
+   int          SliceCount;
+   int          Bitpool;
+   int          Channel;
+   int          Subband;
+   int          First;
+   int          Last;
+   int          Pass;
+   int          Subbands;
+
+   Subbands = (int)Configuration->Subbands;
+   Bitpool  = (int)Configuration->Bitpool;
+
+   for(Channel = 0; Channel < AUDIOSBC_CHANNELS; Channel++)
+   {
+      for(Subband = 0; Subband < Subbands; Subband++)
+      {
+         if(Configuration->AllocationMethod == AUDIOSBC_ALLOCATION_SNR)
+            BitNeed[Channel][Subband] = ScaleFactors[Channel][Subband];
+         else
+         {
+            if(ScaleFactors[Channel][Subband] == 0)
+               BitNeed[Channel][Subband] = -5;
+            else
+            {
+               Loudness                  = ScaleFactors[Channel][Subband] - ((Subbands == 4) ? Offset4[Configuration->Frequency][Subband] : Offset8[Configuration->Frequency][Subband]);
+               BitNeed[Channel][Subband] = (Loudness > 0) ? (Loudness / 2) : Loudness;
+            }
+         }
+      }
+   }
+
+   /* Each pass allocates one channel, or both for a stereo frame.      */
+   for(Pass = 0; Pass < (int)((Configuration->ChannelMode == AUDIOSBC_CHANNEL_MODE_DUAL_CHANNEL) ? 2 : 1); Pass++)
+   {
+      First = Pass;
+      Last  = (Configuration->ChannelMode >= AUDIOSBC_CHANNEL_MODE_STEREO) ? 1 : Pass;
+
+      MaximumBitNeed = 0;
+
+      for(Channel = First; Channel <= Last; Channel++)
+      {
+         for(Subband = 0; Subband < Subbands; Subband++)
+         {
+            if(BitNeed[Channel][Subband] > MaximumBitNeed)
+               MaximumBitNeed = BitNeed[Channel][Subband];
+         }
+      }
+
+      BitCount   = 0;
+      SliceCount = 0;
+      BitSlice   = MaximumBitNeed + 1;
+
+      do
+      {
+         BitSlice--;
+         BitCount   += SliceCount;
+         SliceCount  = 0;
+
+         for(Channel = First; Channel <= Last; Channel++)
+         {
+            for(Subband = 0; Subband < Subbands; Subband++)
+            {
+               if((BitNeed[Channel][Subband] > BitSlice + 1) && (BitNeed[Channel][Subband] < BitSlice + 16))
+                  SliceCount++;
+               else if(BitNeed[Channel][Subband] == BitSlice + 1)
+                  SliceCount += 2;
+            }
+         }
+      } while(BitCount + SliceCount < Bitpool);
+
+      if(BitCount + SliceCount == Bitpool)
+      {
+         BitCount += SliceCount;
+         BitSlice--;
+      }
+
+      for(Channel = First; Channel <= Last; Channel++)
+      {
+         for(Subband = 0; Subband < Subbands; Subband++)
+         {
+            if(BitNeed[Channel][Subband] < BitSlice + 2)
+               Bits[Channel][Subband] = 0;
+            else
+               Bits[Channel][Subband] = (unsigned char)(((BitNeed[Channel][Subband] - BitSlice) < 16) ? (BitNeed[Channel][Subband] - BitSlice) : 16);
+         }
+      }
+
+      Channel = First;
+      Subband = 0;
+
+      while((BitCount < Bitpool) && (Subband < Subbands))
+      {
+         if((Bits[Channel][Subband] >= 2) && (Bits[Channel][Subband] < 16))
+         {
+            Bits[Channel][Subband]++;
+            BitCount++;
+         }
+         else if((BitNeed[Channel][Subband] == BitSlice + 1) && (Bitpool > BitCount + 1))
+         {
+            Bits[Channel][Subband]  = 2;
+            BitCount               += 2;
+         }
+
+         if(Channel == Last)
+         {
+            Channel = First;
+            Subband++;
+         }
+         else
+            Channel++;
+      }
+
+      Channel = First;
+      Subband = 0;
+
+      while((BitCount < Bitpool) && (Subband < Subbands))
+      {
+         if(Bits[Channel][Subband] < 16)
+         {
+            Bits[Channel][Subband]++;
+            BitCount++;
+         }
+
+         if(Channel == Last)
+         {
+            Channel = First;
+            Subband++;
+         }
+         else
+            Channel++;
+      }
+   }
+}
+
+   /* The following function writes the specified number of bits of the */
+   /* specified value to the specified frame at the specified position  */
+   /* (in bits), most significant bit first.                            */
+static void WriteSBCBits(unsigned char *Frame, unsigned int *Position, unsigned int Bits, unsigned int Value)
+{
+   while(Bits--)
+   {
+      if((Value >> Bits) & 1)
+         Frame[*Position >> 3] |= (unsigned char)(0x80 >> (*Position & 7));
+
+      (*Position)++;
+   }
+}
+
+   /* The following function writes the CRC of the specified frame, of  */
+   /* which the header and the scale factors end at the specified       */
+   /* position (in bits).                                               */
+static void WriteSBCCRC(unsigned char *Frame, unsigned int Position)
+{
+   unsigned int CRC;
+   unsigned int Bit;
+   unsigned int Index;
+
+   CRC = 0x0F;
+
+   for(Index = 8; Index < Position; Index++)
+   {
+      if(Index == 24)
+         Index = 32;
+
+      Bit = ((Frame[Index / 8] >> (7 - (Index % 8))) & 1) ^ ((CRC >> 7) & 1);
+      CRC = ((CRC << 1) & 0xFF) ^ (Bit ? 0x1D : 0);
+   }
+
+   Frame[3] = (unsigned char)CRC;
+}
+
+   /* The following function encodes the specified stereo frames (of    */
+   /* which a mono frame takes the left channel) into an SBC frame with */
+   /* a floating point analysis filter bank, as the A2DP specification  */
+   /* describes it.  The subbands that the frame decodes to are kept in */
+   /* the encoder for DecodeSBC().  This function returns the length of */
+   /* the frame.                                                        */
+static unsigned int EncodeSBC(SBC_Encoder_t *Encoder, const short *Input, unsigned char *Frame)
+{
+   const SBC_Configuration_t *Configuration;
+   const double              *Prototype;
+   unsigned int               Subbands;
+   unsigned int               Channels;
+   unsigned int               Channel;
+   unsigned int               Subband;
+   unsigned int               Block;
+   unsigned int               Index;
+   unsigned int               Position;
+   unsigned int               Join;
+   unsigned int               Length;
+   unsigned long              Levels;
+   unsigned long              Sample;
+   double                     Y[16];
+   double                     Value;
+   double                     Maximum[4];
+   double                     Scale;
+   double                     Values[AUDIOSBC_MAXIMUM_BLOCKS][AUDIOSBC_CHANNELS][AUDIOSBC_MAXIMUM_SUBBANDS];
+   unsigned char              ScaleFactors[AUDIOSBC_CHANNELS][AUDIOSBC_MAXIMUM_SUBBANDS];
+   unsigned char              Bits[AUDIOSBC_CHANNELS][AUDIOSBC_MAXIMUM_SUBBANDS];
+   AUDIOSBC_Format_t          Format;
+
+   Configuration = &(Encoder->Configuration);
+   Subbands      = Configuration->Subbands;
+   Channels      = (Configuration->ChannelMode == AUDIOSBC_CHANNEL_MODE_MONO) ? 1 : 2;
+   Prototype     = (Subbands == 4) ? SBCPrototype4 : SBCPrototype8;
+
+   /* Analysis: the history X holds the input newest first.             */
+   for(Block = 0; Block < Configuration->Blocks; Block++)
+   {
+      for(Channel = 0; Channel < Channels; Channel++)
+      {
+         memmove(&(Encoder->Analysis[Channel][Subbands]), Encoder->Analysis[Channel], (Subbands * 9 * sizeof(double)));
+
+         for(Index = 0; Index < Subbands; Index++)
+            Encoder->Analysis[Channel][Subbands - 1 - Index] = Input[(((Block * Subbands) + Index) * AUDIOSBC_CHANNELS) + Channel];
+
+         for(Index = 0; Index < (Subbands * 2); Index++)
+         {
+            Y[Index] = 0;
+
+            for(Position = 0; Position < 5; Position++)
+               Y[Index] += Prototype[Index + (Subbands * 2 * Position)] * Encoder->Analysis[Channel][Index + (Subbands * 2 * Position)];
+         }
+
+         for(Subband = 0; Subband < Subbands; Subband++)
+         {
+            Values[Block][Channel][Subband] = 0;
+
+            for(Index = 0; Index < (Subbands * 2); Index++)
+               Values[Block][Channel][Subband] += cos((Subband + 0.5) * ((double)Index - (Subbands / 2.0)) * M_PI / Subbands) * Y[Index];
+         }
+      }
+   }
+
+   /* Joint stereo codes a subband (but the last) as sum and difference */
+   /* when their scale factors are smaller.                             */
+   Join = 0;
+
+   for(Subband = 0; Subband < Subbands; Subband++)
+   {
+      memset(Maximum, 0, sizeof(Maximum));
+
+      for(Block = 0; Block < Configuration->Blocks; Block++)
+      {
+         for(Channel = 0; Channel < Channels; Channel++)
+         {
+            if(fabs(Values[Block][Channel][Subband]) > Maximum[Channel])
+               Maximum[Channel] = fabs(Values[Block][Channel][Subband]);
+         }
+
+         if(Channels == 2)
+         {
+            Value = fabs((Values[Block][0][Subband] + Values[Block][1][Subband]) / 2.0);
+            if(Value > Maximum[2])
+               Maximum[2] = Value;
+
+            Value = fabs((Values[Block][0][Subband] - Values[Block][1][Subband]) / 2.0);
+            if(Value > Maximum[3])
+               Maximum[3] = Value;
+         }
+      }
+
+      if((Configuration->ChannelMode == AUDIOSBC_CHANNEL_MODE_JOINT_STEREO) && (Subband < (Subbands - 1)) && ((ComputeScaleFactor(Maximum[2]) + ComputeScaleFactor(Maximum[3])) < (ComputeScaleFactor(Maximum[0]) + ComputeScaleFactor(Maximum[1]))))
+      {
+         Join |= 1U << (Subbands - 1 - Subband);
+
+         for(Block = 0; Block < Configuration->Blocks; Block++)
+         {
+            Value                     = Values[Block][0][Subband];
+            Values[Block][0][Subband] = (Value + Values[Block][1][Subband]) / 2.0;
+            Values[Block][1][Subband] = (Value - Values[Block][1][Subband]) / 2.0;
+         }
+
+         Maximum[0] = Maximum[2];
+         Maximum[1] = Maximum[3];
+      }
+
+      for(Channel = 0; Channel < Channels; Channel++)
+         ScaleFactors[Channel][Subband] = (unsigned char)ComputeScaleFactor(Maximum[Channel]);
+   }
+
+   AllocateSBCBits(Configuration, ScaleFactors, Bits);
+
+   /* The header, with the CRC filled in last.                          */
+   memset(Frame, 0, SBC_MAXIMUM_FRAME_LENGTH);
+
+   Frame[0] = AUDIOSBC_SYNCWORD;
+   Frame[1] = (unsigned char)((Configuration->Frequency << 6) | (((Configuration->Blocks / 4) - 1) << 4) | (Configuration->ChannelMode << 2) | (Configuration->AllocationMethod << 1) | ((Subbands == 8) ? 1 : 0));
+   Frame[2] = (unsigned char)Configuration->Bitpool;
+   Position = 32;
+
+   if(Configuration->ChannelMode == AUDIOSBC_CHANNEL_MODE_JOINT_STEREO)
+      WriteSBCBits(Frame, &Position, Subbands, Join);
+
+   for(Channel = 0; Channel < Channels; Channel++)
+   {
+      for(Subband = 0; Subband < Subbands; Subband++)
+         WriteSBCBits(Frame, &Position, 4, ScaleFactors[Channel][Subband]);
+   }
+
+   WriteSBCCRC(Frame, Position);
+
+   /* Quantize the samples, keeping what they decode to.                */
+   for(Block = 0; Block < Configuration->Blocks; Block++)
+   {
+      for(Channel = 0; Channel < Channels; Channel++)
+      {
+         for(Subband = 0; Subband < Subbands; Subband++)
+         {
+            Encoder->Subband[Block][Channel][Subband] = 0;
+
+            if(Bits[Channel][Subband])
+            {
+               Levels = (1UL << Bits[Channel][Subband]) - 1;
+               Scale  = (double)(2UL << ScaleFactors[Channel][Subband]);
+               Value  = floor(((Values[Block][Channel][Subband] / Scale) + 1.0) * Levels / 2.0);
+               Sample = (unsigned long)((Value < 0) ? 0 : ((Value > (Levels - 1)) ? (Levels - 1) : Value));
+
+               WriteSBCBits(Frame, &Position, Bits[Channel][Subband], (unsigned int)Sample);
+
+               Encoder->Subband[Block][Channel][Subband] = Scale * ((((2.0 * Sample) + 1.0) / Levels) - 1.0);
+            }
+         }
+      }
+
+      for(Subband = 0; Subband < Subbands; Subband++)
+      {
+         if(Join & (1U << (Subbands - 1 - Subband)))
+         {
+            Value                                     = Encoder->Subband[Block][0][Subband];
+            Encoder->Subband[Block][0][Subband]       = Value + Encoder->Subband[Block][1][Subband];
+            Encoder->Subband[Block][1][Subband]       = Value - Encoder->Subband[Block][1][Subband];
+         }
+      }
+   }
+
+   Length = (Position + 7) / 8;
+
+   if(AUDIOSBC_ParseHeader(Frame, SBC_MAXIMUM_FRAME_LENGTH, &Format) != (int)Length)
+      fprintf(stderr, "Frame length %u differs from the header (%u)\n", Length, Format.FrameLength);
+
+   return(Length);
+}
+
+   /* The following function decodes the subbands of the last frame that*/
+   /* the specified encoder encoded with a floating point synthesis     */
+   /* filter bank, as the A2DP specification describes it, into the     */
+   /* specified stereo frames (a mono frame is copied to both channels).*/
+static void DecodeSBC(SBC_Encoder_t *Encoder, double *Output)
+{
+   const SBC_Configuration_t *Configuration;
+   const double              *Prototype;
+   double                    *V;
+   unsigned int               Subbands;
+   unsigned int               Channels;
+   unsigned int               Channel;
+   unsigned int               Block;
+   unsigned int               Index;
+   unsigned int               Row;
+   unsigned int               Tap;
+   double                     Sum;
+
+   Configuration = &(Encoder->Configuration);
+   Subbands      = Configuration->Subbands;
+   Channels      = (Configuration->ChannelMode == AUDIOSBC_CHANNEL_MODE_MONO) ? 1 : 2;
+   Prototype     = (Subbands == 4) ? SBCPrototype4 : SBCPrototype8;
+
+   for(Block = 0; Block < Configuration->Blocks; Block++)
+   {
+      for(Channel = 0; Channel < Channels; Channel++)
+      {
+         V = Encoder->Synthesis[Channel];
+
+         memmove(&V[Subbands * 2], V, (Subbands * 18 * sizeof(double)));
+
+         for(Row = 0; Row < (Subbands * 2); Row++)
+         {
+            V[Row] = 0;
+
+            for(Index = 0; Index < Subbands; Index++)
+               V[Row] += cos((Index + 0.5) * (Row + (Subbands / 2.0)) * M_PI / Subbands) * Encoder->Subband[Block][Channel][Index];
+         }
+
+         for(Row = 0; Row < Subbands; Row++)
+         {
+            Sum = 0;
+
+            for(Tap = 0; Tap < AUDIOSBC_TAPS; Tap++)
+               Sum += V[Row + (Subbands * 2 * Tap) + ((Tap & 1) ? Subbands : 0)] * Prototype[Row + (Subbands * Tap)] * -(double)Subbands;
+
+            Output[(((Block * Subbands) + Row) * AUDIOSBC_CHANNELS) + Channel] = Sum;
+
+            if(Channels == 1)
+               Output[(((Block * Subbands) + Row) * AUDIOSBC_CHANNELS) + 1] = Sum;
+         }
+      }
+   }
+}
+
+   /* The following function encodes a test signal (two tones and noise */
+   /* on each channel, rising to full scale over the last quarter) with */
+   /* the specified configuration and decodes it with the block and the */
+   /* reference version of the decoder, which must agree bit for bit,   */
+   /* and with the floating point decoder, from which no sample may     */
+   /* differ by more than SBC_TOLERANCE.  The signal to noise ratio is  */
+   /* also given against the input (delayed by the filter banks).  If   */
+   /* the final parameter is set both versions are timed.  This function*/
+   /* returns the number of samples that differ (or 1 if the decoder    */
+   /* failed).                                                          */
+static int CheckSBC(const SBC_Configuration_t *Configuration, int Timed)
+{
+   int                   ret_val;
+   short                *Input;
+   short                *Block;
+   short                *Reference;
+   double               *Float;
+   unsigned char        *Stream;
+   unsigned int         *Lengths;
+   unsigned int          FrameFrames;
+   unsigned int          Frames;
+   unsigned int          Count;
+   unsigned int          Index;
+   unsigned int          Frame;
+   unsigned int          Offset;
+   unsigned int          Delay;
+   unsigned int          Decoded;
+   unsigned int          Produced;
+   unsigned long         SampleRate;
+   unsigned long long    StartTime;
+   unsigned long long    StartCycles;
+   long                  Difference;
+   long                  MaximumDifference;
+   double                Level;
+   double                Value;
+   double                Signal;
+   double                Noise;
+   double                InputNoise;
+   Timing_t              BlockTiming;
+   Timing_t              ReferenceTiming;
+   AUDIOSBC_Statistics_t Statistics;
+   static SBC_Encoder_t      Encoder;
+   static AUDIOSBC_Decoder_t BlockDecoder;
+   static AUDIOSBC_Decoder_t ReferenceDecoder;
+
+   ret_val     = 0;
+   SampleRate  = SBCSampleRates[Configuration->Frequency];
+   FrameFrames = Configuration->Blocks * Configuration->Subbands;
+   Count       = (unsigned int)((SampleRate * SBC_LENGTH) / FrameFrames);
+   Frames      = Count * FrameFrames;
+
+   Input     = malloc(Frames * AUDIOSBC_CHANNELS * sizeof(short));
+   Block     = malloc(Frames * AUDIOSBC_CHANNELS * sizeof(short));
+   Reference = malloc(Frames * AUDIOSBC_CHANNELS * sizeof(short));
+   Float     = malloc(Frames * AUDIOSBC_CHANNELS * sizeof(double));
+   Stream    = malloc(Count * SBC_MAXIMUM_FRAME_LENGTH);
+   Lengths   = malloc(Count * sizeof(unsigned int));
+
+   memset(&Encoder, 0, sizeof(Encoder));
+
+   Encoder.Configuration = *Configuration;
+
+   if((Input) && (Block) && (Reference) && (Float) && (Stream) && (Lengths) && (!AUDIOSBC_Initialize(&BlockDecoder)) && (!AUDIOSBC_Initialize(&ReferenceDecoder)))
+   {
+      for(Index = 0; Index < Frames; Index++)
+      {
+         Level = (Index < ((Frames * 3) / 4)) ? 1.0 : (1.0 + (3.0 * (Index - ((Frames * 3) / 4))) / (Frames / 4));
+         Value = Level * ((7000.0 * sin(2.0 * M_PI * 441.0 * Index / SampleRate)) + (4000.0 * sin(2.0 * M_PI * 3150.0 * Index / SampleRate)) + (double)((long)(Random() % 2001) - 1000));
+         Input[Index * AUDIOSBC_CHANNELS] = (short)((Value > 32767.0) ? 32767 : ((Value < -32768.0) ? -32768 : lrint(Value)));
+
+         Value = Level * ((6000.0 * sin((2.0 * M_PI * 441.0 * Index / SampleRate) + 0.5)) + (4000.0 * sin(2.0 * M_PI * 5013.0 * Index / SampleRate)) + (double)((long)(Random() % 2001) - 1000));
+         Input[(Index * AUDIOSBC_CHANNELS) + 1] = (short)((Value > 32767.0) ? 32767 : ((Value < -32768.0) ? -32768 : lrint(Value)));
+      }
+
+      /* The stream and the floating point output.                      */
+      for(Frame = 0, Offset = 0; Frame < Count; Frame++)
+      {
+         Lengths[Frame]  = EncodeSBC(&Encoder, &Input[Frame * FrameFrames * AUDIOSBC_CHANNELS], &Stream[Offset]);
+         Offset         += Lengths[Frame];
+
+         DecodeSBC(&Encoder, &Float[Frame * FrameFrames * AUDIOSBC_CHANNELS]);
+      }
+
+      StartTime   = GetNanoseconds();
+      StartCycles = GetCycles();
+
+      for(Frame = 0, Offset = 0, Decoded = 0; Frame < Count; Frame++)
+      {
+         if(AUDIOSBC_Decode(&BlockDecoder, &Stream[Offset], Lengths[Frame], &Produced, &Block[Decoded * AUDIOSBC_CHANNELS]) == (int)Lengths[Frame])
+            Decoded += Produced;
+
+         Offset += Lengths[Frame];
+      }
+
+      BlockTiming.Cycles      = GetCycles() - StartCycles;
+      BlockTiming.Nanoseconds = GetNanoseconds() - StartTime;
+
+      StartTime   = GetNanoseconds();
+      StartCycles = GetCycles();
+
+      for(Frame = 0, Offset = 0, Index = 0; Frame < Count; Frame++)
+      {
+         AUDIOSBC_DecodeReference(&ReferenceDecoder, &Stream[Offset], Lengths[Frame], &Produced, &Reference[Index * AUDIOSBC_CHANNELS]);
+
+         Index  += Produced;
+         Offset += Lengths[Frame];
+      }
+
+      ReferenceTiming.Cycles      = GetCycles() - StartCycles;
+      ReferenceTiming.Nanoseconds = GetNanoseconds() - StartTime;
+
+      AUDIOSBC_Query_Statistics(&BlockDecoder, &Statistics);
+
+      if((Decoded == Frames) && (Index == Frames) && (Statistics.Frames == Count) && (!Statistics.CRCErrors) && (!Statistics.InvalidFrames))
+      {
+         MaximumDifference = 0;
+         Signal            = 0;
+         Noise             = 0;
+         InputNoise        = 0;
+         Delay             = (Configuration->Subbands * 9) + 1;
+
+         for(Index = 0; Index < (Frames * AUDIOSBC_CHANNELS); Index++)
+         {
+            if(Block[Index] != Reference[Index])
+               ret_val++;
+
+            Value       = (Float[Index] > 32767.0) ? 32767.0 : ((Float[Index] < -32768.0) ? -32768.0 : Float[Index]);
+            Difference  = labs(Block[Index] - lrint(Value));
+
+            if(Difference > MaximumDifference)
+               MaximumDifference = Difference;
+
+            Signal     += Value * Value;
+            Noise      += (Block[Index] - Value) * (Block[Index] - Value);
+
+            /* A mono stream is the left channel of the input.          */
+            if(Index >= (Delay * AUDIOSBC_CHANNELS))
+            {
+               Value       = Input[(Index - (Delay * AUDIOSBC_CHANNELS)) & ((Configuration->ChannelMode == AUDIOSBC_CHANNEL_MODE_MONO) ? ~1U : ~0U)];
+               InputNoise += (Block[Index] - Value) * (Block[Index] - Value);
+            }
+         }
+
+         Value = 10.0 * log10(Signal / ((Noise) ? Noise : 1.0));
+
+         if((MaximumDifference > SBC_TOLERANCE) || (Value < SBC_MINIMUM_SNR))
+            ret_val++;
+
+         printf("AUDIOSBC %5lu Hz %u/%2u %-12s %-8s bitpool %3u: %4u frames, SNR %5.1f dB (largest difference %ld) against floating point, %5.1f dB against the input%s\n", SampleRate, Configuration->Subbands, Configuration->Blocks, SBCChannelModes[Configuration->ChannelMode], (Configuration->AllocationMethod == AUDIOSBC_ALLOCATION_SNR) ? "SNR" : "loudness", Configuration->Bitpool, Count, Value, MaximumDifference, 10.0 * log10(Signal / ((InputNoise) ? InputNoise : 1.0)), (ret_val) ? " FAILED" : "");
+
+         if(Timed)
+         {
+            DisplayTiming("block", Frames, &BlockTiming);
+            DisplayTiming("reference", Frames, &ReferenceTiming);
+         }
+      }
+      else
+      {
+         printf("AUDIOSBC %5lu Hz %u/%2u %-12s: decoded %u of %u frames FAILED\n", SampleRate, Configuration->Subbands, Configuration->Blocks, SBCChannelModes[Configuration->ChannelMode], Decoded, Frames);
+
+         ret_val = 1;
+      }
+   }
+   else
+   {
+      fprintf(stderr, "Unable to check the SBC decoder\n");
+
+      ret_val = 1;
+   }
+
+   free(Input);
+   free(Block);
+   free(Reference);
+   free(Float);
+   free(Stream);
+   free(Lengths);
+
+   return(ret_val);
+}
+
+   /* The following function checks that a frame whose CRC does not     */
+   /* match is dropped (but skipped) and that a frame that is cut short */
+   /* or does not start with the sync word is refused.  This function   */
+   /* returns zero if the checks passed.                                */
+static int CheckSBCErrors(void)
+{
+   int                       ret_val;
+   short                     Input[AUDIOSBC_MAXIMUM_FRAMES * AUDIOSBC_CHANNELS];
+   short                     Output[AUDIOSBC_MAXIMUM_FRAMES * AUDIOSBC_CHANNELS];
+   unsigned char             Frame[SBC_MAXIMUM_FRAME_LENGTH];
+   unsigned int              Length;
+   unsigned int              Frames;
+   unsigned int              Index;
+   AUDIOSBC_Statistics_t     Statistics;
+   static SBC_Encoder_t      Encoder;
+   static AUDIOSBC_Decoder_t Decoder;
+   static const SBC_Configuration_t Configuration = { 2, 16, AUDIOSBC_CHANNEL_MODE_JOINT_STEREO, AUDIOSBC_ALLOCATION_LOUDNESS, 8, 53 };
+
+   memset(&Encoder, 0, sizeof(Encoder));
+
+   Encoder.Configuration = Configuration;
+
+   for(Index = 0; Index < (AUDIOSBC_MAXIMUM_FRAMES * AUDIOSBC_CHANNELS); Index++)
+      Input[Index] = (short)(Random() >> 16);
+
+   Length = EncodeSBC(&Encoder, Input, Frame);
+
+   AUDIOSBC_Initialize(&Decoder);
+
+   ret_val = 0;
+
+   /* A scale factor with a flipped bit.                                */
+   Frame[5] ^= 0x10;
+
+   if((AUDIOSBC_Decode(&Decoder, Frame, Length, &Frames, Output) != (int)Length) || (Frames))
+      ret_val = 1;
+
+   Frame[5] ^= 0x10;
+
+   if((AUDIOSBC_Decode(&Decoder, Frame, Length - 1, &Frames, Output) >= 0) || (Frames))
+      ret_val = 1;
+
+   Frame[0] = 0x9D;
+
+   if((AUDIOSBC_Decode(&Decoder, Frame, Length, &Frames, Output) >= 0) || (Frames))
+      ret_val = 1;
+
+   Frame[0] = AUDIOSBC_SYNCWORD;
+
+   if((AUDIOSBC_Decode(&Decoder, Frame, Length, &Frames, Output) != (int)Length) || (Frames != AUDIOSBC_MAXIMUM_FRAMES))
+      ret_val = 1;
+
+   AUDIOSBC_Query_Statistics(&Decoder, &Statistics);
+
+   if((Statistics.Frames != 1) || (Statistics.CRCErrors != 1) || (Statistics.InvalidFrames != 2))
+      ret_val = 1;
+
+   printf("AUDIOSBC errors: %lu frames, %lu CRC errors, %lu invalid frames%s\n", Statistics.Frames, Statistics.CRCErrors, Statistics.InvalidFrames, (ret_val) ? " FAILED" : "");
+
+   return(ret_val);
+}
+
+   /* The following function decodes frames of the largest stereo bit   */
+   /* pool in which the subbands alternate between the largest and the  */
+   /* smallest scale factor (15 and 0), so that the small subbands are  */
+   /* given bits but are more than SUBBAND_BITS + 1 bits below the      */
+   /* largest.  The samples of the large subbands stay near the middle  */
+   /* so that the output does not saturate.  Both versions of the       */
+   /* decoder must agree bit for bit and no sample may differ from the  */
+   /* floating point decoder by more than SBC_TOLERANCE.  This function */
+   /* returns the number of samples that differ.                        */
+static int CheckSBCScaleFactors(void)
+{
+   int                       ret_val;
+   unsigned int              Frame;
+   unsigned int              Length;
+   unsigned int              Position;
+   unsigned int              Channel;
+   unsigned int              Subband;
+   unsigned int              Block;
+   unsigned int              Index;
+   unsigned int              Frames;
+   unsigned int              BlockFrames;
+   unsigned int              ReferenceFrames;
+   unsigned long             Levels;
+   unsigned long             Sample;
+   unsigned long             Spread;
+   long                      Difference;
+   long                      MaximumDifference;
+   double                    Value;
+   short                     Output[AUDIOSBC_MAXIMUM_FRAMES * AUDIOSBC_CHANNELS];
+   short                     Reference[AUDIOSBC_MAXIMUM_FRAMES * AUDIOSBC_CHANNELS];
+   double                    Float[AUDIOSBC_MAXIMUM_FRAMES * AUDIOSBC_CHANNELS];
+   unsigned char             Data[SBC_MAXIMUM_FRAME_LENGTH];
+   unsigned char             ScaleFactors[AUDIOSBC_CHANNELS][AUDIOSBC_MAXIMUM_SUBBANDS];
+   unsigned char             Bits[AUDIOSBC_CHANNELS][AUDIOSBC_MAXIMUM_SUBBANDS];
+   AUDIOSBC_Format_t         Format;
+   static SBC_Encoder_t      Encoder;
+   static AUDIOSBC_Decoder_t BlockDecoder;
+   static AUDIOSBC_Decoder_t ReferenceDecoder;
+   static const SBC_Configuration_t Configuration = { 3, 16, AUDIOSBC_CHANNEL_MODE_STEREO, AUDIOSBC_ALLOCATION_SNR, 8, 250 };
+
+   ret_val           = 0;
+   MaximumDifference = 0;
+
+   memset(&Encoder, 0, sizeof(Encoder));
+
+   Encoder.Configuration = Configuration;
+
+   AUDIOSBC_Initialize(&BlockDecoder);
+   AUDIOSBC_Initialize(&ReferenceDecoder);
+
+   for(Channel = 0; Channel < AUDIOSBC_CHANNELS; Channel++)
+   {
+      for(Subband = 0; Subband < Configuration.Subbands; Subband++)
+         ScaleFactors[Channel][Subband] = ((Channel + Subband) & 1) ? 0 : 15;
+   }
+
+   AllocateSBCBits(&Configuration, ScaleFactors, Bits);
+
+   Frames = Configuration.Blocks * Configuration.Subbands;
+
+   for(Frame = 0; Frame < 4; Frame++)
+   {
+      memset(Data, 0, sizeof(Data));
+
+      Data[0]  = AUDIOSBC_SYNCWORD;
+      Data[1]  = (unsigned char)((Configuration.Frequency << 6) | (((Configuration.Blocks / 4) - 1) << 4) | (Configuration.ChannelMode << 2) | (Configuration.AllocationMethod << 1) | 1);
+      Data[2]  = (unsigned char)Configuration.Bitpool;
+      Position = 32;
+
+      for(Channel = 0; Channel < AUDIOSBC_CHANNELS; Channel++)
+      {
+         for(Subband = 0; Subband < Configuration.Subbands; Subband++)
+            WriteSBCBits(Data, &Position, 4, ScaleFactors[Channel][Subband]);
+      }
+
+      WriteSBCCRC(Data, Position);
+
+      for(Block = 0; Block < Configuration.Blocks; Block++)
+      {
+         for(Channel = 0; Channel < AUDIOSBC_CHANNELS; Channel++)
+         {
+            for(Subband = 0; Subband < Configuration.Subbands; Subband++)
+            {
+               Encoder.Subband[Block][Channel][Subband] = 0;
+
+               if(Bits[Channel][Subband])
+               {
+                  Levels = (1UL << Bits[Channel][Subband]) - 1;
+
+                  /* A large subband is kept within 1/32 of its range.  */
+                  if(ScaleFactors[Channel][Subband])
+                  {
+                     Spread = Levels / 32;
+                     Sample = ((Levels - 1) / 2) - Spread + (Random() % ((Spread * 2) + 1));
+                  }
+                  else
+                     Sample = Random() % Levels;
+
+                  WriteSBCBits(Data, &Position, Bits[Channel][Subband], (unsigned int)Sample);
+
+                  Encoder.Subband[Block][Channel][Subband] = (double)(2UL << ScaleFactors[Channel][Subband]) * ((((2.0 * Sample) + 1.0) / Levels) - 1.0);
+               }
+            }
+         }
+      }
+
+      Length = (Position + 7) / 8;
+
+      DecodeSBC(&Encoder, Float);
+
+      if((AUDIOSBC_ParseHeader(Data, sizeof(Data), &Format) != (int)Length) || (AUDIOSBC_Decode(&BlockDecoder, Data, Length, &BlockFrames, Output) != (int)Length) || (AUDIOSBC_DecodeReference(&ReferenceDecoder, Data, Length, &ReferenceFrames, Reference) != (int)Length) || (BlockFrames != Frames) || (ReferenceFrames != Frames))
+         ret_val++;
+      else
+      {
+         for(Index = 0; Index < (Frames * AUDIOSBC_CHANNELS); Index++)
+         {
+            if(Output[Index] != Reference[Index])
+               ret_val++;
+
+            Value      = (Float[Index] > 32767.0) ? 32767.0 : ((Float[Index] < -32768.0) ? -32768.0 : Float[Index]);
+            Difference = labs(Output[Index] - lrint(Value));
+
+            if(Difference > MaximumDifference)
+               MaximumDifference = Difference;
+         }
+      }
+   }
+
+   if(MaximumDifference > SBC_TOLERANCE)
+      ret_val++;
+
+   printf("AUDIOSBC scale factors 15 and 0, bitpool %u: largest difference %ld against floating point%s\n", Configuration.Bitpool, MaximumDifference, (ret_val) ? " FAILED" : "");
+
+   return(ret_val);
+}
+
+   /* The following function decodes the specified file of SBC frames    */
+   /* (reference vectors) with both versions, which must agree bit for  */
+   /* bit.  If a file of the decoded reference samples is specified (16 */
+   /* bit little endian, interleaved by the channels of the stream) no  */
+   /* sample may differ from it by more than SBC_TOLERANCE.  This       */
+   /* function returns the number of samples that differ (or 1 if the   */
+   /* files could not be read).                                         */
+static int CheckSBCVectors(char *StreamName, char *ReferenceName)
+{
+   int                   ret_val;
+   int                   Result;
+   FILE                 *File;
+   unsigned char        *Stream;
+   unsigned char         Bytes[2];
+   long                  Size;
+   long                  Difference;
+   long                  MaximumDifference;
+   unsigned long         Samples;
+   unsigned long         Compared;
+   unsigned long         Exact;
+   unsigned int          Offset;
+   unsigned int          Frames;
+   unsigned int          Index;
+   unsigned int          Channel;
+   short                 Block[AUDIOSBC_MAXIMUM_FRAMES * AUDIOSBC_CHANNELS];
+   short                 Reference[AUDIOSBC_MAXIMUM_FRAMES * AUDIOSBC_CHANNELS];
+   FILE                 *ReferenceFile;
+   AUDIOSBC_Statistics_t Statistics;
+   static AUDIOSBC_Decoder_t BlockDecoder;
+   static AUDIOSBC_Decoder_t ReferenceDecoder;
+
+   ret_val       = 0;
+   Stream        = NULL;
+   ReferenceFile = NULL;
+   Size          = 0;
+
+   if((File = fopen(StreamName, "rb")) != NULL)
+   {
+      if((!fseek(File, 0, SEEK_END)) && ((Size = ftell(File)) > 0) && (!fseek(File, 0, SEEK_SET)) && ((Stream = malloc(Size)) != NULL))
+      {
+         if(fread(Stream, 1, Size, File) != (size_t)Size)
+            Size = 0;
+      }
+
+      fclose(File);
+   }
+
+   if((ReferenceName) && ((ReferenceFile = fopen(ReferenceName, "rb")) == NULL))
+      Size = 0;
+
+   if((Stream) && (Size > 0))
+   {
+      AUDIOSBC_Initialize(&BlockDecoder);
+      AUDIOSBC_Initialize(&ReferenceDecoder);
+
+      MaximumDifference = 0;
+      Samples           = 0;
+      Compared          = 0;
+      Exact             = 0;
+      Offset            = 0;
+
+      while((Offset < (unsigned int)Size) && ((Result = AUDIOSBC_Decode(&BlockDecoder, &Stream[Offset], (unsigned int)(Size - Offset), &Frames, Block)) > 0))
+      {
+         AUDIOSBC_DecodeReference(&ReferenceDecoder, &Stream[Offset], (unsigned int)(Size - Offset), &Frames, Reference);
+
+         for(Index = 0; Index < (Frames * AUDIOSBC_CHANNELS); Index++)
+         {
+            if(Block[Index] != Reference[Index])
+               ret_val++;
+         }
+
+         /* The reference samples have the channels of the stream.      */
+         for(Index = 0; (ReferenceFile) && (Index < Frames); Index++)
+         {
+            for(Channel = 0; Channel < BlockDecoder.Format.Channels; Channel++)
+            {
+               if(fread(Bytes, 1, 2, ReferenceFile) == 2)
+               {
+                  Difference = labs((long)Block[(Index * AUDIOSBC_CHANNELS) + Channel] - (long)(short)(Bytes[0] | (Bytes[1] << 8)));
+
+                  if(Difference > MaximumDifference)
+                     MaximumDifference = Difference;
+
+                  if(!Difference)
+                     Exact++;
+
+                  Compared++;
+               }
+            }
+         }
+
+         Samples += Frames * BlockDecoder.Format.Channels;
+         Offset  += (unsigned int)Result;
+      }
+
+      AUDIOSBC_Query_Statistics(&BlockDecoder, &Statistics);
+
+      if((Offset != (unsigned int)Size) || (MaximumDifference > SBC_TOLERANCE) || ((ReferenceFile) && (Compared != Samples)))
+         ret_val++;
+
+      printf("AUDIOSBC %s: %lu frames (%lu CRC errors), %lu samples", StreamName, Statistics.Frames, Statistics.CRCErrors, Samples);
+
+      if(ReferenceFile)
+         printf(", %lu of %lu samples of %s exact (largest difference %ld)", Exact, Compared, ReferenceName, MaximumDifference);
+
+      printf("%s\n", (ret_val) ? " FAILED" : "");
+   }
+   else
+   {
+      fprintf(stderr, "Unable to read %s\n", ((Stream) || (!ReferenceName)) ? StreamName : ReferenceName);
+
+      ret_val = 1;
+   }
+
+   if(ReferenceFile)
+      fclose(ReferenceFile);
+
+   free(Stream);
+
+   return(ret_val);
+}
+
+   /* The following function checks the mixer with the specified signal  */
+   /* (as stereo frames) and a tone as its sources, through the changes */
+   /* of MixChanges.  The block version mixes in place over the first   */
+   /* source with random block lengths and must agree with the reference*/
+   /* version, and the first source must pass unchanged once it has     */
+   /* faded in alone.  Both versions are then timed mixing both sources.*/
+   /* This function returns the number of samples that differ.          */
+static int CheckMixer(unsigned int Length, short *Input)
+{
+   int                ret_val;
+   int                Changed;
+   short             *Tone;
+   short             *Block;
+   short             *Reference;
+   unsigned int       Frames;
+   unsigned int       Index;
+   unsigned int       Count;
+   unsigned int       Change;
+   unsigned int       Position;
+   unsigned int       Next;
+   unsigned long long StartTime;
+   unsigned long long StartCycles;
+   Timing_t           BlockTiming;
+   Timing_t           ReferenceTiming;
+   const short       *Inputs[MIX_SOURCES];
+   AUDIOMIX_Mixer_t   BlockMixer;
+   AUDIOMIX_Mixer_t   ReferenceMixer;
+
+   ret_val   = 0;
+   Changed   = 0;
+   Frames    = Length / AUDIOMIX_CHANNELS;
+   Tone      = malloc(Frames * AUDIOMIX_CHANNELS * sizeof(short));
+   Block     = malloc(Frames * AUDIOMIX_CHANNELS * sizeof(short));
+   Reference = malloc(Frames * AUDIOMIX_CHANNELS * sizeof(short));
+
+   if((Tone) && (Block) && (Reference))
+   {
+      for(Index = 0; Index < Frames; Index++)
+      {
+         Tone[Index * AUDIOMIX_CHANNELS]       = (short)lrint(16000.0 * sin(2.0 * M_PI * 997.0 * Index / 48000.0));
+         Tone[(Index * AUDIOMIX_CHANNELS) + 1] = (short)lrint(-12000.0 * sin(2.0 * M_PI * 1499.0 * Index / 48000.0));
+      }
+
+      memcpy(Block, Input, (Frames * AUDIOMIX_CHANNELS * sizeof(short)));
+
+      AUDIOMIX_Initialize(&BlockMixer, MIX_SOURCES, MIX_FADE_FRAMES);
+      AUDIOMIX_Initialize(&ReferenceMixer, MIX_SOURCES, MIX_FADE_FRAMES);
+
+      /* Each change is made at its frame in both versions, the block   */
+      /* version also ends its blocks at random.                        */
+      for(Index = 0, Change = 0; Index < Frames; Index = Next)
+      {
+         while(Change < (sizeof(MixChanges) / sizeof(MixChanges[0])))
+         {
+            Position = ((Frames / 8) * MixChanges[Change].Eighth) + MixChanges[Change].Offset;
+
+            if(Position > Index)
+               break;
+
+            AUDIOMIX_SetGain(&BlockMixer, MixChanges[Change].Source, MixChanges[Change].Gain);
+            AUDIOMIX_SetGain(&ReferenceMixer, MixChanges[Change].Source, MixChanges[Change].Gain);
+
+            Change++;
+         }
+
+         Next = (Change < (sizeof(MixChanges) / sizeof(MixChanges[0]))) ? (((Frames / 8) * MixChanges[Change].Eighth) + MixChanges[Change].Offset) : Frames;
+         if(Next > Frames)
+            Next = Frames;
+
+         Inputs[0] = &Input[Index * AUDIOMIX_CHANNELS];
+         Inputs[1] = &Tone[Index * AUDIOMIX_CHANNELS];
+
+         AUDIOMIX_ProcessReference(&ReferenceMixer, (Next - Index), Inputs, &Reference[Index * AUDIOMIX_CHANNELS]);
+
+         for(Position = Index; Position < Next; Position += Count)
+         {
+            Count = 1 + (unsigned int)(Random() % MAXIMUM_BLOCK_LENGTH);
+            if(Count > (Next - Position))
+               Count = Next - Position;
+
+            Inputs[0] = &Block[Position * AUDIOMIX_CHANNELS];
+            Inputs[1] = &Tone[Position * AUDIOMIX_CHANNELS];
+
+            AUDIOMIX_Process(&BlockMixer, Count, Inputs, &Block[Position * AUDIOMIX_CHANNELS]);
+         }
+      }
+
+      for(Index = 0; Index < (Frames * AUDIOMIX_CHANNELS); Index++)
+      {
+         if(Block[Index] != Reference[Index])
+         {
+            if(!ret_val)
+               printf("   First difference at frame %u: %d, reference %d\n", (Index / AUDIOMIX_CHANNELS), Block[Index], Reference[Index]);
+
+            ret_val++;
+         }
+
+         if((Index >= (MIX_FADE_FRAMES * AUDIOMIX_CHANNELS)) && (Index < ((Frames / 8) * AUDIOMIX_CHANNELS)) && (Block[Index] != Input[Index]))
+            Changed++;
+      }
+
+      printf("AUDIOMIX %u sources: %u frames, %d differences, %d samples of a lone source changed%s\n", MIX_SOURCES, Frames, ret_val, Changed, (Changed) ? " FAILED" : "");
+
+      ret_val += Changed;
+
+      /* Time both versions in periods, mixing both sources.            */
+      Inputs[0] = Input;
+      Inputs[1] = Tone;
+
+      AUDIOMIX_Initialize(&BlockMixer, MIX_SOURCES, MIX_FADE_FRAMES);
+      AUDIOMIX_SetGain(&BlockMixer, 0, AUDIOMIX_UNITY_GAIN / 2);
+      AUDIOMIX_SetGain(&BlockMixer, 1, AUDIOMIX_UNITY_GAIN / 2);
+
+      StartTime   = GetNanoseconds();
+      StartCycles = GetCycles();
+
+      for(Index = 0; Index < Frames; Index += Count)
+      {
+         Count     = ((Frames - Index) < PERIOD_LENGTH) ? (Frames - Index) : PERIOD_LENGTH;
+         Inputs[0] = &Input[Index * AUDIOMIX_CHANNELS];
+         Inputs[1] = &Tone[Index * AUDIOMIX_CHANNELS];
+
+         AUDIOMIX_Process(&BlockMixer, Count, Inputs, &Block[Index * AUDIOMIX_CHANNELS]);
+      }
+
+      BlockTiming.Cycles      = GetCycles() - StartCycles;
+      BlockTiming.Nanoseconds = GetNanoseconds() - StartTime;
+
+      AUDIOMIX_Initialize(&ReferenceMixer, MIX_SOURCES, MIX_FADE_FRAMES);
+      AUDIOMIX_SetGain(&ReferenceMixer, 0, AUDIOMIX_UNITY_GAIN / 2);
+      AUDIOMIX_SetGain(&ReferenceMixer, 1, AUDIOMIX_UNITY_GAIN / 2);
+
+      StartTime   = GetNanoseconds();
+      StartCycles = GetCycles();
+
+      for(Index = 0; Index < Frames; Index += Count)
+      {
+         Count     = ((Frames - Index) < PERIOD_LENGTH) ? (Frames - Index) : PERIOD_LENGTH;
+         Inputs[0] = &Input[Index * AUDIOMIX_CHANNELS];
+         Inputs[1] = &Tone[Index * AUDIOMIX_CHANNELS];
+
+         AUDIOMIX_ProcessReference(&ReferenceMixer, Count, Inputs, &Reference[Index * AUDIOMIX_CHANNELS]);
+      }
+
+      ReferenceTiming.Cycles      = GetCycles() - StartCycles;
+      ReferenceTiming.Nanoseconds = GetNanoseconds() - StartTime;
+
+      DisplayTiming("block", Frames, &BlockTiming);
+      DisplayTiming("reference", Frames, &ReferenceTiming);
+   }
+   else
+   {
+      fprintf(stderr, "Out of memory\n");
+
+      ret_val = 1;
+   }
+
+   free(Tone);
+   free(Block);
+   free(Reference);
+
+   return(ret_val);
+}
+
+   /* The following function checks that each default clock plan is the */
+   /* one that AUDIOCLK_Plan() finds for its rate and that its error    */
+   /* matches the rate it gives, and shows the plans.  This function    */
+   /* returns the number of plans that differ.                          */
+static int CheckClockPlans(void)
+{
+   int                    ret_val;
+   int                    Differs;
+   unsigned int           Index;
+   unsigned long          Rate;
+   AUDIOCLK_Plan_t        Plan;
+   const AUDIOCLK_Plan_t *Default;
+
+   ret_val = 0;
+
+   for(Index = 0; Index < AUDIOCLK_NumberDefaultPlans; Index++)
+   {
+      Default = &AUDIOCLK_DefaultPlans[Index];
+
+      if(!AUDIOCLK_Plan(AUDIOCLK_INPUT_CLOCK, Default->SampleRate, &Plan))
+         Differs = ((Plan.PLLM != Default->PLLM) || (Plan.PLLN != Default->PLLN) || (Plan.PLLP != Default->PLLP) || (Plan.MCKDIV != Default->MCKDIV) || (Plan.Error != Default->Error)) ? 1 : 0;
+      else
+         Differs = 1;
+
+      /* The error is rounded to the nearest part per billion.          */
+      if(fabs((((double)AUDIOCLK_INPUT_CLOCK * Default->PLLN) / ((double)Default->PLLM * Default->PLLP * Default->MCKDIV * AUDIOCLK_MCLK_RATIO * Default->SampleRate) - 1.0) * 1e9 - Default->Error) > 0.5)
+         Differs = 1;
+
+      if(AUDIOCLK_FindPlan(AUDIOCLK_DefaultPlans, AUDIOCLK_NumberDefaultPlans, Default->SampleRate) != Default)
+         Differs = 1;
+
+      Rate = AUDIOCLK_Rate(AUDIOCLK_INPUT_CLOCK, Default);
+
+      printf("AUDIOCLK %5lu Hz: M %u, N %2u, P %2u, MCKDIV %2u, %5lu Hz (%+.1f ppm)%s\n", Default->SampleRate, Default->PLLM, Default->PLLN, Default->PLLP, Default->MCKDIV, Rate, Default->Error / 1000.0, (Differs) ? " FAILED" : "");
+
+      ret_val += Differs;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function checks that the gain of each level of the  */
+   /* volume stage is within one of the exact gain (0.5 dB a level),    */
+   /* that the gains fall with the level and that the mute level is     */
+   /* silent.  This function returns the number of levels that are      */
+   /* wrong.                                                            */
+static int CheckVolumeLevels(void)
+{
+   int          ret_val;
+   unsigned int Level;
+   unsigned int Gain;
+   unsigned int Previous;
+   double       Error;
+   double       MaximumError;
+
+   ret_val      = 0;
+   Previous     = AUDIOVOL_UNITY_GAIN;
+   MaximumError = 0.0;
+
+   for(Level = 0; Level <= AUDIOVOL_MINIMUM_LEVEL; Level++)
+   {
+      Gain  = AUDIOVOL_LevelGain(Level);
+      Error = fabs(Gain - (AUDIOVOL_UNITY_GAIN * pow(10.0, (-(double)Level / (20.0 * AUDIOVOL_LEVELS_PER_DECIBEL)))));
+
+      if(Error > MaximumError)
+         MaximumError = Error;
+
+      if((Error > 1.0) || (Gain > Previous) || (!Gain) || ((!Level) && (Gain != AUDIOVOL_UNITY_GAIN)))
+      {
+         if(!ret_val)
+            printf("   First wrong level %u: gain %u\n", Level, Gain);
+
+         ret_val++;
+      }
+
+      Previous = Gain;
+   }
+
+   if(AUDIOVOL_LevelGain(AUDIOVOL_MUTE_LEVEL))
+      ret_val++;
+
+   printf("AUDIOVOL levels: %u levels, largest error %.2f, %d wrong%s\n", (AUDIOVOL_MINIMUM_LEVEL + 1), MaximumError, ret_val, (ret_val) ? " FAILED" : "");
+
+   return(ret_val);
+}
+
+   /* The following function checks the volume stage with ramps of the  */
+   /* specified shape on the specified signal (as stereo frames).  The  */
+   /* volume or the mute changes at random VOLUME_CHANGES times, with   */
+   /* ramps of random length.  The block version scales in place with   */
+   /* random block lengths and must agree with the reference            */
+   /* version.  The gain halfway along a ramp to VOLUME_MEASURE_LEVEL   */
+   /* must then be halfway in decibels (exponential) or in gain         */
+   /* (linear), and both versions are timed with a new volume in every  */
+   /* period.  This function returns the number of samples that differ. */
+static int CheckVolume(AUDIOVOL_Ramp_t Ramp, unsigned int Length, short *Input)
+{
+   int                ret_val;
+   char              *Name;
+   short             *Block;
+   short             *Reference;
+   double             Expected;
+   double             Measured;
+   unsigned int       Frames;
+   unsigned int       Index;
+   unsigned int       Count;
+   unsigned int       Position;
+   unsigned int       Next;
+   unsigned int       Level;
+   unsigned int       RampFrames;
+   unsigned long long StartTime;
+   unsigned long long StartCycles;
+   Timing_t           BlockTiming;
+   Timing_t           ReferenceTiming;
+   AUDIOVOL_Stage_t   BlockStage;
+   AUDIOVOL_Stage_t   ReferenceStage;
+
+   ret_val   = 0;
+   Name      = (Ramp == vrExponential) ? "exponential" : "linear";
+   Frames    = Length / AUDIOVOL_CHANNELS;
+   Block     = malloc(Frames * AUDIOVOL_CHANNELS * sizeof(short));
+   Reference = malloc(Frames * AUDIOVOL_CHANNELS * sizeof(short));
+
+   if((Block) && (Reference))
+   {
+      memcpy(Block, Input, (Frames * AUDIOVOL_CHANNELS * sizeof(short)));
+
+      AUDIOVOL_Initialize(&BlockStage, Ramp, 0, 1);
+      AUDIOVOL_Initialize(&ReferenceStage, Ramp, 0, 1);
+
+      /* Each change is made at the same frame in both versions, which  */
+      /* may be in the middle of the ramp of the last change.  A quarter*/
+      /* of the changes mute or un-mute the stage.                      */
+      for(Index = 0; Index < Frames; Index = Next)
+      {
+         Next = Index + (Frames / VOLUME_CHANGES);
+         if(Next > Frames)
+            Next = Frames;
+
+         RampFrames = 1 + (unsigned int)(Random() % VOLUME_MAXIMUM_RAMP);
+
+         if(!(Random() % 4))
+         {
+            AUDIOVOL_SetMute(&BlockStage, !BlockStage.Muted, RampFrames);
+            AUDIOVOL_SetMute(&ReferenceStage, !ReferenceStage.Muted, RampFrames);
+         }
+         else
+         {
+            Level = (unsigned int)(Random() % (AUDIOVOL_MUTE_LEVEL + 1));
+
+            AUDIOVOL_SetLevel(&BlockStage, Level, RampFrames);
+            AUDIOVOL_SetLevel(&ReferenceStage, Level, RampFrames);
+         }
+
+         AUDIOVOL_ProcessReference(&ReferenceStage, (Next - Index), &Input[Index * AUDIOVOL_CHANNELS], &Reference[Index * AUDIOVOL_CHANNELS]);
+
+         for(Position = Index; Position < Next; Position += Count)
+         {
+            Count = 1 + (unsigned int)(Random() % MAXIMUM_BLOCK_LENGTH);
+            if(Count > (Next - Position))
+               Count = Next - Position;
+
+            AUDIOVOL_Process(&BlockStage, Count, &Block[Position * AUDIOVOL_CHANNELS], &Block[Position * AUDIOVOL_CHANNELS]);
+         }
+      }
+
+      for(Index = 0; Index < (Frames * AUDIOVOL_CHANNELS); Index++)
+      {
+         if(Block[Index] != Reference[Index])
+         {
+            if(!ret_val)
+               printf("   First difference at frame %u: %d, reference %d\n", (Index / AUDIOVOL_CHANNELS), Block[Index], Reference[Index]);
+
+            ret_val++;
+         }
+      }
+
+      /* Measure the gain halfway along a ramp from unity gain.         */
+      AUDIOVOL_Initialize(&BlockStage, Ramp, 0, 0);
+      AUDIOVOL_SetLevel(&BlockStage, VOLUME_MEASURE_LEVEL, VOLUME_MEASURE_FRAMES);
+      AUDIOVOL_Process(&BlockStage, (VOLUME_MEASURE_FRAMES / 2), Input, Block);
+
+      Measured = 20.0 * log10((double)(BlockStage.Gain >> 15) / AUDIOVOL_UNITY_GAIN);
+
+      if(Ramp == vrExponential)
+         Expected = -(double)VOLUME_MEASURE_LEVEL / (2.0 * AUDIOVOL_LEVELS_PER_DECIBEL);
+      else
+         Expected = 20.0 * log10((1.0 + ((double)AUDIOVOL_LevelGain(VOLUME_MEASURE_LEVEL) / AUDIOVOL_UNITY_GAIN)) / 2.0);
+
+      printf("AUDIOVOL %s: %u frames, %d differences, halfway %.2f dB (%.2f dB)%s\n", Name, Frames, ret_val, Measured, Expected, ((ret_val) || (fabs(Measured - Expected) > VOLUME_TOLERANCE)) ? " FAILED" : "");
+
+      if(fabs(Measured - Expected) > VOLUME_TOLERANCE)
+         ret_val++;
+
+      /* Time both versions in periods, ramping in each.                */
+      AUDIOVOL_Initialize(&BlockStage, Ramp, 0, 0);
+
+      StartTime   = GetNanoseconds();
+      StartCycles = GetCycles();
+
+      for(Index = 0; Index < Frames; Index += Count)
+      {
+         Count = ((Frames - Index) < PERIOD_LENGTH) ? (Frames - Index) : PERIOD_LENGTH;
+
+         AUDIOVOL_SetLevel(&BlockStage, ((Index / PERIOD_LENGTH) % 2) * VOLUME_MEASURE_LEVEL, PERIOD_LENGTH);
+         AUDIOVOL_Process(&BlockStage, Count, &Input[Index * AUDIOVOL_CHANNELS], &Block[Index * AUDIOVOL_CHANNELS]);
+      }
+
+      BlockTiming.Cycles      = GetCycles() - StartCycles;
+      BlockTiming.Nanoseconds = GetNanoseconds() - StartTime;
+
+      AUDIOVOL_Initialize(&ReferenceStage, Ramp, 0, 0);
+
+      StartTime   = GetNanoseconds();
+      StartCycles = GetCycles();
+
+      for(Index = 0; Index < Frames; Index += Count)
+      {
+         Count = ((Frames - Index) < PERIOD_LENGTH) ? (Frames - Index) : PERIOD_LENGTH;
+
+         AUDIOVOL_SetLevel(&ReferenceStage, ((Index / PERIOD_LENGTH) % 2) * VOLUME_MEASURE_LEVEL, PERIOD_LENGTH);
+         AUDIOVOL_ProcessReference(&ReferenceStage, Count, &Input[Index * AUDIOVOL_CHANNELS], &Reference[Index * AUDIOVOL_CHANNELS]);
+      }
+
+      ReferenceTiming.Cycles      = GetCycles() - StartCycles;
+      ReferenceTiming.Nanoseconds = GetNanoseconds() - StartTime;
+
+      DisplayTiming("block", Frames, &BlockTiming);
+      DisplayTiming("reference", Frames, &ReferenceTiming);
+   }
+   else
+   {
+      fprintf(stderr, "Out of memory\n");
+
+      ret_val = 1;
+   }
+
+   free(Block);
+   free(Reference);
+
+   return(ret_val);
+}
+
+int main(int argc, char *argv[])
+{
+   int                  ret_val;
+   int                  Differences;
+   short               *Signal;
+   double               THDN;
+   unsigned int         Index;
+   Timing_t             Timing;
+   AUDIODC_State_t      DCState;
+   SBC_Configuration_t  Configuration;
+
+   if(!ParseOptions(argc, argv))
+   {
+      RandomState = Options.Seed;
+
+      if((Signal = malloc(Options.Samples * sizeof(short))) != NULL)
+      {
+         GenerateMicrophone(Options.Samples, Signal);
+
+         Differences  = CheckDC("microphone", Options.Samples, Signal);
+
+         /* The filters are checked on the microphone as it is sent,    */
+         /* i.e. once the DC has been removed.                          */
+         AUDIODC_Initialize(&DCState, MIC_ZERO_SAMPLE, MIC_GAIN_SHIFT, MIC_THRESHOLD);
+         AUDIODC_Process(&DCState, Options.Samples, Signal, Signal);
+
+         Differences += CheckFilters("microphone", Options.Samples, Signal);
+
+         GenerateFullRange(Options.Samples, Signal);
+
+         Differences += CheckDC("full range", Options.Samples, Signal);
+         Differences += CheckFilters("full range", Options.Samples, Signal);
+
+         Differences += CheckConverter(44100, 48000, Options.Samples, Signal);
+         Differences += CheckConverter(48000, 44100, Options.Samples, Signal);
+
+         /* The cost is given per second of output, i.e. the share of   */
+         /* a core that the conversion takes.                           */
+         for(Index = 0; Index < (sizeof(Tones) / sizeof(Tones[0])); Index++)
+         {
+            THDN = MeasureTone(Tones[Index].InputRate, Tones[Index].OutputRate, Tones[Index].Correction, Tones[Index].Frequency, &Timing);
+
+            printf("AUDIOSRC %lu -> %lu Hz, %+.0f ppm, %5.0f Hz tone: THD+N %6.1f dB, %6.2f ms", Tones[Index].InputRate, Tones[Index].OutputRate, Tones[Index].Correction / 1000.0, Tones[Index].Frequency, THDN, Timing.Nanoseconds / 1e6);
+
+            if(Timing.Cycles)
+               printf(" (%.1f Mcycles)", Timing.Cycles / 1e6);
+
+            printf(" per second of audio\n");
+         }
+
+         Differences += CheckDrift(44100, 48000, 100000);
+         Differences += CheckDrift(44100, 48000, -150000);
+         Differences += CheckDrift(48000, 48000, 50000);
+
+         for(Index = 0; Index < (sizeof(Scenarios) / sizeof(Scenarios[0])); Index++)
+            Differences += CheckJitterBuffer(&Scenarios[Index]);
+
+         /* The mixer is checked on the full range signal (as stereo     */
+         /* frames), so that the mix saturates.                         */
+         Differences += CheckMixer(Options.Samples, Signal);
+
+         Differences += CheckClockPlans();
+
+         /* The volume stage is checked on the full range signal (as    */
+         /* stereo frames).                                             */
+         Differences += CheckVolumeLevels();
+         Differences += CheckVolume(vrLinear, Options.Samples, Signal);
+         Differences += CheckVolume(vrExponential, Options.Samples, Signal);
+
+         /* Every combination of subbands, blocks, channel mode and      */
+         /* allocation method (with the sample rate in turn).           */
+         for(Index = 0; Index < 64; Index++)
+         {
+            Configuration.Subbands         = (Index & 0x20) ? 8 : 4;
+            Configuration.Blocks           = (((Index >> 3) & 0x03) + 1) * 4;
+            Configuration.ChannelMode      = (Index >> 1) & 0x03;
+            Configuration.AllocationMethod = Index & 0x01;
+            Configuration.Frequency        = (Index >> 2) & 0x03;
+            Configuration.Bitpool          = (Configuration.ChannelMode >= AUDIOSBC_CHANNEL_MODE_STEREO) ? 53 : 31;
+
+            Differences += CheckSBC(&Configuration, 0);
+         }
+
+         for(Index = 0; Index < (sizeof(SBCConfigurations) / sizeof(SBCConfigurations[0])); Index++)
+            Differences += CheckSBC(&SBCConfigurations[Index], (Index >= ((sizeof(SBCConfigurations) / sizeof(SBCConfigurations[0])) - SBC_TIMED_CONFIGURATIONS)));
+
+         Differences += CheckSBCErrors();
+         Differences += CheckSBCScaleFactors();
+
+         if(Options.Vectors)
+            Differences += CheckSBCVectors(Options.Vectors, Options.Reference);
+
+         free(Signal);
+
+         ret_val = (Differences) ? 1 : 0;
+      }
+      else
+      {
+         fprintf(stderr, "Out of memory\n");
+
+         ret_val = 1;
+      }
+   }
+   else
+   {
+      Usage(argv[0]);
+
+      ret_val = 2;
+   }
+
+   return(ret_val);
+}
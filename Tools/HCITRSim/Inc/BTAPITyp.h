@@ -0,0 +1,29 @@
+/*****< btapityp.h >***********************************************************/
+/*                                                                            */
+/*  BTAPITyp - Stand-in for the Bluetopia type definitions that are used by   */
+/*             the HCI transport, for the host simulation only.  The          */
+/*             Bluetopia SDK is not part of this tree.                        */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __BTAPITYPH__
+#define __BTAPITYPH__
+
+#include <stddef.h>
+
+typedef unsigned char  Boolean_t;
+typedef unsigned char  Byte_t;
+typedef unsigned short Word_t;
+typedef unsigned int   DWord_t;
+
+#ifndef TRUE
+   #define TRUE        1
+#endif
+
+#ifndef FALSE
+   #define FALSE       0
+#endif
+
+#define BTPSAPI
+#define BTPSCONST      const
+
+#endif
@@ -0,0 +1,24 @@
+/*****< btpskrnl.h >***********************************************************/
+/*                                                                            */
+/*  BTPSKRNL - Stand-in for the Bluetopia kernel functions that are used by   */
+/*             the HCI transport, for the host simulation only (see           */
+/*             SIMKRNL.c).                                                    */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __BTPSKRNLH__
+#define __BTPSKRNLH__
+
+#include "BTAPITyp.h"
+
+#define DBG_ZONE_GENERAL         0
+
+   /* Debug messages are not output by the simulation.                  */
+#define DBG_MSG(_Zone, _Message)
+
+void BTPSAPI BTPS_Delay(unsigned long MilliSeconds);
+unsigned long BTPSAPI BTPS_GetTickCount(void);
+void BTPSAPI BTPS_MemInitialize(void *Destination, unsigned char Value, unsigned long Size);
+void BTPSAPI BTPS_MemCopy(void *Destination, BTPSCONST void *Source, unsigned long Size);
+int BTPSAPI BTPS_OutputMessage(BTPSCONST char *Format, ...);
+
+#endif
@@ -0,0 +1,77 @@
+/*****< freertos.h >***********************************************************/
+/*                                                                            */
+/*  FreeRTOS - Stand-in for the FreeRTOS functions that are used by the HCI   */
+/*             transport, for the host simulation only (see SIMKRNL.c).       */
+/*             Each task is a POSIX thread.  Any other thread that calls      */
+/*             these functions is given a task handle when it first needs     */
+/*             one.                                                           */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __FREERTOSH__
+#define __FREERTOSH__
+
+#include <pthread.h>
+#include <stdint.h>
+
+typedef long           BaseType_t;
+typedef unsigned long  UBaseType_t;
+typedef uint32_t       TickType_t;
+typedef unsigned long  StackType_t;
+
+typedef void (*TaskFunction_t)(void *Parameter);
+
+   /* The following structure holds the state of a task.  The           */
+   /* notification value is protected by the mutex.                     */
+typedef struct _tagStaticTask_t
+{
+   pthread_t        Thread;
+   pthread_mutex_t  Mutex;
+   pthread_cond_t   Condition;
+   unsigned long    NotifyValue;
+   TaskFunction_t   Function;
+   void            *Parameter;
+} StaticTask_t;
+
+typedef StaticTask_t *TaskHandle_t;
+
+   /* The following structure holds the state of a mutex.               */
+
+typedef struct _tagStaticSemaphore_t
+{
+   pthread_mutex_t  Mutex;
+} StaticSemaphore_t;
+
+typedef StaticSemaphore_t *SemaphoreHandle_t;
+
+#define pdFALSE                  ((BaseType_t)0)
+#define pdTRUE                   ((BaseType_t)1)
+#define pdPASS                   pdTRUE
+
+#define configMAX_PRIORITIES     56
+#define tskIDLE_PRIORITY         0
+
+#define portMAX_DELAY            ((TickType_t)0xFFFFFFFFUL)
+#define portTICK_PERIOD_MS       1
+#define pdMS_TO_TICKS(_x)        ((TickType_t)(_x))
+
+#define taskSCHEDULER_RUNNING    ((BaseType_t)2)
+
+   /* The host scheduler decides when a woken task runs.                */
+#define portYIELD_FROM_ISR(_x)   ((void)(_x))
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t Function, const char *Name, uint32_t StackDepth, void *Parameter, UBaseType_t Priority, StackType_t *Stack, StaticTask_t *Task);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+BaseType_t xTaskGetSchedulerState(void);
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(TickType_t Ticks);
+uint32_t ulTaskNotifyTake(BaseType_t ClearCountOnExit, TickType_t TicksToWait);
+BaseType_t xTaskNotifyGive(TaskHandle_t Task);
+void vTaskNotifyGiveFromISR(TaskHandle_t Task, BaseType_t *HigherPriorityTaskWoken);
+void vTaskSuspendAll(void);
+BaseType_t xTaskResumeAll(void);
+BaseType_t xPortIsInsideInterrupt(void);
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *Semaphore);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t Semaphore, TickType_t TicksToWait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t Semaphore);
+
+#endif
@@ -0,0 +1,290 @@
+/*****< hcitrsim.h >***********************************************************/
+/*                                                                            */
+/*  HCITRSIM - Host simulation of the MCU peripherals used by HCITRANS.       */
+/*                                                                            */
+/*  When HCITRANS.c is built with HCITR_HOST_SIMULATION defined this header   */
+/*  takes the place of the STM32 headers (see HCITRCFG.h).  The UART, its     */
+/*  DMA channels, RTS, the CTS EXTI interrupt and the nShutdown line are      */
+/*  simulated by HCITRSIM.c.  The UART wire is a pseudo-terminal, so the      */
+/*  controller can be played by another program or by the loop back peer      */
+/*  of HCITRBENCH.c.  Interrupts are run by the simulator thread and          */
+/*  DisableInterrupts() holds them off as PRIMASK does on the MCU.            */
+/******************************************************************************/
+#ifndef __HCITRSIMH__
+#define __HCITRSIMH__
+
+#include <stdint.h>
+#include <stddef.h>
+
+   /* The following structure holds the configuration of the simulator  */
+   /* (see HCITRSIM_Initialize()).                                      */
+   /*    LinkName          - If not NULL, a symbolic link to the slave  */
+   /*                        side of the pseudo-terminal is created     */
+   /*                        with this name.                            */
+   /*    BaudRatePercent   - The speed of the simulated wire as a       */
+   /*                        percentage of the baud rate that is        */
+   /*                        programmed in the UART, or zero to move    */
+   /*                        characters as fast as the host allows.     */
+   /*    CTSTogglePeriod   - If not zero, the period (in microseconds)  */
+   /*                        at which the controller raises CTS.        */
+   /*    CTSHighTime       - The time (in microseconds) that CTS is held*/
+   /*                        high each period.  CTS is lowered again    */
+   /*                        (waking the transport) afterwards.         */
+   /*    OverrunInterval   - If not zero, every Nth received character  */
+   /*                        is lost with an overrun error.             */
+   /*    BootTime          - The time (in microseconds) from the release*/
+   /*                        of nShutdown until the controller lowers   */
+   /*                        CTS.                                       */
+typedef struct _tagHCITRSIM_Configuration_t
+{
+   char          *LinkName;
+   unsigned int   BaudRatePercent;
+   unsigned long  CTSTogglePeriod;
+   unsigned long  CTSHighTime;
+   unsigned long  OverrunInterval;
+   unsigned long  BootTime;
+} HCITRSIM_Configuration_t;
+
+   /* The following structure is used with HCITRSIM_QueryStatistics()   */
+   /* to return what the simulator has seen.  TxBytes and RxBytes count */
+   /* the characters moved on the wire.  TxWhileCTSHigh counts the      */
+   /* characters that were sent while the controller had CTS raised     */
+   /* (the UART does not use hardware flow control, see usart.c) and    */
+   /* TxDropped those that did not fit in the pseudo-terminal.          */
+   /* InjectedOverruns and LostCharacters count the received characters */
+   /* that were lost to OverrunInterval and to a full receive FIFO.     */
+   /* Interrupts is the number of interrupt handlers that were run and  */
+   /* InterruptTime the processor time (in nanoseconds) spent in them.  */
+   /* MaskedCharacters is the number of character times during which an */
+   /* interrupt was pending but held off by DisableInterrupts().        */
+typedef struct _tagHCITRSIM_Statistics_t
+{
+   unsigned long long TxBytes;
+   unsigned long long RxBytes;
+   unsigned long      TxWhileCTSHigh;
+   unsigned long      TxDropped;
+   unsigned long      InjectedOverruns;
+   unsigned long      LostCharacters;
+   unsigned long      CTSToggles;
+   unsigned long      Interrupts;
+   unsigned long      MaskedCharacters;
+   unsigned long long InterruptTime;
+} HCITRSIM_Statistics_t;
+
+   /* The output delay flags of <termios.h> have the same names as the  */
+   /* control registers of the UART.                                    */
+#undef CR1
+#undef CR2
+#undef CR3
+
+   /* Register layout of the simulated peripherals.  Only the registers */
+   /* that are used by HCITRANS are present.                            */
+typedef struct
+{
+   volatile uint32_t CR1;
+   volatile uint32_t CR2;
+   volatile uint32_t CR3;
+   volatile uint32_t BRR;
+   volatile uint32_t ISR;
+   volatile uint32_t ICR;
+   volatile uint32_t RDR;
+   volatile uint32_t TDR;
+} USART_TypeDef;
+
+typedef struct
+{
+   volatile uint32_t CCR;
+   volatile uint32_t CNDTR;
+} DMA_Channel_TypeDef;
+
+typedef struct
+{
+   volatile uint32_t IMR1;
+} EXTI_TypeDef;
+
+typedef struct
+{
+   volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct
+{
+   volatile uint32_t CTRL;
+   volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef enum
+{
+   DMA2_Channel6_IRQn = 68,
+   DMA2_Channel7_IRQn = 69,
+   USART2_IRQn        = 38
+} IRQn_Type;
+
+typedef enum
+{
+   HAL_OK      = 0,
+   HAL_ERROR   = 1
+} HAL_StatusTypeDef;
+
+typedef struct __DMA_HandleTypeDef
+{
+   DMA_Channel_TypeDef *Instance;
+   void               (*XferCpltCallback)(struct __DMA_HandleTypeDef *hdma);
+   void               (*XferHalfCpltCallback)(struct __DMA_HandleTypeDef *hdma);
+   void               (*XferErrorCallback)(struct __DMA_HandleTypeDef *hdma);
+   void               (*XferAbortCallback)(struct __DMA_HandleTypeDef *hdma);
+} DMA_HandleTypeDef;
+
+typedef struct
+{
+   uint32_t BaudRate;
+} UART_InitTypeDef;
+
+typedef struct __UART_HandleTypeDef
+{
+   USART_TypeDef     *Instance;
+   UART_InitTypeDef   Init;
+   DMA_HandleTypeDef *hdmatx;
+   DMA_HandleTypeDef *hdmarx;
+} UART_HandleTypeDef;
+
+   /* The simulated peripherals.                                        */
+extern USART_TypeDef       HCITRSIM_USART2;
+extern DMA_Channel_TypeDef HCITRSIM_DMA2_Channel6;
+extern DMA_Channel_TypeDef HCITRSIM_DMA2_Channel7;
+extern EXTI_TypeDef        HCITRSIM_EXTI;
+extern CoreDebug_Type      HCITRSIM_CoreDebug;
+extern DWT_Type            HCITRSIM_DWT;
+extern UART_HandleTypeDef  huart2;
+extern uint32_t            SystemCoreClock;
+
+#define USART2                         (&HCITRSIM_USART2)
+#define DMA2_Channel6                  (&HCITRSIM_DMA2_Channel6)
+#define DMA2_Channel7                  (&HCITRSIM_DMA2_Channel7)
+#define EXTI                           (&HCITRSIM_EXTI)
+#define CoreDebug                      (&HCITRSIM_CoreDebug)
+#define DWT                            (&HCITRSIM_DWT)
+
+   /* Register bits (with the same values as the STM32L4R5).            */
+#define USART_CR1_UE                   0x00000001UL
+#define USART_CR1_RE                   0x00000004UL
+#define USART_CR1_TE                   0x00000008UL
+#define USART_CR1_IDLEIE               0x00000010UL
+#define USART_CR1_RXNEIE_RXFNEIE       0x00000020UL
+#define USART_CR1_TXEIE_TXFNFIE        0x00000080UL
+#define USART_CR1_FIFOEN               0x20000000UL
+
+#define USART_CR3_EIE                  0x00000001UL
+#define USART_CR3_DMAR                 0x00000040UL
+#define USART_CR3_DMAT                 0x00000080UL
+#define USART_CR3_TXFTIE               0x00800000UL
+#define USART_CR3_RXFTCFG_Pos          25
+#define USART_CR3_RXFTCFG              0x0E000000UL
+#define USART_CR3_RXFTIE               0x10000000UL
+#define USART_CR3_TXFTCFG_Pos          29
+#define USART_CR3_TXFTCFG              0xE0000000UL
+
+#define USART_ISR_FE                   0x00000002UL
+#define USART_ISR_NE                   0x00000004UL
+#define USART_ISR_ORE                  0x00000008UL
+#define USART_ISR_IDLE                 0x00000010UL
+#define USART_ISR_RXNE_RXFNE           0x00000020UL
+#define USART_ISR_TC                   0x00000040UL
+#define USART_ISR_TXE_TXFNF            0x00000080UL
+#define USART_ISR_RXFT                 0x04000000UL
+#define USART_ISR_TXFT                 0x08000000UL
+
+#define USART_ICR_FECF                 0x00000002UL
+#define USART_ICR_NECF                 0x00000004UL
+#define USART_ICR_ORECF                0x00000008UL
+#define USART_ICR_IDLECF               0x00000010UL
+#define USART_ICR_TCCF                 0x00000040UL
+
+#define UART_TXFIFO_THRESHOLD_1_2      (2UL << USART_CR3_TXFTCFG_Pos)
+#define UART_RXFIFO_THRESHOLD_1_2      (2UL << USART_CR3_RXFTCFG_Pos)
+
+#define EXTI_IMR1_IM3                  0x00000008UL
+
+#define CoreDebug_DEMCR_TRCENA_Msk     0x01000000UL
+#define DWT_CTRL_CYCCNTENA_Msk         0x00000001UL
+
+#define GPIO_PIN_3                     ((uint16_t)0x0008)
+
+   /* The following macros replace the accesses to the MCU that are not */
+   /* plain register accesses (see HCITRANS.c).                         */
+#define GetTimeStamp()                 HCITRSIM_GetCycleCount()
+#define ReadReceiveData()              HCITRSIM_ReadReceiveData()
+#define WriteTransmitData(_x)          HCITRSIM_WriteTransmitData(_x)
+#define StartTransmitDMA(_Buffer, _Length) HCITRSIM_StartTransmitDMA((_Buffer), (_Length))
+#define FlowOff()                      HCITRSIM_SetRTS(1)
+#define FlowOn()                       HCITRSIM_SetRTS(0)
+#define FlowIsOn()                     HCITRSIM_GetRTS()
+#define GetCTSLevel()                  HCITRSIM_GetCTS()
+#define ClearReset()                   HCITRSIM_SetReset(0)
+#define SetReset()                     HCITRSIM_SetReset(1)
+#define EnableUartPeriphClock()        HCITRSIM_SetUartClock(1)
+#define DisableUartPeriphClock()       HCITRSIM_SetUartClock(0)
+#define HoldTxdLine()                  HCITRSIM_SetTxdHeld(1)
+#define ReleaseTxdLine()               HCITRSIM_SetTxdHeld(0)
+#define DisableInterrupts()            HCITRSIM_DisableInterrupts()
+#define EnableInterrupts()             HCITRSIM_EnableInterrupts()
+
+   /* The following function opens the pseudo-terminal and starts the   */
+   /* simulator thread with the specified configuration.  The name of   */
+   /* the slave side of the pseudo-terminal (which the controller opens)*/
+   /* is returned in the specified buffer.  This function returns zero  */
+   /* if successful or a negative value if there was an error.          */
+int HCITRSIM_Initialize(HCITRSIM_Configuration_t *Configuration, char *SlaveName, unsigned int SlaveNameSize);
+
+   /* The following function stops the simulator thread and closes the  */
+   /* pseudo-terminal.                                                  */
+void HCITRSIM_Shutdown(void);
+
+   /* The following function returns the statistics of the simulator in */
+   /* the specified structure and, if the second parameter is non-zero, */
+   /* resets them.                                                      */
+void HCITRSIM_QueryStatistics(HCITRSIM_Statistics_t *Statistics, int Reset);
+
+   /* The following function sets the level of CTS (driven by the       */
+   /* controller).  Lowering CTS raises the CTS EXTI interrupt.         */
+void HCITRSIM_SetCTS(int High);
+
+   /* The following function returns non-zero while the controller is   */
+   /* held in reset (nShutdown low).                                    */
+int HCITRSIM_GetReset(void);
+
+   /* The following functions are used by the macros above.             */
+uint32_t HCITRSIM_GetCycleCount(void);
+unsigned char HCITRSIM_ReadReceiveData(void);
+void HCITRSIM_WriteTransmitData(unsigned char Data);
+void HCITRSIM_StartTransmitDMA(unsigned char *Buffer, unsigned int Length);
+void HCITRSIM_SetRTS(int High);
+int HCITRSIM_GetRTS(void);
+int HCITRSIM_GetCTS(void);
+void HCITRSIM_SetReset(int Active);
+void HCITRSIM_SetUartClock(int Enable);
+void HCITRSIM_SetTxdHeld(int Held);
+void HCITRSIM_DisableInterrupts(void);
+void HCITRSIM_EnableInterrupts(void);
+
+   /* The following function returns non-zero when it is called from an */
+   /* interrupt handler that is being run by the simulator.             */
+int HCITRSIM_IsInsideInterrupt(void);
+
+   /* Simulated HAL and CMSIS functions.                                */
+void MX_USART2_UART_Init(void);
+HAL_StatusTypeDef HAL_UARTEx_SetTxFifoThreshold(UART_HandleTypeDef *huart, uint32_t Threshold);
+HAL_StatusTypeDef HAL_UARTEx_SetRxFifoThreshold(UART_HandleTypeDef *huart, uint32_t Threshold);
+HAL_StatusTypeDef HAL_UARTEx_EnableFifoMode(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma);
+void NVIC_DisableIRQ(IRQn_Type IRQn);
+
+   /* Interrupt handlers and HAL callbacks (implemented by HCITRANS)    */
+   /* that are called by the simulator.                                 */
+void USART2_IRQHandler(void);
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin);
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
+
+#endif
@@ -0,0 +1,55 @@
+/*****< hcitrsimcfg.h >********************************************************/
+/*                                                                            */
+/*  HCITRSIMCFG - Transport mode selection for the host simulation.           */
+/*                                                                            */
+/*  This header is included by HCITRCFG.h after the transport options when    */
+/*  HCITR_HOST_SIMULATION is defined.  It removes the options that need       */
+/*  hardware that is not simulated and, for each HCITRSIM_DISABLE_xxx that    */
+/*  is defined on the compiler command line, the matching option, so that     */
+/*  every transport mode can be built from the same HCITRCFG.h (see the       */
+/*  Makefile).                                                                */
+/******************************************************************************/
+#ifndef __HCITRSIMCFGH__
+#define __HCITRSIMCFGH__
+
+   /* The SD card, the RTC and STOP2 are not simulated.                 */
+#undef HCITR_ENABLE_SNOOP_CAPTURE
+#undef HCITR_ENABLE_LOW_POWER_STOP
+
+#ifdef HCITRSIM_DISABLE_DMA_RX
+
+   #undef HCITR_ENABLE_DMA_RX
+
+#endif
+
+#ifdef HCITRSIM_DISABLE_DMA_TX
+
+   #undef HCITR_ENABLE_DMA_TX
+
+#endif
+
+#ifdef HCITRSIM_DISABLE_UART_FIFO
+
+   #undef HCITR_ENABLE_UART_FIFO
+
+#endif
+
+#ifdef HCITRSIM_DISABLE_H4_FRAMING
+
+   #undef HCITR_ENABLE_H4_FRAMING
+
+#endif
+
+#ifdef HCITRSIM_DISABLE_TX_PRIORITY_QUEUES
+
+   #undef HCITR_ENABLE_TX_PRIORITY_QUEUES
+
+#endif
+
+#ifdef HCITRSIM_DISABLE_RX_TASK
+
+   #undef HCITR_ENABLE_RX_TASK
+
+#endif
+
+#endif
@@ -0,0 +1,56 @@
+/*****< hcitypes.h >***********************************************************/
+/*                                                                            */
+/*  HCITypes - Stand-in for the Bluetopia HCI driver types that are used by   */
+/*             the HCI transport, for the host simulation only.               */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __HCITYPESH__
+#define __HCITYPESH__
+
+#include "BTAPITyp.h"
+
+typedef enum
+{
+   cpUART,
+   cpUART_RTS_CTS,
+   cpBCSP,
+   cpBCSP_Muzzled,
+   cpH4DS,
+   cpH4DS_RTS_CTS,
+   cpHCILL,
+   cpHCILL_RTS_CTS,
+   cp3Wire,
+   cp3Wire_RTS_CTS,
+   cpSIBS,
+   cpSIBS_RTS_CTS
+} HCI_COMM_Protocol_t;
+
+typedef struct _tagHCI_COMMDriverInformation_t
+{
+   unsigned int         DriverInformationSize;
+   unsigned int         COMPortNumber;
+   unsigned long        BaudRate;
+   HCI_COMM_Protocol_t  Protocol;
+   unsigned int         InitializationDelay;
+   char                *COMDeviceName;
+} HCI_COMMDriverInformation_t;
+
+#define HCI_COMM_RECONFIGURE_INFORMATION_RECONFIGURE_FLAGS_CHANGE_BAUDRATE 0x00000001
+#define HCI_COMM_RECONFIGURE_INFORMATION_RECONFIGURE_FLAGS_CHANGE_PROTOCOL 0x00000002
+
+typedef struct _tagHCI_COMMReconfigureInformation_t
+{
+   unsigned long        ReconfigureFlags;
+   unsigned long        BaudRate;
+   HCI_COMM_Protocol_t  Protocol;
+} HCI_COMMReconfigureInformation_t;
+
+#define HCI_COMM_DRIVER_RECONFIGURE_DATA_COMMAND_CHANGE_COMM_PARAMETERS  0x00000001
+
+typedef struct _tagHCI_Driver_Reconfigure_Data_t
+{
+   unsigned int  ReconfigureCommand;
+   void         *ReconfigureData;
+} HCI_Driver_Reconfigure_Data_t;
+
+#endif
@@ -0,0 +1,63 @@
+/*****< logicdat.h >***********************************************************/
+/*                                                                            */
+/*  LOGICDAT - Loader of Saleae Logic captures for the host tools.            */
+/*                                                                            */
+/*  Two formats are read: the .logicdata files that are saved by Logic 1.x    */
+/*  (see SaleaeLogicRecords) and the CSV export of the digital channels       */
+/*  ("Time [s], Channel 0, Channel 1, ...", one row per transition).  The     */
+/*  .logicdata format is not documented.  The loader only uses the parts      */
+/*  that hold the transitions of each channel, and each channel is checked    */
+/*  against the length that is recorded with it, so a channel that could      */
+/*  not be decoded is reported as not present instead of being wrong.         */
+/******************************************************************************/
+#ifndef __LOGICDATH__
+#define __LOGICDATH__
+
+   /* The following constant represents the largest number of channels  */
+   /* of a capture.                                                     */
+#define LOGICDAT_MAXIMUM_CHANNELS                  16
+
+   /* The following structure holds the transitions of one channel.     */
+   /* Edges holds the sample number of each transition (in increasing   */
+   /* order) and InitialLevel the level before the first one.           */
+typedef struct _tagLOGICDAT_Channel_t
+{
+   int                 Present;
+   int                 InitialLevel;
+   unsigned long       NumberEdges;
+   unsigned long long *Edges;
+} LOGICDAT_Channel_t;
+
+   /* The following structure holds a loaded capture.  Samples are      */
+   /* numbered from the start of the capture at SampleRate samples per  */
+   /* second (a CSV export is loaded with one sample per nanosecond).   */
+typedef struct _tagLOGICDAT_Capture_t
+{
+   unsigned long       SampleRate;
+   unsigned long long  NumberSamples;
+   unsigned int        NumberChannels;
+   LOGICDAT_Channel_t  Channels[LOGICDAT_MAXIMUM_CHANNELS];
+} LOGICDAT_Capture_t;
+
+   /* The following function loads the specified capture file (the      */
+   /* format is detected from its contents) into the specified          */
+   /* structure.  This function returns zero if successful or a         */
+   /* negative value if the file could not be read or was not           */
+   /* recognized.  LOGICDAT_Free() must be called to release a capture  */
+   /* that was loaded.                                                  */
+int LOGICDAT_Load(char *FileName, LOGICDAT_Capture_t *Capture);
+
+   /* The following function releases the memory of a capture that was  */
+   /* loaded by LOGICDAT_Load().                                        */
+void LOGICDAT_Free(LOGICDAT_Capture_t *Capture);
+
+   /* The following function returns the level (zero or one) of the     */
+   /* specified channel at the specified sample.                        */
+int LOGICDAT_GetLevel(LOGICDAT_Channel_t *Channel, unsigned long long Sample);
+
+   /* The following function returns the index of the first transition  */
+   /* of the specified channel that is at or after the specified sample */
+   /* (NumberEdges if there is none).                                   */
+unsigned long LOGICDAT_FindEdge(LOGICDAT_Channel_t *Channel, unsigned long long Sample);
+
+#endif
@@ -0,0 +1,12 @@
+/*****< semphr.h >*************************************************************/
+/*                                                                            */
+/*  semphr - Stand-in for the FreeRTOS semaphore header, for the host         */
+/*           simulation only.  Everything is declared in FreeRTOS.h.          */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __SEMPHRH__
+#define __SEMPHRH__
+
+#include "FreeRTOS.h"
+
+#endif
@@ -0,0 +1,12 @@
+/*****< task.h >***************************************************************/
+/*                                                                            */
+/*  task - Stand-in for the FreeRTOS task header, for the host simulation     */
+/*         only.  Everything is declared in FreeRTOS.h.                       */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __TASKH__
+#define __TASKH__
+
+#include "FreeRTOS.h"
+
+#endif
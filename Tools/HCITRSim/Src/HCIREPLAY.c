@@ -0,0 +1,1307 @@
+/*****< hcireplay.c >**********************************************************/
+/*                                                                            */
+/*  HCIREPLAY - Replay of a Saleae Logic capture of the controller start up.  */
+/*                                                                            */
+/*  The UART channels of a capture (see LOGICDAT.h) are decoded into a        */
+/*  time stamped stream of H4 packets, from which the reset, the boot of the  */
+/*  controller and the loading of the initialization script are timed.  With  */
+/*  -p the stream is then replayed through HCITRANS on the simulated UART     */
+/*  (see HCITRSIM.h): the host packets are written with HCITR_COMWrite() and  */
+/*  a peer on the pseudo-terminal plays the controller packets, each side     */
+/*  waiting for the packets of the other side that preceded it in the         */
+/*  capture and then for the recorded delay (divided by the -x factor).  The  */
+/*  controller packets are checked as they arrive at the data callback of     */
+/*  HCITR_COMOpen().                                                          */
+/******************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "BTPSKRNL.h"       /* Bluetooth Kernel Prototypes/Constants.         */
+#include "HCITRCFG.h"       /* HCI Transport configuration.                   */
+#include "HCITRANS.h"       /* HCI Transport Prototypes/Constants.            */
+#include "HCIH4.h"          /* H4 Framing Prototypes/Constants.               */
+#include "LOGICDAT.h"       /* Capture Loader Prototypes/Constants.           */
+
+   /* The following constants represent the defaults of the options.    */
+   /* The channels are those of BluetoothHCISetup.logicsettings, except */
+   /* that nShutdown is recorded on channel 4 of the captures in        */
+   /* SaleaeLogicRecords (the slow clock is on channel 5).              */
+#define DEFAULT_BAUD_RATE                          115200
+#define DEFAULT_CONTROLLER_CHANNEL                 0
+#define DEFAULT_HOST_CHANNEL                       1
+#define DEFAULT_CTS_CHANNEL                        3
+#define DEFAULT_SHUTDOWN_CHANNEL                   4
+#define DEFAULT_SPEED                              1.0
+
+   /* The following constants represent the directions of the packets.  */
+#define DIRECTION_HOST                             0
+#define DIRECTION_CONTROLLER                       1
+#define NUMBER_DIRECTIONS                          2
+
+   /* The following constants represent the results of SplitH4().       */
+#define SPLIT_PARTIAL                              0
+#define SPLIT_COMPLETE                             1
+#define SPLIT_UNKNOWN                              2
+
+   /* The following constants represent the largest H4 packet, the      */
+   /* number of bytes of each packet that are listed by -v and the      */
+   /* number of host gaps that are reported.                            */
+#define MAXIMUM_PACKET_LENGTH                      (1 + 4 + 65535)
+#define LISTED_PACKET_BYTES                        16
+#define NUMBER_REPORTED_GAPS                       5
+
+   /* The following constants represent the HCI events that complete a  */
+   /* command and the OGF of the vendor specific commands (which make   */
+   /* up the initialization script of the CC256x).                      */
+#define HCI_EVENT_COMMAND_COMPLETE                 0x0E
+#define HCI_EVENT_COMMAND_STATUS                   0x0F
+#define HCI_OGF_VENDOR_SPECIFIC                    0x3F
+
+   /* The following constant represents the time (in milliseconds) that */
+   /* the replay is given on top of twice the replayed time before it is*/
+   /* abandoned.                                                        */
+#define REPLAY_TIMEOUT_MARGIN                      5000
+
+   /* The following structure holds the state of a splitter of an H4    */
+   /* byte stream into packets.                                         */
+typedef struct _tagH4Splitter_t
+{
+   unsigned int  Count;
+   unsigned int  HeaderLength;
+   unsigned int  Length;
+   unsigned char Header[5];
+} H4Splitter_t;
+
+   /* The following structure holds a packet of the capture.  The times */
+   /* (in nanoseconds from the start of the capture) are those of the   */
+   /* start bit of the first byte and of the end of the last byte.      */
+   /* Index is the number of the packet among the packets of its        */
+   /* direction and OtherBefore the number of packets of the other      */
+   /* direction that ended before it started.                           */
+typedef struct _tagPacket_t
+{
+   unsigned int        Direction;
+   unsigned int        Index;
+   unsigned int        OtherBefore;
+   unsigned int        Length;
+   unsigned char      *Data;
+   unsigned long long  StartTime;
+   unsigned long long  EndTime;
+} Packet_t;
+
+   /* The following structure holds the decoded capture.  The packets   */
+   /* of both directions are sorted by their start time and             */
+   /* DirectionPackets holds the packets of each direction in order.    */
+   /* The reset and CTS times are only valid when TimesValid has the    */
+   /* matching TIME_VALID_xxx bit set.                                  */
+typedef struct _tagTrace_t
+{
+   unsigned int        NumberPackets;
+   unsigned int        AllocatedPackets;
+   Packet_t           *Packets;
+   unsigned int        NumberDirectionPackets[NUMBER_DIRECTIONS];
+   Packet_t          **DirectionPackets[NUMBER_DIRECTIONS];
+   unsigned long       Bytes[NUMBER_DIRECTIONS];
+   unsigned long       FramingErrors[NUMBER_DIRECTIONS];
+   unsigned long       UnknownBytes[NUMBER_DIRECTIONS];
+   unsigned long long  Duration;
+   unsigned int        TimesValid;
+   unsigned long long  ResetStartTime;
+   unsigned long long  ResetEndTime;
+   unsigned long long  CTSLowTime;
+} Trace_t;
+
+#define TIME_VALID_RESET                           0x01
+#define TIME_VALID_CTS                             0x02
+
+   /* The following structure holds the options of the program.         */
+typedef struct _tagOptions_t
+{
+   char          *FileName;
+   unsigned long  BaudRate;
+   unsigned int   Channels[NUMBER_DIRECTIONS];
+   unsigned int   CTSChannel;
+   unsigned int   ShutdownChannel;
+   int            Verbose;
+   int            Replay;
+   double         Speed;
+   int            NoHostGaps;
+} Options_t;
+
+   /* The following structure holds the state of a replay.  ArrivalTime */
+   /* holds the time (in microseconds) at which each packet arrived at  */
+   /* the other side (the peer for the host packets and the data        */
+   /* callback for the controller packets) and Arrived the number of    */
+   /* packets that arrived.  The checkers compare the bytes that arrive */
+   /* with the bytes of the capture.                                    */
+typedef struct _tagReplay_t
+{
+   pthread_mutex_t     Mutex;
+   pthread_cond_t      Condition;
+   unsigned long long  StartTime;
+   unsigned long long  Deadline;
+   unsigned long long *ArrivalTime[NUMBER_DIRECTIONS];
+   unsigned int        Arrived[NUMBER_DIRECTIONS];
+   H4Splitter_t        Splitter[NUMBER_DIRECTIONS];
+   unsigned int        CheckPacket[NUMBER_DIRECTIONS];
+   unsigned int        CheckOffset[NUMBER_DIRECTIONS];
+   unsigned long       Mismatches[NUMBER_DIRECTIONS];
+} Replay_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+static Options_t            Options;
+static Trace_t              Trace;
+static Replay_t             Replay;
+static char                 SlaveName[128];
+static volatile int         Running;
+static unsigned int         TransportID;
+
+static char                *DirectionNames[NUMBER_DIRECTIONS] = { "H>C", "C>H" };
+
+   /* The transport does not export its process function, it is called  */
+   /* by the Bluetopia scheduler on the target.                         */
+void BTPSAPI HCITR_COMProcess(unsigned int HCITransportID);
+
+   /* Local Function Prototypes.                                        */
+static void Usage(char *Name);
+static int ParseOptions(int argc, char *argv[]);
+static unsigned long long GetMicroseconds(void);
+static double ToMilliseconds(unsigned long long Time);
+static int SplitH4(H4Splitter_t *Splitter, unsigned char Byte);
+static int AddPacket(unsigned int Direction, unsigned int Length, unsigned char *Data, unsigned long long StartTime, unsigned long long EndTime);
+static int DecodeUART(LOGICDAT_Capture_t *Capture, unsigned int Direction);
+static int ComparePackets(const void *Packet1, const void *Packet2);
+static int BuildTrace(LOGICDAT_Capture_t *Capture);
+static unsigned long long GetEdgeTime(LOGICDAT_Capture_t *Capture, unsigned long long Sample);
+static void FindResetTimes(LOGICDAT_Capture_t *Capture);
+static unsigned int GetOpcode(Packet_t *Packet);
+static Packet_t *FindResponse(Packet_t *Command);
+static void DisplayPackets(void);
+static void DisplayTimings(LOGICDAT_Capture_t *Capture);
+static unsigned long long GetDueTime(Packet_t *Packet, unsigned long long PreviousWriteTime);
+static int WaitForPacket(Packet_t *Packet, unsigned long long PreviousWriteTime);
+static void CheckBytes(unsigned int Direction, unsigned int Length, unsigned char *Data);
+static void BTPSAPI DataCallback(unsigned int HCITransportID, unsigned int DataLength, unsigned char *DataBuffer, unsigned long CallbackParameter);
+static void *PeerThread(void *Parameter);
+
+#ifndef HCITR_ENABLE_RX_TASK
+
+static void *ProcessThread(void *Parameter);
+
+#endif
+
+static int RunReplay(void);
+
+   /* The following function displays the usage of the program.         */
+static void Usage(char *Name)
+{
+   fprintf(stderr, "Usage: %s [options] Capture\n", Name);
+   fprintf(stderr, "   Capture            .logicdata file or CSV export of the digital channels.\n");
+   fprintf(stderr, "   -b BaudRate        Baud rate of the capture (default %u).\n", DEFAULT_BAUD_RATE);
+   fprintf(stderr, "   -c Channel         Controller transmit channel (default %u).\n", DEFAULT_CONTROLLER_CHANNEL);
+   fprintf(stderr, "   -h Channel         Host transmit channel (default %u).\n", DEFAULT_HOST_CHANNEL);
+   fprintf(stderr, "   -C Channel         CTS channel (default %u).\n", DEFAULT_CTS_CHANNEL);
+   fprintf(stderr, "   -S Channel         nShutdown channel (default %u).\n", DEFAULT_SHUTDOWN_CHANNEL);
+   fprintf(stderr, "   -v                 List the packets.\n");
+   fprintf(stderr, "   -p                 Replay the capture through the transport.\n");
+   fprintf(stderr, "   -x Factor          Replay Factor times faster (default 1).\n");
+   fprintf(stderr, "   -g                 Replay without the host delays.\n");
+}
+
+   /* The following function parses the command line into the options.  */
+   /* The function returns zero if successful or a negative value if the*/
+   /* command line is not valid.                                        */
+static int ParseOptions(int argc, char *argv[])
+{
+   int ret_val;
+   int Option;
+
+   Options.BaudRate                             = DEFAULT_BAUD_RATE;
+   Options.Channels[DIRECTION_CONTROLLER]       = DEFAULT_CONTROLLER_CHANNEL;
+   Options.Channels[DIRECTION_HOST]             = DEFAULT_HOST_CHANNEL;
+   Options.CTSChannel                           = DEFAULT_CTS_CHANNEL;
+   Options.ShutdownChannel                      = DEFAULT_SHUTDOWN_CHANNEL;
+   Options.Speed                                = DEFAULT_SPEED;
+
+   ret_val = 0;
+
+   while((!ret_val) && ((Option = getopt(argc, argv, "b:c:h:C:S:vpx:g")) != -1))
+   {
+      switch(Option)
+      {
+         case 'b':
+            Options.BaudRate = strtoul(optarg, NULL, 0);
+            if(!Options.BaudRate)
+               ret_val = -1;
+            break;
+         case 'c':
+            Options.Channels[DIRECTION_CONTROLLER] = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+         case 'h':
+            Options.Channels[DIRECTION_HOST] = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+         case 'C':
+            Options.CTSChannel = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+         case 'S':
+            Options.ShutdownChannel = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+         case 'v':
+            Options.Verbose = 1;
+            break;
+         case 'p':
+            Options.Replay = 1;
+            break;
+         case 'x':
+            Options.Speed = strtod(optarg, NULL);
+            if(Options.Speed <= 0)
+               ret_val = -1;
+            break;
+         case 'g':
+            Options.NoHostGaps = 1;
+            break;
+         default:
+            ret_val = -1;
+            break;
+      }
+   }
+
+   if((!ret_val) && (Options.Channels[DIRECTION_CONTROLLER] < LOGICDAT_MAXIMUM_CHANNELS) && (Options.Channels[DIRECTION_HOST] < LOGICDAT_MAXIMUM_CHANNELS) && (optind == (argc - 1)))
+      Options.FileName = argv[optind];
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function returns the time (in microseconds) of the  */
+   /* monotonic clock.                                                  */
+static unsigned long long GetMicroseconds(void)
+{
+   struct timespec Now;
+
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+
+   return(((unsigned long long)Now.tv_sec * 1000000) + (Now.tv_nsec / 1000));
+}
+
+   /* The following function converts a time of the capture (in         */
+   /* nanoseconds) to milliseconds.                                     */
+static double ToMilliseconds(unsigned long long Time)
+{
+   return((double)Time / 1000000.0);
+}
+
+   /* The following function feeds a byte to the specified H4 splitter. */
+   /* The function returns SPLIT_COMPLETE when the byte completes a     */
+   /* packet (of Splitter->Length bytes), SPLIT_UNKNOWN when the byte   */
+   /* should have been a packet indicator but is not one and            */
+   /* SPLIT_PARTIAL otherwise.                                          */
+static int SplitH4(H4Splitter_t *Splitter, unsigned char Byte)
+{
+   int ret_val;
+
+   ret_val = SPLIT_PARTIAL;
+
+   if(!Splitter->Count)
+   {
+      switch(Byte)
+      {
+         case HCIH4_PACKET_TYPE_COMMAND:
+         case HCIH4_PACKET_TYPE_SCO:
+            Splitter->HeaderLength = 3;
+            break;
+         case HCIH4_PACKET_TYPE_ACL:
+            Splitter->HeaderLength = 4;
+            break;
+         case HCIH4_PACKET_TYPE_EVENT:
+            Splitter->HeaderLength = 2;
+            break;
+         case HCIH4_HCILL_GO_TO_SLEEP_IND:
+         case HCIH4_HCILL_GO_TO_SLEEP_ACK:
+         case HCIH4_HCILL_WAKE_UP_IND:
+         case HCIH4_HCILL_WAKE_UP_ACK:
+            Splitter->HeaderLength = 0;
+            break;
+         default:
+            ret_val = SPLIT_UNKNOWN;
+            break;
+      }
+
+      Splitter->Length = 1 + Splitter->HeaderLength;
+   }
+
+   if(ret_val != SPLIT_UNKNOWN)
+   {
+      if(Splitter->Count < sizeof(Splitter->Header))
+         Splitter->Header[Splitter->Count] = Byte;
+
+      /* The length of the payload is known once the header is complete.*/
+      if((++Splitter->Count == (1 + Splitter->HeaderLength)) && (Splitter->HeaderLength))
+      {
+         switch(Splitter->Header[0])
+         {
+            case HCIH4_PACKET_TYPE_ACL:
+               Splitter->Length += Splitter->Header[3] | (Splitter->Header[4] << 8);
+               break;
+            case HCIH4_PACKET_TYPE_EVENT:
+               Splitter->Length += Splitter->Header[2];
+               break;
+            default:
+               Splitter->Length += Splitter->Header[3];
+               break;
+         }
+      }
+
+      if(Splitter->Count == Splitter->Length)
+      {
+         Splitter->Count = 0;
+
+         ret_val         = SPLIT_COMPLETE;
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function adds a copy of the specified packet to the */
+   /* trace.  The function returns zero if successful or a negative     */
+   /* value if there is not enough memory.                              */
+static int AddPacket(unsigned int Direction, unsigned int Length, unsigned char *Data, unsigned long long StartTime, unsigned long long EndTime)
+{
+   int       ret_val;
+   Packet_t *Packets;
+   Packet_t *Packet;
+
+   ret_val = 0;
+
+   if(Trace.NumberPackets == Trace.AllocatedPackets)
+   {
+      if((Packets = (Packet_t *)realloc(Trace.Packets, (Trace.AllocatedPackets ? (Trace.AllocatedPackets * 2) : 256) * sizeof(Packet_t))) != NULL)
+      {
+         Trace.Packets          = Packets;
+         Trace.AllocatedPackets = Trace.AllocatedPackets ? (Trace.AllocatedPackets * 2) : 256;
+      }
+      else
+         ret_val = -1;
+   }
+
+   if(!ret_val)
+   {
+      Packet = &Trace.Packets[Trace.NumberPackets];
+
+      if((Packet->Data = (unsigned char *)malloc(Length)) == NULL)
+         ret_val = -1;
+   }
+
+   if(!ret_val)
+   {
+      memcpy(Packet->Data, Data, Length);
+
+      Packet->Direction   = Direction;
+      Packet->Length      = Length;
+      Packet->StartTime   = StartTime;
+      Packet->EndTime     = EndTime;
+
+      Trace.NumberPackets++;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function decodes the UART channel of the specified  */
+   /* direction (8 data bits, no parity, one stop bit) and adds its H4  */
+   /* packets to the trace.  Characters with a framing error (such as   */
+   /* the line being low while the controller is in reset) are dropped. */
+   /* The function returns zero if successful or a negative value if    */
+   /* the channel is not in the capture or there is not enough memory.  */
+static int DecodeUART(LOGICDAT_Capture_t *Capture, unsigned int Direction)
+{
+   int                 ret_val;
+   int                 Result;
+   double              BitTime;
+   double              NanosecondsPerSample;
+   unsigned int        Bit;
+   unsigned char       Data;
+   unsigned char      *Packet;
+   unsigned long       EdgeIndex;
+   unsigned long long  Start;
+   unsigned long long  StopSample;
+   unsigned long long  PacketStartTime;
+   H4Splitter_t        Splitter;
+   LOGICDAT_Channel_t *Channel;
+
+   Channel = &Capture->Channels[Options.Channels[Direction]];
+
+   if((Options.Channels[Direction] < Capture->NumberChannels) && (Channel->Present) && ((Packet = (unsigned char *)malloc(MAXIMUM_PACKET_LENGTH)) != NULL))
+   {
+      memset(&Splitter, 0, sizeof(Splitter));
+
+      BitTime              = (double)Capture->SampleRate / (double)Options.BaudRate;
+      NanosecondsPerSample = 1000000000.0 / (double)Capture->SampleRate;
+      PacketStartTime      = 0;
+      EdgeIndex            = 0;
+      ret_val              = 0;
+
+      while((!ret_val) && (EdgeIndex < Channel->NumberEdges))
+      {
+         Start = Channel->Edges[EdgeIndex];
+
+         /* A character starts with a falling edge.                     */
+         if(LOGICDAT_GetLevel(Channel, Start))
+         {
+            EdgeIndex++;
+            continue;
+         }
+
+         /* Each bit is sampled in its middle.                          */
+         for(Bit = 0, Data = 0; Bit < 8; Bit++)
+         {
+            if(LOGICDAT_GetLevel(Channel, Start + (unsigned long long)((Bit + 1.5) * BitTime)))
+               Data |= (unsigned char)(1 << Bit);
+         }
+
+         StopSample = Start + (unsigned long long)(9.5 * BitTime);
+
+         if(LOGICDAT_GetLevel(Channel, StopSample))
+         {
+            Trace.Bytes[Direction]++;
+
+            if(!Splitter.Count)
+               PacketStartTime = (unsigned long long)(Start * NanosecondsPerSample);
+
+            Packet[Splitter.Count] = Data;
+
+            if((Result = SplitH4(&Splitter, Data)) == SPLIT_COMPLETE)
+               ret_val = AddPacket(Direction, Splitter.Length, Packet, PacketStartTime, (unsigned long long)((Start + (10 * BitTime)) * NanosecondsPerSample));
+            else
+            {
+               if(Result == SPLIT_UNKNOWN)
+                  Trace.UnknownBytes[Direction]++;
+            }
+         }
+         else
+            Trace.FramingErrors[Direction]++;
+
+         EdgeIndex = LOGICDAT_FindEdge(Channel, StopSample);
+      }
+
+      /* A packet that is cut off by the end of the capture is dropped. */
+      Trace.UnknownBytes[Direction] += Splitter.Count;
+
+      free(Packet);
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function is the comparison function (by start time) */
+   /* that is used to sort the packets of the trace.                    */
+static int ComparePackets(const void *Packet1, const void *Packet2)
+{
+   int ret_val;
+
+   if(((Packet_t *)Packet1)->StartTime < ((Packet_t *)Packet2)->StartTime)
+      ret_val = -1;
+   else
+   {
+      if(((Packet_t *)Packet1)->StartTime > ((Packet_t *)Packet2)->StartTime)
+         ret_val = 1;
+      else
+         ret_val = (int)((Packet_t *)Packet1)->Direction - (int)((Packet_t *)Packet2)->Direction;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function decodes both directions of the capture into*/
+   /* the trace and links the packets of each direction to the packets  */
+   /* of the other direction that preceded them.  The function returns  */
+   /* zero if successful or a negative value if there was an error.     */
+static int BuildTrace(LOGICDAT_Capture_t *Capture)
+{
+   int           ret_val;
+   unsigned int  Index;
+   unsigned int  Direction;
+   unsigned int  OtherIndex;
+   Packet_t     *Packet;
+   Packet_t     *Other;
+
+   Trace.Duration = (unsigned long long)((double)Capture->NumberSamples * (1000000000.0 / (double)Capture->SampleRate));
+
+   if((!DecodeUART(Capture, DIRECTION_HOST)) && (!DecodeUART(Capture, DIRECTION_CONTROLLER)))
+   {
+      qsort(Trace.Packets, Trace.NumberPackets, sizeof(Packet_t), ComparePackets);
+
+      ret_val = 0;
+
+      for(Direction = 0; (!ret_val) && (Direction < NUMBER_DIRECTIONS); Direction++)
+      {
+         if((Trace.DirectionPackets[Direction] = (Packet_t **)malloc((Trace.NumberPackets + 1) * sizeof(Packet_t *))) == NULL)
+            ret_val = -1;
+      }
+
+      for(Index = 0; (!ret_val) && (Index < Trace.NumberPackets); Index++)
+      {
+         Packet        = &Trace.Packets[Index];
+         Packet->Index = Trace.NumberDirectionPackets[Packet->Direction];
+
+         Trace.DirectionPackets[Packet->Direction][Trace.NumberDirectionPackets[Packet->Direction]++] = Packet;
+      }
+
+      /* The packets of the other direction that ended before a packet  */
+      /* started are the ones that it waits for during a replay.        */
+      for(Index = 0; (!ret_val) && (Index < Trace.NumberPackets); Index++)
+      {
+         Packet     = &Trace.Packets[Index];
+         Direction  = Packet->Direction ^ 1;
+
+         for(OtherIndex = (Packet->Index ? Trace.DirectionPackets[Packet->Direction][Packet->Index - 1]->OtherBefore : 0); OtherIndex < Trace.NumberDirectionPackets[Direction]; OtherIndex++)
+         {
+            Other = Trace.DirectionPackets[Direction][OtherIndex];
+
+            if(Other->EndTime > Packet->StartTime)
+               break;
+         }
+
+         Packet->OtherBefore = OtherIndex;
+      }
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function converts a sample of the capture to a time */
+   /* (in nanoseconds).                                                 */
+static unsigned long long GetEdgeTime(LOGICDAT_Capture_t *Capture, unsigned long long Sample)
+{
+   return((unsigned long long)((double)Sample * (1000000000.0 / (double)Capture->SampleRate)));
+}
+
+   /* The following function finds the last reset of the controller     */
+   /* before the first host packet (nShutdown low) and the time at which*/
+   /* the controller lowered CTS after it.                              */
+static void FindResetTimes(LOGICDAT_Capture_t *Capture)
+{
+   unsigned long       Index;
+   unsigned long long  FirstTime;
+   unsigned long long  Time;
+   LOGICDAT_Channel_t *Channel;
+
+   FirstTime = Trace.NumberDirectionPackets[DIRECTION_HOST] ? Trace.DirectionPackets[DIRECTION_HOST][0]->StartTime : Trace.Duration;
+
+   if((Options.ShutdownChannel < Capture->NumberChannels) && (Capture->Channels[Options.ShutdownChannel].Present))
+   {
+      Channel = &Capture->Channels[Options.ShutdownChannel];
+
+      for(Index = 0; Index < Channel->NumberEdges; Index++)
+      {
+         Time = GetEdgeTime(Capture, Channel->Edges[Index]);
+         if(Time >= FirstTime)
+            break;
+
+         if(!LOGICDAT_GetLevel(Channel, Channel->Edges[Index]))
+         {
+            Trace.ResetStartTime = Time;
+            Trace.ResetEndTime   = ((Index + 1) < Channel->NumberEdges) ? GetEdgeTime(Capture, Channel->Edges[Index + 1]) : Trace.Duration;
+            Trace.TimesValid    |= TIME_VALID_RESET;
+         }
+      }
+   }
+
+   if((Trace.TimesValid & TIME_VALID_RESET) && (Options.CTSChannel < Capture->NumberChannels) && (Capture->Channels[Options.CTSChannel].Present))
+   {
+      Channel = &Capture->Channels[Options.CTSChannel];
+
+      for(Index = LOGICDAT_FindEdge(Channel, (Trace.ResetEndTime * Capture->SampleRate) / 1000000000ULL); Index < Channel->NumberEdges; Index++)
+      {
+         if(!LOGICDAT_GetLevel(Channel, Channel->Edges[Index]))
+         {
+            Trace.CTSLowTime  = GetEdgeTime(Capture, Channel->Edges[Index]);
+            Trace.TimesValid |= TIME_VALID_CTS;
+            break;
+         }
+      }
+   }
+}
+
+   /* The following function returns the opcode of the specified command*/
+   /* packet.                                                           */
+static unsigned int GetOpcode(Packet_t *Packet)
+{
+   return(Packet->Data[1] | (Packet->Data[2] << 8));
+}
+
+   /* The following function returns the Command Complete or Command    */
+   /* Status event of the specified command packet (NULL if there is    */
+   /* none).                                                            */
+static Packet_t *FindResponse(Packet_t *Command)
+{
+   unsigned int  Index;
+   Packet_t     *Packet;
+   Packet_t     *ret_val;
+
+   ret_val = NULL;
+
+   for(Index = Command->OtherBefore; (!ret_val) && (Index < Trace.NumberDirectionPackets[DIRECTION_CONTROLLER]); Index++)
+   {
+      Packet = Trace.DirectionPackets[DIRECTION_CONTROLLER][Index];
+
+      if((Packet->Data[0] == HCIH4_PACKET_TYPE_EVENT) && (Packet->StartTime >= Command->EndTime))
+      {
+         if(((Packet->Data[1] == HCI_EVENT_COMMAND_COMPLETE) && (Packet->Length >= 6) && ((Packet->Data[4] | (Packet->Data[5] << 8)) == GetOpcode(Command))) || ((Packet->Data[1] == HCI_EVENT_COMMAND_STATUS) && (Packet->Length >= 7) && ((Packet->Data[5] | (Packet->Data[6] << 8)) == GetOpcode(Command))))
+            ret_val = Packet;
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function lists the packets of the trace.            */
+static void DisplayPackets(void)
+{
+   unsigned int  Index;
+   unsigned int  Byte;
+   Packet_t     *Packet;
+
+   for(Index = 0; Index < Trace.NumberPackets; Index++)
+   {
+      Packet = &Trace.Packets[Index];
+
+      printf("%10.3f ms %s %4u:", ToMilliseconds(Packet->StartTime), DirectionNames[Packet->Direction], Packet->Length);
+
+      for(Byte = 0; (Byte < Packet->Length) && (Byte < LISTED_PACKET_BYTES); Byte++)
+         printf(" %02X", Packet->Data[Byte]);
+
+      printf("%s\n", (Packet->Length > LISTED_PACKET_BYTES) ? " ..." : "");
+   }
+}
+
+   /* The following function displays the timings of the start up that  */
+   /* is recorded in the trace.                                         */
+static void DisplayTimings(LOGICDAT_Capture_t *Capture)
+{
+   unsigned int        Index;
+   unsigned int        GapIndex;
+   unsigned int        NumberCommands;
+   unsigned int        NumberVendor;
+   unsigned int        GapOpcode[NUMBER_REPORTED_GAPS];
+   unsigned long long  GapTime[NUMBER_REPORTED_GAPS];
+   unsigned long long  GapStartTime[NUMBER_REPORTED_GAPS];
+   unsigned long long  FirstCommandTime;
+   unsigned long long  LastResponseTime;
+   unsigned long long  FirstVendorTime;
+   unsigned long long  LastVendorTime;
+   unsigned long long  PreviousResponseTime;
+   unsigned long long  WireTime;
+   unsigned long long  ControllerTime;
+   unsigned long long  HostTime;
+   unsigned long long  Gap;
+   Packet_t           *Packet;
+   Packet_t           *Response;
+   Packet_t           *LastPacket;
+
+   printf("Capture: %s, %lu samples/s, %.3f ms, %u channels\n", Options.FileName, Capture->SampleRate, ToMilliseconds(Trace.Duration), Capture->NumberChannels);
+
+   for(Index = 0; Index < NUMBER_DIRECTIONS; Index++)
+      printf("%s (channel %u): %lu bytes, %u packets, %lu framing errors, %lu bytes outside packets\n", (Index == DIRECTION_HOST) ? "Host to controller" : "Controller to host", Options.Channels[Index], Trace.Bytes[Index], Trace.NumberDirectionPackets[Index], Trace.FramingErrors[Index], Trace.UnknownBytes[Index]);
+
+   if(Trace.TimesValid & TIME_VALID_RESET)
+      printf("Reset: nShutdown (channel %u) low for %.3f ms, released at %.3f ms\n", Options.ShutdownChannel, ToMilliseconds(Trace.ResetEndTime - Trace.ResetStartTime), ToMilliseconds(Trace.ResetEndTime));
+   else
+      printf("Reset: not found on channel %u\n", Options.ShutdownChannel);
+
+   if(Trace.TimesValid & TIME_VALID_CTS)
+      printf("Controller boot: CTS (channel %u) low %.3f ms after the release\n", Options.CTSChannel, ToMilliseconds(Trace.CTSLowTime - Trace.ResetEndTime));
+   else
+      printf("Controller boot: CTS low not found on channel %u\n", Options.CTSChannel);
+
+   memset(GapTime, 0, sizeof(GapTime));
+
+   NumberCommands       = 0;
+   NumberVendor         = 0;
+   FirstCommandTime     = 0;
+   LastResponseTime     = 0;
+   FirstVendorTime      = 0;
+   LastVendorTime       = 0;
+   PreviousResponseTime = 0;
+   WireTime             = 0;
+   ControllerTime       = 0;
+   HostTime             = 0;
+
+   /* Each command is timed from its first byte to the end of the event */
+   /* that completes it.  The time from that event to the next command  */
+   /* is host time.                                                     */
+   for(Index = 0; Index < Trace.NumberDirectionPackets[DIRECTION_HOST]; Index++)
+   {
+      Packet = Trace.DirectionPackets[DIRECTION_HOST][Index];
+      if((Packet->Data[0] != HCIH4_PACKET_TYPE_COMMAND) || (Packet->Length < 4))
+         continue;
+
+      if(!NumberCommands++)
+      {
+         FirstCommandTime = Packet->StartTime;
+
+         if(Trace.TimesValid & TIME_VALID_CTS)
+            printf("Host start: first command %.3f ms after CTS low\n", ToMilliseconds(Packet->StartTime - Trace.CTSLowTime));
+      }
+      else
+      {
+         if(Packet->StartTime > PreviousResponseTime)
+         {
+            Gap       = Packet->StartTime - PreviousResponseTime;
+            HostTime += Gap;
+
+            /* Keep the longest gaps, longest first.                    */
+            for(GapIndex = NUMBER_REPORTED_GAPS; (GapIndex) && (Gap > GapTime[GapIndex - 1]); GapIndex--)
+            {
+               if(GapIndex < NUMBER_REPORTED_GAPS)
+               {
+                  GapTime[GapIndex]      = GapTime[GapIndex - 1];
+                  GapStartTime[GapIndex] = GapStartTime[GapIndex - 1];
+                  GapOpcode[GapIndex]    = GapOpcode[GapIndex - 1];
+               }
+            }
+
+            if(GapIndex < NUMBER_REPORTED_GAPS)
+            {
+               GapTime[GapIndex]      = Gap;
+               GapStartTime[GapIndex] = Packet->StartTime;
+               GapOpcode[GapIndex]    = GetOpcode(Packet);
+            }
+         }
+      }
+
+      WireTime += Packet->EndTime - Packet->StartTime;
+
+      if((Response = FindResponse(Packet)) != NULL)
+      {
+         WireTime             += Response->EndTime - Response->StartTime;
+         ControllerTime       += Response->StartTime - Packet->EndTime;
+         PreviousResponseTime  = Response->EndTime;
+      }
+      else
+         PreviousResponseTime  = Packet->EndTime;
+
+      LastResponseTime = PreviousResponseTime;
+
+      if((GetOpcode(Packet) >> 10) == HCI_OGF_VENDOR_SPECIFIC)
+      {
+         if(!NumberVendor++)
+            FirstVendorTime = Packet->StartTime;
+
+         LastVendorTime = PreviousResponseTime;
+      }
+   }
+
+   if(NumberCommands)
+   {
+      printf("Commands: %u in %.3f ms (%.3f to %.3f ms)\n", NumberCommands, ToMilliseconds(LastResponseTime - FirstCommandTime), ToMilliseconds(FirstCommandTime), ToMilliseconds(LastResponseTime));
+      printf("   wire %.3f ms, controller %.3f ms, host %.3f ms\n", ToMilliseconds(WireTime), ToMilliseconds(ControllerTime), ToMilliseconds(HostTime));
+
+      if(NumberVendor)
+         printf("   initialization script (vendor specific): %u in %.3f ms (%.3f to %.3f ms)\n", NumberVendor, ToMilliseconds(LastVendorTime - FirstVendorTime), ToMilliseconds(FirstVendorTime), ToMilliseconds(LastVendorTime));
+
+      for(GapIndex = 0; (GapIndex < NUMBER_REPORTED_GAPS) && (GapTime[GapIndex]); GapIndex++)
+         printf("   host gap %.3f ms before 0x%04X at %.3f ms\n", ToMilliseconds(GapTime[GapIndex]), GapOpcode[GapIndex], ToMilliseconds(GapStartTime[GapIndex]));
+   }
+   else
+      printf("Commands: none\n");
+
+   if(Trace.NumberPackets)
+   {
+      LastPacket = &Trace.Packets[Trace.NumberPackets - 1];
+      for(Index = 0; Index < Trace.NumberPackets; Index++)
+      {
+         if(Trace.Packets[Index].EndTime > LastPacket->EndTime)
+            LastPacket = &Trace.Packets[Index];
+      }
+
+      printf("Idle: %.3f ms from the last packet (%s 0x%02X at %.3f ms) to the end of the capture\n", ToMilliseconds((Trace.Duration > LastPacket->EndTime) ? (Trace.Duration - LastPacket->EndTime) : 0), DirectionNames[LastPacket->Direction], LastPacket->Data[0], ToMilliseconds(LastPacket->StartTime));
+   }
+}
+
+   /* The following function returns the time (in microseconds) at      */
+   /* which the specified packet is due during the replay.  The packet  */
+   /* is due the recorded delay (divided by the speed) after the later  */
+   /* of the last packet of the other direction that it waits for and   */
+   /* the previous packet of its own direction (written at the specified*/
+   /* time).                                                            */
+   /* * NOTE * This function must be called with the mutex held, once   */
+   /*          the packets that the packet waits for have arrived.      */
+static unsigned long long GetDueTime(Packet_t *Packet, unsigned long long PreviousWriteTime)
+{
+   unsigned long long ReferenceTime;
+   unsigned long long ret_val;
+   Packet_t          *Previous;
+   Packet_t          *Other;
+
+   Previous      = Packet->Index ? Trace.DirectionPackets[Packet->Direction][Packet->Index - 1] : NULL;
+   Other         = Packet->OtherBefore ? Trace.DirectionPackets[Packet->Direction ^ 1][Packet->OtherBefore - 1] : NULL;
+
+   ret_val       = Replay.StartTime;
+   ReferenceTime = 0;
+
+   if((Other) && ((!Previous) || (Other->EndTime >= Previous->StartTime)))
+   {
+      ret_val       = Replay.ArrivalTime[Other->Direction][Other->Index];
+      ReferenceTime = Other->EndTime;
+   }
+   else
+   {
+      if(Previous)
+      {
+         ret_val       = PreviousWriteTime;
+         ReferenceTime = Previous->StartTime;
+      }
+   }
+
+   if(((ReferenceTime) || (Previous) || (Other)) && (Packet->StartTime > ReferenceTime) && ((!Options.NoHostGaps) || (Packet->Direction != DIRECTION_HOST)))
+      ret_val += (unsigned long long)(((Packet->StartTime - ReferenceTime) / 1000) / Options.Speed);
+
+   return(ret_val);
+}
+
+   /* The following function waits until the specified packet is due to */
+   /* be written (see GetDueTime()).  The function returns zero if the  */
+   /* packet is due or a negative value if the replay has timed out or  */
+   /* was stopped.                                                      */
+static int WaitForPacket(Packet_t *Packet, unsigned long long PreviousWriteTime)
+{
+   int                ret_val;
+   unsigned long long Now;
+   unsigned long long WakeTime;
+   struct timespec    Timeout;
+
+   pthread_mutex_lock(&Replay.Mutex);
+
+   ret_val = 1;
+
+   while(ret_val > 0)
+   {
+      Now = GetMicroseconds();
+
+      if((!Running) || (Now >= Replay.Deadline))
+         ret_val = -1;
+      else
+      {
+         WakeTime = Replay.Deadline;
+
+         if(Replay.Arrived[Packet->Direction ^ 1] >= Packet->OtherBefore)
+         {
+            if((WakeTime = GetDueTime(Packet, PreviousWriteTime)) <= Now)
+               ret_val = 0;
+         }
+
+         if(ret_val > 0)
+         {
+            /* The condition variable uses the monotonic clock.         */
+            Timeout.tv_sec  = (time_t)(WakeTime / 1000000);
+            Timeout.tv_nsec = (long)((WakeTime % 1000000) * 1000);
+
+            pthread_cond_timedwait(&Replay.Condition, &Replay.Mutex, &Timeout);
+         }
+      }
+   }
+
+   pthread_mutex_unlock(&Replay.Mutex);
+
+   return(ret_val);
+}
+
+   /* The following function compares the specified bytes that arrived  */
+   /* from the specified direction with the packets of the capture and  */
+   /* notes the time at which each packet arrived.                      */
+   /* * NOTE * This function must be called with the mutex held.        */
+static void CheckBytes(unsigned int Direction, unsigned int Length, unsigned char *Data)
+{
+   Packet_t *Packet;
+
+   while(Length--)
+   {
+      if(Replay.CheckPacket[Direction] < Trace.NumberDirectionPackets[Direction])
+      {
+         Packet = Trace.DirectionPackets[Direction][Replay.CheckPacket[Direction]];
+
+         if((Replay.CheckOffset[Direction] >= Packet->Length) || (*Data != Packet->Data[Replay.CheckOffset[Direction]]))
+            Replay.Mismatches[Direction]++;
+
+         Replay.CheckOffset[Direction]++;
+      }
+      else
+         Replay.Mismatches[Direction]++;
+
+      if(SplitH4(&Replay.Splitter[Direction], *(Data++)) == SPLIT_COMPLETE)
+      {
+         if(Replay.Arrived[Direction] < Trace.NumberDirectionPackets[Direction])
+            Replay.ArrivalTime[Direction][Replay.Arrived[Direction]++] = GetMicroseconds();
+
+         Replay.CheckPacket[Direction]++;
+         Replay.CheckOffset[Direction] = 0;
+
+         pthread_cond_broadcast(&Replay.Condition);
+      }
+   }
+}
+
+   /* The following function is the data callback of the transport.     */
+static void BTPSAPI DataCallback(unsigned int HCITransportID, unsigned int DataLength, unsigned char *DataBuffer, unsigned long CallbackParameter)
+{
+   pthread_mutex_lock(&Replay.Mutex);
+
+   CheckBytes(DIRECTION_CONTROLLER, DataLength, DataBuffer);
+
+   pthread_mutex_unlock(&Replay.Mutex);
+}
+
+   /* The following function is the thread of the peer, which plays the */
+   /* controller packets of the capture on the slave side of the        */
+   /* pseudo-terminal and checks the host packets that arrive there.    */
+static void *PeerThread(void *Parameter)
+{
+   int                 Descriptor;
+   int                 Result;
+   unsigned int        Index;
+   unsigned int        Offset;
+   unsigned long long  WriteTime;
+   unsigned char       RxBuffer[4096];
+   struct pollfd       PollDescriptor;
+   struct termios      Settings;
+   Packet_t           *Packet;
+
+   if((Descriptor = open(SlaveName, O_RDWR | O_NOCTTY | O_NONBLOCK)) >= 0)
+   {
+      tcgetattr(Descriptor, &Settings);
+      cfmakeraw(&Settings);
+      tcsetattr(Descriptor, TCSANOW, &Settings);
+
+      Index     = 0;
+      Offset    = 0;
+      WriteTime = Replay.StartTime;
+
+      while(Running)
+      {
+         PollDescriptor.fd      = Descriptor;
+         PollDescriptor.events  = POLLIN;
+         PollDescriptor.revents = 0;
+
+         if(Offset)
+            PollDescriptor.events |= POLLOUT;
+
+         if((poll(&PollDescriptor, 1, 1) > 0) && (PollDescriptor.revents & POLLIN))
+         {
+            if((Result = read(Descriptor, RxBuffer, sizeof(RxBuffer))) > 0)
+            {
+               pthread_mutex_lock(&Replay.Mutex);
+
+               CheckBytes(DIRECTION_HOST, (unsigned int)Result, RxBuffer);
+
+               pthread_mutex_unlock(&Replay.Mutex);
+            }
+         }
+
+         if(Index < Trace.NumberDirectionPackets[DIRECTION_CONTROLLER])
+         {
+            Packet = Trace.DirectionPackets[DIRECTION_CONTROLLER][Index];
+
+            /* Check (without waiting) whether the next packet is due.  */
+            if(!Offset)
+            {
+               pthread_mutex_lock(&Replay.Mutex);
+
+               if((Replay.Arrived[DIRECTION_HOST] >= Packet->OtherBefore) && (GetDueTime(Packet, WriteTime) <= GetMicroseconds()))
+               {
+                  WriteTime = GetMicroseconds();
+                  Offset    = 0;
+
+                  if((Result = write(Descriptor, Packet->Data, Packet->Length)) > 0)
+                     Offset = (unsigned int)Result;
+                  else
+                     Offset = Packet->Length + 1;
+               }
+
+               pthread_mutex_unlock(&Replay.Mutex);
+            }
+            else
+            {
+               if((Offset <= Packet->Length) && ((Result = write(Descriptor, &Packet->Data[Offset], Packet->Length - Offset)) > 0))
+                  Offset += (unsigned int)Result;
+            }
+
+            if(Offset == Packet->Length)
+            {
+               Index++;
+               Offset = 0;
+            }
+            else
+            {
+               /* The write is retried once the pseudo-terminal has     */
+               /* room.                                                 */
+               if(Offset > Packet->Length)
+                  Offset = 0;
+            }
+         }
+      }
+
+      close(Descriptor);
+   }
+   else
+      fprintf(stderr, "Unable to open %s (%s)\n", SlaveName, strerror(errno));
+
+   return(NULL);
+}
+
+#ifndef HCITR_ENABLE_RX_TASK
+
+   /* The following function is the thread that plays the Bluetopia     */
+   /* scheduler, which calls HCITR_COMProcess() periodically, when the  */
+   /* transport has no receive task.                                    */
+static void *ProcessThread(void *Parameter)
+{
+   while(Running)
+   {
+      HCITR_COMProcess(TransportID);
+
+      BTPS_Delay(1);
+   }
+
+   return(NULL);
+}
+
+#endif
+
+   /* The following function replays the trace through the transport and*/
+   /* displays the results.  The function returns zero if every packet  */
+   /* arrived unchanged or a positive value otherwise.                  */
+static int RunReplay(void)
+{
+   int                               ret_val;
+   unsigned int                      Index;
+   unsigned int                      Direction;
+   unsigned long long                OpenStartTime;
+   unsigned long long                OpenTime;
+   unsigned long long                FirstWriteTime;
+   unsigned long long                WriteTime;
+   unsigned long long                RecordedStartTime;
+   pthread_t                         Peer;
+   pthread_condattr_t                Attributes;
+
+#ifndef HCITR_ENABLE_RX_TASK
+
+   pthread_t                         Process;
+
+#endif
+
+   Packet_t                         *Packet;
+   HCITRSIM_Configuration_t          SimConfiguration;
+   HCI_COMMDriverInformation_t       DriverInformation;
+
+   /* The wire and the boot of the controller are sped up with the rest */
+   /* of the replay.                                                    */
+   memset(&SimConfiguration, 0, sizeof(SimConfiguration));
+
+   SimConfiguration.BaudRatePercent = (unsigned int)(100 * Options.Speed);
+   if(!SimConfiguration.BaudRatePercent)
+      SimConfiguration.BaudRatePercent = 1;
+
+   if(Trace.TimesValid & TIME_VALID_CTS)
+      SimConfiguration.BootTime = (unsigned long)(((Trace.CTSLowTime - Trace.ResetEndTime) / 1000) / Options.Speed);
+
+   pthread_condattr_init(&Attributes);
+   pthread_condattr_setclock(&Attributes, CLOCK_MONOTONIC);
+
+   pthread_mutex_init(&Replay.Mutex, NULL);
+   pthread_cond_init(&Replay.Condition, &Attributes);
+
+   pthread_condattr_destroy(&Attributes);
+
+   for(Direction = 0, ret_val = 0; Direction < NUMBER_DIRECTIONS; Direction++)
+   {
+      if((Replay.ArrivalTime[Direction] = (unsigned long long *)calloc(Trace.NumberDirectionPackets[Direction] + 1, sizeof(unsigned long long))) == NULL)
+         ret_val = 1;
+   }
+
+   if((!ret_val) && (!HCITRSIM_Initialize(&SimConfiguration, SlaveName, sizeof(SlaveName))))
+   {
+      Running            = 1;
+      Replay.StartTime   = GetMicroseconds();
+      Replay.Deadline    = Replay.StartTime + (unsigned long long)(((Trace.Duration / 1000) * 2) / Options.Speed) + (REPLAY_TIMEOUT_MARGIN * 1000ULL);
+
+      memset(&DriverInformation, 0, sizeof(DriverInformation));
+
+      DriverInformation.DriverInformationSize = sizeof(DriverInformation);
+      DriverInformation.BaudRate              = Options.BaudRate;
+      DriverInformation.Protocol              = cpHCILL_RTS_CTS;
+
+      /* The peer starts with the transport, as the controller starts   */
+      /* with the release of nShutdown.                                 */
+      pthread_create(&Peer, NULL, PeerThread, NULL);
+
+      /* HCITR_COMOpen() starts with the reset of the controller, so    */
+      /* the times of the replay are reported from its start.           */
+      OpenStartTime = GetMicroseconds();
+
+      if((ret_val = HCITR_COMOpen(&DriverInformation, DataCallback, 0)) > 0)
+      {
+         TransportID = (unsigned int)ret_val;
+         OpenTime    = GetMicroseconds();
+
+#ifndef HCITR_ENABLE_RX_TASK
+
+         pthread_create(&Process, NULL, ProcessThread, NULL);
+
+#endif
+
+         /* The host packets are written from this thread, as Bluetopia */
+         /* writes them once HCITR_COMOpen() has returned.              */
+         pthread_mutex_lock(&Replay.Mutex);
+         Replay.StartTime = OpenTime;
+         pthread_mutex_unlock(&Replay.Mutex);
+
+         WriteTime      = OpenTime;
+         FirstWriteTime = 0;
+         ret_val        = 0;
+
+         for(Index = 0; (!ret_val) && (Index < Trace.NumberDirectionPackets[DIRECTION_HOST]); Index++)
+         {
+            Packet = Trace.DirectionPackets[DIRECTION_HOST][Index];
+
+            if(!WaitForPacket(Packet, WriteTime))
+            {
+               WriteTime = GetMicroseconds();
+               if(!FirstWriteTime)
+                  FirstWriteTime = WriteTime;
+
+               if(HCITR_COMWrite(TransportID, Packet->Length, Packet->Data))
+                  ret_val = 1;
+            }
+            else
+               ret_val = 1;
+         }
+
+         /* Wait for the rest of the packets of both directions.        */
+         pthread_mutex_lock(&Replay.Mutex);
+
+         while(((Replay.Arrived[DIRECTION_HOST] < Trace.NumberDirectionPackets[DIRECTION_HOST]) || (Replay.Arrived[DIRECTION_CONTROLLER] < Trace.NumberDirectionPackets[DIRECTION_CONTROLLER])) && (GetMicroseconds() < Replay.Deadline))
+         {
+            pthread_mutex_unlock(&Replay.Mutex);
+
+            BTPS_Delay(1);
+
+            pthread_mutex_lock(&Replay.Mutex);
+         }
+
+         Running = 0;
+
+         RecordedStartTime = (Trace.TimesValid & TIME_VALID_RESET) ? Trace.ResetStartTime : 0;
+
+         printf("Replay at %.2fx%s:\n", Options.Speed, Options.NoHostGaps ? " without host delays" : "");
+
+         if(Trace.TimesValid & TIME_VALID_CTS)
+            printf("   HCITR_COMOpen() %.3f ms, the controller needs %.3f ms (reset %.3f ms, boot %.3f ms)\n", (OpenTime - OpenStartTime) / 1000.0, ToMilliseconds((unsigned long long)((Trace.CTSLowTime - Trace.ResetStartTime) / Options.Speed)), ToMilliseconds((unsigned long long)((Trace.ResetEndTime - Trace.ResetStartTime) / Options.Speed)), ToMilliseconds((unsigned long long)((Trace.CTSLowTime - Trace.ResetEndTime) / Options.Speed)));
+
+         if((FirstWriteTime) && (Trace.NumberDirectionPackets[DIRECTION_HOST]))
+            printf("   first host packet %.3f ms after the reset (recorded %.3f ms)\n", (FirstWriteTime - OpenStartTime) / 1000.0, ToMilliseconds(Trace.DirectionPackets[DIRECTION_HOST][0]->StartTime - RecordedStartTime));
+
+         if((Replay.Arrived[DIRECTION_CONTROLLER]) && (Trace.NumberDirectionPackets[DIRECTION_CONTROLLER]))
+            printf("   last controller packet %.3f ms after the reset (recorded %.3f ms)\n", (Replay.ArrivalTime[DIRECTION_CONTROLLER][Replay.Arrived[DIRECTION_CONTROLLER] - 1] - OpenStartTime) / 1000.0, ToMilliseconds(Trace.DirectionPackets[DIRECTION_CONTROLLER][Trace.NumberDirectionPackets[DIRECTION_CONTROLLER] - 1]->EndTime - RecordedStartTime));
+
+         for(Direction = 0; Direction < NUMBER_DIRECTIONS; Direction++)
+         {
+            printf("   %s: %u of %u packets arrived, %lu bytes differ\n", DirectionNames[Direction], Replay.Arrived[Direction], Trace.NumberDirectionPackets[Direction], Replay.Mismatches[Direction]);
+
+            if((Replay.Arrived[Direction] != Trace.NumberDirectionPackets[Direction]) || (Replay.Mismatches[Direction]))
+               ret_val = 1;
+         }
+
+         pthread_mutex_unlock(&Replay.Mutex);
+
+         /* The threads may be blocked in the transport, which is left  */
+         /* open, so the process simply exits.                          */
+      }
+      else
+      {
+         fprintf(stderr, "HCITR_COMOpen() failed (%d)\n", ret_val);
+
+         Running = 0;
+         ret_val = 1;
+      }
+
+      fflush(stdout);
+
+      HCITRSIM_Shutdown();
+   }
+   else
+   {
+      fprintf(stderr, "Unable to create the pseudo-terminal\n");
+
+      ret_val = 1;
+   }
+
+   return(ret_val);
+}
+
+int main(int argc, char *argv[])
+{
+   int                ret_val;
+   LOGICDAT_Capture_t Capture;
+
+   if(!ParseOptions(argc, argv))
+   {
+      if(!LOGICDAT_Load(Options.FileName, &Capture))
+      {
+         if(!BuildTrace(&Capture))
+         {
+            FindResetTimes(&Capture);
+
+            if(Options.Verbose)
+               DisplayPackets();
+
+            DisplayTimings(&Capture);
+
+            fflush(stdout);
+
+            ret_val = Options.Replay ? RunReplay() : 0;
+         }
+         else
+         {
+            fprintf(stderr, "Unable to decode the UART channels %u and %u of %s\n", Options.Channels[DIRECTION_HOST], Options.Channels[DIRECTION_CONTROLLER], Options.FileName);
+
+            ret_val = 1;
+         }
+
+         LOGICDAT_Free(&Capture);
+      }
+      else
+      {
+         fprintf(stderr, "Unable to load %s\n", Options.FileName);
+
+         ret_val = 1;
+      }
+   }
+   else
+   {
+      Usage(argv[0]);
+
+      ret_val = 2;
+   }
+
+   _exit(ret_val);
+}
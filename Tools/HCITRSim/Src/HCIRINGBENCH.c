@@ -0,0 +1,482 @@
+/*****< hciringbench.c >*******************************************************/
+/*                                                                            */
+/*  HCIRINGBENCH - Check and benchmark of the HCI transport receive ring.     */
+/*                                                                            */
+/*  HCIRING is built from the firmware sources and fed with a numbered byte   */
+/*  stream, both the way the receive interrupt writes it (HCIRING_Produce())  */
+/*  and the way the circular receive DMA writes it (HCIRING_ProducerSync()).  */
+/*  The consumer checks that every byte it is given is the next one of the    */
+/*  stream, and after a forced overrun that it continues in order with the    */
+/*  oldest byte that is left.  The bookkeeping of each path is then timed.    */
+/*  The program exits with a non zero status if any check fails.              */
+/*                                                                            */
+/******************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "HCIRING.h"        /* HCI Transport Ring Prototypes/Constants.       */
+
+   /* The following constants represent the defaults of the options.    */
+#define DEFAULT_BYTES            (1UL << 22)
+#define DEFAULT_SEED             1
+
+   /* The following constants represent the size of the ring (that of   */
+   /* the firmware receive buffer) and the largest number of bytes that */
+   /* are written or read at a time.                                    */
+#define RING_SIZE                1024
+#define MAXIMUM_CHUNK            (RING_SIZE / 2)
+
+   /* The following constants represent the spans that the consumer     */
+   /* reads at most at a time when the throughput is timed.             */
+#define NUMBER_TIMED_SPANS       4
+
+   /* The following structure holds the options of the benchmark.       */
+typedef struct _tagOptions_t
+{
+   unsigned long Bytes;
+   unsigned long Seed;
+} Options_t;
+
+   /* The following structure holds the state of a test stream: the     */
+   /* number of bytes that have been written to the ring and the number */
+   /* of the next byte that the consumer expects.                       */
+typedef struct _tagStream_t
+{
+   unsigned long Written;
+   unsigned long Expected;
+   unsigned long Errors;
+} Stream_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+static Options_t      Options;
+static unsigned long  RandomState;
+static unsigned char  RingBuffer[RING_SIZE];
+static unsigned char  Sink[RING_SIZE];
+
+static const unsigned int TimedSpans[NUMBER_TIMED_SPANS] = { 1, 16, 128, RING_SIZE };
+
+   /* Local Function Prototypes.                                        */
+static void Usage(char *Name);
+static int ParseOptions(int argc, char *argv[]);
+static unsigned long long GetNanoseconds(void);
+static unsigned long Random(void);
+static unsigned char StreamByte(unsigned long Number);
+static void WriteStream(Stream_t *Stream, unsigned int Length);
+static void ConsumeStream(HCIRING_Ring_t *Ring, Stream_t *Stream, unsigned int Maximum);
+static int CheckProduce(void);
+static int CheckProducerSync(void);
+static int CheckOverrun(void);
+static void TimeProduce(void);
+static void TimeProducerSync(unsigned int Span);
+
+   /* The following function displays the usage of the program.         */
+static void Usage(char *Name)
+{
+   fprintf(stderr, "Usage: %s [options]\n", Name);
+   fprintf(stderr, "   -n Bytes           Bytes of each check and timing (default %lu).\n", DEFAULT_BYTES);
+   fprintf(stderr, "   -s Seed            Seed of the random chunk lengths (default %u).\n", DEFAULT_SEED);
+}
+
+   /* The following function parses the options of the program.  This   */
+   /* function returns zero if successful or a negative value if there  */
+   /* was an error.                                                     */
+static int ParseOptions(int argc, char *argv[])
+{
+   int ret_val;
+   int Option;
+
+   ret_val       = 0;
+
+   Options.Bytes = DEFAULT_BYTES;
+   Options.Seed  = DEFAULT_SEED;
+
+   while((!ret_val) && ((Option = getopt(argc, argv, "n:s:h")) != -1))
+   {
+      switch(Option)
+      {
+         case 'n':
+            Options.Bytes = strtoul(optarg, NULL, 0);
+            if(Options.Bytes < RING_SIZE)
+               ret_val = -1;
+            break;
+         case 's':
+            Options.Seed = strtoul(optarg, NULL, 0);
+            break;
+         default:
+            ret_val = -1;
+            break;
+      }
+   }
+
+   if(ret_val)
+      Usage(argv[0]);
+
+   return(ret_val);
+}
+
+   /* The following function returns the current monotonic time in       */
+   /* nanoseconds.                                                      */
+static unsigned long long GetNanoseconds(void)
+{
+   struct timespec Now;
+
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+
+   return(((unsigned long long)Now.tv_sec * 1000000000ULL) + Now.tv_nsec);
+}
+
+   /* The following function returns the next pseudo random number (31   */
+   /* bits), so that every run with the same seed is the same.          */
+static unsigned long Random(void)
+{
+   RandomState = (RandomState * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+
+   return(RandomState >> 1);
+}
+
+   /* The following function returns the value of the specified byte of */
+   /* the test stream.  Bytes that are 256 apart differ, so a byte that */
+   /* is delivered out of order is found.                               */
+static unsigned char StreamByte(unsigned long Number)
+{
+   return((unsigned char)(Number ^ (Number >> 8) ^ (Number >> 16)));
+}
+
+   /* The following function writes the next specified number of bytes  */
+   /* of the test stream to the ring buffer at the write position, the  */
+   /* way the hardware does (wrapping, whether or not there is room).   */
+static void WriteStream(Stream_t *Stream, unsigned int Length)
+{
+   while(Length--)
+   {
+      RingBuffer[Stream->Written % RING_SIZE] = StreamByte(Stream->Written);
+
+      Stream->Written++;
+   }
+}
+
+   /* The following function reads at most the specified number of bytes */
+   /* from the ring, a span at a time, and checks that each one is the  */
+   /* next byte of the test stream.                                     */
+static void ConsumeStream(HCIRING_Ring_t *Ring, Stream_t *Stream, unsigned int Maximum)
+{
+   unsigned int   Length;
+   unsigned int   Index;
+   unsigned char *Data;
+
+   while((Maximum) && ((Length = HCIRING_GetSpan(Ring, &Data)) != 0))
+   {
+      if(Length > Maximum)
+         Length = Maximum;
+
+      for(Index = 0; Index < Length; Index++, Stream->Expected++)
+      {
+         if(Data[Index] != StreamByte(Stream->Expected))
+            Stream->Errors++;
+      }
+
+      HCIRING_Consume(Ring, Length);
+
+      Maximum -= Length;
+   }
+}
+
+   /* The following function checks the interrupt path: the stream is    */
+   /* written in random chunks that are only accepted while there is    */
+   /* room, and read in random chunks.  This function returns zero if   */
+   /* the check passed or a negative value if it failed.                */
+static int CheckProduce(void)
+{
+   int            ret_val;
+   unsigned int   Length;
+   unsigned int   Accepted;
+   unsigned long  Rejected;
+   Stream_t       Stream;
+   HCIRING_Ring_t Ring;
+
+   memset(&Stream, 0, sizeof(Stream));
+
+   HCIRING_Initialize(&Ring, RingBuffer, RING_SIZE);
+
+   Rejected = 0;
+
+   while(Stream.Written < Options.Bytes)
+   {
+      Length   = 1 + (Random() % MAXIMUM_CHUNK);
+      Accepted = (Length < Ring.BytesFree) ? Length : Ring.BytesFree;
+
+      /* Only what is accepted is written, as the receive interrupt     */
+      /* drops a character that does not fit.                           */
+      WriteStream(&Stream, Accepted);
+
+      if(HCIRING_Produce(&Ring, Length) != Accepted)
+         Stream.Errors++;
+
+      Rejected += (Length - Accepted);
+
+      ConsumeStream(&Ring, &Stream, 1 + (Random() % MAXIMUM_CHUNK));
+   }
+
+   ConsumeStream(&Ring, &Stream, RING_SIZE);
+
+   ret_val = ((Stream.Errors) || (Stream.Expected != Stream.Written) || (Ring.BytesFree != RING_SIZE) || ((Rejected != 0) != (Ring.OverrunCount != 0))) ? -1 : 0;
+
+   printf("HCIRING produce: %lu bytes, %lu rejected, %lu overruns, %lu errors%s\n", Stream.Written, Rejected, Ring.OverrunCount, Stream.Errors, (ret_val) ? " FAILED" : "");
+
+   return(ret_val);
+}
+
+   /* The following function checks the circular DMA path without        */
+   /* overruns: the stream is written in random chunks that fit in the  */
+   /* room that is left, the producer is synchronized to the write      */
+   /* position (which may be the size of the ring, as the counter of the*/
+   /* DMA reloads) and the stream is read in random chunks.  This       */
+   /* function returns zero if the check passed or a negative value if  */
+   /* it failed.                                                        */
+static int CheckProducerSync(void)
+{
+   int            ret_val;
+   unsigned int   Length;
+   unsigned int   Position;
+   Stream_t       Stream;
+   HCIRING_Ring_t Ring;
+
+   memset(&Stream, 0, sizeof(Stream));
+
+   HCIRING_Initialize(&Ring, RingBuffer, RING_SIZE);
+
+   while(Stream.Written < Options.Bytes)
+   {
+      Length = Random() % (Ring.BytesFree + 1);
+
+      WriteStream(&Stream, Length);
+
+      Position = Stream.Written % RING_SIZE;
+      if((!Position) && (Length))
+         Position = RING_SIZE;
+
+      if(HCIRING_ProducerSync(&Ring, Position) != Length)
+         Stream.Errors++;
+
+      ConsumeStream(&Ring, &Stream, 1 + (Random() % MAXIMUM_CHUNK));
+   }
+
+   ConsumeStream(&Ring, &Stream, RING_SIZE);
+
+   ret_val = ((Stream.Errors) || (Stream.Expected != Stream.Written) || (Ring.BytesFree != RING_SIZE) || (Ring.OverrunCount)) ? -1 : 0;
+
+   printf("HCIRING producer sync: %lu bytes, %lu overruns, %lu errors%s\n", Stream.Written, Ring.OverrunCount, Stream.Errors, (ret_val) ? " FAILED" : "");
+
+   return(ret_val);
+}
+
+   /* The following function checks the overruns of the circular DMA    */
+   /* path.  The stream is written until the DMA has overwritten data   */
+   /* that was not read (both from an idle consumer and between         */
+   /* HCIRING_GetSpan() and HCIRING_Consume() of a busy one), and after */
+   /* each overrun the consumer must continue in order with the oldest  */
+   /* byte that is left, the one RING_SIZE before the write position.   */
+   /* This function returns zero if the check passed or a negative value*/
+   /* if it failed.                                                     */
+static int CheckOverrun(void)
+{
+   int             ret_val;
+   unsigned int    Length;
+   unsigned int    Span;
+   unsigned int    Position;
+   unsigned long   Overruns;
+   unsigned long   Dropped;
+   unsigned char  *Data;
+   Stream_t        Stream;
+   HCIRING_Ring_t  Ring;
+
+   memset(&Stream, 0, sizeof(Stream));
+
+   HCIRING_Initialize(&Ring, RingBuffer, RING_SIZE);
+
+   Overruns = 0;
+   Dropped  = 0;
+
+   while(Stream.Written < Options.Bytes)
+   {
+      /* Some data is left unread (at least half of the ring), then the */
+      /* DMA writes past it, but by less than the size of the ring that */
+      /* the producer must be synchronized within.                      */
+      ConsumeStream(&Ring, &Stream, Random() % RING_SIZE);
+
+      if(Ring.BytesFree > (RING_SIZE / 2))
+      {
+         Length = Ring.BytesFree - (RING_SIZE / 2);
+
+         WriteStream(&Stream, Length);
+
+         HCIRING_ProducerSync(&Ring, (Stream.Written % RING_SIZE) ? (Stream.Written % RING_SIZE) : RING_SIZE);
+      }
+
+      Length = Ring.BytesFree + 1 + (Random() % (RING_SIZE - 1 - Ring.BytesFree));
+
+      /* Every other overrun happens while a span is being processed.   */
+      Span = (Overruns & 1) ? HCIRING_GetSpan(&Ring, &Data) : 0;
+
+      WriteStream(&Stream, Length);
+
+      Position = Stream.Written % RING_SIZE;
+      if(!Position)
+         Position = RING_SIZE;
+
+      HCIRING_ProducerSync(&Ring, Position);
+
+      Overruns++;
+
+      if((Ring.OverrunCount != Overruns) || (Ring.BytesFree) || (Ring.OutIndex != Ring.InIndex))
+         Stream.Errors++;
+
+      /* The oldest byte that is left is the one the DMA writes next.   */
+      Dropped        += (Stream.Written - RING_SIZE) - Stream.Expected;
+      Stream.Expected = Stream.Written - RING_SIZE;
+
+      /* The span that was in progress is consumed, which drops that    */
+      /* many of the oldest bytes.                                      */
+      if(Span)
+      {
+         HCIRING_Consume(&Ring, Span);
+
+         Dropped         += Span;
+         Stream.Expected += Span;
+      }
+   }
+
+   ConsumeStream(&Ring, &Stream, RING_SIZE);
+
+   ret_val = ((Stream.Errors) || (Stream.Expected != Stream.Written) || (Ring.BytesFree != RING_SIZE) || (!Overruns)) ? -1 : 0;
+
+   printf("HCIRING overrun: %lu bytes, %lu overruns, %lu dropped, %lu errors%s\n", Stream.Written, Ring.OverrunCount, Dropped, Stream.Errors, (ret_val) ? " FAILED" : "");
+
+   return(ret_val);
+}
+
+   /* The following function times the interrupt path, one byte at a    */
+   /* time as the receive interrupt produces them, with the consumer    */
+   /* reading whatever is waiting every 64 bytes.                       */
+static void TimeProduce(void)
+{
+   unsigned int        Length;
+   unsigned long       Index;
+   unsigned char      *Data;
+   unsigned long long  StartTime;
+   unsigned long long  ElapsedTime;
+   HCIRING_Ring_t      Ring;
+
+   HCIRING_Initialize(&Ring, RingBuffer, RING_SIZE);
+
+   StartTime = GetNanoseconds();
+
+   for(Index = 0; Index < Options.Bytes; Index++)
+   {
+      RingBuffer[Ring.InIndex] = (unsigned char)Index;
+
+      HCIRING_Produce(&Ring, 1);
+
+      if(!(Index & 63))
+      {
+         while((Length = HCIRING_GetSpan(&Ring, &Data)) != 0)
+         {
+            memcpy(Sink, Data, Length);
+
+            HCIRING_Consume(&Ring, Length);
+         }
+      }
+   }
+
+   ElapsedTime = GetNanoseconds() - StartTime;
+
+   printf("HCIRING produce timing: %lu bytes, %.2f ns per byte, %.1f MB/s\n", Options.Bytes, (double)ElapsedTime / Options.Bytes, (Options.Bytes * 1000.0) / ElapsedTime);
+}
+
+   /* The following function times the circular DMA path, half a ring   */
+   /* at a time as the half and full transfer events synchronize the    */
+   /* producer, with the consumer reading at most the specified number  */
+   /* of bytes at a time (the length of the packets it is given).       */
+static void TimeProducerSync(unsigned int Span)
+{
+   unsigned int        Length;
+   unsigned int        Position;
+   unsigned long       Bytes;
+   unsigned long       Calls;
+   unsigned char      *Data;
+   unsigned long long  StartTime;
+   unsigned long long  ElapsedTime;
+   HCIRING_Ring_t      Ring;
+
+   HCIRING_Initialize(&Ring, RingBuffer, RING_SIZE);
+
+   Position  = 0;
+   Calls     = 0;
+
+   StartTime = GetNanoseconds();
+
+   for(Bytes = 0; Bytes < Options.Bytes; Bytes += (RING_SIZE / 2))
+   {
+      Position += (RING_SIZE / 2);
+
+      HCIRING_ProducerSync(&Ring, Position);
+
+      if(Position == RING_SIZE)
+         Position = 0;
+
+      while((Length = HCIRING_GetSpan(&Ring, &Data)) != 0)
+      {
+         if(Length > Span)
+            Length = Span;
+
+         memcpy(Sink, Data, Length);
+
+         HCIRING_Consume(&Ring, Length);
+
+         Calls++;
+      }
+   }
+
+   ElapsedTime = GetNanoseconds() - StartTime;
+
+   printf("HCIRING producer sync timing: %lu bytes in spans of %4u, %lu spans, %.2f ns per byte, %.1f MB/s\n", Bytes, Span, Calls, (double)ElapsedTime / Bytes, (Bytes * 1000.0) / ElapsedTime);
+}
+
+int main(int argc, char *argv[])
+{
+   int          ret_val;
+   unsigned int Index;
+
+   if(!ParseOptions(argc, argv))
+   {
+      RandomState = Options.Seed;
+
+      ret_val     = 0;
+
+      if(CheckProduce())
+         ret_val = 1;
+
+      if(CheckProducerSync())
+         ret_val = 1;
+
+      if(CheckOverrun())
+         ret_val = 1;
+
+      TimeProduce();
+
+      for(Index = 0; Index < NUMBER_TIMED_SPANS; Index++)
+         TimeProducerSync(TimedSpans[Index]);
+   }
+   else
+      ret_val = 2;
+
+   return(ret_val);
+}
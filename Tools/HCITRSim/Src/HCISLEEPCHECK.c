@@ -0,0 +1,204 @@
+/*****< hcisleepcheck.c >******************************************************/
+/*                                                                            */
+/*  HCISLEEPCHECK - Check of the HCILL suspend/wake sequencing.               */
+/*                                                                            */
+/*  HCISLEEP is built from the firmware sources and driven through each       */
+/*  suspend and wake sequence of the transport: a suspend that completes, a   */
+/*  suspend that is aborted by received data, by the controller (CTS) or by   */
+/*  the host, and a wake of the suspended link by either side.  Every event   */
+/*  must return exactly the expected actions and leave the expected state,    */
+/*  and each sequence must end with the expected counts.  The program exits   */
+/*  with a non zero status if any check fails.                                */
+/*                                                                            */
+/******************************************************************************/
+
+#include <stdio.h>
+
+#include "HCISLEEP.h"       /* HCI Transport Sleep Prototypes/Constants.      */
+
+   /* The following constant represents the largest number of events of */
+   /* a sequence.                                                       */
+#define MAXIMUM_STEPS            8
+
+   /* The following constants represent the actions that the transport  */
+   /* performs at each stage of a suspend.                              */
+#define ACTIONS_SUSPEND_REQUEST  (HCISLEEP_ACTION_HOLD_FLOW)
+#define ACTIONS_SUSPEND_COMPLETE (HCISLEEP_ACTION_STOP_UART | HCISLEEP_ACTION_SUSPENDED)
+#define ACTIONS_SUSPENDED        (HCISLEEP_ACTION_SUSPENDED)
+#define ACTIONS_SUSPEND_ABORT    (HCISLEEP_ACTION_RELEASE_FLOW)
+#define ACTIONS_SUSPEND_ABORTED  (HCISLEEP_ACTION_ABORTED)
+#define ACTIONS_WAKE             (HCISLEEP_ACTION_START_UART | HCISLEEP_ACTION_RELEASE_FLOW)
+
+   /* The following structure holds a single event of a sequence, the    */
+   /* actions that it must return and the state that it must leave.     */
+typedef struct _tagStep_t
+{
+   HCISLEEP_Event_t Event;
+   unsigned int     Actions;
+   HCISLEEP_State_t State;
+} Step_t;
+
+   /* The following structure holds a sequence of events, starting from */
+   /* the awake state, and the counts that it must end with.            */
+typedef struct _tagSequence_t
+{
+   char          *Name;
+   unsigned int   NumberSteps;
+   Step_t         Steps[MAXIMUM_STEPS];
+   unsigned long  SuspendCount;
+   unsigned long  AbortCount;
+   unsigned long  ControllerWakeCount;
+   unsigned long  HostWakeCount;
+} Sequence_t;
+
+   /* The following table holds the sequences that are checked.  Events */
+   /* that do not apply to a state (i.e. received data while awake or   */
+   /* suspended) are mixed in, and must return no actions.              */
+static const Sequence_t Sequences[] =
+{
+   { "awake", 5,
+      {
+         { hseReceiveActivity, 0,                        hslAwake          },
+         { hseWaitComplete,    0,                        hslAwake          },
+         { hseControllerWake,  0,                        hslAwake          },
+         { hseHostWake,        0,                        hslAwake          },
+         { hseReceiveActivity, 0,                        hslAwake          }
+      }, 0, 0, 0, 0
+   },
+   { "suspend and CTS wake", 6,
+      {
+         { hseSuspendRequest,  ACTIONS_SUSPEND_REQUEST,  hslSuspendWait    },
+         { hseSuspendRequest,  0,                        hslSuspendWait    },
+         { hseWaitComplete,    ACTIONS_SUSPEND_COMPLETE, hslSuspended      },
+         { hseReceiveActivity, 0,                        hslSuspended      },
+         { hseControllerWake,  ACTIONS_WAKE,             hslAwake          },
+         { hseControllerWake,  0,                        hslAwake          }
+      }, 1, 0, 1, 0
+   },
+   { "suspend and host wake", 5,
+      {
+         { hseSuspendRequest,  ACTIONS_SUSPEND_REQUEST,  hslSuspendWait    },
+         { hseWaitComplete,    ACTIONS_SUSPEND_COMPLETE, hslSuspended      },
+         { hseSuspendRequest,  0,                        hslSuspended      },
+         { hseWaitComplete,    ACTIONS_SUSPENDED,        hslSuspended      },
+         { hseHostWake,        ACTIONS_WAKE,             hslAwake          }
+      }, 1, 0, 0, 1
+   },
+   { "suspend aborted by RX", 5,
+      {
+         { hseSuspendRequest,  ACTIONS_SUSPEND_REQUEST,  hslSuspendWait    },
+         { hseReceiveActivity, ACTIONS_SUSPEND_ABORT,    hslSuspendAborted },
+         { hseReceiveActivity, 0,                        hslSuspendAborted },
+         { hseWaitComplete,    ACTIONS_SUSPEND_ABORTED,  hslAwake          },
+         { hseWaitComplete,    0,                        hslAwake          }
+      }, 0, 1, 0, 0
+   },
+   { "suspend aborted by CTS", 4,
+      {
+         { hseSuspendRequest,  ACTIONS_SUSPEND_REQUEST,  hslSuspendWait    },
+         { hseControllerWake,  ACTIONS_SUSPEND_ABORT,    hslSuspendAborted },
+         { hseHostWake,        0,                        hslSuspendAborted },
+         { hseWaitComplete,    ACTIONS_SUSPEND_ABORTED,  hslAwake          }
+      }, 0, 1, 0, 0
+   },
+   { "suspend aborted by host", 4,
+      {
+         { hseSuspendRequest,  ACTIONS_SUSPEND_REQUEST,  hslSuspendWait    },
+         { hseHostWake,        ACTIONS_SUSPEND_ABORT,    hslSuspendAborted },
+         { hseControllerWake,  0,                        hslSuspendAborted },
+         { hseWaitComplete,    ACTIONS_SUSPEND_ABORTED,  hslAwake          }
+      }, 0, 1, 0, 0
+   },
+   { "abort then suspend", 8,
+      {
+         { hseSuspendRequest,  ACTIONS_SUSPEND_REQUEST,  hslSuspendWait    },
+         { hseReceiveActivity, ACTIONS_SUSPEND_ABORT,    hslSuspendAborted },
+         { hseWaitComplete,    ACTIONS_SUSPEND_ABORTED,  hslAwake          },
+         { hseSuspendRequest,  ACTIONS_SUSPEND_REQUEST,  hslSuspendWait    },
+         { hseWaitComplete,    ACTIONS_SUSPEND_COMPLETE, hslSuspended      },
+         { hseHostWake,        ACTIONS_WAKE,             hslAwake          },
+         { hseSuspendRequest,  ACTIONS_SUSPEND_REQUEST,  hslSuspendWait    },
+         { hseWaitComplete,    ACTIONS_SUSPEND_COMPLETE, hslSuspended      }
+      }, 2, 1, 0, 1
+   }
+};
+
+#define NUMBER_SEQUENCES         (sizeof(Sequences) / sizeof(Sequences[0]))
+
+   /* Local Function Prototypes.                                        */
+static int CheckActionOrder(void);
+static int CheckSequence(const Sequence_t *Sequence);
+
+   /* The following function checks that the actions are defined in the */
+   /* order that the transport performs them (lowest bit first), so that*/
+   /* the UART is started before RTS is released on a wake and RTS is   */
+   /* raised before the UART is stopped on a suspend.  This function    */
+   /* returns zero if the check passed or a negative value if it failed.*/
+static int CheckActionOrder(void)
+{
+   int ret_val;
+
+   ret_val = ((HCISLEEP_ACTION_START_UART < HCISLEEP_ACTION_HOLD_FLOW) && (HCISLEEP_ACTION_HOLD_FLOW < HCISLEEP_ACTION_RELEASE_FLOW) && (HCISLEEP_ACTION_RELEASE_FLOW < HCISLEEP_ACTION_STOP_UART) && (HCISLEEP_ACTION_STOP_UART < HCISLEEP_ACTION_SUSPENDED) && (HCISLEEP_ACTION_SUSPENDED < HCISLEEP_ACTION_ABORTED)) ? 0 : -1;
+
+   printf("HCISLEEP action order%s\n", (ret_val) ? " FAILED" : "");
+
+   return(ret_val);
+}
+
+   /* The following function passes the events of the specified sequence */
+   /* to a new state machine and checks the actions and state of each   */
+   /* and the counts at the end.  This function returns zero if the     */
+   /* check passed or a negative value if it failed.                    */
+static int CheckSequence(const Sequence_t *Sequence)
+{
+   int                 ret_val;
+   unsigned int        Index;
+   unsigned int        Actions;
+   HCISLEEP_Machine_t  Machine;
+
+   ret_val = 0;
+
+   HCISLEEP_Initialize(&Machine);
+
+   for(Index = 0; Index < Sequence->NumberSteps; Index++)
+   {
+      Actions = HCISLEEP_Event(&Machine, Sequence->Steps[Index].Event);
+
+      if((Actions != Sequence->Steps[Index].Actions) || (Machine.State != Sequence->Steps[Index].State))
+      {
+         printf("   Event %u (%u): actions 0x%04X state %u, expected actions 0x%04X state %u\n", Index, (unsigned int)Sequence->Steps[Index].Event, Actions, (unsigned int)Machine.State, Sequence->Steps[Index].Actions, (unsigned int)Sequence->Steps[Index].State);
+
+         ret_val = -1;
+      }
+   }
+
+   if((Machine.SuspendCount != Sequence->SuspendCount) || (Machine.AbortCount != Sequence->AbortCount) || (Machine.ControllerWakeCount != Sequence->ControllerWakeCount) || (Machine.HostWakeCount != Sequence->HostWakeCount))
+   {
+      printf("   Counts: suspend %lu abort %lu CTS wake %lu host wake %lu\n", Machine.SuspendCount, Machine.AbortCount, Machine.ControllerWakeCount, Machine.HostWakeCount);
+
+      ret_val = -1;
+   }
+
+   printf("HCISLEEP %s: %u events%s\n", Sequence->Name, Sequence->NumberSteps, (ret_val) ? " FAILED" : "");
+
+   return(ret_val);
+}
+
+int main(int argc, char *argv[])
+{
+   int          ret_val;
+   unsigned int Index;
+
+   ret_val = 0;
+
+   if(CheckActionOrder())
+      ret_val = 1;
+
+   for(Index = 0; Index < NUMBER_SEQUENCES; Index++)
+   {
+      if(CheckSequence(&Sequences[Index]))
+         ret_val = 1;
+   }
+
+   return(ret_val);
+}
@@ -0,0 +1,662 @@
+/*****< hcitrbench.c >*********************************************************/
+/*                                                                            */
+/*  HCITRBENCH - Throughput benchmark of the HCI transport on the host.       */
+/*                                                                            */
+/*  HCITRANS is run against the simulated UART (see HCITRSIM.h).  By default  */
+/*  a loop back peer on the other side of the pseudo-terminal plays the       */
+/*  controller: it streams numbered ACL packets to the transport and checks   */
+/*  the numbered ACL packets that the transport sends.  With -e the name of   */
+/*  the pseudo-terminal is printed and the benchmark waits for an external    */
+/*  program to play the controller instead.                                   */
+/*                                                                            */
+/******************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "BTPSKRNL.h"       /* Bluetooth Kernel Prototypes/Constants.         */
+#include "HCITRCFG.h"       /* HCI Transport configuration.                   */
+#include "HCITRANS.h"       /* HCI Transport Prototypes/Constants.            */
+
+   /* The following constants represent the defaults of the options.    */
+#define DEFAULT_BAUD_RATE        3000000
+#define DEFAULT_DURATION         5
+#define DEFAULT_PACKET_LENGTH    256
+
+   /* The following constants represent the largest payload of a test   */
+   /* packet and the length of the H4 and ACL headers in front of it.   */
+#define MAXIMUM_PACKET_LENGTH    1021
+#define PACKET_HEADER_LENGTH     5
+
+   /* The following constants represent the test ACL connection handle  */
+   /* (with the first automatically flushable packet boundary flag) and */
+   /* the H4 packet indicator of ACL data.                              */
+#define TEST_ACL_HANDLE          0x2001
+#define H4_ACL_PACKET            0x02
+
+   /* The following constants represent the directions that are tested. */
+#define DIRECTION_RX             0x01
+#define DIRECTION_TX             0x02
+
+   /* The following constants represent the state of a packet checker.  */
+#define CHECK_STATE_INDICATOR    0
+#define CHECK_STATE_HEADER       1
+#define CHECK_STATE_PAYLOAD      2
+
+   /* The following structure holds the state of a checker of a stream  */
+   /* of test packets.  The checker is fed any number of bytes at a     */
+   /* time.  Each payload starts with a 16 bit sequence number (little  */
+   /* endian) and byte N of the payload is (Sequence + N) & 0xFF.  After*/
+   /* an error the checker looks for the next packet indicator.  Errors */
+   /* are only counted once the first packet has been found, as the     */
+   /* stream may have been joined in the middle of a packet.            */
+typedef struct _tagChecker_t
+{
+   unsigned int       State;
+   unsigned char      Header[PACKET_HEADER_LENGTH - 1];
+   unsigned int       Index;
+   unsigned int       Length;
+   unsigned int       Sequence;
+   int                SequenceValid;
+   unsigned int       ExpectedSequence;
+   unsigned long      Packets;
+   unsigned long      Errors;
+   unsigned long      LostPackets;
+   unsigned long long Bytes;
+} Checker_t;
+
+   /* The following structure holds the options of the benchmark.       */
+typedef struct _tagOptions_t
+{
+   unsigned long  BaudRate;
+   unsigned int   Duration;
+   unsigned int   PacketLength;
+   unsigned int   Directions;
+   int            External;
+   HCITRSIM_Configuration_t SimConfiguration;
+} Options_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+static Options_t            Options;
+static char                 SlaveName[128];
+static volatile int         Running;
+static unsigned int         TransportID;
+
+static Checker_t            HostChecker;
+static Checker_t            PeerChecker;
+static pthread_mutex_t      HostCheckerMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t      PeerCheckerMutex = PTHREAD_MUTEX_INITIALIZER;
+
+   /* The transport does not export its process function, it is called  */
+   /* by the Bluetopia scheduler on the target.                         */
+void BTPSAPI HCITR_COMProcess(unsigned int HCITransportID);
+
+   /* Local Function Prototypes.                                        */
+static void Usage(char *Name);
+static int ParseOptions(int argc, char *argv[]);
+static unsigned long long GetMicroseconds(void);
+static unsigned int BuildPacket(unsigned char *Buffer, unsigned int Length, unsigned int Sequence);
+static void CheckBytes(Checker_t *Checker, unsigned int Length, unsigned char *Data);
+static void BTPSAPI DataCallback(unsigned int HCITransportID, unsigned int DataLength, unsigned char *DataBuffer, unsigned long CallbackParameter);
+static void *PeerThread(void *Parameter);
+static void *WriterThread(void *Parameter);
+
+#ifndef HCITR_ENABLE_RX_TASK
+
+static void *ProcessThread(void *Parameter);
+
+#endif
+
+static void DisplayModes(void);
+static void DisplayResults(unsigned long long ElapsedTime, HCITR_Statistics_t *Statistics, HCITRSIM_Statistics_t *SimStatistics);
+
+   /* The following function displays the usage of the program.         */
+static void Usage(char *Name)
+{
+   fprintf(stderr, "Usage: %s [options]\n", Name);
+   fprintf(stderr, "   -b BaudRate        Baud rate to reconfigure to (default %u).\n", DEFAULT_BAUD_RATE);
+   fprintf(stderr, "   -t Seconds         Duration of the test (default %u).\n", DEFAULT_DURATION);
+   fprintf(stderr, "   -l Length          ACL payload length (default %u, maximum %u).\n", DEFAULT_PACKET_LENGTH, MAXIMUM_PACKET_LENGTH);
+   fprintf(stderr, "   -d rx|tx|both      Directions to stream (default both).\n");
+   fprintf(stderr, "   -p Percent         Wire speed in percent of the baud rate, 0 for unpaced\n");
+   fprintf(stderr, "                      (default 100).\n");
+   fprintf(stderr, "   -c Period,High     Raise CTS for High us every Period us.\n");
+   fprintf(stderr, "   -o Interval        Inject an overrun every Interval received bytes.\n");
+   fprintf(stderr, "   -L LinkName        Create a symbolic link to the pseudo-terminal.\n");
+   fprintf(stderr, "   -e                 External controller, no loop back peer.\n");
+}
+
+   /* The following function parses the command line into the options.  */
+   /* The function returns zero if successful or a negative value if the*/
+   /* command line is not valid.                                        */
+static int ParseOptions(int argc, char *argv[])
+{
+   int ret_val;
+   int Option;
+
+   Options.BaudRate                         = DEFAULT_BAUD_RATE;
+   Options.Duration                         = DEFAULT_DURATION;
+   Options.PacketLength                     = DEFAULT_PACKET_LENGTH;
+   Options.Directions                       = DIRECTION_RX | DIRECTION_TX;
+   Options.SimConfiguration.BaudRatePercent = 100;
+
+   ret_val = 0;
+
+   while((!ret_val) && ((Option = getopt(argc, argv, "b:t:l:d:p:c:o:L:e")) != -1))
+   {
+      switch(Option)
+      {
+         case 'b':
+            Options.BaudRate = strtoul(optarg, NULL, 0);
+            break;
+         case 't':
+            Options.Duration = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+         case 'l':
+            Options.PacketLength = (unsigned int)strtoul(optarg, NULL, 0);
+            if((Options.PacketLength < 2) || (Options.PacketLength > MAXIMUM_PACKET_LENGTH))
+               ret_val = -1;
+            break;
+         case 'd':
+            if(!strcmp(optarg, "rx"))
+               Options.Directions = DIRECTION_RX;
+            else
+            {
+               if(!strcmp(optarg, "tx"))
+                  Options.Directions = DIRECTION_TX;
+               else
+               {
+                  if(!strcmp(optarg, "both"))
+                     Options.Directions = DIRECTION_RX | DIRECTION_TX;
+                  else
+                     ret_val = -1;
+               }
+            }
+            break;
+         case 'p':
+            Options.SimConfiguration.BaudRatePercent = (unsigned int)strtoul(optarg, NULL, 0);
+            break;
+         case 'c':
+            if((sscanf(optarg, "%lu,%lu", &Options.SimConfiguration.CTSTogglePeriod, &Options.SimConfiguration.CTSHighTime) != 2) || (Options.SimConfiguration.CTSHighTime >= Options.SimConfiguration.CTSTogglePeriod))
+               ret_val = -1;
+            break;
+         case 'o':
+            Options.SimConfiguration.OverrunInterval = strtoul(optarg, NULL, 0);
+            break;
+         case 'L':
+            Options.SimConfiguration.LinkName = optarg;
+            break;
+         case 'e':
+            Options.External = 1;
+            break;
+         default:
+            ret_val = -1;
+            break;
+      }
+   }
+
+   if((!ret_val) && (optind != argc))
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function returns the time (in microseconds) of the  */
+   /* monotonic clock.                                                  */
+static unsigned long long GetMicroseconds(void)
+{
+   struct timespec Now;
+
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+
+   return(((unsigned long long)Now.tv_sec * 1000000) + (Now.tv_nsec / 1000));
+}
+
+   /* The following function builds the specified test packet (with the */
+   /* H4 packet indicator) in the specified buffer and returns its total*/
+   /* length.                                                           */
+static unsigned int BuildPacket(unsigned char *Buffer, unsigned int Length, unsigned int Sequence)
+{
+   unsigned int Index;
+
+   Buffer[0] = H4_ACL_PACKET;
+   Buffer[1] = (unsigned char)(TEST_ACL_HANDLE & 0xFF);
+   Buffer[2] = (unsigned char)(TEST_ACL_HANDLE >> 8);
+   Buffer[3] = (unsigned char)(Length & 0xFF);
+   Buffer[4] = (unsigned char)(Length >> 8);
+   Buffer[5] = (unsigned char)(Sequence & 0xFF);
+   Buffer[6] = (unsigned char)((Sequence >> 8) & 0xFF);
+
+   for(Index = 2; Index < Length; Index++)
+      Buffer[PACKET_HEADER_LENGTH + Index] = (unsigned char)(Sequence + Index);
+
+   return(PACKET_HEADER_LENGTH + Length);
+}
+
+   /* The following function feeds the specified bytes to the specified */
+   /* packet checker.                                                   */
+static void CheckBytes(Checker_t *Checker, unsigned int Length, unsigned char *Data)
+{
+   unsigned int  Skipped;
+   unsigned char Byte;
+
+   Checker->Bytes += Length;
+
+   while(Length--)
+   {
+      Byte = *(Data++);
+
+      switch(Checker->State)
+      {
+         case CHECK_STATE_INDICATOR:
+            if(Byte == H4_ACL_PACKET)
+            {
+               Checker->State = CHECK_STATE_HEADER;
+               Checker->Index = 0;
+            }
+            else
+            {
+               if(Checker->SequenceValid)
+                  Checker->Errors++;
+            }
+            break;
+         case CHECK_STATE_HEADER:
+            Checker->Header[Checker->Index++] = Byte;
+
+            if(Checker->Index == sizeof(Checker->Header))
+            {
+               Checker->Length = Checker->Header[2] | (Checker->Header[3] << 8);
+
+               if(((Checker->Header[0] | (Checker->Header[1] << 8)) == TEST_ACL_HANDLE) && (Checker->Length >= 2) && (Checker->Length <= MAXIMUM_PACKET_LENGTH))
+               {
+                  Checker->State    = CHECK_STATE_PAYLOAD;
+                  Checker->Index    = 0;
+                  Checker->Sequence = 0;
+               }
+               else
+               {
+                  if(Checker->SequenceValid)
+                     Checker->Errors++;
+
+                  Checker->State = CHECK_STATE_INDICATOR;
+               }
+            }
+            break;
+         case CHECK_STATE_PAYLOAD:
+            if(Checker->Index < 2)
+               Checker->Sequence |= (unsigned int)Byte << (Checker->Index * 8);
+            else
+            {
+               if(Byte != (unsigned char)(Checker->Sequence + Checker->Index))
+               {
+                  /* Resynchronize on the next packet indicator.        */
+                  if(Checker->SequenceValid)
+                     Checker->Errors++;
+
+                  Checker->State = CHECK_STATE_INDICATOR;
+                  break;
+               }
+            }
+
+            if(++Checker->Index == Checker->Length)
+            {
+               /* Count the packets that were skipped since the last one*/
+               /* (a sequence number that goes backwards was corrupted).*/
+               Skipped = (Checker->Sequence - Checker->ExpectedSequence) & 0xFFFF;
+               if((Checker->SequenceValid) && (Skipped < 0x8000))
+                  Checker->LostPackets += Skipped;
+
+               Checker->Packets++;
+               Checker->SequenceValid    = 1;
+               Checker->ExpectedSequence = (Checker->Sequence + 1) & 0xFFFF;
+               Checker->State            = CHECK_STATE_INDICATOR;
+            }
+            break;
+      }
+   }
+}
+
+   /* The following function is the data callback of the transport.     */
+static void BTPSAPI DataCallback(unsigned int HCITransportID, unsigned int DataLength, unsigned char *DataBuffer, unsigned long CallbackParameter)
+{
+   pthread_mutex_lock(&HostCheckerMutex);
+
+   CheckBytes(&HostChecker, DataLength, DataBuffer);
+
+   pthread_mutex_unlock(&HostCheckerMutex);
+}
+
+   /* The following function is the thread of the loop back peer, which */
+   /* plays the controller on the slave side of the pseudo-terminal.    */
+static void *PeerThread(void *Parameter)
+{
+   int            Descriptor;
+   int            Result;
+   unsigned int   Sequence;
+   unsigned int   Offset;
+   unsigned int   Length;
+   unsigned char  TxPacket[PACKET_HEADER_LENGTH + MAXIMUM_PACKET_LENGTH];
+   unsigned char  RxBuffer[4096];
+   struct pollfd  PollDescriptor;
+   struct termios Settings;
+
+   if((Descriptor = open(SlaveName, O_RDWR | O_NOCTTY | O_NONBLOCK)) >= 0)
+   {
+      tcgetattr(Descriptor, &Settings);
+      cfmakeraw(&Settings);
+      tcsetattr(Descriptor, TCSANOW, &Settings);
+
+      Sequence = 0;
+      Offset   = 0;
+      Length   = 0;
+
+      while(Running)
+      {
+         PollDescriptor.fd      = Descriptor;
+         PollDescriptor.events  = POLLIN;
+         PollDescriptor.revents = 0;
+
+         if(Options.Directions & DIRECTION_RX)
+            PollDescriptor.events |= POLLOUT;
+
+         if(poll(&PollDescriptor, 1, 10) > 0)
+         {
+            if(PollDescriptor.revents & POLLIN)
+            {
+               if((Result = read(Descriptor, RxBuffer, sizeof(RxBuffer))) > 0)
+               {
+                  pthread_mutex_lock(&PeerCheckerMutex);
+
+                  CheckBytes(&PeerChecker, (unsigned int)Result, RxBuffer);
+
+                  pthread_mutex_unlock(&PeerCheckerMutex);
+               }
+            }
+
+            if(PollDescriptor.revents & POLLOUT)
+            {
+               if(Offset == Length)
+               {
+                  Length = BuildPacket(TxPacket, Options.PacketLength, Sequence++);
+                  Offset = 0;
+               }
+
+               if((Result = write(Descriptor, &TxPacket[Offset], Length - Offset)) > 0)
+                  Offset += (unsigned int)Result;
+            }
+         }
+      }
+
+      close(Descriptor);
+   }
+   else
+      fprintf(stderr, "Unable to open %s (%s)\n", SlaveName, strerror(errno));
+
+   return(NULL);
+}
+
+   /* The following function is the thread that streams test packets to */
+   /* the transport.                                                    */
+static void *WriterThread(void *Parameter)
+{
+   unsigned int  Sequence;
+   unsigned int  Length;
+   unsigned char Packet[PACKET_HEADER_LENGTH + MAXIMUM_PACKET_LENGTH];
+
+   Sequence = 0;
+
+   while(Running)
+   {
+      Length = BuildPacket(Packet, Options.PacketLength, Sequence++);
+
+      /* HCITR_COMWrite() blocks until the packet has been queued.      */
+      if(HCITR_COMWrite(TransportID, Length, Packet))
+         break;
+   }
+
+   return(NULL);
+}
+
+#ifndef HCITR_ENABLE_RX_TASK
+
+   /* The following function is the thread that plays the Bluetopia     */
+   /* scheduler, which calls HCITR_COMProcess() periodically, when the  */
+   /* transport has no receive task.                                    */
+static void *ProcessThread(void *Parameter)
+{
+   while(Running)
+   {
+      HCITR_COMProcess(TransportID);
+
+      BTPS_Delay(1);
+   }
+
+   return(NULL);
+}
+
+#endif
+
+   /* The following function displays the transport options that the    */
+   /* program was built with.                                           */
+static void DisplayModes(void)
+{
+   printf("Mode:");
+
+#ifdef HCITR_ENABLE_DMA_RX
+
+   printf(" DMA_RX");
+
+#endif
+
+#ifdef HCITR_ENABLE_DMA_TX
+
+   printf(" DMA_TX");
+
+#endif
+
+#ifdef HCITR_ENABLE_UART_FIFO
+
+   printf(" UART_FIFO");
+
+#endif
+
+#ifdef HCITR_ENABLE_H4_FRAMING
+
+   printf(" H4_FRAMING");
+
+#endif
+
+#ifdef HCITR_ENABLE_TX_PRIORITY_QUEUES
+
+   printf(" TX_PRIORITY_QUEUES");
+
+#endif
+
+#ifdef HCITR_ENABLE_RX_TASK
+
+   printf(" RX_TASK");
+
+#endif
+
+   printf("\n");
+}
+
+   /* The following function displays the results of the benchmark.     */
+static void DisplayResults(unsigned long long ElapsedTime, HCITR_Statistics_t *Statistics, HCITRSIM_Statistics_t *SimStatistics)
+{
+   unsigned long long WireRate;
+   unsigned long long Bytes;
+   unsigned long      Interrupts;
+
+   DisplayModes();
+
+   WireRate = (Options.BaudRate / 10) * (Options.SimConfiguration.BaudRatePercent ? Options.SimConfiguration.BaudRatePercent : 100) / 100;
+   if(!ElapsedTime)
+      ElapsedTime = 1;
+
+   if(Options.SimConfiguration.BaudRatePercent)
+      printf("Baud rate %lu, wire %u%%, %u second(s), %u byte payloads\n", Options.BaudRate, Options.SimConfiguration.BaudRatePercent, Options.Duration, Options.PacketLength);
+   else
+      printf("Baud rate %lu, wire unpaced, %u second(s), %u byte payloads\n", Options.BaudRate, Options.Duration, Options.PacketLength);
+
+   Bytes = (HostChecker.Bytes * 1000000) / ElapsedTime;
+   printf("RX: %10llu bytes/s (%3llu%% of the wire), %lu packets, %lu errors, %lu lost\n", Bytes, (Bytes * 100) / WireRate, HostChecker.Packets, HostChecker.Errors, HostChecker.LostPackets);
+
+   Bytes = (PeerChecker.Bytes * 1000000) / ElapsedTime;
+   printf("TX: %10llu bytes/s (%3llu%% of the wire), %lu packets, %lu errors, %lu lost\n", Bytes, (Bytes * 100) / WireRate, PeerChecker.Packets, PeerChecker.Errors, PeerChecker.LostPackets);
+
+   printf("Interrupts: RX %lu (%.1f bytes each), TX %lu (%.1f bytes each), handlers run %lu\n", Statistics->RxInterrupts, Statistics->RxInterrupts ? (double)Statistics->RxBytes / Statistics->RxInterrupts : 0.0, Statistics->TxInterrupts, Statistics->TxInterrupts ? (double)Statistics->TxBytes / Statistics->TxInterrupts : 0.0, SimStatistics->Interrupts);
+
+   Bytes      = SimStatistics->TxBytes + SimStatistics->RxBytes;
+   Interrupts = SimStatistics->Interrupts;
+   printf("Interrupt time: %llu us, %.1f ns/byte, %.1f us/handler, %lu character times masked\n", SimStatistics->InterruptTime / 1000, Bytes ? (double)SimStatistics->InterruptTime / Bytes : 0.0, Interrupts ? (double)SimStatistics->InterruptTime / (Interrupts * 1000.0) : 0.0, SimStatistics->MaskedCharacters);
+
+   printf("Receive buffer: %lu bytes, high water %lu, flow off %lu, buffer overruns %lu, UART overruns %lu\n", Statistics->RxBufferSize, Statistics->RxHighWaterMark, Statistics->RxFlowOffCount, Statistics->RxBufferOverruns, Statistics->RxUARTOverruns);
+   printf("Receive callbacks %lu, task wakeups %lu, maximum latency %lu us\n", Statistics->RxCallbacks, Statistics->RxTaskWakeups, Statistics->RxMaximumLatency);
+   printf("Wire: injected overruns %lu, lost characters %lu, CTS toggles %lu, sent while CTS high %lu, dropped %lu\n", SimStatistics->InjectedOverruns, SimStatistics->LostCharacters, SimStatistics->CTSToggles, SimStatistics->TxWhileCTSHigh, SimStatistics->TxDropped);
+}
+
+int main(int argc, char *argv[])
+{
+   int                               ret_val;
+   pthread_t                         Peer;
+   pthread_t                         Writer;
+
+#ifndef HCITR_ENABLE_RX_TASK
+
+   pthread_t                         Process;
+
+#endif
+
+   unsigned long long                StartTime;
+   unsigned long long                ElapsedTime;
+   HCITR_Statistics_t                Statistics;
+   HCITRSIM_Statistics_t             SimStatistics;
+   HCI_COMMDriverInformation_t       DriverInformation;
+   HCI_COMMReconfigureInformation_t  ReconfigureInformation;
+   HCI_Driver_Reconfigure_Data_t     ReconfigureData;
+
+   if(!ParseOptions(argc, argv))
+   {
+      if(!HCITRSIM_Initialize(&Options.SimConfiguration, SlaveName, sizeof(SlaveName)))
+      {
+         Running = 1;
+
+         if(Options.External)
+         {
+            printf("Controller pseudo-terminal: %s\n", SlaveName);
+            fflush(stdout);
+         }
+         else
+            pthread_create(&Peer, NULL, PeerThread, NULL);
+
+         /* Open the transport at the initial baud rate and switch to   */
+         /* the baud rate of the test, as Bluetopia does after the      */
+         /* initialization script.                                      */
+         memset(&DriverInformation, 0, sizeof(DriverInformation));
+
+         DriverInformation.DriverInformationSize = sizeof(DriverInformation);
+         DriverInformation.BaudRate              = 115200;
+         DriverInformation.Protocol              = cpHCILL_RTS_CTS;
+
+         if((ret_val = HCITR_COMOpen(&DriverInformation, DataCallback, 0)) > 0)
+         {
+            TransportID = (unsigned int)ret_val;
+
+            ReconfigureInformation.ReconfigureFlags = HCI_COMM_RECONFIGURE_INFORMATION_RECONFIGURE_FLAGS_CHANGE_BAUDRATE;
+            ReconfigureInformation.BaudRate         = Options.BaudRate;
+            ReconfigureInformation.Protocol         = cpHCILL_RTS_CTS;
+
+            ReconfigureData.ReconfigureCommand      = HCI_COMM_DRIVER_RECONFIGURE_DATA_COMMAND_CHANGE_COMM_PARAMETERS;
+            ReconfigureData.ReconfigureData         = &ReconfigureInformation;
+
+            HCITR_COMReconfigure(TransportID, &ReconfigureData);
+
+            /* Start counting once the baud rate has changed.           */
+            HCITR_QueryStatistics(TransportID, &Statistics, TRUE);
+            HCITRSIM_QueryStatistics(&SimStatistics, 1);
+
+            pthread_mutex_lock(&HostCheckerMutex);
+            memset(&HostChecker, 0, sizeof(HostChecker));
+            pthread_mutex_unlock(&HostCheckerMutex);
+
+            pthread_mutex_lock(&PeerCheckerMutex);
+            memset(&PeerChecker, 0, sizeof(PeerChecker));
+            pthread_mutex_unlock(&PeerCheckerMutex);
+
+            StartTime = GetMicroseconds();
+
+            if((!Options.External) && (Options.Directions & DIRECTION_TX))
+               pthread_create(&Writer, NULL, WriterThread, NULL);
+
+#ifndef HCITR_ENABLE_RX_TASK
+
+            pthread_create(&Process, NULL, ProcessThread, NULL);
+
+#endif
+
+            sleep(Options.Duration);
+
+            ElapsedTime = GetMicroseconds() - StartTime;
+
+            HCITR_QueryStatistics(TransportID, &Statistics, FALSE);
+            HCITRSIM_QueryStatistics(&SimStatistics, 0);
+
+            Running = 0;
+
+            pthread_mutex_lock(&HostCheckerMutex);
+            pthread_mutex_lock(&PeerCheckerMutex);
+
+            DisplayResults(ElapsedTime, &Statistics, &SimStatistics);
+
+            /* Without injected faults any data error is a failure.     */
+            if((!Options.SimConfiguration.OverrunInterval) && (HostChecker.Errors + HostChecker.LostPackets + PeerChecker.Errors + PeerChecker.LostPackets))
+               ret_val = 1;
+            else
+               ret_val = 0;
+
+            pthread_mutex_unlock(&PeerCheckerMutex);
+            pthread_mutex_unlock(&HostCheckerMutex);
+
+            /* The threads may be blocked in the transport, which is    */
+            /* left open, so the process simply exits.                  */
+         }
+         else
+         {
+            fprintf(stderr, "HCITR_COMOpen() failed (%d)\n", ret_val);
+
+            ret_val = 1;
+         }
+
+         fflush(stdout);
+
+         HCITRSIM_Shutdown();
+      }
+      else
+      {
+         fprintf(stderr, "Unable to create the pseudo-terminal\n");
+
+         ret_val = 1;
+      }
+   }
+   else
+   {
+      Usage(argv[0]);
+
+      ret_val = 2;
+   }
+
+   _exit(ret_val);
+}
@@ -0,0 +1,1090 @@
+/*****< hcitrsim.c >***********************************************************/
+/*                                                                            */
+/*  HCITRSIM - Host simulation of the MCU peripherals used by HCITRANS.       */
+/*                                                                            */
+/*  The simulator thread advances the UART one character time at a time.      */
+/*  In each character time the transmitter moves one character from the       */
+/*  transmit DMA (or FIFO) to the pseudo-terminal and the receiver moves one  */
+/*  character from the pseudo-terminal to the receive DMA buffer (or FIFO),   */
+/*  as long as RTS is low.  The interrupts that are then pending are run by   */
+/*  the simulator thread unless they are held off by DisableInterrupts().     */
+/*                                                                            */
+/******************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "HCITRCFG.h"       /* HCI Transport configuration.                   */
+
+   /* The following defines the depth of the transmit and receive FIFOs */
+   /* of the UART (one character when the FIFOs are disabled).          */
+#define UART_FIFO_DEPTH          8
+
+   /* The following defines the size of the buffers that hold the       */
+   /* characters waiting to be read from and written to the             */
+   /* pseudo-terminal.                                                  */
+#define WIRE_BUFFER_SIZE         65536
+
+   /* The following defines the time (in microseconds) that the         */
+   /* simulator thread sleeps between two passes when the wire is paced.*/
+   /* The characters that were due in this time are then simulated back */
+   /* to back (with the interrupts run after each one).                 */
+#define SIMULATION_PERIOD        100
+
+   /* The following defines the largest number of character times that  */
+   /* are simulated in one pass, so that the simulation does not try to */
+   /* catch up after the host has stalled it.                           */
+#define MAXIMUM_CHARACTERS_PER_PASS 4096
+
+   /* The following defines the number of character times that are      */
+   /* simulated in one pass when the wire is not paced.                 */
+#define UNPACED_CHARACTERS_PER_PASS 64
+
+   /* The following define the number of bits in a character (start,    */
+   /* eight data bits and stop) and the number of nanoseconds in a      */
+   /* second.                                                           */
+#define BITS_PER_CHARACTER       10
+#define NANOSECONDS_PER_SECOND   1000000000ULL
+
+   /* The following constants represent the interrupts (bit mask) that  */
+   /* are pending.                                                      */
+#define PENDING_UART             0x0001
+#define PENDING_CTS              0x0002
+#define PENDING_RX_DMA_HALF      0x0004
+#define PENDING_RX_DMA_FULL      0x0008
+#define PENDING_TX_DMA           0x0010
+
+   /* The following structure holds the characters that are waiting to  */
+   /* be read from or written to the pseudo-terminal.                   */
+typedef struct _tagWireBuffer_t
+{
+   unsigned char Data[WIRE_BUFFER_SIZE];
+   unsigned int  InIndex;
+   unsigned int  OutIndex;
+   unsigned int  Count;
+} WireBuffer_t;
+
+   /* The following structure holds a UART FIFO.                        */
+typedef struct _tagFIFO_t
+{
+   unsigned char Data[UART_FIFO_DEPTH];
+   unsigned int  InIndex;
+   unsigned int  OutIndex;
+   unsigned int  Count;
+} FIFO_t;
+
+   /* The following structure holds the state of the simulator.  The    */
+   /* model (everything but the configuration) is protected by the      */
+   /* mutex, which is never held while an interrupt handler is run.     */
+   /* The interrupt mutex is held by the simulator thread while it runs */
+   /* the interrupt handlers and by DisableInterrupts() (it is recursive*/
+   /* as interrupts are also "disabled" from the handlers).             */
+typedef struct _tagSimContext_t
+{
+   HCITRSIM_Configuration_t  Configuration;
+   int                       MasterDescriptor;
+   int                       SlaveDescriptor;
+   pthread_t                 Thread;
+   volatile int              Running;
+   pthread_mutex_t           Mutex;
+   pthread_mutex_t           InterruptMutex;
+
+   int                       RTSHigh;
+   int                       CTSHigh;
+   int                       ResetActive;
+   int                       Booting;
+   int                       UartClockEnabled;
+   int                       TxdHeld;
+   int                       UartIRQEnabled;
+
+   FIFO_t                    TxFIFO;
+   FIFO_t                    RxFIFO;
+   unsigned char             LastReceived;
+   int                       LineActive;
+
+   unsigned char            *TxDMAData;
+   unsigned int              TxDMARemaining;
+   unsigned char            *RxDMABuffer;
+   unsigned int              RxDMASize;
+   int                       RxDMAActive;
+   unsigned int              Pending;
+
+   WireBuffer_t              WireRx;
+   WireBuffer_t              WireTx;
+
+   unsigned long long        LastTime;
+   unsigned long long        TimeRemainder;
+   unsigned long long        NextCTSToggle;
+   unsigned long long        BootDoneTime;
+   unsigned long             OverrunCounter;
+
+   HCITRSIM_Statistics_t     Statistics;
+} SimContext_t;
+
+   /* The simulated peripherals.                                        */
+USART_TypeDef              HCITRSIM_USART2;
+DMA_Channel_TypeDef        HCITRSIM_DMA2_Channel6;
+DMA_Channel_TypeDef        HCITRSIM_DMA2_Channel7;
+EXTI_TypeDef               HCITRSIM_EXTI;
+CoreDebug_Type             HCITRSIM_CoreDebug;
+DWT_Type                   HCITRSIM_DWT;
+uint32_t                   SystemCoreClock = 120000000;
+
+static DMA_HandleTypeDef   hdma_usart2_tx = { DMA2_Channel7, NULL, NULL, NULL, NULL };
+static DMA_HandleTypeDef   hdma_usart2_rx = { DMA2_Channel6, NULL, NULL, NULL, NULL };
+
+UART_HandleTypeDef         huart2         = { USART2, { 115200 }, &hdma_usart2_tx, &hdma_usart2_rx };
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+static SimContext_t        SimContext;
+static __thread int        InsideInterrupt;
+
+   /* Local Function Prototypes.                                        */
+static unsigned long long GetNanoseconds(void);
+static unsigned long long GetThreadNanoseconds(void);
+static int PutFIFO(FIFO_t *FIFO, unsigned int Depth, unsigned char Data);
+static int GetFIFO(FIFO_t *FIFO, unsigned char *Data);
+static void PutWire(WireBuffer_t *Buffer, unsigned char Data);
+static int GetWire(WireBuffer_t *Buffer, unsigned char *Data);
+static unsigned int GetFIFODepth(void);
+static unsigned int GetFIFOThreshold(uint32_t Configuration);
+static void UpdateFlags(void);
+static void ClearFlags(void);
+static void SimulateCharacter(void);
+static void UpdateCTS(unsigned long long Now);
+static unsigned int GetPendingInterrupts(void);
+static int RunInterrupts(unsigned int Pending);
+static void TransferWire(void);
+static void *SimulatorThread(void *Parameter);
+
+   /* The following function returns the time (in nanoseconds) of the   */
+   /* monotonic clock.                                                  */
+static unsigned long long GetNanoseconds(void)
+{
+   struct timespec Now;
+
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+
+   return(((unsigned long long)Now.tv_sec * NANOSECONDS_PER_SECOND) + Now.tv_nsec);
+}
+
+   /* The following function returns the processor time (in             */
+   /* nanoseconds) used by the calling thread.                          */
+static unsigned long long GetThreadNanoseconds(void)
+{
+   struct timespec Now;
+
+   clock_gettime(CLOCK_THREAD_CPUTIME_ID, &Now);
+
+   return(((unsigned long long)Now.tv_sec * NANOSECONDS_PER_SECOND) + Now.tv_nsec);
+}
+
+   /* The following function adds a character to the specified FIFO if  */
+   /* it holds less than the specified number of characters.  The       */
+   /* function returns non-zero if the character was added.             */
+static int PutFIFO(FIFO_t *FIFO, unsigned int Depth, unsigned char Data)
+{
+   int ret_val;
+
+   if(FIFO->Count < Depth)
+   {
+      FIFO->Data[FIFO->InIndex] = Data;
+
+      FIFO->InIndex = (FIFO->InIndex + 1) % UART_FIFO_DEPTH;
+      FIFO->Count++;
+
+      ret_val = 1;
+   }
+   else
+      ret_val = 0;
+
+   return(ret_val);
+}
+
+   /* The following function removes the oldest character from the      */
+   /* specified FIFO.  The function returns non-zero if there was a     */
+   /* character.                                                        */
+static int GetFIFO(FIFO_t *FIFO, unsigned char *Data)
+{
+   int ret_val;
+
+   if(FIFO->Count)
+   {
+      *Data = FIFO->Data[FIFO->OutIndex];
+
+      FIFO->OutIndex = (FIFO->OutIndex + 1) % UART_FIFO_DEPTH;
+      FIFO->Count--;
+
+      ret_val = 1;
+   }
+   else
+      ret_val = 0;
+
+   return(ret_val);
+}
+
+   /* The following function adds a character to the specified wire     */
+   /* buffer.  A character that does not fit is dropped.                */
+static void PutWire(WireBuffer_t *Buffer, unsigned char Data)
+{
+   if(Buffer->Count < WIRE_BUFFER_SIZE)
+   {
+      Buffer->Data[Buffer->InIndex] = Data;
+
+      Buffer->InIndex = (Buffer->InIndex + 1) % WIRE_BUFFER_SIZE;
+      Buffer->Count++;
+   }
+   else
+      SimContext.Statistics.TxDropped++;
+}
+
+   /* The following function removes the oldest character from the      */
+   /* specified wire buffer.  The function returns non-zero if there was*/
+   /* a character.                                                      */
+static int GetWire(WireBuffer_t *Buffer, unsigned char *Data)
+{
+   int ret_val;
+
+   if(Buffer->Count)
+   {
+      *Data = Buffer->Data[Buffer->OutIndex];
+
+      Buffer->OutIndex = (Buffer->OutIndex + 1) % WIRE_BUFFER_SIZE;
+      Buffer->Count--;
+
+      ret_val = 1;
+   }
+   else
+      ret_val = 0;
+
+   return(ret_val);
+}
+
+   /* The following function returns the number of characters that the  */
+   /* FIFOs of the UART hold in the current mode.                       */
+static unsigned int GetFIFODepth(void)
+{
+   return((USART2->CR1 & USART_CR1_FIFOEN) ? UART_FIFO_DEPTH : 1);
+}
+
+   /* The following function returns the number of characters of the    */
+   /* specified FIFO threshold configuration (TXFTCFG or RXFTCFG).      */
+static unsigned int GetFIFOThreshold(uint32_t Configuration)
+{
+   static const unsigned char Thresholds[] = { 1, 2, 4, 6, 7, 8, 8, 8 };
+
+   return(Thresholds[Configuration & 7]);
+}
+
+   /* The following function updates the status flags of the UART that  */
+   /* follow the state of the FIFOs and the transmitter.                */
+   /* * NOTE * This function must be called with the mutex held.        */
+static void UpdateFlags(void)
+{
+   uint32_t     Flags;
+   unsigned int Depth;
+
+   Depth  = GetFIFODepth();
+   Flags  = USART2->ISR & ~(USART_ISR_RXNE_RXFNE | USART_ISR_RXFT | USART_ISR_TXE_TXFNF | USART_ISR_TXFT | USART_ISR_TC);
+
+   if(SimContext.RxFIFO.Count)
+      Flags |= USART_ISR_RXNE_RXFNE;
+
+   if(SimContext.TxFIFO.Count < Depth)
+      Flags |= USART_ISR_TXE_TXFNF;
+
+   if(USART2->CR1 & USART_CR1_FIFOEN)
+   {
+      if(SimContext.RxFIFO.Count >= GetFIFOThreshold(USART2->CR3 >> USART_CR3_RXFTCFG_Pos))
+         Flags |= USART_ISR_RXFT;
+
+      if((Depth - SimContext.TxFIFO.Count) >= GetFIFOThreshold(USART2->CR3 >> USART_CR3_TXFTCFG_Pos))
+         Flags |= USART_ISR_TXFT;
+   }
+
+   /* The transmission is complete once there is nothing left to send.  */
+   if((!SimContext.TxFIFO.Count) && ((!SimContext.TxDMARemaining) || (!(USART2->CR3 & USART_CR3_DMAT))))
+      Flags |= USART_ISR_TC;
+
+   USART2->ISR = Flags;
+}
+
+   /* The following function clears the status flags that have been     */
+   /* written to the interrupt flag clear register.                     */
+   /* * NOTE * This function must be called with the mutex and the      */
+   /*          interrupt mutex held (all writes to the ICR are made from*/
+   /*          an interrupt or with interrupts disabled).               */
+static void ClearFlags(void)
+{
+   uint32_t Clear;
+
+   if((Clear = USART2->ICR) != 0)
+   {
+      /* The clear bits are in the same positions as the flags.         */
+      USART2->ISR &= ~(Clear & (USART_ICR_FECF | USART_ICR_NECF | USART_ICR_ORECF | USART_ICR_IDLECF));
+      USART2->ICR  = 0;
+   }
+}
+
+   /* The following function simulates one character time of the UART.  */
+   /* * NOTE * This function must be called with the mutex held.        */
+static void SimulateCharacter(void)
+{
+   int           Sent;
+   int           Received;
+   unsigned char Data;
+
+   Sent     = 0;
+   Received = 0;
+
+   if((SimContext.UartClockEnabled) && (USART2->CR1 & USART_CR1_UE))
+   {
+      /* The transmitter is not stopped by CTS, as the UART does not use*/
+      /* hardware flow control.                                         */
+      if((USART2->CR1 & USART_CR1_TE) && (!SimContext.TxdHeld))
+      {
+         if((SimContext.TxDMARemaining) && (USART2->CR3 & USART_CR3_DMAT))
+         {
+            Data = *(SimContext.TxDMAData++);
+            Sent = 1;
+
+            DMA2_Channel7->CNDTR = --SimContext.TxDMARemaining;
+            if(!SimContext.TxDMARemaining)
+               SimContext.Pending |= PENDING_TX_DMA;
+         }
+         else
+            Sent = GetFIFO(&SimContext.TxFIFO, &Data);
+
+         if(Sent)
+         {
+            PutWire(&SimContext.WireTx, Data);
+
+            SimContext.Statistics.TxBytes++;
+
+            if(SimContext.CTSHigh)
+               SimContext.Statistics.TxWhileCTSHigh++;
+         }
+      }
+
+      /* The controller only sends while RTS is low and it is out of    */
+      /* reset.                                                         */
+      if((USART2->CR1 & USART_CR1_RE) && (!SimContext.RTSHigh) && (!SimContext.ResetActive) && (GetWire(&SimContext.WireRx, &Data)))
+      {
+         Received = 1;
+
+         SimContext.Statistics.RxBytes++;
+
+         if((SimContext.Configuration.OverrunInterval) && (++SimContext.OverrunCounter >= SimContext.Configuration.OverrunInterval))
+         {
+            /* Lose the character as if it had not been read in time.   */
+            SimContext.OverrunCounter  = 0;
+            USART2->ISR               |= USART_ISR_ORE;
+
+            SimContext.Statistics.InjectedOverruns++;
+         }
+         else
+         {
+            if((SimContext.RxDMAActive) && (USART2->CR3 & USART_CR3_DMAR))
+            {
+               SimContext.RxDMABuffer[SimContext.RxDMASize - DMA2_Channel6->CNDTR] = Data;
+
+               /* The receive DMA is circular.                          */
+               DMA2_Channel6->CNDTR--;
+               if(DMA2_Channel6->CNDTR == (SimContext.RxDMASize / 2))
+                  SimContext.Pending |= PENDING_RX_DMA_HALF;
+
+               if(!DMA2_Channel6->CNDTR)
+               {
+                  DMA2_Channel6->CNDTR  = SimContext.RxDMASize;
+                  SimContext.Pending   |= PENDING_RX_DMA_FULL;
+               }
+            }
+            else
+            {
+               if(!PutFIFO(&SimContext.RxFIFO, GetFIFODepth(), Data))
+               {
+                  USART2->ISR |= USART_ISR_ORE;
+
+                  SimContext.Statistics.LostCharacters++;
+               }
+            }
+         }
+      }
+
+      /* The line is idle after one character time without a character. */
+      if((!Received) && (SimContext.LineActive))
+         USART2->ISR |= USART_ISR_IDLE;
+   }
+
+   SimContext.LineActive = Received;
+
+   UpdateFlags();
+}
+
+   /* The following function lowers CTS when the controller has booted  */
+   /* and raises and lowers it at the configured times.                 */
+   /* * NOTE * This function must be called with the mutex held.        */
+static void UpdateCTS(unsigned long long Now)
+{
+   if((SimContext.Booting) && (Now >= SimContext.BootDoneTime))
+   {
+      SimContext.Booting  = 0;
+      SimContext.CTSHigh  = 0;
+      SimContext.Pending |= PENDING_CTS;
+   }
+
+   if((SimContext.Configuration.CTSTogglePeriod) && (!SimContext.ResetActive) && (!SimContext.Booting) && (Now >= SimContext.NextCTSToggle))
+   {
+      if(!SimContext.CTSHigh)
+      {
+         SimContext.CTSHigh       = 1;
+         SimContext.NextCTSToggle = Now + (SimContext.Configuration.CTSHighTime * 1000ULL);
+
+         SimContext.Statistics.CTSToggles++;
+      }
+      else
+      {
+         SimContext.CTSHigh       = 0;
+         SimContext.NextCTSToggle = Now + ((SimContext.Configuration.CTSTogglePeriod - SimContext.Configuration.CTSHighTime) * 1000ULL);
+
+         SimContext.Pending      |= PENDING_CTS;
+      }
+   }
+}
+
+   /* The following function returns the interrupts that are pending.   */
+   /* * NOTE * This function must be called with the mutex held.        */
+static unsigned int GetPendingInterrupts(void)
+{
+   unsigned int ret_val;
+   uint32_t     Flags;
+   uint32_t     Control1;
+   uint32_t     Control3;
+
+   ret_val  = SimContext.Pending;
+
+   Flags    = USART2->ISR;
+   Control1 = USART2->CR1;
+   Control3 = USART2->CR3;
+
+   if((SimContext.UartIRQEnabled) && (SimContext.UartClockEnabled))
+   {
+      if(((Control1 & USART_CR1_RXNEIE_RXFNEIE) && (Flags & (USART_ISR_RXNE_RXFNE | USART_ISR_ORE))) ||
+         ((Control3 & USART_CR3_RXFTIE) && (Flags & USART_ISR_RXFT)) ||
+         ((Control1 & USART_CR1_IDLEIE) && (Flags & USART_ISR_IDLE)) ||
+         ((Control1 & USART_CR1_TXEIE_TXFNFIE) && (Flags & USART_ISR_TXE_TXFNF)) ||
+         ((Control3 & USART_CR3_TXFTIE) && (Flags & USART_ISR_TXFT)) ||
+         ((Control3 & USART_CR3_EIE) && (Flags & (USART_ISR_ORE | USART_ISR_NE | USART_ISR_FE))))
+      {
+         ret_val |= PENDING_UART;
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function runs the handlers of the specified pending */
+   /* interrupts unless interrupts are disabled.  The function returns  */
+   /* non-zero if the handlers were run.                                */
+static int RunInterrupts(unsigned int Pending)
+{
+   int                ret_val;
+   unsigned int       Handlers;
+   unsigned long long StartTime;
+
+   if(!pthread_mutex_trylock(&SimContext.InterruptMutex))
+   {
+      StartTime = GetThreadNanoseconds();
+      Handlers  = 0;
+
+      pthread_mutex_lock(&SimContext.Mutex);
+
+      ClearFlags();
+
+      /* The events that are not levels are cleared as they are taken   */
+      /* (an event that was raised since they were read is left         */
+      /* pending).                                                      */
+      SimContext.Pending &= ~(Pending & (PENDING_CTS | PENDING_RX_DMA_HALF | PENDING_RX_DMA_FULL | PENDING_TX_DMA));
+
+      pthread_mutex_unlock(&SimContext.Mutex);
+
+      InsideInterrupt = 1;
+
+      if((Pending & PENDING_CTS) && (EXTI->IMR1 & EXTI_IMR1_IM3))
+      {
+         HAL_GPIO_EXTI_Callback(GPIO_PIN_3);
+         Handlers++;
+      }
+
+      if(Pending & PENDING_TX_DMA)
+      {
+         if(huart2.hdmatx->XferCpltCallback)
+            (*huart2.hdmatx->XferCpltCallback)(huart2.hdmatx);
+         Handlers++;
+      }
+
+      if(Pending & PENDING_RX_DMA_HALF)
+      {
+         HAL_UARTEx_RxEventCallback(&huart2, (uint16_t)(SimContext.RxDMASize / 2));
+         Handlers++;
+      }
+
+      if(Pending & PENDING_RX_DMA_FULL)
+      {
+         HAL_UARTEx_RxEventCallback(&huart2, (uint16_t)SimContext.RxDMASize);
+         Handlers++;
+      }
+
+      if(Pending & PENDING_UART)
+      {
+         USART2_IRQHandler();
+         Handlers++;
+      }
+
+      InsideInterrupt = 0;
+
+      pthread_mutex_lock(&SimContext.Mutex);
+
+      ClearFlags();
+      UpdateFlags();
+
+      SimContext.Statistics.Interrupts    += Handlers;
+      SimContext.Statistics.InterruptTime += GetThreadNanoseconds() - StartTime;
+
+      pthread_mutex_unlock(&SimContext.Mutex);
+
+      pthread_mutex_unlock(&SimContext.InterruptMutex);
+
+      ret_val = 1;
+   }
+   else
+   {
+      pthread_mutex_lock(&SimContext.Mutex);
+
+      SimContext.Statistics.MaskedCharacters++;
+
+      pthread_mutex_unlock(&SimContext.Mutex);
+
+      ret_val = 0;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function moves characters between the wire buffers  */
+   /* and the pseudo-terminal.                                          */
+static void TransferWire(void)
+{
+   int            Result;
+   unsigned int   Length;
+   unsigned char  Buffer[1024];
+
+   pthread_mutex_lock(&SimContext.Mutex);
+
+   /* Characters are only read while there is room for them, so the     */
+   /* pseudo-terminal pushes back on the controller.                    */
+   Length = WIRE_BUFFER_SIZE - SimContext.WireRx.Count;
+   if(Length > sizeof(Buffer))
+      Length = sizeof(Buffer);
+
+   if((Length) && ((Result = read(SimContext.MasterDescriptor, Buffer, Length)) > 0))
+   {
+      for(Length = 0; Length < (unsigned int)Result; Length++)
+      {
+         SimContext.WireRx.Data[SimContext.WireRx.InIndex] = Buffer[Length];
+
+         SimContext.WireRx.InIndex = (SimContext.WireRx.InIndex + 1) % WIRE_BUFFER_SIZE;
+         SimContext.WireRx.Count++;
+      }
+   }
+
+   while(SimContext.WireTx.Count)
+   {
+      Length = WIRE_BUFFER_SIZE - SimContext.WireTx.OutIndex;
+      if(Length > SimContext.WireTx.Count)
+         Length = SimContext.WireTx.Count;
+
+      if((Result = write(SimContext.MasterDescriptor, &(SimContext.WireTx.Data[SimContext.WireTx.OutIndex]), Length)) <= 0)
+         break;
+
+      SimContext.WireTx.OutIndex = (SimContext.WireTx.OutIndex + Result) % WIRE_BUFFER_SIZE;
+      SimContext.WireTx.Count   -= Result;
+   }
+
+   pthread_mutex_unlock(&SimContext.Mutex);
+}
+
+   /* The following function is the simulator thread.                   */
+static void *SimulatorThread(void *Parameter)
+{
+   unsigned int       Index;
+   unsigned int       Pending;
+   unsigned long      BaudRate;
+   unsigned long long Now;
+   unsigned long long Characters;
+   unsigned long long BitTime;
+   struct timespec    Delay;
+
+   SimContext.LastTime = GetNanoseconds();
+
+   while(SimContext.Running)
+   {
+      TransferWire();
+
+      /* Work out how many character times have passed at the baud rate */
+      /* that is programmed in the UART.                                */
+      Now = GetNanoseconds();
+
+      if(SimContext.Configuration.BaudRatePercent)
+      {
+         BaudRate = (USART2->BRR) ? (HCITR_UART_CLOCK / USART2->BRR) : 0;
+         BitTime  = (Now - SimContext.LastTime) * (((unsigned long long)BaudRate * SimContext.Configuration.BaudRatePercent) / 100) + SimContext.TimeRemainder;
+
+         Characters                = BitTime / (NANOSECONDS_PER_SECOND * BITS_PER_CHARACTER);
+         SimContext.TimeRemainder  = BitTime % (NANOSECONDS_PER_SECOND * BITS_PER_CHARACTER);
+
+         if(Characters > MAXIMUM_CHARACTERS_PER_PASS)
+         {
+            Characters               = MAXIMUM_CHARACTERS_PER_PASS;
+            SimContext.TimeRemainder = 0;
+         }
+      }
+      else
+         Characters = UNPACED_CHARACTERS_PER_PASS;
+
+      SimContext.LastTime = Now;
+
+      /* Run any interrupt that was raised outside of a character time  */
+      /* (e.g. a transmit interrupt that was enabled by a task).        */
+      pthread_mutex_lock(&SimContext.Mutex);
+
+      UpdateCTS(Now);
+
+      Pending = GetPendingInterrupts();
+
+      pthread_mutex_unlock(&SimContext.Mutex);
+
+      if(Pending)
+         RunInterrupts(Pending);
+
+      for(Index = 0; Index < Characters; Index++)
+      {
+         pthread_mutex_lock(&SimContext.Mutex);
+
+         SimulateCharacter();
+
+         Pending = GetPendingInterrupts();
+
+         pthread_mutex_unlock(&SimContext.Mutex);
+
+         /* An unpaced wire waits while interrupts are disabled, as it  */
+         /* has no character time to measure the latency against.       */
+         if((Pending) && (!RunInterrupts(Pending)) && (!SimContext.Configuration.BaudRatePercent))
+         {
+            sched_yield();
+            break;
+         }
+      }
+
+      if(SimContext.Configuration.BaudRatePercent)
+      {
+         Delay.tv_sec  = 0;
+         Delay.tv_nsec = SIMULATION_PERIOD * 1000L;
+
+         nanosleep(&Delay, NULL);
+      }
+   }
+
+   return(NULL);
+}
+
+   /* The following function opens the pseudo-terminal and starts the   */
+   /* simulator thread with the specified configuration.                */
+int HCITRSIM_Initialize(HCITRSIM_Configuration_t *Configuration, char *SlaveName, unsigned int SlaveNameSize)
+{
+   int                  ret_val;
+   char                 Name[128];
+   struct termios       Settings;
+   pthread_mutexattr_t  Attributes;
+
+   if((Configuration) && (!SimContext.Running))
+   {
+      SimContext.Configuration    = *Configuration;
+      SimContext.SlaveDescriptor  = -1;
+      SimContext.MasterDescriptor = posix_openpt(O_RDWR | O_NOCTTY);
+
+      if((SimContext.MasterDescriptor >= 0) && (!grantpt(SimContext.MasterDescriptor)) && (!unlockpt(SimContext.MasterDescriptor)) && (!ptsname_r(SimContext.MasterDescriptor, Name, sizeof(Name))))
+      {
+         /* The slave side is kept open (in raw mode) so that the master*/
+         /* side does not see a hang up while no controller is attached.*/
+         if((SimContext.SlaveDescriptor = open(Name, O_RDWR | O_NOCTTY)) >= 0)
+         {
+            tcgetattr(SimContext.SlaveDescriptor, &Settings);
+            cfmakeraw(&Settings);
+            tcsetattr(SimContext.SlaveDescriptor, TCSANOW, &Settings);
+         }
+
+         fcntl(SimContext.MasterDescriptor, F_SETFL, fcntl(SimContext.MasterDescriptor, F_GETFL) | O_NONBLOCK);
+
+         if(Configuration->LinkName)
+         {
+            unlink(Configuration->LinkName);
+            if(symlink(Name, Configuration->LinkName))
+               fprintf(stderr, "Unable to create %s (%s)\n", Configuration->LinkName, strerror(errno));
+         }
+
+         if((SlaveName) && (SlaveNameSize))
+         {
+            strncpy(SlaveName, Name, SlaveNameSize - 1);
+            SlaveName[SlaveNameSize - 1] = '\0';
+         }
+
+         pthread_mutexattr_init(&Attributes);
+         pthread_mutexattr_settype(&Attributes, PTHREAD_MUTEX_RECURSIVE);
+
+         pthread_mutex_init(&SimContext.Mutex, NULL);
+         pthread_mutex_init(&SimContext.InterruptMutex, &Attributes);
+
+         pthread_mutexattr_destroy(&Attributes);
+
+         /* The controller is in reset (with CTS high) until the        */
+         /* transport is opened.                                        */
+         SimContext.ResetActive   = 1;
+         SimContext.CTSHigh       = 1;
+         SimContext.RTSHigh       = 1;
+         SimContext.NextCTSToggle = GetNanoseconds() + (SimContext.Configuration.CTSTogglePeriod * 1000ULL);
+         SimContext.Running       = 1;
+
+         if(!pthread_create(&SimContext.Thread, NULL, SimulatorThread, NULL))
+            ret_val = 0;
+         else
+         {
+            SimContext.Running = 0;
+
+            ret_val = -1;
+         }
+      }
+      else
+         ret_val = -1;
+
+      if((ret_val) && (SimContext.MasterDescriptor >= 0))
+      {
+         if(SimContext.SlaveDescriptor >= 0)
+            close(SimContext.SlaveDescriptor);
+
+         close(SimContext.MasterDescriptor);
+      }
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function stops the simulator thread and closes the  */
+   /* pseudo-terminal.                                                  */
+void HCITRSIM_Shutdown(void)
+{
+   if(SimContext.Running)
+   {
+      SimContext.Running = 0;
+
+      pthread_join(SimContext.Thread, NULL);
+
+      if(SimContext.Configuration.LinkName)
+         unlink(SimContext.Configuration.LinkName);
+
+      close(SimContext.SlaveDescriptor);
+      close(SimContext.MasterDescriptor);
+   }
+}
+
+   /* The following function returns the statistics of the simulator in */
+   /* the specified structure and, if the second parameter is non-zero, */
+   /* resets them.                                                      */
+void HCITRSIM_QueryStatistics(HCITRSIM_Statistics_t *Statistics, int Reset)
+{
+   pthread_mutex_lock(&SimContext.Mutex);
+
+   if(Statistics)
+      *Statistics = SimContext.Statistics;
+
+   if(Reset)
+      memset(&SimContext.Statistics, 0, sizeof(SimContext.Statistics));
+
+   pthread_mutex_unlock(&SimContext.Mutex);
+}
+
+   /* The following function sets the level of CTS (driven by the       */
+   /* controller).  Lowering CTS raises the CTS EXTI interrupt.         */
+void HCITRSIM_SetCTS(int High)
+{
+   pthread_mutex_lock(&SimContext.Mutex);
+
+   if((SimContext.CTSHigh) && (!High))
+      SimContext.Pending |= PENDING_CTS;
+
+   SimContext.CTSHigh = High;
+
+   pthread_mutex_unlock(&SimContext.Mutex);
+}
+
+   /* The following function returns non-zero while the controller is   */
+   /* held in reset (nShutdown low).                                    */
+int HCITRSIM_GetReset(void)
+{
+   return(SimContext.ResetActive);
+}
+
+uint32_t HCITRSIM_GetCycleCount(void)
+{
+   return((uint32_t)((GetNanoseconds() * (SystemCoreClock / 1000000)) / 1000));
+}
+
+unsigned char HCITRSIM_ReadReceiveData(void)
+{
+   pthread_mutex_lock(&SimContext.Mutex);
+
+   /* Reading an empty FIFO returns the last character again.           */
+   GetFIFO(&SimContext.RxFIFO, &SimContext.LastReceived);
+
+   UpdateFlags();
+
+   pthread_mutex_unlock(&SimContext.Mutex);
+
+   return(SimContext.LastReceived);
+}
+
+void HCITRSIM_WriteTransmitData(unsigned char Data)
+{
+   pthread_mutex_lock(&SimContext.Mutex);
+
+   /* A character written to a full FIFO is lost.                       */
+   if(!PutFIFO(&SimContext.TxFIFO, GetFIFODepth(), Data))
+      SimContext.Statistics.TxDropped++;
+
+   UpdateFlags();
+
+   pthread_mutex_unlock(&SimContext.Mutex);
+}
+
+void HCITRSIM_StartTransmitDMA(unsigned char *Buffer, unsigned int Length)
+{
+   pthread_mutex_lock(&SimContext.Mutex);
+
+   SimContext.TxDMAData       = Buffer;
+   SimContext.TxDMARemaining  = Length;
+   SimContext.Pending        &= ~PENDING_TX_DMA;
+   DMA2_Channel7->CNDTR       = Length;
+
+   pthread_mutex_unlock(&SimContext.Mutex);
+}
+
+void HCITRSIM_SetRTS(int High)
+{
+   SimContext.RTSHigh = High;
+}
+
+int HCITRSIM_GetRTS(void)
+{
+   return(SimContext.RTSHigh);
+}
+
+int HCITRSIM_GetCTS(void)
+{
+   return(SimContext.CTSHigh);
+}
+
+void HCITRSIM_SetReset(int Active)
+{
+   pthread_mutex_lock(&SimContext.Mutex);
+
+   /* The controller holds CTS high while it is in reset and lowers it  */
+   /* once it has started (after the boot time, see UpdateCTS()).       */
+   if(Active)
+   {
+      SimContext.CTSHigh = 1;
+      SimContext.Booting = 0;
+   }
+   else
+   {
+      if((SimContext.ResetActive) && (SimContext.CTSHigh))
+      {
+         if(SimContext.Configuration.BootTime)
+         {
+            SimContext.Booting      = 1;
+            SimContext.BootDoneTime = GetNanoseconds() + (SimContext.Configuration.BootTime * 1000ULL);
+         }
+         else
+         {
+            SimContext.CTSHigh  = 0;
+            SimContext.Pending |= PENDING_CTS;
+         }
+      }
+   }
+
+   SimContext.ResetActive = Active;
+
+   pthread_mutex_unlock(&SimContext.Mutex);
+}
+
+void HCITRSIM_SetUartClock(int Enable)
+{
+   SimContext.UartClockEnabled = Enable;
+}
+
+void HCITRSIM_SetTxdHeld(int Held)
+{
+   SimContext.TxdHeld = Held;
+}
+
+void HCITRSIM_DisableInterrupts(void)
+{
+   pthread_mutex_lock(&SimContext.InterruptMutex);
+}
+
+void HCITRSIM_EnableInterrupts(void)
+{
+   pthread_mutex_unlock(&SimContext.InterruptMutex);
+}
+
+int HCITRSIM_IsInsideInterrupt(void)
+{
+   return(InsideInterrupt);
+}
+
+void MX_USART2_UART_Init(void)
+{
+   pthread_mutex_lock(&SimContext.Mutex);
+
+   memset(&SimContext.TxFIFO, 0, sizeof(SimContext.TxFIFO));
+   memset(&SimContext.RxFIFO, 0, sizeof(SimContext.RxFIFO));
+
+   /* 115200 baud, 8 data bits, no parity, one stop bit.                */
+   USART2->CR1 = USART_CR1_UE | USART_CR1_TE | USART_CR1_RE;
+   USART2->CR2 = 0;
+   USART2->CR3 = 0;
+   USART2->BRR = HCITR_UART_CLOCK / 115200;
+   USART2->ISR = 0;
+   USART2->ICR = 0;
+
+   huart2.Init.BaudRate      = 115200;
+
+   /* HAL_UART_MspInit() enables the UART interrupt.                    */
+   SimContext.UartIRQEnabled = 1;
+
+   UpdateFlags();
+
+   pthread_mutex_unlock(&SimContext.Mutex);
+}
+
+HAL_StatusTypeDef HAL_UARTEx_SetTxFifoThreshold(UART_HandleTypeDef *huart, uint32_t Threshold)
+{
+   pthread_mutex_lock(&SimContext.Mutex);
+
+   huart->Instance->CR3 = (huart->Instance->CR3 & ~USART_CR3_TXFTCFG) | Threshold;
+
+   pthread_mutex_unlock(&SimContext.Mutex);
+
+   return(HAL_OK);
+}
+
+HAL_StatusTypeDef HAL_UARTEx_SetRxFifoThreshold(UART_HandleTypeDef *huart, uint32_t Threshold)
+{
+   pthread_mutex_lock(&SimContext.Mutex);
+
+   huart->Instance->CR3 = (huart->Instance->CR3 & ~USART_CR3_RXFTCFG) | Threshold;
+
+   pthread_mutex_unlock(&SimContext.Mutex);
+
+   return(HAL_OK);
+}
+
+HAL_StatusTypeDef HAL_UARTEx_EnableFifoMode(UART_HandleTypeDef *huart)
+{
+   pthread_mutex_lock(&SimContext.Mutex);
+
+   huart->Instance->CR1 |= USART_CR1_FIFOEN;
+
+   UpdateFlags();
+
+   pthread_mutex_unlock(&SimContext.Mutex);
+
+   return(HAL_OK);
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+   pthread_mutex_lock(&SimContext.Mutex);
+
+   SimContext.RxDMABuffer  = pData;
+   SimContext.RxDMASize    = Size;
+   SimContext.RxDMAActive  = 1;
+   DMA2_Channel6->CNDTR    = Size;
+
+   /* The HAL enables the idle line and error interrupts.               */
+   huart->Instance->ISR   &= ~USART_ISR_IDLE;
+   huart->Instance->CR1   |= USART_CR1_IDLEIE;
+   huart->Instance->CR3   |= (USART_CR3_DMAR | USART_CR3_EIE);
+
+   pthread_mutex_unlock(&SimContext.Mutex);
+
+   return(HAL_OK);
+}
+
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef *huart)
+{
+   pthread_mutex_lock(&SimContext.Mutex);
+
+   SimContext.RxDMAActive  = 0;
+
+   huart->Instance->CR1   &= ~(USART_CR1_IDLEIE | USART_CR1_RXNEIE_RXFNEIE);
+   huart->Instance->CR3   &= ~(USART_CR3_DMAR | USART_CR3_EIE | USART_CR3_RXFTIE);
+
+   pthread_mutex_unlock(&SimContext.Mutex);
+
+   return(HAL_OK);
+}
+
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma)
+{
+   pthread_mutex_lock(&SimContext.Mutex);
+
+   if(hdma == huart2.hdmatx)
+   {
+      SimContext.TxDMARemaining  = 0;
+      SimContext.Pending        &= ~PENDING_TX_DMA;
+   }
+
+   pthread_mutex_unlock(&SimContext.Mutex);
+
+   return(HAL_OK);
+}
+
+void NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+   if(IRQn == USART2_IRQn)
+      SimContext.UartIRQEnabled = 0;
+}
+
+   /* The following functions are the default (weak) HAL callbacks, as  */
+   /* in the HAL, for the modes of HCITRANS that do not implement them. */
+__attribute__((weak)) void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+}
+
+__attribute__((weak)) void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+}
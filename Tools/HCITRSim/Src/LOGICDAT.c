@@ -0,0 +1,561 @@
+/*****< logicdat.c >***********************************************************/
+/*                                                                            */
+/*  LOGICDAT - Loader of Saleae Logic captures for the host tools.            */
+/*                                                                            */
+/******************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "LOGICDAT.h"       /* Capture Loader Prototypes/Constants.           */
+
+   /* The following constants represent the signature at the start of a */
+   /* .logicdata file (a length prefixed string at offset 4) and the    */
+   /* bytes in front of the sample rate that follows it.                */
+#define LOGICDATA_SIGNATURE_OFFSET                 4
+#define LOGICDATA_SIGNATURE                        "\x0A" "Data save2"
+#define LOGICDATA_SAMPLE_RATE_PREFIX               "\x01\x15\x01\x54"
+
+   /* A .logicdata file is made of length prefixed little endian        */
+   /* numbers (a length byte followed by that many bytes, so zero is a  */
+   /* single zero byte) and of arrays.  The transitions of each channel */
+   /* follow a header that starts with the following bytes (the second  */
+   /* group is only present in front of the first channel):             */
+   /*    01 16 [01 54 01 15] 01 <Channel + 1> 00 <Samples> 01 01        */
+   /*    <Transition Samples> <Trailing Samples>                        */
+   /* where Transition Samples is the sample of the last transition and */
+   /* the two lengths add up to the length of the capture.  Two arrays  */
+   /* of runs follow, each after its count (the count is recorded three */
+   /* times, separated by zero bytes): 16 bit runs (the level in bit 15 */
+   /* and the length in the low 15 bits) and 32 bit runs (the level in  */
+   /* bit 31) for the runs that do not fit in 15 bits.  The long runs   */
+   /* are placed in front of the short runs and between two short runs  */
+   /* of the same level.  The lengths of both arrays add up to          */
+   /* Transition Samples, which is used to find and to check them.      */
+#define LOGICDATA_CHANNEL_PREFIX                   "\x01\x16"
+#define LOGICDATA_FIRST_CHANNEL_PREFIX             "\x01\x54\x01\x15"
+#define LOGICDATA_ARRAY_SEARCH_LENGTH              64
+#define LOGICDATA_LONG_ARRAY_SEARCH_LENGTH         16
+
+#define LOGICDATA_SHORT_RUN_LEVEL                  0x8000
+#define LOGICDATA_SHORT_RUN_LENGTH                 0x7FFF
+#define LOGICDATA_LONG_RUN_LEVEL                   0x80000000UL
+#define LOGICDATA_LONG_RUN_LENGTH                  0x7FFFFFFFUL
+
+   /* The following constants represent the resolution that the times   */
+   /* of a CSV export are converted to and the longest line that is     */
+   /* read.                                                             */
+#define CSV_SAMPLE_RATE                            1000000000UL
+#define CSV_MAXIMUM_LINE_LENGTH                    1024
+
+   /* Local Function Prototypes.                                        */
+static unsigned char *ReadFile(char *FileName, unsigned long *Size);
+static int GetNumber(unsigned char *Buffer, unsigned long Size, unsigned long *Offset, unsigned long long *Value);
+static int MatchBytes(unsigned char *Buffer, unsigned long Size, unsigned long *Offset, char *Bytes, unsigned int Length);
+static int GetArrayCount(unsigned char *Buffer, unsigned long Size, unsigned long Offset, unsigned long *Count, unsigned long *DataOffset);
+static int AddEdge(LOGICDAT_Channel_t *Channel, unsigned long *Allocated, unsigned long long Sample);
+static int AddRun(LOGICDAT_Channel_t *Channel, unsigned long *Allocated, unsigned long long *Sample, int Level, unsigned long Length);
+static int LoadLogicDataChannel(unsigned char *Buffer, unsigned long Size, unsigned long Offset, unsigned long long TransitionSamples, LOGICDAT_Channel_t *Channel);
+static int LoadLogicData(unsigned char *Buffer, unsigned long Size, LOGICDAT_Capture_t *Capture);
+static int LoadCSV(char *FileName, LOGICDAT_Capture_t *Capture);
+
+   /* The following function reads the specified file into a buffer that*/
+   /* is allocated with malloc().  The function returns the buffer (and */
+   /* its size) if successful or NULL if there was an error.            */
+static unsigned char *ReadFile(char *FileName, unsigned long *Size)
+{
+   long           Length;
+   FILE          *File;
+   unsigned char *ret_val;
+
+   ret_val = NULL;
+
+   if((File = fopen(FileName, "rb")) != NULL)
+   {
+      if((!fseek(File, 0, SEEK_END)) && ((Length = ftell(File)) > 0) && (!fseek(File, 0, SEEK_SET)))
+      {
+         if((ret_val = (unsigned char *)malloc((size_t)Length)) != NULL)
+         {
+            if(fread(ret_val, 1, (size_t)Length, File) == (size_t)Length)
+               *Size = (unsigned long)Length;
+            else
+            {
+               free(ret_val);
+
+               ret_val = NULL;
+            }
+         }
+      }
+
+      fclose(File);
+   }
+
+   return(ret_val);
+}
+
+   /* The following function reads a length prefixed number at the      */
+   /* specified offset and moves the offset past it.  The function      */
+   /* returns zero if successful or a negative value if there is no     */
+   /* valid number at the offset.                                       */
+static int GetNumber(unsigned char *Buffer, unsigned long Size, unsigned long *Offset, unsigned long long *Value)
+{
+   int          ret_val;
+   unsigned int Length;
+
+   if(*Offset < Size)
+   {
+      Length = Buffer[*Offset];
+
+      if((Length <= sizeof(*Value)) && ((*Offset + 1 + Length) <= Size))
+      {
+         *Value = 0;
+
+         while(Length)
+         {
+            *Value = (*Value << 8) | Buffer[*Offset + Length];
+
+            Length--;
+         }
+
+         *Offset += 1 + Buffer[*Offset];
+
+         ret_val  = 0;
+      }
+      else
+         ret_val = -1;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function compares the bytes at the specified offset */
+   /* with the specified bytes and, if they match, moves the offset past*/
+   /* them.  The function returns non-zero if the bytes match.          */
+static int MatchBytes(unsigned char *Buffer, unsigned long Size, unsigned long *Offset, char *Bytes, unsigned int Length)
+{
+   int ret_val;
+
+   if(((*Offset + Length) <= Size) && (!memcmp(&Buffer[*Offset], Bytes, Length)))
+   {
+      *Offset += Length;
+
+      ret_val  = 1;
+   }
+   else
+      ret_val = 0;
+
+   return(ret_val);
+}
+
+   /* The following function reads the count of an array (three equal   */
+   /* numbers separated by zero bytes) at the specified offset.  The    */
+   /* function returns zero (with the count and the offset of the first */
+   /* element) if successful or a negative value if there is no count at*/
+   /* the offset.                                                       */
+static int GetArrayCount(unsigned char *Buffer, unsigned long Size, unsigned long Offset, unsigned long *Count, unsigned long *DataOffset)
+{
+   int                ret_val;
+   unsigned int       Index;
+   unsigned long long Value[3];
+
+   ret_val = 0;
+
+   for(Index = 0; (!ret_val) && (Index < 3); Index++)
+   {
+      if((Index) && ((Offset >= Size) || (Buffer[Offset++])))
+         ret_val = -1;
+      else
+         ret_val = GetNumber(Buffer, Size, &Offset, &Value[Index]);
+   }
+
+   if((!ret_val) && (Value[0] == Value[1]) && (Value[0] == Value[2]) && (Value[0] <= ((Size - Offset) / 2)))
+   {
+      *Count      = (unsigned long)Value[0];
+      *DataOffset = Offset;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function adds a transition to the specified channel,*/
+   /* growing its array as needed.  The function returns zero if        */
+   /* successful or a negative value if there is not enough memory.     */
+static int AddEdge(LOGICDAT_Channel_t *Channel, unsigned long *Allocated, unsigned long long Sample)
+{
+   int                 ret_val;
+   unsigned long long *Edges;
+
+   ret_val = 0;
+
+   if(Channel->NumberEdges == *Allocated)
+   {
+      if((Edges = (unsigned long long *)realloc(Channel->Edges, (*Allocated ? (*Allocated * 2) : 256) * sizeof(unsigned long long))) != NULL)
+      {
+         Channel->Edges  = Edges;
+         *Allocated      = *Allocated ? (*Allocated * 2) : 256;
+      }
+      else
+         ret_val = -1;
+   }
+
+   if(!ret_val)
+      Channel->Edges[Channel->NumberEdges++] = Sample;
+
+   return(ret_val);
+}
+
+   /* The following function adds a run of the specified level and      */
+   /* length to the specified channel (each run ends with a transition).*/
+   /* The function returns zero if successful or a negative value if    */
+   /* there is not enough memory.                                       */
+static int AddRun(LOGICDAT_Channel_t *Channel, unsigned long *Allocated, unsigned long long *Sample, int Level, unsigned long Length)
+{
+   if(!Channel->NumberEdges)
+      Channel->InitialLevel = Level;
+
+   *Sample += Length;
+
+   return(AddEdge(Channel, Allocated, *Sample));
+}
+
+   /* The following function finds the arrays of runs that follow the   */
+   /* header of a channel in a .logicdata file (the header ends at the  */
+   /* specified offset) and converts them to the transitions of the     */
+   /* channel.  The function returns zero if successful or a negative   */
+   /* value if no arrays that add up to the specified number of samples */
+   /* were found.                                                       */
+static int LoadLogicDataChannel(unsigned char *Buffer, unsigned long Size, unsigned long Offset, unsigned long long TransitionSamples, LOGICDAT_Channel_t *Channel)
+{
+   int                 ret_val;
+   unsigned long       SearchOffset;
+   unsigned long       LongSearchOffset;
+   unsigned long       NumberShort;
+   unsigned long       NumberLong;
+   unsigned long       ShortOffset;
+   unsigned long       LongOffset;
+   unsigned long       NumberLead;
+   unsigned long       Index;
+   unsigned long       LongIndex;
+   unsigned long       Allocated;
+   unsigned long       Run;
+   unsigned long       NumberLongRuns;
+   unsigned long long  Sample;
+   unsigned long long  Total;
+   unsigned long long  LongTotal;
+
+   ret_val     = -1;
+   NumberShort = 0;
+   NumberLong  = 0;
+   ShortOffset = 0;
+   LongOffset  = 0;
+
+   for(SearchOffset = Offset; (ret_val) && (SearchOffset < (Offset + LOGICDATA_ARRAY_SEARCH_LENGTH)) && (SearchOffset < Size); SearchOffset++)
+   {
+      if(!GetArrayCount(Buffer, Size, SearchOffset, &NumberShort, &ShortOffset))
+      {
+         for(Index = 0, Total = 0; Index < NumberShort; Index++)
+            Total += (Buffer[ShortOffset + (Index * 2)] | (Buffer[ShortOffset + (Index * 2) + 1] << 8)) & LOGICDATA_SHORT_RUN_LENGTH;
+
+         for(LongSearchOffset = ShortOffset + (NumberShort * 2); (ret_val) && (LongSearchOffset < (ShortOffset + (NumberShort * 2) + LOGICDATA_LONG_ARRAY_SEARCH_LENGTH)) && (LongSearchOffset < Size); LongSearchOffset++)
+         {
+            if((!GetArrayCount(Buffer, Size, LongSearchOffset, &NumberLong, &LongOffset)) && (NumberLong <= ((Size - LongOffset) / 4)))
+            {
+               for(Index = 0, LongTotal = 0; Index < NumberLong; Index++)
+                  LongTotal += (Buffer[LongOffset + (Index * 4)] | (Buffer[LongOffset + (Index * 4) + 1] << 8) | (Buffer[LongOffset + (Index * 4) + 2] << 16) | ((unsigned long)Buffer[LongOffset + (Index * 4) + 3] << 24)) & LOGICDATA_LONG_RUN_LENGTH;
+
+               if((Total + LongTotal) == TransitionSamples)
+                  ret_val = 0;
+            }
+         }
+      }
+   }
+
+   if(!ret_val)
+   {
+      /* Every pair of neighbouring short runs of the same level has a  */
+      /* long run between them, the remaining long runs lead.           */
+      for(Index = 1, NumberLead = NumberLong; (NumberLead) && (Index < NumberShort); Index++)
+      {
+         if(!((Buffer[ShortOffset + (Index * 2) + 1] ^ Buffer[ShortOffset + (Index * 2) - 1]) & (LOGICDATA_SHORT_RUN_LEVEL >> 8)))
+            NumberLead--;
+      }
+
+      Allocated = 0;
+      Sample    = 0;
+      LongIndex = 0;
+
+      for(Index = 0; (!ret_val) && (Index <= NumberShort); Index++)
+      {
+         /* Add the long runs that come before this short run (the      */
+         /* leading runs, one between runs of the same level or, after  */
+         /* the last short run, the ones that are left).                */
+         if(!Index)
+            NumberLongRuns = NumberLead;
+         else
+         {
+            if(Index == NumberShort)
+               NumberLongRuns = NumberLong - LongIndex;
+            else
+               NumberLongRuns = (!((Buffer[ShortOffset + (Index * 2) + 1] ^ Buffer[ShortOffset + (Index * 2) - 1]) & (LOGICDATA_SHORT_RUN_LEVEL >> 8))) ? 1 : 0;
+         }
+
+         while((!ret_val) && (NumberLongRuns--) && (LongIndex < NumberLong))
+         {
+            Run     = Buffer[LongOffset + (LongIndex * 4)] | (Buffer[LongOffset + (LongIndex * 4) + 1] << 8) | (Buffer[LongOffset + (LongIndex * 4) + 2] << 16) | ((unsigned long)Buffer[LongOffset + (LongIndex * 4) + 3] << 24);
+            ret_val = AddRun(Channel, &Allocated, &Sample, (Run & LOGICDATA_LONG_RUN_LEVEL) ? 1 : 0, Run & LOGICDATA_LONG_RUN_LENGTH);
+
+            LongIndex++;
+         }
+
+         if((!ret_val) && (Index < NumberShort))
+         {
+            Run     = Buffer[ShortOffset + (Index * 2)] | (Buffer[ShortOffset + (Index * 2) + 1] << 8);
+            ret_val = AddRun(Channel, &Allocated, &Sample, (Run & LOGICDATA_SHORT_RUN_LEVEL) ? 1 : 0, Run & LOGICDATA_SHORT_RUN_LENGTH);
+         }
+      }
+
+      if(!ret_val)
+         Channel->Present = 1;
+      else
+      {
+         free(Channel->Edges);
+
+         Channel->Edges       = NULL;
+         Channel->NumberEdges = 0;
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function loads a .logicdata file that has been read */
+   /* into the specified buffer.  The function returns zero if          */
+   /* successful or a negative value if the file was not recognized.    */
+static int LoadLogicData(unsigned char *Buffer, unsigned long Size, LOGICDAT_Capture_t *Capture)
+{
+   int                ret_val;
+   unsigned int       ChannelNumber;
+   unsigned long      Offset;
+   unsigned long      HeaderOffset;
+   unsigned long long Value;
+   unsigned long long Samples;
+   unsigned long long TransitionSamples;
+   unsigned long long TrailingSamples;
+
+   Offset = LOGICDATA_SIGNATURE_OFFSET;
+
+   if((MatchBytes(Buffer, Size, &Offset, LOGICDATA_SIGNATURE, sizeof(LOGICDATA_SIGNATURE) - 1)) && (MatchBytes(Buffer, Size, &Offset, LOGICDATA_SAMPLE_RATE_PREFIX, sizeof(LOGICDATA_SAMPLE_RATE_PREFIX) - 1)) && (!GetNumber(Buffer, Size, &Offset, &Value)) && (Value))
+   {
+      Capture->SampleRate = (unsigned long)Value;
+
+      for(; Offset < Size; Offset++)
+      {
+         HeaderOffset = Offset;
+
+         if(!MatchBytes(Buffer, Size, &HeaderOffset, LOGICDATA_CHANNEL_PREFIX, sizeof(LOGICDATA_CHANNEL_PREFIX) - 1))
+            continue;
+
+         MatchBytes(Buffer, Size, &HeaderOffset, LOGICDATA_FIRST_CHANNEL_PREFIX, sizeof(LOGICDATA_FIRST_CHANNEL_PREFIX) - 1);
+
+         if(((HeaderOffset + 3) > Size) || (Buffer[HeaderOffset] != 0x01) || (!Buffer[HeaderOffset + 1]) || (Buffer[HeaderOffset + 1] > LOGICDAT_MAXIMUM_CHANNELS) || (Buffer[HeaderOffset + 2]))
+            continue;
+
+         ChannelNumber  = Buffer[HeaderOffset + 1] - 1;
+         HeaderOffset  += 3;
+
+         if((GetNumber(Buffer, Size, &HeaderOffset, &Samples)) || (!MatchBytes(Buffer, Size, &HeaderOffset, "\x01\x01", 2)) || (GetNumber(Buffer, Size, &HeaderOffset, &TransitionSamples)) || (GetNumber(Buffer, Size, &HeaderOffset, &TrailingSamples)) || ((TransitionSamples + TrailingSamples) != Samples))
+            continue;
+
+         if((Capture->NumberSamples) && (Capture->NumberSamples != Samples))
+            continue;
+
+         Capture->NumberSamples = Samples;
+
+         if(ChannelNumber >= Capture->NumberChannels)
+            Capture->NumberChannels = ChannelNumber + 1;
+
+         /* A channel without transitions has no arrays to check.       */
+         if((!Capture->Channels[ChannelNumber].Present) && ((!TransitionSamples) || (!LoadLogicDataChannel(Buffer, Size, HeaderOffset, TransitionSamples, &Capture->Channels[ChannelNumber]))))
+            Capture->Channels[ChannelNumber].Present = 1;
+      }
+
+      ret_val = Capture->NumberChannels ? 0 : -1;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function loads the CSV export of the digital        */
+   /* channels of a capture.  The function returns zero if successful or*/
+   /* a negative value if the file could not be read or was not         */
+   /* recognized.                                                       */
+static int LoadCSV(char *FileName, LOGICDAT_Capture_t *Capture)
+{
+   int                ret_val;
+   int                Level;
+   int                FirstRow;
+   char               Line[CSV_MAXIMUM_LINE_LENGTH];
+   char              *Field;
+   char              *End;
+   FILE              *File;
+   double             Time;
+   double             StartTime;
+   unsigned int       Index;
+   unsigned long      Allocated[LOGICDAT_MAXIMUM_CHANNELS];
+   unsigned long long Sample;
+
+   ret_val = -1;
+
+   if((File = fopen(FileName, "r")) != NULL)
+   {
+      /* The first line names the columns, the first is the time.       */
+      if((fgets(Line, sizeof(Line), File)) && (!strncmp(Line, "Time", 4)))
+      {
+         for(Field = Line; (Field = strchr(Field, ',')) != NULL; Field++)
+            Capture->NumberChannels++;
+
+         if((Capture->NumberChannels) && (Capture->NumberChannels <= LOGICDAT_MAXIMUM_CHANNELS))
+         {
+            memset(Allocated, 0, sizeof(Allocated));
+
+            Capture->SampleRate = CSV_SAMPLE_RATE;
+            StartTime           = 0;
+            FirstRow            = 1;
+            ret_val             = 0;
+
+            while((!ret_val) && (fgets(Line, sizeof(Line), File)))
+            {
+               Time = strtod(Line, &End);
+               if(End == Line)
+                  continue;
+
+               if(FirstRow)
+                  StartTime = Time;
+
+               Sample = (unsigned long long)llround((Time - StartTime) * CSV_SAMPLE_RATE);
+               Field  = End;
+
+               for(Index = 0; (!ret_val) && (Index < Capture->NumberChannels); Index++)
+               {
+                  if((Field = strchr(Field, ',')) != NULL)
+                  {
+                     Level = (int)strtol(++Field, NULL, 10) ? 1 : 0;
+
+                     if(FirstRow)
+                     {
+                        Capture->Channels[Index].Present      = 1;
+                        Capture->Channels[Index].InitialLevel = Level;
+                     }
+                     else
+                     {
+                        if(Level != LOGICDAT_GetLevel(&Capture->Channels[Index], Sample))
+                           ret_val = AddEdge(&Capture->Channels[Index], &Allocated[Index], Sample);
+                     }
+                  }
+                  else
+                     ret_val = -1;
+               }
+
+               Capture->NumberSamples = Sample;
+               FirstRow               = 0;
+            }
+
+            if(FirstRow)
+               ret_val = -1;
+         }
+      }
+
+      fclose(File);
+   }
+
+   return(ret_val);
+}
+
+   /* The following function loads the specified capture file (the      */
+   /* format is detected from its contents) into the specified          */
+   /* structure.  This function returns zero if successful or a         */
+   /* negative value if the file could not be read or was not           */
+   /* recognized.  LOGICDAT_Free() must be called to release a capture  */
+   /* that was loaded.                                                  */
+int LOGICDAT_Load(char *FileName, LOGICDAT_Capture_t *Capture)
+{
+   int            ret_val;
+   unsigned char *Buffer;
+   unsigned long  Size;
+
+   memset(Capture, 0, sizeof(LOGICDAT_Capture_t));
+
+   if((Buffer = ReadFile(FileName, &Size)) != NULL)
+   {
+      if((Size > (LOGICDATA_SIGNATURE_OFFSET + sizeof(LOGICDATA_SIGNATURE) - 1)) && (!memcmp(&Buffer[LOGICDATA_SIGNATURE_OFFSET], LOGICDATA_SIGNATURE, sizeof(LOGICDATA_SIGNATURE) - 1)))
+         ret_val = LoadLogicData(Buffer, Size, Capture);
+      else
+         ret_val = LoadCSV(FileName, Capture);
+
+      free(Buffer);
+
+      if(ret_val)
+         LOGICDAT_Free(Capture);
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function releases the memory of a capture that was  */
+   /* loaded by LOGICDAT_Load().                                        */
+void LOGICDAT_Free(LOGICDAT_Capture_t *Capture)
+{
+   unsigned int Index;
+
+   for(Index = 0; Index < LOGICDAT_MAXIMUM_CHANNELS; Index++)
+      free(Capture->Channels[Index].Edges);
+
+   memset(Capture, 0, sizeof(LOGICDAT_Capture_t));
+}
+
+   /* The following function returns the level (zero or one) of the     */
+   /* specified channel at the specified sample.                        */
+int LOGICDAT_GetLevel(LOGICDAT_Channel_t *Channel, unsigned long long Sample)
+{
+   unsigned long Index;
+
+   /* The level toggles at every transition up to the sample.           */
+   Index = LOGICDAT_FindEdge(Channel, Sample + 1);
+
+   return(Channel->InitialLevel ^ (int)(Index & 1));
+}
+
+   /* The following function returns the index of the first transition  */
+   /* of the specified channel that is at or after the specified sample */
+   /* (NumberEdges if there is none).                                   */
+unsigned long LOGICDAT_FindEdge(LOGICDAT_Channel_t *Channel, unsigned long long Sample)
+{
+   unsigned long Low;
+   unsigned long High;
+   unsigned long Middle;
+
+   Low  = 0;
+   High = Channel->NumberEdges;
+
+   while(Low < High)
+   {
+      Middle = Low + ((High - Low) / 2);
+
+      if(Channel->Edges[Middle] < Sample)
+         Low = Middle + 1;
+      else
+         High = Middle;
+   }
+
+   return(Low);
+}
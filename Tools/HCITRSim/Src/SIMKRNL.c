@@ -0,0 +1,264 @@
+/*****< simkrnl.c >************************************************************/
+/*                                                                            */
+/*  SIMKRNL - FreeRTOS and Bluetopia kernel functions for the host            */
+/*            simulation of the HCI transport.                                */
+/*                                                                            */
+/******************************************************************************/
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "BTPSKRNL.h"       /* Bluetooth Kernel Prototypes/Constants.         */
+#include "FreeRTOS.h"       /* Simulated FreeRTOS Prototypes/Constants.       */
+#include "HCITRSIM.h"       /* Simulated Peripheral Prototypes/Constants.     */
+
+   /* The following variable holds the task handle of a thread that was */
+   /* not created by xTaskCreateStatic(), once it has needed one.       */
+static __thread StaticTask_t  ImplicitTask;
+static __thread TaskHandle_t  CurrentTask;
+
+   /* The following variable serializes the tasks that have suspended   */
+   /* the scheduler.                                                    */
+static pthread_mutex_t        SchedulerMutex = PTHREAD_MUTEX_INITIALIZER;
+
+   /* Local Function Prototypes.                                        */
+static unsigned long long GetMilliseconds(void);
+static void InitializeTask(StaticTask_t *Task);
+static void *TaskThread(void *Parameter);
+
+   /* The following function returns the time (in milliseconds) of the  */
+   /* monotonic clock.                                                  */
+static unsigned long long GetMilliseconds(void)
+{
+   struct timespec Now;
+
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+
+   return(((unsigned long long)Now.tv_sec * 1000) + (Now.tv_nsec / 1000000));
+}
+
+   /* The following function initializes the notification state of the  */
+   /* specified task.                                                   */
+static void InitializeTask(StaticTask_t *Task)
+{
+   pthread_condattr_t Attributes;
+
+   pthread_condattr_init(&Attributes);
+   pthread_condattr_setclock(&Attributes, CLOCK_MONOTONIC);
+
+   pthread_mutex_init(&(Task->Mutex), NULL);
+   pthread_cond_init(&(Task->Condition), &Attributes);
+
+   pthread_condattr_destroy(&Attributes);
+
+   Task->NotifyValue = 0;
+}
+
+   /* The following function is the thread of a task that was created   */
+   /* with xTaskCreateStatic().                                         */
+static void *TaskThread(void *Parameter)
+{
+   StaticTask_t *Task = (StaticTask_t *)Parameter;
+
+   CurrentTask = Task;
+
+   (*Task->Function)(Task->Parameter);
+
+   return(NULL);
+}
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t Function, const char *Name, uint32_t StackDepth, void *Parameter, UBaseType_t Priority, StackType_t *Stack, StaticTask_t *Task)
+{
+   TaskHandle_t ret_val;
+
+   InitializeTask(Task);
+
+   Task->Function  = Function;
+   Task->Parameter = Parameter;
+
+   /* The tasks of the transport never exit, so the thread is detached. */
+   if(!pthread_create(&(Task->Thread), NULL, TaskThread, Task))
+   {
+      pthread_detach(Task->Thread);
+
+      ret_val = Task;
+   }
+   else
+      ret_val = NULL;
+
+   return(ret_val);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+   if(!CurrentTask)
+   {
+      InitializeTask(&ImplicitTask);
+
+      ImplicitTask.Thread = pthread_self();
+
+      CurrentTask         = &ImplicitTask;
+   }
+
+   return(CurrentTask);
+}
+
+BaseType_t xTaskGetSchedulerState(void)
+{
+   return(taskSCHEDULER_RUNNING);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+   return((TickType_t)GetMilliseconds());
+}
+
+void vTaskDelay(TickType_t Ticks)
+{
+   struct timespec Delay;
+
+   Delay.tv_sec  = Ticks / 1000;
+   Delay.tv_nsec = (Ticks % 1000) * 1000000L;
+
+   while((nanosleep(&Delay, &Delay)) && (errno == EINTR)) {}
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t ClearCountOnExit, TickType_t TicksToWait)
+{
+   uint32_t         ret_val;
+   TaskHandle_t     Task;
+   struct timespec  Timeout;
+
+   Task = xTaskGetCurrentTaskHandle();
+
+   clock_gettime(CLOCK_MONOTONIC, &Timeout);
+
+   Timeout.tv_sec  += TicksToWait / 1000;
+   Timeout.tv_nsec += (TicksToWait % 1000) * 1000000L;
+   if(Timeout.tv_nsec >= 1000000000L)
+   {
+      Timeout.tv_sec++;
+      Timeout.tv_nsec -= 1000000000L;
+   }
+
+   pthread_mutex_lock(&(Task->Mutex));
+
+   while(!Task->NotifyValue)
+   {
+      if(TicksToWait == portMAX_DELAY)
+         pthread_cond_wait(&(Task->Condition), &(Task->Mutex));
+      else
+      {
+         if(pthread_cond_timedwait(&(Task->Condition), &(Task->Mutex), &Timeout) == ETIMEDOUT)
+            break;
+      }
+   }
+
+   ret_val = (uint32_t)Task->NotifyValue;
+
+   if(Task->NotifyValue)
+   {
+      if(ClearCountOnExit)
+         Task->NotifyValue = 0;
+      else
+         Task->NotifyValue--;
+   }
+
+   pthread_mutex_unlock(&(Task->Mutex));
+
+   return(ret_val);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t Task)
+{
+   pthread_mutex_lock(&(Task->Mutex));
+
+   Task->NotifyValue++;
+
+   pthread_cond_signal(&(Task->Condition));
+
+   pthread_mutex_unlock(&(Task->Mutex));
+
+   return(pdPASS);
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t Task, BaseType_t *HigherPriorityTaskWoken)
+{
+   xTaskNotifyGive(Task);
+
+   if(HigherPriorityTaskWoken)
+      *HigherPriorityTaskWoken = pdTRUE;
+}
+
+void vTaskSuspendAll(void)
+{
+   pthread_mutex_lock(&SchedulerMutex);
+}
+
+BaseType_t xTaskResumeAll(void)
+{
+   pthread_mutex_unlock(&SchedulerMutex);
+
+   return(pdFALSE);
+}
+
+BaseType_t xPortIsInsideInterrupt(void)
+{
+   return(HCITRSIM_IsInsideInterrupt() ? pdTRUE : pdFALSE);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *Semaphore)
+{
+   pthread_mutex_init(&(Semaphore->Mutex), NULL);
+
+   return(Semaphore);
+}
+
+   /* The transport only takes a mutex with no time out.                */
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t Semaphore, TickType_t TicksToWait)
+{
+   return((pthread_mutex_lock(&(Semaphore->Mutex))) ? pdFALSE : pdTRUE);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t Semaphore)
+{
+   return((pthread_mutex_unlock(&(Semaphore->Mutex))) ? pdFALSE : pdTRUE);
+}
+
+void BTPSAPI BTPS_Delay(unsigned long MilliSeconds)
+{
+   vTaskDelay((TickType_t)MilliSeconds);
+}
+
+unsigned long BTPSAPI BTPS_GetTickCount(void)
+{
+   return((unsigned long)GetMilliseconds());
+}
+
+void BTPSAPI BTPS_MemInitialize(void *Destination, unsigned char Value, unsigned long Size)
+{
+   memset(Destination, Value, Size);
+}
+
+void BTPSAPI BTPS_MemCopy(void *Destination, BTPSCONST void *Source, unsigned long Size)
+{
+   memcpy(Destination, Source, Size);
+}
+
+int BTPSAPI BTPS_OutputMessage(BTPSCONST char *Format, ...)
+{
+   int     ret_val;
+   va_list Arguments;
+
+   va_start(Arguments, Format);
+
+   ret_val = vprintf(Format, Arguments);
+
+   va_end(Arguments);
+
+   return(ret_val);
+}
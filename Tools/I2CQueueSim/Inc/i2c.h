@@ -0,0 +1,13 @@
+/*****< i2c.h >****************************************************************/
+/*                                                                            */
+/*  i2c - Stand-in for the generated I2C header, for the host check only.     */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __I2CH__
+#define __I2CH__
+
+#include "main.h"
+
+extern I2C_HandleTypeDef hi2c1;
+
+#endif
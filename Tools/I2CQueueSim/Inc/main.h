@@ -0,0 +1,38 @@
+/*****< main.h >***************************************************************/
+/*                                                                            */
+/*  main - Stand-in for the HAL definitions that are used by I2CQUEUE, for    */
+/*         the host check only.  The interrupt mask is a variable and the     */
+/*         DMA transfers are recorded by the check (see I2CQUEUECHECK.c),     */
+/*         which completes them by calling the HAL callbacks.                 */
+/*                                                                            */
+/******************************************************************************/
+#ifndef __MAINH__
+#define __MAINH__
+
+#include <stdint.h>
+
+typedef enum
+{
+   HAL_OK      = 0x00,
+   HAL_ERROR   = 0x01,
+   HAL_BUSY    = 0x02,
+   HAL_TIMEOUT = 0x03
+} HAL_StatusTypeDef;
+
+   /* The following structure holds the state of an I2C bus.            */
+typedef struct __I2C_HandleTypeDef
+{
+   unsigned int Instance;
+} I2C_HandleTypeDef;
+
+extern uint32_t SimulatedPRIMASK;
+
+#define __get_PRIMASK()          (SimulatedPRIMASK)
+#define __set_PRIMASK(_x)        (SimulatedPRIMASK = (uint32_t)(_x))
+#define __disable_irq()          (SimulatedPRIMASK = 1)
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_DMA(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size);
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c);
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c);
+
+#endif
@@ -0,0 +1,531 @@
+/*****< i2cqueuecheck.c >******************************************************/
+/*                                                                            */
+/*  I2CQUEUECHECK - Check of the I2C register write queue.                    */
+/*                                                                            */
+/*  I2CQUEUE is built from the firmware sources with the HAL transfer         */
+/*  stubbed out: each DMA transfer that the queue starts is recorded, and     */
+/*  the check completes it (or fails it) by calling the HAL callback that     */
+/*  the I2C interrupt would.  The transfers that reach the bus, the order     */
+/*  and status of the callbacks, the STOP2 lock and the statistics are        */
+/*  checked for the merging of consecutive registers, the register shadow,    */
+/*  a failed transfer (which fails the queued sequences of its device), a     */
+/*  transfer that can not be started and a full queue.  The program exits     */
+/*  with a non zero status if any check fails.                                */
+/*                                                                            */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "main.h"           /* Simulated HAL Prototypes/Constants.            */
+#include "LOWPOWER.h"       /* Low Power Prototypes/Constants.                */
+#include "I2CQUEUE.h"       /* I2C Register Write Queue Prototypes/Constants. */
+
+   /* The following constants represent the 7 bit addresses of the two  */
+   /* devices: one that increments its register address once the        */
+   /* increment flag is set in it (like the CS43L22) and one that does  */
+   /* not.                                                              */
+#define CODEC_ADDRESS            0x4A
+#define CODEC_INCREMENT_FLAG     0x80
+#define EXPANDER_ADDRESS         0x20
+
+   /* The following constants represent the largest number of transfers */
+   /* and of callbacks that are recorded by a check.                    */
+#define MAXIMUM_TRANSFERS        16
+#define MAXIMUM_CALLBACKS        16
+
+   /* The following structure holds a transfer that was started: the    */
+   /* (8 bit) address and the bytes that were sent.                     */
+typedef struct _tagTransfer_t
+{
+   unsigned int  Address;
+   unsigned int  Length;
+   unsigned char Data[I2CQUEUE_MAXIMUM_WRITES + 1];
+} Transfer_t;
+
+   /* The following structure holds a call of the callback of a         */
+   /* sequence.                                                         */
+typedef struct _tagCallback_t
+{
+   unsigned int  DeviceID;
+   int           Status;
+   unsigned long CallbackParameter;
+} Callback_t;
+
+   /* The following structure holds what the bus and the callbacks have */
+   /* seen since the last call to ResetLog().                           */
+typedef struct _tagLog_t
+{
+   unsigned int  NumberTransfers;
+   Transfer_t    Transfers[MAXIMUM_TRANSFERS];
+   unsigned int  NumberCallbacks;
+   Callback_t    Callbacks[MAXIMUM_CALLBACKS];
+} Log_t;
+
+   /* Simulated HAL state (see main.h and i2c.h).                       */
+uint32_t                  SimulatedPRIMASK;
+I2C_HandleTypeDef         hi2c1;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+static unsigned long      StopLocks;
+static int                TransferPending;
+static HAL_StatusTypeDef  StartStatus;
+static Log_t              Log;
+static int                CodecID;
+static int                ExpanderID;
+
+   /* Local Function Prototypes.                                        */
+static void ResetLog(void);
+static void RecordCallback(unsigned int DeviceID, int Status, unsigned long CallbackParameter);
+static void CompleteTransfers(unsigned int FailedTransfer);
+static int CheckTransfers(unsigned int NumberTransfers, const Transfer_t *Transfers);
+static int CheckCallbacks(unsigned int NumberCallbacks, const Callback_t *Callbacks);
+static int CheckStatistics(unsigned long Sequences, unsigned long Transfers, unsigned long SkippedWrites, unsigned long Errors);
+static int CheckIdle(void);
+static int CheckRegistration(void);
+static int CheckMerge(void);
+static int CheckShadow(void);
+static int CheckFailure(void);
+static int CheckStartFailure(void);
+static int CheckQueueFull(void);
+static int CheckParameters(void);
+
+   /* The following function stands in for the HAL, recording the       */
+   /* transfer that the queue starts.  Only one transfer may be         */
+   /* pending.                                                          */
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_DMA(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint8_t *pData, uint16_t Size)
+{
+   HAL_StatusTypeDef ret_val;
+   Transfer_t       *Transfer;
+
+   if((hi2c == &hi2c1) && (!TransferPending) && (Size <= (I2CQUEUE_MAXIMUM_WRITES + 1)) && (Log.NumberTransfers < MAXIMUM_TRANSFERS) && (StartStatus == HAL_OK))
+   {
+      Transfer          = &Log.Transfers[Log.NumberTransfers++];
+      Transfer->Address = DevAddress;
+      Transfer->Length  = Size;
+
+      memcpy(Transfer->Data, pData, Size);
+
+      TransferPending   = 1;
+
+      ret_val           = HAL_OK;
+   }
+   else
+      ret_val = (StartStatus != HAL_OK) ? StartStatus : HAL_BUSY;
+
+   return(ret_val);
+}
+
+   /* The following functions stand in for the STOP2 locks.             */
+void LOWPOWER_PreventStop(unsigned long Locks)
+{
+   StopLocks |= Locks;
+}
+
+void LOWPOWER_AllowStop(unsigned long Locks)
+{
+   StopLocks &= ~Locks;
+}
+
+   /* The following function clears what the bus and the callbacks have */
+   /* seen.                                                             */
+static void ResetLog(void)
+{
+   memset(&Log, 0, sizeof(Log));
+}
+
+   /* The following function is the callback of every sequence that is  */
+   /* queued by the checks.                                             */
+static void RecordCallback(unsigned int DeviceID, int Status, unsigned long CallbackParameter)
+{
+   if(Log.NumberCallbacks < MAXIMUM_CALLBACKS)
+   {
+      Log.Callbacks[Log.NumberCallbacks].DeviceID          = DeviceID;
+      Log.Callbacks[Log.NumberCallbacks].Status            = Status;
+      Log.Callbacks[Log.NumberCallbacks].CallbackParameter = CallbackParameter;
+   }
+
+   Log.NumberCallbacks++;
+}
+
+   /* The following function completes the pending transfer, and those  */
+   /* that are started from its interrupt in turn, until the bus is     */
+   /* idle.  The transfer with the specified index in the log (if any)  */
+   /* fails as if the device did not acknowledge.                       */
+static void CompleteTransfers(unsigned int FailedTransfer)
+{
+   while(TransferPending)
+   {
+      TransferPending = 0;
+
+      if(Log.NumberTransfers == (FailedTransfer + 1))
+         HAL_I2C_ErrorCallback(&hi2c1);
+      else
+         HAL_I2C_MasterTxCpltCallback(&hi2c1);
+   }
+}
+
+   /* The following function checks that the specified transfers, and   */
+   /* only those, were started.  This function returns zero if they     */
+   /* were or a negative value if not.                                  */
+static int CheckTransfers(unsigned int NumberTransfers, const Transfer_t *Transfers)
+{
+   int          ret_val;
+   unsigned int Index;
+
+   ret_val = (Log.NumberTransfers == NumberTransfers) ? 0 : -1;
+
+   for(Index = 0; (!ret_val) && (Index < NumberTransfers); Index++)
+   {
+      if((Log.Transfers[Index].Address != Transfers[Index].Address) || (Log.Transfers[Index].Length != Transfers[Index].Length) || (memcmp(Log.Transfers[Index].Data, Transfers[Index].Data, Transfers[Index].Length)))
+         ret_val = -1;
+   }
+
+   if(ret_val)
+   {
+      for(Index = 0; Index < Log.NumberTransfers; Index++)
+         printf("   Transfer %u: address 0x%02X, %u bytes, first 0x%02X\n", Index, Log.Transfers[Index].Address, Log.Transfers[Index].Length, Log.Transfers[Index].Data[0]);
+   }
+
+   return(ret_val);
+}
+
+   /* The following function checks that the specified callbacks, and   */
+   /* only those, were called in order.  This function returns zero if  */
+   /* they were or a negative value if not.                             */
+static int CheckCallbacks(unsigned int NumberCallbacks, const Callback_t *Callbacks)
+{
+   int          ret_val;
+   unsigned int Index;
+
+   ret_val = (Log.NumberCallbacks == NumberCallbacks) ? 0 : -1;
+
+   for(Index = 0; (!ret_val) && (Index < NumberCallbacks); Index++)
+   {
+      if((Log.Callbacks[Index].DeviceID != Callbacks[Index].DeviceID) || (Log.Callbacks[Index].Status != Callbacks[Index].Status) || (Log.Callbacks[Index].CallbackParameter != Callbacks[Index].CallbackParameter))
+         ret_val = -1;
+   }
+
+   if(ret_val)
+   {
+      for(Index = 0; (Index < Log.NumberCallbacks) && (Index < MAXIMUM_CALLBACKS); Index++)
+         printf("   Callback %u: device %u, status %d, parameter %lu\n", Index, Log.Callbacks[Index].DeviceID, Log.Callbacks[Index].Status, Log.Callbacks[Index].CallbackParameter);
+   }
+
+   return(ret_val);
+}
+
+   /* The following function checks the statistics of the queue since   */
+   /* they were last reset, and resets them.  This function returns     */
+   /* zero if they match or a negative value if not.                    */
+static int CheckStatistics(unsigned long Sequences, unsigned long Transfers, unsigned long SkippedWrites, unsigned long Errors)
+{
+   int                   ret_val;
+   I2CQUEUE_Statistics_t Statistics;
+
+   I2CQUEUE_Query_Statistics(&Statistics, 1);
+
+   ret_val = ((Statistics.Sequences == Sequences) && (Statistics.Transfers == Transfers) && (Statistics.SkippedWrites == SkippedWrites) && (Statistics.Errors == Errors)) ? 0 : -1;
+
+   printf("   Statistics: %lu sequences, %lu transfers, %lu skipped writes, %lu errors\n", Statistics.Sequences, Statistics.Transfers, Statistics.SkippedWrites, Statistics.Errors);
+
+   return(ret_val);
+}
+
+   /* The following function checks that the queue has gone idle: no    */
+   /* transfer is pending, the STOP2 lock has been released and the     */
+   /* interrupts are enabled again.  This function returns zero if it   */
+   /* has or a negative value if not.                                   */
+static int CheckIdle(void)
+{
+   return(((!TransferPending) && (!(StopLocks & LOWPOWER_LOCK_I2C_QUEUE)) && (!SimulatedPRIMASK)) ? 0 : -1);
+}
+
+   /* The following function registers the two devices, and checks that */
+   /* a third is refused.  This function returns zero if the check      */
+   /* passed or a negative value if it failed.                          */
+static int CheckRegistration(void)
+{
+   int ret_val;
+
+   CodecID    = I2CQUEUE_Register_Device(CODEC_ADDRESS, 1, CODEC_INCREMENT_FLAG);
+   ExpanderID = I2CQUEUE_Register_Device(EXPANDER_ADDRESS, 0, 0);
+
+   ret_val    = ((CodecID == 0) && (ExpanderID == 1) && (I2CQUEUE_Register_Device(0x30, 0, 0) == I2CQUEUE_ERROR_QUEUE_FULL) && (I2CQUEUE_Register_Device(0x80, 0, 0) == I2CQUEUE_ERROR_INVALID_PARAMETER)) ? 0 : -1;
+
+   printf("I2CQUEUE registration%s\n", (ret_val) ? " FAILED" : "");
+
+   return(ret_val);
+}
+
+   /* The following function checks that the writes of a sequence to    */
+   /* consecutive registers are sent as one transfer (with the increment*/
+   /* flag set in the register address) to a device that increments its */
+   /* register address, and one at a time otherwise.  This function     */
+   /* returns zero if the check passed or a negative value if it failed.*/
+static int CheckMerge(void)
+{
+   int ret_val;
+   int Locked;
+
+   static const I2CQUEUE_Write_t CodecWrites[]    = { { 0x02, 0x11 }, { 0x03, 0x22 }, { 0x04, 0x33 }, { 0x08, 0x44 } };
+   static const I2CQUEUE_Write_t ExpanderWrites[] = { { 0x01, 0x55 }, { 0x02, 0x66 } };
+   static const Transfer_t       Transfers[]      =
+   {
+      { CODEC_ADDRESS << 1,    4, { 0x02 | CODEC_INCREMENT_FLAG, 0x11, 0x22, 0x33 } },
+      { CODEC_ADDRESS << 1,    2, { 0x08, 0x44 } },
+      { EXPANDER_ADDRESS << 1, 2, { 0x01, 0x55 } },
+      { EXPANDER_ADDRESS << 1, 2, { 0x02, 0x66 } }
+   };
+   static const Callback_t       Callbacks[]      = { { 0, 0, 1 }, { 1, 0, 2 } };
+
+   ResetLog();
+
+   ret_val  = I2CQUEUE_Write_Sequence(CodecID, 4, CodecWrites, RecordCallback, 1);
+   ret_val |= I2CQUEUE_Write_Sequence(ExpanderID, 2, ExpanderWrites, RecordCallback, 2);
+
+   /* The first transfer is started by the caller and holds the lock.   */
+   Locked   = ((TransferPending) && (StopLocks & LOWPOWER_LOCK_I2C_QUEUE) && (!Log.NumberCallbacks));
+
+   CompleteTransfers(MAXIMUM_TRANSFERS);
+
+   if((ret_val) || (!Locked) || (CheckTransfers(4, Transfers)) || (CheckCallbacks(2, Callbacks)) || (CheckIdle()))
+      ret_val = -1;
+
+   if(CheckStatistics(2, 4, 0, 0))
+      ret_val = -1;
+
+   printf("I2CQUEUE merge: %u transfers%s\n", Log.NumberTransfers, (ret_val) ? " FAILED" : "");
+
+   return(ret_val);
+}
+
+   /* The following function checks the shadow of the registers: writes */
+   /* of the value a register already holds are dropped (a sequence that*/
+   /* is left empty completes at once), the value of a register is      */
+   /* known once it has been written and every write is sent again once */
+   /* the shadow has been invalidated.  It follows CheckMerge().  This  */
+   /* function returns zero if the check passed or a negative value if  */
+   /* it failed.                                                        */
+static int CheckShadow(void)
+{
+   int ret_val;
+
+   static const I2CQUEUE_Write_t Writes[]    = { { 0x02, 0x11 }, { 0x03, 0x22 }, { 0x05, 0x77 }, { 0x04, 0x33 }, { 0x08, 0x44 } };
+   static const Transfer_t       Transfers[] =
+   {
+      { CODEC_ADDRESS << 1,    2, { 0x05, 0x77 } },
+      { CODEC_ADDRESS << 1,    2, { 0x02, 0x11 } }
+   };
+   static const Callback_t       Callbacks[] = { { 0, 0, 3 }, { 0, 0, 4 }, { 0, 0, 5 } };
+
+   ResetLog();
+
+   ret_val  = I2CQUEUE_Write_Sequence(CodecID, 5, Writes, RecordCallback, 3);
+
+   CompleteTransfers(MAXIMUM_TRANSFERS);
+
+   /* Nothing is left to send, the callback is called before this       */
+   /* returns.                                                          */
+   ret_val |= I2CQUEUE_Write_Register(CodecID, 0x02, 0x11, RecordCallback, 4);
+
+   if((TransferPending) || (Log.NumberCallbacks != 2))
+      ret_val = -1;
+
+   if((I2CQUEUE_Query_Register(CodecID, 0x05) != 0x77) || (I2CQUEUE_Query_Register(CodecID, 0x03) != 0x22) || (I2CQUEUE_Query_Register(CodecID, 0x09) >= 0) || (I2CQUEUE_Query_Register(ExpanderID, 0x02) != 0x66))
+      ret_val = -1;
+
+   I2CQUEUE_Invalidate(CodecID);
+
+   if((I2CQUEUE_Query_Register(CodecID, 0x05) >= 0) || (I2CQUEUE_Query_Register(ExpanderID, 0x02) != 0x66))
+      ret_val = -1;
+
+   ret_val |= I2CQUEUE_Write_Register(CodecID, 0x02, 0x11, RecordCallback, 5);
+
+   CompleteTransfers(MAXIMUM_TRANSFERS);
+
+   if((ret_val) || (CheckTransfers(2, Transfers)) || (CheckCallbacks(3, Callbacks)) || (CheckIdle()))
+      ret_val = -1;
+
+   if(CheckStatistics(3, 2, 5, 0))
+      ret_val = -1;
+
+   printf("I2CQUEUE shadow: %u transfers%s\n", Log.NumberTransfers, (ret_val) ? " FAILED" : "");
+
+   return(ret_val);
+}
+
+   /* The following function checks a transfer that fails.  The rest of */
+   /* its sequence and the sequence queued after it to the same device  */
+   /* (of which a write was dropped by the shadow) fail without being   */
+   /* sent, the sequence queued to the other device is still sent and   */
+   /* the shadow of the failed device is invalidated.  This function    */
+   /* returns zero if the check passed or a negative value if it failed.*/
+static int CheckFailure(void)
+{
+   int ret_val;
+
+   static const I2CQUEUE_Write_t FirstWrites[]    = { { 0x10, 0x01 }, { 0x11, 0x02 }, { 0x20, 0x03 } };
+   static const I2CQUEUE_Write_t SecondWrites[]   = { { 0x10, 0x01 }, { 0x12, 0x04 } };
+   static const I2CQUEUE_Write_t ExpanderWrites[] = { { 0x03, 0x09 } };
+   static const Transfer_t       Transfers[]      =
+   {
+      { CODEC_ADDRESS << 1,    3, { 0x10 | CODEC_INCREMENT_FLAG, 0x01, 0x02 } },
+      { EXPANDER_ADDRESS << 1, 2, { 0x03, 0x09 } }
+   };
+   static const Callback_t       Callbacks[]      = { { 0, I2CQUEUE_ERROR_TRANSFER_FAILED, 10 }, { 0, I2CQUEUE_ERROR_TRANSFER_FAILED, 11 }, { 1, 0, 12 } };
+
+   ResetLog();
+
+   ret_val  = I2CQUEUE_Write_Sequence(CodecID, 3, FirstWrites, RecordCallback, 10);
+   ret_val |= I2CQUEUE_Write_Sequence(CodecID, 2, SecondWrites, RecordCallback, 11);
+   ret_val |= I2CQUEUE_Write_Sequence(ExpanderID, 1, ExpanderWrites, RecordCallback, 12);
+
+   CompleteTransfers(0);
+
+   if((ret_val) || (CheckTransfers(2, Transfers)) || (CheckCallbacks(3, Callbacks)) || (CheckIdle()))
+      ret_val = -1;
+
+   if((I2CQUEUE_Query_Register(CodecID, 0x10) >= 0) || (I2CQUEUE_Query_Register(CodecID, 0x12) >= 0) || (I2CQUEUE_Query_Register(ExpanderID, 0x03) != 0x09))
+      ret_val = -1;
+
+   if(CheckStatistics(3, 2, 1, 1))
+      ret_val = -1;
+
+   printf("I2CQUEUE failed transfer: %u transfers, %u callbacks%s\n", Log.NumberTransfers, Log.NumberCallbacks, (ret_val) ? " FAILED" : "");
+
+   return(ret_val);
+}
+
+   /* The following function checks a transfer that the HAL refuses to  */
+   /* start: the sequence fails from the caller and the write is sent   */
+   /* when it is queued again.  This function returns zero if the check */
+   /* passed or a negative value if it failed.                          */
+static int CheckStartFailure(void)
+{
+   int ret_val;
+
+   static const Transfer_t Transfers[] = { { EXPANDER_ADDRESS << 1, 2, { 0x04, 0x0A } } };
+   static const Callback_t Callbacks[] = { { 1, I2CQUEUE_ERROR_TRANSFER_FAILED, 20 }, { 1, 0, 21 } };
+
+   ResetLog();
+
+   StartStatus = HAL_BUSY;
+
+   ret_val     = I2CQUEUE_Write_Register(ExpanderID, 0x04, 0x0A, RecordCallback, 20);
+
+   StartStatus = HAL_OK;
+
+   if((Log.NumberCallbacks != 1) || (CheckIdle()) || (I2CQUEUE_Query_Register(ExpanderID, 0x04) >= 0))
+      ret_val = -1;
+
+   ret_val    |= I2CQUEUE_Write_Register(ExpanderID, 0x04, 0x0A, RecordCallback, 21);
+
+   CompleteTransfers(MAXIMUM_TRANSFERS);
+
+   if((ret_val) || (CheckTransfers(1, Transfers)) || (CheckCallbacks(2, Callbacks)) || (CheckIdle()))
+      ret_val = -1;
+
+   if(CheckStatistics(2, 2, 0, 1))
+      ret_val = -1;
+
+   printf("I2CQUEUE refused transfer%s\n", (ret_val) ? " FAILED" : "");
+
+   return(ret_val);
+}
+
+   /* The following function fills the queue while its first transfer   */
+   /* is pending and checks that one more sequence is refused and that  */
+   /* the sequences complete in the order they were queued.  This       */
+   /* function returns zero if the check passed or a negative value if  */
+   /* it failed.                                                        */
+static int CheckQueueFull(void)
+{
+   int          ret_val;
+   unsigned int Index;
+   Callback_t   Callbacks[I2CQUEUE_MAXIMUM_SEQUENCES];
+
+   ResetLog();
+
+   ret_val = 0;
+
+   for(Index = 0; Index < I2CQUEUE_MAXIMUM_SEQUENCES; Index++)
+   {
+      ret_val |= I2CQUEUE_Write_Register(ExpanderID, 0x30, Index, RecordCallback, 30 + Index);
+
+      Callbacks[Index].DeviceID          = ExpanderID;
+      Callbacks[Index].Status            = 0;
+      Callbacks[Index].CallbackParameter = 30 + Index;
+   }
+
+   if(I2CQUEUE_Write_Register(ExpanderID, 0x30, 0xFF, RecordCallback, 99) != I2CQUEUE_ERROR_QUEUE_FULL)
+      ret_val = -1;
+
+   CompleteTransfers(MAXIMUM_TRANSFERS);
+
+   if((ret_val) || (Log.NumberTransfers != I2CQUEUE_MAXIMUM_SEQUENCES) || (CheckCallbacks(I2CQUEUE_MAXIMUM_SEQUENCES, Callbacks)) || (CheckIdle()) || (I2CQUEUE_Query_Register(ExpanderID, 0x30) != (I2CQUEUE_MAXIMUM_SEQUENCES - 1)))
+      ret_val = -1;
+
+   if(CheckStatistics(I2CQUEUE_MAXIMUM_SEQUENCES, I2CQUEUE_MAXIMUM_SEQUENCES, 0, 0))
+      ret_val = -1;
+
+   printf("I2CQUEUE full queue: %u sequences%s\n", Log.NumberCallbacks, (ret_val) ? " FAILED" : "");
+
+   return(ret_val);
+}
+
+   /* The following function checks that invalid parameters are refused */
+   /* without queuing anything.  This function returns zero if the      */
+   /* check passed or a negative value if it failed.                    */
+static int CheckParameters(void)
+{
+   int              ret_val;
+   I2CQUEUE_Write_t Writes[I2CQUEUE_MAXIMUM_WRITES + 1];
+
+   ResetLog();
+
+   memset(Writes, 0, sizeof(Writes));
+
+   ret_val = ((I2CQUEUE_Write_Sequence(2, 1, Writes, NULL, 0) == I2CQUEUE_ERROR_INVALID_PARAMETER) && (I2CQUEUE_Write_Sequence(CodecID, 0, Writes, NULL, 0) == I2CQUEUE_ERROR_INVALID_PARAMETER) && (I2CQUEUE_Write_Sequence(CodecID, I2CQUEUE_MAXIMUM_WRITES + 1, Writes, NULL, 0) == I2CQUEUE_ERROR_INVALID_PARAMETER) && (I2CQUEUE_Write_Sequence(CodecID, 1, NULL, NULL, 0) == I2CQUEUE_ERROR_INVALID_PARAMETER) && (I2CQUEUE_Write_Register(CodecID, 0x100, 0, NULL, 0) == I2CQUEUE_ERROR_INVALID_PARAMETER) && (I2CQUEUE_Write_Register(CodecID, 0, 0x100, NULL, 0) == I2CQUEUE_ERROR_INVALID_PARAMETER) && (!Log.NumberTransfers) && (!CheckIdle())) ? 0 : -1;
+
+   if(CheckStatistics(0, 0, 0, 0))
+      ret_val = -1;
+
+   printf("I2CQUEUE parameters%s\n", (ret_val) ? " FAILED" : "");
+
+   return(ret_val);
+}
+
+int main(int argc, char *argv[])
+{
+   int ret_val;
+
+   ret_val = 0;
+
+   if(CheckRegistration())
+      ret_val = 1;
+   else
+   {
+      if(CheckMerge())
+         ret_val = 1;
+
+      if(CheckShadow())
+         ret_val = 1;
+
+      if(CheckFailure())
+         ret_val = 1;
+
+      if(CheckStartFailure())
+         ret_val = 1;
+
+      if(CheckQueueFull())
+         ret_val = 1;
+
+      if(CheckParameters())
+         ret_val = 1;
+   }
+
+   return(ret_val);
+}